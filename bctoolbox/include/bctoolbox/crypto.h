@@ -550,6 +550,38 @@ BCTBX_PUBLIC const char *bctbx_ssl_get_ciphersuite(bctbx_ssl_context_t *ssl_ctx)
 BCTBX_PUBLIC int bctbx_ssl_get_ciphersuite_id(const char *ciphersuite);
 BCTBX_PUBLIC const char *bctbx_ssl_get_version(bctbx_ssl_context_t *ssl_ctx);
 
+/***** Session resumption *****/
+typedef struct bctbx_ssl_session_struct bctbx_ssl_session_t;
+BCTBX_PUBLIC bctbx_ssl_session_t *bctbx_ssl_session_new(void);
+BCTBX_PUBLIC void bctbx_ssl_session_free(bctbx_ssl_session_t *session);
+
+/**
+ * @brief Copy the session negotiated by an ssl context, so that a later connection to the same peer can resume it
+ * (using a session ticket or the session ID, depending on what the server supports).
+ * With TLS 1.3 the tickets are received after the handshake, so the session is best saved when closing the connection.
+ *
+ * @param[in]		ssl_ctx		The ssl context, with a completed handshake
+ * @param[in/out]	session		A session created with bctbx_ssl_session_new(), previous content is replaced
+ *
+ * @return 0 on success, negative error code if the context holds no resumable session
+ */
+BCTBX_PUBLIC int32_t bctbx_ssl_get_session(bctbx_ssl_context_t *ssl_ctx, bctbx_ssl_session_t *session);
+
+/**
+ * @brief Offer a previously saved session to the server. Must be called after bctbx_ssl_context_setup() and before
+ * the handshake. The server may refuse it, the handshake is then a full one.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+BCTBX_PUBLIC int32_t bctbx_ssl_set_session(bctbx_ssl_context_t *ssl_ctx, const bctbx_ssl_session_t *session);
+
+/**
+ * @brief Tell if the handshake performed on this context resumed a previous session instead of doing a full one.
+ *
+ * @return 1 if the session was resumed, 0 otherwise
+ */
+BCTBX_PUBLIC int bctbx_ssl_session_resumed(bctbx_ssl_context_t *ssl_ctx);
+
 BCTBX_PUBLIC bctbx_ssl_config_t *bctbx_ssl_config_new(void);
 BCTBX_PUBLIC int32_t bctbx_ssl_config_set_crypto_library_config(bctbx_ssl_config_t *ssl_config, void *internal_config);
 BCTBX_PUBLIC void bctbx_ssl_config_free(bctbx_ssl_config_t *ssl_config);
@@ -578,6 +610,17 @@ BCTBX_PUBLIC int32_t bctbx_ssl_config_set_ciphersuites(bctbx_ssl_config_t *ssl_c
  */
 BCTBX_PUBLIC int32_t bctbx_ssl_config_set_groups(bctbx_ssl_config_t *ssl_config, const bctbx_list_t *groups);
 
+/**
+ * @brief Enable or disable session tickets (RFC 5077, and TLS 1.3 tickets).
+ * On client side, the client requests a ticket that can be used to resume the session later.
+ * On server side, the server issues tickets protected by a key generated at configuration time: the endpoint and,
+ * for mbedtls, the rng must already be set.
+ * Tickets are enabled by default on client side.
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+BCTBX_PUBLIC int32_t bctbx_ssl_config_set_session_tickets(bctbx_ssl_config_t *ssl_config, int enable);
+
 /***** DTLS-SRTP functions *****/
 BCTBX_PUBLIC bctbx_dtls_srtp_profile_t bctbx_ssl_get_dtls_srtp_protection_profile(bctbx_ssl_context_t *ssl_ctx);
 BCTBX_PUBLIC int32_t bctbx_ssl_config_set_dtls_srtp_protection_profiles(bctbx_ssl_config_t *ssl_config,
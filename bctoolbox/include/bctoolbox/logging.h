@@ -101,6 +101,28 @@ BCTBX_PUBLIC bctbx_log_handler_t *bctbx_create_file_log_handler(uint64_t max_siz
  */
 BCTBX_PUBLIC void bctbx_file_log_handler_reopen(bctbx_log_handler_t *file_log_handler);
 
+/**
+ * @brief Enable or disable the asynchronous mode of a file log handler.
+ * In asynchronous mode, a logging thread only formats its message and copies it into a lock-free ring buffer of its
+ * own. A background thread writes the records to the file, rotates and syncs it. Memory usage is bounded by
+ * buffer_size for each thread: when the ring buffer of a thread is full, its records are dropped and counted.
+ * bctbx_logv_flush() waits until the records of the calling thread are written.
+ * @param[in] file_log_handler A log handler created with bctbx_create_file_log_handler() or bctbx_set_log_file().
+ * @param[in] enabled TRUE to enable the asynchronous mode, FALSE to go back to synchronous writes.
+ * @param[in] buffer_size The size in bytes of the ring buffer of each logging thread, 0 for the default (256 kB).
+ * @note Like bctbx_remove_log_handler(), disabling the asynchronous mode must not be done while other threads log.
+ */
+BCTBX_PUBLIC void
+bctbx_file_log_handler_set_async(bctbx_log_handler_t *file_log_handler, bool_t enabled, size_t buffer_size);
+
+/**
+ * @brief Get the number of log records dropped by a file log handler in asynchronous mode.
+ * Dropped records are also reported in the log file itself by a warning.
+ * @param[in] file_log_handler The file log handler.
+ * @return The number of records dropped since the asynchronous mode was enabled.
+ */
+BCTBX_PUBLIC uint64_t bctbx_file_log_handler_get_dropped_count(const bctbx_log_handler_t *file_log_handler);
+
 /* set domain the handler is limited to. NULL for ALL*/
 BCTBX_PUBLIC void bctbx_log_handler_set_domain(bctbx_log_handler_t *log_handler, const char *domain);
 BCTBX_PUBLIC void bctbx_log_handler_set_user_data(bctbx_log_handler_t *, void *user_data);
@@ -136,7 +158,8 @@ BCTBX_PUBLIC int bctbx_log_level_enabled(const char *domain, BctbxLogLevel level
 BCTBX_PUBLIC void bctbx_logv(const char *domain, BctbxLogLevel level, const char *fmt, va_list args);
 
 /**
- * Flushes the log output queue.
+ * Flushes the log output queue, and waits for the asynchronous file log handlers to write the logs of the calling
+ * thread.
  * WARNING: Must be called from the thread that has been defined with bctbx_set_log_thread_id().
  */
 BCTBX_PUBLIC void bctbx_logv_flush(void);
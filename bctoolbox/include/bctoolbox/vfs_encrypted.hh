@@ -88,6 +88,9 @@ using EncryptedVfsOpenCb = std::function<void(VfsEncryption &settings)>;
 
 // forward declare this type, store all the encryption data and functions
 class VfsEncryptionModule;
+// forward declare the cache of plain chunks
+template <typename Value>
+class VfsLruCache;
 
 /** Store in the bctbx_vfs_file_t userData field an object specific to encryption */
 class VfsEncryption {
@@ -126,6 +129,30 @@ private:
 	bool mIntegrityFullCheck;       /**< if the file size given in the header metadata is incorrect, full check the file
 	                                   integrity and revrite header */
 	int mAccessMode;                /**< the flags used to open the file, filtered on the access mode */
+	bool mHeaderDirty; /**< the file size changed since the header was written: it is written by sync or at closing */
+	std::unique_ptr<VfsLruCache<std::vector<uint8_t>>> mChunkCache; /**< the most recently used plain chunks */
+	mutable std::vector<uint8_t> mRawBuffer; /**< raw chunks read from or written to the file, reused between calls */
+
+	/**
+	 * Get the plain content of a chunk, from the cache or read and decrypted from the file.
+	 * The chunk must exist in the file.
+	 * @param[in]	chunkIndex	the chunk index
+	 *
+	 * @return the plain chunk, in the cache. It is valid until the next access to the cache.
+	 * @throw a EvfsException if the chunk cannot be read or decrypted
+	 */
+	std::vector<uint8_t> &plainChunkGet(uint32_t chunkIndex) const;
+
+	/**
+	 * Read and decrypt complete chunks directly in the given buffer, they are not cached.
+	 * Chunks are decrypted in parallel when there are enough of them.
+	 * @param[in]	firstChunk	index of the first chunk to decrypt
+	 * @param[in]	chunkCount	number of chunks to decrypt, they must all be complete
+	 * @param[out]	plainData	a buffer of at least chunkCount*chunkSize bytes
+	 *
+	 * @throw a EvfsException if a chunk cannot be read or decrypted
+	 */
+	void decryptChunks(uint32_t firstChunk, uint32_t chunkCount, uint8_t *plainData) const;
 
 	/**
 	 * Parse the header of an encrypted file, check everything seems correct
@@ -157,15 +184,18 @@ public:
 	 */
 	int64_t fileSizeGet() const noexcept;
 
-	/* Read from file at given offset the requested size */
-	std::vector<uint8_t> read(size_t offset, size_t count) const;
+	/* Read from file at given offset the requested size, return the size actually read: less at the end of file */
+	size_t read(uint8_t *plainData, size_t count, size_t offset) const;
 
 	/* write to file at given offset the requested size */
-	size_t write(const std::vector<uint8_t> &plainData, size_t offset);
+	size_t write(const uint8_t *plainData, size_t count, size_t offset);
 
 	/* Truncate the file to the given size, if given size is greater than current, pad with 0 */
 	void truncate(const uint64_t size);
 
+	/* Write the file header if the file size changed since it was written and sync the file to disk */
+	int sync();
+
 	/**
 	 *  Get the filename
 	 *  @return a string with the filename as given to the open function
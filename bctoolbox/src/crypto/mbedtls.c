@@ -37,6 +37,9 @@
 #include <mbedtls/sha256.h>
 #include <mbedtls/sha512.h>
 #include <mbedtls/ssl.h>
+#ifdef MBEDTLS_SSL_TICKET_C
+#include <mbedtls/ssl_ticket.h>
+#endif
 #include <mbedtls/timing.h>
 #include <mbedtls/x509.h>
 
@@ -865,6 +868,8 @@ struct bctbx_ssl_context_struct {
 	                              size_t); /* args: callback data, data buffer to be read, size of data buffer */
 	void *callback_sendrecv_data;          /**< data passed to send/recv callbacks */
 	mbedtls_timing_delay_context timer;    /**< a timer is requested for DTLS */
+	uint8_t server_hello_reached;          /**< the handshake went through the ServerHello */
+	uint8_t server_certificate_reached;    /**< the handshake went through the server Certificate: it was a full one */
 #ifdef HAVE_DTLS_SRTP
 	bctbx_dtls_srtp_keys_t dtls_srtp_keys; /**< Key material is stored during the handshake there and used after
 	                                          completion to generate the DTLS-SRTP shared secret */
@@ -899,6 +904,8 @@ int32_t bctbx_ssl_close_notify(bctbx_ssl_context_t *ssl_ctx) {
 }
 
 int32_t bctbx_ssl_session_reset(bctbx_ssl_context_t *ssl_ctx) {
+	ssl_ctx->server_hello_reached = 0;
+	ssl_ctx->server_certificate_reached = 0;
 	return mbedtls_ssl_session_reset(&(ssl_ctx->ssl_ctx));
 }
 
@@ -931,8 +938,25 @@ int32_t bctbx_ssl_read(bctbx_ssl_context_t *ssl_ctx, unsigned char *buf, size_t
 }
 
 int32_t bctbx_ssl_handshake(bctbx_ssl_context_t *ssl_ctx) {
+	int ret = 0;
 
-	int ret = mbedtls_ssl_handshake(&(ssl_ctx->ssl_ctx));
+	/* Same as mbedtls_ssl_handshake(), step by step to see the states: mbedtls does not tell if the session was
+	 * resumed, but an abbreviated handshake goes from the ServerHello (TLS 1.2) or the EncryptedExtensions (TLS 1.3)
+	 * to the Finished messages without the server Certificate, on both sides. */
+	while (!mbedtls_ssl_is_handshake_over(&(ssl_ctx->ssl_ctx))) {
+		ret = mbedtls_ssl_handshake_step(&(ssl_ctx->ssl_ctx));
+		switch (ssl_ctx->ssl_ctx.MBEDTLS_PRIVATE(state)) {
+			case MBEDTLS_SSL_SERVER_HELLO:
+				ssl_ctx->server_hello_reached = 1;
+				break;
+			case MBEDTLS_SSL_SERVER_CERTIFICATE:
+				ssl_ctx->server_certificate_reached = 1;
+				break;
+			default:
+				break;
+		}
+		if (ret != 0) break;
+	}
 
 	/* remap some output codes */
 	if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
@@ -1004,6 +1028,54 @@ int32_t bctbx_ssl_set_hostname(bctbx_ssl_context_t *ssl_ctx, const char *hostnam
 	return mbedtls_ssl_set_hostname(&(ssl_ctx->ssl_ctx), hostname);
 }
 
+/** session resumption **/
+struct bctbx_ssl_session_struct {
+	mbedtls_ssl_session session;
+};
+
+bctbx_ssl_session_t *bctbx_ssl_session_new(void) {
+	bctbx_ssl_session_t *session = bctbx_malloc0(sizeof(bctbx_ssl_session_t));
+	mbedtls_ssl_session_init(&(session->session));
+	return session;
+}
+
+void bctbx_ssl_session_free(bctbx_ssl_session_t *session) {
+	if (session == NULL) return;
+	mbedtls_ssl_session_free(&(session->session));
+	bctbx_free(session);
+}
+
+int32_t bctbx_ssl_get_session(bctbx_ssl_context_t *ssl_ctx, bctbx_ssl_session_t *session) {
+	if (ssl_ctx == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	if (session == NULL) {
+		return BCTBX_ERROR_INVALID_INPUT_DATA;
+	}
+	if (!mbedtls_ssl_is_handshake_over(&(ssl_ctx->ssl_ctx))) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	mbedtls_ssl_session_free(&(session->session));
+	mbedtls_ssl_session_init(&(session->session));
+	return mbedtls_ssl_get_session(&(ssl_ctx->ssl_ctx), &(session->session));
+}
+
+int32_t bctbx_ssl_set_session(bctbx_ssl_context_t *ssl_ctx, const bctbx_ssl_session_t *session) {
+	if (ssl_ctx == NULL || ssl_ctx->ssl_ctx.MBEDTLS_PRIVATE(conf) == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	if (session == NULL) {
+		return BCTBX_ERROR_INVALID_INPUT_DATA;
+	}
+	return mbedtls_ssl_set_session(&(ssl_ctx->ssl_ctx), &(session->session));
+}
+
+int bctbx_ssl_session_resumed(bctbx_ssl_context_t *ssl_ctx) {
+	if (ssl_ctx == NULL || !mbedtls_ssl_is_handshake_over(&(ssl_ctx->ssl_ctx))) return 0;
+	/* a handshake not driven by bctbx_ssl_handshake() is not known to be resumed */
+	return ssl_ctx->server_hello_reached && !ssl_ctx->server_certificate_reached;
+}
+
 /** DTLS SRTP functions **/
 #ifdef HAVE_DTLS_SRTP
 uint8_t bctbx_dtls_srtp_supported(void) {
@@ -1093,6 +1165,11 @@ struct bctbx_ssl_config_struct {
 	                                      list termination) */
 #endif                                 /* HAVE_DTLS_SRTP */
 	int *ciphersuites;                 /**< ciphersuites as mbedtls id's */
+	int (*rng_function)(void *, unsigned char *, size_t); /**< kept to set up the session tickets key */
+	void *rng_context;
+#ifdef MBEDTLS_SSL_TICKET_C
+	mbedtls_ssl_ticket_context *ticket_ctx; /**< server side session tickets key */
+#endif
 };
 
 bctbx_ssl_config_t *bctbx_ssl_config_new(void) {
@@ -1102,7 +1179,7 @@ bctbx_ssl_config_t *bctbx_ssl_config_new(void) {
 	ssl_config->ssl_config_externally_provided = 0;
 	mbedtls_ssl_config_init(ssl_config->ssl_config);
 
-	mbedtls_ssl_conf_session_tickets(ssl_config->ssl_config, MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+	mbedtls_ssl_conf_session_tickets(ssl_config->ssl_config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
 	mbedtls_ssl_conf_renegotiation(ssl_config->ssl_config, MBEDTLS_SSL_RENEGOTIATION_DISABLED);
 
 	ssl_config->callback_cli_cert_function = NULL;
@@ -1154,6 +1231,13 @@ void bctbx_ssl_config_free(bctbx_ssl_config_t *ssl_config) {
 		bctbx_free(ssl_config->ciphersuites);
 	}
 
+#ifdef MBEDTLS_SSL_TICKET_C
+	if (ssl_config->ticket_ctx) {
+		mbedtls_ssl_ticket_free(ssl_config->ticket_ctx);
+		bctbx_free(ssl_config->ticket_ctx);
+	}
+#endif
+
 	bctbx_free(ssl_config);
 }
 
@@ -1314,6 +1398,8 @@ int32_t bctbx_ssl_config_set_rng(bctbx_ssl_config_t *ssl_config,
 	}
 
 	mbedtls_ssl_conf_rng(ssl_config->ssl_config, rng_function, rng_context);
+	ssl_config->rng_function = rng_function;
+	ssl_config->rng_context = rng_context;
 
 	return 0;
 }
@@ -1369,6 +1455,53 @@ int32_t bctbx_ssl_config_set_groups(BCTBX_UNUSED(bctbx_ssl_config_t *ssl_config)
 	return BCTBX_ERROR_UNAVAILABLE_FUNCTION;
 }
 
+int32_t bctbx_ssl_config_set_session_tickets(bctbx_ssl_config_t *ssl_config, int enable) {
+	if (ssl_config == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONFIG;
+	}
+
+	if (ssl_config->ssl_config->MBEDTLS_PRIVATE(endpoint) == MBEDTLS_SSL_IS_CLIENT) {
+		mbedtls_ssl_conf_session_tickets(ssl_config->ssl_config, enable ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED
+		                                                                : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+		return 0;
+	}
+
+#ifdef MBEDTLS_SSL_TICKET_C
+	if (!enable) {
+		mbedtls_ssl_conf_session_tickets_cb(ssl_config->ssl_config, NULL, NULL, NULL);
+		if (ssl_config->ticket_ctx) {
+			mbedtls_ssl_ticket_free(ssl_config->ticket_ctx);
+			bctbx_free(ssl_config->ticket_ctx);
+			ssl_config->ticket_ctx = NULL;
+		}
+		return 0;
+	}
+	if (ssl_config->ticket_ctx != NULL) {
+		return 0;
+	}
+	if (ssl_config->rng_function == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONFIG;
+	}
+
+	ssl_config->ticket_ctx = bctbx_malloc0(sizeof(mbedtls_ssl_ticket_context));
+	mbedtls_ssl_ticket_init(ssl_config->ticket_ctx);
+	/* tickets are valid for one day, the key is renewed at the same rate */
+	int ret = mbedtls_ssl_ticket_setup(ssl_config->ticket_ctx, ssl_config->rng_function, ssl_config->rng_context,
+	                                   MBEDTLS_CIPHER_AES_256_GCM, 86400);
+	if (ret != 0) {
+		mbedtls_ssl_ticket_free(ssl_config->ticket_ctx);
+		bctbx_free(ssl_config->ticket_ctx);
+		ssl_config->ticket_ctx = NULL;
+		return ret;
+	}
+	mbedtls_ssl_conf_session_tickets_cb(ssl_config->ssl_config, mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse,
+	                                    ssl_config->ticket_ctx);
+	return 0;
+#else
+	return enable ? BCTBX_ERROR_UNAVAILABLE_FUNCTION : 0;
+#endif
+}
+
 /** DTLS SRTP functions **/
 #ifdef HAVE_DTLS_SRTP
 /* key derivation code */
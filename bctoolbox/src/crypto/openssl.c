@@ -1084,6 +1084,59 @@ const char *bctbx_ssl_get_version(bctbx_ssl_context_t *ssl_ctx) {
 	}
 }
 
+/** session resumption **/
+struct bctbx_ssl_session_struct {
+	SSL_SESSION *session;
+};
+
+bctbx_ssl_session_t *bctbx_ssl_session_new(void) {
+	return bctbx_malloc0(sizeof(bctbx_ssl_session_t));
+}
+
+void bctbx_ssl_session_free(bctbx_ssl_session_t *session) {
+	if (session == NULL) return;
+	if (session->session) SSL_SESSION_free(session->session);
+	bctbx_free(session);
+}
+
+int32_t bctbx_ssl_get_session(bctbx_ssl_context_t *ssl_ctx, bctbx_ssl_session_t *session) {
+	if (ssl_ctx == NULL || ssl_ctx->ssl == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	if (session == NULL) {
+		return BCTBX_ERROR_INVALID_INPUT_DATA;
+	}
+	/* with TLS 1.3 the session is replaced each time a ticket is received, get the last one */
+	SSL_SESSION *current_session = SSL_get0_session(ssl_ctx->ssl);
+	if (current_session == NULL || !SSL_SESSION_is_resumable(current_session)) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	/* work on a copy: openssl marks the session of a connection not closed by a close notify as not resumable */
+	SSL_SESSION *ssl_session = SSL_SESSION_dup(current_session);
+	if (ssl_session == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	if (session->session) SSL_SESSION_free(session->session);
+	session->session = ssl_session;
+	return 0;
+}
+
+int32_t bctbx_ssl_set_session(bctbx_ssl_context_t *ssl_ctx, const bctbx_ssl_session_t *session) {
+	if (ssl_ctx == NULL || ssl_ctx->ssl == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONTEXT;
+	}
+	if (session == NULL || session->session == NULL) {
+		return BCTBX_ERROR_INVALID_INPUT_DATA;
+	}
+	/* SSL_set_session() takes its own reference on the session */
+	return SSL_set_session(ssl_ctx->ssl, session->session) == 1 ? 0 : BCTBX_ERROR_INVALID_SSL_CONTEXT;
+}
+
+int bctbx_ssl_session_resumed(bctbx_ssl_context_t *ssl_ctx) {
+	if (ssl_ctx == NULL || ssl_ctx->ssl == NULL) return 0;
+	return SSL_session_reused(ssl_ctx->ssl) == 1 ? 1 : 0;
+}
+
 int32_t bctbx_ssl_set_hostname(bctbx_ssl_context_t *ssl_ctx, const char *hostname) {
 	return SSL_set_tlsext_host_name(ssl_ctx->ssl, hostname) == 1 ? 0 : ERR_get_error();
 }
@@ -1507,6 +1560,28 @@ int32_t bctbx_ssl_config_set_dtls_srtp_protection_profiles(bctbx_ssl_config_t *s
 	return ret == 1 ? 0 : ERR_get_error();
 }
 
+int32_t bctbx_ssl_config_set_session_tickets(bctbx_ssl_config_t *ssl_config, int enable) {
+	if (ssl_config == NULL) {
+		return BCTBX_ERROR_INVALID_SSL_CONFIG;
+	}
+
+	if (enable) {
+		SSL_CTX_clear_options(ssl_config->ssl_ctx, SSL_OP_NO_TICKET);
+		if (ssl_config->ssl_method == TLS_server_method() || ssl_config->ssl_method == DTLS_server_method()) {
+			/* ticket keys are generated by openssl for each SSL_CTX. A session ID context is required to resume
+			 * sessions of clients authenticated with a certificate. */
+			static const unsigned char session_id_context[] = "bctoolbox";
+			if (SSL_CTX_set_session_id_context(ssl_config->ssl_ctx, session_id_context,
+			                                   sizeof(session_id_context) - 1) != 1) {
+				return BCTBX_ERROR_INVALID_SSL_CONFIG;
+			}
+		}
+	} else {
+		SSL_CTX_set_options(ssl_config->ssl_ctx, SSL_OP_NO_TICKET);
+	}
+	return 0;
+}
+
 /** DTLS SRTP functions **/
 
 int32_t bctbx_ssl_context_setup(bctbx_ssl_context_t *ssl_ctx, bctbx_ssl_config_t *ssl_config) {
@@ -0,0 +1,438 @@
+/*
+ * Copyright (c) 2016-2024 Belledonne Communications SARL.
+ *
+ * This file is part of bctoolbox.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async-log-writer.h"
+#include "bctoolbox/defs.h"
+
+using namespace std;
+
+namespace bctoolbox {
+
+/*
+ * Single producer, single consumer ring buffer of log records. The producer is the thread owning the ring, the
+ * consumer is the background thread of the writer. Records are stored contiguously; when a record does not fit
+ * before the end of the buffer, the remaining bytes are skipped (with a padding record if there is room for a header)
+ * and the record is written at the beginning.
+ */
+class LogRing {
+public:
+	struct Record {
+		uint32_t size; /* whole record, header included, padding records have a level of 0 */
+		int32_t level;
+		int64_t sec;
+		int32_t usec;
+		uint32_t domainLen;
+		uint32_t tagsLen;
+		uint32_t msgLen;
+
+		const char *domain() const {
+			return reinterpret_cast<const char *>(this + 1);
+		}
+		const char *tags() const {
+			return domain() + domainLen + 1;
+		}
+		const char *msg() const {
+			return tags() + tagsLen + 1;
+		}
+	};
+
+	explicit LogRing(size_t size) : mCapacity(size - size % sizeof(Record)), mBuffer(new Record[size / sizeof(Record)]) {
+	}
+
+	/* Producer side */
+	bool write(const struct timeval &tp, const char *domain, BctbxLogLevel level, const char *tags, const char *msg) {
+		size_t domainLen = domain ? strlen(domain) : 0;
+		size_t tagsLen = tags ? strlen(tags) : 0;
+		size_t msgLen = strlen(msg);
+		/* a single huge message shall not monopolize the ring: truncate it to a quarter of the capacity */
+		size_t maxLen = mCapacity / 4;
+		if (sizeof(Record) + domainLen + tagsLen + 3 > maxLen) return false;
+		msgLen = min(msgLen, maxLen - sizeof(Record) - domainLen - tagsLen - 3);
+		size_t size = align(sizeof(Record) + domainLen + tagsLen + msgLen + 3);
+
+		size_t head = mHead.load(memory_order_relaxed);
+		size_t tail = mTail.load(memory_order_acquire);
+		size_t offset = head % mCapacity;
+		size_t skip = (mCapacity - offset < size) ? mCapacity - offset : 0;
+		if (head + skip + size - tail > mCapacity) return false;
+		if (skip >= sizeof(Record)) {
+			Record *padding = at(offset);
+			padding->size = (uint32_t)skip;
+			padding->level = 0;
+		}
+		if (skip) offset = 0;
+
+		Record *record = at(offset);
+		record->size = (uint32_t)size;
+		record->level = level;
+		record->sec = tp.tv_sec;
+		record->usec = (int32_t)tp.tv_usec;
+		record->domainLen = (uint32_t)domainLen;
+		record->tagsLen = (uint32_t)tagsLen;
+		record->msgLen = (uint32_t)msgLen;
+		char *data = reinterpret_cast<char *>(record + 1);
+		if (domainLen) memcpy(data, domain, domainLen);
+		data[domainLen] = '\0';
+		data += domainLen + 1;
+		if (tagsLen) memcpy(data, tags, tagsLen);
+		data[tagsLen] = '\0';
+		data += tagsLen + 1;
+		memcpy(data, msg, msgLen);
+		data[msgLen] = '\0';
+		mHead.store(head + skip + size, memory_order_release);
+		return true;
+	}
+
+	bool isMoreThanHalfFull() const {
+		return mHead.load(memory_order_relaxed) - mTail.load(memory_order_relaxed) > mCapacity / 2;
+	}
+
+	/* Consumer side */
+	/* Sets the limit of the records returned by front(), so that a drain ends even if the producer keeps writing. */
+	void snapshot() {
+		mReadLimit = mHead.load(memory_order_acquire);
+	}
+
+	const Record *front() {
+		while (mReadPos != mReadLimit) {
+			size_t offset = mReadPos % mCapacity;
+			if (mCapacity - offset < sizeof(Record)) {
+				mReadPos += mCapacity - offset;
+				continue;
+			}
+			const Record *record = at(offset);
+			if (record->level != 0) return record;
+			mReadPos += record->size;
+		}
+		return nullptr;
+	}
+
+	void pop() {
+		mReadPos += at(mReadPos % mCapacity)->size;
+		mTail.store(mReadPos, memory_order_release);
+	}
+
+	bool isEmpty() const {
+		return mReadPos == mHead.load(memory_order_acquire);
+	}
+
+	/* Set when the producer thread exits, the consumer releases the ring once it is empty. */
+	atomic<bool> mOrphaned{false};
+	/* Set when the writer is destroyed, the producer releases the ring on its next log. */
+	atomic<bool> mClosed{false};
+
+private:
+	static size_t align(size_t size) {
+		return (size + sizeof(Record) - 1) / sizeof(Record) * sizeof(Record);
+	}
+	Record *at(size_t offset) const {
+		return mBuffer.get() + offset / sizeof(Record);
+	}
+
+	const size_t mCapacity;
+	/* Allocated as an array of Record so that every record is correctly aligned. */
+	unique_ptr<Record[]> mBuffer;
+	atomic<size_t> mHead{0};
+	atomic<size_t> mTail{0};
+	size_t mReadPos = 0;
+	size_t mReadLimit = 0;
+};
+
+class AsyncLogWriter {
+public:
+	AsyncLogWriter(bctbx_file_log_handler_t *fileHandler, size_t bufferSize)
+	    : mFileHandler(fileHandler), mBufferSize(max(bufferSize, sMinBufferSize)), mId(++sLastId) {
+		registerWriter(this);
+		mThread = thread(&AsyncLogWriter::run, this);
+	}
+	~AsyncLogWriter() {
+		unregisterWriter(this);
+		{
+			lock_guard<mutex> lock(mMutex);
+			mRunning = false;
+		}
+		mCondition.notify_one();
+		mThread.join();
+		lock_guard<mutex> lock(mRingsMutex);
+		for (auto &ring : mRings)
+			ring->mClosed.store(true, memory_order_release);
+	}
+
+	bool push(const struct timeval &tp, const char *domain, BctbxLogLevel level, const char *tags, const char *msg) {
+		LogRing &ring = getThreadRing();
+		if (!ring.write(tp, domain, level, tags, msg)) {
+			mDroppedCount.fetch_add(1, memory_order_relaxed);
+			wakeUp();
+			return false;
+		}
+		if (level >= BCTBX_LOG_ERROR || ring.isMoreThanHalfFull()) wakeUp();
+		return true;
+	}
+
+	void flush() {
+		/* the background thread never waits for itself */
+		if (this_thread::get_id() == mThread.get_id()) return;
+		unique_lock<mutex> lock(mMutex);
+		uint64_t request = ++mFlushRequested;
+		mCondition.notify_one();
+		mFlushCondition.wait(lock, [this, request] { return mFlushDone >= request || !mRunning; });
+	}
+
+	uint64_t getDroppedCount() const {
+		return mDroppedCount.load(memory_order_relaxed);
+	}
+
+	/*
+	 * The registry lock is not held while waiting for the writers, as a flush may be requested again from a path
+	 * writing logs. The writers being flushed are pinned so that they are not destroyed meanwhile.
+	 */
+	static void flushAll() {
+		auto &registry = getRegistry();
+		vector<AsyncLogWriter *> writers;
+		{
+			lock_guard<mutex> lock(registry.mMutex);
+			writers.assign(registry.mWriters.begin(), registry.mWriters.end());
+			for (auto writer : writers)
+				++writer->mPinCount;
+		}
+		for (auto writer : writers)
+			writer->flush();
+		{
+			lock_guard<mutex> lock(registry.mMutex);
+			for (auto writer : writers)
+				--writer->mPinCount;
+		}
+		registry.mCondition.notify_all();
+	}
+
+private:
+	struct Registry {
+		mutex mMutex;
+		condition_variable mCondition;
+		list<AsyncLogWriter *> mWriters;
+	};
+
+	/* The rings of the calling thread, one per writer it logged to. */
+	struct ThreadRings {
+		~ThreadRings() {
+			for (auto &entry : mRings)
+				entry.second->mOrphaned.store(true, memory_order_release);
+		}
+		vector<pair<uint64_t, shared_ptr<LogRing>>> mRings;
+	};
+
+	static Registry &getRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	static void registerWriter(AsyncLogWriter *writer) {
+		static once_flag atExitRegistered;
+		auto &registry = getRegistry();
+		/* write pending logs when the process exits */
+		call_once(atExitRegistered, [] { atexit(flushAll); });
+		lock_guard<mutex> lock(registry.mMutex);
+		registry.mWriters.push_back(writer);
+	}
+
+	static void unregisterWriter(AsyncLogWriter *writer) {
+		auto &registry = getRegistry();
+		unique_lock<mutex> lock(registry.mMutex);
+		registry.mWriters.remove(writer);
+		/* wait for the flushes in progress, the background thread is still running to complete them */
+		registry.mCondition.wait(lock, [writer] { return writer->mPinCount == 0; });
+	}
+
+	LogRing &getThreadRing() {
+		thread_local ThreadRings threadRings;
+		auto &rings = threadRings.mRings;
+		for (auto &entry : rings) {
+			if (entry.first == mId) return *entry.second;
+		}
+		/* first log of this thread to this writer: release the rings of destroyed writers and create a new one */
+		rings.erase(remove_if(rings.begin(), rings.end(),
+		                      [](const pair<uint64_t, shared_ptr<LogRing>> &entry) {
+			                      return entry.second->mClosed.load(memory_order_acquire);
+		                      }),
+		            rings.end());
+		auto ring = make_shared<LogRing>(mBufferSize);
+		{
+			lock_guard<mutex> lock(mRingsMutex);
+			mRings.push_back(ring);
+		}
+		rings.emplace_back(mId, ring);
+		return *ring;
+	}
+
+	void wakeUp() {
+		if (!mWakeUpRequested.exchange(true, memory_order_relaxed)) mCondition.notify_one();
+	}
+
+	void run() {
+		auto lastSync = chrono::steady_clock::now();
+		unique_lock<mutex> lock(mMutex);
+		while (mRunning) {
+			mCondition.wait_for(lock, sPollInterval, [this] {
+				return !mRunning || mFlushRequested != mFlushDone || mWakeUpRequested.load(memory_order_relaxed);
+			});
+			uint64_t flushRequested = mFlushRequested;
+			mWakeUpRequested.store(false, memory_order_relaxed);
+			lock.unlock();
+
+			drain();
+			auto now = chrono::steady_clock::now();
+			bool toDisk = flushRequested != mFlushDone || now - lastSync >= sSyncInterval;
+			bctbx_file_log_handler_sync(mFileHandler, toDisk);
+			if (toDisk) lastSync = now;
+
+			lock.lock();
+			mFlushDone = flushRequested;
+			mFlushCondition.notify_all();
+		}
+		lock.unlock();
+		drain();
+		bctbx_file_log_handler_sync(mFileHandler, TRUE);
+	}
+
+	/* Writes the pending records of all the rings, merged in timestamp order. */
+	void drain() {
+		vector<shared_ptr<LogRing>> rings;
+		{
+			lock_guard<mutex> lock(mRingsMutex);
+			rings = mRings;
+		}
+		for (auto &ring : rings)
+			ring->snapshot();
+		for (;;) {
+			LogRing *nextRing = nullptr;
+			const LogRing::Record *next = nullptr;
+			for (auto &ring : rings) {
+				const LogRing::Record *record = ring->front();
+				if (record && (!next || record->sec < next->sec || (record->sec == next->sec && record->usec < next->usec))) {
+					next = record;
+					nextRing = ring.get();
+				}
+			}
+			if (!next) break;
+			struct timeval tp;
+			tp.tv_sec = (decltype(tp.tv_sec))next->sec;
+			tp.tv_usec = next->usec;
+			bctbx_file_log_handler_write(mFileHandler, &tp, next->domainLen ? next->domain() : NULL,
+			                             (BctbxLogLevel)next->level, next->tagsLen ? next->tags() : NULL, next->msg());
+			nextRing->pop();
+		}
+
+		uint64_t droppedCount = mDroppedCount.load(memory_order_relaxed);
+		if (droppedCount != mReportedDroppedCount) {
+			struct timeval tp;
+			string msg = "Asynchronous logging: " + to_string(droppedCount - mReportedDroppedCount) +
+			             " log records dropped because the ring buffer of their thread was full.";
+			bctbx_gettimeofday(&tp, NULL);
+			bctbx_file_log_handler_write(mFileHandler, &tp, NULL, BCTBX_LOG_WARNING, NULL, msg.c_str());
+			mReportedDroppedCount = droppedCount;
+		}
+
+		/* the rings of the threads that exited are released once empty */
+		lock_guard<mutex> lock(mRingsMutex);
+		mRings.erase(remove_if(mRings.begin(), mRings.end(),
+		                       [](const shared_ptr<LogRing> &ring) {
+			                       return ring->mOrphaned.load(memory_order_acquire) && ring->isEmpty();
+		                       }),
+		             mRings.end());
+	}
+
+	static constexpr size_t sMinBufferSize = 4096;
+	static constexpr chrono::milliseconds sPollInterval{100};
+	static constexpr chrono::seconds sSyncInterval{1};
+	static atomic<uint64_t> sLastId;
+
+	bctbx_file_log_handler_t *mFileHandler;
+	const size_t mBufferSize;
+	/* Identifies the writer in the thread local rings, the address of a destroyed writer may be reused. */
+	const uint64_t mId;
+	thread mThread;
+	/* Number of flushAll() calls using the writer, guarded by the registry mutex. */
+	unsigned int mPinCount = 0;
+
+	mutex mRingsMutex;
+	vector<shared_ptr<LogRing>> mRings;
+
+	atomic<uint64_t> mDroppedCount{0};
+	uint64_t mReportedDroppedCount = 0;
+	atomic<bool> mWakeUpRequested{false};
+
+	mutex mMutex;
+	condition_variable mCondition;
+	condition_variable mFlushCondition;
+	bool mRunning = true;
+	uint64_t mFlushRequested = 0;
+	uint64_t mFlushDone = 0;
+};
+
+atomic<uint64_t> AsyncLogWriter::sLastId{0};
+
+} // namespace bctoolbox
+
+using namespace bctoolbox;
+
+bctbx_async_log_writer_t *bctbx_async_log_writer_new(bctbx_file_log_handler_t *filehandler, size_t buffer_size) {
+	return (bctbx_async_log_writer_t *)new AsyncLogWriter(filehandler, buffer_size);
+}
+
+void bctbx_async_log_writer_destroy(bctbx_async_log_writer_t *writer) {
+	delete (AsyncLogWriter *)writer;
+}
+
+bool_t bctbx_async_log_writer_push(bctbx_async_log_writer_t *writer,
+                                   const struct timeval *tp,
+                                   const char *domain,
+                                   BctbxLogLevel level,
+                                   const char *tags,
+                                   const char *msg) {
+	return ((AsyncLogWriter *)writer)->push(*tp, domain, level, tags, msg) ? TRUE : FALSE;
+}
+
+void bctbx_async_log_writer_flush(bctbx_async_log_writer_t *writer) {
+	((AsyncLogWriter *)writer)->flush();
+}
+
+uint64_t bctbx_async_log_writer_get_dropped_count(const bctbx_async_log_writer_t *writer) {
+	return ((const AsyncLogWriter *)writer)->getDroppedCount();
+}
+
+void bctbx_async_log_writers_flush(void) {
+	AsyncLogWriter::flushAll();
+}
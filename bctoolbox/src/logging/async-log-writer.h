@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016-2024 Belledonne Communications SARL.
+ *
+ * This file is part of bctoolbox.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BCTBX_ASYNC_LOG_WRITER_H
+#define BCTBX_ASYNC_LOG_WRITER_H
+
+#include "bctoolbox/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Size of the ring buffer of each logging thread, when not specified to bctbx_file_log_handler_set_async(). */
+#define BCTBX_ASYNC_LOG_DEFAULT_BUFFER_SIZE (256 * 1024)
+
+typedef struct _bctbx_file_log_handler_t bctbx_file_log_handler_t;
+typedef struct _bctbx_async_log_writer bctbx_async_log_writer_t;
+
+/*
+ * The asynchronous writer of a file log handler.
+ * Logging threads push their records into a ring buffer of their own, without taking any lock. A background thread
+ * drains the ring buffers in timestamp order and writes the records to the file through
+ * bctbx_file_log_handler_write(). Records that do not fit in the ring buffer of their thread are dropped and counted.
+ */
+bctbx_async_log_writer_t *bctbx_async_log_writer_new(bctbx_file_log_handler_t *filehandler, size_t buffer_size);
+
+/* Writes all pending records and stops the background thread. */
+void bctbx_async_log_writer_destroy(bctbx_async_log_writer_t *writer);
+
+/* Returns FALSE if the record was dropped because the ring buffer of the calling thread is full. */
+bool_t bctbx_async_log_writer_push(bctbx_async_log_writer_t *writer,
+                                   const struct timeval *tp,
+                                   const char *domain,
+                                   BctbxLogLevel level,
+                                   const char *tags,
+                                   const char *msg);
+
+/* Waits until the records pushed by the calling thread are written and synced to disk. */
+void bctbx_async_log_writer_flush(bctbx_async_log_writer_t *writer);
+
+uint64_t bctbx_async_log_writer_get_dropped_count(const bctbx_async_log_writer_t *writer);
+
+/* Flushes all the asynchronous writers of the process. */
+void bctbx_async_log_writers_flush(void);
+
+/* Implemented by logging.c, called from the background thread. */
+void bctbx_file_log_handler_write(bctbx_file_log_handler_t *filehandler,
+                                  const struct timeval *tp,
+                                  const char *domain,
+                                  BctbxLogLevel level,
+                                  const char *tags,
+                                  const char *msg);
+void bctbx_file_log_handler_sync(bctbx_file_log_handler_t *filehandler, bool_t to_disk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BCTBX_ASYNC_LOG_WRITER_H */
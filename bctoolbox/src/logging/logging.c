@@ -21,6 +21,7 @@
 #include "config.h"
 #endif
 
+#include "async-log-writer.h"
 #include "bctoolbox/defs.h"
 #include "bctoolbox/logging.h"
 
@@ -116,14 +117,15 @@ struct _bctbx_log_handler_t {
 	void *user_info;
 };
 
-typedef struct _bctbx_file_log_handler_t {
+struct _bctbx_file_log_handler_t {
 	char *path;
 	char *name;
 	uint64_t max_size;
 	uint64_t size;
 	FILE *file;
 	bool_t reopen_requested;
-} bctbx_file_log_handler_t;
+	bctbx_async_log_writer_t *async_writer; /* NULL unless asynchronous mode is enabled */
+};
 
 void bctbx_logv_out_cb(void *user_info, const char *domain, BctbxLogLevel lev, const char *fmt, va_list args);
 
@@ -256,6 +258,29 @@ void bctbx_file_log_handler_reopen(bctbx_log_handler_t *file_log_handler) {
 	bctbx_mutex_unlock(&logger->log_mutex);
 }
 
+void bctbx_file_log_handler_set_async(bctbx_log_handler_t *file_log_handler, bool_t enabled, size_t buffer_size) {
+	bctbx_file_log_handler_t *filehandler = (bctbx_file_log_handler_t *)file_log_handler->user_info;
+	if (file_log_handler->func != bctbx_logv_file || filehandler == NULL) {
+		bctbx_error("bctbx_file_log_handler_set_async(): [%p] is not a file log handler", file_log_handler);
+		return;
+	}
+	if (enabled && filehandler->async_writer == NULL) {
+		filehandler->async_writer = bctbx_async_log_writer_new(
+		    filehandler, buffer_size ? buffer_size : BCTBX_ASYNC_LOG_DEFAULT_BUFFER_SIZE);
+	} else if (!enabled && filehandler->async_writer != NULL) {
+		bctbx_async_log_writer_t *writer = filehandler->async_writer;
+		filehandler->async_writer = NULL;
+		bctbx_async_log_writer_destroy(writer);
+	}
+}
+
+uint64_t bctbx_file_log_handler_get_dropped_count(const bctbx_log_handler_t *file_log_handler) {
+	const bctbx_file_log_handler_t *filehandler = (const bctbx_file_log_handler_t *)file_log_handler->user_info;
+	if (file_log_handler->func != bctbx_logv_file || filehandler == NULL || filehandler->async_writer == NULL)
+		return 0;
+	return bctbx_async_log_writer_get_dropped_count(filehandler->async_writer);
+}
+
 /**
  *@param func: your logging function, compatible with the BctoolboxLogFunc prototype.
  *
@@ -542,6 +567,7 @@ void _bctbx_logv_flush(int dummy, ...) {
 
 void bctbx_logv_flush(void) {
 	_bctbx_logv_flush(0);
+	bctbx_async_log_writers_flush();
 }
 
 void bctbx_logv(const char *domain, BctbxLogLevel level, const char *fmt, va_list args) {
@@ -562,7 +588,8 @@ void bctbx_logv(const char *domain, BctbxLogLevel level, const char *fmt, va_lis
 			}
 		} else if (logger->log_thread_id == bctbx_thread_self()) {
 			bctbx_list_t *handlers;
-			bctbx_logv_flush();
+			/* the asynchronous writers are not waited for here, it would make every log synchronous */
+			_bctbx_logv_flush(0);
 			handlers = bctbx_list_first_elem(logger->logv_outs);
 			while (handlers) {
 				bctbx_log_handler_t *handler = (bctbx_log_handler_t *)handlers->data;
@@ -751,24 +778,40 @@ static char *format_tags(void) {
 	return tags_str;
 }
 
-void bctbx_logv_file(void *user_info, const char *domain, BctbxLogLevel lev, const char *fmt, va_list args) {
-	const char *lname = "undef";
-	char *msg = NULL;
-	char *tags = NULL;
-	struct timeval tp;
+static const char *file_log_level_name(BctbxLogLevel lev) {
+	switch (lev) {
+		case BCTBX_LOG_DEBUG:
+			return "debug";
+		case BCTBX_LOG_MESSAGE:
+			return "message";
+		case BCTBX_LOG_WARNING:
+			return "warning";
+		case BCTBX_LOG_ERROR:
+			return "error";
+		case BCTBX_LOG_FATAL:
+			return "fatal";
+		default:
+			return "badlevel";
+	}
+}
+
+/* Must be called with the log mutex held. */
+static void file_log_handler_output(bctbx_file_log_handler_t *filehandler,
+                                    const struct timeval *tp,
+                                    const char *domain,
+                                    BctbxLogLevel lev,
+                                    const char *tags,
+                                    const char *msg,
+                                    bool_t flush) {
 	struct tm *lt;
 #ifndef _WIN32
 	struct tm tmbuf;
 #endif
-	time_t tt;
-	int ret = -1;
-	bctbx_file_log_handler_t *filehandler = (bctbx_file_log_handler_t *)user_info;
-	bctbx_logger_t *logger = bctbx_get_logger();
-
-	bctbx_mutex_lock(&logger->log_mutex);
+	time_t tt = (time_t)tp->tv_sec;
+	int ret;
 	FILE *f = filehandler ? filehandler->file : stdout;
-	bctbx_gettimeofday(&tp, NULL);
-	tt = (time_t)tp.tv_sec;
+
+	if (!f) return;
 
 #ifdef _WIN32
 	lt = localtime(&tt);
@@ -776,27 +819,76 @@ void bctbx_logv_file(void *user_info, const char *domain, BctbxLogLevel lev, con
 	lt = localtime_r(&tt, &tmbuf);
 #endif
 
-	if (!f) goto end;
+	ret = fprintf(f, "%i-%.2i-%.2i %.2i:%.2i:%.2i:%.3i %s-%s-%s %s" ENDLINE, 1900 + lt->tm_year, 1 + lt->tm_mon,
+	              lt->tm_mday, lt->tm_hour, lt->tm_min, lt->tm_sec, (int)(tp->tv_usec / 1000),
+	              (domain ? domain : "bctoolbox"), file_log_level_name(lev), tags ? tags : "", msg);
+	if (flush) fflush(f);
 
-	switch (lev) {
-		case BCTBX_LOG_DEBUG:
-			lname = "debug";
-			break;
-		case BCTBX_LOG_MESSAGE:
-			lname = "message";
-			break;
-		case BCTBX_LOG_WARNING:
-			lname = "warning";
-			break;
-		case BCTBX_LOG_ERROR:
-			lname = "error";
-			break;
-		case BCTBX_LOG_FATAL:
-			lname = "fatal";
-			break;
-		default:
-			lname = "badlevel";
+	/* reopen the log file when either the size limit has been exceeded, or reopen has been required
+	   by the user. Reopening a log file that has reached the size limit automatically trigger log rotation
+	   while opening. */
+	if (filehandler) {
+		bool_t reopen_requested = filehandler->reopen_requested;
+		if (filehandler->max_size > 0 && ret > 0) {
+			filehandler->size += ret;
+			reopen_requested = reopen_requested || filehandler->size > filehandler->max_size;
+		}
+		if (reopen_requested) {
+			_close_log_collection_file(filehandler);
+			_open_log_collection_file(filehandler);
+			filehandler->reopen_requested = FALSE;
+		}
+	}
+}
+
+void bctbx_file_log_handler_write(bctbx_file_log_handler_t *filehandler,
+                                  const struct timeval *tp,
+                                  const char *domain,
+                                  BctbxLogLevel level,
+                                  const char *tags,
+                                  const char *msg) {
+	bctbx_logger_t *logger = bctbx_get_logger();
+	bctbx_mutex_lock(&logger->log_mutex);
+	file_log_handler_output(filehandler, tp, domain, level, tags, msg, FALSE);
+	bctbx_mutex_unlock(&logger->log_mutex);
+}
+
+void bctbx_file_log_handler_sync(bctbx_file_log_handler_t *filehandler, bool_t to_disk) {
+	bctbx_logger_t *logger = bctbx_get_logger();
+	bctbx_mutex_lock(&logger->log_mutex);
+	if (filehandler->file) {
+		fflush(filehandler->file);
+		if (to_disk) {
+#ifdef _WIN32
+			_commit(fileno(filehandler->file));
+#else
+			fsync(fileno(filehandler->file));
+#endif
+		}
 	}
+	bctbx_mutex_unlock(&logger->log_mutex);
+}
+
+void bctbx_logv_file(void *user_info, const char *domain, BctbxLogLevel lev, const char *fmt, va_list args) {
+	char *msg = NULL;
+	char *tags = NULL;
+	struct timeval tp;
+	bctbx_file_log_handler_t *filehandler = (bctbx_file_log_handler_t *)user_info;
+	bctbx_logger_t *logger = bctbx_get_logger();
+
+	bctbx_gettimeofday(&tp, NULL);
+	if (filehandler && filehandler->async_writer) {
+		/* only capture the record, the file is written by the background thread of the writer */
+		msg = bctbx_strdup_vprintf(fmt, args);
+		tags = format_tags();
+		bctbx_async_log_writer_push(filehandler->async_writer, &tp, domain, lev, tags, msg);
+		if (tags) bctbx_free(tags);
+		bctbx_free(msg);
+		return;
+	}
+
+	bctbx_mutex_lock(&logger->log_mutex);
+	if (filehandler && filehandler->file == NULL) goto end;
 
 	msg = bctbx_strdup_vprintf(fmt, args);
 #if defined(_MSC_VER) && !defined(_WIN32_WCE)
@@ -815,28 +907,9 @@ void bctbx_logv_file(void *user_info, const char *domain, BctbxLogLevel lev, con
 #endif
 #endif
 	tags = format_tags();
-	ret = fprintf(f, "%i-%.2i-%.2i %.2i:%.2i:%.2i:%.3i %s-%s-%s %s" ENDLINE, 1900 + lt->tm_year, 1 + lt->tm_mon,
-	              lt->tm_mday, lt->tm_hour, lt->tm_min, lt->tm_sec, (int)(tp.tv_usec / 1000),
-	              (domain ? domain : "bctoolbox"), lname, tags ? tags : "", msg);
-	fflush(f);
+	file_log_handler_output(filehandler, &tp, domain, lev, tags, msg, TRUE);
 	if (tags) bctbx_free(tags);
 
-	/* reopen the log file when either the size limit has been exceeded, or reopen has been required
-	   by the user. Reopening a log file that has reached the size limit automatically trigger log rotation
-	   while opening. */
-	if (filehandler) {
-		bool_t reopen_requested = filehandler->reopen_requested;
-		if (filehandler->max_size > 0 && ret > 0) {
-			filehandler->size += ret;
-			reopen_requested = reopen_requested || filehandler->size > filehandler->max_size;
-		}
-		if (reopen_requested) {
-			_close_log_collection_file(filehandler);
-			_open_log_collection_file(filehandler);
-			filehandler->reopen_requested = FALSE;
-		}
-	}
-
 end:
 	bctbx_mutex_unlock(&logger->log_mutex);
 	if (msg) bctbx_free(msg);
@@ -844,6 +917,10 @@ end:
 
 static void bctbx_handler_logv_file_uninit(bctbx_log_handler_t *handler) {
 	bctbx_file_log_handler_t *filehandler = (bctbx_file_log_handler_t *)handler->user_info;
+	if (filehandler->async_writer) {
+		bctbx_async_log_writer_destroy(filehandler->async_writer);
+		filehandler->async_writer = NULL;
+	}
 	fclose(filehandler->file);
 	bctbx_free(filehandler->path);
 	bctbx_free(filehandler->name);
@@ -25,8 +25,13 @@
 #include "vfs_encryption_module.hh"
 #include "vfs_encryption_module_aes256gcm_sha256.hh"
 #include "vfs_encryption_module_dummy.hh"
+#include "vfs_lru_cache.hh"
 #include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <thread>
 
 // MSVC does not define O_ACCMODE...
 #ifndef O_ACCMODE
@@ -119,6 +124,13 @@ static constexpr int64_t baseFileHeaderSize = 29;
 
 static constexpr size_t defaultChunkSize = 4096; // default chunk size in bytes
 
+/* Number of plain chunks kept in cache: 256kB with the default chunk size. It must be at least 2 as the first and last
+ * chunks of a write are held together */
+static constexpr size_t chunkCacheSize = 64;
+/* Reads of at least this number of complete chunks not in cache are decrypted in parallel */
+static constexpr uint32_t parallelDecryptionMinChunks = 16;
+static constexpr unsigned int maxDecryptionThreads = 4;
+
 /**
  * Initialiase the static callback property
  */
@@ -130,7 +142,8 @@ VfsEncryption::VfsEncryption(bctbx_vfs_file_t *stdFp, const std::string &filenam
                      // file, let a chance to the callback to set the chunk size.
       m_module(nullptr), // encryption module is set by callback or when parsing the header
       mHeaderExtensionSize(0), mFilename(filename), mFileSize(0), mEncryptExistingPlainFile(false),
-      mIntegrityFullCheck(false), mAccessMode(accessMode), pFileStd(stdFp) {
+      mIntegrityFullCheck(false), mAccessMode(accessMode), mHeaderDirty(false),
+      mChunkCache(std::make_unique<VfsLruCache<std::vector<uint8_t>>>(chunkCacheSize)), pFileStd(stdFp) {
 
 	if (stdFp == NULL) throw EVFS_EXCEPTION << "Cannot create a vfs encrytion object, vfs pointer is null";
 
@@ -166,34 +179,33 @@ VfsEncryption::VfsEncryption(bctbx_vfs_file_t *stdFp, const std::string &filenam
 		std::remove(tmpFilename.data());
 		auto stdFdTmp = bctbx_file_open2(bctbx_vfs_get_standard(), tmpFilename.data(), O_WRONLY | O_CREAT);
 		// read the whole file chunk by chunk and write their ciphertext to the temp file
-		char *readBuf = static_cast<char *>(bctbx_malloc(mChunkSize));
+		std::vector<uint8_t> readBuf(mChunkSize);
+		mRawBuffer.resize(rawChunkSizeGet());
 		uint64_t index = 0;
 
 		uint32_t currentChunkIndex = 0;
 		do {
 			// read
-			auto readSize = bctbx_file_read(pFileStd, readBuf, mChunkSize, static_cast<off_t>(index));
+			auto readSize = bctbx_file_read(pFileStd, readBuf.data(), mChunkSize, static_cast<off_t>(index));
 			if (readSize < 0) {
 				bctbx_file_close(stdFdTmp);
-				bctbx_free(readBuf);
 				throw EVFS_EXCEPTION << "Unable to migrate plain file " << mFilename << ". Could not read file";
 			}
 			index += readSize;
 			// encrypt
-			auto rawChunk =
-			    m_module->encryptChunk(currentChunkIndex, std::vector<uint8_t>(readBuf, readBuf + readSize));
+			m_module->encryptChunk(currentChunkIndex, mRawBuffer.data(), 0, readBuf.data(), (size_t)readSize);
 			// write
-			if (bctbx_file_write(stdFdTmp, rawChunk.data(), rawChunk.size(), (off_t)getChunkOffset(currentChunkIndex)) -
-			        rawChunk.size() !=
+			size_t rawChunkSize = m_module->getChunkHeaderSize() + (size_t)readSize;
+			if (bctbx_file_write(stdFdTmp, mRawBuffer.data(), rawChunkSize, (off_t)getChunkOffset(currentChunkIndex)) -
+			        rawChunkSize !=
 			    0) {
 				bctbx_file_close(stdFdTmp);
-				bctbx_free(readBuf);
 				throw EVFS_EXCEPTION << "Unable to migrate plain file " << mFilename
 				                     << ". Could not write to temporary file " << tmpFilename;
 			}
 			currentChunkIndex++;
 		} while (index < mFileSize);
-		bctbx_free(readBuf);
+		bctbx_clean(readBuf.data(), readBuf.size());
 
 		// write header and close
 		writeHeader(stdFdTmp);
@@ -216,24 +228,25 @@ VfsEncryption::VfsEncryption(bctbx_vfs_file_t *stdFp, const std::string &filenam
 				throw EVFS_EXCEPTION << "Integrity check fail while opening file " << mFilename;
 			} else {                               // header integrity is Ok
 				if (mIntegrityFullCheck == true) { // file size in header is wrong, check each chunk and update header
+					std::vector<uint8_t> plainData(mChunkSize);
+					mRawBuffer.resize(rawChunkSizeGet());
 					for (auto chunkIndex = getChunkIndex(mFileSize); chunkIndex > 0;
 					     chunkIndex--) { // start from last chunk
-						std::vector<uint8_t> rawData(rawChunkSizeGet());
-						ssize_t readSize = bctbx_file_read(pFileStd, rawData.data(), rawData.size(),
+						ssize_t readSize = bctbx_file_read(pFileStd, mRawBuffer.data(), mRawBuffer.size(),
 						                                   (off_t)getChunkOffset(chunkIndex));
-						if (readSize >= 0) {
-							rawData.resize(readSize);
-						} else {
+						if (readSize < 0) {
 							throw EVFS_EXCEPTION
 							    << "fail to read file while trying to check the full integrity, file_read returned "
 							    << readSize;
 						}
-
-						std::vector<uint8_t> plainData(mChunkSize);
+						if ((size_t)readSize < m_module->getChunkHeaderSize()) { // no chunk at this index
+							continue;
+						}
 
 						// decrypt the chunk, if it fails it will generate an exception, let it flow up
-						m_module->decryptChunk(chunkIndex, rawData);
+						m_module->decryptChunk(chunkIndex, mRawBuffer.data(), (size_t)readSize, plainData.data());
 					}
+					bctbx_clean(plainData.data(), plainData.size());
 					// all clear, update header
 					writeHeader();
 					BCTBX_SLOGW
@@ -249,6 +262,13 @@ VfsEncryption::VfsEncryption(bctbx_vfs_file_t *stdFp, const std::string &filenam
 }
 
 VfsEncryption::~VfsEncryption() {
+	if (mHeaderDirty) {
+		try {
+			writeHeader();
+		} catch (EvfsException const &e) { // the header is checked and fixed at next opening
+			BCTBX_SLOGE << "Encrypted VFS: cannot update header of file " << mFilename << " at closing. " << e;
+		}
+	}
 	if (pFileStd != nullptr) {
 		bctbx_file_close(pFileStd);
 	}
@@ -541,6 +561,9 @@ void VfsEncryption::writeHeader(bctbx_vfs_file_t *fp) {
 		throw EVFS_EXCEPTION << "Encrypted VFS: something went wrong while writing file header. file_write returns "
 		                     << ret << " but we expected " << header.size();
 	}
+	if (fp == nullptr) {
+		mHeaderDirty = false;
+	}
 }
 
 int64_t VfsEncryption::fileSizeGet() const noexcept {
@@ -571,161 +594,244 @@ size_t VfsEncryption::getChunkOffset(uint32_t index) const noexcept {
 	       + baseFileHeaderSize + mHeaderExtensionSize + m_module->getModuleFileHeaderSize();
 }
 
-std::vector<uint8_t> VfsEncryption::read(size_t offset, size_t count) const {
-	// plain file?
-	if (m_module == nullptr) {
-		std::vector<uint8_t> plain(count);
-		auto readSize = bctbx_file_read(pFileStd, plain.data(), plain.size(), (off_t)offset);
-		plain.resize(readSize);
-		return plain;
+std::vector<uint8_t> &VfsEncryption::plainChunkGet(uint32_t chunkIndex) const {
+	auto cachedChunk = mChunkCache->get(chunkIndex);
+	if (cachedChunk != nullptr) {
+		return *cachedChunk;
+	}
+
+	mRawBuffer.resize(rawChunkSizeGet());
+	ssize_t readSize =
+	    bctbx_file_read(pFileStd, mRawBuffer.data(), mRawBuffer.size(), (off_t)getChunkOffset(chunkIndex));
+	if (readSize < 0) {
+		throw EVFS_EXCEPTION << "fail to read file " << mFilename << " file_read returned " << readSize;
+	}
+	if ((size_t)readSize < m_module->getChunkHeaderSize()) {
+		throw EVFS_EXCEPTION << "fail to read chunk " << chunkIndex << " of file " << mFilename << ", it is only "
+		                     << readSize << " bytes long";
 	}
 
-	/* first compute how much of the actual file we must read */
-	uint32_t firstChunk = getChunkIndex(offset);
-	uint32_t lastChunk =
-	    getChunkIndex(offset + count - 1); // -1 as we read data from indexes offset to offset + count - 1
-	size_t offsetInFirstChunk = offset % mChunkSize;
+	auto &plainChunk = mChunkCache->insert(chunkIndex);
+	plainChunk.resize((size_t)readSize - m_module->getChunkHeaderSize());
+	try {
+		m_module->decryptChunk(chunkIndex, mRawBuffer.data(), (size_t)readSize, plainChunk.data());
+	} catch (...) { // do not keep a partially decrypted chunk
+		mChunkCache->erase(chunkIndex);
+		throw;
+	}
+	return plainChunk;
+}
 
-	// allocate a vector large enough to store all the data to read : number of chunks * size of raw
-	// chunk(payload+header)
-	std::vector<uint8_t> rawData((lastChunk - firstChunk + 1) * rawChunkSizeGet());
+void VfsEncryption::decryptChunks(uint32_t firstChunk, uint32_t chunkCount, uint8_t *plainData) const {
+	const size_t rawChunkSize = rawChunkSizeGet();
 
-	/* read all chunks from actual file */
-	ssize_t readSize = bctbx_file_read(pFileStd, rawData.data(), rawData.size(), (off_t)getChunkOffset(firstChunk));
+	/* read all chunks from actual file at once */
+	mRawBuffer.resize(chunkCount * rawChunkSize);
+	ssize_t readSize =
+	    bctbx_file_read(pFileStd, mRawBuffer.data(), mRawBuffer.size(), (off_t)getChunkOffset(firstChunk));
+	if (readSize < 0 || (size_t)readSize != mRawBuffer.size()) {
+		throw EVFS_EXCEPTION << "fail to read file " << mFilename << " file_read returned " << readSize << " but "
+		                     << mRawBuffer.size() << " bytes were expected";
+	}
 
-	/* resize rawData to the actual content size - last chunk may be incomplete */
-	if (readSize >= 0) {
-		rawData.resize(readSize);
-	} else {
-		throw EVFS_EXCEPTION << "fail to read file " << mFilename << " file_read returned " << readSize;
+	// decrypt the chunks in [begin, end[, relative to firstChunk
+	auto decryptSlice = [this, firstChunk, rawChunkSize, plainData](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			m_module->decryptChunk(firstChunk + i, mRawBuffer.data() + i * rawChunkSize, rawChunkSize,
+			                       plainData + i * mChunkSize);
+		}
+	};
+
+	unsigned int threadCount = 1;
+	if (chunkCount >= parallelDecryptionMinChunks) {
+		threadCount = std::min(maxDecryptionThreads, std::max(1U, std::thread::hardware_concurrency()));
+	}
+	uint32_t sliceSize = (chunkCount + threadCount - 1) / threadCount;
+
+	// the first slice is decrypted by the calling thread, the others by worker threads
+	std::vector<std::future<void>> workers;
+	for (uint32_t begin = sliceSize; begin < chunkCount; begin += sliceSize) {
+		workers.push_back(std::async(std::launch::async, decryptSlice, begin, std::min(begin + sliceSize, chunkCount)));
+	}
+	std::exception_ptr error = nullptr;
+	try {
+		decryptSlice(0, std::min(sliceSize, chunkCount));
+	} catch (...) {
+		error = std::current_exception();
 	}
+	for (auto &worker : workers) { // all workers must be done before leaving as they use our buffers
+		try {
+			worker.get();
+		} catch (...) {
+			if (error == nullptr) error = std::current_exception();
+		}
+	}
+	if (error != nullptr) {
+		std::rethrow_exception(error);
+	}
+}
 
-	std::vector<uint8_t> plainData{};
-	plainData.reserve((lastChunk - firstChunk + 1) * mChunkSize);
+size_t VfsEncryption::read(uint8_t *plainData, size_t count, size_t offset) const {
+	// plain file?
+	if (m_module == nullptr) {
+		auto readSize = bctbx_file_read(pFileStd, plainData, count, (off_t)offset);
+		if (readSize < 0) {
+			throw EVFS_EXCEPTION << "fail to read plain file " << mFilename << " file_read returned " << readSize;
+		}
+		return (size_t)readSize;
+	}
 
-	// decrypt everything we have chunk by chunk, use firstChunk as chunk index
-	while (rawData.size() > m_module->getChunkHeaderSize()) {
-		std::vector<uint8_t> plainChunk = m_module->decryptChunk(
-		    firstChunk++,
-		    std::vector<uint8_t>(rawData.cbegin(), rawData.cbegin() + std::min(rawChunkSizeGet(), rawData.size())));
-		plainData.insert(plainData.end(), plainChunk.cbegin(), plainChunk.cend());
-		// remove the decrypted chunk
-		rawData.erase(rawData.begin(), rawData.begin() + std::min(rawChunkSizeGet(), rawData.size()));
+	// do not read after the end of file
+	if (offset >= mFileSize) {
+		return 0;
 	}
+	count = (size_t)std::min(static_cast<uint64_t>(count), mFileSize - offset);
+
+	size_t readSize = 0;
+	while (readSize < count) {
+		uint32_t chunkIndex = getChunkIndex(offset + readSize);
+		size_t offsetInChunk = (offset + readSize) % mChunkSize;
+
+		// large reads of complete chunks not in cache are decrypted directly in the given buffer
+		if (offsetInChunk == 0) {
+			uint32_t completeChunks = static_cast<uint32_t>((count - readSize) / mChunkSize);
+			uint32_t chunkCount = 0;
+			while (chunkCount < completeChunks && !mChunkCache->contains(chunkIndex + chunkCount)) {
+				chunkCount++;
+			}
+			if (chunkCount >= parallelDecryptionMinChunks) {
+				decryptChunks(chunkIndex, chunkCount, plainData + readSize);
+				readSize += chunkCount * mChunkSize;
+				continue;
+			}
+		}
 
-	// return only the requested part
-	plainData.erase(plainData.begin(),
-	                plainData.begin() +
-	                    std::min(offsetInFirstChunk, plainData.size())); // remove unwanted chunk begining
-	if (count < plainData.size()) {                                      // if we have too much data, remove the end
-		plainData.erase(plainData.begin() + count, plainData.end());
+		const auto &plainChunk = plainChunkGet(chunkIndex);
+		size_t size = std::min(mChunkSize - offsetInChunk, count - readSize);
+		if (plainChunk.size() < offsetInChunk + size) {
+			throw EVFS_EXCEPTION << "fail to read file " << mFilename << ", chunk " << chunkIndex << " is too short";
+		}
+		memcpy(plainData + readSize, plainChunk.data() + offsetInChunk, size);
+		readSize += size;
 	}
-	return plainData;
+	return readSize;
 }
 
-size_t VfsEncryption::write(const std::vector<uint8_t> &plainData, size_t offset) {
+size_t VfsEncryption::write(const uint8_t *plainData, size_t count, size_t offset) {
 	// plain file?
 	if (m_module == nullptr) {
-		ssize_t ret = bctbx_file_write(pFileStd, plainData.data(), plainData.size(), (off_t)offset);
-		if (ret - plainData.size() == 0) { // compare signed and unsigned
-			return plainData.size();
+		ssize_t ret = bctbx_file_write(pFileStd, plainData, count, (off_t)offset);
+		if (ret - count == 0) { // compare signed and unsigned
+			return count;
 		} else {
 			throw EVFS_EXCEPTION << "plain file fail to write to physical file " << ret;
 		}
 	}
 
-	auto plain = plainData; // work on a local copy as we may modify it
-	uint64_t finalFileSize = std::max(
-	    mFileSize, static_cast<decltype(mFileSize)>(plain.size() + offset)); // we might need to increase the file size
-
-	// Are we writing after the end of the file, if yes, prepend with zeros
+	// Are we writing after the end of the file, if yes, fill the gap with zeros one chunk at a time
 	if (offset > mFileSize) {
-		plain.insert(plain.begin(), offset - static_cast<size_t>(mFileSize), 0);
-		offset = static_cast<size_t>(mFileSize);
-	}
-
-	uint32_t firstChunk = getChunkIndex(offset);
-	uint32_t lastChunk =
-	    getChunkIndex(offset + plain.size() - 1); // -1 as we write data from indexes offset to offset + data size - 1
-	size_t rawDataSize =
-	    (lastChunk - firstChunk + 1) * rawChunkSizeGet(); // maximum size used, last chunk might be incomplete
-	std::vector<uint8_t>
-	    rawData{}; // Store the existing encrypted chunks with header that are overwritten by this operation
-
-	// Are we overwritting some chunks?
-	size_t readOffset = offset - offset % mChunkSize; // we must start read/write at the begining of a chunk
-
-	if (readOffset < mFileSize) { // Yes we are overwritting some data, read all the existing chunks we are overwritting
-		rawData.resize(rawDataSize);
-		ssize_t overwrittenSize =
-		    bctbx_file_read(pFileStd, rawData.data(), rawDataSize, (off_t)getChunkOffset(firstChunk));
-		rawData.resize(overwrittenSize);
-		rawData.shrink_to_fit();
-	}
-
-	// prepend the plain buffer if needed
-	if (readOffset < offset) { // we need to get the plain data from readOffset to offset
-		// decrypt the first chunk
-		auto plainChunk = m_module->decryptChunk(
-		    firstChunk,
-		    std::vector<uint8_t>(rawData.cbegin(), rawData.cbegin() + std::min(rawChunkSizeGet(), rawData.size())));
-		plain.insert(plain.begin(), plainChunk.cbegin(),
-		             plainChunk.cbegin() + (offset - readOffset)); // prepend the begining to our plain buffer
-	}
-
-	// append the plain buffer if needed:
-	if ((plain.size() % mChunkSize != 0) &&
-	    (plain.size() + readOffset < mFileSize)) { // We do not have an integer number of chunks to write and we have
-		                                           // data after our last written byte
-		auto plainChunk = m_module->decryptChunk(
-		    lastChunk,
-		    std::vector<uint8_t>(rawData.cbegin() + getChunkOffset(lastChunk) - getChunkOffset(firstChunk),
-		                         rawData.cbegin() + std::min(getChunkOffset(lastChunk + 1) - getChunkOffset(firstChunk),
-		                                                     rawData.size())));
-		plain.insert(plain.end(), plainChunk.cbegin() + (plain.size() % mChunkSize),
-		             plainChunk.cend()); // append what is over the part we will write.
-	}
-
-	// encrypt the overwritten chunks
-	std::vector<uint8_t> updatedRawData{};
-	updatedRawData.reserve(rawDataSize);
-	uint32_t currentChunkIndex = firstChunk;
-	while (rawData.size() > 0) {
-		// get a chunk to re-encrypt
-		std::vector<uint8_t> rawChunk(rawData.cbegin(), rawData.cbegin() + std::min(rawChunkSizeGet(), rawData.size()));
-		// delete it
-		rawData.erase(rawData.begin(), rawData.begin() + std::min(rawChunkSizeGet(), rawData.size()));
-		// re-encrypt
-		m_module->encryptChunk(
-		    currentChunkIndex++, rawChunk,
-		    std::vector<uint8_t>(plain.cbegin(), plain.cbegin() + std::min(mChunkSize, plain.size())));
-		// delete consumed plain
-		plain.erase(plain.begin(), plain.begin() + std::min(mChunkSize, plain.size()));
-		// store the result
-		updatedRawData.insert(updatedRawData.end(), rawChunk.cbegin(), rawChunk.cend());
-	}
-
-	// add new chunks if some data remains in the plain buffer
-	while (plain.size() > 0) {
-		auto rawChunk = m_module->encryptChunk(
-		    currentChunkIndex++,
-		    std::vector<uint8_t>(plain.cbegin(), plain.cbegin() + std::min(mChunkSize, plain.size())));
-		// delete consumed plain
-		plain.erase(plain.begin(), plain.begin() + std::min(mChunkSize, plain.size()));
-		// store the result
-		updatedRawData.insert(updatedRawData.end(), rawChunk.cbegin(), rawChunk.cend());
-	}
-
-	// now actually write the rawData in the file
-	ssize_t ret =
-	    bctbx_file_write(pFileStd, updatedRawData.data(), updatedRawData.size(), (off_t)getChunkOffset(firstChunk));
-	if (ret - updatedRawData.size() == 0) { // compare signed and unsigned
-		mFileSize = finalFileSize;
-		writeHeader();
-		return plainData.size();
-	} else {
-		throw EVFS_EXCEPTION << "fail to write to physical file " << mFilename << " file_write " << ret;
+		std::vector<uint8_t> zeros(mChunkSize, 0);
+		while (offset > mFileSize) {
+			size_t size = (size_t)std::min(static_cast<uint64_t>(mChunkSize - mFileSize % mChunkSize),
+			                               static_cast<uint64_t>(offset) - mFileSize);
+			write(zeros.data(), size, (size_t)mFileSize);
+		}
+	}
+	if (count == 0) {
+		return 0;
+	}
+
+	const uint64_t endOffset = static_cast<uint64_t>(offset) + count;
+	const uint32_t firstChunk = getChunkIndex(offset);
+	const uint32_t lastChunk = getChunkIndex(endOffset - 1); // -1 as we write data from offset to offset + count - 1
+	const size_t rawChunkSize = rawChunkSizeGet();
+	const size_t chunkHeaderSize = m_module->getChunkHeaderSize();
+
+	try {
+		// Only the first and last chunks may be partially overwritten: merge them with their current content, in cache
+		// Chunks are complete when they are not the last one, so we only keep the existing data after our last byte
+		auto isPartial = [this, offset, endOffset](uint32_t chunkIndex) {
+			uint64_t chunkBegin = static_cast<uint64_t>(chunkIndex) * mChunkSize;
+			uint64_t existingEnd = std::min(chunkBegin + mChunkSize, mFileSize);
+			return (offset > chunkBegin) || (endOffset < existingEnd);
+		};
+		std::vector<uint8_t> *firstPlainChunk = nullptr;
+		std::vector<uint8_t> *lastPlainChunk = nullptr;
+		if (isPartial(firstChunk)) {
+			firstPlainChunk = &plainChunkGet(firstChunk);
+		}
+		if (lastChunk != firstChunk && isPartial(lastChunk)) {
+			lastPlainChunk = &plainChunkGet(lastChunk);
+		}
+		auto merge = [this, plainData, offset, endOffset](std::vector<uint8_t> &plainChunk, uint32_t chunkIndex) {
+			uint64_t chunkBegin = static_cast<uint64_t>(chunkIndex) * mChunkSize;
+			uint64_t writeBegin = std::max(chunkBegin, static_cast<uint64_t>(offset));
+			uint64_t writeEnd = std::min(chunkBegin + mChunkSize, endOffset);
+			if (plainChunk.size() < writeEnd - chunkBegin) {
+				plainChunk.resize((size_t)(writeEnd - chunkBegin));
+			}
+			memcpy(plainChunk.data() + (writeBegin - chunkBegin), plainData + (writeBegin - offset),
+			       (size_t)(writeEnd - writeBegin));
+		};
+		if (firstPlainChunk != nullptr) merge(*firstPlainChunk, firstChunk);
+		if (lastPlainChunk != nullptr) merge(*lastPlainChunk, lastChunk);
+
+		// Some modules re-encrypt a chunk using its previous header: read the overwritten chunks
+		mRawBuffer.resize((lastChunk - firstChunk + 1) * rawChunkSize);
+		size_t existingRawSize = 0;
+		if (m_module->isRawChunkNeededToReencrypt() && static_cast<uint64_t>(firstChunk) * mChunkSize < mFileSize) {
+			ssize_t readSize =
+			    bctbx_file_read(pFileStd, mRawBuffer.data(), mRawBuffer.size(), (off_t)getChunkOffset(firstChunk));
+			if (readSize < 0) {
+				throw EVFS_EXCEPTION << "fail to read file " << mFilename << " file_read returned " << readSize;
+			}
+			existingRawSize = (size_t)readSize;
+		}
+
+		// encrypt all chunks in place in the raw buffer: complete ones directly from the given plain buffer
+		size_t rawDataSize = 0;
+		for (uint32_t chunkIndex = firstChunk; chunkIndex <= lastChunk; chunkIndex++) {
+			const uint8_t *plainChunk = nullptr;
+			size_t plainChunkSize = 0;
+			if (chunkIndex == firstChunk && firstPlainChunk != nullptr) {
+				plainChunk = firstPlainChunk->data();
+				plainChunkSize = firstPlainChunk->size();
+			} else if (chunkIndex == lastChunk && lastPlainChunk != nullptr) {
+				plainChunk = lastPlainChunk->data();
+				plainChunkSize = lastPlainChunk->size();
+			} else {
+				uint64_t chunkBegin = static_cast<uint64_t>(chunkIndex) * mChunkSize;
+				plainChunk = plainData + (chunkBegin - offset);
+				plainChunkSize = (size_t)(std::min(chunkBegin + mChunkSize, endOffset) - chunkBegin);
+				auto cachedChunk = mChunkCache->get(chunkIndex); // keep the cache up to date
+				if (cachedChunk != nullptr) {
+					cachedChunk->assign(plainChunk, plainChunk + plainChunkSize);
+				}
+			}
+			size_t rawOffset = (chunkIndex - firstChunk) * rawChunkSize;
+			size_t existingRawChunkSize =
+			    (existingRawSize > rawOffset) ? std::min(rawChunkSize, existingRawSize - rawOffset) : 0;
+			m_module->encryptChunk(chunkIndex, mRawBuffer.data() + rawOffset, existingRawChunkSize, plainChunk,
+			                       plainChunkSize);
+			rawDataSize = rawOffset + chunkHeaderSize + plainChunkSize;
+		}
+
+		// now actually write the rawData in the file
+		ssize_t ret = bctbx_file_write(pFileStd, mRawBuffer.data(), rawDataSize, (off_t)getChunkOffset(firstChunk));
+		if (ret - rawDataSize != 0) { // compare signed and unsigned
+			throw EVFS_EXCEPTION << "fail to write to physical file " << mFilename << " file_write " << ret;
+		}
+	} catch (...) { // the cache may hold data that did not make it to the file
+		mChunkCache->clear();
+		throw;
 	}
+
+	// The header is updated by sync or when the file is closed: if it is not, the file size is checked at opening
+	if (endOffset > mFileSize) {
+		mFileSize = endOffset;
+		mHeaderDirty = true;
+	}
+	return count;
 }
 
 void VfsEncryption::truncate(const uint64_t newSize) {
@@ -737,46 +843,62 @@ void VfsEncryption::truncate(const uint64_t newSize) {
 
 	// if current size is smaller, just write 0 at the end
 	if (mFileSize < newSize) {
-		write(std::vector<uint8_t>{},
-		      static_cast<size_t>(newSize)); // write nothing at new size index, the gap is filled with 0 by write
+		write(nullptr, 0, static_cast<size_t>(newSize)); // write nothing at new size index, the gap is filled with 0
 		return;
 	}
 
 	if (mFileSize > newSize) {
-		// If the last chunk is modified, we must re-encrypt it
-		if (newSize % mChunkSize != 0) {
-			// allocate a vector large enough to store a complete chunk
-			std::vector<uint8_t> rawData(rawChunkSizeGet());
-
-			// read the future last chunk from actual file
-			ssize_t readSize = bctbx_file_read(pFileStd, rawData.data(), rawData.size(),
-			                                   (off_t)getChunkOffset(getChunkIndex(newSize)));
-			rawData.resize(readSize);
-			// decrypt it
-			auto plainLastChunk = m_module->decryptChunk(
-			    getChunkIndex(newSize),
-			    std::vector<uint8_t>(rawData.cbegin(), rawData.cbegin() + std::min(rawChunkSizeGet(), rawData.size())));
-			// truncate the part we don't need anymore
-			plainLastChunk.resize(newSize % mChunkSize);
-			// re-encrypt it
-			m_module->encryptChunk(getChunkIndex(newSize), rawData,
-			                       std::vector<uint8_t>(plainLastChunk.cbegin(), plainLastChunk.cend()));
-
-			/* write it to the actual file */
-			if (bctbx_file_write(pFileStd, rawData.data(), rawData.size(),
-			                     (off_t)getChunkOffset(getChunkIndex(newSize))) -
-			        rawData.size() !=
-			    0) {
-				throw EVFS_EXCEPTION << "Cannot write file " << mFilename << " during truncate";
+		uint32_t lastChunk = getChunkIndex(newSize);
+		try {
+			// If the last chunk is modified, we must re-encrypt it
+			if (newSize % mChunkSize != 0) {
+				auto &plainLastChunk = plainChunkGet(lastChunk);
+				// truncate the part we don't need anymore
+				plainLastChunk.resize(newSize % mChunkSize);
+
+				mRawBuffer.resize(rawChunkSizeGet());
+				size_t existingRawChunkSize = 0;
+				if (m_module->isRawChunkNeededToReencrypt()) {
+					ssize_t readSize = bctbx_file_read(pFileStd, mRawBuffer.data(), mRawBuffer.size(),
+					                                   (off_t)getChunkOffset(lastChunk));
+					if (readSize < 0) {
+						throw EVFS_EXCEPTION << "Cannot read file " << mFilename << " during truncate";
+					}
+					existingRawChunkSize = (size_t)readSize;
+				}
+				// re-encrypt it
+				m_module->encryptChunk(lastChunk, mRawBuffer.data(), existingRawChunkSize, plainLastChunk.data(),
+				                       plainLastChunk.size());
+
+				/* write it to the actual file */
+				size_t rawChunkSize = m_module->getChunkHeaderSize() + plainLastChunk.size();
+				if (bctbx_file_write(pFileStd, mRawBuffer.data(), rawChunkSize, (off_t)getChunkOffset(lastChunk)) -
+				        rawChunkSize !=
+				    0) {
+					throw EVFS_EXCEPTION << "Cannot write file " << mFilename << " during truncate";
+				}
+				lastChunk++;
 			}
+		} catch (...) {
+			mChunkCache->clear();
+			throw;
 		}
+		// drop the chunks after the new end of file
+		mChunkCache->eraseFrom(lastChunk);
 		// update file size in meta data
 		mFileSize = newSize;
 		// truncate the actual file
 		bctbx_file_truncate(pFileStd, rawFileSizeGet());
-		// update the header
+		// the header is updated by sync or when the file is closed
+		mHeaderDirty = true;
+	}
+}
+
+int VfsEncryption::sync() {
+	if (mHeaderDirty) {
 		writeHeader();
 	}
+	return bctbx_file_sync(pFileStd);
 }
 
 std::string VfsEncryption::filenameGet() const noexcept {
@@ -832,7 +954,11 @@ static int bcClose(bctbx_vfs_file_t *pFile) {
 static int bcSync(bctbx_vfs_file_t *pFile) {
 	if (pFile && pFile->pUserData) {
 		VfsEncryption *ctx = static_cast<VfsEncryption *>(pFile->pUserData);
-		return bctbx_file_sync(ctx->pFileStd);
+		try {
+			return ctx->sync();
+		} catch (EvfsException const &e) { // cannot let raise an exception to a C context
+			BCTBX_SLOGE << "Encrypted VFS: error while syncing file " << ctx->filenameGet() << ". " << e;
+		}
 	}
 	return BCTBX_VFS_ERROR;
 }
@@ -853,10 +979,7 @@ static ssize_t bcRead(bctbx_vfs_file_t *pFile, void *buf, size_t count, off_t of
 		VfsEncryption *ctx = static_cast<VfsEncryption *>(pFile->pUserData);
 
 		try {
-			auto readBuffer = ctx->read(offset, count);
-
-			memcpy(buf, readBuffer.data(), readBuffer.size());
-			return (ssize_t)readBuffer.size();
+			return (ssize_t)ctx->read(static_cast<uint8_t *>(buf), count, offset);
 		} catch (EvfsException const &e) { // cannot let raise an exception to a C context
 			BCTBX_SLOGE << "Encrypted VFS: error while reading " << count << " bytes from file " << ctx->filenameGet()
 			            << " at offset " << offset << ". " << e;
@@ -879,9 +1002,12 @@ static ssize_t bcWrite(bctbx_vfs_file_t *pFile, const void *buf, size_t count, o
 	if (offset < 0) return BCTBX_VFS_ERROR;
 	if (pFile && pFile->pUserData) {
 		VfsEncryption *ctx = static_cast<VfsEncryption *>(pFile->pUserData);
-		return (ssize_t)ctx->write(std::vector<uint8_t>(reinterpret_cast<const uint8_t *>(buf),
-		                                                reinterpret_cast<const uint8_t *>(buf) + count),
-		                           offset);
+		try {
+			return (ssize_t)ctx->write(static_cast<const uint8_t *>(buf), count, offset);
+		} catch (EvfsException const &e) { // cannot let raise an exception to a C context
+			BCTBX_SLOGE << "Encrypted VFS: error while writing " << count << " bytes to file " << ctx->filenameGet()
+			            << " at offset " << offset << ". " << e;
+		}
 	}
 	return BCTBX_VFS_ERROR;
 }
@@ -58,25 +58,37 @@ public:
 
 	/**
 	 * Decrypt a data chunk
-	 * @param[in] a vector which size shall be chunkHeaderSize + chunkSize holding the raw data read from disk
-	 * @return the decrypted data chunk
+	 * This function may be called concurrently on different chunks.
+	 * @param[in]	chunkIndex	The chunk index
+	 * @param[in]	rawChunk	The raw data read from disk: the chunk header followed by the cipher text
+	 * @param[in]	rawChunkSize	The raw chunk size: chunkHeaderSize + at most chunkSize bytes
+	 * @param[out]	plainData	A buffer of rawChunkSize - chunkHeaderSize bytes to store the decrypted chunk
 	 */
-	virtual std::vector<uint8_t> decryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &rawChunk) = 0;
+	virtual void decryptChunk(const uint32_t chunkIndex,
+	                          const uint8_t *rawChunk,
+	                          const size_t rawChunkSize,
+	                          uint8_t *plainData) = 0;
 
 	/**
-	 * ReEncrypt a data chunk
-	 * @param[in/out] rawChunk	The existing encrypted chunk
-	 * @param[in]     plainData	The plain text to be encrypted
+	 * Encrypt a data chunk
+	 * @param[in]		chunkIndex	The chunk index
+	 * @param[in/out]	rawChunk	On input, the existing encrypted chunk when re-encrypting one. On output, the
+	 * encrypted chunk: chunkHeaderSize + plainDataSize bytes
+	 * @param[in]		existingRawChunkSize	The size of the existing encrypted chunk, 0 to encrypt a new chunk
+	 * @param[in]		plainData	The plain text to be encrypted
+	 * @param[in]		plainDataSize	The plain text size, at most chunkSize bytes
 	 */
-	virtual void
-	encryptChunk(const uint32_t chunkIndex, std::vector<uint8_t> &rawChunk, const std::vector<uint8_t> &plainData) = 0;
+	virtual void encryptChunk(const uint32_t chunkIndex,
+	                          uint8_t *rawChunk,
+	                          const size_t existingRawChunkSize,
+	                          const uint8_t *plainData,
+	                          const size_t plainDataSize) = 0;
+
 	/**
-	 * Encrypt a new data chunk
-	 * @param[in]	chunkIndex	The chunk index
-	 * @param[in]	plainData	The plain text to be encrypted
-	 * @return the encrypted chunk
+	 * @return true if encryptChunk() needs the existing encrypted chunk to re-encrypt it, false if the chunk is
+	 * encrypted again from scratch
 	 */
-	virtual std::vector<uint8_t> encryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &plainData) = 0;
+	virtual bool isRawChunkNeededToReencrypt() const noexcept = 0;
 
 	/**
 	 * Check the integrity over the whole file
@@ -20,6 +20,7 @@
 #include "vfs_encryption_module_aes256gcm_sha256.hh"
 #include "bctoolbox/crypto.h" // bctbx_clean
 #include "bctoolbox/crypto.hh"
+#include "bctoolbox/defs.h"
 #include <algorithm>
 #include <functional>
 
@@ -46,17 +47,23 @@ static constexpr size_t fileHeaderSize = fileSaltSize + fileAuthTagSize;
  */
 static constexpr size_t masterKeySize = 32;
 
+/**
+ * Number of derived chunk keys kept in cache: 32kB of keys, covering 4MB of file with the default chunk size
+ */
+static constexpr size_t chunkKeysCacheSize = 1024;
+static_assert(AES256GCM128::keySize() == 32, "chunk keys cache stores 32 bytes keys");
+
 /** constructor called at file creation */
 VfsEM_AES256GCM_SHA256::VfsEM_AES256GCM_SHA256()
     : mRNG(std::make_shared<bctoolbox::RNG>()), // start the local RNG
-      mFileSalt(mRNG->randomize(fileSaltSize))  // generate a random file Salt
-{
+      mFileSalt(mRNG->randomize(fileSaltSize)), // generate a random file Salt
+      sChunkKeys(chunkKeysCacheSize) {
 }
 
 /** constructor called when opening an existing file */
 VfsEM_AES256GCM_SHA256::VfsEM_AES256GCM_SHA256(const std::vector<uint8_t> &fileHeader)
     : mRNG(std::make_shared<bctoolbox::RNG>()), // start the local RNG
-      mFileSalt(std::vector<uint8_t>(fileSaltSize)) {
+      mFileSalt(std::vector<uint8_t>(fileSaltSize)), sChunkKeys(chunkKeysCacheSize) {
 	if (fileHeader.size() != fileHeaderSize) {
 		throw EVFS_EXCEPTION << "The AES256GCM128-SHA256 encryption module expect a fileHeader of size "
 		                     << fileHeaderSize << " bytes but " << fileHeader.size() << " are provided";
@@ -93,6 +100,10 @@ void VfsEM_AES256GCM_SHA256::setModuleSecretMaterial(const std::vector<uint8_t>
 		                     << masterKeySize << " bytes but " << secret.size() << " are provided";
 	}
 	sMasterKey = secret;
+	{
+		std::lock_guard<std::mutex> lock(mChunkKeysMutex);
+		sChunkKeys.clear();
+	}
 
 	// Now that we have a master key, we can derive the header authentication one
 	sFileHeaderHMACKey = bctoolbox::HKDF<SHA256>(mFileSalt, sMasterKey, "EVFS file Header", masterKeySize);
@@ -103,82 +114,89 @@ void VfsEM_AES256GCM_SHA256::setModuleSecretMaterial(const std::vector<uint8_t>
  * HKDF(fileSalt || ChunkIndex, master Key, "EVFS chunk")
  *
  * @param[in]	chunkIndex	the chunk index used in key derivation
- *
- * @return	the AES256-GCM128 key
+ * @param[out]	key		the AES256-GCM128 key
  */
-std::vector<uint8_t> VfsEM_AES256GCM_SHA256::deriveChunkKey(uint32_t chunkIndex) {
+void VfsEM_AES256GCM_SHA256::deriveChunkKey(uint32_t chunkIndex, ChunkKey &key) {
+	{
+		std::lock_guard<std::mutex> lock(mChunkKeysMutex);
+		auto cachedKey = sChunkKeys.get(chunkIndex);
+		if (cachedKey != nullptr) {
+			key = *cachedKey;
+			return;
+		}
+	}
+
 	std::vector<uint8_t> chunkSalt{mFileSalt};
 	chunkSalt.push_back((chunkIndex >> 24) & 0xFF);
 	chunkSalt.push_back((chunkIndex >> 16) & 0xFF);
 	chunkSalt.push_back((chunkIndex >> 8) & 0xFF);
 	chunkSalt.push_back(chunkIndex & 0xFF);
-	return bctoolbox::HKDF<SHA256>(chunkSalt, sMasterKey, "EVFS chunk", AES256GCM128::keySize());
+	auto derivedKey = bctoolbox::HKDF<SHA256>(chunkSalt, sMasterKey, "EVFS chunk", AES256GCM128::keySize());
+	std::copy(derivedKey.cbegin(), derivedKey.cend(), key.begin());
+	bctbx_clean(derivedKey.data(), derivedKey.size());
+
+	std::lock_guard<std::mutex> lock(mChunkKeysMutex);
+	sChunkKeys.insert(chunkIndex) = key;
 }
 
-std::vector<uint8_t> VfsEM_AES256GCM_SHA256::decryptChunk(const uint32_t chunkIndex,
-                                                          const std::vector<uint8_t> &rawChunk) {
+void VfsEM_AES256GCM_SHA256::decryptChunk(const uint32_t chunkIndex,
+                                          const uint8_t *rawChunk,
+                                          const size_t rawChunkSize,
+                                          uint8_t *plainData) {
 	if (sMasterKey.empty()) {
 		throw EVFS_EXCEPTION << "No encryption Master key set, cannot decrypt";
 	}
+	if (rawChunkSize < chunkHeaderSize) {
+		throw EVFS_EXCEPTION << "Chunk " << chunkIndex << " is too short to be decrypted: " << rawChunkSize << " bytes";
+	}
 
 	// derive the key : HKDF (fileHeaderSalt || Chunk Index, Master key, "EVFS chunk")
-	std::vector<uint8_t> key{deriveChunkKey(chunkIndex)};
-
-	// parse the header: tag, IV, encryption Counter
-	std::vector<uint8_t> tag(AES256GCM128::tagSize());
-	std::copy(rawChunk.cbegin(), rawChunk.cbegin() + chunkAuthTagSize, tag.begin());
-	std::vector<uint8_t> IV(rawChunk.cbegin() + chunkAuthTagSize, rawChunk.cbegin() + chunkAuthTagSize + chunkIVSize);
-	std::vector<uint8_t> AD{}; // No associated data
+	ChunkKey key;
+	deriveChunkKey(chunkIndex, key);
 
-	// extract cipher
-	std::vector<uint8_t> cipher(rawChunk.cbegin() + chunkHeaderSize, rawChunk.cend());
-
-	// decrypt and auth
-	std::vector<uint8_t> plain;
-	if (AEADDecrypt<AES256GCM128>(key, IV, cipher, AD, tag, plain) == false) {
-		throw EVFS_EXCEPTION << "Authentication failure during chunk decryption";
-	}
+	// the chunk header is: tag, IV. No associated data. Decrypt and auth
+	int ret = bctbx_aes_gcm_decrypt_and_auth(key.data(), key.size(), rawChunk + chunkHeaderSize,
+	                                         rawChunkSize - chunkHeaderSize, nullptr, 0, rawChunk + chunkAuthTagSize,
+	                                         chunkIVSize, rawChunk, chunkAuthTagSize, plainData);
 
 	// cleaning
 	bctbx_clean(key.data(), key.size());
 
-	return plain;
+	if (ret == BCTBX_ERROR_AUTHENTICATION_FAILED) {
+		throw EVFS_EXCEPTION << "Authentication failure during chunk decryption";
+	} else if (ret != 0) {
+		throw EVFS_EXCEPTION << "Error during chunk decryption : return value " << ret;
+	}
 }
 
 // This module does not reuse any part of its chunk header during encryption
 // So re-encryption is the same than initial encryption
 void VfsEM_AES256GCM_SHA256::encryptChunk(const uint32_t chunkIndex,
-                                          std::vector<uint8_t> &rawChunk,
-                                          const std::vector<uint8_t> &plainData) {
-
-	rawChunk = encryptChunk(chunkIndex, plainData);
-}
-
-std::vector<uint8_t> VfsEM_AES256GCM_SHA256::encryptChunk(const uint32_t chunkIndex,
-                                                          const std::vector<uint8_t> &plainData) {
+                                          uint8_t *rawChunk,
+                                          BCTBX_UNUSED(const size_t existingRawChunkSize),
+                                          const uint8_t *plainData,
+                                          const size_t plainDataSize) {
 	if (sMasterKey.empty()) {
 		throw EVFS_EXCEPTION << "No encryption Master key set, cannot encrypt";
 	}
-	// generate a random IV
-	auto IV = mRNG->randomize(chunkIVSize);
+	// generate a random IV, directly in the chunk header
+	mRNG->randomize(rawChunk + chunkAuthTagSize, chunkIVSize);
 
 	// derive the key : HKDF (fileHeaderSalt || Chunk Index, Master key, "EVFS chunk")
-	std::vector<uint8_t> key{deriveChunkKey(chunkIndex)};
+	ChunkKey key;
+	deriveChunkKey(chunkIndex, key);
 
-	std::vector<uint8_t> AD{};
-	std::vector<uint8_t> tag(AES256GCM128::tagSize());
-	std::vector<uint8_t> rawChunk = AEADEncrypt<AES256GCM128>(key, IV, plainData, AD, tag);
-
-	// insert header:
-	std::vector<uint8_t> chunkHeader(chunkHeaderSize, 0);
-	std::copy(tag.cbegin(), tag.cend(), chunkHeader.begin());
-	std::copy(IV.cbegin(), IV.cend(), chunkHeader.begin() + tag.size());
-	rawChunk.insert(rawChunk.begin(), chunkHeader.cbegin(), chunkHeader.cend());
+	// the tag is written at the begining of the chunk header, the cipher text after it
+	int ret = bctbx_aes_gcm_encrypt_and_tag(key.data(), key.size(), plainData, plainDataSize, nullptr, 0,
+	                                        rawChunk + chunkAuthTagSize, chunkIVSize, rawChunk, chunkAuthTagSize,
+	                                        rawChunk + chunkHeaderSize);
 
 	// cleaning
 	bctbx_clean(key.data(), key.size());
 
-	return rawChunk;
+	if (ret != 0) {
+		throw EVFS_EXCEPTION << "Error during chunk encryption : return value " << ret;
+	}
 }
 
 /**
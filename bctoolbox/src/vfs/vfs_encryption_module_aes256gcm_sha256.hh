@@ -22,7 +22,9 @@
 #include "bctoolbox/crypto.hh"
 #include "bctoolbox/vfs_encrypted.hh"
 #include "vfs_encryption_module.hh"
+#include "vfs_lru_cache.hh"
 #include <array>
+#include <mutex>
 
 /*********** The AES256-GCM SHA256 module   ************************
  * Key derivations:
@@ -58,15 +60,23 @@ private:
 	std::vector<uint8_t> sMasterKey;         // used to derive all keys
 	std::vector<uint8_t> sFileHeaderHMACKey; // used to feed HMAC integrity check on file header
 
+	using ChunkKey = std::array<uint8_t, 32>; // AES256-GCM128 key
+	/**
+	 * The most recently used chunk keys: the key derivation costs more than the encryption of a chunk.
+	 * Chunks may be decrypted concurrently, the cache is protected by its own mutex.
+	 */
+	VfsLruCache<ChunkKey> sChunkKeys;
+	std::mutex mChunkKeysMutex;
+
 	/**
 	 * Derive the key from master key for the given chunkIndex:
 	 * HKDF(fileSalt || ChunkIndex, master Key, "EVFS chunk")
+	 * The key is taken from the chunk keys cache when it was already derived.
 	 *
 	 * @param[in]	chunkIndex	the chunk index used in key derivation
-	 *
-	 * @return	the AES256-GCM128 key
+	 * @param[out]	key		the AES256-GCM128 key
 	 */
-	std::vector<uint8_t> deriveChunkKey(uint32_t chunkIndex);
+	void deriveChunkKey(uint32_t chunkIndex, ChunkKey &key);
 
 public:
 	/**
@@ -96,17 +106,23 @@ public:
 	 */
 	size_t getSecretMaterialSize() const noexcept override;
 
-	/**
-	 * Decrypt a chunk of data
-	 * @param[in] a vector which size shall be chunkHeaderSize + chunkSize holding the raw data read from disk
-	 * @return the decrypted data chunk
-	 */
-	std::vector<uint8_t> decryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &rawChunk) override;
+	void decryptChunk(const uint32_t chunkIndex,
+	                  const uint8_t *rawChunk,
+	                  const size_t rawChunkSize,
+	                  uint8_t *plainData) override;
 
 	void encryptChunk(const uint32_t chunkIndex,
-	                  std::vector<uint8_t> &rawChunk,
-	                  const std::vector<uint8_t> &plainData) override;
-	std::vector<uint8_t> encryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &plainData) override;
+	                  uint8_t *rawChunk,
+	                  const size_t existingRawChunkSize,
+	                  const uint8_t *plainData,
+	                  const size_t plainDataSize) override;
+
+	/**
+	 * This module does not reuse any part of its chunk header during encryption
+	 */
+	bool isRawChunkNeededToReencrypt() const noexcept override {
+		return false;
+	}
 
 	const std::vector<uint8_t> getModuleFileHeader(const VfsEncryption &fileContext) const override;
 
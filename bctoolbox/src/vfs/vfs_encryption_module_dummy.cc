@@ -54,22 +54,26 @@ static constexpr size_t fileHeaderSize = 16;
  */
 static constexpr size_t secretMaterialSize = 16;
 
-static std::string getHex(const std::vector<uint8_t> &v) {
+static std::string getHex(const uint8_t *buffer, const size_t size) {
 	std::string result;
-	result.reserve(v.size() * 2); // two digits per character
+	result.reserve(size * 2); // two digits per character
 
 	static constexpr char hex[] = "0123456789ABCDEF";
 
-	for (uint8_t c : v) {
-		result.push_back(hex[c / 16]);
-		result.push_back(hex[c % 16]);
+	for (size_t i = 0; i < size; i++) {
+		result.push_back(hex[buffer[i] / 16]);
+		result.push_back(hex[buffer[i] % 16]);
 	}
 
 	return result;
 }
 
+static std::string getHex(const std::vector<uint8_t> &v) {
+	return getHex(v.data(), v.size());
+}
+
 // chunk index is in chunk 8,9,10,11
-uint32_t VfsEncryptionModuleDummy::getChunkIndex(const std::vector<uint8_t> &chunk) const {
+uint32_t VfsEncryptionModuleDummy::getChunkIndex(const uint8_t *chunk) const {
 	return chunk[8] << 24 | chunk[9] << 16 | chunk[10] << 8 | chunk[11];
 }
 
@@ -130,12 +134,37 @@ void VfsEncryptionModuleDummy::setModuleSecretMaterial(const std::vector<uint8_t
 	mSecret = secret;
 }
 
-std::vector<uint8_t> VfsEncryptionModuleDummy::decryptChunk(const uint32_t chunkIndex,
-                                                            const std::vector<uint8_t> &rawChunk) {
+/**
+ * The dummy encryption is a simple XOR on 16 bytes blocks with fileHeaderMaterial(8 bytes)||chunkHeaderMaterial(8
+ * bytes, the part after the integrity tag). The 16 bytes key is then xor with the secret material
+ */
+std::array<uint8_t, 16> VfsEncryptionModuleDummy::chunkXORKey(const uint8_t *chunk) const {
+	std::array<uint8_t, 16> XORkey;
+	std::copy(mFileHeader.cbegin(), mFileHeader.cend(), XORkey.begin()); // Xor key is file header material (global IV)
+	std::copy(chunk + 8, chunk + chunkHeaderSize, XORkey.begin() + 8);   // and chunkHeaderMaterial
+	std::transform(XORkey.begin(), XORkey.end(), mSecret.cbegin(), XORkey.begin(), std::bit_xor<uint8_t>());
+	return XORkey;
+}
+
+// Xor it all, 16 bytes at a time
+static void xorChunk(const uint8_t *input, const size_t size, const std::array<uint8_t, 16> &XORkey, uint8_t *output) {
+	for (size_t i = 0; i < size; i += 16) {
+		std::transform(input + i, input + std::min(i + 16, size), XORkey.cbegin(), output + i, std::bit_xor<uint8_t>());
+	}
+}
+
+void VfsEncryptionModuleDummy::decryptChunk(const uint32_t chunkIndex,
+                                            const uint8_t *rawChunk,
+                                            const size_t rawChunkSize,
+                                            uint8_t *plainData) {
+	if (rawChunkSize < chunkHeaderSize) {
+		throw EVFS_EXCEPTION << "Chunk " << chunkIndex << " is too short to be decrypted: " << rawChunkSize << " bytes";
+	}
 	// First check the integrity of the block. In the dummy module, integrity is 8 bytes of HMAC SHA256 keyed with the
 	// master key
-	std::vector<uint8_t> computedIntegrity = chunkIntegrityTag(rawChunk);
-	if (!std::equal(computedIntegrity.cbegin(), computedIntegrity.cend(), rawChunk.cbegin())) {
+	uint8_t computedIntegrity[8];
+	chunkIntegrityTag(rawChunk, rawChunkSize, computedIntegrity);
+	if (!std::equal(computedIntegrity, computedIntegrity + 8, rawChunk)) {
 		throw EVFS_EXCEPTION << "Integrity check failure while decrypting";
 	}
 
@@ -144,109 +173,64 @@ std::vector<uint8_t> VfsEncryptionModuleDummy::decryptChunk(const uint32_t chunk
 		throw EVFS_EXCEPTION << "Integrity check: unmatching chunk index";
 	}
 
-	std::vector<uint8_t> plainData(rawChunk.cbegin() + chunkHeaderSize, rawChunk.cend());
-	// The dummy decryption is a simple XOR on 16 bytes blocks with fileHeaderMaterial(8 bytes)||chunkHeaderMaterial(8
-	// bytes) The 16 bytes result is then xor with the secret material
-	std::vector<uint8_t> XORkey(globalIV()); // Xor key is file header material
-	XORkey.insert(XORkey.end(), rawChunk.cbegin() + 8, rawChunk.cbegin() + chunkHeaderSize); // and chunkHeaderMaterial
-	std::transform(XORkey.begin(), XORkey.end(), mSecret.cbegin(), XORkey.begin(), std::bit_xor<uint8_t>());
-
+	auto XORkey = chunkXORKey(rawChunk);
 	BCTBX_SLOGD << "decryptChunk :" << std::endl
-	            << "   chunk is " << getHex(plainData) << std::endl
-	            << "   key is " << getHex(XORkey);
-	// Xor it all, 16 bytes at a time
-	for (size_t i = 0; i < plainData.size(); i += 16) {
-		std::transform(plainData.begin() + i, plainData.begin() + std::min(i + 16, plainData.size()), XORkey.cbegin(),
-		               plainData.begin() + i, std::bit_xor<uint8_t>());
-	}
-	BCTBX_SLOGD << "decryptChunk :" << std::endl << "   output is " << getHex(plainData);
-
-	return plainData;
+	            << "   chunk is " << getHex(rawChunk + chunkHeaderSize, rawChunkSize - chunkHeaderSize) << std::endl
+	            << "   key is " << getHex(XORkey.data(), XORkey.size());
+	xorChunk(rawChunk + chunkHeaderSize, rawChunkSize - chunkHeaderSize, XORkey, plainData);
+	BCTBX_SLOGD << "decryptChunk :" << std::endl
+	            << "   output is " << getHex(plainData, rawChunkSize - chunkHeaderSize);
 }
 
 void VfsEncryptionModuleDummy::encryptChunk(const uint32_t chunkIndex,
-                                            std::vector<uint8_t> &rawChunk,
-                                            const std::vector<uint8_t> &plainData) {
-	BCTBX_SLOGD << "encryptChunk re :" << std::endl
-	            << "   plain is " << plainData.size() << std::endl
-	            << "    plain: " << getHex(plainData);
-	BCTBX_SLOGD << "    in cipher: " << getHex(rawChunk);
-
-	// Check integrity on the whole block. Actual module shall optimize it and be able to check only the header
-	// integrity, we just want to make sure the data we intend to use - header meta data - are valid
-	std::vector<uint8_t> computedIntegrity = chunkIntegrityTag(rawChunk);
-	if (!std::equal(computedIntegrity.cbegin(), computedIntegrity.cend(), rawChunk.cbegin())) {
-		throw EVFS_EXCEPTION << "Integrity check failure while re-encrypting chunk";
+                                            uint8_t *rawChunk,
+                                            const size_t existingRawChunkSize,
+                                            const uint8_t *plainData,
+                                            const size_t plainDataSize) {
+	BCTBX_SLOGD << "encryptChunk " << (existingRawChunkSize > 0 ? "re" : "new") << " :" << std::endl
+	            << "   plain is " << plainDataSize << " index is " << chunkIndex << std::endl
+	            << "    plain: " << getHex(plainData, plainDataSize);
+
+	if (existingRawChunkSize > 0) {
+		BCTBX_SLOGD << "    in cipher: " << getHex(rawChunk, existingRawChunkSize);
+		if (existingRawChunkSize < chunkHeaderSize) {
+			throw EVFS_EXCEPTION << "Chunk " << chunkIndex << " is too short to be re-encrypted";
+		}
+		// Check integrity on the whole block. Actual module shall optimize it and be able to check only the header
+		// integrity, we just want to make sure the data we intend to use - header meta data - are valid
+		uint8_t computedIntegrity[8];
+		chunkIntegrityTag(rawChunk, existingRawChunkSize, computedIntegrity);
+		if (!std::equal(computedIntegrity, computedIntegrity + 8, rawChunk)) {
+			throw EVFS_EXCEPTION << "Integrity check failure while re-encrypting chunk";
+		}
+		// Check the given chunk index is matching the one found in block - avoid attacker moving blocks in the file
+		if (chunkIndex != getChunkIndex(rawChunk)) {
+			throw EVFS_EXCEPTION << "Integrity check: unmatching chunk index";
+		}
+
+		// Increase the encryption count
+		uint32_t encryptionCount = rawChunk[12] << 24 | rawChunk[13] << 16 | rawChunk[14] << 8 | rawChunk[15];
+		encryptionCount++;
+		rawChunk[12] = (encryptionCount >> 24) & 0xFF;
+		rawChunk[13] = (encryptionCount >> 16) & 0xFF;
+		rawChunk[14] = (encryptionCount >> 8) & 0xFF;
+		rawChunk[15] = (encryptionCount & 0xFF);
+	} else {
+		std::fill(rawChunk, rawChunk + chunkHeaderSize, 0);
+		// set in the chunk Index
+		rawChunk[8] = (chunkIndex >> 24) & 0xFF;
+		rawChunk[9] = (chunkIndex >> 16) & 0xFF;
+		rawChunk[10] = (chunkIndex >> 8) & 0xFF;
+		rawChunk[11] = (chunkIndex & 0xFF);
+		// rawChunk 12 to 15 is the encryptionCount, 0 is fine
 	}
-	// Check the given chunk index is matching the one found in block - avoid attacker moving blocks in the file
-	if (chunkIndex != getChunkIndex(rawChunk)) {
-		throw EVFS_EXCEPTION << "Integrity check: unmatching chunk index";
-	}
-
-	// Increase the encryption count
-	uint32_t encryptionCount = rawChunk[12] << 24 | rawChunk[13] << 16 | rawChunk[14] << 8 | rawChunk[15];
-	encryptionCount++;
-	rawChunk[12] = (encryptionCount >> 24) & 0xFF;
-	rawChunk[13] = (encryptionCount >> 16) & 0xFF;
-	rawChunk[14] = (encryptionCount >> 8) & 0xFF;
-	rawChunk[15] = (encryptionCount & 0xFF);
-
-	// resize encrypted buffer
-	rawChunk.resize(chunkHeaderSize + plainData.size());
-
-	// The dummy encryption is a simple XOR on 16 bytes blocks with fileHeaderMaterial(8 bytes)||chunkHeaderMaterial(8
-	// bytes, the part after the integrity tag) The 16 bytes result is then xor with the secret material
-	std::vector<uint8_t> XORkey(globalIV()); // Xor key is file header material
-	XORkey.insert(XORkey.end(), rawChunk.cbegin() + 8, rawChunk.cbegin() + chunkHeaderSize); // and chunkHeaderMaterial
-	std::transform(XORkey.begin(), XORkey.end(), mSecret.cbegin(), XORkey.begin(), std::bit_xor<uint8_t>());
-
-	// Xor it all, 16 bytes at a time
-	for (size_t i = 0; i < plainData.size(); i += 16) {
-		std::transform(plainData.begin() + i, plainData.begin() + std::min(i + 16, plainData.size()), XORkey.cbegin(),
-		               rawChunk.begin() + chunkHeaderSize + i, std::bit_xor<uint8_t>());
-	}
-
-	// Update integrity
-	computedIntegrity = chunkIntegrityTag(rawChunk);
-	std::copy(computedIntegrity.cbegin(), computedIntegrity.cend(), rawChunk.begin());
 
-	BCTBX_SLOGD << "   out cipher: " << getHex(rawChunk);
-}
-
-std::vector<uint8_t> VfsEncryptionModuleDummy::encryptChunk(const uint32_t chunkIndex,
-                                                            const std::vector<uint8_t> &plainData) {
-	BCTBX_SLOGD << "encryptChunk new :" << std::endl
-	            << "   plain is " << plainData.size() << " index is " << chunkIndex << std::endl
-	            << "    plain: " << getHex(plainData);
-	// create a vector of the appropriate size, init to 0
-	std::vector<uint8_t> rawChunk(chunkHeaderSize + plainData.size(), 0);
-
-	// set in the chunk Index
-	rawChunk[8] = (chunkIndex >> 24) & 0xFF;
-	rawChunk[9] = (chunkIndex >> 16) & 0xFF;
-	rawChunk[10] = (chunkIndex >> 8) & 0xFF;
-	rawChunk[11] = (chunkIndex & 0xFF);
-	// rawChunk 12 to 15 is the encryptionCount, 0 is fine
-
-	// The dummy encryption is a simple XOR on 16 bytes blocks with fileHeaderMaterial(8 bytes)||chunkHeaderMaterial(8
-	// bytes, the part after the integrity tag) The 16 bytes result is then xor with the secret material
-	std::vector<uint8_t> XORkey(globalIV()); // Xor key is file header material
-	XORkey.insert(XORkey.end(), rawChunk.cbegin() + 8, rawChunk.cbegin() + chunkHeaderSize); // and chunkHeaderMaterial
-	std::transform(XORkey.begin(), XORkey.end(), mSecret.cbegin(), XORkey.begin(), std::bit_xor<uint8_t>());
-
-	// Xor it all, 16 bytes at a time
-	for (size_t i = 0; i < plainData.size(); i += 16) {
-		std::transform(plainData.begin() + i, plainData.begin() + std::min(i + 16, plainData.size()), XORkey.cbegin(),
-		               rawChunk.begin() + chunkHeaderSize + i, std::bit_xor<uint8_t>());
-	}
+	xorChunk(plainData, plainDataSize, chunkXORKey(rawChunk), rawChunk + chunkHeaderSize);
 
 	// Update integrity
-	auto computedIntegrity = chunkIntegrityTag(rawChunk);
-	std::copy(computedIntegrity.cbegin(), computedIntegrity.cend(), rawChunk.begin());
-
-	BCTBX_SLOGD << "    cipher: " << getHex(rawChunk);
+	chunkIntegrityTag(rawChunk, chunkHeaderSize + plainDataSize, rawChunk);
 
-	return rawChunk;
+	BCTBX_SLOGD << "    cipher: " << getHex(rawChunk, chunkHeaderSize + plainDataSize);
 }
 
 /**
@@ -272,16 +256,13 @@ bool VfsEncryptionModuleDummy::checkIntegrity(const VfsEncryption &fileContext)
 	return (std::equal(tag.cbegin(), tag.cend(), mFileHeaderIntegrity.cbegin()));
 }
 
-std::vector<uint8_t> VfsEncryptionModuleDummy::chunkIntegrityTag(const std::vector<uint8_t> &chunk) const {
-	std::vector<uint8_t> tag(8);
+void VfsEncryptionModuleDummy::chunkIntegrityTag(const uint8_t *chunk, const size_t chunkSize, uint8_t *tag) const {
 	bctbx_hmacSha256(
 	    mSecret.data(), secretMaterialSize,
-	    chunk.data() +
-	        8, // compute integrity on the whole block (header included) but skip the integrity tag (8 first bytes)
-	    chunk.size() - 8,
+	    chunk + 8, // compute integrity on the whole block (header included) but skip the integrity tag (8 first bytes)
+	    chunkSize - 8,
 	    8, // get 8 bytes out of the HMAC
-	    tag.data());
-	return tag;
+	    tag);
 }
 
 /**
@@ -21,6 +21,7 @@
 #define BCTBX_VFS_ENCRYPTION_MODULE_DUMMY_HH
 #include "bctoolbox/vfs_encrypted.hh"
 #include "vfs_encryption_module.hh"
+#include <array>
 
 namespace bctoolbox {
 class VfsEncryptionModuleDummy : public VfsEncryptionModule {
@@ -33,14 +34,19 @@ private:
 	std::vector<uint8_t> mSecret;
 
 	/**
-	 * Compute the integrity tag in the given chunk
+	 * Compute the integrity tag (8 bytes) of the given chunk
 	 */
-	std::vector<uint8_t> chunkIntegrityTag(const std::vector<uint8_t> &chunk) const;
+	void chunkIntegrityTag(const uint8_t *chunk, const size_t chunkSize, uint8_t *tag) const;
 
 	/**
 	 * Get the chunk index from the given chunk
 	 */
-	uint32_t getChunkIndex(const std::vector<uint8_t> &chunk) const;
+	uint32_t getChunkIndex(const uint8_t *chunk) const;
+
+	/**
+	 * Get the key used to XOR the given chunk
+	 */
+	std::array<uint8_t, 16> chunkXORKey(const uint8_t *chunk) const;
 
 	/**
 	 * Get global IV. Part of IV common to all chunks
@@ -76,17 +82,23 @@ public:
 	 */
 	size_t getSecretMaterialSize() const noexcept override;
 
-	/**
-	 * Decrypt a chunk of data
-	 * @param[in] a vector which size shall be chunkHeaderSize + chunkSize holding the raw data read from disk
-	 * @return the decrypted data chunk
-	 */
-	std::vector<uint8_t> decryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &rawChunk) override;
+	void decryptChunk(const uint32_t chunkIndex,
+	                  const uint8_t *rawChunk,
+	                  const size_t rawChunkSize,
+	                  uint8_t *plainData) override;
 
 	void encryptChunk(const uint32_t chunkIndex,
-	                  std::vector<uint8_t> &rawChunk,
-	                  const std::vector<uint8_t> &plainData) override;
-	std::vector<uint8_t> encryptChunk(const uint32_t chunkIndex, const std::vector<uint8_t> &plainData) override;
+	                  uint8_t *rawChunk,
+	                  const size_t existingRawChunkSize,
+	                  const uint8_t *plainData,
+	                  const size_t plainDataSize) override;
+
+	/**
+	 * The chunk header holds an encryption counter, increased at each re-encryption
+	 */
+	bool isRawChunkNeededToReencrypt() const noexcept override {
+		return true;
+	}
 
 	const std::vector<uint8_t> getModuleFileHeader(const VfsEncryption &fileContext) const override;
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016-2024 Belledonne Communications SARL.
+ *
+ * This file is part of bctoolbox.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BCTBX_VFS_LRU_CACHE_HH
+#define BCTBX_VFS_LRU_CACHE_HH
+
+#include "bctoolbox/crypto.h" // bctbx_clean
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+namespace bctoolbox {
+
+/**
+ * A bounded cache of values indexed by chunk index, dropping the least recently used value when it is full.
+ * The values hold plain text or key material: they are cleaned when dropped.
+ * Once the cache is full, the entry of the dropped value is reused for the inserted one, so a value holding a buffer
+ * (a std::vector) keeps its capacity and inserting does not allocate anymore.
+ * This class is not thread safe.
+ */
+template <typename Value>
+class VfsLruCache {
+public:
+	explicit VfsLruCache(size_t capacity) : mCapacity(capacity) {
+	}
+	VfsLruCache(const VfsLruCache &) = delete;
+	VfsLruCache &operator=(const VfsLruCache &) = delete;
+	~VfsLruCache() {
+		clear();
+	}
+
+	/**
+	 * Get a cached value, it becomes the most recently used one
+	 * @param[in]	index	the chunk index
+	 *
+	 * @return a pointer to the value, nullptr if it is not in cache. It is valid until the next call to insert(),
+	 * erase(), eraseFrom() or clear().
+	 */
+	Value *get(uint32_t index) {
+		auto it = mIndex.find(index);
+		if (it == mIndex.end()) return nullptr;
+		mEntries.splice(mEntries.begin(), mEntries, it->second);
+		return &it->second->second;
+	}
+
+	/**
+	 * @return true if the value of the given chunk is in cache, the order of the entries is not modified
+	 */
+	bool contains(uint32_t index) const {
+		return mIndex.find(index) != mIndex.end();
+	}
+
+	/**
+	 * Get the slot storing the value of a chunk, it becomes the most recently used one
+	 * The slot content is unspecified if the value was not in cache: the caller shall overwrite it.
+	 * @param[in]	index	the chunk index
+	 *
+	 * @return the value slot, valid until the next call to insert(), erase(), eraseFrom() or clear().
+	 */
+	Value &insert(uint32_t index) {
+		auto it = mIndex.find(index);
+		if (it != mIndex.end()) {
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			return it->second->second;
+		}
+		if (!mEntries.empty() && mEntries.size() >= mCapacity) { // recycle the least recently used entry
+			auto last = std::prev(mEntries.end());
+			mIndex.erase(last->first);
+			clean(last->second);
+			last->first = index;
+			mEntries.splice(mEntries.begin(), mEntries, last);
+		} else {
+			mEntries.emplace_front(index, Value{});
+		}
+		mIndex[index] = mEntries.begin();
+		return mEntries.front().second;
+	}
+
+	void erase(uint32_t index) {
+		auto it = mIndex.find(index);
+		if (it == mIndex.end()) return;
+		clean(it->second->second);
+		mEntries.erase(it->second);
+		mIndex.erase(it);
+	}
+
+	/**
+	 * Drop the values of all chunks starting at the given index
+	 */
+	void eraseFrom(uint32_t index) {
+		for (auto it = mEntries.begin(); it != mEntries.end();) {
+			if (it->first >= index) {
+				clean(it->second);
+				mIndex.erase(it->first);
+				it = mEntries.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	void clear() {
+		for (auto &entry : mEntries) {
+			clean(entry.second);
+		}
+		mEntries.clear();
+		mIndex.clear();
+	}
+
+private:
+	static void clean(Value &value) {
+		bctbx_clean(value.data(), value.size() * sizeof(typename Value::value_type));
+	}
+
+	using Entry = std::pair<uint32_t, Value>;
+	size_t mCapacity;
+	std::list<Entry> mEntries; // most recently used first
+	std::unordered_map<uint32_t, typename std::list<Entry>::iterator> mIndex;
+};
+
+} // namespace bctoolbox
+#endif // BCTBX_VFS_LRU_CACHE_HH
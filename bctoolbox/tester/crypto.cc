@@ -27,6 +27,7 @@
 #include "bctoolbox_tester.h"
 #include <array>
 #include <cmath>
+#include <deque>
 #include <stdio.h>
 
 using namespace bctoolbox;
@@ -1446,6 +1447,136 @@ static void key_wrap_test() {
 	BC_ASSERT_TRUE(plaintext == unwrapped_pt);
 }
 
+/* In memory transport for the TLS tests: each end reads what the other one wrote */
+struct MemoryTransport {
+	std::deque<uint8_t> *in;
+	std::deque<uint8_t> *out;
+};
+
+static int memory_transport_send(void *data, const unsigned char *buffer, size_t length) {
+	auto transport = static_cast<MemoryTransport *>(data);
+	transport->out->insert(transport->out->end(), buffer, buffer + length);
+	return (int)length;
+}
+
+static int memory_transport_recv(void *data, unsigned char *buffer, size_t length) {
+	auto transport = static_cast<MemoryTransport *>(data);
+	if (transport->in->empty()) return BCTBX_ERROR_NET_WANT_READ;
+	size_t read = std::min(length, transport->in->size());
+	std::copy(transport->in->begin(), transport->in->begin() + read, buffer);
+	transport->in->erase(transport->in->begin(), transport->in->begin() + read);
+	return (int)read;
+}
+
+static int tls_rng(void *rng, unsigned char *output, size_t output_length) {
+	return bctbx_rng_get(static_cast<bctbx_rng_context_t *>(rng), output, output_length);
+}
+
+/* Connects a client to a server, offering the given session if any. On success the session is replaced by the one
+ * negotiated, after some application data was exchanged so that TLS 1.3 tickets were received. */
+static bool tls_connect(bctbx_ssl_config_t *clientConfig,
+                        bctbx_ssl_config_t *serverConfig,
+                        bctbx_ssl_session_t *session,
+                        bool offerSession,
+                        bool &resumed) {
+	std::deque<uint8_t> toServer, toClient;
+	MemoryTransport clientTransport{&toClient, &toServer};
+	MemoryTransport serverTransport{&toServer, &toClient};
+	bctbx_ssl_context_t *client = bctbx_ssl_context_new();
+	bctbx_ssl_context_t *server = bctbx_ssl_context_new();
+	bool ret = false;
+
+	bctbx_ssl_context_setup(client, clientConfig);
+	bctbx_ssl_context_setup(server, serverConfig);
+	bctbx_ssl_set_io_callbacks(client, &clientTransport, memory_transport_send, memory_transport_recv);
+	bctbx_ssl_set_io_callbacks(server, &serverTransport, memory_transport_send, memory_transport_recv);
+	if (offerSession && !BC_ASSERT_TRUE(bctbx_ssl_set_session(client, session) == 0)) goto end;
+
+	for (int i = 0; i < 20; i++) {
+		int clientRet = bctbx_ssl_handshake(client);
+		int serverRet = bctbx_ssl_handshake(server);
+		if (clientRet == 0 && serverRet == 0) {
+			ret = true;
+			break;
+		}
+		if ((clientRet != 0 && clientRet != BCTBX_ERROR_NET_WANT_READ) ||
+		    (serverRet != 0 && serverRet != BCTBX_ERROR_NET_WANT_READ)) {
+			break;
+		}
+	}
+	if (!BC_ASSERT_TRUE(ret)) goto end;
+
+	{
+		const unsigned char ping[] = "ping";
+		unsigned char buffer[16];
+		BC_ASSERT_EQUAL(bctbx_ssl_write(client, ping, sizeof(ping)), (int)sizeof(ping), int, "%d");
+		BC_ASSERT_EQUAL(bctbx_ssl_read(server, buffer, sizeof(buffer)), (int)sizeof(ping), int, "%d");
+		BC_ASSERT_EQUAL(bctbx_ssl_write(server, ping, sizeof(ping)), (int)sizeof(ping), int, "%d");
+		BC_ASSERT_EQUAL(bctbx_ssl_read(client, buffer, sizeof(buffer)), (int)sizeof(ping), int, "%d");
+	}
+	resumed = bctbx_ssl_session_resumed(client) == 1;
+	BC_ASSERT_EQUAL(bctbx_ssl_session_resumed(server), resumed ? 1 : 0, int, "%d");
+	ret = BC_ASSERT_TRUE(bctbx_ssl_get_session(client, session) == 0);
+
+end:
+	bctbx_ssl_context_free(client);
+	bctbx_ssl_context_free(server);
+	return ret;
+}
+
+static void tls_session_resumption(void) {
+	bctbx_rng_context_t *rng = bctbx_rng_context_new();
+	bctbx_x509_certificate_t *cert = bctbx_x509_certificate_new();
+	bctbx_signing_key_t *key = bctbx_signing_key_new();
+	char pem[8192];
+	if (!BC_ASSERT_TRUE(bctbx_x509_certificate_generate_selfsigned("bctoolbox.example.org", cert, key, pem,
+	                                                               sizeof(pem)) == 0)) {
+		goto end_cert;
+	}
+
+	{
+		bctbx_ssl_config_t *serverConfig = bctbx_ssl_config_new();
+		bctbx_ssl_config_defaults(serverConfig, BCTBX_SSL_IS_SERVER, BCTBX_SSL_TRANSPORT_STREAM);
+		bctbx_ssl_config_set_authmode(serverConfig, BCTBX_SSL_VERIFY_NONE);
+		bctbx_ssl_config_set_rng(serverConfig, tls_rng, rng);
+		BC_ASSERT_EQUAL(bctbx_ssl_config_set_own_cert(serverConfig, cert, key), 0, int, "%x");
+		BC_ASSERT_EQUAL(bctbx_ssl_config_set_session_tickets(serverConfig, 1), 0, int, "%x");
+
+		bctbx_ssl_config_t *clientConfig = bctbx_ssl_config_new();
+		bctbx_ssl_config_defaults(clientConfig, BCTBX_SSL_IS_CLIENT, BCTBX_SSL_TRANSPORT_STREAM);
+		bctbx_ssl_config_set_authmode(clientConfig, BCTBX_SSL_VERIFY_NONE);
+		bctbx_ssl_config_set_rng(clientConfig, tls_rng, rng);
+
+		bctbx_ssl_session_t *session = bctbx_ssl_session_new();
+		bool resumed = true;
+		/* first connection is a full handshake, next ones resume its session */
+		if (tls_connect(clientConfig, serverConfig, session, false, resumed)) {
+			BC_ASSERT_FALSE(resumed);
+			if (tls_connect(clientConfig, serverConfig, session, true, resumed)) BC_ASSERT_TRUE(resumed);
+			if (tls_connect(clientConfig, serverConfig, session, true, resumed)) BC_ASSERT_TRUE(resumed);
+		}
+
+		/* another server does not know the ticket keys nor the session ID, a full handshake is done */
+		bctbx_ssl_config_t *otherServerConfig = bctbx_ssl_config_new();
+		bctbx_ssl_config_defaults(otherServerConfig, BCTBX_SSL_IS_SERVER, BCTBX_SSL_TRANSPORT_STREAM);
+		bctbx_ssl_config_set_authmode(otherServerConfig, BCTBX_SSL_VERIFY_NONE);
+		bctbx_ssl_config_set_rng(otherServerConfig, tls_rng, rng);
+		bctbx_ssl_config_set_own_cert(otherServerConfig, cert, key);
+		bctbx_ssl_config_set_session_tickets(otherServerConfig, 1);
+		if (tls_connect(clientConfig, otherServerConfig, session, true, resumed)) BC_ASSERT_FALSE(resumed);
+
+		bctbx_ssl_session_free(session);
+		bctbx_ssl_config_free(otherServerConfig);
+		bctbx_ssl_config_free(clientConfig);
+		bctbx_ssl_config_free(serverConfig);
+	}
+
+end_cert:
+	bctbx_x509_certificate_free(cert);
+	bctbx_signing_key_free(key);
+	bctbx_rng_context_free(rng);
+}
+
 static test_t crypto_tests[] = {
     TEST_NO_TAG("Diffie-Hellman Key exchange", DHM),
     TEST_NO_TAG("Elliptic Curve Diffie-Hellman Key exchange", ECDH),
@@ -1457,6 +1588,7 @@ static test_t crypto_tests[] = {
     TEST_NO_TAG("RNG", rng_test),
     TEST_NO_TAG("AEAD", AEAD),
     TEST_NO_TAG("Key wrap", key_wrap_test),
+    TEST_NO_TAG("TLS session resumption", tls_session_resumption),
 };
 
 test_suite_t crypto_test_suite = {"Crypto",     NULL, NULL, NULL, NULL, sizeof(crypto_tests) / sizeof(crypto_tests[0]),
@@ -21,6 +21,7 @@
 #include "bctoolbox/vfs_encrypted.hh"
 #include "bctoolbox/vfs_standard.h"
 #include "bctoolbox_tester.h"
+#include "vfs/vfs_lru_cache.hh"
 #include <fstream>
 
 using namespace bctoolbox;
@@ -541,10 +542,222 @@ void recovery_test() {
 	VfsEncryption::openCallbackSet(nullptr);
 }
 
+/**
+ * Check the LRU order, the recycling of entries once the cache is full and the erase functions of the chunk cache
+ */
+void chunk_cache_test() {
+	VfsLruCache<std::vector<uint8_t>> cache(3);
+
+	BC_ASSERT_PTR_NULL(cache.get(0));
+	for (uint32_t i = 0; i < 3; i++) {
+		cache.insert(i).assign(16, (uint8_t)i);
+	}
+	for (uint32_t i = 0; i < 3; i++) {
+		BC_ASSERT_TRUE(cache.contains(i));
+	}
+
+	// chunk 0 becomes the most recently used, inserting a 4th chunk drops chunk 1 and recycles its entry
+	auto *chunk0 = cache.get(0);
+	if (BC_ASSERT_PTR_NOT_NULL(chunk0)) {
+		BC_ASSERT_EQUAL(chunk0->size(), 16, size_t, "%zu");
+		BC_ASSERT_EQUAL((*chunk0)[0], 0, uint8_t, "%d");
+	}
+	auto &chunk3 = cache.insert(3);
+	BC_ASSERT_TRUE(chunk3.capacity() >= 16);
+	chunk3.assign(16, 3);
+	BC_ASSERT_FALSE(cache.contains(1));
+	BC_ASSERT_PTR_NULL(cache.get(1));
+	BC_ASSERT_TRUE(cache.contains(0));
+	BC_ASSERT_TRUE(cache.contains(2));
+	BC_ASSERT_TRUE(cache.contains(3));
+
+	// inserting a cached chunk returns its current value and makes it the most recently used
+	auto &chunk2 = cache.insert(2);
+	BC_ASSERT_EQUAL(chunk2.size(), 16, size_t, "%zu");
+	BC_ASSERT_EQUAL(chunk2[0], 2, uint8_t, "%d");
+	cache.insert(4).assign(16, 4); // drops chunk 0
+	BC_ASSERT_FALSE(cache.contains(0));
+	BC_ASSERT_TRUE(cache.contains(2));
+
+	cache.erase(2);
+	BC_ASSERT_FALSE(cache.contains(2));
+	cache.erase(2); // erasing a chunk not in cache does nothing
+	cache.insert(1).assign(16, 1);
+	cache.eraseFrom(3);
+	BC_ASSERT_TRUE(cache.contains(1));
+	BC_ASSERT_FALSE(cache.contains(3));
+	BC_ASSERT_FALSE(cache.contains(4));
+	auto *chunk1 = cache.get(1);
+	if (BC_ASSERT_PTR_NOT_NULL(chunk1)) {
+		BC_ASSERT_EQUAL((*chunk1)[15], 1, uint8_t, "%d");
+	}
+
+	cache.clear();
+	BC_ASSERT_FALSE(cache.contains(1));
+	BC_ASSERT_PTR_NULL(cache.get(1));
+}
+
+/**
+ * Large reads of chunks not in cache are decrypted directly in the caller's buffer, by several threads.
+ * Check it with reads starting inside a chunk, reads around a cached chunk and a corrupted chunk.
+ */
+void parallel_decryption_test(bctoolbox::EncryptionSuite suite) {
+	/* get the encrypted file path */
+	char *path = bc_tester_file("parallel_decryption.");
+	std::string filePath{path};
+	filePath.append(bctoolbox::encryptionSuiteString(suite)).append(".evfs");
+	bctbx_free(path);
+
+	/* remove file if it was already there */
+	remove(filePath.data());
+
+	// 80 chunks of 16 bytes, more than enough to be decrypted in parallel
+	std::vector<uint8_t> data(80 * bctbx_vfs_tester_chunk_size);
+	for (size_t i = 0; i < data.size(); i++) {
+		data[i] = message[i % sizeof(message)] ^ (uint8_t)(i / sizeof(message));
+	}
+	std::vector<uint8_t> readBuffer(data.size());
+
+	bctbx_vfs_file_t *fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR | O_CREAT);
+	BC_ASSERT_EQUAL(bctbx_file_write(fp, data.data(), data.size(), 0), (ssize_t)data.size(), ssize_t, "%ld");
+	bctbx_file_close(fp);
+
+	// nothing in cache after reopening: the whole file is decrypted at once
+	fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR);
+	BC_ASSERT_EQUAL(bctbx_file_read(fp, readBuffer.data(), readBuffer.size(), 0), (ssize_t)data.size(), ssize_t,
+	                "%ld");
+	BC_ASSERT_TRUE(memcmp(readBuffer.data(), data.data(), data.size()) == 0);
+	bctbx_file_close(fp);
+
+	// a read starting in the middle of a chunk, with a chunk in cache in the middle of the range
+	fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR);
+	std::fill(readBuffer.begin(), readBuffer.end(), 0);
+	BC_ASSERT_EQUAL(bctbx_file_read(fp, readBuffer.data(), 4, 40 * bctbx_vfs_tester_chunk_size), 4, ssize_t, "%ld");
+	BC_ASSERT_EQUAL(bctbx_file_read(fp, readBuffer.data(), data.size() - 5, 5), (ssize_t)(data.size() - 5), ssize_t,
+	                "%ld");
+	BC_ASSERT_TRUE(memcmp(readBuffer.data(), data.data() + 5, data.size() - 5) == 0);
+	bctbx_file_close(fp);
+
+	// corrupt the auth tag of a chunk in the second half of the file: the read shall fail
+	if (suite == bctoolbox::EncryptionSuite::aes256gcm128_sha256) {
+		// the raw chunks of aes256gcm128 have a 28 bytes header, seek to the beginning of chunk 60
+		const std::streamoff chunkOffset = -(std::streamoff)(20 * (bctbx_vfs_tester_chunk_size + 28));
+		std::fstream file(filePath, std::ios::out | std::ios::in | std::ios::binary);
+		file.seekg(chunkOffset, std::ios::end);
+		char tweakBuf[1];
+		file.read(tweakBuf, 1);
+		file.seekp(chunkOffset, std::ios::end);
+		tweakBuf[0] ^= 0xFF;
+		file.write(tweakBuf, 1);
+		file.close();
+
+		fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR);
+		BC_ASSERT_PTR_NOT_NULL(fp);
+		if (fp != NULL) {
+			BC_ASSERT_TRUE(bctbx_file_read(fp, readBuffer.data(), readBuffer.size(), 0) < 0);
+			bctbx_file_close(fp);
+		}
+	}
+
+	/* cleaning */
+	remove(filePath.data());
+}
+
+void parallel_decryption_test() {
+	/* set the encrypted vfs callback */
+	VfsEncryption::openCallbackSet(set_encryption_info);
+
+	parallel_decryption_test(EncryptionSuite::dummy);
+	parallel_decryption_test(EncryptionSuite::aes256gcm128_sha256);
+
+	VfsEncryption::openCallbackSet(nullptr);
+}
+
+/**
+ * The header is written only on sync or at closing: simulate a crash before that by copying the file while it is
+ * still open after a write extending it, then check the copy recovers its actual size and content at opening.
+ */
+void dirty_header_recovery_test(bctoolbox::EncryptionSuite suite) {
+	/* get the encrypted file paths */
+	char *path = bc_tester_file("dirty_header.");
+	std::string filePath{path};
+	filePath.append(bctoolbox::encryptionSuiteString(suite)).append(".evfs");
+	bctbx_free(path);
+	path = bc_tester_file("dirty_header_crashed.");
+	std::string crashedFilePath{path};
+	crashedFilePath.append(bctoolbox::encryptionSuiteString(suite)).append(".evfs");
+	bctbx_free(path);
+
+	/* remove files if they were already there */
+	remove(filePath.data());
+	remove(crashedFilePath.data());
+
+	uint8_t readBuffer[256];
+	memset(readBuffer, 0, sizeof(readBuffer));
+
+	// the header is written at closing with a size of 100
+	bctbx_vfs_file_t *fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR | O_CREAT);
+	bctbx_file_write(fp, message, 100, 0);
+	bctbx_file_close(fp);
+
+	// extend the file, the header in the file still holds the size of 100
+	fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDWR);
+	bctbx_file_write(fp, message + 100, 130, 100);
+	BC_ASSERT_EQUAL(bctbx_file_size(fp), 230, int64_t, "%ld");
+	{
+		std::ifstream src(filePath, std::ios::binary);
+		std::ofstream dst(crashedFilePath, std::ios::binary);
+		dst << src.rdbuf();
+	}
+	bctbx_file_close(fp);
+
+	// the copy was made before the header update: its size is recovered from the chunks at opening
+	fp = bctbx_file_open2(&bcEncryptedVfs, crashedFilePath.data(), O_RDWR);
+	BC_ASSERT_PTR_NOT_NULL(fp);
+	if (fp != NULL) {
+		BC_ASSERT_EQUAL(bctbx_file_size(fp), 230, int64_t, "%ld");
+		BC_ASSERT_EQUAL(bctbx_file_read(fp, readBuffer, sizeof(readBuffer), 0), 230, ssize_t, "%ld");
+		BC_ASSERT_TRUE(memcmp(readBuffer, message, 230) == 0);
+		bctbx_file_close(fp);
+	}
+
+	// the header was updated at recovery
+	fp = bctbx_file_open2(&bcEncryptedVfs, crashedFilePath.data(), O_RDONLY);
+	BC_ASSERT_PTR_NOT_NULL(fp);
+	if (fp != NULL) {
+		BC_ASSERT_EQUAL(bctbx_file_size(fp), 230, int64_t, "%ld");
+		bctbx_file_close(fp);
+	}
+
+	// the original file got its header at closing
+	fp = bctbx_file_open2(&bcEncryptedVfs, filePath.data(), O_RDONLY);
+	BC_ASSERT_EQUAL(bctbx_file_size(fp), 230, int64_t, "%ld");
+	BC_ASSERT_EQUAL(bctbx_file_read(fp, readBuffer, sizeof(readBuffer), 0), 230, ssize_t, "%ld");
+	BC_ASSERT_TRUE(memcmp(readBuffer, message, 230) == 0);
+	bctbx_file_close(fp);
+
+	/* cleaning */
+	remove(filePath.data());
+	remove(crashedFilePath.data());
+}
+
+void dirty_header_recovery_test() {
+	/* set the encrypted vfs callback */
+	VfsEncryption::openCallbackSet(set_encryption_info);
+
+	dirty_header_recovery_test(EncryptionSuite::dummy);
+	dirty_header_recovery_test(EncryptionSuite::aes256gcm128_sha256);
+
+	VfsEncryption::openCallbackSet(nullptr);
+}
+
 static test_t encrypted_vfs_tests[] = {TEST_NO_TAG("basic", basic_encryption_test),
                                        TEST_NO_TAG("Authentication failure", auth_fail_test),
                                        TEST_NO_TAG("migration", migration_test), TEST_NO_TAG("recovery", recovery_test),
-                                       TEST_NO_TAG("fprintf", fprintf_encryption_test)};
+                                       TEST_NO_TAG("fprintf", fprintf_encryption_test),
+                                       TEST_NO_TAG("Chunk cache", chunk_cache_test),
+                                       TEST_NO_TAG("Parallel decryption", parallel_decryption_test),
+                                       TEST_NO_TAG("Dirty header recovery", dirty_header_recovery_test)};
 
 test_suite_t encrypted_vfs_test_suite = {
     "Encrypted vfs",    NULL, NULL, NULL, NULL, sizeof(encrypted_vfs_tests) / sizeof(encrypted_vfs_tests[0]),
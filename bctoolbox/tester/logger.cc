@@ -17,9 +17,12 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
 #include <list>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "bctoolbox/crypto.h"
 #include "bctoolbox/tester.h"
@@ -119,7 +122,114 @@ static void test_cpp_tags(void) {
 	bctbx_uninit_logger();
 }
 
-static test_t logger_tests[] = {TEST_NO_TAG("Log tags", test_tags), TEST_NO_TAG("C++ log tags", test_cpp_tags)};
+static void test_async_file_logging(void) {
+	const char *domain = "async-logging";
+	const int threadCount = 4;
+	const int logCount = 200;
+	const char *path = bc_tester_get_writable_dir_prefix();
+	const char *name = "async_logging.log";
+	char *filename = bctbx_strdup_printf("%s/%s", path, name);
+	remove(filename);
+
+	bctbx_init_logger(1);
+	bctbx_set_log_level(domain, BCTBX_LOG_MESSAGE);
+	bctbx_log_handler_t *handler = bctbx_create_file_log_handler(0, path, name);
+	if (!BC_ASSERT_PTR_NOT_NULL(handler)) goto end;
+	bctbx_log_handler_set_domain(handler, domain);
+	bctbx_file_log_handler_set_async(handler, TRUE, 0);
+	bctbx_add_log_handler(handler);
+
+	{
+		std::vector<std::thread> threads;
+		for (int i = 0; i < threadCount; ++i) {
+			threads.emplace_back([domain, i, logCount] {
+				bctbx_push_log_tag("thread", std::to_string(i).c_str());
+				for (int j = 0; j < logCount; ++j)
+					bctbx_log(domain, BCTBX_LOG_MESSAGE, "async log %d of thread %d", j, i);
+				bctbx_pop_log_tag("thread");
+			});
+		}
+		for (auto &thread : threads)
+			thread.join();
+	}
+	bctbx_log(domain, BCTBX_LOG_MESSAGE, "async log of the main thread");
+	bctbx_logv_flush();
+
+	{
+		/* everything logged before the flush is in the file, once */
+		std::ifstream file(filename);
+		std::string line;
+		int count = 0;
+		bool mainThreadLogFound = false;
+		while (std::getline(file, line)) {
+			if (line.find("async log ") != std::string::npos) count++;
+			if (line.find("async log of the main thread") != std::string::npos) mainThreadLogFound = true;
+			if (line.find("async log 0 of thread 1") != std::string::npos) {
+				BC_ASSERT_TRUE(line.find("async-logging-message-[1] ") != std::string::npos);
+			}
+		}
+		BC_ASSERT_TRUE(mainThreadLogFound);
+		BC_ASSERT_EQUAL(count + (int)bctbx_file_log_handler_get_dropped_count(handler), threadCount * logCount + 1,
+		                int, "%d");
+	}
+
+	bctbx_remove_log_handler(handler);
+end:
+	bctbx_set_log_level(domain, BCTBX_LOG_WARNING);
+	remove(filename);
+	bctbx_free(filename);
+	bctbx_uninit_logger();
+}
+
+static void test_async_file_logging_overflow(void) {
+	const char *domain = "async-logging";
+	const int logCount = 1000;
+	const char *path = bc_tester_get_writable_dir_prefix();
+	const char *name = "async_logging_overflow.log";
+	char *filename = bctbx_strdup_printf("%s/%s", path, name);
+	std::string payload(200, 'x');
+	uint64_t dropped;
+	remove(filename);
+
+	bctbx_init_logger(1);
+	bctbx_set_log_level(domain, BCTBX_LOG_MESSAGE);
+	bctbx_log_handler_t *handler = bctbx_create_file_log_handler(0, path, name);
+	if (!BC_ASSERT_PTR_NOT_NULL(handler)) goto end;
+	bctbx_log_handler_set_domain(handler, domain);
+	/* the smallest ring buffer holds about 16 records of this size */
+	bctbx_file_log_handler_set_async(handler, TRUE, 4096);
+	bctbx_add_log_handler(handler);
+
+	for (int i = 0; i < logCount; ++i)
+		bctbx_log(domain, BCTBX_LOG_MESSAGE, "overflow log %d %s", i, payload.c_str());
+	bctbx_logv_flush();
+	dropped = bctbx_file_log_handler_get_dropped_count(handler);
+
+	{
+		/* records are either written or counted as dropped, and the drops are reported in the file */
+		std::ifstream file(filename);
+		std::string line;
+		int count = 0;
+		bool dropReported = false;
+		while (std::getline(file, line)) {
+			if (line.find("overflow log ") != std::string::npos) count++;
+			if (line.find("log records dropped") != std::string::npos) dropReported = true;
+		}
+		BC_ASSERT_EQUAL(count + (int)dropped, logCount, int, "%d");
+		BC_ASSERT_EQUAL(dropReported, dropped > 0, bool, "%d");
+	}
+
+	bctbx_remove_log_handler(handler);
+end:
+	bctbx_set_log_level(domain, BCTBX_LOG_WARNING);
+	remove(filename);
+	bctbx_free(filename);
+	bctbx_uninit_logger();
+}
+
+static test_t logger_tests[] = {TEST_NO_TAG("Log tags", test_tags), TEST_NO_TAG("C++ log tags", test_cpp_tags),
+                                TEST_NO_TAG("Asynchronous file logging", test_async_file_logging),
+                                TEST_NO_TAG("Asynchronous file logging overflow", test_async_file_logging_overflow)};
 
 test_suite_t logger_test_suite = {"Logging",    NULL, NULL, NULL, NULL, sizeof(logger_tests) / sizeof(logger_tests[0]),
                                   logger_tests, 0};
@@ -35,6 +35,7 @@
 
 #cmakedefine HAVE_LIBDL
 #cmakedefine HAVE_CLOCK_GETTIME
+#cmakedefine HAVE_EPOLL
 
 #cmakedefine HAVE_RESINIT
 
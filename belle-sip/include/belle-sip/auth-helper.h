@@ -396,6 +396,39 @@ BELLESIP_EXPORT void belle_tls_crypto_config_set_postcheck_callback(belle_tls_cr
  */
 BELLESIP_EXPORT void belle_tls_crypto_config_set_ssl_config(belle_tls_crypto_config_t *obj, void *ssl_config);
 
+/**
+ * Enable or disable TLS session resumption for the connections using this crypto configuration. When enabled, which is
+ * the default, the session negotiated with a server is kept after the connection is closed, and offered on the next
+ * connection to the same server. If the server accepts it (session ticket or session ID), the certificate exchange and
+ * verification of a full handshake are skipped.
+ * Saved sessions are dropped whenever the certificate verification settings of the configuration are changed.
+ * @param[in/out]	obj		The crypto configuration object to set
+ * @param[in]		enable	TRUE to resume sessions, FALSE to always perform a full handshake
+ */
+BELLESIP_EXPORT void belle_tls_crypto_config_enable_session_resumption(belle_tls_crypto_config_t *obj, int enable);
+
+/**
+ * Tell whether TLS session resumption is enabled for this crypto configuration.
+ */
+BELLESIP_EXPORT int belle_tls_crypto_config_session_resumption_enabled(const belle_tls_crypto_config_t *obj);
+
+/**
+ * Drop the TLS sessions saved for resumption, next connections will perform a full handshake.
+ */
+BELLESIP_EXPORT void belle_tls_crypto_config_clear_sessions(belle_tls_crypto_config_t *obj);
+
+/**
+ * Get the number of successful TLS handshakes that were full ones (no session resumed) on the connections using this
+ * crypto configuration.
+ */
+BELLESIP_EXPORT unsigned int belle_tls_crypto_config_get_full_handshake_count(const belle_tls_crypto_config_t *obj);
+
+/**
+ * Get the number of successful TLS handshakes that resumed a previous session on the connections using this crypto
+ * configuration.
+ */
+BELLESIP_EXPORT unsigned int belle_tls_crypto_config_get_resumed_handshake_count(const belle_tls_crypto_config_t *obj);
+
 BELLE_SIP_END_DECLS
 
 #endif /* AUTHENTICATION_HELPER_H_ */
@@ -62,11 +62,31 @@ BELLESIP_EXPORT void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, b
 
 BELLESIP_EXPORT void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source);
 
+/**
+ * The ways a main loop can wait for events on its sources.
+ **/
+typedef enum belle_sip_main_loop_backend {
+	BELLE_SIP_MAIN_LOOP_BACKEND_DEFAULT, /**< epoll where available, poll otherwise */
+	BELLE_SIP_MAIN_LOOP_BACKEND_POLL,    /**< poll(), or WaitForMultipleObjectsEx() on Windows */
+	BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL    /**< Linux epoll, with sources registered once for all */
+} belle_sip_main_loop_backend_t;
+
 /**
  * Creates a mainloop.
  **/
 BELLESIP_EXPORT belle_sip_main_loop_t *belle_sip_main_loop_new(void);
 
+/**
+ * Creates a mainloop waiting for events with the given backend.
+ * If the backend is not available on the platform, the default one is used.
+ **/
+BELLESIP_EXPORT belle_sip_main_loop_t *belle_sip_main_loop_new_with_backend(belle_sip_main_loop_backend_t backend);
+
+/**
+ * Returns the backend the mainloop waits for events with.
+ **/
+BELLESIP_EXPORT belle_sip_main_loop_backend_t belle_sip_main_loop_get_backend(const belle_sip_main_loop_t *ml);
+
 /**
  * Adds a timeout into the main loop
  * @param ml
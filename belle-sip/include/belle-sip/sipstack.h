@@ -114,6 +114,24 @@ BELLESIP_EXPORT unsigned char belle_sip_stack_dns_search_enabled(const belle_sip
 
 BELLESIP_EXPORT void belle_sip_stack_enable_dns_search(belle_sip_stack_t *stack, unsigned char enable);
 
+BELLESIP_EXPORT unsigned char belle_sip_stack_dns_cache_enabled(const belle_sip_stack_t *stack);
+
+/**
+ * Enable or disable the cache of DNS answers shared by all the resolutions made with this stack (enabled by default).
+ * Answers are kept for the TTL of their records, and negative answers (NXDOMAIN, no record of the requested type) for
+ * the duration advertised by the SOA record of the zone. Concurrent resolutions of the same name and type share a
+ * single DNS query. The cache is flushed whenever the DNS configuration of the stack changes.
+ * Only the built-in resolver uses this cache, not the Apple DNS Service nor mDNS.
+ * @param stack the stack
+ * @param enable TRUE to enable the cache, FALSE to disable it and drop its content.
+ */
+BELLESIP_EXPORT void belle_sip_stack_enable_dns_cache(belle_sip_stack_t *stack, unsigned char enable);
+
+/**
+ * Drop all the DNS answers cached by the stack, for example after a network change.
+ */
+BELLESIP_EXPORT void belle_sip_stack_clear_dns_cache(belle_sip_stack_t *stack);
+
 BELLESIP_EXPORT void
 belle_sip_stack_set_refresh_window(belle_sip_stack_t *stack, const int min_value, const int max_value);
 BELLESIP_EXPORT int belle_sip_stack_get_min_refresh_window(belle_sip_stack_t *stack);
@@ -19,6 +19,7 @@
 
 #include "belle-sip/auth-helper.h"
 #include "belle_sip_internal.h"
+#include "tls_session_cache.hh"
 
 GET_SET_STRING(belle_sip_auth_event, username)
 
@@ -135,6 +136,7 @@ unsigned int belle_tls_verify_policy_get_exceptions(const belle_tls_verify_polic
 static void crypto_config_uninit(belle_tls_crypto_config_t *obj) {
 	if (obj->root_ca) belle_sip_free(obj->root_ca);
 	if (obj->root_ca_data) belle_sip_free(obj->root_ca_data);
+	belle_sip_object_unref(obj->session_cache);
 }
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(belle_tls_crypto_config_t);
@@ -143,6 +145,8 @@ BELLE_SIP_INSTANCIATE_VPTR(belle_tls_crypto_config_t, belle_sip_object_t, crypto
 belle_tls_crypto_config_t *belle_tls_crypto_config_new(void) {
 	belle_tls_crypto_config_t *obj = belle_sip_object_new(belle_tls_crypto_config_t);
 
+	obj->session_cache = belle_sip_tls_session_cache_new();
+	obj->session_resumption_enabled = TRUE;
 	/*default to "system" default root ca, wihtout warranty...*/
 #if defined(__ANDROID__)
 	belle_tls_crypto_config_set_root_ca(obj, "/system/etc/security/cacerts");
@@ -164,6 +168,7 @@ belle_tls_crypto_config_t *belle_tls_crypto_config_new(void) {
 }
 
 int belle_tls_crypto_config_set_root_ca(belle_tls_crypto_config_t *obj, const char *path) {
+	belle_tls_crypto_config_clear_sessions(obj);
 	if (obj->root_ca) {
 		belle_sip_free(obj->root_ca);
 		obj->root_ca = NULL;
@@ -178,6 +183,7 @@ int belle_tls_crypto_config_set_root_ca(belle_tls_crypto_config_t *obj, const ch
 }
 
 int belle_tls_crypto_config_set_root_ca_data(belle_tls_crypto_config_t *obj, const char *data) {
+	belle_tls_crypto_config_clear_sessions(obj);
 	if (obj->root_ca) {
 		belle_sip_free(obj->root_ca);
 		obj->root_ca = NULL;
@@ -196,6 +202,7 @@ int belle_tls_crypto_config_set_root_ca_data(belle_tls_crypto_config_t *obj, con
 }
 
 void belle_tls_crypto_config_set_verify_exceptions(belle_tls_crypto_config_t *obj, int flags) {
+	if (obj->exception_flags != flags) belle_tls_crypto_config_clear_sessions(obj);
 	obj->exception_flags = flags;
 }
 
@@ -204,12 +211,14 @@ unsigned int belle_tls_crypto_config_get_verify_exceptions(const belle_tls_crypt
 }
 
 void belle_tls_crypto_config_set_ssl_config(belle_tls_crypto_config_t *obj, void *ssl_config) {
+	belle_tls_crypto_config_clear_sessions(obj);
 	obj->ssl_config = ssl_config;
 }
 
 void belle_tls_crypto_config_set_verify_callback(belle_tls_crypto_config_t *obj,
                                                  belle_tls_crypto_config_verify_callback_t cb,
                                                  void *cb_data) {
+	belle_tls_crypto_config_clear_sessions(obj);
 	obj->verify_cb = cb;
 	obj->verify_cb_data = cb_data;
 }
@@ -220,3 +229,25 @@ void belle_tls_crypto_config_set_postcheck_callback(belle_tls_crypto_config_t *o
 	obj->postcheck_cb = cb;
 	obj->postcheck_cb_data = cb_data;
 }
+
+void belle_tls_crypto_config_enable_session_resumption(belle_tls_crypto_config_t *obj, int enable) {
+	obj->session_resumption_enabled = enable;
+	if (!enable) belle_tls_crypto_config_clear_sessions(obj);
+}
+
+int belle_tls_crypto_config_session_resumption_enabled(const belle_tls_crypto_config_t *obj) {
+	return obj->session_resumption_enabled;
+}
+
+void belle_tls_crypto_config_clear_sessions(belle_tls_crypto_config_t *obj) {
+	/* sessions were authenticated with the previous settings, they must not be resumed with the new ones */
+	if (obj->session_cache) belle_sip_tls_session_cache_clear(obj->session_cache);
+}
+
+unsigned int belle_tls_crypto_config_get_full_handshake_count(const belle_tls_crypto_config_t *obj) {
+	return belle_sip_tls_session_cache_get_handshake_count(obj->session_cache, FALSE);
+}
+
+unsigned int belle_tls_crypto_config_get_resumed_handshake_count(const belle_tls_crypto_config_t *obj) {
+	return belle_sip_tls_session_cache_get_handshake_count(obj->session_cache, TRUE);
+}
@@ -313,8 +313,10 @@ struct belle_sip_source {
 	unsigned char cancelled;
 	unsigned char expired;
 	unsigned char oneshot;
-	unsigned char notify_required; /*for testing purpose, use to ask for being scheduled*/
-	bctbx_iterator_t *it;          /*for fast removal*/
+	unsigned char notify_required;             /*for testing purpose, use to ask for being scheduled*/
+	struct belle_sip_epoll_entry *epoll_entry; /*registration of the fd, shared by its sources, with epoll*/
+	struct belle_sip_timer_slot *timer_slot;   /*slot of the main loop timer wheel, for fast removal*/
+	belle_sip_source_t *timer_prev, *timer_next;
 	belle_sip_main_loop_t *ml;
 };
 
@@ -332,6 +334,8 @@ void belle_sip_fd_source_init(belle_sip_source_t *s,
                               unsigned int timeout_value_ms);
 belle_sip_source_t *belle_sip_fd_source_new(
     belle_sip_source_func_t func, void *data, belle_sip_fd_t fd, unsigned int events, unsigned int timeout_value_ms);
+/*for testing purpose, to have the source notified at next main loop iteration*/
+void belle_sip_source_set_notify_required(belle_sip_source_t *s, unsigned char notify_required);
 void belle_sip_source_uninit(belle_sip_source_t *s);
 void belle_sip_source_reset(belle_sip_source_t *s);
 void belle_sip_source_set_notify(belle_sip_source_t *s, belle_sip_source_func_t func);
@@ -701,6 +705,8 @@ struct belle_sip_hop {
 /*
  belle_sip_stack_t
 */
+typedef struct _belle_sip_dns_cache belle_sip_dns_cache_t;
+
 struct belle_sip_stack {
 	belle_sip_object_t base;
 	belle_sip_main_loop_t *ml;
@@ -723,6 +729,7 @@ struct belle_sip_stack {
 	bctbx_list_t *user_host_entries; /*list of belle_sip_param_pair_t* storing user provided dns entries name  for
 	                                    hostname, value for ip value*/
 	belle_sip_list_t *dns_servers;   /*used when dns servers are supplied by app layer*/
+	belle_sip_dns_cache_t *dns_cache; /*answers shared by all resolutions made on this stack*/
 	/*http proxy stuff to be used by both http and sip provider*/
 	char *http_proxy_host;
 	int http_proxy_port;
@@ -735,6 +742,7 @@ struct belle_sip_stack {
 
 	unsigned char dns_srv_enabled;
 	unsigned char dns_search_enabled;
+	unsigned char dns_cache_enabled;
 	unsigned char reconnect_to_primary_asap;
 	unsigned char simulate_non_working_srv;
 	unsigned char
@@ -762,6 +770,8 @@ BELLESIP_EXPORT int belle_sip_stack_check_digest_compatibility(const belle_sip_s
  belle_sip_provider_t
 */
 
+typedef struct _belle_sip_list_index belle_sip_list_index_t;
+
 struct belle_sip_provider {
 	belle_sip_object_t base;
 	belle_sip_stack_t *stack;
@@ -771,6 +781,10 @@ struct belle_sip_provider {
 	belle_sip_list_t *client_transactions;
 	belle_sip_list_t *server_transactions;
 	belle_sip_list_t *dialogs;
+	/*hash indexes of the above lists, by branch for transactions and by call-id for dialogs*/
+	belle_sip_list_index_t *client_transactions_index;
+	belle_sip_list_index_t *server_transactions_index;
+	belle_sip_list_index_t *dialogs_index;
 	belle_sip_list_t *auth_contexts;
 	unsigned short unconditional_answer;
 	unsigned char rport_enabled; /*0 if rport should not be set in via header*/
@@ -17,11 +17,14 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "bctoolbox/map.h"
 #include "belle-sip/belle-sip.h"
 #include "belle_sip_internal.h"
 #include <limits.h>
 
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifndef _WIN32
 #include <poll.h>
 #include <unistd.h>
@@ -141,8 +144,405 @@ static int belle_sip_poll(belle_sip_pollfd_t *pfd, int count, int duration) {
 
 #endif
 
+#ifdef HAVE_EPOLL
+
+/*
+ Epoll() based implementation of event loop.
+ The fds are registered when their source is added to the main loop, so that only the sources having events are
+ examined at each iteration. It is level-triggered like poll(), as channels may not read all what is available when
+ notified.
+ */
+
+#define BELLE_SIP_EPOLL_MAX_EVENTS 256
+#define BELLE_SIP_EPOLL_CONTROL_PIPE UINT64_MAX /*epoll data of the control pipe, never used by a registration*/
+
+typedef struct belle_sip_epoll_entry belle_sip_epoll_entry_t;
+
+static uint32_t belle_sip_event_to_epoll(unsigned int events) {
+	uint32_t ret = 0;
+	if (events & BELLE_SIP_EVENT_READ) ret |= EPOLLIN;
+	if (events & BELLE_SIP_EVENT_WRITE) ret |= EPOLLOUT;
+	if (events & BELLE_SIP_EVENT_ERROR) ret |= EPOLLERR;
+	return ret;
+}
+
+static unsigned int belle_sip_epoll_to_event(uint32_t events) {
+	unsigned int ret = 0;
+	if (events & EPOLLIN) ret |= BELLE_SIP_EVENT_READ;
+	if (events & EPOLLOUT) ret |= BELLE_SIP_EVENT_WRITE;
+	if (events & EPOLLERR) ret |= BELLE_SIP_EVENT_ERROR;
+	return ret;
+}
+
+#endif
+
+/*
+ Hierarchical timer wheel, holding the sources with a timeout.
+ The root level has a slot per millisecond of the current round of 256 ms. Each upper level has 64 slots, each of them
+ covering a full round of the level below. When a round ends, the timers of the next slot of the upper level are spread
+ in the lower levels (cascading). This way arming, cancelling or expiring a timer does not depend on the number of
+ timers.
+ */
+
+#define BELLE_SIP_TIMER_WHEEL_ROOT_BITS 8
+#define BELLE_SIP_TIMER_WHEEL_ROOT_SIZE (1 << BELLE_SIP_TIMER_WHEEL_ROOT_BITS)
+#define BELLE_SIP_TIMER_WHEEL_ROOT_MASK (BELLE_SIP_TIMER_WHEEL_ROOT_SIZE - 1)
+#define BELLE_SIP_TIMER_WHEEL_LEVEL_BITS 6
+#define BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE (1 << BELLE_SIP_TIMER_WHEEL_LEVEL_BITS)
+#define BELLE_SIP_TIMER_WHEEL_LEVEL_MASK (BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE - 1)
+/*number of levels above the root one, covering 2^32 ms (about 49 days)*/
+#define BELLE_SIP_TIMER_WHEEL_LEVELS 4
+#define BELLE_SIP_TIMER_WHEEL_SLOTS                                                                                    \
+	(BELLE_SIP_TIMER_WHEEL_ROOT_SIZE + BELLE_SIP_TIMER_WHEEL_LEVELS * BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE)
+
+typedef struct belle_sip_timer_slot {
+	belle_sip_source_t *first;
+	belle_sip_source_t *last;
+	int level; /*-1 for the lists out of the wheel*/
+} belle_sip_timer_slot_t;
+
+typedef struct belle_sip_timer_wheel {
+	uint64_t current; /*the first millisecond whose timers have not expired yet*/
+	belle_sip_timer_slot_t slots[BELLE_SIP_TIMER_WHEEL_SLOTS]; /*the root level, then the upper ones*/
+	int counts[BELLE_SIP_TIMER_WHEEL_LEVELS + 1];               /*number of timers in each level*/
+	belle_sip_timer_slot_t due;     /*timers to notify at next iteration: cancelled, or armed in the past*/
+	belle_sip_timer_slot_t expired; /*timers being notified*/
+} belle_sip_timer_wheel_t;
+
+static void belle_sip_timer_wheel_init(belle_sip_timer_wheel_t *w, uint64_t now) {
+	int i;
+	w->current = now;
+	for (i = 0; i < BELLE_SIP_TIMER_WHEEL_SLOTS; ++i) {
+		w->slots[i].level =
+		    i < BELLE_SIP_TIMER_WHEEL_ROOT_SIZE
+		        ? 0
+		        : 1 + (i - BELLE_SIP_TIMER_WHEEL_ROOT_SIZE) / BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE;
+	}
+	w->due.level = -1;
+	w->expired.level = -1;
+}
+
+static belle_sip_timer_slot_t *belle_sip_timer_wheel_get_slot(belle_sip_timer_wheel_t *w, int level, uint64_t index) {
+	if (level == 0) return &w->slots[index & BELLE_SIP_TIMER_WHEEL_ROOT_MASK];
+	return &w->slots[BELLE_SIP_TIMER_WHEEL_ROOT_SIZE + (level - 1) * BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE +
+	                 (index & BELLE_SIP_TIMER_WHEEL_LEVEL_MASK)];
+}
+
+/*all the lists holding timers: the slots of the wheel, then the due and expired ones*/
+static belle_sip_timer_slot_t *belle_sip_timer_wheel_get_list(belle_sip_timer_wheel_t *w, int i) {
+	if (i < BELLE_SIP_TIMER_WHEEL_SLOTS) return &w->slots[i];
+	if (i == BELLE_SIP_TIMER_WHEEL_SLOTS) return &w->due;
+	if (i == BELLE_SIP_TIMER_WHEEL_SLOTS + 1) return &w->expired;
+	return NULL;
+}
+
+/*number of bits of the time giving the slot of an upper level*/
+static int belle_sip_timer_wheel_get_shift(int level) {
+	return BELLE_SIP_TIMER_WHEEL_ROOT_BITS + (level - 1) * BELLE_SIP_TIMER_WHEEL_LEVEL_BITS;
+}
+
+static void
+belle_sip_timer_slot_append(belle_sip_timer_wheel_t *w, belle_sip_timer_slot_t *slot, belle_sip_source_t *s) {
+	s->timer_slot = slot;
+	s->timer_prev = slot->last;
+	s->timer_next = NULL;
+	if (slot->last) slot->last->timer_next = s;
+	else slot->first = s;
+	slot->last = s;
+	if (slot->level >= 0) w->counts[slot->level]++;
+}
+
+static void belle_sip_timer_wheel_remove(belle_sip_timer_wheel_t *w, belle_sip_source_t *s) {
+	belle_sip_timer_slot_t *slot = s->timer_slot;
+	if (s->timer_prev) s->timer_prev->timer_next = s->timer_next;
+	else slot->first = s->timer_next;
+	if (s->timer_next) s->timer_next->timer_prev = s->timer_prev;
+	else slot->last = s->timer_prev;
+	if (slot->level >= 0) w->counts[slot->level]--;
+	s->timer_slot = NULL;
+	s->timer_prev = s->timer_next = NULL;
+}
+
+static void belle_sip_timer_wheel_add(belle_sip_timer_wheel_t *w, belle_sip_source_t *s) {
+	uint64_t expire = s->expire_ms;
+	uint64_t delta;
+	int level = 1;
+	int shift;
+
+	if (expire < w->current) {
+		belle_sip_timer_slot_append(w, &w->due, s);
+		return;
+	}
+	delta = expire - w->current;
+	if (delta < BELLE_SIP_TIMER_WHEEL_ROOT_SIZE) {
+		belle_sip_timer_slot_append(w, belle_sip_timer_wheel_get_slot(w, 0, expire), s);
+		return;
+	}
+	while (level < BELLE_SIP_TIMER_WHEEL_LEVELS &&
+	       (delta >> (belle_sip_timer_wheel_get_shift(level) + BELLE_SIP_TIMER_WHEEL_LEVEL_BITS)) != 0) {
+		level++;
+	}
+	shift = belle_sip_timer_wheel_get_shift(level);
+	if ((delta >> (shift + BELLE_SIP_TIMER_WHEEL_LEVEL_BITS)) != 0) {
+		/*too far for the wheel: the timer will be placed again when its slot is cascaded*/
+		expire = w->current + ((uint64_t)1 << (shift + BELLE_SIP_TIMER_WHEEL_LEVEL_BITS)) - 1;
+	}
+	belle_sip_timer_slot_append(w, belle_sip_timer_wheel_get_slot(w, level, expire >> shift), s);
+}
+
+/*spreads the timers of the current slot of an upper level in the levels below, returns the index of this slot*/
+static uint64_t belle_sip_timer_wheel_cascade(belle_sip_timer_wheel_t *w, int level) {
+	uint64_t index = (w->current >> belle_sip_timer_wheel_get_shift(level)) & BELLE_SIP_TIMER_WHEEL_LEVEL_MASK;
+	belle_sip_timer_slot_t *slot = belle_sip_timer_wheel_get_slot(w, level, index);
+	belle_sip_source_t *s = slot->first;
+	belle_sip_source_t *next;
+
+	/*detach the timers first, as the ones a full turn away go back to the same slot*/
+	slot->first = slot->last = NULL;
+	for (; s != NULL; s = next) {
+		next = s->timer_next;
+		w->counts[level]--;
+		belle_sip_timer_wheel_add(w, s);
+	}
+	return index;
+}
+
+/*moves the timers expired at the given time to the expired list, in the order of their expiry*/
+static void belle_sip_timer_wheel_expire(belle_sip_timer_wheel_t *w, uint64_t now) {
+	belle_sip_source_t *s;
+	int level;
+	int count = 0;
+
+	while ((s = w->due.first) != NULL) {
+		belle_sip_timer_wheel_remove(w, s);
+		belle_sip_timer_slot_append(w, &w->expired, s);
+	}
+	for (level = 0; level <= BELLE_SIP_TIMER_WHEEL_LEVELS; ++level) {
+		count += w->counts[level];
+	}
+	if (count == 0) {
+		/*nothing to look at in between*/
+		if (w->current <= now) w->current = now + 1;
+		return;
+	}
+	while (w->current <= now) {
+		uint64_t index = w->current & BELLE_SIP_TIMER_WHEEL_ROOT_MASK;
+		uint64_t next;
+		belle_sip_timer_slot_t *slot = belle_sip_timer_wheel_get_slot(w, 0, index);
+
+		if (index == 0) {
+			for (level = 1; level <= BELLE_SIP_TIMER_WHEEL_LEVELS; ++level) {
+				if (belle_sip_timer_wheel_cascade(w, level) != 0) break;
+			}
+		}
+		while ((s = slot->first) != NULL) {
+			belle_sip_timer_wheel_remove(w, s);
+			belle_sip_timer_slot_append(w, &w->expired, s);
+		}
+		/*jump to the next slot holding timers in this round, or to the next round*/
+		next = index + 1;
+		if (w->counts[0] == 0) next = BELLE_SIP_TIMER_WHEEL_ROOT_SIZE;
+		else {
+			while (next < BELLE_SIP_TIMER_WHEEL_ROOT_SIZE && belle_sip_timer_wheel_get_slot(w, 0, next)->first == NULL)
+				next++;
+		}
+		w->current = MIN(w->current + (next - index), now + 1);
+	}
+}
+
+/*returns the time at which the wheel has to be looked at, UINT64_MAX if there is no timer*/
+static uint64_t belle_sip_timer_wheel_get_next_expiry(belle_sip_timer_wheel_t *w) {
+	uint64_t next = UINT64_MAX;
+	int level;
+
+	if (w->due.first || w->expired.first) return 0;
+	for (level = 0; level <= BELLE_SIP_TIMER_WHEEL_LEVELS; ++level) {
+		if (w->counts[level] > 0 && (w->current & BELLE_SIP_TIMER_WHEEL_ROOT_MASK) == 0) {
+			/*a round starts, with upper slots to cascade*/
+			return w->current;
+		}
+	}
+	if (w->counts[0] > 0) {
+		uint64_t index = w->current & BELLE_SIP_TIMER_WHEEL_ROOT_MASK;
+		uint64_t i;
+		for (i = index; i < BELLE_SIP_TIMER_WHEEL_ROOT_SIZE; ++i) {
+			if (belle_sip_timer_wheel_get_slot(w, 0, i)->first) return w->current + (i - index);
+		}
+		/*the remaining timers of the root level are for the next round*/
+		next = (w->current | BELLE_SIP_TIMER_WHEEL_ROOT_MASK) + 1;
+	}
+	/*the timers of upper levels need to be looked at when their slot is cascaded*/
+	for (level = 1; level <= BELLE_SIP_TIMER_WHEEL_LEVELS; ++level) {
+		if (w->counts[level] > 0) {
+			int shift = belle_sip_timer_wheel_get_shift(level);
+			uint64_t round = w->current >> shift;
+			uint64_t i;
+			for (i = 1; i <= BELLE_SIP_TIMER_WHEEL_LEVEL_SIZE; ++i) {
+				if (belle_sip_timer_wheel_get_slot(w, level, round + i)->first) {
+					next = MIN(next, (round + i) << shift);
+					break;
+				}
+			}
+		}
+	}
+	return next;
+}
+
+static belle_sip_source_t *belle_sip_timer_wheel_find(belle_sip_timer_wheel_t *w, unsigned long id) {
+	belle_sip_timer_slot_t *list;
+	belle_sip_source_t *s;
+	int i;
+
+	for (i = 0; (list = belle_sip_timer_wheel_get_list(w, i)) != NULL; ++i) {
+		for (s = list->first; s != NULL; s = s->timer_next) {
+			if (s->id == id) return s;
+		}
+	}
+	return NULL;
+}
+
+struct belle_sip_main_loop {
+	belle_sip_object_t base;
+	belle_sip_list_t *fd_sources;
+	belle_sip_timer_wheel_t timers;
+	bctbx_mutex_t
+	    sources_mutex; // mutex to avoid concurency between source addition/removing/cancelling and main loop iteration.
+	belle_sip_object_pool_t *pool;
+	int nsources;
+	int run;
+	int in_loop;
+	belle_sip_main_loop_backend_t backend;
+	belle_sip_pollfd_t *pfd; /*kept from one iteration to the other with the poll backend*/
+	int pfd_size;
+#ifndef _WIN32
+	int control_fds[2];
+	unsigned long thread_id;
+#endif
+#ifdef HAVE_EPOLL
+	int epoll_fd; /*-1 with the poll backend*/
+	struct epoll_event epoll_events[BELLE_SIP_EPOLL_MAX_EVENTS];
+	belle_sip_epoll_entry_t **epoll_entries; /*indexed by fd*/
+	int epoll_entries_size;
+	uint32_t epoll_generation;
+	belle_sip_list_t *removed_while_polling; /*kept until the events returned by epoll_wait() are examined*/
+	unsigned char polling;
+	unsigned char notify_required;
+#endif
+};
+
+#ifdef HAVE_EPOLL
+
+/*
+ The sources sharing a fd share a single epoll registration, registered for the union of their events.
+ The epoll data holds the fd and a generation number rather than a pointer, so that an event returned for a
+ registration that no longer exists (fd closed and reused, or removed while polling) is recognized and ignored.
+ */
+struct belle_sip_epoll_entry {
+	belle_sip_list_t *sources;
+	uint32_t generation;
+	unsigned short events;
+};
+
+static belle_sip_epoll_entry_t *belle_sip_main_loop_epoll_get_entry(belle_sip_main_loop_t *ml, int fd) {
+	if (fd < 0 || fd >= ml->epoll_entries_size) return NULL;
+	return ml->epoll_entries[fd];
+}
+
+static unsigned short belle_sip_epoll_entry_get_events(const belle_sip_epoll_entry_t *entry) {
+	const belle_sip_list_t *elem;
+	unsigned short events = 0;
+	for (elem = entry->sources; elem != NULL; elem = elem->next) {
+		events |= ((belle_sip_source_t *)elem->data)->events;
+	}
+	return events;
+}
+
+static int belle_sip_main_loop_epoll_ctl(belle_sip_main_loop_t *ml, int op, int fd, belle_sip_epoll_entry_t *entry) {
+	struct epoll_event ev = {0};
+	ev.events = belle_sip_event_to_epoll(entry->events);
+	ev.data.u64 = ((uint64_t)entry->generation << 32) | (uint32_t)fd;
+	return epoll_ctl(ml->epoll_fd, op, fd, &ev);
+}
+
+static void belle_sip_main_loop_epoll_register(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	int fd = (int)s->fd;
+	belle_sip_epoll_entry_t *entry = belle_sip_main_loop_epoll_get_entry(ml, fd);
+
+	if (entry == NULL) {
+		if (fd < 0) {
+			belle_sip_error("Cannot register invalid fd [%i] to epoll set", fd);
+			return;
+		}
+		entry = belle_sip_new0(belle_sip_epoll_entry_t);
+		entry->generation = ++ml->epoll_generation;
+		entry->events = s->events;
+		if (belle_sip_main_loop_epoll_ctl(ml, EPOLL_CTL_ADD, fd, entry) == -1) {
+			belle_sip_error("epoll_ctl() failed to add fd [%i]: %s", fd, strerror(errno));
+			belle_sip_free(entry);
+			return;
+		}
+		if (fd >= ml->epoll_entries_size) {
+			int size = MAX(fd + 1, 2 * ml->epoll_entries_size);
+			ml->epoll_entries = belle_sip_realloc(ml->epoll_entries, size * sizeof(belle_sip_epoll_entry_t *));
+			memset(ml->epoll_entries + ml->epoll_entries_size, 0,
+			       (size - ml->epoll_entries_size) * sizeof(belle_sip_epoll_entry_t *));
+			ml->epoll_entries_size = size;
+		}
+		ml->epoll_entries[fd] = entry;
+	} else if ((entry->events | s->events) != entry->events) {
+		entry->events |= s->events;
+		if (belle_sip_main_loop_epoll_ctl(ml, EPOLL_CTL_MOD, fd, entry) == -1) {
+			belle_sip_error("epoll_ctl() failed to modify fd [%i]: %s", fd, strerror(errno));
+		}
+	}
+	entry->sources = belle_sip_list_prepend(entry->sources, s);
+	s->epoll_entry = entry;
+}
+
+static void belle_sip_main_loop_epoll_unregister(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	int fd = (int)s->fd;
+	belle_sip_epoll_entry_t *entry = s->epoll_entry;
+
+	s->epoll_entry = NULL;
+	entry->sources = belle_sip_list_remove(entry->sources, s);
+	if (entry->sources != NULL) {
+		unsigned short events = belle_sip_epoll_entry_get_events(entry);
+		if (events != entry->events) {
+			entry->events = events;
+			if (belle_sip_main_loop_epoll_ctl(ml, EPOLL_CTL_MOD, fd, entry) == -1) {
+				belle_sip_error("epoll_ctl() failed to modify fd [%i]: %s", fd, strerror(errno));
+			}
+		}
+		return;
+	}
+	if (epoll_ctl(ml->epoll_fd, EPOLL_CTL_DEL, fd, NULL) == -1) {
+		if (errno == EBADF || errno == ENOENT) {
+			/*unregistered by the kernel only if no other fd refers to the same file, otherwise its events are
+			 * ignored as stale*/
+			belle_sip_warning("fd [%i] was closed before its source [%p] was removed from the main loop", fd, s);
+		} else {
+			belle_sip_error("epoll_ctl() failed to remove fd [%i]: %s", fd, strerror(errno));
+		}
+	}
+	ml->epoll_entries[fd] = NULL;
+	belle_sip_free(entry);
+}
+
+static void belle_sip_main_loop_epoll_update(belle_sip_main_loop_t *ml, belle_sip_source_t *s) {
+	belle_sip_epoll_entry_t *entry = s->epoll_entry;
+	unsigned short events = belle_sip_epoll_entry_get_events(entry);
+
+	if (events == entry->events) return;
+	entry->events = events;
+	if (belle_sip_main_loop_epoll_ctl(ml, EPOLL_CTL_MOD, (int)s->fd, entry) == -1) {
+		belle_sip_error("epoll_ctl() failed to modify fd [%i]: %s", (int)s->fd, strerror(errno));
+	}
+}
+
+#endif
+
 static void belle_sip_source_destroy(belle_sip_source_t *obj) {
-	if (obj->node.next || obj->node.prev) {
+	if (obj->node.next || obj->node.prev || obj->timer_slot) {
 		belle_sip_fatal("Destroying source currently used in main loop !");
 	}
 	belle_sip_source_uninit(obj);
@@ -157,15 +557,28 @@ static void belle_sip_source_init(belle_sip_source_t *s,
 	static unsigned long global_id = 1;
 	s->node.data = s;
 	if (s->id == 0) s->id = global_id++;
+#ifdef HAVE_EPOLL
+	if (s->epoll_entry) belle_sip_main_loop_epoll_unregister(s->ml, s);
+#endif
 	s->fd = fd;
 	s->events = events;
 	s->timeout = timeout_value_ms;
 	s->data = data;
 	s->notify = func;
 	s->sock = (belle_sip_socket_t)-1;
+#ifdef HAVE_EPOLL
+	/*the source is initialized again while being in the main loop*/
+	if (s->ml && s->ml->epoll_fd != -1 && (s->node.next || s->node.prev || &s->node == s->ml->fd_sources) &&
+	    fd != (belle_sip_fd_t)-1) {
+		belle_sip_main_loop_epoll_register(s->ml, s);
+	}
+#endif
 }
 
 void belle_sip_source_reset(belle_sip_source_t *s) {
+#ifdef HAVE_EPOLL
+	if (s->epoll_entry) belle_sip_main_loop_epoll_unregister(s->ml, s);
+#endif
 #ifdef _WIN32
 	if (s->sock != (belle_sip_socket_t)-1) {
 		WSACloseEvent(s->fd);
@@ -175,7 +588,6 @@ void belle_sip_source_reset(belle_sip_source_t *s) {
 	s->fd = (belle_sip_fd_t)-1;
 	s->sock = (belle_sip_socket_t)-1;
 }
-
 void belle_sip_source_uninit(belle_sip_source_t *obj) {
 	belle_sip_source_reset(obj);
 }
@@ -249,6 +661,9 @@ void belle_sip_source_set_user_data(belle_sip_source_t *s, void *user_data) {
 }
 int belle_sip_source_set_events(belle_sip_source_t *source, int event_mask) {
 	source->events = event_mask;
+#ifdef HAVE_EPOLL
+	if (source->epoll_entry) belle_sip_main_loop_epoll_update(source->ml, source);
+#endif
 	return 0;
 }
 
@@ -256,39 +671,38 @@ belle_sip_socket_t belle_sip_source_get_socket(const belle_sip_source_t *source)
 	return source->sock;
 }
 
-struct belle_sip_main_loop {
-	belle_sip_object_t base;
-	belle_sip_list_t *fd_sources;
-	bctbx_map_t *timer_sources;
-	bctbx_mutex_t
-	    sources_mutex; // mutex to avoid concurency between source addition/removing/cancelling and main loop iteration.
-	belle_sip_object_pool_t *pool;
-	int nsources;
-	int run;
-	int in_loop;
-#ifndef _WIN32
-	int control_fds[2];
-	unsigned long thread_id;
+void belle_sip_source_set_notify_required(belle_sip_source_t *s, unsigned char notify_required) {
+	s->notify_required = notify_required;
+#ifdef HAVE_EPOLL
+	/*with epoll, only the sources having events are examined, so the main loop has to look for this one*/
+	if (notify_required && s->ml) s->ml->notify_required = TRUE;
 #endif
-};
+}
+
 
-static void belle_sip_main_loop_remove_source_internal(belle_sip_main_loop_t *ml,
-                                                       belle_sip_source_t *source,
-                                                       bool_t destroy_timer_sources) {
+void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
+	int removed = FALSE;
 	int unrefs = 0;
 
 	bctbx_mutex_lock(&ml->sources_mutex);
 	if (source->node.next || source->node.prev || &source->node == ml->fd_sources) {
 		ml->fd_sources = belle_sip_list_remove_link(ml->fd_sources, &source->node);
+		removed = TRUE;
+#ifdef HAVE_EPOLL
+		if (source->epoll_entry) belle_sip_main_loop_epoll_unregister(ml, source);
+		/*epoll_wait() may have returned events for it, keep it alive until they are examined*/
+		if (ml->polling) ml->removed_while_polling = belle_sip_list_prepend(ml->removed_while_polling, source);
+		else unrefs++;
+#else
 		unrefs++;
+#endif
 	}
-	if (source->it) {
-		if (destroy_timer_sources) bctbx_map_erase(ml->timer_sources, source->it);
-		bctbx_iterator_delete(source->it);
-		source->it = NULL;
+	if (source->timer_slot) {
+		belle_sip_timer_wheel_remove(&ml->timers, source);
+		removed = TRUE;
 		unrefs++;
 	}
-	if (unrefs) {
+	if (removed) {
 		source->cancelled = TRUE;
 		ml->nsources--;
 		bctbx_mutex_unlock(&ml->sources_mutex);
@@ -301,23 +715,15 @@ static void belle_sip_main_loop_remove_source_internal(belle_sip_main_loop_t *ml
 	bctbx_mutex_unlock(&ml->sources_mutex);
 }
 
-void belle_sip_main_loop_remove_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
-	belle_sip_main_loop_remove_source_internal(ml, source, TRUE);
-}
-
 static void belle_sip_main_loop_destroy(belle_sip_main_loop_t *ml) {
-	bctbx_iterator_t *it = bctbx_map_ullong_begin(ml->timer_sources);
-	bctbx_iterator_t *end = bctbx_map_ullong_end(ml->timer_sources);
+	belle_sip_timer_slot_t *list;
+	int i;
 
-	while (!bctbx_iterator_ullong_equals(it, end)) {
-		belle_sip_main_loop_remove_source_internal(
-		    ml, (belle_sip_source_t *)bctbx_pair_ullong_get_second(bctbx_iterator_ullong_get_pair(it)), FALSE);
-		it = bctbx_iterator_ullong_get_next(it);
+	for (i = 0; (list = belle_sip_timer_wheel_get_list(&ml->timers, i)) != NULL; ++i) {
+		while (list->first) {
+			belle_sip_main_loop_remove_source(ml, list->first);
+		}
 	}
-
-	bctbx_iterator_ullong_delete(it);
-	bctbx_iterator_ullong_delete(end);
-
 	while (ml->fd_sources) {
 		belle_sip_main_loop_remove_source(ml, (belle_sip_source_t *)ml->fd_sources->data);
 	}
@@ -325,9 +731,12 @@ static void belle_sip_main_loop_destroy(belle_sip_main_loop_t *ml) {
 		belle_sip_object_unref(ml->pool);
 	}
 
-	bctbx_mmap_ullong_delete(ml->timer_sources);
 	bctbx_mutex_destroy(&ml->sources_mutex);
-
+	if (ml->pfd) belle_sip_free(ml->pfd);
+#ifdef HAVE_EPOLL
+	if (ml->epoll_fd != -1) close(ml->epoll_fd);
+	if (ml->epoll_entries) belle_sip_free(ml->epoll_entries);
+#endif
 #ifndef _WIN32
 	close(ml->control_fds[0]);
 	close(ml->control_fds[1]);
@@ -338,9 +747,13 @@ BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(belle_sip_main_loop_t);
 BELLE_SIP_INSTANCIATE_VPTR(belle_sip_main_loop_t, belle_sip_object_t, belle_sip_main_loop_destroy, NULL, NULL, FALSE);
 
 belle_sip_main_loop_t *belle_sip_main_loop_new(void) {
+	return belle_sip_main_loop_new_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_DEFAULT);
+}
+
+belle_sip_main_loop_t *belle_sip_main_loop_new_with_backend(belle_sip_main_loop_backend_t backend) {
 	belle_sip_main_loop_t *m = belle_sip_object_new(belle_sip_main_loop_t);
 	m->pool = belle_sip_object_pool_push();
-	m->timer_sources = bctbx_mmap_ullong_new();
+	belle_sip_timer_wheel_init(&m->timers, belle_sip_time_ms());
 	bctbx_mutex_init(&m->sources_mutex, NULL);
 
 #ifndef _WIN32
@@ -353,12 +766,39 @@ belle_sip_main_loop_t *belle_sip_main_loop_new(void) {
 	m->thread_id = 0;
 #endif
 
+	m->backend = BELLE_SIP_MAIN_LOOP_BACKEND_POLL;
+#ifdef HAVE_EPOLL
+	m->epoll_fd = -1;
+	if (backend != BELLE_SIP_MAIN_LOOP_BACKEND_POLL) {
+		m->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (m->epoll_fd == -1) {
+			belle_sip_warning("epoll_create1() failed: %s, using poll() instead", strerror(errno));
+		} else {
+			struct epoll_event ev = {0};
+			ev.events = EPOLLIN;
+			ev.data.u64 = BELLE_SIP_EPOLL_CONTROL_PIPE;
+			if (epoll_ctl(m->epoll_fd, EPOLL_CTL_ADD, m->control_fds[0], &ev) == -1) {
+				belle_sip_fatal("Cannot add control pipe of main loop thread to epoll set: %s", strerror(errno));
+			}
+			m->backend = BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL;
+		}
+	}
+#else
+	if (backend == BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL) {
+		belle_sip_warning("epoll is not available on this platform, using poll() instead");
+	}
+#endif
+
 	return m;
 }
 
+belle_sip_main_loop_backend_t belle_sip_main_loop_get_backend(const belle_sip_main_loop_t *ml) {
+	return ml->backend;
+}
+
 void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, belle_sip_source_t *source) {
 	bctbx_mutex_lock(&ml->sources_mutex);
-	if (source->node.next || source->node.prev) {
+	if (source->node.next || source->node.prev || source->timer_slot) {
 		belle_sip_fatal("Source is already linked somewhere else.");
 	}
 	if (source->node.data != source) {
@@ -370,13 +810,16 @@ void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, belle_sip_source_
 	if (source->timeout >= 0) {
 		belle_sip_object_ref(source);
 		source->expire_ms = belle_sip_time_ms() + source->timeout;
-		source->it = bctbx_map_insert_and_delete_with_returned_it(
-		    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(source->expire_ms, source));
+		belle_sip_timer_wheel_add(&ml->timers, source);
 	}
 	source->cancelled = FALSE;
 	if (source->fd != (belle_sip_fd_t)-1) {
 		belle_sip_object_ref(source);
 		ml->fd_sources = belle_sip_list_concat(&source->node, ml->fd_sources);
+		source->index = -1; /*not in the pollfd table yet*/
+#ifdef HAVE_EPOLL
+		if (ml->epoll_fd != -1) belle_sip_main_loop_epoll_register(ml, source);
+#endif
 	}
 
 	ml->nsources++;
@@ -386,7 +829,6 @@ void belle_sip_main_loop_add_source(belle_sip_main_loop_t *ml, belle_sip_source_
 
 	bctbx_mutex_unlock(&ml->sources_mutex);
 }
-
 belle_sip_source_t *belle_sip_main_loop_create_timeout_with_remove_cb(belle_sip_main_loop_t *ml,
                                                                       belle_sip_source_func_t func,
                                                                       void *data,
@@ -468,26 +910,23 @@ void belle_sip_source_set_timeout(belle_sip_source_t *s, unsigned int value_ms)
 
 void belle_sip_source_set_timeout_int64(belle_sip_source_t *s, int64_t value_ms) {
 	belle_sip_main_loop_t *ml = s->ml;
-	int removed_from_map = FALSE;
+	int removed_from_timers = FALSE;
 	// take the mutex only when the source has been added to the mail loop
 	if (ml) bctbx_mutex_lock(&ml->sources_mutex);
 	if (!s->expired) {
 		s->expire_ms = belle_sip_time_ms() + value_ms;
-		if (s->it) {
-			/*this timeout is already sorted in the timer_sources map, we need to move it to its new place*/
-			bctbx_map_erase(ml->timer_sources, s->it);
-			bctbx_iterator_delete(s->it);
+		if (s->timer_slot && !s->cancelled) {
+			/*this timeout is already in the timer wheel, we need to move it to its new place*/
+			belle_sip_timer_wheel_remove(&ml->timers, s);
 			if (value_ms != -1) {
-				s->it = bctbx_map_insert_and_delete_with_returned_it(
-				    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(s->expire_ms, s));
+				belle_sip_timer_wheel_add(&ml->timers, s);
 			} else {
-				s->it = NULL;
-				removed_from_map = TRUE;
+				removed_from_timers = TRUE;
 			}
 		}
 	}
 	s->timeout = value_ms;
-	if (removed_from_map) belle_sip_object_unref(s);
+	if (removed_from_timers) belle_sip_object_unref(s);
 	if (ml) bctbx_mutex_unlock(&ml->sources_mutex);
 }
 
@@ -504,44 +943,39 @@ int64_t belle_sip_source_get_timeout_int64(const belle_sip_source_t *s) {
 }
 
 void belle_sip_source_cancel(belle_sip_source_t *s) {
-	if (s->ml) {
-		bctbx_mutex_lock(&s->ml->sources_mutex);
-		s->cancelled = TRUE;
-		if (s->it) {
-			bctbx_map_erase(s->ml->timer_sources, s->it);
-			bctbx_iterator_delete(s->it);
-			/*put on front*/
-			s->it = bctbx_map_insert_and_delete_with_returned_it(s->ml->timer_sources,
-			                                                     (bctbx_pair_t *)bctbx_pair_ullong_new(0, s));
+	belle_sip_main_loop_t *ml = s->ml;
+	if (ml) {
+		bctbx_mutex_lock(&ml->sources_mutex);
+		if (!s->cancelled) {
+			/*the cancelled sources are notified at next iteration through the due timers, to be removed*/
+			if (s->timer_slot) {
+				belle_sip_timer_wheel_remove(&ml->timers, s);
+				belle_sip_timer_slot_append(&ml->timers, &ml->timers.due, s);
+			} else if (s->node.next || s->node.prev || &s->node == ml->fd_sources) {
+				belle_sip_object_ref(s);
+				belle_sip_timer_slot_append(&ml->timers, &ml->timers.due, s);
+			}
 		}
-		bctbx_mutex_unlock(&s->ml->sources_mutex);
+		s->cancelled = TRUE;
+		bctbx_mutex_unlock(&ml->sources_mutex);
 	} else {
 		s->cancelled = TRUE;
 	}
 }
 
-static int match_source_id(const void *s, const void *pid) {
-	if (((belle_sip_source_t *)s)->id == (unsigned long)(intptr_t)pid) {
-		return 0;
-	}
-	return -1;
-}
-
 belle_sip_source_t *belle_sip_main_loop_find_source(belle_sip_main_loop_t *ml, unsigned long id) {
-	bctbx_iterator_t *it;
 	belle_sip_source_t *ret = NULL;
-	belle_sip_list_t *elem = belle_sip_list_find_custom(ml->fd_sources, match_source_id, (const void *)(intptr_t)id);
-	if (elem != NULL) {
-		ret = (belle_sip_source_t *)elem->data;
-	} else if ((it = bctbx_map_find_custom(ml->timer_sources, match_source_id, (const void *)(intptr_t)id))) {
-		ret = (belle_sip_source_t *)bctbx_pair_get_second(bctbx_iterator_get_pair(it));
-		bctbx_iterator_delete(it);
-	} /*else
-	    ret = NULL;*/
+	belle_sip_list_t *elem;
 
+	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
+		if (((belle_sip_source_t *)elem->data)->id == id) {
+			ret = (belle_sip_source_t *)elem->data;
+			break;
+		}
+	}
+	if (ret == NULL) ret = belle_sip_timer_wheel_find(&ml->timers, id);
 	return ret;
 }
-
 void belle_sip_main_loop_cancel_source(belle_sip_main_loop_t *ml, unsigned long id) {
 	belle_sip_source_t *s = belle_sip_main_loop_find_source(ml, id);
 	if (s) belle_sip_source_cancel(s);
@@ -564,124 +998,208 @@ static ssize_t clear_pipe(int read_fd) {
 	else return cum_nread;
 }
 
-static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
-	size_t pfd_size = (ml->nsources + 1) * sizeof(belle_sip_pollfd_t);
-	belle_sip_pollfd_t *pfd = (belle_sip_pollfd_t *)belle_sip_malloc0(pfd_size);
+
+/*waits for events with poll() and appends the sources having some to the list of sources to be notified*/
+static int belle_sip_main_loop_poll(belle_sip_main_loop_t *ml,
+                                    int duration,
+                                    bctbx_list_t **to_be_notified,
+                                    bctbx_list_t **to_be_notified_last) {
+	bctbx_list_t *elem;
 	int i = 0;
-	bctbx_list_t *elem, *next;
-	int duration = -1;
 	int ret;
-	uint64_t cur;
-	bctbx_list_t *to_be_notified = NULL;
-	bctbx_list_t *to_be_notified_last = NULL;
-	int can_clean = belle_sip_object_pool_cleanable(
-	    ml->pool); /*iterate might not be called by the thread that created the main loop*/
-	belle_sip_object_pool_t *tmp_pool = NULL;
-	bctbx_iterator_t *it, *end;
 
-	if (!can_clean) {
-		/*Push a temporary pool for the time of the iterate loop*/
-		tmp_pool = belle_sip_object_pool_push();
+	bctbx_mutex_lock(&ml->sources_mutex);
+	if (ml->pfd_size < ml->nsources + 1) {
+		ml->pfd_size = ml->nsources + 1;
+		ml->pfd = (belle_sip_pollfd_t *)belle_sip_realloc(ml->pfd, ml->pfd_size * sizeof(belle_sip_pollfd_t));
 	}
-
-	/*Step 1: prepare the pollfd table and get the next timeout value */
-	bctbx_mutex_lock(&ml->sources_mutex); // Lock for the whole step 1
-	for (elem = ml->fd_sources; elem != NULL; elem = next) {
-		next = elem->next;
+	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
 		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
 		if (!s->cancelled) {
 			if (s->fd != (belle_sip_fd_t)-1) {
-				belle_sip_source_to_poll(s, pfd, i);
+				belle_sip_source_to_poll(s, ml->pfd, i);
 				++i;
 			}
 		}
 	}
 #ifndef _WIN32
-	pfd[i].fd = ml->control_fds[0];
-	pfd[i].events = POLLIN;
+	ml->pfd[i].fd = ml->control_fds[0];
+	ml->pfd[i].events = POLLIN;
+	ml->pfd[i].revents = 0;
 	++i;
 #endif
-	/*all source with timeout are in ml->timer_sources*/
-	if (bctbx_map_size(ml->timer_sources) > 0) {
-		int64_t diff;
-		uint64_t next_wakeup_time;
-		it = bctbx_map_begin(ml->timer_sources);
-		/*use first because in case of canceled timer, key ==0 , key != s->expire_ms */
-		next_wakeup_time = bctbx_pair_ullong_get_first((const bctbx_pair_ullong_t *)bctbx_iterator_get_pair(it));
-		/* compute the amount of time to wait for shortest timeout*/
-		cur = belle_sip_time_ms();
-		diff = next_wakeup_time - cur;
-		if (diff > 0) duration = MIN((unsigned int)diff, INT_MAX);
-		else duration = 0;
-		bctbx_iterator_delete(it);
-		it = NULL;
-	}
 	bctbx_mutex_unlock(&ml->sources_mutex);
 
-	/* do the poll */
-	ret = belle_sip_poll(pfd, i, duration);
+	ret = belle_sip_poll(ml->pfd, i, duration);
 	if (ret == -1) {
-		goto end;
+		return -1;
 	}
 
 #ifndef _WIN32
-	if (pfd[i - 1].revents == POLLIN) {
+	if (ml->pfd[i - 1].revents == POLLIN) {
 		if (clear_pipe(ml->control_fds[0]) == -1)
 			belle_sip_fatal("Cannot read control pipe of main loop thread: %s", strerror(errno));
 	}
 #endif
 
-	/* Step 2: examine poll results and determine the list of source to be notified */
-	bctbx_mutex_lock(&ml->sources_mutex); // Lock for step 2 and step 3.
-	cur = belle_sip_time_ms();
+	bctbx_mutex_lock(&ml->sources_mutex);
 	for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
 		unsigned revents = 0;
 		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
-		if (!s->cancelled) {
-			if (s->fd != (belle_sip_fd_t)-1) {
-				if (s->notify_required) { /*for testing purpose to force channel to read*/
-					revents = BELLE_SIP_EVENT_READ;
-					s->notify_required = 0; /*reset*/
-				} else {
-					revents = belle_sip_source_get_revents(s, pfd);
-				}
-				s->revents = revents;
+		/*the cancelled sources are among the due timers*/
+		if (s->cancelled) continue;
+		if (s->fd != (belle_sip_fd_t)-1) {
+			if (s->notify_required) { /*for testing purpose to force channel to read*/
+				revents = BELLE_SIP_EVENT_READ;
+				s->notify_required = 0; /*reset*/
+			} else if (s->index != -1) {
+				revents = belle_sip_source_get_revents(s, ml->pfd);
+			} /*else added while polling*/
+			s->revents = revents;
+		} else {
+			belle_sip_error("Source [%p] does not contains any fd !", s);
+		}
+		if (revents != 0) {
+			*to_be_notified = bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+		}
+	}
+	bctbx_mutex_unlock(&ml->sources_mutex);
+	return ret;
+}
+
+#ifdef HAVE_EPOLL
+
+/*waits for events with epoll_wait() and appends the sources having some to the list of sources to be notified*/
+static int belle_sip_main_loop_epoll(belle_sip_main_loop_t *ml,
+                                     int duration,
+                                     bctbx_list_t **to_be_notified,
+                                     bctbx_list_t **to_be_notified_last) {
+	bctbx_list_t *elem;
+	int i;
+	int ret;
+
+	bctbx_mutex_lock(&ml->sources_mutex);
+	ml->polling = TRUE;
+	bctbx_mutex_unlock(&ml->sources_mutex);
+
+	ret = epoll_wait(ml->epoll_fd, ml->epoll_events, BELLE_SIP_EPOLL_MAX_EVENTS, duration);
+	if (ret == -1 && errno != EINTR) belle_sip_error("epoll_wait() error: %s", strerror(errno));
+
+	bctbx_mutex_lock(&ml->sources_mutex);
+	ml->polling = FALSE;
+	for (i = 0; i < ret; ++i) {
+		uint64_t data = ml->epoll_events[i].data.u64;
+		belle_sip_epoll_entry_t *entry;
+		unsigned int events;
+
+		if (data == BELLE_SIP_EPOLL_CONTROL_PIPE) {
+			if (clear_pipe(ml->control_fds[0]) == -1)
+				belle_sip_fatal("Cannot read control pipe of main loop thread: %s", strerror(errno));
+			continue;
+		}
+		/*the registration may have been removed while polling*/
+		entry = belle_sip_main_loop_epoll_get_entry(ml, (int)(uint32_t)data);
+		if (entry == NULL || entry->generation != (uint32_t)(data >> 32)) continue;
+		events = belle_sip_epoll_to_event(ml->epoll_events[i].events);
+		for (elem = entry->sources; elem != NULL; elem = elem->next) {
+			belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+			unsigned int revents;
+
+			/*cancelled and then among the due timers*/
+			if (s->cancelled) continue;
+			if (s->notify_required) { /*for testing purpose to force channel to read*/
+				revents = BELLE_SIP_EVENT_READ;
+				s->notify_required = 0; /*reset*/
 			} else {
-				belle_sip_error("Source [%p] does not contains any fd !", s);
+				revents = events & (s->events | BELLE_SIP_EVENT_ERROR);
 			}
+			s->revents = revents;
 			if (revents != 0) {
-				to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
+				*to_be_notified =
+				    bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
 			}
-		} else to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
+		}
 	}
-
-	/* Step 3: find timeouted sources */
-	it = bctbx_map_begin(ml->timer_sources);
-	end = bctbx_map_end(ml->timer_sources);
-	while (!bctbx_iterator_equals(it, end)) {
-		/*use first because in case of canceled timer, key != s->expire_ms*/
-		uint64_t expire = bctbx_pair_ullong_get_first((const bctbx_pair_ullong_t *)bctbx_iterator_get_pair(it));
-		belle_sip_source_t *s = (belle_sip_source_t *)bctbx_pair_get_second(bctbx_iterator_get_pair(it));
-		if (expire > cur) {
-			/* no need to continue looping because map is ordered*/
-			break;
-		} else {
+	if (ml->notify_required) {
+		ml->notify_required = FALSE;
+		for (elem = ml->fd_sources; elem != NULL; elem = elem->next) {
+			belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+			if (s->cancelled || !s->notify_required) continue;
+			s->notify_required = 0; /*reset*/
 			if (s->revents == 0) {
-				s->expired = TRUE;
-				to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
-			} /*else already in to_be_notified by Step 2*/
-
-			s->revents |= BELLE_SIP_EVENT_TIMEOUT;
-			it = bctbx_iterator_get_next(it);
+				*to_be_notified =
+				    bctbx_list_append_fast(*to_be_notified, to_be_notified_last, belle_sip_object_ref(s));
+			}
+			s->revents = BELLE_SIP_EVENT_READ;
 		}
 	}
-	bctbx_iterator_delete(it);
-	bctbx_iterator_delete(end);
+	for (elem = ml->removed_while_polling; elem != NULL; elem = elem->next) {
+		belle_sip_object_unref(elem->data);
+	}
+	ml->removed_while_polling = belle_sip_list_free(ml->removed_while_polling);
+	bctbx_mutex_unlock(&ml->sources_mutex);
+	return ret;
+}
+
+#endif
+
+static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
+	bctbx_list_t *elem, *next;
+	int duration = -1;
+	int ret;
+	uint64_t cur;
+	uint64_t next_wakeup_time;
+	belle_sip_source_t *s;
+	bctbx_list_t *to_be_notified = NULL;
+	bctbx_list_t *to_be_notified_last = NULL;
+	int can_clean = belle_sip_object_pool_cleanable(
+	    ml->pool); /*iterate might not be called by the thread that created the main loop*/
+	belle_sip_object_pool_t *tmp_pool = NULL;
+
+	if (!can_clean) {
+		/*Push a temporary pool for the time of the iterate loop*/
+		tmp_pool = belle_sip_object_pool_push();
+	}
+
+	/*Step 1: get the next timeout value */
+	bctbx_mutex_lock(&ml->sources_mutex);
+	next_wakeup_time = belle_sip_timer_wheel_get_next_expiry(&ml->timers);
+	bctbx_mutex_unlock(&ml->sources_mutex);
+	if (next_wakeup_time != UINT64_MAX) {
+		/* compute the amount of time to wait for shortest timeout*/
+		cur = belle_sip_time_ms();
+		if (next_wakeup_time > cur) duration = (int)MIN(next_wakeup_time - cur, INT_MAX);
+		else duration = 0;
+	}
+
+	/* Step 2: wait for events and determine the list of source to be notified */
+#ifdef HAVE_EPOLL
+	if (ml->epoll_fd != -1) ret = belle_sip_main_loop_epoll(ml, duration, &to_be_notified, &to_be_notified_last);
+	else
+#endif
+		ret = belle_sip_main_loop_poll(ml, duration, &to_be_notified, &to_be_notified_last);
+	if (ret == -1) {
+		if (tmp_pool) belle_sip_object_unref(tmp_pool);
+		return;
+	}
+
+	/* Step 3: find timeouted sources */
+	bctbx_mutex_lock(&ml->sources_mutex);
+	cur = belle_sip_time_ms();
+	belle_sip_timer_wheel_expire(&ml->timers, cur);
+	for (s = ml->timers.expired.first; s != NULL; s = s->timer_next) {
+		if (s->revents == 0) {
+			s->expired = TRUE;
+			to_be_notified = bctbx_list_append_fast(to_be_notified, &to_be_notified_last, belle_sip_object_ref(s));
+		} /*else already in to_be_notified by Step 2*/
+
+		s->revents |= BELLE_SIP_EVENT_TIMEOUT;
+	}
 	bctbx_mutex_unlock(&ml->sources_mutex);
 
 	/* Step 4: notify those to be notified */
 	for (elem = to_be_notified; elem != NULL;) {
-		belle_sip_source_t *s = (belle_sip_source_t *)elem->data;
+		s = (belle_sip_source_t *)elem->data;
 		next = elem->next;
 		if (!s->cancelled) {
 
@@ -698,13 +1216,16 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 				belle_sip_main_loop_remove_source(ml, s);
 			} else {
 				bctbx_mutex_lock(&ml->sources_mutex);
-				if (s->expired && s->it) {
-					bctbx_map_erase(ml->timer_sources, s->it);
-					bctbx_iterator_delete(s->it);
-					s->it = NULL;
-					belle_sip_object_unref(s);
+				if (s->timer_slot == &ml->timers.expired) {
+					belle_sip_timer_wheel_remove(&ml->timers, s);
+					if (s->expired) {
+						belle_sip_object_unref(s);
+					} else {
+						/*notified for its fd only, the timeout will be notified at next iteration*/
+						belle_sip_timer_slot_append(&ml->timers, &ml->timers.due, s);
+					}
 				}
-				if (!s->it && s->timeout >= 0) {
+				if (!s->timer_slot && s->timeout >= 0) {
 					/*timeout needs to be started again */
 					if (ret == BELLE_SIP_CONTINUE_WITHOUT_CATCHUP) {
 						s->expire_ms = cur + s->timeout;
@@ -712,8 +1233,7 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 						s->expire_ms += s->timeout;
 					}
 					s->expired = FALSE;
-					s->it = bctbx_map_insert_and_delete_with_returned_it(
-					    ml->timer_sources, (bctbx_pair_t *)bctbx_pair_ullong_new(s->expire_ms, s));
+					belle_sip_timer_wheel_add(&ml->timers, s);
 					belle_sip_object_ref(s);
 				}
 				bctbx_mutex_unlock(&ml->sources_mutex);
@@ -732,9 +1252,6 @@ static void belle_sip_main_loop_iterate(belle_sip_main_loop_t *ml) {
 		belle_sip_object_unref(tmp_pool);
 		tmp_pool = NULL;
 	}
-
-end:
-	belle_sip_free(pfd);
 }
 
 void belle_sip_main_loop_run(belle_sip_main_loop_t *ml) {
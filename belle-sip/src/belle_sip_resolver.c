@@ -18,6 +18,7 @@
  */
 
 #include "belle_sip_internal.h"
+#include "dns_cache.hh"
 #include <bctoolbox/defs.h>
 
 #ifdef HAVE_MDNS
@@ -51,6 +52,12 @@ static const int belle_sip_aaaa_timeout_after_a_received = 3000;
  */
 static const int belle_sip_srv_timeout_after_a_received = 3000;
 
+/* Upper bounds of the time an answer is kept in the stack's DNS cache, in seconds. Negative answers are not kept more
+ * than an hour, as recommended by RFC 2308.
+ */
+static const uint32_t belle_sip_dns_cache_max_ttl = 86400;
+static const uint32_t belle_sip_dns_cache_max_negative_ttl = 3600;
+
 typedef struct belle_sip_simple_resolver_context belle_sip_simple_resolver_context_t;
 #define BELLE_SIP_SIMPLE_RESOLVER_CONTEXT(obj) BELLE_SIP_CAST(obj, belle_sip_simple_resolver_context_t)
 
@@ -311,6 +318,9 @@ struct belle_sip_simple_resolver_context {
 #endif
 #endif
 	bool_t not_using_dns_socket;
+	struct dns_packet *answer;  /* kept until destruction so that it can be shared with the contexts waiting for it */
+	uint8_t dns_cache_owner;    /* this context sends the query the identical ones wait for */
+	uint8_t dns_cache_waiting;  /* this context waits for the answer to an identical query */
 };
 
 struct belle_sip_combined_resolver_context {
@@ -624,8 +634,12 @@ static belle_sip_list_t *srv_select_by_weight(belle_sip_list_t *srv_list) {
 	return srv_list; /*no weight election was necessary, return original list*/
 }
 
+static bctbx_list_t *resolver_dns_cache_complete(belle_sip_simple_resolver_context_t *ctx);
+static void resolver_notify_waiters(belle_sip_simple_resolver_context_t *ctx, bctbx_list_t *waiters);
+
 static void simple_resolver_context_notify(belle_sip_resolver_context_t *obj) {
 	belle_sip_simple_resolver_context_t *ctx = BELLE_SIP_SIMPLE_RESOLVER_CONTEXT(obj);
+	bctbx_list_t *waiters = resolver_dns_cache_complete(ctx);
 	if ((ctx->type == DNS_T_A) || (ctx->type == DNS_T_AAAA)
 #ifdef HAVE_DNS_SERVICE
 	    || (ctx->dns_service_type == kDNSServiceType_A) || (ctx->dns_service_type == kDNSServiceType_AAAA)
@@ -649,6 +663,7 @@ static void simple_resolver_context_notify(belle_sip_resolver_context_t *obj) {
 		ctx->srv_list = srv_select_by_weight(ctx->srv_list);
 		ctx->srv_cb(ctx->srv_cb_data, ctx->name, ctx->srv_list, BELLE_SIP_RESOLVER_CONTEXT(obj)->min_ttl);
 	}
+	resolver_notify_waiters(ctx, waiters);
 }
 
 static void dual_resolver_context_notify(belle_sip_resolver_context_t *obj) {
@@ -708,10 +723,131 @@ static void append_dns_result(belle_sip_simple_resolver_context_t *ctx,
 	belle_sip_message("%s resolved to %s", ctx->name, host);
 }
 
+static void resolver_parse_answer(belle_sip_simple_resolver_context_t *ctx, struct dns_packet *ans) {
+	struct dns_rr_i dns_rr_it;
+	struct dns_rr rr;
+	union dns_any any;
+	int error;
+	enum dns_section section = DNS_S_AN;
+
+	memset(&dns_rr_it, 0, sizeof dns_rr_it);
+	dns_rr_i_init(&dns_rr_it, ans);
+
+	while (dns_rr_grep(&rr, 1, &dns_rr_it, ans, &error)) {
+		if (rr.section == section) {
+			if ((error = dns_any_parse(dns_any_init(&any, sizeof(any)), &rr, ans))) {
+				belle_sip_error("%s dns_any_parse error: %s", __FUNCTION__, dns_strerror(error));
+				break;
+			}
+			if ((ctx->type == DNS_T_AAAA) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_AAAA)) {
+				struct dns_aaaa *aaaa = &any.aaaa;
+				struct sockaddr_in6 sin6;
+				memset(&sin6, 0, sizeof(sin6));
+				memcpy(&sin6.sin6_addr, &aaaa->addr, sizeof(sin6.sin6_addr));
+				sin6.sin6_family = AF_INET6;
+				sin6.sin6_port = ctx->port;
+				append_dns_result(ctx, &ctx->ai_list, (struct sockaddr *)&sin6, sizeof(sin6));
+				if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
+					BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
+			} else if ((ctx->type == DNS_T_A) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_A)) {
+				struct dns_a *a = &any.a;
+				struct sockaddr_in sin;
+				memset(&sin, 0, sizeof(sin));
+				memcpy(&sin.sin_addr, &a->addr, sizeof(sin.sin_addr));
+				sin.sin_family = AF_INET;
+				sin.sin_port = ctx->port;
+				append_dns_result(ctx, &ctx->ai_list, (struct sockaddr *)&sin, sizeof(sin));
+				if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
+					BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
+			} else if ((ctx->type == DNS_T_SRV) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_SRV)) {
+				char host[NI_MAXHOST + 1];
+				struct dns_srv *srv = &any.srv;
+				belle_sip_dns_srv_t *b_srv = belle_sip_dns_srv_create(srv);
+				snprintf(host, sizeof(host), "[target:%s port:%d prio:%d weight:%d]", srv->target, srv->port,
+				         srv->priority, srv->weight);
+				ctx->srv_list =
+				    belle_sip_list_insert_sorted(ctx->srv_list, belle_sip_object_ref(b_srv), srv_compare_prio);
+				belle_sip_message("SRV %s resolved to %s", ctx->name, host);
+				if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
+					BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
+			}
+		}
+	}
+}
+
+/*
+ * Returns for how long an answer can be kept in the DNS cache, in seconds: the lowest TTL of the answer records, or for
+ * a negative answer (NXDOMAIN or no record of the requested type) the SOA minimum of the zone (RFC 2308). Server
+ * failures and negative answers without SOA are not cached.
+ */
+static uint32_t resolver_answer_cache_ttl(belle_sip_simple_resolver_context_t *ctx, struct dns_packet *ans) {
+	struct dns_rr_i dns_rr_it;
+	struct dns_rr rr;
+	union dns_any any;
+	int error;
+	enum dns_rcode rcode = dns_p_rcode(ans);
+	uint32_t answer_ttl = UINT32_MAX;
+	uint32_t negative_ttl = 0;
+	int matching_records = 0;
+
+	if (rcode != DNS_RC_NOERROR && rcode != DNS_RC_NXDOMAIN) return 0;
+
+	memset(&dns_rr_it, 0, sizeof dns_rr_it);
+	dns_rr_i_init(&dns_rr_it, ans);
+	while (dns_rr_grep(&rr, 1, &dns_rr_it, ans, &error)) {
+		if (rr.section == DNS_S_AN) {
+			/* CNAME records of the chain count too, the answer is not valid anymore once one of them expired */
+			if (rr.type == ctx->type) matching_records++;
+			answer_ttl = MIN(answer_ttl, rr.ttl);
+		} else if (rr.section == DNS_S_NS && rr.type == DNS_T_SOA) {
+			if (dns_any_parse(dns_any_init(&any, sizeof(any)), &rr, ans) == 0) {
+				negative_ttl = MIN(rr.ttl, any.soa.minimum);
+			}
+		}
+	}
+	if (rcode == DNS_RC_NOERROR && matching_records > 0) return MIN(answer_ttl, belle_sip_dns_cache_max_ttl);
+	return MIN(negative_ttl, belle_sip_dns_cache_max_negative_ttl);
+}
+
+/* Stores the answer of the query sent by this context, returns the contexts that were waiting for it. */
+static bctbx_list_t *resolver_dns_cache_complete(belle_sip_simple_resolver_context_t *ctx) {
+	struct dns_packet *copy = NULL;
+	uint32_t ttl = 0;
+
+	if (!ctx->dns_cache_owner) return NULL;
+	ctx->dns_cache_owner = FALSE;
+	if (ctx->answer) ttl = resolver_answer_cache_ttl(ctx, ctx->answer);
+	if (ttl > 0) {
+		int error;
+		copy = dns_p_copy(dns_p_make(ctx->answer->end, &error), ctx->answer);
+		belle_sip_message("Caching DNS answer for %s for %u s", ctx->name, ttl);
+	}
+	return belle_sip_dns_cache_complete(ctx->base.stack->dns_cache, ctx->name, ctx->type, ctx, copy, ttl);
+}
+
+/* Gives to each waiting context the answer of the query it waited for (no answer at all if the query failed). */
+static void resolver_notify_waiters(belle_sip_simple_resolver_context_t *ctx, bctbx_list_t *waiters) {
+	bctbx_list_t *it;
+
+	/* the callbacks may cancel the other waiting contexts */
+	for (it = waiters; it != NULL; it = it->next) {
+		belle_sip_simple_resolver_context_t *waiter = (belle_sip_simple_resolver_context_t *)it->data;
+		waiter->dns_cache_waiting = FALSE;
+		belle_sip_object_ref(waiter);
+	}
+	for (it = waiters; it != NULL; it = it->next) {
+		belle_sip_simple_resolver_context_t *waiter = (belle_sip_simple_resolver_context_t *)it->data;
+		if (!waiter->base.notified && !waiter->base.cancelled) {
+			if (ctx->answer) resolver_parse_answer(waiter, ctx->answer);
+			belle_sip_resolver_context_notify(BELLE_SIP_RESOLVER_CONTEXT(waiter));
+		}
+		belle_sip_object_unref(waiter);
+	}
+	bctbx_list_free(waiters);
+}
+
 static int resolver_process_data(belle_sip_simple_resolver_context_t *ctx, unsigned int revents) {
 	struct dns_packet *ans;
-	struct dns_rr_i *I;
-	struct dns_rr_i dns_rr_it;
 	int error;
 	unsigned char simulated_timeout = 0;
 	int timeout = belle_sip_stack_get_dns_timeout(ctx->base.stack);
@@ -734,55 +870,9 @@ static int resolver_process_data(belle_sip_simple_resolver_context_t *ctx, unsig
 	error = dns_res_check(ctx->R);
 
 	if (!error) {
-		struct dns_rr rr;
-		union dns_any any;
-		enum dns_section section = DNS_S_AN;
-
 		ans = dns_res_fetch(ctx->R, &error);
-		memset(&dns_rr_it, 0, sizeof dns_rr_it);
-		I = dns_rr_i_init(&dns_rr_it, ans);
-
-		while (dns_rr_grep(&rr, 1, I, ans, &error)) {
-			if (rr.section == section) {
-				if ((error = dns_any_parse(dns_any_init(&any, sizeof(any)), &rr, ans))) {
-					belle_sip_error("%s dns_any_parse error: %s", __FUNCTION__, dns_strerror(error));
-					break;
-				}
-				if ((ctx->type == DNS_T_AAAA) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_AAAA)) {
-					struct dns_aaaa *aaaa = &any.aaaa;
-					struct sockaddr_in6 sin6;
-					memset(&sin6, 0, sizeof(sin6));
-					memcpy(&sin6.sin6_addr, &aaaa->addr, sizeof(sin6.sin6_addr));
-					sin6.sin6_family = AF_INET6;
-					sin6.sin6_port = ctx->port;
-					append_dns_result(ctx, &ctx->ai_list, (struct sockaddr *)&sin6, sizeof(sin6));
-					if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
-						BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
-				} else if ((ctx->type == DNS_T_A) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_A)) {
-					struct dns_a *a = &any.a;
-					struct sockaddr_in sin;
-					memset(&sin, 0, sizeof(sin));
-					memcpy(&sin.sin_addr, &a->addr, sizeof(sin.sin_addr));
-					sin.sin_family = AF_INET;
-					sin.sin_port = ctx->port;
-					append_dns_result(ctx, &ctx->ai_list, (struct sockaddr *)&sin, sizeof(sin));
-					if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
-						BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
-				} else if ((ctx->type == DNS_T_SRV) && (rr.class == DNS_C_IN) && (rr.type == DNS_T_SRV)) {
-					char host[NI_MAXHOST + 1];
-					struct dns_srv *srv = &any.srv;
-					belle_sip_dns_srv_t *b_srv = belle_sip_dns_srv_create(srv);
-					snprintf(host, sizeof(host), "[target:%s port:%d prio:%d weight:%d]", srv->target, srv->port,
-					         srv->priority, srv->weight);
-					ctx->srv_list =
-					    belle_sip_list_insert_sorted(ctx->srv_list, belle_sip_object_ref(b_srv), srv_compare_prio);
-					belle_sip_message("SRV %s resolved to %s", ctx->name, host);
-					if (rr.ttl < BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl)
-						BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = rr.ttl;
-				}
-			}
-		}
-		free(ans);
+		if (ans) resolver_parse_answer(ctx, ans);
+		ctx->answer = ans;
 #if defined(USE_GETADDRINFO_FALLBACK) || defined(HAVE_MDNS)
 		ctx->getaddrinfo_cancelled = TRUE;
 #endif
@@ -1276,6 +1366,88 @@ static int resolver_process_mdns_browse_result(belle_sip_mdns_source_t *source,
 }
 #endif
 
+static int resolver_dns_cache_usable(belle_sip_simple_resolver_context_t *ctx) {
+	belle_sip_stack_t *stack = ctx->base.stack;
+	/* Don't hide the network failures simulated by the tests */
+	if (!stack->dns_cache_enabled || stack->resolver_send_error || stack->resolver_tx_delay > 0 ||
+	    stack->dns_timeout == 0)
+		return FALSE;
+#ifdef HAVE_MDNS
+	if (is_mdns_query(ctx->name)) return FALSE;
+#endif
+	return TRUE;
+}
+
+static int resolver_process_cached_answer(belle_sip_simple_resolver_context_t *ctx, unsigned int revents) {
+	belle_sip_message("%s resolved from DNS cache", ctx->name);
+	resolver_parse_answer(ctx, ctx->answer);
+	belle_sip_resolver_context_notify(BELLE_SIP_RESOLVER_CONTEXT(ctx));
+	return BELLE_SIP_STOP;
+}
+
+static int _resolver_start_dns_query(belle_sip_simple_resolver_context_t *ctx) {
+	struct dns_options opts;
+	int error;
+	struct dns_resolv_conf *conf;
+
+	if (resolver_dns_cache_usable(ctx)) {
+		belle_sip_dns_cache_t *cache = ctx->base.stack->dns_cache;
+		uint32_t remaining_ttl = 0;
+		const struct dns_packet *cached = belle_sip_dns_cache_lookup(cache, ctx->name, ctx->type, &remaining_ttl);
+		if (cached) {
+			/* The answer is given from the main loop, like a network one, so that the query can still be cancelled */
+			ctx->answer = dns_p_copy(dns_p_make(cached->end, &error), cached);
+			if (ctx->answer) {
+				BELLE_SIP_RESOLVER_CONTEXT(ctx)->min_ttl = remaining_ttl;
+				belle_sip_socket_source_init((belle_sip_source_t *)ctx,
+				                             (belle_sip_source_func_t)resolver_process_cached_answer, ctx, -1,
+				                             BELLE_SIP_EVENT_TIMEOUT, 0);
+				belle_sip_main_loop_add_source(ctx->base.stack->ml, (belle_sip_source_t *)ctx);
+				return 0;
+			}
+		}
+		if (!belle_sip_dns_cache_join(cache, ctx->name, ctx->type, ctx)) {
+			belle_sip_message("%s: waiting for the answer to the query in progress for %s", __FUNCTION__, ctx->name);
+			ctx->dns_cache_waiting = TRUE;
+			return 0;
+		}
+		ctx->dns_cache_owner = TRUE;
+	}
+
+	conf = resconf(ctx);
+	if (conf) {
+		conf->options.recurse = 0;
+		conf->options.timeout = 2;
+		conf->options.attempts = 5;
+	} else return -1;
+	if (!hosts(ctx)) return -1;
+
+	memset(&opts, 0, sizeof opts);
+
+	/* When there are IPv6 nameservers, allow responses to arrive from an IP address that is not the IP address to
+	 * which the request was sent originally. Mac' NAT64 network tend to do this sometimes.*/
+	opts.udp_uses_connect = ctx->resconf->iface.ss_family != AF_INET6;
+	if (!opts.udp_uses_connect) belle_sip_message("Resolver is not using connect().");
+
+	if (!(ctx->R = dns_res_open(ctx->resconf, ctx->hosts, dns_hints_mortal(dns_hints_local(ctx->resconf, &error)),
+	                            cache(ctx), &opts, &error))) {
+		belle_sip_error("%s dns_res_open error [%s]: %s", __FUNCTION__, ctx->name, dns_strerror(error));
+		return -1;
+	}
+	error = 0;
+	if (ctx->base.stack->resolver_tx_delay > 0) {
+		belle_sip_socket_source_init((belle_sip_source_t *)ctx,
+		                             (belle_sip_source_func_t)resolver_process_data_delayed, ctx, -1,
+		                             BELLE_SIP_EVENT_TIMEOUT, ctx->base.stack->resolver_tx_delay + 1000);
+		belle_sip_message("%s DNS resolution delayed by %d ms", __FUNCTION__, ctx->base.stack->resolver_tx_delay);
+	} else {
+		error = _resolver_send_query(ctx);
+	}
+	if (error == 0 && !ctx->base.notified && !ctx->not_using_dns_socket)
+		belle_sip_main_loop_add_source(ctx->base.stack->ml, (belle_sip_source_t *)ctx);
+	return error;
+}
+
 static int _resolver_start_query(belle_sip_simple_resolver_context_t *ctx) {
 	if (!ctx->name) return -1;
 #ifdef HAVE_DNS_SERVICE
@@ -1373,42 +1545,7 @@ static int _resolver_start_query(belle_sip_simple_resolver_context_t *ctx) {
 		}
 	} else {
 #endif
-		struct dns_options opts;
-		int error;
-		struct dns_resolv_conf *conf;
-
-		conf = resconf(ctx);
-		if (conf) {
-			conf->options.recurse = 0;
-			conf->options.timeout = 2;
-			conf->options.attempts = 5;
-		} else return -1;
-		if (!hosts(ctx)) return -1;
-
-		memset(&opts, 0, sizeof opts);
-
-		/* When there are IPv6 nameservers, allow responses to arrive from an IP address that is not the IP address to
-		 * which the request was sent originally. Mac' NAT64 network tend to do this sometimes.*/
-		opts.udp_uses_connect = ctx->resconf->iface.ss_family != AF_INET6;
-		if (!opts.udp_uses_connect) belle_sip_message("Resolver is not using connect().");
-
-		if (!(ctx->R = dns_res_open(ctx->resconf, ctx->hosts, dns_hints_mortal(dns_hints_local(ctx->resconf, &error)),
-		                            cache(ctx), &opts, &error))) {
-			belle_sip_error("%s dns_res_open error [%s]: %s", __FUNCTION__, ctx->name, dns_strerror(error));
-			return -1;
-		}
-		error = 0;
-		if (ctx->base.stack->resolver_tx_delay > 0) {
-			belle_sip_socket_source_init((belle_sip_source_t *)ctx,
-			                             (belle_sip_source_func_t)resolver_process_data_delayed, ctx, -1,
-			                             BELLE_SIP_EVENT_TIMEOUT, ctx->base.stack->resolver_tx_delay + 1000);
-			belle_sip_message("%s DNS resolution delayed by %d ms", __FUNCTION__, ctx->base.stack->resolver_tx_delay);
-		} else {
-			error = _resolver_send_query(ctx);
-		}
-		if (error == 0 && !ctx->base.notified && !ctx->not_using_dns_socket)
-			belle_sip_main_loop_add_source(ctx->base.stack->ml, (belle_sip_source_t *)ctx);
-		return error;
+		return _resolver_start_dns_query(ctx);
 #ifdef HAVE_MDNS
 	}
 #endif
@@ -1511,6 +1648,10 @@ static void belle_sip_simple_resolver_context_destroy(belle_sip_simple_resolver_
 		dns_res_close(ctx->R);
 		ctx->R = NULL;
 	}
+	if (ctx->answer != NULL) {
+		free(ctx->answer);
+		ctx->answer = NULL;
+	}
 	if (ctx->hosts != NULL) {
 		dns_hosts_close(ctx->hosts);
 		ctx->hosts = NULL;
@@ -1555,7 +1696,28 @@ static void belle_sip_dual_resolver_context_destroy(belle_sip_dual_resolver_cont
 }
 
 static void simple_resolver_context_cancel(belle_sip_resolver_context_t *obj) {
+	belle_sip_simple_resolver_context_t *ctx = BELLE_SIP_SIMPLE_RESOLVER_CONTEXT(obj);
 	belle_sip_main_loop_remove_source(obj->stack->ml, (belle_sip_source_t *)obj);
+	if (ctx->dns_cache_owner || ctx->dns_cache_waiting) {
+		bctbx_list_t *waiters = belle_sip_dns_cache_leave(obj->stack->dns_cache, ctx->name, ctx->type, ctx);
+		bctbx_list_t *it;
+		ctx->dns_cache_owner = FALSE;
+		ctx->dns_cache_waiting = FALSE;
+		/* The contexts that waited for the query of this one now have to send their own */
+		for (it = waiters; it != NULL; it = it->next) {
+			belle_sip_simple_resolver_context_t *waiter = (belle_sip_simple_resolver_context_t *)it->data;
+			waiter->dns_cache_waiting = FALSE;
+			belle_sip_object_ref(waiter);
+		}
+		for (it = waiters; it != NULL; it = it->next) {
+			belle_sip_simple_resolver_context_t *waiter = (belle_sip_simple_resolver_context_t *)it->data;
+			if (!waiter->base.notified && !waiter->base.cancelled && _resolver_start_dns_query(waiter) != 0) {
+				belle_sip_resolver_context_notify(BELLE_SIP_RESOLVER_CONTEXT(waiter));
+			}
+			belle_sip_object_unref(waiter);
+		}
+		bctbx_list_free(waiters);
+	}
 }
 
 static void combined_resolver_context_cancel(belle_sip_resolver_context_t *obj) {
@@ -1786,7 +1786,7 @@ void belle_sip_channel_check_dns_reusability(belle_sip_channel_t *obj) {
 
 void belle_sip_channel_set_simulated_recv_return(belle_sip_channel_t *obj, int recv_error) {
 	obj->simulated_recv_return = recv_error;
-	obj->base.notify_required = (recv_error <= 0);
+	belle_sip_source_set_notify_required((belle_sip_source_t *)obj, recv_error <= 0);
 }
 
 const char *belle_sip_channel_get_bank_identifier(const belle_sip_channel_t *obj) {
@@ -275,6 +275,8 @@ void belle_sip_tls_channel_set_client_certificate_key(belle_sip_tls_channel_t *o
 
 #define BELLE_SIP_TLS_CHANNEL(obj) BELLE_SIP_CAST(obj, belle_sip_tls_channel_t)
 
+typedef struct _belle_sip_tls_session_cache belle_sip_tls_session_cache_t;
+
 struct belle_tls_crypto_config {
 	belle_sip_object_t base;
 	char *root_ca;       /**< path to the trusted certificate chain used when verifiying peer certificate */
@@ -289,6 +291,8 @@ struct belle_tls_crypto_config {
 	void *verify_cb_data;
 	belle_tls_crypto_config_postcheck_callback_t postcheck_cb;
 	void *postcheck_cb_data;
+	belle_sip_tls_session_cache_t *session_cache; /**< sessions of the channels using this config, to resume them */
+	int session_resumption_enabled;
 };
 
 typedef struct _belle_sip_channel_bank belle_sip_channel_bank_t;
@@ -7195,7 +7195,9 @@ exec:
 				if (!R->nodata) dns_p_movptr(&R->nodata, &F->answer);
 
 				if (R->search_enabled) dgoto(R->sp, DNS_R_SEARCH);
-				else dgoto(R->sp, DNS_R_FINISH);
+				/* Without search, the answer just stashed is the final one (NXDOMAIN or NODATA) */
+				if (!F->answer) dns_p_movptr(&F->answer, &R->nodata);
+				dgoto(R->sp, DNS_R_FINISH);
 			}
 
 			dns_rr_foreach(&rr, F->answer, .section = DNS_S_NS, .type = DNS_T_NS) {
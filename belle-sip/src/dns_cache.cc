@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "dns_cache.hh"
+
+namespace bellesip {
+
+std::string DnsCache::makeKey(const char *name, int type) {
+	std::string key = std::to_string(type);
+	key += ':';
+	key += name;
+	return key;
+}
+
+const struct dns_packet *DnsCache::lookup(const char *name, int type, uint32_t *remainingTtl) {
+	auto it = mEntries.find(makeKey(name, type));
+	if (it == mEntries.end()) return nullptr;
+	uint64_t now = belle_sip_time_ms();
+	if (it->second.expireTime <= now) {
+		mEntries.erase(it);
+		return nullptr;
+	}
+	if (remainingTtl) *remainingTtl = (uint32_t)((it->second.expireTime - now + 999) / 1000);
+	return it->second.answer.get();
+}
+
+bool DnsCache::join(const char *name, int type, void *query) {
+	auto result = mPendingQueries.emplace(makeKey(name, type), PendingQuery());
+	PendingQuery &pending = result.first->second;
+	if (result.second) {
+		pending.query = query;
+		pending.generation = mGeneration;
+		return true;
+	}
+	pending.waiters.push_back(query);
+	return false;
+}
+
+std::vector<void *>
+DnsCache::complete(const char *name, int type, void *query, struct dns_packet *answer, uint32_t ttl) {
+	std::string key = makeKey(name, type);
+	std::unique_ptr<struct dns_packet, void (*)(void *)> ownedAnswer(answer, free);
+	std::vector<void *> waiters;
+	auto it = mPendingQueries.find(key);
+	if (it == mPendingQueries.end() || it->second.query != query) return waiters;
+	bool upToDate = it->second.generation == mGeneration;
+	waiters = std::move(it->second.waiters);
+	mPendingQueries.erase(it);
+
+	if (!ownedAnswer || ttl == 0 || !upToDate) return waiters;
+	uint64_t now = belle_sip_time_ms();
+	if (mEntries.size() >= sMaxEntries && mEntries.find(key) == mEntries.end()) purge(now);
+	Entry &entry = mEntries[key];
+	entry.answer = std::move(ownedAnswer);
+	entry.expireTime = now + (uint64_t)ttl * 1000;
+	return waiters;
+}
+
+std::vector<void *> DnsCache::leave(const char *name, int type, void *query) {
+	std::vector<void *> waiters;
+	auto it = mPendingQueries.find(makeKey(name, type));
+	if (it == mPendingQueries.end()) return waiters;
+	PendingQuery &pending = it->second;
+	if (pending.query == query) {
+		waiters = std::move(pending.waiters);
+		mPendingQueries.erase(it);
+	} else {
+		pending.waiters.erase(std::remove(pending.waiters.begin(), pending.waiters.end(), query),
+		                      pending.waiters.end());
+	}
+	return waiters;
+}
+
+void DnsCache::purge(uint64_t now) {
+	for (auto it = mEntries.begin(); it != mEntries.end();) {
+		if (it->second.expireTime <= now) it = mEntries.erase(it);
+		else ++it;
+	}
+	if (mEntries.size() < sMaxEntries) return;
+	/* still full of valid answers: make room by dropping the one that would have expired first */
+	using Item = decltype(mEntries)::value_type;
+	auto oldest = std::min_element(mEntries.begin(), mEntries.end(), [](const Item &a, const Item &b) {
+		return a.second.expireTime < b.second.expireTime;
+	});
+	mEntries.erase(oldest);
+}
+
+void DnsCache::clear() {
+	mEntries.clear();
+	++mGeneration;
+}
+
+size_t DnsCache::getCount() const {
+	return mEntries.size();
+}
+
+} // namespace bellesip
+
+using namespace bellesip;
+
+static bctbx_list_t *queries_to_list(const std::vector<void *> &queries) {
+	bctbx_list_t *list = nullptr;
+	for (auto it = queries.rbegin(); it != queries.rend(); ++it) {
+		list = bctbx_list_prepend(list, *it);
+	}
+	return list;
+}
+
+belle_sip_dns_cache_t *belle_sip_dns_cache_new(void) {
+	return (new DnsCache())->toC();
+}
+
+const struct dns_packet *
+belle_sip_dns_cache_lookup(belle_sip_dns_cache_t *obj, const char *name, int type, uint32_t *remaining_ttl) {
+	return DnsCache::toCpp(obj)->lookup(name, type, remaining_ttl);
+}
+
+int belle_sip_dns_cache_join(belle_sip_dns_cache_t *obj, const char *name, int type, void *query) {
+	return DnsCache::toCpp(obj)->join(name, type, query) ? TRUE : FALSE;
+}
+
+bctbx_list_t *belle_sip_dns_cache_complete(
+    belle_sip_dns_cache_t *obj, const char *name, int type, void *query, struct dns_packet *answer, uint32_t ttl) {
+	return queries_to_list(DnsCache::toCpp(obj)->complete(name, type, query, answer, ttl));
+}
+
+bctbx_list_t *belle_sip_dns_cache_leave(belle_sip_dns_cache_t *obj, const char *name, int type, void *query) {
+	return queries_to_list(DnsCache::toCpp(obj)->leave(name, type, query));
+}
+
+void belle_sip_dns_cache_clear(belle_sip_dns_cache_t *obj) {
+	DnsCache::toCpp(obj)->clear();
+}
+
+size_t belle_sip_dns_cache_get_count(belle_sip_dns_cache_t *obj) {
+	return DnsCache::toCpp(obj)->getCount();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef dns_cache_h
+#define dns_cache_h
+
+#include "belle_sip_internal.h"
+
+struct dns_packet;
+
+#ifdef __cplusplus
+
+#include "belle-sip/object++.hh"
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bellesip {
+
+/*
+ * Stack-wide cache of DNS answers, keyed by query name and type. The resolver decides for how long an answer can be
+ * kept (TTL of the records, or SOA minimum for NXDOMAIN/NODATA answers). The cache also tracks the queries in flight,
+ * so that concurrent resolutions of the same name wait for the answer of the first one instead of sending their own
+ * query. Queries and waiters are opaque pointers owned by the resolver.
+ */
+class DnsCache : public HybridObject<belle_sip_dns_cache_t, DnsCache> {
+public:
+	static constexpr size_t sMaxEntries = 1024;
+
+	explicit DnsCache() = default;
+	DnsCache(const DnsCache &) = delete;
+	// The returned packet is owned by the cache and remains valid until the next modification of the cache.
+	const struct dns_packet *lookup(const char *name, int type, uint32_t *remainingTtl);
+	// Returns true if query has to be sent by the caller, false if it has been queued behind an identical one.
+	bool join(const char *name, int type, void *query);
+	// Ends the query, storing answer (if not null) for ttl seconds. Returns the queries that waited for it.
+	std::vector<void *> complete(const char *name, int type, void *query, struct dns_packet *answer, uint32_t ttl);
+	// Removes a query, returns the ones that waited for it if it was the one in flight.
+	std::vector<void *> leave(const char *name, int type, void *query);
+	void clear();
+	size_t getCount() const;
+
+private:
+	struct Entry {
+		std::unique_ptr<struct dns_packet, void (*)(void *)> answer{nullptr, free};
+		uint64_t expireTime = 0;
+	};
+	struct PendingQuery {
+		void *query = nullptr;
+		std::vector<void *> waiters;
+		unsigned int generation = 0;
+	};
+	static std::string makeKey(const char *name, int type);
+	void purge(uint64_t now);
+
+	std::unordered_map<std::string, Entry> mEntries;
+	std::unordered_map<std::string, PendingQuery> mPendingQueries;
+	// Bumped by clear(), answers to queries sent before are not stored.
+	unsigned int mGeneration = 0;
+};
+
+} // namespace bellesip
+
+extern "C" {
+#endif
+
+belle_sip_dns_cache_t *belle_sip_dns_cache_new(void);
+
+/* Returns the cached answer to the query, NULL if there is none or it expired. */
+const struct dns_packet *
+belle_sip_dns_cache_lookup(belle_sip_dns_cache_t *obj, const char *name, int type, uint32_t *remaining_ttl);
+
+/* Returns TRUE if the query has to be sent, FALSE if it waits for the answer of an identical query in flight. */
+int belle_sip_dns_cache_join(belle_sip_dns_cache_t *obj, const char *name, int type, void *query);
+
+/* Ends the query in flight. The cache takes the ownership of answer (which can be NULL) and keeps it for ttl seconds.
+ * Returns the list of queries that were waiting for this answer, to be freed by the caller. */
+bctbx_list_t *belle_sip_dns_cache_complete(
+    belle_sip_dns_cache_t *obj, const char *name, int type, void *query, struct dns_packet *answer, uint32_t ttl);
+
+/* Removes a query, either in flight or waiting. If it was in flight, returns the list of the queries that were
+ * waiting for it, none of them being in flight anymore. */
+bctbx_list_t *belle_sip_dns_cache_leave(belle_sip_dns_cache_t *obj, const char *name, int type, void *query);
+
+void belle_sip_dns_cache_clear(belle_sip_dns_cache_t *obj);
+
+size_t belle_sip_dns_cache_get_count(belle_sip_dns_cache_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "list_index.hh"
+
+namespace bellesip {
+
+void ListIndex::add(const char *key, belle_sip_list_t *link) {
+	mLinksByKey[key].push_back(link);
+	++mCount;
+}
+
+belle_sip_list_t *ListIndex::remove(const char *key, const void *data) {
+	auto map_it = mLinksByKey.find(key);
+	if (map_it == mLinksByKey.end()) return nullptr;
+	auto &links = map_it->second;
+	auto it = std::find_if(links.begin(), links.end(), [data](belle_sip_list_t *link) { return link->data == data; });
+	if (it == links.end()) return nullptr;
+	belle_sip_list_t *link = *it;
+	links.erase(it);
+	if (links.empty()) mLinksByKey.erase(map_it);
+	--mCount;
+	return link;
+}
+
+void *ListIndex::find(const char *key, belle_sip_compare_func func, const void *user_data) const {
+	auto map_it = mLinksByKey.find(key);
+	if (map_it == mLinksByKey.end()) return nullptr;
+	/* elements are prepended to the list, so the most recent ones are the first to be matched */
+	for (auto it = map_it->second.rbegin(); it != map_it->second.rend(); ++it) {
+		if (func((*it)->data, user_data) == 0) return (*it)->data;
+	}
+	return nullptr;
+}
+
+void ListIndex::forEach(const char *key, void (*func)(void *, void *), void *user_data) const {
+	auto map_it = mLinksByKey.find(key);
+	if (map_it == mLinksByKey.end()) return;
+	for (auto it = map_it->second.rbegin(); it != map_it->second.rend(); ++it) {
+		func((*it)->data, user_data);
+	}
+}
+
+size_t ListIndex::getCount() const {
+	return mCount;
+}
+
+} // namespace bellesip
+
+using namespace bellesip;
+
+belle_sip_list_index_t *belle_sip_list_index_new(void) {
+	return (new ListIndex())->toC();
+}
+
+void belle_sip_list_index_prepend(belle_sip_list_index_t *obj, belle_sip_list_t **list, const char *key, void *data) {
+	*list = belle_sip_list_prepend(*list, data);
+	ListIndex::toCpp(obj)->add(key, *list);
+}
+
+int belle_sip_list_index_remove(belle_sip_list_index_t *obj, belle_sip_list_t **list, const char *key, void *data) {
+	belle_sip_list_t *link = ListIndex::toCpp(obj)->remove(key, data);
+	if (link == nullptr) return FALSE;
+	*list = belle_sip_list_delete_link(*list, link);
+	return TRUE;
+}
+
+void *belle_sip_list_index_find(belle_sip_list_index_t *obj,
+                                const char *key,
+                                belle_sip_compare_func func,
+                                const void *user_data) {
+	return ListIndex::toCpp(obj)->find(key, func, user_data);
+}
+
+void belle_sip_list_index_for_each(belle_sip_list_index_t *obj,
+                                   const char *key,
+                                   void (*func)(void *, void *),
+                                   void *user_data) {
+	ListIndex::toCpp(obj)->forEach(key, func, user_data);
+}
+
+size_t belle_sip_list_index_get_count(belle_sip_list_index_t *obj) {
+	return ListIndex::toCpp(obj)->getCount();
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef list_index_h
+#define list_index_h
+
+#include "belle_sip_internal.h"
+
+#ifdef __cplusplus
+
+#include "belle-sip/object++.hh"
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bellesip {
+
+/*
+ * Hash index over the elements of a belle_sip_list_t, keyed by a string that must not change while the element is
+ * indexed (call-id of a dialog, branch of a transaction...). The list keeps the ownership of the elements, the index
+ * remembers their link so that they can be removed from the list without walking it.
+ */
+class ListIndex : public HybridObject<belle_sip_list_index_t, ListIndex> {
+public:
+	explicit ListIndex() = default;
+	ListIndex(const ListIndex &) = delete;
+	void add(const char *key, belle_sip_list_t *link);
+	belle_sip_list_t *remove(const char *key, const void *data);
+	// Returns the most recently added element of key for which func returns 0, like belle_sip_list_find_custom().
+	void *find(const char *key, belle_sip_compare_func func, const void *user_data) const;
+	void forEach(const char *key, void (*func)(void *, void *), void *user_data) const;
+	size_t getCount() const;
+
+private:
+	std::unordered_map<std::string, std::vector<belle_sip_list_t *>> mLinksByKey;
+	size_t mCount = 0;
+};
+
+} // namespace bellesip
+
+extern "C" {
+#endif
+
+belle_sip_list_index_t *belle_sip_list_index_new(void);
+
+/* Prepends data to *list and indexes it with key. */
+void belle_sip_list_index_prepend(belle_sip_list_index_t *obj, belle_sip_list_t **list, const char *key, void *data);
+
+/* Removes data from *list and from the index, returns FALSE if it was not indexed with key. */
+int belle_sip_list_index_remove(belle_sip_list_index_t *obj, belle_sip_list_t **list, const char *key, void *data);
+
+void *belle_sip_list_index_find(belle_sip_list_index_t *obj,
+                                const char *key,
+                                belle_sip_compare_func func,
+                                const void *user_data);
+
+void belle_sip_list_index_for_each(belle_sip_list_index_t *obj,
+                                   const char *key,
+                                   void (*func)(void *, void *),
+                                   void *user_data);
+
+size_t belle_sip_list_index_get_count(belle_sip_list_index_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -125,7 +125,7 @@ belle_sip_message_t *belle_sip_message_parse(const char *value) {
 
 belle_sip_message_t *belle_sip_message_parse_raw(const char *buff, size_t buff_length, size_t *message_length) {
 	auto parser = bellesip::SIP::Parser::getInstance();
-	auto object = parser->parse(buff, "message", message_length);
+	auto object = parser->parse(string_view(buff, buff_length), "message", message_length);
 	if (object) {
 		auto context = BELLE_SIP_PARSER_CONTEXT(object);
 		belle_sip_message_t *message = reinterpret_cast<belle_sip_message_t *>(context->obj);
@@ -19,6 +19,7 @@
 
 #include "belle-sip/message.h"
 #include "belle_sip_internal.h"
+#include "list_index.hh"
 #include "listeningpoint_internal.h"
 #include "md5.h"
 
@@ -101,6 +102,9 @@ static void belle_sip_provider_uninit(belle_sip_provider_t *p) {
 	p->auth_contexts =
 	    belle_sip_list_free_with_data(p->auth_contexts, (void (*)(void *))belle_sip_authorization_destroy);
 	p->dialogs = belle_sip_list_free_with_data(p->dialogs, belle_sip_object_unref);
+	belle_sip_object_unref(p->client_transactions_index);
+	belle_sip_object_unref(p->server_transactions_index);
+	belle_sip_object_unref(p->dialogs_index);
 	p->lps = belle_sip_list_free_with_data(p->lps, belle_sip_object_unref);
 }
 
@@ -610,6 +614,9 @@ belle_sip_provider_t *belle_sip_provider_new(belle_sip_stack_t *s, belle_sip_lis
 	p->rport_enabled = 1;
 	p->unconditional_answer = 480;
 	p->response_integrity_checking_enabled = TRUE;
+	p->client_transactions_index = belle_sip_list_index_new();
+	p->server_transactions_index = belle_sip_list_index_new();
+	p->dialogs_index = belle_sip_list_index_new();
 	if (lp) belle_sip_provider_add_listening_point(p, lp);
 	return p;
 }
@@ -731,31 +738,44 @@ belle_sip_dialog_t *belle_sip_provider_create_dialog_internal(belle_sip_provider
 	return dialog;
 }
 
+struct dialog_matcher {
+	const char *call_id;
+	const char *local_tag;
+	const char *remote_tag;
+	belle_sip_dialog_t *returned_dialog;
+};
+
+static void dialog_match(void *p_dialog, void *p_matcher) {
+	belle_sip_dialog_t *dialog = (belle_sip_dialog_t *)p_dialog;
+	struct dialog_matcher *matcher = (struct dialog_matcher *)p_matcher;
+	/*ignore dialog in state BELLE_SIP_DIALOG_NULL, is it really the correct things to do*/
+	if (belle_sip_dialog_get_state(dialog) != BELLE_SIP_DIALOG_NULL &&
+	    _belle_sip_dialog_match(dialog, matcher->call_id, matcher->local_tag, matcher->remote_tag)) {
+		if (!matcher->returned_dialog) matcher->returned_dialog = dialog;
+		else {
+			belle_sip_fatal("More than 1 dialog is matching, check your app");
+		}
+	}
+}
+
 static belle_sip_dialog_t *_belle_sip_provider_find_dialog(const belle_sip_provider_t *prov,
                                                            const char *call_id,
                                                            const char *local_tag,
                                                            const char *remote_tag,
                                                            bool_t local_tag_mandatory) {
-	belle_sip_list_t *iterator;
-	belle_sip_dialog_t *returned_dialog = NULL;
+	struct dialog_matcher matcher;
 
 	if (call_id == NULL || (local_tag_mandatory && (local_tag == NULL)) || remote_tag == NULL) {
 		return NULL;
 	}
 
-	for (iterator = prov->dialogs; iterator != NULL; iterator = iterator->next) {
-		belle_sip_dialog_t *dialog = (belle_sip_dialog_t *)iterator->data;
-		dialog = (belle_sip_dialog_t *)iterator->data;
-		/*ignore dialog in state BELLE_SIP_DIALOG_NULL, is it really the correct things to do*/
-		if (belle_sip_dialog_get_state(dialog) != BELLE_SIP_DIALOG_NULL &&
-		    _belle_sip_dialog_match(dialog, call_id, local_tag, remote_tag)) {
-			if (!returned_dialog) returned_dialog = dialog;
-			else {
-				belle_sip_fatal("More than 1 dialog is matching, check your app");
-			}
-		}
-	}
-	return returned_dialog;
+	/*only the dialogs sharing the call-id need to be compared*/
+	matcher.call_id = call_id;
+	matcher.local_tag = local_tag;
+	matcher.remote_tag = remote_tag;
+	matcher.returned_dialog = NULL;
+	belle_sip_list_index_for_each(prov->dialogs_index, call_id, dialog_match, &matcher);
+	return matcher.returned_dialog;
 }
 /*find a dialog given the call id, local-tag and to-tag*/
 belle_sip_dialog_t *belle_sip_provider_find_dialog(const belle_sip_provider_t *prov,
@@ -806,7 +826,8 @@ belle_sip_provider_find_dialog_from_message(belle_sip_provider_t *prov, belle_si
 }
 
 void belle_sip_provider_add_dialog(belle_sip_provider_t *prov, belle_sip_dialog_t *dialog) {
-	prov->dialogs = belle_sip_list_prepend(prov->dialogs, belle_sip_object_ref(dialog));
+	belle_sip_list_index_prepend(prov->dialogs_index, &prov->dialogs,
+	                             belle_sip_header_call_id_get_call_id(dialog->call_id), belle_sip_object_ref(dialog));
 }
 
 static void notify_dialog_terminated(belle_sip_dialog_terminated_event_t *ev) {
@@ -820,7 +841,8 @@ void belle_sip_provider_remove_dialog(belle_sip_provider_t *prov, belle_sip_dial
 	ev->source = prov;
 	ev->dialog = dialog;
 	ev->is_expired = dialog->is_expired;
-	prov->dialogs = belle_sip_list_remove(prov->dialogs, dialog);
+	belle_sip_list_index_remove(prov->dialogs_index, &prov->dialogs,
+	                            belle_sip_header_call_id_get_call_id(dialog->call_id), dialog);
 	belle_sip_main_loop_do_later(belle_sip_stack_get_main_loop(prov->stack),
 	                             (belle_sip_callback_t)notify_dialog_terminated, ev);
 }
@@ -986,7 +1008,8 @@ void belle_sip_provider_set_transaction_terminated(belle_sip_provider_t *p, bell
 }
 
 void belle_sip_provider_add_client_transaction(belle_sip_provider_t *prov, belle_sip_client_transaction_t *t) {
-	prov->client_transactions = belle_sip_list_prepend(prov->client_transactions, belle_sip_object_ref(t));
+	belle_sip_list_index_prepend(prov->client_transactions_index, &prov->client_transactions, t->base.branch_id,
+	                             belle_sip_object_ref(t));
 }
 
 struct client_transaction_matcher {
@@ -1010,7 +1033,6 @@ belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transact
 	belle_sip_header_cseq_t *cseq =
 	    (belle_sip_header_cseq_t *)belle_sip_message_get_header((belle_sip_message_t *)resp, "cseq");
 	belle_sip_client_transaction_t *ret = NULL;
-	belle_sip_list_t *elem;
 	if (via == NULL) {
 		belle_sip_warning("Response has no via.");
 		return NULL;
@@ -1030,18 +1052,17 @@ belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transact
 		belle_sip_warning("Response has missing method in cseq.");
 		return NULL;
 	}
-	elem = belle_sip_list_find_custom(prov->client_transactions, client_transaction_match, &matcher);
-	if (elem) {
-		ret = (belle_sip_client_transaction_t *)elem->data;
+	ret = (belle_sip_client_transaction_t *)belle_sip_list_index_find(
+	    prov->client_transactions_index, matcher.branchid, client_transaction_match, &matcher);
+	if (ret) {
 		belle_sip_message("Found transaction matching response.");
 	}
 	return ret;
 }
 
 void belle_sip_provider_remove_client_transaction(belle_sip_provider_t *prov, belle_sip_client_transaction_t *t) {
-	belle_sip_list_t *elem = belle_sip_list_find(prov->client_transactions, t);
-	if (elem) {
-		prov->client_transactions = belle_sip_list_delete_link(prov->client_transactions, elem);
+	if (belle_sip_list_index_remove(prov->client_transactions_index, &prov->client_transactions, t->base.branch_id,
+	                                t)) {
 		belle_sip_object_unref(t);
 	} else {
 		belle_sip_error("trying to remove transaction [%p] not part of provider [%p]", t, prov);
@@ -1049,7 +1070,8 @@ void belle_sip_provider_remove_client_transaction(belle_sip_provider_t *prov, be
 }
 
 void belle_sip_provider_add_server_transaction(belle_sip_provider_t *prov, belle_sip_server_transaction_t *t) {
-	prov->server_transactions = belle_sip_list_prepend(prov->server_transactions, belle_sip_object_ref(t));
+	belle_sip_list_index_prepend(prov->server_transactions_index, &prov->server_transactions, t->base.branch_id,
+	                             belle_sip_object_ref(t));
 }
 
 struct transaction_matcher {
@@ -1070,13 +1092,12 @@ static int transaction_match(const void *p_tr, const void *p_matcher) {
 	return -1;
 }
 
-belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_list_t *transactions,
-                                                                      belle_sip_request_t *req) {
+static belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_list_index_t *transactions,
+                                                                             belle_sip_request_t *req) {
 	struct transaction_matcher matcher;
 	belle_sip_header_via_t *via =
 	    (belle_sip_header_via_t *)belle_sip_message_get_header((belle_sip_message_t *)req, "via");
 	belle_sip_transaction_t *ret = NULL;
-	belle_sip_list_t *elem = NULL;
 	const char *branch;
 	char token[BELLE_SIP_BRANCH_ID_LENGTH] = {0};
 
@@ -1093,27 +1114,27 @@ belle_sip_transaction_t *belle_sip_provider_find_matching_transaction(belle_sip_
 		belle_sip_message("Message from old RFC2543 stack, computed branch is %s", token);
 	}
 
-	elem = belle_sip_list_find_custom(transactions, transaction_match, &matcher);
+	ret = (belle_sip_transaction_t *)belle_sip_list_index_find(transactions, matcher.branchid, transaction_match,
+	                                                           &matcher);
 
-	if (elem) {
-		ret = (belle_sip_transaction_t *)elem->data;
+	if (ret) {
 		belle_sip_message("Found transaction [%p] matching request.", ret);
 	}
 	return ret;
 }
 belle_sip_server_transaction_t *belle_sip_provider_find_matching_server_transaction(belle_sip_provider_t *prov,
                                                                                     belle_sip_request_t *req) {
-	belle_sip_transaction_t *ret = belle_sip_provider_find_matching_transaction(prov->server_transactions, req);
+	belle_sip_transaction_t *ret = belle_sip_provider_find_matching_transaction(prov->server_transactions_index, req);
 	return ret ? BELLE_SIP_SERVER_TRANSACTION(ret) : NULL;
 }
 belle_sip_client_transaction_t *belle_sip_provider_find_matching_client_transaction_from_req(belle_sip_provider_t *prov,
                                                                                              belle_sip_request_t *req) {
-	belle_sip_transaction_t *ret = belle_sip_provider_find_matching_transaction(prov->client_transactions, req);
+	belle_sip_transaction_t *ret = belle_sip_provider_find_matching_transaction(prov->client_transactions_index, req);
 	return ret ? BELLE_SIP_CLIENT_TRANSACTION(ret) : NULL;
 }
 
 void belle_sip_provider_remove_server_transaction(belle_sip_provider_t *prov, belle_sip_server_transaction_t *t) {
-	prov->server_transactions = belle_sip_list_remove(prov->server_transactions, t);
+	belle_sip_list_index_remove(prov->server_transactions_index, &prov->server_transactions, t->base.branch_id, t);
 	belle_sip_object_unref(t);
 }
 
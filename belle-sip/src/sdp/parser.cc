@@ -176,7 +176,7 @@ bellesip::SDP::Parser::Parser() {
 	    ->setCollector("fmt", make_fn(&belle_sdp_media_media_formats_add));
 }
 
-void *bellesip::SDP::Parser::parse(const string &input, const string &rule) {
+void *bellesip::SDP::Parser::parse(string_view input, const string &rule) {
 	string parsedRule = rule;
 	size_t parsedSize = 0;
 	replace(parsedRule.begin(), parsedRule.end(), '_', '-');
@@ -27,7 +27,7 @@ namespace SDP {
 class Parser {
 public:
 	static Parser *getInstance();
-	void *parse(const string &input, const string &rule);
+	void *parse(string_view input, const string &rule);
 
 private:
 	static Parser *instance;
@@ -427,7 +427,7 @@ bellesip::SIP::Parser::Parser() {
 	    ->setCollector("header-value", make_fn(&belle_sip_header_extension_set_value));
 }
 
-void *bellesip::SIP::Parser::parse(const string &input, const string &rule, size_t *parsedSize, bool fullMatch) {
+void *bellesip::SIP::Parser::parse(string_view input, const string &rule, size_t *parsedSize, bool fullMatch) {
 	string parsedRule = rule;
 	*parsedSize = 0;
 	replace(parsedRule.begin(), parsedRule.end(), '_', '-');
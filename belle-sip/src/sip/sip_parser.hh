@@ -29,7 +29,7 @@ namespace SIP {
 class Parser {
 public:
 	static Parser *getInstance();
-	void *parse(const string &input, const string &rule, size_t *parsedSize, bool fullMatch = false);
+	void *parse(string_view input, const string &rule, size_t *parsedSize, bool fullMatch = false);
 
 private:
 	static Parser *instance;
@@ -18,6 +18,7 @@
  */
 
 #include "belle_sip_internal.h"
+#include "dns_cache.hh"
 #include "listeningpoint_internal.h"
 
 static int belle_sip_well_known_port = 5060;
@@ -172,6 +173,7 @@ static void belle_sip_stack_destroy(belle_sip_stack_t *stack) {
 	if (stack->http_proxy_passwd) belle_sip_free(stack->http_proxy_passwd);
 	if (stack->http_proxy_username) belle_sip_free(stack->http_proxy_username);
 	belle_sip_list_free_with_data(stack->dns_servers, belle_sip_free);
+	belle_sip_object_unref(stack->dns_cache);
 #ifdef HAVE_DNS_SERVICE
 	if (stack->dns_service_queue) {
 		dispatch_release(stack->dns_service_queue);
@@ -196,6 +198,8 @@ belle_sip_stack_t *belle_sip_stack_new(const char *properties) {
 	stack->dns_timeout = 15000;
 	stack->dns_srv_enabled = TRUE;
 	stack->dns_search_enabled = TRUE;
+	stack->dns_cache_enabled = TRUE;
+	stack->dns_cache = belle_sip_dns_cache_new();
 	stack->inactive_transport_timeout = 3600; /*one hour*/
 	stack->pong_timeout = 10;                 /* 10 seconds*/
 	stack->ping_pong_verification = TRUE;
@@ -214,6 +218,7 @@ belle_sip_stack_t *belle_sip_stack_new(const char *properties) {
 }
 
 void belle_sip_stack_add_user_host_entry(belle_sip_stack_t *stack, const char *ip, const char *hostname) {
+	belle_sip_dns_cache_clear(stack->dns_cache);
 	stack->user_host_entries = bctbx_list_append(stack->user_host_entries, belle_sip_param_pair_new(ip, hostname));
 }
 const belle_sip_timer_config_t *belle_sip_stack_get_timer_config(const belle_sip_stack_t *stack) {
@@ -294,9 +299,23 @@ unsigned char belle_sip_stack_dns_search_enabled(const belle_sip_stack_t *stack)
 }
 
 void belle_sip_stack_enable_dns_search(belle_sip_stack_t *stack, unsigned char enable) {
+	if (stack->dns_search_enabled != enable) belle_sip_dns_cache_clear(stack->dns_cache);
 	stack->dns_search_enabled = enable;
 }
 
+unsigned char belle_sip_stack_dns_cache_enabled(const belle_sip_stack_t *stack) {
+	return stack->dns_cache_enabled;
+}
+
+void belle_sip_stack_enable_dns_cache(belle_sip_stack_t *stack, unsigned char enable) {
+	if (!enable) belle_sip_dns_cache_clear(stack->dns_cache);
+	stack->dns_cache_enabled = enable;
+}
+
+void belle_sip_stack_clear_dns_cache(belle_sip_stack_t *stack) {
+	belle_sip_dns_cache_clear(stack->dns_cache);
+}
+
 belle_sip_listening_point_t *
 belle_sip_stack_create_listening_point(belle_sip_stack_t *s, const char *ipaddress, int port, const char *transport) {
 	belle_sip_listening_point_t *lp = NULL;
@@ -392,6 +411,7 @@ const char *belle_sip_stack_get_dns_user_hosts_file(const belle_sip_stack_t *sta
 void belle_sip_stack_set_dns_user_hosts_file(belle_sip_stack_t *stack, const char *hosts_file) {
 	if (stack->dns_user_hosts_file) belle_sip_free(stack->dns_user_hosts_file);
 	stack->dns_user_hosts_file = hosts_file ? belle_sip_strdup(hosts_file) : NULL;
+	belle_sip_dns_cache_clear(stack->dns_cache);
 }
 
 const char *belle_sip_stack_get_dns_resolv_conf_file(const belle_sip_stack_t *stack) {
@@ -401,6 +421,7 @@ const char *belle_sip_stack_get_dns_resolv_conf_file(const belle_sip_stack_t *st
 void belle_sip_stack_set_dns_resolv_conf_file(belle_sip_stack_t *stack, const char *resolv_conf_file) {
 	if (stack->dns_resolv_conf) belle_sip_free(stack->dns_resolv_conf);
 	stack->dns_resolv_conf = resolv_conf_file ? belle_sip_strdup(resolv_conf_file) : NULL;
+	belle_sip_dns_cache_clear(stack->dns_cache);
 }
 
 void belle_sip_stack_set_ip_version_preference(belle_sip_stack_t *stack, int family) {
@@ -419,6 +440,7 @@ void belle_sip_stack_set_dns_servers(belle_sip_stack_t *stack, const belle_sip_l
 		belle_sip_list_free_with_data(stack->dns_servers, belle_sip_free);
 	}
 	stack->dns_servers = newservers;
+	belle_sip_dns_cache_clear(stack->dns_cache);
 }
 
 const char *belle_sip_version_to_string(void) {
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "tls_session_cache.hh"
+
+namespace bellesip {
+
+const bctbx_ssl_session_t *TlsSessionCache::lookup(const std::string &key) {
+	auto it = mEntries.find(key);
+	if (it == mEntries.end()) return nullptr;
+	it->second.lastUse = ++mUseCounter;
+	return it->second.session.get();
+}
+
+bool TlsSessionCache::store(const std::string &key, bctbx_ssl_context_t *sslCtx) {
+	std::unique_ptr<bctbx_ssl_session_t, void (*)(bctbx_ssl_session_t *)> session(bctbx_ssl_session_new(),
+	                                                                              bctbx_ssl_session_free);
+	if (bctbx_ssl_get_session(sslCtx, session.get()) != 0) {
+		remove(key);
+		return false;
+	}
+	if (mEntries.size() >= sMaxEntries && mEntries.find(key) == mEntries.end()) purge();
+	Entry &entry = mEntries[key];
+	entry.session = std::move(session);
+	entry.lastUse = ++mUseCounter;
+	return true;
+}
+
+void TlsSessionCache::remove(const std::string &key) {
+	mEntries.erase(key);
+}
+
+void TlsSessionCache::purge() {
+	/* drop the session of the peer we did not connect to for the longest time */
+	using Item = decltype(mEntries)::value_type;
+	auto oldest = std::min_element(mEntries.begin(), mEntries.end(),
+	                               [](const Item &a, const Item &b) { return a.second.lastUse < b.second.lastUse; });
+	if (oldest != mEntries.end()) mEntries.erase(oldest);
+}
+
+void TlsSessionCache::clear() {
+	mEntries.clear();
+}
+
+size_t TlsSessionCache::getCount() const {
+	return mEntries.size();
+}
+
+void TlsSessionCache::countHandshake(bool resumed) {
+	if (resumed) mResumedHandshakes++;
+	else mFullHandshakes++;
+}
+
+unsigned int TlsSessionCache::getHandshakeCount(bool resumed) const {
+	return resumed ? mResumedHandshakes : mFullHandshakes;
+}
+
+} // namespace bellesip
+
+using namespace bellesip;
+
+belle_sip_tls_session_cache_t *belle_sip_tls_session_cache_new(void) {
+	return (new TlsSessionCache())->toC();
+}
+
+const bctbx_ssl_session_t *belle_sip_tls_session_cache_lookup(belle_sip_tls_session_cache_t *obj, const char *key) {
+	return TlsSessionCache::toCpp(obj)->lookup(key);
+}
+
+int belle_sip_tls_session_cache_store(belle_sip_tls_session_cache_t *obj, const char *key, bctbx_ssl_context_t *ssl_ctx) {
+	return TlsSessionCache::toCpp(obj)->store(key, ssl_ctx) ? 0 : -1;
+}
+
+void belle_sip_tls_session_cache_remove(belle_sip_tls_session_cache_t *obj, const char *key) {
+	TlsSessionCache::toCpp(obj)->remove(key);
+}
+
+void belle_sip_tls_session_cache_clear(belle_sip_tls_session_cache_t *obj) {
+	TlsSessionCache::toCpp(obj)->clear();
+}
+
+size_t belle_sip_tls_session_cache_get_count(belle_sip_tls_session_cache_t *obj) {
+	return TlsSessionCache::toCpp(obj)->getCount();
+}
+
+void belle_sip_tls_session_cache_count_handshake(belle_sip_tls_session_cache_t *obj, int resumed) {
+	TlsSessionCache::toCpp(obj)->countHandshake(!!resumed);
+}
+
+unsigned int belle_sip_tls_session_cache_get_handshake_count(belle_sip_tls_session_cache_t *obj, int resumed) {
+	return TlsSessionCache::toCpp(obj)->getHandshakeCount(!!resumed);
+}
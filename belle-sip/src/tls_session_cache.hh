@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of belle-sip.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef tls_session_cache_h
+#define tls_session_cache_h
+
+#include "belle_sip_internal.h"
+
+#ifdef __cplusplus
+
+#include "belle-sip/object++.hh"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace bellesip {
+
+/*
+ * TLS sessions negotiated by the client channels sharing a crypto config, keyed by the peer they were negotiated with.
+ * A session is saved when its connection is closed and offered to the server on the next connection to the same peer,
+ * which saves a full handshake if the server accepts to resume it. Counts the full and resumed handshakes.
+ */
+class TlsSessionCache : public HybridObject<belle_sip_tls_session_cache_t, TlsSessionCache> {
+public:
+	static constexpr size_t sMaxEntries = 64;
+
+	explicit TlsSessionCache() = default;
+	TlsSessionCache(const TlsSessionCache &) = delete;
+	// The returned session is owned by the cache and remains valid until the next modification of the cache.
+	const bctbx_ssl_session_t *lookup(const std::string &key);
+	// Saves the session negotiated by sslCtx, returns false if it cannot be resumed.
+	bool store(const std::string &key, bctbx_ssl_context_t *sslCtx);
+	void remove(const std::string &key);
+	void clear();
+	size_t getCount() const;
+	void countHandshake(bool resumed);
+	unsigned int getHandshakeCount(bool resumed) const;
+
+private:
+	struct Entry {
+		std::unique_ptr<bctbx_ssl_session_t, void (*)(bctbx_ssl_session_t *)> session{nullptr, bctbx_ssl_session_free};
+		uint64_t lastUse = 0;
+	};
+	void purge();
+
+	std::unordered_map<std::string, Entry> mEntries;
+	uint64_t mUseCounter = 0;
+	unsigned int mFullHandshakes = 0;
+	unsigned int mResumedHandshakes = 0;
+};
+
+} // namespace bellesip
+
+extern "C" {
+#endif
+
+belle_sip_tls_session_cache_t *belle_sip_tls_session_cache_new(void);
+
+/* Returns the session saved for this peer, NULL if there is none. */
+const bctbx_ssl_session_t *belle_sip_tls_session_cache_lookup(belle_sip_tls_session_cache_t *obj, const char *key);
+
+/* Saves the session negotiated by ssl_ctx for this peer. Returns 0 on success, -1 if the session is not resumable. */
+int belle_sip_tls_session_cache_store(belle_sip_tls_session_cache_t *obj, const char *key, bctbx_ssl_context_t *ssl_ctx);
+
+void belle_sip_tls_session_cache_remove(belle_sip_tls_session_cache_t *obj, const char *key);
+
+void belle_sip_tls_session_cache_clear(belle_sip_tls_session_cache_t *obj);
+
+size_t belle_sip_tls_session_cache_get_count(belle_sip_tls_session_cache_t *obj);
+
+void belle_sip_tls_session_cache_count_handshake(belle_sip_tls_session_cache_t *obj, int resumed);
+
+unsigned int belle_sip_tls_session_cache_get_handshake_count(belle_sip_tls_session_cache_t *obj, int resumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
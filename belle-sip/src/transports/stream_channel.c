@@ -87,8 +87,9 @@ void stream_channel_close(belle_sip_stream_channel_t *obj) {
 			obj->write_stream = NULL;
 		}
 #endif
-		belle_sip_close_socket(sock);
+		/*the source is reset first, so that its fd is unregistered from the main loop while still open*/
 		belle_sip_source_reset((belle_sip_source_t *)obj);
+		belle_sip_close_socket(sock);
 	}
 }
 
@@ -22,15 +22,15 @@
 static int on_new_connection(void *userdata, unsigned int events);
 
 void belle_sip_stream_listening_point_destroy_server_socket(belle_sip_stream_listening_point_t *lp) {
-	if (lp->server_sock != (belle_sip_socket_t)-1) {
-		belle_sip_close_socket(lp->server_sock);
-		lp->server_sock = -1;
-	}
 	if (lp->source) {
 		belle_sip_main_loop_remove_source(lp->base.stack->ml, lp->source);
 		belle_sip_object_unref(lp->source);
 		lp->source = NULL;
 	}
+	if (lp->server_sock != (belle_sip_socket_t)-1) {
+		belle_sip_close_socket(lp->server_sock);
+		lp->server_sock = -1;
+	}
 }
 
 static void belle_sip_stream_listening_point_uninit(belle_sip_stream_listening_point_t *lp) {
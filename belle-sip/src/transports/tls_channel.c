@@ -19,6 +19,7 @@
 
 #include "belle_sip_internal.h"
 #include "stream_channel.h"
+#include "tls_session_cache.hh"
 
 #include "bctoolbox/crypto.h"
 
@@ -378,6 +379,8 @@ struct belle_sip_tls_channel {
 	belle_tls_crypto_config_t *crypto_config;
 	int http_proxy_connected;
 	belle_sip_resolver_context_t *http_proxy_resolver_ctx;
+	char *session_key; /*identifies the peer in the session cache of the crypto config*/
+	int session_established;
 };
 
 static void tls_channel_close(belle_sip_tls_channel_t *obj) {
@@ -401,6 +404,7 @@ static void tls_channel_uninit(belle_sip_tls_channel_t *obj) {
 	}
 
 	if (obj->cur_debug_msg) belle_sip_free(obj->cur_debug_msg);
+	if (obj->session_key) belle_sip_free(obj->session_key);
 	belle_sip_object_unref(obj->crypto_config);
 	if (obj->client_cert_chain) belle_sip_object_unref(obj->client_cert_chain);
 	if (obj->client_cert_key) belle_sip_object_unref(obj->client_cert_key);
@@ -512,11 +516,15 @@ static int tls_process_handshake(belle_sip_channel_t *obj) {
 	belle_sip_tls_channel_t *channel = (belle_sip_tls_channel_t *)obj;
 	char tmp[128];
 	int err = bctbx_ssl_handshake(channel->sslctx);
+	int resumed = FALSE;
 
 	memset(tmp, '\0', sizeof(tmp));
 	if (err == 0) {
-		belle_sip_message("Channel [%p]: SSL handshake finished, SSL version is [%s], selected ciphersuite is [%s]",
-		                  obj, bctbx_ssl_get_version(channel->sslctx), bctbx_ssl_get_ciphersuite(channel->sslctx));
+		resumed = bctbx_ssl_session_resumed(channel->sslctx);
+		belle_sip_message(
+		    "Channel [%p]: SSL handshake finished (%s), SSL version is [%s], selected ciphersuite is [%s]", obj,
+		    resumed ? "session resumed" : "full handshake", bctbx_ssl_get_version(channel->sslctx),
+		    bctbx_ssl_get_ciphersuite(channel->sslctx));
 		err = tls_handle_postcheck(channel);
 		if (err != 0) {
 			snprintf(tmp, sizeof(tmp) - 1, "%s", "application level post-check failed.");
@@ -524,6 +532,8 @@ static int tls_process_handshake(belle_sip_channel_t *obj) {
 	}
 
 	if (err == 0) {
+		belle_sip_tls_session_cache_count_handshake(channel->crypto_config->session_cache, resumed);
+		channel->session_established = TRUE;
 		belle_sip_source_set_timeout_int64((belle_sip_source_t *)obj, -1);
 		belle_sip_channel_set_ready(obj, (struct sockaddr *)&channel->ss, channel->socklen);
 	} else if (err == BCTBX_ERROR_NET_WANT_READ || err == BCTBX_ERROR_NET_WANT_WRITE) {
@@ -533,6 +543,9 @@ static int tls_process_handshake(belle_sip_channel_t *obj) {
 			bctbx_strerror(err, tmp, sizeof(tmp));
 		}
 		belle_sip_error("Channel [%p]: SSL handshake failed : %s", obj, tmp);
+		/*don't offer again a session that may be the cause of the failure*/
+		if (channel->session_key)
+			belle_sip_tls_session_cache_remove(channel->crypto_config->session_cache, channel->session_key);
 		return -1;
 	}
 	return 0;
@@ -844,6 +857,11 @@ static int belle_sip_tls_channel_load_root_ca_from_buffer(belle_sip_tls_channel_
 
 static void belle_sip_tls_channel_deinit_bctbx_ssl(belle_sip_tls_channel_t *obj) {
 	if (obj->sslctx) {
+		/*save the session now, with TLS 1.3 the tickets are received after the handshake*/
+		if (obj->session_established && obj->session_key && obj->crypto_config->session_resumption_enabled) {
+			belle_sip_tls_session_cache_store(obj->crypto_config->session_cache, obj->session_key, obj->sslctx);
+		}
+		obj->session_established = FALSE;
 		bctbx_ssl_context_free(obj->sslctx);
 		obj->sslctx = NULL;
 	}
@@ -857,6 +875,39 @@ static void belle_sip_tls_channel_deinit_bctbx_ssl(belle_sip_tls_channel_t *obj)
 	}
 }
 
+static char *belle_sip_tls_channel_make_session_key(belle_sip_tls_channel_t *obj) {
+	belle_sip_channel_t *channel = (belle_sip_channel_t *)obj;
+	char addr[64] = {0};
+	char *key;
+
+	if (channel->current_peer) {
+		bctbx_sockaddr_to_printable_ip_address(channel->current_peer->ai_addr,
+		                                       (socklen_t)channel->current_peer->ai_addrlen, addr, sizeof(addr));
+	}
+	key = belle_sip_strdup_printf("%s|%s", channel->peer_cname ? channel->peer_cname : channel->peer_name, addr);
+	/*a session authenticated with a client certificate must not be resumed with another one*/
+	if (obj->client_cert_chain) {
+		char fingerprint[256];
+		if (bctbx_x509_certificate_get_fingerprint(obj->client_cert_chain->cert, fingerprint, sizeof(fingerprint),
+		                                           BCTBX_MD_SHA256) > 0) {
+			key = belle_sip_strcat_printf(key, "|%s", fingerprint);
+		}
+	}
+	return key;
+}
+
+static void belle_sip_tls_channel_offer_session(belle_sip_tls_channel_t *obj) {
+	belle_tls_crypto_config_t *crypto_config = obj->crypto_config;
+	const bctbx_ssl_session_t *session;
+
+	if (obj->session_key) belle_sip_free(obj->session_key);
+	obj->session_key = belle_sip_tls_channel_make_session_key(obj);
+	session = belle_sip_tls_session_cache_lookup(crypto_config->session_cache, obj->session_key);
+	if (session && bctbx_ssl_set_session(obj->sslctx, session) == 0) {
+		belle_sip_message("Channel [%p]: offering to resume TLS session with [%s]", obj, obj->session_key);
+	}
+}
+
 static int belle_sip_tls_channel_init_bctbx_ssl(belle_sip_tls_channel_t *obj) {
 	belle_sip_stream_channel_t *super = (belle_sip_stream_channel_t *)obj;
 	belle_tls_crypto_config_t *crypto_config = obj->crypto_config;
@@ -911,6 +962,7 @@ static int belle_sip_tls_channel_init_bctbx_ssl(belle_sip_tls_channel_t *obj) {
 	bctbx_ssl_context_setup(obj->sslctx, obj->sslcfg);
 	bctbx_ssl_set_io_callbacks(obj->sslctx, obj, tls_callback_write, tls_callback_read);
 	bctbx_ssl_set_hostname(obj->sslctx, super->base.peer_cname ? super->base.peer_cname : super->base.peer_name);
+	if (crypto_config->session_resumption_enabled) belle_sip_tls_channel_offer_session(obj);
 	return 0;
 }
 
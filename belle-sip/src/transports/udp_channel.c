@@ -34,10 +34,11 @@ typedef struct belle_sip_udp_channel belle_sip_udp_channel_t;
 static void udp_channel_close(belle_sip_channel_t *obj) {
 	belle_sip_udp_channel_t *chan = (belle_sip_udp_channel_t *)obj;
 	belle_sip_socket_t sock = belle_sip_source_get_socket((belle_sip_source_t *)chan);
+	/*the source is reset first, so that its fd is unregistered from the main loop while still open*/
+	belle_sip_source_reset((belle_sip_source_t *)obj);
 	if (chan->shared_socket == SOCKET_NOT_SET && sock != SOCKET_NOT_SET) {
-		belle_sip_close_socket(belle_sip_source_get_socket((belle_sip_source_t *)obj));
+		belle_sip_close_socket(sock);
 	}
-	belle_sip_source_reset((belle_sip_source_t *)obj);
 }
 
 static void udp_channel_uninit(belle_sip_udp_channel_t *obj) {
@@ -228,6 +228,30 @@ static void one_https_get(void) {
 	}
 }
 
+static void https_get_with_session_resumption(void) {
+	belle_tls_crypto_config_t *crypto_config = belle_tls_crypto_config_new();
+	int i;
+
+	if (belle_sip_tester_get_root_ca_path() != NULL) {
+		belle_tls_crypto_config_set_root_ca(crypto_config, belle_sip_tester_get_root_ca_path());
+	}
+	/* each provider opens its own connection, the second one resumes the session saved when the first was closed */
+	for (i = 0; i < 2; ++i) {
+		http_counters_t counters = {0};
+		belle_http_provider_t *prov = belle_sip_stack_create_http_provider(http_stack, "0.0.0.0");
+		belle_http_provider_set_tls_crypto_config(prov, crypto_config);
+		if (one_get_prov("https://gitlab.linphone.org", &counters, &counters.response_count, prov) == 0) {
+			BC_ASSERT_EQUAL(counters.two_hundred, 1, int, "%d");
+		}
+		belle_sip_object_unref(prov);
+	}
+	if (belle_sip_stack_tls_available(http_stack)) {
+		BC_ASSERT_EQUAL(belle_tls_crypto_config_get_full_handshake_count(crypto_config), 1, unsigned int, "%u");
+		BC_ASSERT_EQUAL(belle_tls_crypto_config_get_resumed_handshake_count(crypto_config), 1, unsigned int, "%u");
+	}
+	belle_sip_object_unref(crypto_config);
+}
+
 static void one_https_only_get(void) {
 	http_counters_t counters = {0};
 	// first perform one get on https using the https only provider, it shall work
@@ -656,6 +680,7 @@ static test_t http_tests[] = {
     TEST_NO_TAG("One https GET with http proxy", one_https_get_with_proxy),
     TEST_NO_TAG("http request with io error", http_get_io_error),
     TEST_NO_TAG("https GET with long body", https_get_long_body),
+    TEST_NO_TAG("https GET with session resumption", https_get_with_session_resumption),
     TEST_NO_TAG("http basic auth GET", http_basic_auth_get), TEST_NO_TAG("http digest auth GET", http_digest_get),
     TEST_NO_TAG("http digest md5/sha-256 GET", http_sha256_md5_digest_get),
     TEST_NO_TAG("http bearer auth GET", http_bearer_get),
@@ -286,10 +286,221 @@ static void test_truncated_compressed_body(void) {
 	belle_sip_object_unref(mbh);
 }
 
+typedef struct main_loop_timer {
+	int timeout;
+	int notified;
+	uint64_t notified_at;
+	int order;
+} main_loop_timer_t;
+
+static int main_loop_timer_order = 0;
+
+static int main_loop_timer_cb(void *data, unsigned int events) {
+	main_loop_timer_t *timer = (main_loop_timer_t *)data;
+	BC_ASSERT_TRUE(events & BELLE_SIP_EVENT_TIMEOUT);
+	timer->notified++;
+	timer->notified_at = belle_sip_time_ms();
+	timer->order = main_loop_timer_order++;
+	return BELLE_SIP_STOP;
+}
+
+static int main_loop_periodic_timer_cb(void *data, unsigned int events) {
+	main_loop_timer_t *timer = (main_loop_timer_t *)data;
+	BC_ASSERT_TRUE(events & BELLE_SIP_EVENT_TIMEOUT);
+	timer->notified++;
+	return timer->notified < 5 ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
+}
+
+static void main_loop_timers_with_backend(belle_sip_main_loop_backend_t backend) {
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new_with_backend(backend);
+	/*timeouts spread over the different levels of the timer wheel*/
+	const int timeouts[] = {700, 0, 300, 20, 1, 256, 255, 1100};
+	main_loop_timer_t timers[sizeof(timeouts) / sizeof(timeouts[0])] = {0};
+	main_loop_timer_t cancelled = {0};
+	main_loop_timer_t rearmed = {0};
+	main_loop_timer_t periodic = {0};
+	belle_sip_source_t *cancelled_source;
+	belle_sip_source_t *rearmed_source;
+	belle_sip_source_t *periodic_source;
+	size_t i, j;
+	uint64_t start = belle_sip_time_ms();
+
+	main_loop_timer_order = 0;
+	for (i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); ++i) {
+		timers[i].timeout = timeouts[i];
+		belle_sip_main_loop_add_timeout(ml, main_loop_timer_cb, &timers[i], timeouts[i]);
+	}
+	cancelled_source = belle_sip_main_loop_create_timeout(ml, main_loop_timer_cb, &cancelled, 100, "cancelled");
+	rearmed_source = belle_sip_main_loop_create_timeout(ml, main_loop_timer_cb, &rearmed, 50, "rearmed");
+	periodic_source = belle_sip_main_loop_create_timeout(ml, main_loop_periodic_timer_cb, &periodic, 10, "periodic");
+	belle_sip_source_cancel(cancelled_source);
+	belle_sip_source_set_timeout_int64(rearmed_source, 600);
+
+	belle_sip_main_loop_sleep(ml, 1300);
+
+	for (i = 0; i < sizeof(timeouts) / sizeof(timeouts[0]); ++i) {
+		BC_ASSERT_EQUAL(timers[i].notified, 1, int, "%i");
+		BC_ASSERT_GREATER((unsigned int)(timers[i].notified_at - start), (unsigned int)timers[i].timeout, unsigned int,
+		                  "%u");
+		for (j = 0; j < sizeof(timeouts) / sizeof(timeouts[0]); ++j) {
+			if (timers[i].timeout < timers[j].timeout) BC_ASSERT_LOWER(timers[i].order, timers[j].order, int, "%i");
+		}
+	}
+	BC_ASSERT_EQUAL(cancelled.notified, 0, int, "%i");
+	BC_ASSERT_EQUAL(rearmed.notified, 1, int, "%i");
+	BC_ASSERT_GREATER((unsigned int)(rearmed.notified_at - start), 600, unsigned int, "%u");
+	BC_ASSERT_EQUAL(periodic.notified, 5, int, "%i");
+
+	belle_sip_object_unref(cancelled_source);
+	belle_sip_object_unref(rearmed_source);
+	belle_sip_object_unref(periodic_source);
+	belle_sip_object_unref(ml);
+}
+
+static void main_loop_timers(void) {
+	main_loop_timers_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_POLL);
+	main_loop_timers_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL);
+}
+
+#ifndef _WIN32
+
+typedef struct main_loop_fd_source {
+	belle_sip_source_t *source;
+	int fd;
+	int read_count;
+	int timeout_count;
+} main_loop_fd_source_t;
+
+static int main_loop_fd_source_cb(void *data, unsigned int events) {
+	main_loop_fd_source_t *ctx = (main_loop_fd_source_t *)data;
+	char buffer[16];
+	if (events & BELLE_SIP_EVENT_READ) {
+		if (read(ctx->fd, buffer, sizeof(buffer)) > 0) ctx->read_count++;
+	}
+	if (events & BELLE_SIP_EVENT_TIMEOUT) ctx->timeout_count++;
+	return BELLE_SIP_CONTINUE;
+}
+
+static void main_loop_fd_sources_with_backend(belle_sip_main_loop_backend_t backend) {
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new_with_backend(backend);
+	main_loop_fd_source_t ctx[2] = {0};
+	int fds[2][2];
+	int i;
+
+	for (i = 0; i < 2; ++i) {
+		BC_ASSERT_EQUAL(pipe(fds[i]), 0, int, "%i");
+		ctx[i].fd = fds[i][0];
+		ctx[i].source = belle_sip_socket_source_new(main_loop_fd_source_cb, &ctx[i], fds[i][0],
+		                                            BELLE_SIP_EVENT_READ | BELLE_SIP_EVENT_ERROR, i == 0 ? -1 : 120);
+		belle_sip_main_loop_add_source(ml, ctx[i].source);
+	}
+
+	belle_sip_main_loop_sleep(ml, 50);
+	BC_ASSERT_EQUAL(ctx[0].read_count, 0, int, "%i");
+	BC_ASSERT_EQUAL(ctx[1].read_count, 0, int, "%i");
+
+	BC_ASSERT_EQUAL((int)write(fds[0][1], "a", 1), 1, int, "%i");
+	belle_sip_main_loop_sleep(ml, 100);
+	BC_ASSERT_EQUAL(ctx[0].read_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(ctx[1].read_count, 0, int, "%i");
+	BC_ASSERT_GREATER(ctx[1].timeout_count, 1, int, "%i");
+
+	/*no more notified once removed, even with data to read*/
+	belle_sip_main_loop_remove_source(ml, ctx[0].source);
+	BC_ASSERT_EQUAL((int)write(fds[0][1], "b", 1), 1, int, "%i");
+	BC_ASSERT_EQUAL((int)write(fds[1][1], "c", 1), 1, int, "%i");
+	belle_sip_main_loop_sleep(ml, 50);
+	BC_ASSERT_EQUAL(ctx[0].read_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(ctx[1].read_count, 1, int, "%i");
+
+	/*cancelled sources are removed at next iteration*/
+	belle_sip_source_cancel(ctx[1].source);
+	belle_sip_main_loop_sleep(ml, 10);
+	BC_ASSERT_PTR_NULL(belle_sip_main_loop_find_source(ml, belle_sip_source_get_id(ctx[1].source)));
+
+	for (i = 0; i < 2; ++i) {
+		belle_sip_object_unref(ctx[i].source);
+		close(fds[i][0]);
+		close(fds[i][1]);
+	}
+	belle_sip_object_unref(ml);
+}
+
+static void main_loop_fd_sources(void) {
+	main_loop_fd_sources_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_POLL);
+	main_loop_fd_sources_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL);
+}
+
+static void main_loop_shared_fd_sources_with_backend(belle_sip_main_loop_backend_t backend) {
+	belle_sip_main_loop_t *ml = belle_sip_main_loop_new_with_backend(backend);
+	main_loop_fd_source_t ctx[2] = {0};
+	belle_sip_source_t *write_source;
+	main_loop_fd_source_t write_ctx = {0};
+	int fds[2];
+	int i;
+
+	BC_ASSERT_EQUAL(pipe(fds), 0, int, "%i");
+	/*both sources may be notified when there is something to read, only one of them will read it*/
+	BC_ASSERT_EQUAL(fcntl(fds[0], F_SETFL, O_NONBLOCK), 0, int, "%i");
+	/*two sources on the same fd*/
+	for (i = 0; i < 2; ++i) {
+		ctx[i].fd = fds[0];
+		ctx[i].source = belle_sip_socket_source_new(main_loop_fd_source_cb, &ctx[i], fds[0],
+		                                            BELLE_SIP_EVENT_READ | BELLE_SIP_EVENT_ERROR, -1);
+		belle_sip_main_loop_add_source(ml, ctx[i].source);
+	}
+	/*a source not interested in the events of the fd*/
+	write_ctx.fd = fds[0];
+	write_source = belle_sip_socket_source_new(main_loop_fd_source_cb, &write_ctx, fds[0], 0, -1);
+	belle_sip_main_loop_add_source(ml, write_source);
+
+	BC_ASSERT_EQUAL((int)write(fds[1], "ab", 2), 2, int, "%i");
+	belle_sip_main_loop_sleep(ml, 50);
+	BC_ASSERT_EQUAL(ctx[0].read_count + ctx[1].read_count, 1, int, "%i");
+	BC_ASSERT_EQUAL(write_ctx.read_count, 0, int, "%i");
+
+	/*the remaining source is still notified once the other one is removed*/
+	belle_sip_main_loop_remove_source(ml, ctx[0].source);
+	BC_ASSERT_EQUAL((int)write(fds[1], "c", 1), 1, int, "%i");
+	belle_sip_main_loop_sleep(ml, 50);
+	BC_ASSERT_EQUAL(ctx[0].read_count + ctx[1].read_count, 2, int, "%i");
+	BC_ASSERT_EQUAL(write_ctx.read_count, 0, int, "%i");
+
+	/*and the fd can be registered again once all its sources are removed*/
+	belle_sip_main_loop_remove_source(ml, ctx[1].source);
+	belle_sip_main_loop_remove_source(ml, write_source);
+	belle_sip_main_loop_add_source(ml, ctx[0].source);
+	BC_ASSERT_EQUAL((int)write(fds[1], "d", 1), 1, int, "%i");
+	belle_sip_main_loop_sleep(ml, 50);
+	BC_ASSERT_EQUAL(ctx[0].read_count + ctx[1].read_count, 3, int, "%i");
+	belle_sip_main_loop_remove_source(ml, ctx[0].source);
+
+	for (i = 0; i < 2; ++i) {
+		belle_sip_object_unref(ctx[i].source);
+	}
+	belle_sip_object_unref(write_source);
+	close(fds[0]);
+	close(fds[1]);
+	belle_sip_object_unref(ml);
+}
+
+static void main_loop_shared_fd_sources(void) {
+	main_loop_shared_fd_sources_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_POLL);
+	main_loop_shared_fd_sources_with_backend(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL);
+}
+
+#endif
+
 static test_t core_tests[] = {TEST_NO_TAG("Object Data", test_object_data),
                               TEST_NO_TAG("Presence marshal", test_presence_marshal),
                               TEST_NO_TAG("Compressed body", test_compressed_body),
-                              TEST_NO_TAG("Truncated compressed body", test_truncated_compressed_body)};
+                              TEST_NO_TAG("Truncated compressed body", test_truncated_compressed_body),
+                              TEST_NO_TAG("Main loop timers", main_loop_timers),
+#ifndef _WIN32
+                              TEST_NO_TAG("Main loop fd sources", main_loop_fd_sources),
+                              TEST_NO_TAG("Main loop shared fd sources", main_loop_shared_fd_sources),
+#endif
+};
 
 test_suite_t core_test_suite = {"Core",
                                 NULL,
@@ -1013,6 +1013,215 @@ static void ipv4_and_ipv6_dns_server(void) {
 #endif /* HAVE_DNS_SERVICE */
 }
 
+/* Minimal DNS server answering on the loopback from the main loop, to count the queries the resolver sends:
+ * - DNS_STUB_NAME has an A record,
+ * - DNS_STUB_MISSING_NAME does not exist (NXDOMAIN, with the SOA of the zone),
+ * - any other name is refused. */
+#define DNS_STUB_NAME "cached.belle-sip.test"
+#define DNS_STUB_IP "127.0.0.2"
+#define DNS_STUB_MISSING_NAME "missing.belle-sip.test"
+#define DNS_STUB_TTL 60
+#define DNS_STUB_NEGATIVE_TTL 30
+
+typedef struct dns_stub_server {
+	belle_sip_socket_t sock;
+	belle_sip_source_t *source;
+	int port;
+	int queries;
+} dns_stub_server_t;
+
+static size_t dns_stub_put_record(unsigned char *p, int type, uint32_t ttl, const unsigned char *rdata, size_t rdlen) {
+	/* owner name is a pointer to the question name, right after the 12 bytes header */
+	unsigned char record[] = {0xc0, 0x0c, 0, (unsigned char)type, 0, 1, (unsigned char)(ttl >> 24),
+	                          (unsigned char)(ttl >> 16), (unsigned char)(ttl >> 8), (unsigned char)ttl, 0,
+	                          (unsigned char)rdlen};
+	memcpy(p, record, sizeof(record));
+	memcpy(p + sizeof(record), rdata, rdlen);
+	return sizeof(record) + rdlen;
+}
+
+static int dns_stub_server_process(dns_stub_server_t *server, unsigned int revents) {
+	unsigned char query[512];
+	unsigned char answer[1024];
+	char name[256] = {0};
+	struct sockaddr_storage from;
+	socklen_t fromlen = sizeof(from);
+	size_t pos = 12, namelen = 0, len;
+	ssize_t size;
+
+	size = bctbx_recvfrom(server->sock, query, sizeof(query), 0, (struct sockaddr *)&from, &fromlen);
+	if (size < 12) return BELLE_SIP_CONTINUE;
+	while (pos < (size_t)size && query[pos] != 0 && namelen + query[pos] + 1 < sizeof(name)) {
+		if (namelen > 0) name[namelen++] = '.';
+		memcpy(name + namelen, query + pos + 1, query[pos]);
+		namelen += query[pos];
+		pos += query[pos] + 1;
+	}
+	pos += 5; /* root label, type and class */
+	if (pos > (size_t)size) return BELLE_SIP_CONTINUE;
+	server->queries++;
+
+	len = pos;
+	memcpy(answer, query, len);
+	memset(answer + 6, 0, 6);
+	answer[2] = 0x80 | (query[2] & 0x01); /* QR, and RD copied from the query */
+	answer[3] = 0x80;                     /* RA */
+	if (strcasecmp(name, DNS_STUB_NAME) == 0) {
+		unsigned char addr[] = {127, 0, 0, 2};
+		answer[7] = 1;
+		len += dns_stub_put_record(answer + len, 1 /*A*/, DNS_STUB_TTL, addr, sizeof(addr));
+	} else if (strcasecmp(name, DNS_STUB_MISSING_NAME) == 0) {
+		/* mname and rname point to the question name, then serial, refresh, retry, expire and minimum */
+		unsigned char soa[24] = {0xc0, 0x0c, 0xc0, 0x0c, 0, 0, 0, 1, 0, 0, 0x0e, 0x10, 0, 0, 0x0e, 0x10,
+		                         0, 0, 0x0e, 0x10, 0, 0, 0, DNS_STUB_NEGATIVE_TTL};
+		answer[3] |= 3; /* NXDOMAIN */
+		answer[9] = 1;
+		len += dns_stub_put_record(answer + len, 6 /*SOA*/, DNS_STUB_TTL, soa, sizeof(soa));
+	} else {
+		answer[3] |= 5; /* REFUSED */
+	}
+	bctbx_sendto(server->sock, answer, len, 0, (struct sockaddr *)&from, fromlen);
+	return BELLE_SIP_CONTINUE;
+}
+
+static dns_stub_server_t *dns_stub_server_new(belle_sip_stack_t *stack) {
+	dns_stub_server_t *server = belle_sip_new0(dns_stub_server_t);
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof(addr);
+	char dns_server[64];
+	belle_sip_list_t *servers;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	server->sock = (belle_sip_socket_t)bctbx_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	BC_ASSERT_EQUAL(bctbx_bind(server->sock, (struct sockaddr *)&addr, sizeof(addr)), 0, int, "%d");
+	BC_ASSERT_EQUAL(bctbx_getsockname(server->sock, (struct sockaddr *)&addr, &addrlen), 0, int, "%d");
+	server->port = ntohs(addr.sin_port);
+	server->source = belle_sip_socket_source_new((belle_sip_source_func_t)dns_stub_server_process, server,
+	                                             server->sock, BELLE_SIP_EVENT_READ, -1);
+	belle_sip_main_loop_add_source(belle_sip_stack_get_main_loop(stack), server->source);
+
+	snprintf(dns_server, sizeof(dns_server), "[127.0.0.1]:%d", server->port);
+	servers = belle_sip_list_append(NULL, dns_server);
+	belle_sip_stack_set_dns_servers(stack, servers);
+	belle_sip_list_free(servers);
+	belle_sip_stack_enable_dns_search(stack, FALSE);
+	belle_sip_stack_set_dns_engine(stack, BELLE_SIP_DNS_DNS_C);
+	return server;
+}
+
+static void dns_stub_server_destroy(belle_sip_stack_t *stack, dns_stub_server_t *server) {
+	belle_sip_main_loop_remove_source(belle_sip_stack_get_main_loop(stack), server->source);
+	belle_sip_object_unref(server->source);
+	belle_sip_close_socket(server->sock);
+	belle_sip_free(server);
+}
+
+static void resolve_from_stub(resolver_endpoint_t *client, const char *name, int expect_success) {
+	reset_endpoint(client);
+	client->resolver_ctx = belle_sip_stack_resolve_a(client->stack, name, SIP_PORT, AF_INET, a_resolve_done, client);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	BC_ASSERT_EQUAL(client->resolve_ko, !expect_success, int, "%d");
+	if (expect_success && BC_ASSERT_PTR_NOT_NULL(client->ai_list)) {
+		struct sockaddr_in *sock_in = (struct sockaddr_in *)client->ai_list->ai_addr;
+		struct addrinfo *ai = bctbx_ip_address_to_addrinfo(AF_INET, SOCK_STREAM, DNS_STUB_IP, SIP_PORT);
+		if (ai) {
+			BC_ASSERT_EQUAL(sock_in->sin_addr.s_addr, ((struct sockaddr_in *)ai->ai_addr)->sin_addr.s_addr, int, "%d");
+			bctbx_freeaddrinfo(ai);
+		}
+		BC_ASSERT_LOWER(belle_sip_resolver_results_get_ttl(client->results), DNS_STUB_TTL, int, "%d");
+	}
+}
+
+static void dns_cache_positive_answer(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	dns_stub_server_t *server = dns_stub_server_new(client->stack);
+
+	resolve_from_stub(client, DNS_STUB_NAME, TRUE);
+	BC_ASSERT_EQUAL(server->queries, 1, int, "%d");
+
+	/* Answered from the cache, still asynchronously */
+	resolve_from_stub(client, DNS_STUB_NAME, TRUE);
+	BC_ASSERT_PTR_NOT_NULL(client->resolver_ctx);
+	BC_ASSERT_EQUAL(server->queries, 1, int, "%d");
+
+	belle_sip_stack_clear_dns_cache(client->stack);
+	resolve_from_stub(client, DNS_STUB_NAME, TRUE);
+	BC_ASSERT_EQUAL(server->queries, 2, int, "%d");
+
+	belle_sip_stack_enable_dns_cache(client->stack, FALSE);
+	resolve_from_stub(client, DNS_STUB_NAME, TRUE);
+	resolve_from_stub(client, DNS_STUB_NAME, TRUE);
+	BC_ASSERT_EQUAL(server->queries, 4, int, "%d");
+
+	dns_stub_server_destroy(client->stack, server);
+	destroy_endpoint(client);
+}
+
+static void dns_cache_negative_answer(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	dns_stub_server_t *server = dns_stub_server_new(client->stack);
+	int queries;
+
+	resolve_from_stub(client, DNS_STUB_MISSING_NAME, FALSE);
+	resolve_from_stub(client, DNS_STUB_MISSING_NAME, FALSE);
+	BC_ASSERT_EQUAL(server->queries, 1, int, "%d");
+
+	/* Failures are not cached (the resolver retries a refused query, so the count of queries is not known) */
+	resolve_from_stub(client, "refused.belle-sip.test", FALSE);
+	queries = server->queries;
+	BC_ASSERT_GREATER(queries, 2, int, "%d");
+	resolve_from_stub(client, "refused.belle-sip.test", FALSE);
+	BC_ASSERT_GREATER(server->queries, queries + 1, int, "%d");
+
+	dns_stub_server_destroy(client->stack, server);
+	destroy_endpoint(client);
+}
+
+static void dns_cache_concurrent_queries(void) {
+	resolver_endpoint_t *client = create_endpoint();
+	resolver_endpoint_t *other = belle_sip_new0(resolver_endpoint_t);
+	resolver_endpoint_t *third = belle_sip_new0(resolver_endpoint_t);
+	dns_stub_server_t *server = dns_stub_server_new(client->stack);
+
+	/* The second resolution waits for the answer to the query of the first one */
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, DNS_STUB_NAME, SIP_PORT, AF_INET, a_resolve_done, client);
+	other->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, DNS_STUB_NAME, SIP_PORT, AF_INET, a_resolve_done, other);
+	BC_ASSERT_TRUE(wait_for(client->stack, &client->resolve_done, 1, 2000));
+	BC_ASSERT_TRUE(wait_for(client->stack, &other->resolve_done, 1, 2000));
+	BC_ASSERT_PTR_NOT_NULL(client->ai_list);
+	BC_ASSERT_PTR_NOT_NULL(other->ai_list);
+	BC_ASSERT_EQUAL(server->queries, 1, int, "%d");
+
+	/* When the first resolution is cancelled, the ones waiting for it send their own query */
+	belle_sip_stack_clear_dns_cache(client->stack);
+	reset_endpoint(client);
+	reset_endpoint(other);
+	client->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, DNS_STUB_NAME, SIP_PORT, AF_INET, a_resolve_done, client);
+	other->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, DNS_STUB_NAME, SIP_PORT, AF_INET, a_resolve_done, other);
+	third->resolver_ctx =
+	    belle_sip_stack_resolve_a(client->stack, DNS_STUB_NAME, SIP_PORT, AF_INET, a_resolve_done, third);
+	belle_sip_resolver_context_cancel(client->resolver_ctx);
+	BC_ASSERT_TRUE(wait_for(client->stack, &other->resolve_done, 1, 2000));
+	BC_ASSERT_TRUE(wait_for(client->stack, &third->resolve_done, 1, 2000));
+	BC_ASSERT_PTR_NOT_NULL(other->ai_list);
+	BC_ASSERT_PTR_NOT_NULL(third->ai_list);
+	BC_ASSERT_EQUAL(client->resolve_done, 0, int, "%d");
+	BC_ASSERT_EQUAL(server->queries, 3, int, "%d");
+
+	reset_endpoint(other);
+	reset_endpoint(third);
+	belle_sip_free(other);
+	belle_sip_free(third);
+	dns_stub_server_destroy(client->stack, server);
+	destroy_endpoint(client);
+}
+
 #ifdef HAVE_MDNS
 static void mdns_register_callback(void *data, int error) {
 	int *register_error = (int *)data;
@@ -1173,6 +1382,9 @@ static test_t resolver_tests[] = {
     TEST_NO_TAG("DNS fallback because of invalid IPv6", dns_fallback_because_of_invalid_ipv6),
     TEST_NO_TAG("IPv6 DNS server", ipv6_dns_server),
     TEST_NO_TAG("IPv4 and v6 DNS servers", ipv4_and_ipv6_dns_server),
+    TEST_NO_TAG("DNS cache", dns_cache_positive_answer),
+    TEST_NO_TAG("DNS cache with negative answer", dns_cache_negative_answer),
+    TEST_NO_TAG("DNS cache with concurrent queries", dns_cache_concurrent_queries),
     TEST_NO_TAG("A query (IPv4) cancelled", a_query_cancelled),
     TEST_NO_TAG("SRV query cancelled", srv_query_cancelled),
     TEST_NO_TAG("SRV + A query cancelled", srv_a_query_cancelled),
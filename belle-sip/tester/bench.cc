@@ -1,8 +1,12 @@
 #include <stdint.h>
 
+#include <string>
+#include <vector>
+
 #include "criterion.hpp"
 
 #include "belle-sip/belle-sip.h"
+#include "belle_sip_internal.h"
 
 // antlr: 59 µs
 // belr: 7 µs
@@ -208,4 +212,154 @@ Content-Length: 0\r\n\
 	belle_sip_message_parse(message);
 }
 
-CRITERION_BENCHMARK_MAIN()
\ No newline at end of file
+// Provider with as many pending transactions and dialogs as a busy B2BUA, to measure the matching of incoming messages.
+class LoadedProvider {
+public:
+	static constexpr int sTransactionCount = 10000;
+
+	static LoadedProvider &get() {
+		static LoadedProvider provider;
+		return provider;
+	}
+
+	~LoadedProvider() {
+		belle_sip_object_unref(mFirstRequest);
+		belle_sip_object_unref(mProvider);
+		belle_sip_object_unref(mStack);
+	}
+
+	static belle_sip_request_t *createRequest(int index) {
+		std::string message = "SUBSCRIBE sip:conference@sip.example.org SIP/2.0\r\n"
+		                      "Via: SIP/2.0/UDP 192.168.0.1:5060;branch=z9hG4bK." +
+		                      std::to_string(index) +
+		                      "\r\n"
+		                      "From: <sip:alice@sip.example.org>;tag=from-" +
+		                      std::to_string(index) +
+		                      "\r\n"
+		                      "To: <sip:conference@sip.example.org>\r\n"
+		                      "CSeq: 20 SUBSCRIBE\r\n"
+		                      "Call-ID: call-" +
+		                      std::to_string(index) +
+		                      "\r\n"
+		                      "Contact: <sip:alice@192.168.0.1:5060>\r\n"
+		                      "Max-Forwards: 70\r\n"
+		                      "Event: conference\r\n"
+		                      "Content-Length: 0\r\n"
+		                      "\r\n";
+		return BELLE_SIP_REQUEST(belle_sip_message_parse(message.c_str()));
+	}
+
+	belle_sip_stack_t *mStack;
+	belle_sip_provider_t *mProvider;
+	// Request of the oldest transaction, the last one found by a linear search.
+	belle_sip_request_t *mFirstRequest;
+
+private:
+	LoadedProvider() {
+		// Don't measure the logging of the matches.
+		belle_sip_set_log_level(BELLE_SIP_LOG_WARNING);
+		mStack = belle_sip_stack_new(NULL);
+		mProvider = belle_sip_stack_create_provider(mStack, NULL);
+		for (int i = 0; i < sTransactionCount; i++) {
+			belle_sip_request_t *req = createRequest(i);
+			belle_sip_server_transaction_t *t = belle_sip_provider_create_server_transaction(mProvider, req);
+			belle_sip_provider_create_dialog(mProvider, BELLE_SIP_TRANSACTION(t));
+		}
+		mFirstRequest = (belle_sip_request_t *)belle_sip_object_ref(createRequest(0));
+	}
+};
+
+// list: 499 µs
+// hash index: 1 µs
+BENCHMARK(ServerTransactionMatching) {
+	SETUP_BENCHMARK(LoadedProvider &provider = LoadedProvider::get();)
+	belle_sip_provider_find_matching_server_transaction(provider.mProvider, provider.mFirstRequest);
+}
+
+// list: 491 µs
+// hash index: 1 µs
+BENCHMARK(DialogLookup) {
+	SETUP_BENCHMARK(LoadedProvider &provider = LoadedProvider::get();)
+	belle_sip_provider_find_dialog(provider.mProvider, "call-0", "unknown", "from-0");
+}
+
+CRITERION_BENCHMARK_MAIN()
+// Main loop with as many idle sockets and pending timers as a busy server, to measure the cost of its iterations.
+class LoadedMainLoop {
+public:
+	static constexpr int sSocketCount = 400;
+	static constexpr int sTimerCount = 10000;
+
+	static LoadedMainLoop &getPoll() {
+		static LoadedMainLoop mainLoop(BELLE_SIP_MAIN_LOOP_BACKEND_POLL);
+		return mainLoop;
+	}
+
+	static LoadedMainLoop &getEpoll() {
+		static LoadedMainLoop mainLoop(BELLE_SIP_MAIN_LOOP_BACKEND_EPOLL);
+		return mainLoop;
+	}
+
+	~LoadedMainLoop() {
+		for (belle_sip_source_t *source : mSources) {
+			belle_sip_main_loop_remove_source(mMainLoop, source);
+			if (belle_sip_source_get_socket(source) != (belle_sip_socket_t)-1)
+				belle_sip_close_socket(belle_sip_source_get_socket(source));
+			belle_sip_object_unref(source);
+		}
+		belle_sip_object_unref(mMainLoop);
+	}
+
+	// Moves the timeout of one of the timers, as done by the transactions and refreshers.
+	void rearmTimer() {
+		belle_sip_source_set_timeout_int64(mSources[sSocketCount + mRearmed % sTimerCount], sTimeout + mRearmed % 1000);
+		mRearmed++;
+	}
+
+	belle_sip_main_loop_t *mMainLoop;
+
+private:
+	static constexpr int64_t sTimeout = 3600000;
+
+	static int onEvent(void *, unsigned int) {
+		return BELLE_SIP_CONTINUE;
+	}
+
+	LoadedMainLoop(belle_sip_main_loop_backend_t backend) {
+		mMainLoop = belle_sip_main_loop_new_with_backend(backend);
+		for (int i = 0; i < sSocketCount; i++) {
+			belle_sip_socket_t sock = socket(AF_INET, SOCK_DGRAM, 0);
+			mSources.push_back(belle_sip_socket_source_new(onEvent, this, sock, BELLE_SIP_EVENT_READ, -1));
+		}
+		for (int i = 0; i < sTimerCount; i++) {
+			mSources.push_back(belle_sip_timeout_source_new(onEvent, this, (unsigned int)(sTimeout + i)));
+		}
+		for (belle_sip_source_t *source : mSources) {
+			belle_sip_main_loop_add_source(mMainLoop, source);
+		}
+	}
+
+	std::vector<belle_sip_source_t *> mSources;
+	unsigned int mRearmed = 0;
+};
+
+// timers in map: 30 µs
+// timer wheel: 27 µs
+BENCHMARK(PollMainLoopIteration) {
+	SETUP_BENCHMARK(LoadedMainLoop &mainLoop = LoadedMainLoop::getPoll();)
+	belle_sip_main_loop_sleep(mainLoop.mMainLoop, 0);
+}
+
+// timers in map, poll: 30 µs
+// timer wheel: 1.6 µs
+BENCHMARK(EpollMainLoopIteration) {
+	SETUP_BENCHMARK(LoadedMainLoop &mainLoop = LoadedMainLoop::getEpoll();)
+	belle_sip_main_loop_sleep(mainLoop.mMainLoop, 0);
+}
+
+// timers in map: 2 µs
+// timer wheel: 0.4 µs
+BENCHMARK(TimerRearming) {
+	SETUP_BENCHMARK(LoadedMainLoop &mainLoop = LoadedMainLoop::getEpoll();)
+	mainLoop.rearmTimer();
+}
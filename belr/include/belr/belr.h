@@ -20,10 +20,14 @@
 #ifndef _BELR_H_
 #define _BELR_H_
 
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <string_view>
+#include <vector>
 
 // =============================================================================
 
@@ -67,13 +71,27 @@ public:
 
 	void setName(const std::string &name);
 	const std::string &getName() const;
-	BELR_PUBLIC size_t feed(ParserContextBase &ctx, const std::string &input, size_t pos);
+	BELR_PUBLIC size_t feed(ParserContextBase &ctx, std::string_view input, size_t pos);
+	/* Same as feed(), without notifying any parser context: only for recognizers the parser has no handler nor
+	 * collector for, neither for them nor for their sub-recognizers. */
+	size_t match(std::string_view input, size_t pos) const;
 	unsigned int getId() const {
 		return mId;
 	}
+	/* Unlike the id, every recognizer has a serial, that parsers use to index their own data about recognizers. */
+	unsigned int getSerial() const {
+		return mSerial;
+	}
+	/* The characters recognized, if the recognizer always recognizes exactly one character, nullptr otherwise. */
+	const TransitionMap *getCharClass() const {
+		return mCharClass.get();
+	}
 	bool getTransitionMap(TransitionMap *mask);
+	bool getCharClass(TransitionMap *mask, int recursionLevel) const;
 	void optimize();
 	void optimize(int recursionLevel);
+	void computeCharClass();
+	void forEachChild(const std::function<void(Recognizer *)> &func) const;
 	void serialize(BinaryOutputStream &fstr, bool topLevel = false);
 	static std::shared_ptr<Recognizer> build(BinaryGrammarBuilder &ifstr);
 
@@ -83,11 +101,21 @@ protected:
 	virtual void _serialize(BinaryOutputStream &fstr) = 0;
 	/*returns true if the transition map is complete, false otherwise*/
 	virtual bool _getTransitionMap(TransitionMap *mask);
+	/*returns true if the recognizer always recognizes exactly one character, among the ones set in mask*/
+	virtual bool _getCharClass(TransitionMap *mask, int recursionLevel) const;
+	virtual void _forEachChild(const std::function<void(Recognizer *)> &func) const;
 	virtual void _optimize(int recursionLevel) = 0;
-	virtual size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) = 0;
+	virtual size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) = 0;
+	virtual size_t _match(std::string_view input, size_t pos) const = 0;
 
 	std::string mName;
 	unsigned int mId = 0;
+
+private:
+	static unsigned int nextSerial();
+
+	unsigned int mSerial = nextSerial();
+	std::unique_ptr<TransitionMap> mCharClass;
 };
 
 enum RecognizerTypeId {
@@ -109,7 +137,9 @@ public:
 	CharRecognizer(BinaryGrammarBuilder &istr);
 
 private:
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
 	void _optimize(int recursionLevel) override;
 	virtual void _serialize(BinaryOutputStream &fstr) override;
 
@@ -125,11 +155,14 @@ public:
 
 protected:
 	void _optimize(int recursionLevel) override;
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
 	bool _getTransitionMap(TransitionMap *mask) override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
+	void _forEachChild(const std::function<void(Recognizer *)> &func) const override;
 	virtual void _serialize(BinaryOutputStream &fstr) override;
 
-	size_t _feedExclusive(ParserContextBase &ctx, const std::string &input, size_t pos);
+	size_t _feedExclusive(ParserContextBase &ctx, std::string_view input, size_t pos);
 
 	std::list<std::shared_ptr<Recognizer>> mElements;
 	bool mIsExclusive = false;
@@ -142,7 +175,7 @@ public:
 	ExclusiveSelector(BinaryGrammarBuilder &istr);
 
 private:
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
 };
 
 class Sequence : public Recognizer {
@@ -155,9 +188,12 @@ public:
 protected:
 	virtual void _serialize(BinaryOutputStream &fstr) override;
 	void _optimize(int recursionLevel) override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
+	void _forEachChild(const std::function<void(Recognizer *)> &func) const override;
 
 private:
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
 
 	std::list<std::shared_ptr<Recognizer>> mElements;
 };
@@ -172,9 +208,13 @@ public:
 protected:
 	virtual void _serialize(BinaryOutputStream &fstr) override;
 	void _optimize(int recursionLevel) override;
+	void _forEachChild(const std::function<void(Recognizer *)> &func) const override;
 
 private:
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	/* Loop over a recognizer of a single character, without calling it. */
+	size_t matchCharClass(const TransitionMap *charClass, std::string_view input, size_t pos) const;
 
 	std::shared_ptr<Recognizer> mRecognizer;
 	int mMin = 0;
@@ -198,7 +238,9 @@ public:
 private:
 	virtual void _serialize(BinaryOutputStream &fstr) override;
 	void _optimize(int recursionLevel) override;
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
 
 	int mBegin;
 	int mEnd;
@@ -213,7 +255,9 @@ public:
 private:
 	void _optimize(int recursionLevel) override;
 	virtual void _serialize(BinaryOutputStream &fstr) override;
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
 
 	std::string mLiteral;
 	size_t mLiteralSize;
@@ -240,7 +284,10 @@ public:
 private:
 	void _optimize(int recursionLevel) override;
 	virtual void _serialize(BinaryOutputStream &fstr) override;
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
+	void _forEachChild(const std::function<void(Recognizer *)> &func) const override;
 
 	std::shared_ptr<Recognizer> mRecognizer;
 };
@@ -260,7 +307,10 @@ public:
 private:
 	void _optimize(int recursionLevel) override;
 	virtual void _serialize(BinaryOutputStream &fstr) override;
-	size_t _feed(ParserContextBase &ctx, const std::string &input, size_t pos) override;
+	size_t _feed(ParserContextBase &ctx, std::string_view input, size_t pos) override;
+	size_t _match(std::string_view input, size_t pos) const override;
+	bool _getCharClass(TransitionMap *mask, int recursionLevel) const override;
+	void _forEachChild(const std::function<void(Recognizer *)> &func) const override;
 	std::shared_ptr<Recognizer> mRecognizer;
 };
 
@@ -323,6 +373,13 @@ public:
 	 *because no branch context is to be created to explore the different choices of the selector recognizer.
 	 **/
 	BELR_PUBLIC void optimize();
+	/**
+	 * Compute which recognizers of the grammar can be matched without notifying the parser context, that is the ones
+	 * that neither are nor refer to any of the given rules.
+	 * @param ruleIds the ids of the rules a parser has a handler or a collector for.
+	 * @param pureRecognizers set to true at the serial of each of these recognizers.
+	 **/
+	BELR_PUBLIC void computePureRecognizers(const std::set<unsigned int> &ruleIds, std::vector<bool> &pureRecognizers);
 	/**
 	 * Return the number of rules in this grammar.
 	 **/
@@ -337,6 +394,9 @@ public:
 	BELR_PUBLIC int load(const std::string &filename);
 
 private:
+	void forEachRecognizer(const std::function<void(Recognizer *)> &func);
+	void computeCharClasses();
+
 	std::map<std::string, std::shared_ptr<Recognizer>> mRules;
 	// The recognizer pointers create loops in the chain of recognizer, preventing shared_ptr<> to be released.
 	// We store them in this list so that we can reset them manually to break the loop of reference.
@@ -21,17 +21,18 @@
 #define _PARSER_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #define BELR_USE_ATOMIC 1
 
-#if BELR_USE_ATOMIC
-#include <atomic>
-#endif
-
 #include "bctoolbox/defs.h"
 
 #include "belr.h"
@@ -40,6 +41,35 @@
 
 namespace belr {
 
+/*
+ * Null terminated copy of a part of the parsed input, for the collectors that expect a C string.
+ * Short values, which are the vast majority, are copied on the stack.
+ */
+class NullTerminatedString {
+public:
+	explicit NullTerminatedString(std::string_view value) {
+		if (value.size() < sizeof(mBuffer)) {
+			value.copy(mBuffer, value.size());
+			mBuffer[value.size()] = '\0';
+			mStr = mBuffer;
+		} else {
+			mLongValue.assign(value);
+			mStr = mLongValue.c_str();
+		}
+	}
+	NullTerminatedString(const NullTerminatedString &) = delete;
+	NullTerminatedString &operator=(const NullTerminatedString &) = delete;
+
+	const char *c_str() const {
+		return mStr;
+	}
+
+private:
+	char mBuffer[256];
+	std::string mLongValue;
+	const char *mStr;
+};
+
 /*
  * A collector is an object that represents the relationship a child element to parent element.
  * In the words, each element for which a Handler is being may collect other elements.
@@ -52,7 +82,7 @@ public:
 	/* This method invokes the assignation of a child element represented by an element to a parent element. */
 	virtual void invokeWithChild(_parserElementT obj, _parserElementT child) = 0;
 	/* This method invokes the assignation of a child element represented as a simple string to a parent element. */
-	virtual void invokeWithValue(_parserElementT obj, const std::string &value) = 0;
+	virtual void invokeWithValue(_parserElementT obj, std::string_view value) = 0;
 };
 
 template <class T, class U>
@@ -83,17 +113,24 @@ public:
 
 private:
 	virtual void invokeWithChild(_parserElementT obj, _parserElementT child) override;
-	virtual void invokeWithValue(_parserElementT obj, const std::string &value) override;
+	virtual void invokeWithValue(_parserElementT obj, std::string_view value) override;
 	template <typename _valueT>
 	inline void _invokeWithValue(
 	    _parserElementT obj,
-	    typename std::enable_if<std::is_convertible<_valueT, std::string>::value, const std::string &>::type value) {
+	    typename std::enable_if<std::is_convertible<_valueT, std::string>::value, std::string_view>::type value) {
+		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj), std::string(value));
+	}
+	template <typename _valueT>
+	inline void _invokeWithValue(
+	    _parserElementT obj,
+	    typename std::enable_if<std::is_same<_valueT, std::string_view>::value, std::string_view>::type value) {
+		// The collector takes a view on the parsed input, no copy is needed.
 		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj), value);
 	}
 	template <typename _valueT>
 	inline void _invokeWithValue(
 	    _parserElementT,
-	    typename std::enable_if<std::is_convertible<_valueT, _parserElementT>::value, const std::string &>::type) {
+	    typename std::enable_if<std::is_convertible<_valueT, _parserElementT>::value, std::string_view>::type) {
 		// no op.
 	}
 #if defined(_MSC_VER)
@@ -103,8 +140,9 @@ private:
 	template <typename _valueT>
 	inline void
 	_invokeWithValue(_parserElementT obj,
-	                 typename std::enable_if<std::is_integral<_valueT>::value, const std::string &>::type value) {
-		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj), std::atoll(value.c_str()));
+	                 typename std::enable_if<std::is_integral<_valueT>::value, std::string_view>::type value) {
+		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj),
+		      std::atoll(NullTerminatedString(value).c_str()));
 	}
 #if defined(_MSC_VER)
 #pragma warning(pop)
@@ -112,8 +150,9 @@ private:
 	template <typename _valueT>
 	inline void
 	_invokeWithValue(_parserElementT obj,
-	                 typename std::enable_if<std::is_floating_point<_valueT>::value, const std::string &>::type value) {
-		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj), std::atof(value.c_str()));
+	                 typename std::enable_if<std::is_floating_point<_valueT>::value, std::string_view>::type value) {
+		mFunc(universal_pointer_cast<typename _functorT::first_argument_type>(obj),
+		      std::atof(NullTerminatedString(value).c_str()));
 	}
 	template <typename _valueT>
 	inline void
@@ -121,6 +160,11 @@ private:
 	                 typename std::enable_if<std::is_convertible<_valueT, std::string>::value, _parserElementT>::type) {
 	}
 	template <typename _valueT>
+	inline void
+	_invokeWithChild(_parserElementT,
+	                 typename std::enable_if<std::is_same<_valueT, std::string_view>::value, _parserElementT>::type) {
+	}
+	template <typename _valueT>
 	inline void _invokeWithChild(_parserElementT,
 	                             typename std::enable_if<std::is_integral<_valueT>::value, _parserElementT>::type) {
 	}
@@ -158,11 +202,12 @@ class HandlerContextBase;
 template <typename _parserElementT>
 class ParserHandlerBase {
 	friend class HandlerContext<_parserElementT>;
+	friend class Parser<_parserElementT>;
 
 public:
 	virtual ~ParserHandlerBase() = default;
 	/* Invoke the creation of the object that will represent an element being parsed */
-	virtual _parserElementT invoke(const std::string &input, size_t begin, size_t count) = 0;
+	virtual _parserElementT invoke(std::string_view input, size_t begin, size_t count) = 0;
 
 	std::shared_ptr<HandlerContext<_parserElementT>> createContext();
 	inline const std::string &getRulename() const {
@@ -197,7 +242,7 @@ public:
 	ParserHandler(const Parser<_parserElementT> &parser, const std::string &rulename, _createElementFn create)
 	    : ParserHandlerBase<_parserElementT>(parser, rulename), mHandlerCreateFunc(create) {
 	}
-	_parserElementT invoke(const std::string &input, size_t begin, size_t count) override;
+	_parserElementT invoke(std::string_view input, size_t begin, size_t count) override;
 
 	template <typename _functorT>
 	ParserHandler<_createElementFn, _parserElementT> *setCollector(const std::string &child_rule_name, _functorT fn) {
@@ -209,14 +254,14 @@ private:
 	template <typename _funcT>
 	typename std::enable_if<std::is_convertible<typename _funcT::first_argument_type, std::string>::value,
 	                        _derivedParserElementT>::type
-	_invoke(const std::string &value, size_t begin, size_t count) {
+	_invoke(std::string_view value, size_t begin, size_t count) {
 		// Case where the create func accepts two strings for rulename and matched characters.
-		return mHandlerCreateFunc(this->getRulename(), value.substr(begin, count));
+		return mHandlerCreateFunc(this->getRulename(), std::string(value.substr(begin, count)));
 	}
 	template <typename _funcT>
 	typename std::enable_if<std::is_convertible<_funcT, std::function<_derivedParserElementT()>>::value,
 	                        _derivedParserElementT>::type
-	_invoke(const std::string &, size_t, size_t) {
+	_invoke(std::string_view, size_t, size_t) {
 		return mHandlerCreateFunc();
 	}
 	_createElementFn mHandlerCreateFunc;
@@ -240,7 +285,7 @@ public:
 	}
 
 	/* Invoke the assignment of a sub-lement to a parent object */
-	void invoke(_parserElementT parent, const std::string &input);
+	void invoke(_parserElementT parent, std::string_view input);
 
 private:
 	CollectorBase<_parserElementT> *mCollector; // not a shared_ptr for optimization, the collector cannot disapear
@@ -267,7 +312,7 @@ public:
 	/* Set a child to the element, by adding an Assignment. */
 	void setChild(unsigned int subrule_id, size_t begin, size_t count, const std::shared_ptr<HandlerContext> &child);
 	/* Create the object representing the element, and perform the assignments. */
-	_parserElementT realize(const std::string &input, size_t begin, size_t count);
+	_parserElementT realize(std::string_view input, size_t begin, size_t count);
 	/* Create a HandlerContext in order to try a new path of the automaton.
 	 * This HandlerContext may be kept if the parsing was succesfull, in which case merge() must be called.
 	 * If not succesfull, recyle() must be used.
@@ -312,13 +357,21 @@ public:
 	virtual void beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec) = 0;
 	/* Called when the Recognizer has finished to process an input, and notifies the position and number of characters
 	 * parsed. */
-	virtual void endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count) = 0;
+	virtual void endParse(const ParserLocalContext &ctx, std::string_view input, size_t begin, size_t count) = 0;
 	/* Called when creating a branch, in order to explore a branch of the automaton tree. */
 	virtual std::shared_ptr<HandlerContextBase> branch() = 0;
 	/* If the branch succesfully parsed characters, it is merged.*/
 	virtual void merge(const std::shared_ptr<HandlerContextBase> &other) = 0;
 	/* Otherwise, it is removed. */
 	virtual void removeBranch(const std::shared_ptr<HandlerContextBase> &other) = 0;
+	/* Returns true if the Recognizer can process the input without notifying this context, because nothing is to be
+	 * built from what it recognizes. */
+	bool isPure(const Recognizer *rec) const {
+		return mPureRecognizers && rec->getSerial() < mPureRecognizers->size() && (*mPureRecognizers)[rec->getSerial()];
+	}
+
+protected:
+	const std::vector<bool> *mPureRecognizers = nullptr;
 };
 
 /*
@@ -329,17 +382,17 @@ template <typename _parserElementT>
 class ParserContext : public ParserContextBase {
 public:
 	ParserContext(Parser<_parserElementT> &parser);
-	_parserElementT createRootObject(const std::string &input, size_t count);
+	_parserElementT createRootObject(std::string_view input, size_t count);
 
 protected:
 	void beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec) override;
-	void endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count) override;
+	void endParse(const ParserLocalContext &ctx, std::string_view input, size_t begin, size_t count) override;
 	std::shared_ptr<HandlerContextBase> branch() override;
 	void merge(const std::shared_ptr<HandlerContextBase> &other) override;
 	void removeBranch(const std::shared_ptr<HandlerContextBase> &other) override;
 
 	void _beginParse(ParserLocalContext &ctx, const std::shared_ptr<Recognizer> &rec);
-	void _endParse(const ParserLocalContext &ctx, const std::string &input, size_t begin, size_t count);
+	void _endParse(const ParserLocalContext &ctx, std::string_view input, size_t begin, size_t count);
 	std::shared_ptr<HandlerContext<_parserElementT>> _branch();
 	void _merge(const std::shared_ptr<HandlerContext<_parserElementT>> &other);
 	void _removeBranch(const std::shared_ptr<HandlerContext<_parserElementT>> &other);
@@ -373,15 +426,21 @@ public:
 		return ret;
 	}
 	_parserElementT
-	parseInput(const std::string &rulename, const std::string &input, size_t *parsed_size, bool full_match = false);
+	parseInput(const std::string &rulename, std::string_view input, size_t *parsed_size, bool full_match = false);
 
 private:
 	ParserHandlerBase<_parserElementT> *getHandler(unsigned int);
 	void installHandler(ParserHandlerBase<_parserElementT> *handler);
+	void invalidateSpecialization() const;
+	/* Find the recognizers of the grammar this parser has nothing to build from. */
+	void specialize();
 	std::shared_ptr<Grammar> mGrammar;
 	std::map<unsigned int, std::unique_ptr<ParserHandlerBase<_parserElementT>>> mHandlers;
 	std::unique_ptr<ParserHandlerBase<_parserElementT>> mNullHandler;
 	std::unique_ptr<CollectorBase<_parserElementT>> mNullCollector;
+	std::vector<bool> mPureRecognizers;
+	mutable std::atomic<bool> mSpecialized{false};
+	std::mutex mSpecializationMutex;
 };
 
 class DebugElement {
@@ -428,13 +487,13 @@ struct StringToCharMapper {
 	StringToCharMapper(const std::function<_retT(_arg1T, const char *)> &cfunc) : mCFunc(cfunc) {
 	}
 	std::function<_retT(_arg1T, const char *)> mCFunc;
-	_retT operator()(_arg1T arg1, const std::string &arg2) {
-		return mCFunc(arg1, arg2.c_str());
+	_retT operator()(_arg1T arg1, std::string_view arg2) {
+		return mCFunc(arg1, NullTerminatedString(arg2).c_str());
 	}
 };
 
 template <typename _retT, typename _arg1T>
-inline std::function<_retT(_arg1T, const std::string &)> make_fn(_retT (*arg)(_arg1T, const char *)) {
+inline std::function<_retT(_arg1T, std::string_view)> make_fn(_retT (*arg)(_arg1T, const char *)) {
 	return StringToCharMapper<_retT, _arg1T>(arg);
 }
 
@@ -467,12 +526,12 @@ void ParserCollector<_functorT, _parserElementT>::invokeWithChild(_parserElement
 }
 
 template <typename _functorT, typename _parserElementT>
-void ParserCollector<_functorT, _parserElementT>::invokeWithValue(_parserElementT obj, const std::string &value) {
+void ParserCollector<_functorT, _parserElementT>::invokeWithValue(_parserElementT obj, std::string_view value) {
 	_invokeWithValue<typename _functorT::second_argument_type>(obj, value);
 }
 
 template <typename _parserElementT>
-void Assignment<_parserElementT>::invoke(_parserElementT parent, const std::string &input) {
+void Assignment<_parserElementT>::invoke(_parserElementT parent, std::string_view input) {
 	if (mChild) {
 		mCollector->invokeWithChild(parent, mChild->realize(input, mBegin, mCount));
 	} else {
@@ -500,7 +559,7 @@ void HandlerContext<_parserElementT>::setChild(unsigned int subrule_id,
 }
 
 template <typename _parserElementT>
-_parserElementT HandlerContext<_parserElementT>::realize(const std::string &input, size_t begin, size_t count) {
+_parserElementT HandlerContext<_parserElementT>::realize(std::string_view input, size_t begin, size_t count) {
 	_parserElementT ret = mHandler.invoke(input, begin, count);
 	for (auto it = mAssignments.begin(); it != mAssignments.end(); ++it) {
 		(*it).invoke(ret, input);
@@ -556,6 +615,7 @@ void ParserHandlerBase<_parserElementT>::installCollector(const std::string &rul
 		return;
 	}
 	mCollectors[rec->getId()].reset(collector);
+	mParser.invalidateSpecialization();
 }
 
 template <typename _parserElementT>
@@ -606,7 +666,7 @@ std::shared_ptr<HandlerContext<_parserElementT>> ParserHandlerBase<_parserElemen
 
 template <typename _createElementFn, typename _parserElementT>
 _parserElementT
-ParserHandler<_createElementFn, _parserElementT>::invoke(const std::string &input, size_t begin, size_t count) {
+ParserHandler<_createElementFn, _parserElementT>::invoke(std::string_view input, size_t begin, size_t count) {
 	return universal_pointer_cast<_parserElementT>(_invoke<_createElementFn>(input, begin, count));
 }
 
@@ -616,6 +676,7 @@ ParserHandler<_createElementFn, _parserElementT>::invoke(const std::string &inpu
 
 template <typename _parserElementT>
 ParserContext<_parserElementT>::ParserContext(Parser<_parserElementT> &parser) : mParser(parser) {
+	mPureRecognizers = &parser.mPureRecognizers;
 }
 
 template <typename _parserElementT>
@@ -636,7 +697,7 @@ inline void ParserContext<_parserElementT>::_beginParse(ParserLocalContext &lctx
 
 template <typename _parserElementT>
 inline void ParserContext<_parserElementT>::_endParse(const ParserLocalContext &localctx,
-                                                      const std::string &,
+                                                      std::string_view,
                                                       size_t begin,
                                                       size_t count) {
 	if (localctx.mHandlerContext) {
@@ -668,7 +729,7 @@ inline void ParserContext<_parserElementT>::_endParse(const ParserLocalContext &
 }
 
 template <typename _parserElementT>
-_parserElementT ParserContext<_parserElementT>::createRootObject(const std::string &input, size_t count) {
+_parserElementT ParserContext<_parserElementT>::createRootObject(std::string_view input, size_t count) {
 	return mRoot ? mRoot->realize(input, 0, count) : nullptr;
 }
 
@@ -712,7 +773,7 @@ void ParserContext<_parserElementT>::beginParse(ParserLocalContext &ctx, const s
 
 template <typename _parserElementT>
 void ParserContext<_parserElementT>::endParse(const ParserLocalContext &localctx,
-                                              const std::string &input,
+                                              std::string_view input,
                                               size_t begin,
                                               size_t count) {
 	_endParse(localctx, input, begin, count);
@@ -761,15 +822,38 @@ void Parser<_parserElementT>::installHandler(ParserHandlerBase<_parserElementT>
 		fatal(str.str().c_str());
 	}
 	mHandlers[rec->getId()].reset(handler);
+	invalidateSpecialization();
+}
+
+template <typename _parserElementT>
+void Parser<_parserElementT>::invalidateSpecialization() const {
+	mSpecialized = false;
+}
+
+template <typename _parserElementT>
+void Parser<_parserElementT>::specialize() {
+	std::lock_guard<std::mutex> lock(mSpecializationMutex);
+	if (mSpecialized) return;
+
+	std::set<unsigned int> ruleIds;
+	for (auto it = mHandlers.begin(); it != mHandlers.end(); ++it) {
+		ruleIds.insert((*it).first);
+		for (auto it2 = (*it).second->mCollectors.begin(); it2 != (*it).second->mCollectors.end(); ++it2) {
+			ruleIds.insert((*it2).first);
+		}
+	}
+	mGrammar->computePureRecognizers(ruleIds, mPureRecognizers);
+	mSpecialized = true;
 }
 
 template <typename _parserElementT>
 _parserElementT Parser<_parserElementT>::parseInput(const std::string &rulename,
-                                                    const std::string &input,
+                                                    std::string_view input,
                                                     size_t *parsed_size,
                                                     bool full_match) {
 	size_t parsed;
 	std::shared_ptr<Recognizer> rec = mGrammar->getRule(rulename);
+	if (!mSpecialized) specialize();
 	ParserContext<_parserElementT> pctx(*this);
 
 	auto h = getHandler(rec->getId());
@@ -24,6 +24,11 @@
 // #define BCTBX_DEBUG_MODE 1
 // #define BELR_DEBUG 1
 
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <bctoolbox/defs.h>
 
 #include "belr/belr.h"
@@ -35,6 +40,14 @@ using namespace std;
 
 namespace belr {
 
+/* Beyond this depth, recognizers are not considered as recognizing a single character, to avoid loops. */
+static const int maxCharClassRecursion = 32;
+
+/* The input is not required to be null terminated: past its end, it reads as '\0' as a C string would. */
+static inline char charAt(std::string_view input, size_t pos) {
+	return pos < input.size() ? input[pos] : '\0';
+}
+
 void fatal(const char *message) {
 	bctbx_fatal("%s", message);
 }
@@ -47,7 +60,7 @@ public:
 	                        BCTBX_UNUSED(const std::shared_ptr<Recognizer> &rec)) override {
 	}
 	virtual void endParse(BCTBX_UNUSED(const ParserLocalContext &ctx),
-	                      BCTBX_UNUSED(const std::string &input),
+	                      BCTBX_UNUSED(std::string_view input),
 	                      BCTBX_UNUSED(size_t begin),
 	                      BCTBX_UNUSED(size_t count)) override {
 	}
@@ -90,6 +103,11 @@ void TransitionMap::merge(const TransitionMap *other) {
 	}
 }
 
+unsigned int Recognizer::nextSerial() {
+	static atomic<unsigned int> serial_base{0};
+	return serial_base++;
+}
+
 void Recognizer::setName(const std::string &name) {
 	static unsigned int id_base = 0;
 	mName = name;
@@ -197,9 +215,12 @@ const string &Recognizer::getName() const {
 	return mName;
 }
 
-size_t Recognizer::feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t Recognizer::feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	size_t match;
 
+	/* Nothing to build below this recognizer: no need to notify the parser context. */
+	if (ctx.isPure(this)) return this->match(input, pos);
+
 #ifdef BELR_DEBUG
 	BCTBX_SLOGD << "Trying to match: " << mName;
 #endif
@@ -210,7 +231,7 @@ size_t Recognizer::feed(ParserContextBase &ctx, const string &input, size_t pos)
 	if (match != string::npos && match > 0) {
 #ifdef BELR_DEBUG
 		if (mName.size() > 0) {
-			string matched = input.substr(pos, match);
+			string matched(input.substr(pos, match));
 			BCTBX_SLOGD << "Matched recognizer '" << mName << "' with sequence '" << matched << "'.";
 		}
 #endif
@@ -220,6 +241,11 @@ size_t Recognizer::feed(ParserContextBase &ctx, const string &input, size_t pos)
 	return match;
 }
 
+size_t Recognizer::match(std::string_view input, size_t pos) const {
+	if (mCharClass) return mCharClass->mPossibleChars[(unsigned char)charAt(input, pos)] ? 1 : string::npos;
+	return _match(input, pos);
+}
+
 bool Recognizer::getTransitionMap(TransitionMap *mask) {
 	bool ret = _getTransitionMap(mask);
 	if (0 /*!mName.empty()*/) {
@@ -244,6 +270,27 @@ bool Recognizer::_getTransitionMap(TransitionMap *mask) {
 	return true;
 }
 
+bool Recognizer::_getCharClass(BCTBX_UNUSED(TransitionMap *mask), BCTBX_UNUSED(int recursionLevel)) const {
+	return false;
+}
+
+bool Recognizer::getCharClass(TransitionMap *mask, int recursionLevel) const {
+	return _getCharClass(mask, recursionLevel);
+}
+
+void Recognizer::computeCharClass() {
+	auto charClass = unique_ptr<TransitionMap>(new TransitionMap());
+	if (getCharClass(charClass.get(), 0)) mCharClass = std::move(charClass);
+	else mCharClass.reset();
+}
+
+void Recognizer::forEachChild(const std::function<void(Recognizer *)> &func) const {
+	_forEachChild(func);
+}
+
+void Recognizer::_forEachChild(BCTBX_UNUSED(const std::function<void(Recognizer *)> &func)) const {
+}
+
 void Recognizer::optimize() {
 	optimize(0);
 }
@@ -263,14 +310,25 @@ CharRecognizer::CharRecognizer(int to_recognize, bool caseSensitive)
 	}
 }
 
-size_t CharRecognizer::_feed(BCTBX_UNUSED(ParserContextBase &ctx), const string &input, size_t pos) {
-	int c = (unsigned char)input[pos];
+size_t CharRecognizer::_feed(BCTBX_UNUSED(ParserContextBase &ctx), std::string_view input, size_t pos) {
+	return _match(input, pos);
+}
+
+size_t CharRecognizer::_match(std::string_view input, size_t pos) const {
+	int c = (unsigned char)charAt(input, pos);
 	if (mCaseSensitive) {
 		return c == mToRecognize ? 1 : string::npos;
 	}
 	return ::tolower(c) == mToRecognize ? 1 : string::npos;
 }
 
+bool CharRecognizer::_getCharClass(TransitionMap *mask, BCTBX_UNUSED(int recursionLevel)) const {
+	for (int i = 0; i < 256; ++i) {
+		if ((mCaseSensitive ? i : ::tolower(i)) == mToRecognize) mask->mPossibleChars[i] = true;
+	}
+	return true;
+}
+
 void CharRecognizer::_optimize(BCTBX_UNUSED(int recursionLevel)) {
 }
 
@@ -302,7 +360,7 @@ bool Selector::_getTransitionMap(TransitionMap *mask) {
 	return true;
 }
 
-size_t Selector::_feedExclusive(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t Selector::_feedExclusive(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	size_t matched = 0;
 
 	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
@@ -314,7 +372,7 @@ size_t Selector::_feedExclusive(ParserContextBase &ctx, const string &input, siz
 	return string::npos;
 }
 
-size_t Selector::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t Selector::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	if (mIsExclusive) return _feedExclusive(ctx, input, pos);
 
 	size_t matched = 0;
@@ -340,6 +398,35 @@ size_t Selector::_feed(ParserContextBase &ctx, const string &input, size_t pos)
 	return bestmatch;
 }
 
+size_t Selector::_match(std::string_view input, size_t pos) const {
+	size_t matched = 0;
+	size_t bestmatch = string::npos;
+
+	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
+		matched = (*it)->match(input, pos);
+		if (mIsExclusive) {
+			if (matched != string::npos && matched > 0) return matched;
+		} else if (matched != string::npos && (matched > bestmatch || bestmatch == string::npos)) {
+			bestmatch = matched;
+		}
+	}
+	return bestmatch;
+}
+
+bool Selector::_getCharClass(TransitionMap *mask, int recursionLevel) const {
+	if (mElements.empty() || recursionLevel > maxCharClassRecursion) return false;
+	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
+		if (!(*it)->getCharClass(mask, recursionLevel + 1)) return false;
+	}
+	return true;
+}
+
+void Selector::_forEachChild(const std::function<void(Recognizer *)> &func) const {
+	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
+		func((*it).get());
+	}
+}
+
 void Selector::_serialize(BinaryOutputStream &fstr) {
 	fstr << (unsigned char)mIsExclusive;
 	fstr << (int)mElements.size();
@@ -400,7 +487,7 @@ ExclusiveSelector::ExclusiveSelector() : Selector(true) {
 ExclusiveSelector::ExclusiveSelector(BinaryGrammarBuilder &istr) : Selector(istr) {
 }
 
-size_t ExclusiveSelector::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t ExclusiveSelector::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	return Selector::_feedExclusive(ctx, input, pos);
 }
 
@@ -420,7 +507,7 @@ bool Sequence::_getTransitionMap(TransitionMap *mask) {
 	return isComplete;
 }
 
-size_t Sequence::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t Sequence::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	size_t matched = 0;
 	size_t total = 0;
 
@@ -435,6 +522,32 @@ size_t Sequence::_feed(ParserContextBase &ctx, const string &input, size_t pos)
 	return total;
 }
 
+size_t Sequence::_match(std::string_view input, size_t pos) const {
+	size_t matched = 0;
+	size_t total = 0;
+
+	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
+		matched = (*it)->match(input, pos);
+		if (matched == string::npos) {
+			return string::npos;
+		}
+		pos += matched;
+		total += matched;
+	}
+	return total;
+}
+
+bool Sequence::_getCharClass(TransitionMap *mask, int recursionLevel) const {
+	if (mElements.size() != 1 || recursionLevel > maxCharClassRecursion) return false;
+	return mElements.front()->getCharClass(mask, recursionLevel + 1);
+}
+
+void Sequence::_forEachChild(const std::function<void(Recognizer *)> &func) const {
+	for (auto it = mElements.begin(); it != mElements.end(); ++it) {
+		func((*it).get());
+	}
+}
+
 void Sequence::_optimize(int recursionLevel) {
 	for (auto it = mElements.begin(); it != mElements.end(); ++it)
 		(*it)->optimize(recursionLevel);
@@ -466,12 +579,15 @@ shared_ptr<Loop> Loop::setRecognizer(const shared_ptr<Recognizer> &element, int
 	return static_pointer_cast<Loop>(shared_from_this());
 }
 
-size_t Loop::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t Loop::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	size_t matched = 0;
 	size_t total = 0;
 	int repeat;
 
-	for (repeat = 0; (mMax != -1 ? repeat < mMax : true) && input[pos] != '\0'; repeat++) {
+	const TransitionMap *charClass = mRecognizer->getCharClass();
+	if (charClass && ctx.isPure(mRecognizer.get())) return matchCharClass(charClass, input, pos);
+
+	for (repeat = 0; (mMax != -1 ? repeat < mMax : true) && charAt(input, pos) != '\0'; repeat++) {
 		matched = mRecognizer->feed(ctx, input, pos);
 		if (matched == string::npos) break;
 		total += matched;
@@ -481,6 +597,39 @@ size_t Loop::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
 	return total;
 }
 
+size_t Loop::_match(std::string_view input, size_t pos) const {
+	size_t matched = 0;
+	size_t total = 0;
+	int repeat;
+
+	const TransitionMap *charClass = mRecognizer->getCharClass();
+	if (charClass) return matchCharClass(charClass, input, pos);
+
+	for (repeat = 0; (mMax != -1 ? repeat < mMax : true) && charAt(input, pos) != '\0'; repeat++) {
+		matched = mRecognizer->match(input, pos);
+		if (matched == string::npos) break;
+		total += matched;
+		pos += matched;
+	}
+	if (repeat < mMin) return string::npos;
+	return total;
+}
+
+size_t Loop::matchCharClass(const TransitionMap *charClass, std::string_view input, size_t pos) const {
+	size_t begin = pos;
+	int repeat;
+
+	for (repeat = 0; (mMax != -1 ? repeat < mMax : true) && charAt(input, pos) != '\0'; repeat++, pos++) {
+		if (!charClass->mPossibleChars[(unsigned char)charAt(input, pos)]) break;
+	}
+	if (repeat < mMin) return string::npos;
+	return pos - begin;
+}
+
+void Loop::_forEachChild(const std::function<void(Recognizer *)> &func) const {
+	func(mRecognizer.get());
+}
+
 bool Loop::_getTransitionMap(TransitionMap *mask) {
 	mRecognizer->getTransitionMap(mask);
 	return mMin !=
@@ -506,12 +655,23 @@ void Loop::_optimize(int recursionLevel) {
 CharRange::CharRange(int begin, int end) : mBegin(begin), mEnd(end) {
 }
 
-size_t CharRange::_feed(BCTBX_UNUSED(ParserContextBase &ctx), const string &input, size_t pos) {
-	int c = (unsigned char)input[pos];
+size_t CharRange::_feed(BCTBX_UNUSED(ParserContextBase &ctx), std::string_view input, size_t pos) {
+	return _match(input, pos);
+}
+
+size_t CharRange::_match(std::string_view input, size_t pos) const {
+	int c = (unsigned char)charAt(input, pos);
 	if (c >= mBegin && c <= mEnd) return 1;
 	return string::npos;
 }
 
+bool CharRange::_getCharClass(TransitionMap *mask, BCTBX_UNUSED(int recursionLevel)) const {
+	for (int i = mBegin; i <= mEnd && i < 256; ++i) {
+		mask->mPossibleChars[i] = true;
+	}
+	return true;
+}
+
 void CharRange::_optimize(BCTBX_UNUSED(int recursionLevel)) {
 }
 
@@ -550,14 +710,26 @@ shared_ptr<Loop> Foundation::loop() {
 Literal::Literal(const string &lit) : mLiteral(tolower(lit)), mLiteralSize(mLiteral.size()) {
 }
 
-size_t Literal::_feed(BCTBX_UNUSED(ParserContextBase &ctx), const string &input, size_t pos) {
+size_t Literal::_feed(BCTBX_UNUSED(ParserContextBase &ctx), std::string_view input, size_t pos) {
+	return _match(input, pos);
+}
+
+size_t Literal::_match(std::string_view input, size_t pos) const {
 	size_t i;
 	for (i = 0; i < mLiteralSize; ++i) {
-		if (::tolower(input[pos + i]) != mLiteral[i]) return string::npos;
+		if (::tolower((unsigned char)charAt(input, pos + i)) != (unsigned char)mLiteral[i]) return string::npos;
 	}
 	return mLiteralSize;
 }
 
+bool Literal::_getCharClass(TransitionMap *mask, BCTBX_UNUSED(int recursionLevel)) const {
+	if (mLiteralSize != 1) return false;
+	for (int i = 0; i < 256; ++i) {
+		if (::tolower(i) == (unsigned char)mLiteral[0]) mask->mPossibleChars[i] = true;
+	}
+	return true;
+}
+
 void Literal::_serialize(BinaryOutputStream &fstr) {
 	fstr << mLiteral;
 }
@@ -571,8 +743,8 @@ void Literal::_optimize(BCTBX_UNUSED(int recursionLevel)) {
 }
 
 bool Literal::_getTransitionMap(TransitionMap *mask) {
-	mask->mPossibleChars[::tolower(mLiteral[0])] = true;
-	mask->mPossibleChars[::toupper(mLiteral[0])] = true;
+	mask->mPossibleChars[::tolower((unsigned char)mLiteral[0])] = true;
+	mask->mPossibleChars[::toupper((unsigned char)mLiteral[0])] = true;
 	return true;
 }
 
@@ -588,7 +760,7 @@ shared_ptr<Recognizer> RecognizerPointer::getPointed() {
 	return mRecognizer;
 }
 
-size_t RecognizerPointer::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t RecognizerPointer::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	if (mRecognizer) {
 		return mRecognizer->feed(ctx, input, pos);
 	} else {
@@ -597,6 +769,24 @@ size_t RecognizerPointer::_feed(ParserContextBase &ctx, const string &input, siz
 	return string::npos;
 }
 
+size_t RecognizerPointer::_match(std::string_view input, size_t pos) const {
+	if (mRecognizer) {
+		return mRecognizer->match(input, pos);
+	} else {
+		bctbx_fatal("RecognizerPointer with name '%s' is undefined", mName.c_str());
+	}
+	return string::npos;
+}
+
+bool RecognizerPointer::_getCharClass(TransitionMap *mask, int recursionLevel) const {
+	if (!mRecognizer || recursionLevel > maxCharClassRecursion) return false;
+	return mRecognizer->getCharClass(mask, recursionLevel + 1);
+}
+
+void RecognizerPointer::_forEachChild(const std::function<void(Recognizer *)> &func) const {
+	if (mRecognizer) func(mRecognizer.get());
+}
+
 void RecognizerPointer::_serialize(BCTBX_UNUSED(BinaryOutputStream &fstr)) {
 	bctbx_fatal("The RecognizerPointer is not supposed to be serialized.");
 }
@@ -618,7 +808,7 @@ shared_ptr<Recognizer> RecognizerAlias::getPointed() {
 	return mRecognizer;
 }
 
-size_t RecognizerAlias::_feed(ParserContextBase &ctx, const string &input, size_t pos) {
+size_t RecognizerAlias::_feed(ParserContextBase &ctx, std::string_view input, size_t pos) {
 	if (mRecognizer) {
 		return mRecognizer->feed(ctx, input, pos);
 	} else {
@@ -627,6 +817,24 @@ size_t RecognizerAlias::_feed(ParserContextBase &ctx, const string &input, size_
 	return string::npos;
 }
 
+size_t RecognizerAlias::_match(std::string_view input, size_t pos) const {
+	if (mRecognizer) {
+		return mRecognizer->match(input, pos);
+	} else {
+		bctbx_fatal("RecognizerAlias with name '%s' is undefined", mName.c_str());
+	}
+	return string::npos;
+}
+
+bool RecognizerAlias::_getCharClass(TransitionMap *mask, int recursionLevel) const {
+	if (!mRecognizer || recursionLevel > maxCharClassRecursion) return false;
+	return mRecognizer->getCharClass(mask, recursionLevel + 1);
+}
+
+void RecognizerAlias::_forEachChild(const std::function<void(Recognizer *)> &func) const {
+	if (mRecognizer) func(mRecognizer.get());
+}
+
 void RecognizerAlias::_serialize(BinaryOutputStream &fstr) {
 	mRecognizer->serialize(fstr);
 }
@@ -745,6 +953,51 @@ void Grammar::optimize() {
 	for (auto it = mRules.begin(); it != mRules.end(); ++it) {
 		(*it).second->optimize();
 	}
+	computeCharClasses();
+}
+
+void Grammar::forEachRecognizer(const std::function<void(Recognizer *)> &func) {
+	unordered_set<Recognizer *> visited;
+	vector<Recognizer *> toVisit;
+
+	for (auto it = mRules.begin(); it != mRules.end(); ++it) {
+		toVisit.push_back((*it).second.get());
+	}
+	while (!toVisit.empty()) {
+		Recognizer *rec = toVisit.back();
+		toVisit.pop_back();
+		if (!visited.insert(rec).second) continue;
+		func(rec);
+		rec->forEachChild([&toVisit](Recognizer *child) { toVisit.push_back(child); });
+	}
+}
+
+/* Recognizers of exactly one character are matched with a single lookup in a table, instead of exploring them. */
+void Grammar::computeCharClasses() {
+	forEachRecognizer([](Recognizer *rec) { rec->computeCharClass(); });
+}
+
+void Grammar::computePureRecognizers(const std::set<unsigned int> &ruleIds, std::vector<bool> &pureRecognizers) {
+	unordered_map<Recognizer *, vector<Recognizer *>> parents;
+	vector<Recognizer *> impure;
+	unsigned int maxSerial = 0;
+
+	forEachRecognizer([&](Recognizer *rec) {
+		maxSerial = max(maxSerial, rec->getSerial());
+		if (rec->getId() != 0 && ruleIds.find(rec->getId()) != ruleIds.end()) impure.push_back(rec);
+		rec->forEachChild([&parents, rec](Recognizer *child) { parents[child].push_back(rec); });
+	});
+
+	/* A recognizer is not pure as soon as one of the rules can be reached from it. */
+	pureRecognizers.assign(maxSerial + 1, true);
+	while (!impure.empty()) {
+		Recognizer *rec = impure.back();
+		impure.pop_back();
+		if (!pureRecognizers[rec->getSerial()]) continue;
+		pureRecognizers[rec->getSerial()] = false;
+		auto it = parents.find(rec);
+		if (it != parents.end()) impure.insert(impure.end(), (*it).second.begin(), (*it).second.end());
+	}
 }
 
 int Grammar::getNumRules() const {
@@ -816,6 +1069,8 @@ int Grammar::load(const std::string &filename) {
 	if (!isComplete()) {
 		bctbx_error("Grammar is not complete");
 		err = -1;
+	} else {
+		computeCharClasses();
 	}
 	return err;
 }
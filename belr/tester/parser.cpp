@@ -122,6 +122,92 @@ static void parser_connected_to_c_functions(void) {
 	sip_response_destroy(resp);
 }
 
+static void parser_fed_with_string_view(void) {
+	string grammarToParse = bcTesterRes("sipgrammar.txt");
+	string sipmessage = openFile(bcTesterRes("response.txt"));
+
+	BC_ASSERT_TRUE(sipmessage.size() > 0);
+
+	ABNFGrammarBuilder builder;
+	shared_ptr<Grammar> grammar = builder.createFromAbnfFile(grammarToParse, make_shared<CoreRules>());
+	BC_ASSERT_FALSE(!grammar);
+	if (!grammar) return;
+
+	shared_ptr<Parser<void *>> parser = make_shared<Parser<void *>>(grammar);
+	parser->setHandler("response", make_fn(&sip_response_create))
+	    ->setCollector("from", make_fn(&sip_response_set_from))
+	    ->setCollector("to", make_fn(&sip_response_set_to));
+	parser->setHandler("from", make_fn(&sip_uri_create))
+	    ->setCollector("user", make_fn(&sip_uri_set_user))
+	    ->setCollector("host", make_fn(&sip_uri_set_host));
+	parser->setHandler("to", make_fn(&sip_uri_create))
+	    ->setCollector("user", make_fn(&sip_uri_set_user))
+	    ->setCollector("host", make_fn(&sip_uri_set_host))
+	    ->setCollector("port", make_fn(&sip_uri_set_port));
+
+	/* The input is a part of a larger buffer, that is not null terminated after the message. */
+	string buffer = sipmessage + "NOT PART OF THE MESSAGE";
+	string_view input(buffer.data(), sipmessage.size());
+	size_t pos = 0;
+	void *elem = parser->parseInput("response", input, &pos, true);
+	BC_ASSERT_PTR_NOT_NULL(elem);
+	if (!elem) return;
+
+	BC_ASSERT_EQUAL((int)pos, (int)sipmessage.size(), int, "%i");
+
+	sip_response_t *resp = (sip_response_t *)elem;
+	BC_ASSERT_PTR_NOT_NULL(resp->to);
+	if (resp->to) {
+		BC_ASSERT_STRING_EQUAL(resp->to->user, "smorlat2");
+		BC_ASSERT_STRING_EQUAL(resp->to->host, "siptest.linphone.org");
+		BC_ASSERT_EQUAL(resp->to->port, 5060, int, "%i");
+	}
+	sip_response_destroy(resp);
+}
+
+static void parser_with_collector_added_after_parsing(void) {
+	string grammarToParse = bcTesterRes("sipgrammar.txt");
+	string sipmessage = openFile(bcTesterRes("response.txt"));
+
+	ABNFGrammarBuilder builder;
+	shared_ptr<Grammar> grammar = builder.createFromAbnfFile(grammarToParse, make_shared<CoreRules>());
+	BC_ASSERT_FALSE(!grammar);
+	if (!grammar) return;
+
+	/* The parser skips the context notifications for the rules it has nothing to build from, this must be updated
+	 * when a collector is added. */
+	shared_ptr<Parser<void *>> parser = make_shared<Parser<void *>>(grammar);
+	parser->setHandler("response", make_fn(&sip_response_create))->setCollector("to", make_fn(&sip_response_set_to));
+	auto toHandler = parser->setHandler("to", make_fn(&sip_uri_create));
+	toHandler->setCollector("host", make_fn(&sip_uri_set_host));
+
+	size_t pos = 0;
+	sip_response_t *resp = (sip_response_t *)parser->parseInput("response", sipmessage, &pos);
+	BC_ASSERT_PTR_NOT_NULL(resp);
+	if (!resp) return;
+	BC_ASSERT_EQUAL((int)pos, (int)sipmessage.size(), int, "%i");
+	BC_ASSERT_PTR_NULL(resp->from);
+	BC_ASSERT_PTR_NOT_NULL(resp->to);
+	if (resp->to) {
+		BC_ASSERT_PTR_NULL(resp->to->user);
+		BC_ASSERT_STRING_EQUAL(resp->to->host, "siptest.linphone.org");
+		BC_ASSERT_EQUAL(resp->to->port, 0, int, "%i");
+	}
+	sip_response_destroy(resp);
+
+	toHandler->setCollector("user", make_fn(&sip_uri_set_user))->setCollector("port", make_fn(&sip_uri_set_port));
+	resp = (sip_response_t *)parser->parseInput("response", sipmessage, &pos);
+	BC_ASSERT_PTR_NOT_NULL(resp);
+	if (!resp) return;
+	BC_ASSERT_PTR_NOT_NULL(resp->to);
+	if (resp->to) {
+		BC_ASSERT_STRING_EQUAL(resp->to->user, "smorlat2");
+		BC_ASSERT_STRING_EQUAL(resp->to->host, "siptest.linphone.org");
+		BC_ASSERT_EQUAL(resp->to->port, 5060, int, "%i");
+	}
+	sip_response_destroy(resp);
+}
+
 //
 // Parser with inheritance.
 //
@@ -287,6 +373,9 @@ static void parser_with_inheritance(void) {
 }
 
 static test_t tests[] = {TEST_NO_TAG("Parser connected to C functions", parser_connected_to_c_functions),
+                         TEST_NO_TAG("Parser fed with a string view", parser_fed_with_string_view),
+                         TEST_NO_TAG("Parser with collector added after parsing",
+                                     parser_with_collector_added_after_parsing),
                          TEST_NO_TAG("Parser with inheritance", parser_with_inheritance)};
 
 test_suite_t parser_suite = {"Parser", NULL, NULL, NULL, NULL, sizeof(tests) / sizeof(tests[0]), tests, 0, 0};
@@ -711,6 +711,32 @@ BZRTP_EXPORT int bzrtp_set_MTU(bzrtpContext_t *zrtpContext, size_t mtu);
  */
 BZRTP_EXPORT size_t bzrtp_get_MTU(bzrtpContext_t *zrtpContext);
 
+/**
+ * @brief Statistics of the key agreement pool
+ */
+typedef struct bzrtpKeyAgreementPoolStats_struct {
+	uint64_t hits; /**< number of key pairs given by the pool */
+	uint64_t misses; /**< number of key pairs generated on demand because the pool was empty */
+	uint32_t ready; /**< number of key pairs currently in the pool */
+} bzrtpKeyAgreementPoolStats_t;
+
+/**
+ * @brief set the number of key pairs the key agreement pool keeps ready for each algorithm in use
+ * The pool is shared by all the ZRTP contexts: a low priority thread generates in advance the DH, ECDH and KEM key pairs,
+ * so creating the Commit or DHPart messages does not wait for it. A key pair is used only once.
+ * The pool is disabled by default.
+ *
+ * @param[in]		poolSize		Number of key pairs per algorithm, 0 disables the pool and frees the key pairs it holds
+ */
+BZRTP_EXPORT void bzrtp_setKeyAgreementPoolSize(uint8_t poolSize);
+
+/**
+ * @brief get the statistics of the key agreement pool
+ *
+ * @param[out]		stats			Filled with the pool statistics
+ */
+BZRTP_EXPORT void bzrtp_getKeyAgreementPoolStats(bzrtpKeyAgreementPoolStats_t *stats);
+
 
 /**
  * @brief Retrieve the list of available key agreements algorithms
@@ -262,6 +262,15 @@ uint16_t bzrtp_computeKeyAgreementSharedSecretLength(uint8_t keyAgreementAlgo, u
  */
 bool_t bzrtp_isKem(uint8_t keyAgreementAlgo);
 
+/**
+ * Return the length of the secret used by the DHM key agreements: twice the size of the cipher key - rfc section 5.1.5
+ *
+ * @param[in]	cipherAlgo	The negotiated cipher algo mapped to an integer as defined in cryptoUtils.h
+ *
+ * @return		the DHM secret length in bytes
+ */
+uint8_t bzrtp_computeDHMSecretLength(uint8_t cipherAlgo);
+
 /**
  * Compute the variable size of data in a Commit message based on the given key agreement algorithm
  * For DH types, it is the hvi size, for KEM types, it is the hvi size + public key size, for preShared or multistream the nonce size
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2014-2024 Belledonne Communications SARL.
+ *
+ * This file is part of bzrtp.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEYAGREEMENTPOOL_H
+#define KEYAGREEMENTPOOL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ * The key agreement pool holds key pairs generated in advance by a background thread, so the DHPart and Commit
+ * messages do not have to wait for the key generation. It is shared by all the ZRTP contexts and disabled by default,
+ * see bzrtp_setKeyAgreementPoolSize.
+ * The pool learns which algorithms are in use from the calls to bzrtp_keyAgreementPool_get and
+ * bzrtp_keyAgreementPool_prepare, then keeps some key pairs ready for each of them.
+ */
+
+/**
+ * @brief Take a key pair from the pool. A key pair is given only once, it then belongs to the caller.
+ * When the pool is empty for this algorithm, it is refilled in background and the caller shall generate the key pair.
+ *
+ * @param[in]	keyAgreementAlgo	The key agreement algorithm: DH2k, DH3k, X255, X448 or any KEM
+ * @param[in]	cipherAlgo		The negotiated cipher, it gives the secret length of the DH algorithms
+ * @param[in]	hashAlgo		The negotiated hash, it is used by the KEM algorithms
+ *
+ * @return a bctbx_DHMContext_t, bctbx_ECDHContext_t or bzrtp_KEMContext_t holding a key pair according to the
+ * algorithm, NULL if the pool is disabled, empty or the algorithm has no key pair.
+ */
+void *bzrtp_keyAgreementPool_get(uint8_t keyAgreementAlgo, uint8_t cipherAlgo, uint8_t hashAlgo);
+
+/**
+ * @brief Announce that key pairs of this algorithm will be needed soon, so the pool generates some if it is enabled
+ *
+ * @param[in]	keyAgreementAlgo	The key agreement algorithm
+ * @param[in]	cipherAlgo		The cipher expected to be negotiated
+ * @param[in]	hashAlgo		The hash expected to be negotiated
+ */
+void bzrtp_keyAgreementPool_prepare(uint8_t keyAgreementAlgo, uint8_t cipherAlgo, uint8_t hashAlgo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEYAGREEMENTPOOL_H */
@@ -24,6 +24,7 @@
 #include "typedef.h"
 #include "bctoolbox/crypto.h"
 #include "cryptoUtils.h"
+#include "keyAgreementPool.h"
 #include "zidCache.h"
 #include "packetParser.h"
 #include "stateMachine.h"
@@ -437,6 +438,13 @@ int bzrtp_startChannelEngine(bzrtpContext_t *zrtpContext, uint32_t selfSSRC) {
 		}
 	}
 
+	/* let the key agreement pool generate the key pair we will most likely need while the Hello are exchanged */
+	if (zrtpChannelContext->isMainChannel == 1 && zrtpContext->kc > 0) {
+		bzrtp_keyAgreementPool_prepare(zrtpContext->supportedKeyAgreement[0],
+			zrtpContext->cc > 0 ? zrtpContext->supportedCipher[0] : ZRTP_CIPHER_AES1,
+			zrtpContext->hc > 0 ? zrtpContext->supportedHash[0] : ZRTP_HASH_S256);
+	}
+
 	/* set the timer reference to 0 to force a message to be sent at first timer tick */
 	zrtpContext->timeReference = 0;
 
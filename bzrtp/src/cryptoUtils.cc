@@ -1462,6 +1462,21 @@ bool_t bzrtp_isKem(uint8_t keyAgreementAlgo) {
 	}
 }
 
+uint8_t bzrtp_computeDHMSecretLength(uint8_t cipherAlgo) {
+	switch (cipherAlgo) {
+	case ZRTP_CIPHER_AES3:
+	case ZRTP_CIPHER_2FS3:
+		return 64;
+	case ZRTP_CIPHER_AES2:
+	case ZRTP_CIPHER_2FS2:
+		return 48;
+	case ZRTP_CIPHER_AES1:
+	case ZRTP_CIPHER_2FS1:
+	default:
+		return 32;
+	}
+}
+
 uint16_t bzrtp_computeCommitMessageVariableLength(uint8_t keyAgreementAlgo) {
 	if (keyAgreementAlgo == ZRTP_KEYAGREEMENT_Prsh) return 24; /* nonce (16 bytes) and keyID(8 bytes) are 24 bytes length in preshared Commit message format */
 	if (keyAgreementAlgo == ZRTP_KEYAGREEMENT_Mult) return 16; /* nonce is 16 bytes length in multistream Commit message format */
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2014-2024 Belledonne Communications SARL.
+ *
+ * This file is part of bzrtp.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bctoolbox/crypto.h"
+#include "bctoolbox/logging.h"
+#include "bzrtp/bzrtp.h"
+#include "cryptoUtils.h"
+#include "keyAgreementPool.h"
+
+namespace {
+
+/* The key pairs are indexed by algorithm and by the parameter of the algorithm affecting the key pair:
+ * the secret length for DHM, the hash for KEM and nothing for ECDH */
+uint16_t poolKey(uint8_t keyAgreementAlgo, uint8_t cipherAlgo, uint8_t hashAlgo) {
+	switch (keyAgreementAlgo) {
+	case ZRTP_KEYAGREEMENT_DH2k:
+	case ZRTP_KEYAGREEMENT_DH3k:
+		return (uint16_t)(keyAgreementAlgo << 8 | bzrtp_computeDHMSecretLength(cipherAlgo));
+	case ZRTP_KEYAGREEMENT_X255:
+	case ZRTP_KEYAGREEMENT_X448:
+		return (uint16_t)(keyAgreementAlgo << 8);
+	default:
+		if (bzrtp_isKem(keyAgreementAlgo) == TRUE) {
+			return (uint16_t)(keyAgreementAlgo << 8 | hashAlgo);
+		}
+		return 0; /* no key pair to generate in advance for this algorithm */
+	}
+}
+
+void *generateKeyPair(uint16_t key, bctbx_rng_context_t *rng) {
+	uint8_t keyAgreementAlgo = (uint8_t)(key >> 8);
+	uint8_t variant = (uint8_t)(key & 0xFF);
+	switch (keyAgreementAlgo) {
+	case ZRTP_KEYAGREEMENT_DH2k:
+	case ZRTP_KEYAGREEMENT_DH3k: {
+		bctbx_DHMContext_t *DHMContext = bctbx_CreateDHMContext(
+		    (keyAgreementAlgo == ZRTP_KEYAGREEMENT_DH2k) ? BCTBX_DHM_2048 : BCTBX_DHM_3072, variant);
+		if (DHMContext != NULL) {
+			bctbx_DHMCreatePublic(DHMContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, rng);
+		}
+		return DHMContext;
+	}
+	case ZRTP_KEYAGREEMENT_X255:
+	case ZRTP_KEYAGREEMENT_X448: {
+		bctbx_ECDHContext_t *ECDHContext = bctbx_CreateECDHContext(
+		    (keyAgreementAlgo == ZRTP_KEYAGREEMENT_X255) ? BCTBX_ECDH_X25519 : BCTBX_ECDH_X448);
+		if (ECDHContext != NULL) {
+			bctbx_ECDHCreateKeyPair(ECDHContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, rng);
+		}
+		return ECDHContext;
+	}
+	default: {
+		bzrtp_KEMContext_t *KEMContext = bzrtp_createKEMContext(keyAgreementAlgo, variant);
+		if (KEMContext != NULL) {
+			bzrtp_KEM_generateKeyPair(KEMContext);
+		}
+		return KEMContext;
+	}
+	}
+}
+
+void destroyKeyPair(uint16_t key, void *context) {
+	switch (key >> 8) {
+	case ZRTP_KEYAGREEMENT_DH2k:
+	case ZRTP_KEYAGREEMENT_DH3k:
+		bctbx_DestroyDHMContext((bctbx_DHMContext_t *)context);
+		break;
+	case ZRTP_KEYAGREEMENT_X255:
+	case ZRTP_KEYAGREEMENT_X448:
+		bctbx_DestroyECDHContext((bctbx_ECDHContext_t *)context);
+		break;
+	default:
+		bzrtp_destroyKEMContext((bzrtp_KEMContext_t *)context);
+		break;
+	}
+}
+
+/*
+ * Process wide pool of key pairs, filled by a worker thread started when the pool is enabled.
+ * Each algorithm in use gets up to mSize key pairs ready.
+ */
+class KeyAgreementPool {
+public:
+	~KeyAgreementPool() {
+		setSize(0);
+	}
+
+	void setSize(uint8_t size) {
+		std::thread worker;
+		std::map<uint16_t, std::deque<void *>> keyPairs;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mSize = size;
+			if (mSize > 0) {
+				if (!mWorker.joinable()) {
+					mStopped = false;
+					mWorker = std::thread(&KeyAgreementPool::run, this);
+				}
+				for (auto &entry : mKeyPairs) { /* drop the key pairs above the new size */
+					while (entry.second.size() > mSize) {
+						destroyKeyPair(entry.first, entry.second.back());
+						entry.second.pop_back();
+					}
+				}
+				mCondition.notify_one();
+				return;
+			}
+			mStopped = true;
+			worker = std::move(mWorker);
+			keyPairs.swap(mKeyPairs);
+		}
+		mCondition.notify_one();
+		if (worker.joinable()) worker.join();
+		for (auto &entry : keyPairs) {
+			for (void *context : entry.second) {
+				destroyKeyPair(entry.first, context);
+			}
+		}
+	}
+
+	void *get(uint16_t key) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mSize == 0) return NULL;
+		auto &keyPairs = mKeyPairs[key];
+		mCondition.notify_one();
+		if (keyPairs.empty()) {
+			mMisses++;
+			return NULL;
+		}
+		void *context = keyPairs.front();
+		keyPairs.pop_front();
+		mHits++;
+		return context;
+	}
+
+	void prepare(uint16_t key) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mSize == 0) return;
+		if (mKeyPairs.emplace(key, std::deque<void *>()).second) {
+			mCondition.notify_one();
+		}
+	}
+
+	void getStats(bzrtpKeyAgreementPoolStats_t *stats) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		stats->hits = mHits;
+		stats->misses = mMisses;
+		stats->ready = 0;
+		for (const auto &entry : mKeyPairs) {
+			stats->ready += (uint32_t)entry.second.size();
+		}
+	}
+
+private:
+	void run() {
+#ifdef __linux__
+		/* the key pairs are needed later, do not compete with the media and signaling threads */
+		setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+		bctbx_rng_context_t *rng = bctbx_rng_context_new();
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (!mStopped) {
+			uint16_t key = 0;
+			for (const auto &entry : mKeyPairs) {
+				if (entry.second.size() < mSize) {
+					key = entry.first;
+					break;
+				}
+			}
+			if (key == 0) {
+				mCondition.wait(lock);
+				continue;
+			}
+
+			lock.unlock();
+			void *context = generateKeyPair(key, rng);
+			lock.lock();
+
+			if (context == NULL) {
+				bctbx_warning("Key agreement pool unable to generate a key pair for %s, stop pooling it",
+				              bzrtp_algoToString((uint8_t)(key >> 8)));
+				mKeyPairs.erase(key);
+			} else if (mStopped || mKeyPairs[key].size() >= mSize) {
+				destroyKeyPair(key, context);
+			} else {
+				mKeyPairs[key].push_back(context);
+			}
+		}
+		lock.unlock();
+		bctbx_rng_context_free(rng);
+	}
+
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::thread mWorker;
+	bool mStopped = true;
+	uint8_t mSize = 0;
+	std::map<uint16_t, std::deque<void *>> mKeyPairs;
+	uint64_t mHits = 0;
+	uint64_t mMisses = 0;
+};
+
+KeyAgreementPool &keyAgreementPool() {
+	static KeyAgreementPool pool;
+	return pool;
+}
+
+} // namespace
+
+void *bzrtp_keyAgreementPool_get(uint8_t keyAgreementAlgo, uint8_t cipherAlgo, uint8_t hashAlgo) {
+	uint16_t key = poolKey(keyAgreementAlgo, cipherAlgo, hashAlgo);
+	if (key == 0) return NULL;
+	return keyAgreementPool().get(key);
+}
+
+void bzrtp_keyAgreementPool_prepare(uint8_t keyAgreementAlgo, uint8_t cipherAlgo, uint8_t hashAlgo) {
+	uint16_t key = poolKey(keyAgreementAlgo, cipherAlgo, hashAlgo);
+	if (key == 0) return;
+	keyAgreementPool().prepare(key);
+}
+
+void bzrtp_setKeyAgreementPoolSize(uint8_t poolSize) {
+	keyAgreementPool().setSize(poolSize);
+}
+
+void bzrtp_getKeyAgreementPoolStats(bzrtpKeyAgreementPoolStats_t *stats) {
+	if (stats == NULL) return;
+	keyAgreementPool().getStats(stats);
+}
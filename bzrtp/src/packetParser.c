@@ -25,6 +25,7 @@
 #include <bctoolbox/defs.h>
 #include <bctoolbox/crypto.h>
 #include "cryptoUtils.h"
+#include "keyAgreementPool.h"
 
 /* minimum length of a ZRTP packet: 12 bytes header + 12 bytes message(shortest are ACK messages) + 4 bytes CRC */
 #define ZRTP_MIN_PACKET_LENGTH 28
@@ -1406,9 +1407,15 @@ bzrtpPacket_t *bzrtp_createZrtpPacket(bzrtpContext_t *zrtpContext, bzrtpChannelC
 
 			/* if the DH is of type KEM, generate now the key pair, store the KEM context in the  */
 			if (bzrtp_isKem(zrtpCommitMessage->keyAgreementAlgo)) {
-				bzrtp_KEMContext_t *KEMContext = bzrtp_createKEMContext(zrtpCommitMessage->keyAgreementAlgo, zrtpChannelContext->hashAlgo);
+				/* use a key pair generated in advance if there is one */
+				bzrtp_KEMContext_t *KEMContext = (bzrtp_KEMContext_t *)bzrtp_keyAgreementPool_get(zrtpCommitMessage->keyAgreementAlgo, zrtpChannelContext->cipherAlgo, zrtpChannelContext->hashAlgo);
+				if (KEMContext == NULL) {
+					KEMContext = bzrtp_createKEMContext(zrtpCommitMessage->keyAgreementAlgo, zrtpChannelContext->hashAlgo);
+					if (KEMContext != NULL) {
+						bzrtp_KEM_generateKeyPair(KEMContext);
+					}
+				}
 				if (KEMContext != NULL) {
-					bzrtp_KEM_generateKeyPair(KEMContext);
 					uint16_t pvLength = bzrtp_computeKeyAgreementPublicValueLength(zrtpCommitMessage->keyAgreementAlgo, MSGTYPE_COMMIT);
 					zrtpCommitMessage->pv = (uint8_t *)malloc(pvLength*sizeof(uint8_t));
 					memset(zrtpCommitMessage->pv, 0, pvLength); // Set the memory to zero as the buffer is expanded to have a size multiple of 0, so there might be padding at the end.
@@ -1429,7 +1436,6 @@ bzrtpPacket_t *bzrtp_createZrtpPacket(bzrtpContext_t *zrtpContext, bzrtpChannelC
 	case MSGTYPE_DHPART1 :
 	case MSGTYPE_DHPART2 :
 	{
-		uint8_t secretLength; /* is in bytes */
 		uint8_t bctbx_keyAgreementAlgo = BCTBX_DHM_UNSET;
 		bzrtpDHPartMessage_t *zrtpDHPartMessage = (bzrtpDHPartMessage_t *)malloc(sizeof(bzrtpDHPartMessage_t));
 		memset(zrtpDHPartMessage, 0, sizeof(bzrtpDHPartMessage_t));
@@ -1450,43 +1456,34 @@ bzrtpPacket_t *bzrtp_createZrtpPacket(bzrtpContext_t *zrtpContext, bzrtpChannelC
 		}
 
 		/* compute the public value and insert it in the message, will then be used whatever role - initiator or responder - we assume */
-		/* initialise the dhm context, secret length shall be twice the size of cipher block key length - rfc section 5.1.5 */
-		switch (zrtpChannelContext->cipherAlgo) {
-		case ZRTP_CIPHER_AES3:
-		case ZRTP_CIPHER_2FS3:
-			secretLength = 64;
-			break;
-		case ZRTP_CIPHER_AES2:
-		case ZRTP_CIPHER_2FS2:
-			secretLength = 48;
-			break;
-		case ZRTP_CIPHER_AES1:
-		case ZRTP_CIPHER_2FS1:
-		default:
-			secretLength = 32;
-			break;
+		/* DH and ECDH key pairs may have been generated in advance, if the pool gives none generate it now */
+		void *pooledKeyAgreementContext = NULL;
+		if (!bzrtp_isKem(zrtpChannelContext->keyAgreementAlgo)) {
+			pooledKeyAgreementContext = bzrtp_keyAgreementPool_get(zrtpChannelContext->keyAgreementAlgo, zrtpChannelContext->cipherAlgo, zrtpChannelContext->hashAlgo);
 		}
 
 		uint16_t pvLength = bzrtp_computeKeyAgreementPublicValueLength(zrtpChannelContext->keyAgreementAlgo, messageType);
 		/* DHM key exchange */
 		if (zrtpChannelContext->keyAgreementAlgo == ZRTP_KEYAGREEMENT_DH2k || zrtpChannelContext->keyAgreementAlgo == ZRTP_KEYAGREEMENT_DH3k) {
-			bctbx_DHMContext_t *DHMContext = NULL;
-			if (zrtpChannelContext->keyAgreementAlgo==ZRTP_KEYAGREEMENT_DH2k) {
-				bctbx_keyAgreementAlgo = BCTBX_DHM_2048;
-			} else {
-				bctbx_keyAgreementAlgo = BCTBX_DHM_3072;
-			}
-			/* create DHM context */
-			DHMContext = bctbx_CreateDHMContext(bctbx_keyAgreementAlgo, secretLength);
+			bctbx_DHMContext_t *DHMContext = (bctbx_DHMContext_t *)pooledKeyAgreementContext;
 			if (DHMContext == NULL) {
-				free(zrtpPacket);
-				free(zrtpDHPartMessage);
-				*exitCode = BZRTP_CREATE_ERROR_UNABLETOCREATECRYPTOCONTEXT;
-				return NULL;
-			}
+				if (zrtpChannelContext->keyAgreementAlgo==ZRTP_KEYAGREEMENT_DH2k) {
+					bctbx_keyAgreementAlgo = BCTBX_DHM_2048;
+				} else {
+					bctbx_keyAgreementAlgo = BCTBX_DHM_3072;
+				}
+				/* create DHM context, secret length shall be twice the size of cipher block key length - rfc section 5.1.5 */
+				DHMContext = bctbx_CreateDHMContext(bctbx_keyAgreementAlgo, bzrtp_computeDHMSecretLength(zrtpChannelContext->cipherAlgo));
+				if (DHMContext == NULL) {
+					free(zrtpPacket);
+					free(zrtpDHPartMessage);
+					*exitCode = BZRTP_CREATE_ERROR_UNABLETOCREATECRYPTOCONTEXT;
+					return NULL;
+				}
 
-			/* create private key and compute the public value */
-			bctbx_DHMCreatePublic(DHMContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, zrtpContext->RNGContext);
+				/* create private key and compute the public value */
+				bctbx_DHMCreatePublic(DHMContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, zrtpContext->RNGContext);
+			}
 			zrtpDHPartMessage->pv = (uint8_t *)malloc(pvLength*sizeof(uint8_t));
 			memcpy(zrtpDHPartMessage->pv, DHMContext->self, pvLength);
 			zrtpContext->keyAgreementContext = (void *)DHMContext; /* save DHM context in zrtp Context */
@@ -1494,23 +1491,25 @@ bzrtpPacket_t *bzrtp_createZrtpPacket(bzrtpContext_t *zrtpContext, bzrtpChannelC
 
 			/* ECDH key exchange */
 		} else if (zrtpChannelContext->keyAgreementAlgo == ZRTP_KEYAGREEMENT_X255 || zrtpChannelContext->keyAgreementAlgo == ZRTP_KEYAGREEMENT_X448) {
-			bctbx_ECDHContext_t *ECDHContext = NULL;
-			if (zrtpChannelContext->keyAgreementAlgo==ZRTP_KEYAGREEMENT_X255) {
-				bctbx_keyAgreementAlgo = BCTBX_ECDH_X25519;
-			} else {
-				bctbx_keyAgreementAlgo = BCTBX_ECDH_X448;
-			}
-
-			/* Create the ECDH context */
-			ECDHContext = bctbx_CreateECDHContext(bctbx_keyAgreementAlgo);
+			bctbx_ECDHContext_t *ECDHContext = (bctbx_ECDHContext_t *)pooledKeyAgreementContext;
 			if (ECDHContext == NULL) {
-				free(zrtpPacket);
-				free(zrtpDHPartMessage);
-				*exitCode = BZRTP_CREATE_ERROR_UNABLETOCREATECRYPTOCONTEXT;
-				return NULL;
+				if (zrtpChannelContext->keyAgreementAlgo==ZRTP_KEYAGREEMENT_X255) {
+					bctbx_keyAgreementAlgo = BCTBX_ECDH_X25519;
+				} else {
+					bctbx_keyAgreementAlgo = BCTBX_ECDH_X448;
+				}
+
+				/* Create the ECDH context */
+				ECDHContext = bctbx_CreateECDHContext(bctbx_keyAgreementAlgo);
+				if (ECDHContext == NULL) {
+					free(zrtpPacket);
+					free(zrtpDHPartMessage);
+					*exitCode = BZRTP_CREATE_ERROR_UNABLETOCREATECRYPTOCONTEXT;
+					return NULL;
+				}
+				/* create private key and compute the public value */
+				bctbx_ECDHCreateKeyPair(ECDHContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, zrtpContext->RNGContext);
 			}
-			/* create private key and compute the public value */
-			bctbx_ECDHCreateKeyPair(ECDHContext, (int (*)(void *, uint8_t *, size_t))bctbx_rng_get, zrtpContext->RNGContext);
 			zrtpDHPartMessage->pv = (uint8_t *)malloc(pvLength*sizeof(uint8_t));
 			memcpy(zrtpDHPartMessage->pv, ECDHContext->selfPublic, pvLength);
 			/* we might already have a keyAgreement context in the zrtpContext (if we are building a DHPart1 after having built a DHPart2) */
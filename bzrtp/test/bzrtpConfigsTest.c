@@ -2512,6 +2512,36 @@ static void test_loosy_network_goclear_multiChannel(void) {
 #endif /* GOCLEAR_ENABLED */
 }
 
+static void test_key_agreement_pool(void) {
+	bzrtpKeyAgreementPoolStats_t before, after;
+	int i;
+	cryptoParams_t *pattern = defaultCryptoAlgoSelection();
+	resetGlobalParams();
+
+	bzrtp_setKeyAgreementPoolSize(2);
+	/* first exchange registers the key agreement in the pool, it may not be filled in time */
+	BC_ASSERT_EQUAL(monochannel_exchange(pattern, pattern, pattern, NULL, NULL, NULL, NULL), 0, int, "%x");
+
+	/* wait for the background thread to refill the pool, in real time */
+	for (i=0; i<500; i++) {
+		bzrtp_getKeyAgreementPoolStats(&before);
+		if (before.ready == 2) break;
+		bctbx_sleep_ms(10);
+	}
+	BC_ASSERT_EQUAL(before.ready, 2, int, "%d");
+
+	/* both endpoints now get their key pair from the pool */
+	BC_ASSERT_EQUAL(monochannel_exchange(pattern, pattern, pattern, NULL, NULL, NULL, NULL), 0, int, "%x");
+	bzrtp_getKeyAgreementPoolStats(&after);
+	BC_ASSERT_EQUAL((int)(after.hits - before.hits), 2, int, "%d");
+	BC_ASSERT_EQUAL((int)(after.misses - before.misses), 0, int, "%d");
+
+	/* disabling the pool frees the key pairs */
+	bzrtp_setKeyAgreementPoolSize(0);
+	bzrtp_getKeyAgreementPoolStats(&after);
+	BC_ASSERT_EQUAL(after.ready, 0, int, "%d");
+}
+
 static test_t key_exchange_tests[] = {
 	TEST_NO_TAG("Cacheless multi channel", test_cacheless_exchange),
 	TEST_NO_TAG("Config contraints", test_config_contraints),
@@ -2531,6 +2561,7 @@ static test_t key_exchange_tests[] = {
 	TEST_NO_TAG("Go Clear Send simultaneously", test_goclear_sendSimultaneously),
 	TEST_NO_TAG("Loosy network GoClear", test_loosy_network_goclear),
 	TEST_NO_TAG("Loosy network GoClear Multichannel", test_loosy_network_goclear_multiChannel),
+	TEST_NO_TAG("Key agreement pool", test_key_agreement_pool),
 	TEST_NO_TAG("Performance measurements", test_performances),
 };
 
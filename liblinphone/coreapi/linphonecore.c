@@ -4644,9 +4644,6 @@ void linphone_core_iterate(LinphoneCore *lc) {
 		return;
 	}
 
-	/* We have to iterate for each call */
-	L_GET_PRIVATE_FROM_C_OBJECT(lc)->iterateCalls(current_real_time, one_second_elapsed);
-
 	if (linphone_core_video_preview_enabled(lc)) {
 		if (lc->previewstream == NULL && !L_GET_PRIVATE_FROM_C_OBJECT(lc)->hasCalls()) toggle_video_preview(lc, TRUE);
 #ifdef VIDEO_ENABLED
@@ -5445,6 +5442,8 @@ void linphone_core_set_in_call_timeout(LinphoneCore *lc, int seconds) {
 	lc->sip_conf.in_call_timeout = seconds;
 	if (linphone_core_ready(lc)) {
 		linphone_config_set_int(lc->config, "sip", "in_call_timeout", seconds);
+		/* The timeout of the ongoing calls is scheduled when they get connected */
+		L_GET_PRIVATE_FROM_C_OBJECT(lc)->updateCallsSupervision();
 	}
 }
 
@@ -46,6 +46,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string_view>
+#include <unordered_map>
 #if !defined(_WIN32_WCE)
 #include <errno.h>
 #include <sys/stat.h>
@@ -90,9 +92,14 @@ typedef struct _LpSectionParam {
 	char *value;
 } LpSectionParam;
 
+/* The sections and items are kept in lists to preserve the file ordering, and indexed by name for the lookups */
+typedef std::unordered_map<std::string_view, struct _LpItem *> LpItemIndex;
+typedef std::unordered_map<std::string_view, struct _LpSection *> LpSectionIndex;
+
 typedef struct _LpSection {
 	char *name;
 	bctbx_list_t *items;
+	LpItemIndex *items_index; /* keys point to the item keys */
 	bctbx_list_t *params;
 	bool_t overwrite; // If set to true, will add overwrite=true to all items of this section when converted to xml
 	bool_t skip;      // If set to true, won't be dumped when converted to xml
@@ -105,6 +112,8 @@ struct _LpConfig {
 	char *tmpfilename;
 	char *factory_filename;
 	bctbx_list_t *sections;
+	LpSectionIndex *sections_index; /* keys point to the section names */
+	unsigned int revision;          /* incremented on each modification, for the LinphoneConfigEntry caches */
 	bctbx_vfs_t *g_bctbx_vfs;
 	bool_t modified;
 	bool_t readonly;
@@ -164,6 +173,7 @@ LpSectionParam *lp_section_param_new(const char *key, const char *value) {
 LpSection *lp_section_new(const char *name) {
 	LpSection *sec = lp_new0(LpSection, 1);
 	sec->name = ortp_strdup(name);
+	sec->items_index = new LpItemIndex();
 	return sec;
 }
 
@@ -186,15 +196,20 @@ void lp_section_destroy(LpSection *sec) {
 	bctbx_list_for_each(sec->items, lp_item_destroy);
 	bctbx_list_for_each(sec->params, lp_section_param_destroy);
 	bctbx_list_free(sec->items);
+	delete sec->items_index;
 	free(sec);
 }
 
 void lp_section_add_item(LpSection *sec, LpItem *item) {
 	sec->items = bctbx_list_append(sec->items, (void *)item);
+	if (!item->is_comment) sec->items_index->emplace(item->key, item);
 }
 
 void linphone_config_add_section(LpConfig *lpconfig, LpSection *section) {
 	lpconfig->sections = bctbx_list_append(lpconfig->sections, (void *)section);
+	if (lpconfig->sections_index == NULL) lpconfig->sections_index = new LpSectionIndex();
+	lpconfig->sections_index->emplace(section->name, section);
+	lpconfig->revision++;
 }
 
 void linphone_config_add_section_param(LpSection *section, LpSectionParam *param) {
@@ -203,11 +218,18 @@ void linphone_config_add_section_param(LpSection *section, LpSectionParam *param
 
 void linphone_config_remove_section(LpConfig *lpconfig, LpSection *section) {
 	lpconfig->sections = bctbx_list_remove(lpconfig->sections, (void *)section);
+	auto it = lpconfig->sections_index->find(section->name);
+	if (it != lpconfig->sections_index->end() && it->second == section) lpconfig->sections_index->erase(it);
+	lpconfig->revision++;
 	lp_section_destroy(section);
 }
 
 void lp_section_remove_item(LpSection *sec, LpItem *item) {
 	sec->items = bctbx_list_remove(sec->items, (void *)item);
+	if (!item->is_comment) {
+		auto it = sec->items_index->find(item->key);
+		if (it != sec->items_index->end() && it->second == item) sec->items_index->erase(it);
+	}
 	lp_item_destroy(item);
 }
 
@@ -228,17 +250,9 @@ static int is_a_comment(const char *str) {
 }
 
 LpSection *linphone_config_find_section(const LpConfig *lpconfig, const char *name) {
-	LpSection *sec;
-	bctbx_list_t *elem = lpconfig->sections;
-	/*printf("Looking for section %s\n",name);*/
-	for (; elem != NULL; elem = bctbx_list_next(elem)) {
-		sec = (LpSection *)elem->data;
-		if (strcmp(sec->name, name) == 0) {
-			/*printf("Section %s found\n",name);*/
-			return sec;
-		}
-	}
-	return NULL;
+	if (lpconfig->sections_index == NULL) return NULL;
+	auto it = lpconfig->sections_index->find(name);
+	return it != lpconfig->sections_index->end() ? it->second : NULL;
 }
 
 LpSectionParam *lp_section_find_param(const LpSection *sec, const char *key) {
@@ -268,17 +282,8 @@ LpItem *lp_section_find_comment(const LpSection *sec, const char *comment) {
 }
 
 LpItem *lp_section_find_item(const LpSection *sec, const char *name) {
-	bctbx_list_t *elem;
-	LpItem *item;
-	/*printf("Looking for item %s\n",name);*/
-	for (elem = sec->items; elem != NULL; elem = bctbx_list_next(elem)) {
-		item = (LpItem *)elem->data;
-		if (!item->is_comment && strcmp(item->key, name) == 0) {
-			/*printf("Item %s found\n",name);*/
-			return item;
-		}
-	}
-	return NULL;
+	auto it = sec->items_index->find(name);
+	return it != sec->items_index->end() ? it->second : NULL;
 }
 
 bctbx_list_t *lp_section_get_items(const LpSection *sec) {
@@ -389,6 +394,7 @@ static LpSection *linphone_config_parse_line(LpConfig *lpconfig, char *line, LpS
 								ortp_free(item->value);
 								item->value = ortp_strdup(pos1);
 							}
+							lpconfig->revision++;
 							/*ms_message("Found %s=%s",key,pos1);*/
 						} else {
 							ms_warning("found key,item but no sections");
@@ -677,6 +683,7 @@ static void _linphone_config_uninit(LpConfig *lpconfig) {
 	if (lpconfig->tmpfilename) ortp_free(lpconfig->tmpfilename);
 	if (lpconfig->factory_filename) bctbx_free(lpconfig->factory_filename);
 	if (lpconfig->sections) bctbx_list_free_with_data(lpconfig->sections, (bctbx_list_free_func)lp_section_destroy);
+	delete lpconfig->sections_index;
 }
 
 LpConfig *linphone_config_ref(LpConfig *lpconfig) {
@@ -774,46 +781,57 @@ bool_t linphone_config_get_range(const LpConfig *lpconfig,
 	}
 }
 
+static int lp_parse_int(const char *str) {
+	int ret = 0;
+	if (strstr(str, "0x") == str) {
+		sscanf(str, "%x", &ret);
+	} else sscanf(str, "%i", &ret);
+	return ret;
+}
+
+static bool_t lp_parse_bool(const char *str) {
+	int ret = 0;
+	sscanf(str, "%i", &ret);
+	return ret != 0;
+}
+
+static int64_t lp_parse_int64(const char *str) {
+#ifdef _WIN32
+	return (int64_t)_atoi64(str);
+#else
+	return atoll(str);
+#endif
+}
+
+static float lp_parse_float(const char *str, float default_value) {
+	float ret = default_value;
+	sscanf(str, "%f", &ret);
+	return ret;
+}
+
 int linphone_config_get_int(const LpConfig *lpconfig, const char *section, const char *key, int default_value) {
 	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
-		int ret = 0;
-
-		if (strstr(str, "0x") == str) {
-			sscanf(str, "%x", &ret);
-		} else sscanf(str, "%i", &ret);
-		return ret;
-	} else return default_value;
+	if (str != NULL) return lp_parse_int(str);
+	else return default_value;
 }
 
 bool_t linphone_config_get_bool(const LpConfig *lpconfig, const char *section, const char *key, bool_t default_value) {
 	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
-		int ret = 0;
-		sscanf(str, "%i", &ret);
-		return ret != 0;
-	}
+	if (str != NULL) return lp_parse_bool(str);
 	return default_value;
 }
 
 int64_t
 linphone_config_get_int64(const LpConfig *lpconfig, const char *section, const char *key, int64_t default_value) {
 	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
-#ifdef _WIN32
-		return (int64_t)_atoi64(str);
-#else
-		return atoll(str);
-#endif
-	} else return default_value;
+	if (str != NULL) return lp_parse_int64(str);
+	else return default_value;
 }
 
 float linphone_config_get_float(const LpConfig *lpconfig, const char *section, const char *key, float default_value) {
 	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	float ret = default_value;
 	if (str == NULL) return default_value;
-	sscanf(str, "%f", &ret);
-	return ret;
+	return lp_parse_float(str, default_value);
 }
 
 bool_t linphone_config_get_overwrite_flag_for_entry(const LpConfig *lpconfig, const char *section, const char *key) {
@@ -876,6 +894,7 @@ void linphone_config_set_string(LpConfig *lpconfig, const char *section, const c
 		linphone_config_add_section(lpconfig, sec);
 		lp_section_add_item(sec, lp_item_new(key, value));
 	}
+	lpconfig->revision++;
 	lpconfig->modified = TRUE;
 }
 
@@ -1063,6 +1082,8 @@ void linphone_config_reload(LinphoneConfig *lpconfig) {
 	bctbx_list_for_each(lpconfig->sections, (void (*)(void *))lp_section_destroy);
 	bctbx_list_free(lpconfig->sections);
 	lpconfig->sections = NULL;
+	if (lpconfig->sections_index) lpconfig->sections_index->clear();
+	lpconfig->revision++;
 	linphone_config_read_file(lpconfig, lpconfig->filename);
 }
 
@@ -1379,7 +1400,7 @@ void linphone_config_clean_entry(LpConfig *lpconfig, const char *section, const
 		item = lp_section_find_item(sec, key);
 		if (item != NULL) lp_section_remove_item(sec, item);
 	}
-	return;
+	lpconfig->revision++;
 }
 int linphone_config_has_entry(const LpConfig *lpconfig, const char *section, const char *key) {
 	LpSection *sec;
@@ -1393,6 +1414,97 @@ bool_t linphone_config_is_readonly(const LpConfig *lpconfig) {
 	return lpconfig->filename == NULL || lpconfig->readonly;
 }
 
+#define LP_ENTRY_PARSED_INT (1 << 0)
+#define LP_ENTRY_PARSED_BOOL (1 << 1)
+#define LP_ENTRY_PARSED_INT64 (1 << 2)
+#define LP_ENTRY_PARSED_FLOAT (1 << 3)
+
+struct _LinphoneConfigEntry {
+	LpConfig *lpconfig;
+	char *section;
+	char *key;
+	unsigned int revision; /* revision of the config when the value was looked up */
+	const char *value;     /* NULL if the entry is not set */
+	int parsed;            /* LP_ENTRY_PARSED_* flags of the typed values already computed */
+	int int_value;
+	bool_t bool_value;
+	int64_t int64_value;
+	float float_value;
+	bool_t float_valid;
+	bool_t resolved;
+};
+
+LinphoneConfigEntry *linphone_config_entry_new(LpConfig *lpconfig, const char *section, const char *key) {
+	LinphoneConfigEntry *entry = lp_new0(LinphoneConfigEntry, 1);
+	entry->lpconfig = linphone_config_ref(lpconfig);
+	entry->section = ortp_strdup(section);
+	entry->key = ortp_strdup(key);
+	return entry;
+}
+
+void linphone_config_entry_free(LinphoneConfigEntry *entry) {
+	linphone_config_unref(entry->lpconfig);
+	ortp_free(entry->section);
+	ortp_free(entry->key);
+	free(entry);
+}
+
+static const char *linphone_config_entry_lookup(LinphoneConfigEntry *entry) {
+	if (!entry->resolved || entry->revision != entry->lpconfig->revision) {
+		entry->value = linphone_config_get_string(entry->lpconfig, entry->section, entry->key, NULL);
+		entry->revision = entry->lpconfig->revision;
+		entry->parsed = 0;
+		entry->resolved = TRUE;
+	}
+	return entry->value;
+}
+
+const char *linphone_config_entry_get_string(LinphoneConfigEntry *entry, const char *default_string) {
+	const char *str = linphone_config_entry_lookup(entry);
+	return str != NULL ? str : default_string;
+}
+
+int linphone_config_entry_get_int(LinphoneConfigEntry *entry, int default_value) {
+	const char *str = linphone_config_entry_lookup(entry);
+	if (str == NULL) return default_value;
+	if (!(entry->parsed & LP_ENTRY_PARSED_INT)) {
+		entry->int_value = lp_parse_int(str);
+		entry->parsed |= LP_ENTRY_PARSED_INT;
+	}
+	return entry->int_value;
+}
+
+bool_t linphone_config_entry_get_bool(LinphoneConfigEntry *entry, bool_t default_value) {
+	const char *str = linphone_config_entry_lookup(entry);
+	if (str == NULL) return default_value;
+	if (!(entry->parsed & LP_ENTRY_PARSED_BOOL)) {
+		entry->bool_value = lp_parse_bool(str);
+		entry->parsed |= LP_ENTRY_PARSED_BOOL;
+	}
+	return entry->bool_value;
+}
+
+int64_t linphone_config_entry_get_int64(LinphoneConfigEntry *entry, int64_t default_value) {
+	const char *str = linphone_config_entry_lookup(entry);
+	if (str == NULL) return default_value;
+	if (!(entry->parsed & LP_ENTRY_PARSED_INT64)) {
+		entry->int64_value = lp_parse_int64(str);
+		entry->parsed |= LP_ENTRY_PARSED_INT64;
+	}
+	return entry->int64_value;
+}
+
+float linphone_config_entry_get_float(LinphoneConfigEntry *entry, float default_value) {
+	const char *str = linphone_config_entry_lookup(entry);
+	if (str == NULL) return default_value;
+	if (!(entry->parsed & LP_ENTRY_PARSED_FLOAT)) {
+		/* the default value is returned when the value is not a float, it can't be cached */
+		entry->float_valid = sscanf(str, "%f", &entry->float_value) == 1;
+		entry->parsed |= LP_ENTRY_PARSED_FLOAT;
+	}
+	return entry->float_valid ? entry->float_value : default_value;
+}
+
 BELLE_SIP_INSTANCIATE_VPTR(LinphoneConfig,
                            belle_sip_object_t,
                            _linphone_config_uninit, // uninit
@@ -675,6 +675,62 @@ linphone_config_load_dict_to_section(LinphoneConfig *config, const char *section
  */
 LINPHONE_PUBLIC bool_t linphone_config_is_readonly(const LpConfig *config);
 
+/**
+ * A handle on a configuration item, for the items read very often.
+ * It remembers the value of the item and its conversions until the #LinphoneConfig is modified, so reading it again
+ * costs neither a lookup nor a parsing.
+ * @donotwrap
+ */
+typedef struct _LinphoneConfigEntry LinphoneConfigEntry;
+
+/**
+ * Creates a handle on a configuration item. It holds a reference on the #LinphoneConfig.
+ * @param config The #LinphoneConfig object @notnil
+ * @param section The section of the item @notnil
+ * @param key The name of the item @notnil
+ * @return a #LinphoneConfigEntry to be freed with linphone_config_entry_free() @notnil
+ * @donotwrap
+ */
+LINPHONE_PUBLIC LinphoneConfigEntry *
+linphone_config_entry_new(LinphoneConfig *config, const char *section, const char *key);
+
+/**
+ * Frees a handle created by linphone_config_entry_new().
+ * @donotwrap
+ */
+LINPHONE_PUBLIC void linphone_config_entry_free(LinphoneConfigEntry *entry);
+
+/**
+ * Same as linphone_config_get_string() for the item of the handle.
+ * The returned string is valid until the next modification of the #LinphoneConfig.
+ * @donotwrap
+ */
+LINPHONE_PUBLIC const char *linphone_config_entry_get_string(LinphoneConfigEntry *entry, const char *default_string);
+
+/**
+ * Same as linphone_config_get_int() for the item of the handle.
+ * @donotwrap
+ */
+LINPHONE_PUBLIC int linphone_config_entry_get_int(LinphoneConfigEntry *entry, int default_value);
+
+/**
+ * Same as linphone_config_get_bool() for the item of the handle.
+ * @donotwrap
+ */
+LINPHONE_PUBLIC bool_t linphone_config_entry_get_bool(LinphoneConfigEntry *entry, bool_t default_value);
+
+/**
+ * Same as linphone_config_get_int64() for the item of the handle.
+ * @donotwrap
+ */
+LINPHONE_PUBLIC int64_t linphone_config_entry_get_int64(LinphoneConfigEntry *entry, int64_t default_value);
+
+/**
+ * Same as linphone_config_get_float() for the item of the handle.
+ * @donotwrap
+ */
+LINPHONE_PUBLIC float linphone_config_entry_get_float(LinphoneConfigEntry *entry, float default_value);
+
 /************ */
 /* DEPRECATED */
 /* ********** */
@@ -195,10 +195,6 @@ bool Call::initiateOutgoing(const string &subject, const std::shared_ptr<const C
 	return defer;
 }
 
-void Call::iterate(time_t currentRealTime, bool oneSecondElapsed) {
-	getActiveSession()->iterate(currentRealTime, oneSecondElapsed);
-}
-
 void Call::notifyRinging() {
 	if (getState() == CallSession::State::IncomingReceived) {
 		getActiveSession()->getPrivate()->handleIncoming(true);
@@ -860,6 +856,7 @@ void Call::configure(LinphoneCallDir direction, const string &callid) {
 	mParticipant = Participant::create();
 	mParticipant->createSession(getCore(), nullptr, TRUE);
 	mParticipant->getSession()->configure(direction, callid);
+	mParticipant->getSession()->getPrivate()->enableSupervision(true);
 }
 
 void Call::configure(LinphoneCallDir direction,
@@ -877,6 +874,7 @@ void Call::configure(LinphoneCallDir direction,
 
 	mParticipant->configure(nullptr, (direction == LinphoneCallIncoming) ? to : from);
 	mParticipant->getSession()->configure(direction, account, op, from, to);
+	mParticipant->getSession()->getPrivate()->enableSupervision(true);
 }
 
 bool Call::isOpConfigured() const {
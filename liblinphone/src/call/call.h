@@ -217,7 +217,6 @@ public:
 	void createPlayer();
 	void initiateIncoming();
 	bool initiateOutgoing(const std::string &subject = "", const std::shared_ptr<const Content> content = nullptr);
-	void iterate(time_t currentRealTime, bool oneSecondElapsed);
 	void notifyRinging();
 	void startIncomingNotification();
 	void startPushIncomingNotification();
@@ -47,6 +47,8 @@ public:
 	void setPingTime(int value) {
 		pingTime = value;
 	}
+	void enableSupervision(bool value);
+	void updateSupervisionTimer();
 
 	void createOp();
 	CallSessionParams *getCurrentParams() const {
@@ -160,6 +162,12 @@ protected:
 	bool pingReplied = false;
 	int pingTime = 0;
 
+	// Checks the timeouts of the session: delayed start, ringing, push notification and in call timeouts.
+	// Only the sessions of a Call are supervised, not the ones of chat rooms and conference focuses.
+	bool supervisionEnabled = false;
+	belle_sip_source_t *supervisionTimer = nullptr;
+	unsigned int supervisionInterval = 0;
+
 	std::shared_ptr<CallSession> referer;
 	std::shared_ptr<CallSession> transferTarget;
 
@@ -179,6 +187,8 @@ private:
 	void createOpTo(const std::shared_ptr<Address> &to);
 	void executePendingActions();
 	void refreshContactAddress();
+	unsigned int computeSupervisionInterval() const;
+	void supervise();
 
 	std::shared_ptr<Address> getFixedContact() const;
 
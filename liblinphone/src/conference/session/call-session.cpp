@@ -195,6 +195,7 @@ void CallSessionPrivate::setState(CallSession::State newState, const string &mes
 			default:
 				break;
 		}
+		updateSupervisionTimer();
 
 		if (message.empty()) {
 			lError() << "You must fill a reason when changing call state (from " << Utils::toString(prevState) << " to "
@@ -1228,6 +1229,86 @@ void CallSessionPrivate::repairByNewInvite(bool withReplaces) {
 	if (!defer) q->startInvite(nullptr, subject, contentToRestore);
 }
 
+/*
+ * Returns the period of the supervision timer in the current state, 0 if nothing has to be checked.
+ * The ringing and push timeouts are checked every second, the in call timeout only when it is expected to expire.
+ */
+unsigned int CallSessionPrivate::computeSupervisionInterval() const {
+	L_Q();
+	if (!supervisionEnabled) return 0;
+	if ((state == CallSession::State::End) || (state == CallSession::State::Error) ||
+	    (state == CallSession::State::Released))
+		return 0;
+	if ((state == CallSession::State::OutgoingInit) || (state == CallSession::State::IncomingReceived) ||
+	    (state == CallSession::State::IncomingEarlyMedia) || ((direction == LinphoneCallIncoming) && !op))
+		return 1000;
+
+	const auto callTimeout = q->getCore()->getCCore()->sip_conf.in_call_timeout;
+	const auto &connectedTime = log->getConnectedTime();
+	if ((callTimeout > 0) && (connectedTime != 0)) {
+		time_t remaining = connectedTime + callTimeout + 1 - ms_time(nullptr);
+		return (unsigned int)MAX(remaining, 1) * 1000;
+	}
+	return 0;
+}
+
+void CallSessionPrivate::enableSupervision(bool value) {
+	supervisionEnabled = value;
+	updateSupervisionTimer();
+}
+
+void CallSessionPrivate::updateSupervisionTimer() {
+	L_Q();
+	unsigned int interval = computeSupervisionInterval();
+	if (supervisionTimer && (interval == supervisionInterval)) return;
+
+	if (supervisionTimer) {
+		// Destroying the timer from its own callback is fine, the main loop holds a ref on it while it is notified.
+		q->getCore()->destroyTimer(supervisionTimer);
+		supervisionTimer = nullptr;
+	}
+	supervisionInterval = interval;
+	if (interval == 0) return;
+	supervisionTimer = q->getCore()->createTimer(
+	    [this]() -> bool {
+		    L_Q();
+		    shared_ptr<CallSession> ref = q->getSharedFromThis();
+		    supervise();
+		    updateSupervisionTimer();
+		    return true;
+	    },
+	    interval, "Call session supervision");
+}
+
+void CallSessionPrivate::supervise() {
+	L_Q();
+	time_t currentRealTime = ms_time(nullptr);
+	int elapsed = (int)(currentRealTime - log->getStartTime());
+	if ((state == CallSession::State::OutgoingInit) &&
+	    (elapsed > q->getCore()->getCCore()->sip_conf.delayed_timeout) && (pingOp != nullptr)) {
+		/* Start the call even if the OPTIONS reply did not arrive */
+		q->startInvite(nullptr, "");
+	}
+	if ((state == CallSession::State::IncomingReceived) || (state == CallSession::State::IncomingEarlyMedia)) {
+		q->notifyIncomingCallSessionTimeoutCheck(elapsed, true);
+	}
+
+	if (direction == LinphoneCallIncoming && !op) {
+		q->notifyPushCallSessionTimeoutCheck(elapsed);
+	}
+
+	const auto callTimeout = q->getCore()->getCCore()->sip_conf.in_call_timeout;
+	const auto &connectedTime = log->getConnectedTime();
+	if ((callTimeout > 0) && (connectedTime != 0) && ((currentRealTime - connectedTime) > callTimeout) &&
+	    (state != CallSession::State::End) && (state != CallSession::State::Error) &&
+	    (state != CallSession::State::Released)) {
+		lInfo() << "Terminating call session " << q << " (local address " << *q->getLocalAddress()
+		        << " remote address " << (q->getRemoteAddress() ? q->getRemoteAddress()->toString() : "sip:")
+		        << ") because the call timeout (" << callTimeout << "s) has been reached";
+		q->terminate();
+	}
+}
+
 void CallSessionPrivate::refreshContactAddress() {
 	L_Q();
 	if (!op) return;
@@ -1373,6 +1454,7 @@ CallSession::~CallSession() {
 	L_D();
 	try { // getCore may no longuer be available when deleting, specially in case of managed enviroment like java
 		getCore()->getPrivate()->unregisterListener(d);
+		if (d->supervisionTimer) getCore()->destroyTimer(d->supervisionTimer);
 	} catch (const bad_weak_ptr &) {
 	}
 	if (d->currentParams) delete d->currentParams;
@@ -1692,32 +1774,6 @@ bool CallSession::initiateOutgoing(BCTBX_UNUSED(const string &subject),
 	return defer;
 }
 
-void CallSession::iterate(time_t currentRealTime, bool oneSecondElapsed) {
-	L_D();
-	int elapsed = (int)(currentRealTime - d->log->getStartTime());
-	if ((d->state == CallSession::State::OutgoingInit) && (elapsed > getCore()->getCCore()->sip_conf.delayed_timeout) &&
-	    (d->pingOp != nullptr)) {
-		/* Start the call even if the OPTIONS reply did not arrive */
-		startInvite(nullptr, "");
-	}
-	if ((d->state == CallSession::State::IncomingReceived) || (d->state == CallSession::State::IncomingEarlyMedia)) {
-		notifyIncomingCallSessionTimeoutCheck(elapsed, oneSecondElapsed);
-	}
-
-	if (d->direction == LinphoneCallIncoming && !isOpConfigured()) {
-		notifyPushCallSessionTimeoutCheck(elapsed);
-	}
-
-	const auto callTimeout = getCore()->getCCore()->sip_conf.in_call_timeout;
-	const auto &connectedTime = d->log->getConnectedTime();
-	if ((callTimeout > 0) && (connectedTime != 0) && ((currentRealTime - connectedTime) > callTimeout)) {
-		lInfo() << "Terminating call session " << this << " (local address " << *getLocalAddress() << " remote address "
-		        << (getRemoteAddress() ? getRemoteAddress()->toString() : "sip:") << ") because the call timeout ("
-		        << callTimeout << "s) has been reached";
-		terminate();
-	}
-}
-
 LinphoneStatus CallSession::redirect(const string &redirectUri) {
 	auto address = getCore()->interpretUrl(redirectUri, true);
 	if (!address || !address->isValid()) {
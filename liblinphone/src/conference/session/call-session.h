@@ -132,7 +132,6 @@ public:
 	virtual void initiateIncoming();
 	virtual bool initiateOutgoing(const std::string &subject = "",
 	                              const std::shared_ptr<const Content> content = nullptr);
-	virtual void iterate(time_t currentRealTime, bool oneSecondElapsed);
 	LinphoneStatus redirect(const std::string &redirectUri);
 	LinphoneStatus redirect(const Address &redirectAddr);
 	virtual void startIncomingNotification(bool notifyRinging = true);
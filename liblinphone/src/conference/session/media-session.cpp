@@ -4785,10 +4785,6 @@ bool MediaSession::initiateOutgoing(const string &subject, const std::shared_ptr
 	return defer;
 }
 
-void MediaSession::iterate(time_t currentRealTime, bool oneSecondElapsed) {
-	CallSession::iterate(currentRealTime, oneSecondElapsed);
-}
-
 LinphoneStatus MediaSession::pauseFromConference(const MediaSessionParams *msp) {
 	L_D();
 	int ret = 0;
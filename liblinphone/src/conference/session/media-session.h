@@ -79,7 +79,6 @@ public:
 	void initiateIncoming() override;
 	bool initiateOutgoing(const std::string &subject = "",
 	                      const std::shared_ptr<const Content> content = nullptr) override;
-	void iterate(time_t currentRealTime, bool oneSecondElapsed) override;
 	LinphoneStatus pauseFromConference(const MediaSessionParams *msp);
 	LinphoneStatus pause();
 	LinphoneStatus resume();
@@ -109,14 +109,6 @@ bool CorePrivate::isAlreadyInCallWithAddress(const std::shared_ptr<Address> &add
 	return false;
 }
 
-void CorePrivate::iterateCalls(time_t currentRealTime, bool oneSecondElapsed) const {
-	// Make a copy of the list af calls because it may be altered during calls to the Call::iterate method
-	list<shared_ptr<Call>> savedCalls(calls);
-	for (const auto &call : savedCalls) {
-		call->iterate(currentRealTime, oneSecondElapsed);
-	}
-}
-
 void CorePrivate::notifySoundcardUsage(bool used) {
 	L_Q();
 
@@ -147,6 +139,12 @@ void CorePrivate::notifySoundcardUsage(bool used) {
 	}
 }
 
+void CorePrivate::updateCallsSupervision() const {
+	for (const auto &call : calls) {
+		call->getActiveSession()->getPrivate()->updateSupervisionTimer();
+	}
+}
+
 int CorePrivate::removeCall(const shared_ptr<Call> &call) {
 	L_ASSERT(call);
 	auto iter = find(calls.begin(), calls.end(), call);
@@ -35,6 +35,7 @@
 #include "friend/friend-list.h"
 #include "object/object-p.h"
 #include "sal/call-op.h"
+#include "search/magic-search-index.h"
 #include "utils/background-task.h"
 
 // =============================================================================
@@ -91,8 +92,8 @@ public:
 	}
 	bool inviteReplacesABrokenCall(SalCallOp *op);
 	bool isAlreadyInCallWithAddress(const std::shared_ptr<Address> &addr) const;
-	void iterateCalls(time_t currentRealTime, bool oneSecondElapsed) const;
 	void notifySoundcardUsage(bool used);
+	void updateCallsSupervision() const;
 	int removeCall(const std::shared_ptr<Call> &call);
 	void removeReleasingCall(const std::shared_ptr<Call> &call);
 	void setCurrentCall(const std::shared_ptr<Call> &call);
@@ -243,6 +244,7 @@ private:
 	std::unique_ptr<HttpClient> httpClient;
 
 	std::list<std::shared_ptr<FriendList>> friendLists;
+	MagicSearchIndex magicSearchIndex;
 
 	L_DECLARE_PUBLIC(Core);
 };
@@ -197,6 +197,16 @@ void CorePrivate::init() {
 			if (duration >= 1000) {
 				lWarning() << "Opening database took " << duration << " ms !";
 			}
+			// Group event insertions and updates in transactions committed periodically, see
+			// MainDb::enableWriteBehind().
+			int writeBehindDelay =
+			    linphone_config_get_int(linphone_core_get_config(lc), "storage", "write_behind_delay_ms", 0);
+			if (writeBehindDelay > 0) {
+				int writeBehindMaxOperations = linphone_config_get_int(linphone_core_get_config(lc), "storage",
+				                                                       "write_behind_max_operations", 500);
+				mainDb->enableWriteBehind((unsigned int)writeBehindDelay,
+				                          (unsigned int)std::max(writeBehindMaxOperations, 0));
+			}
 
 			loadChatRooms();
 			linphone_core_friends_storage_resync_friends_lists(lc); // Load friends from mainDB if any
@@ -540,6 +550,7 @@ void CorePrivate::uninit() {
 
 void CorePrivate::disconnectMainDb() {
 	if (mainDb != nullptr) {
+		mainDb->enableWriteBehind(0, 0);
 		mainDb->disconnect();
 	}
 }
@@ -3168,18 +3179,21 @@ void Core::addFriendList(const shared_ptr<FriendList> &list) {
 	L_D();
 
 	d->friendLists.push_back(list);
+	d->magicSearchIndex.addFriendList(list);
 }
 
 void Core::removeFriendList(const shared_ptr<FriendList> &list) {
 	L_D();
 
 	d->friendLists.remove(list);
+	d->magicSearchIndex.removeFriendList(list.get());
 }
 
 void Core::clearFriendLists() {
 	L_D();
 
 	d->friendLists.clear();
+	d->magicSearchIndex.invalidate();
 }
 
 const list<shared_ptr<FriendList>> &Core::getFriendLists() const {
@@ -3188,6 +3202,12 @@ const list<shared_ptr<FriendList>> &Core::getFriendLists() const {
 	return d->friendLists;
 }
 
+MagicSearchIndex &Core::getMagicSearchIndex() {
+	L_D();
+
+	return d->magicSearchIndex;
+}
+
 bool Core::isEktPluginLoaded() const {
 	return mEktPluginLoaded;
 }
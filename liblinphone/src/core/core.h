@@ -75,6 +75,7 @@ class ChatMessage;
 class ChatMessageReaction;
 class ChatRoom;
 class Ldap;
+class MagicSearchIndex;
 class PushNotificationMessage;
 class SalMediaDescription;
 class ConferenceScheduler;
@@ -468,6 +469,7 @@ public:
 	void removeFriendList(const std::shared_ptr<FriendList> &list);
 	void clearFriendLists();
 	const std::list<std::shared_ptr<FriendList>> &getFriendLists() const;
+	MagicSearchIndex &getMagicSearchIndex();
 
 	// ---------------------------------------------------------------------------
 	// EKT plugin
@@ -35,18 +35,25 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
+// When nested, the transaction is a savepoint of the write-behind transaction of MainDb: committing it only
+// releases the savepoint, and a rollback does not discard the other pending operations.
 class SmartTransaction {
 public:
-	SmartTransaction(soci::session *session, const char *name) : mSession(session), mName(name), mIsCommitted(false) {
-		lDebug() << "Start transaction " << this << " in MainDb::" << mName << ".";
-		mSession->begin();
+	SmartTransaction(soci::session *session, const char *name, bool nested = false)
+	    : mSession(session), mName(name), mIsCommitted(false), mIsNested(nested) {
+		lDebug() << "Start transaction " << this << " in MainDb::" << mName << (mIsNested ? " (nested)." : ".");
+		if (mIsNested) *mSession << "SAVEPOINT " << sSavepointName;
+		else mSession->begin();
 	}
 
 	~SmartTransaction() {
 		if (!mIsCommitted) {
 			lDebug() << "Rollback transaction " << this << " in MainDb::" << mName << ".";
 			try {
-				mSession->rollback();
+				if (mIsNested) {
+					*mSession << "ROLLBACK TO SAVEPOINT " << sSavepointName;
+					*mSession << "RELEASE SAVEPOINT " << sSavepointName;
+				} else mSession->rollback();
 			} catch (std::runtime_error &e) {
 				lError() << "Error during rollback transaction " << this << " in MainDb::" << mName
 				         << ". Error : " << e.what();
@@ -62,13 +69,17 @@ public:
 
 		lDebug() << "Commit transaction " << this << " in MainDb::" << mName << ".";
 		mIsCommitted = true;
-		mSession->commit();
+		if (mIsNested) *mSession << "RELEASE SAVEPOINT " << sSavepointName;
+		else mSession->commit();
 	}
 
 private:
+	static constexpr const char *sSavepointName = "write_behind_operation";
+
 	soci::session *mSession;
 	const char *mName;
 	bool mIsCommitted;
+	bool mIsNested;
 
 	L_DISABLE_COPY(SmartTransaction);
 };
@@ -96,16 +107,19 @@ public:
 	DbTransaction(DbTransactionInfo &info, Function &&function) : mFunction(std::move(function)) {
 		MainDb *mainDb = info.mainDb;
 		const char *name = info.name;
-		soci::session *session = mainDb->getPrivate()->dbSession.getBackendSession();
+		MainDbPrivate *d = mainDb->getPrivate();
+		soci::session *session = d->dbSession.getBackendSession();
 
 		try {
-			SmartTransaction tr(session, name);
+			SmartTransaction tr(session, name, d->writeBehindBatchOpened);
 			mResult = exec<InternalReturnType>(tr);
 		} catch (const soci::soci_error &e) {
 			lWarning() << "Caught exception in MainDb::" << name << "(" << e.what() << ").";
 			soci::soci_error::error_category category = e.get_error_category();
 			if ((category == soci::soci_error::connection_error || category == soci::soci_error::unknown) &&
 			    mainDb->forceReconnect()) {
+				// The reconnection rolled back the write-behind transaction.
+				if (d->writeBehindBatchOpened) d->invalidateWriteBehindBatch();
 				try {
 					SmartTransaction tr(session, name);
 					mResult = exec<InternalReturnType>(tr);
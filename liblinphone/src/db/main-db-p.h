@@ -22,6 +22,9 @@
 #define _L_MAIN_DB_P_H_
 
 #include <unordered_map>
+#include <vector>
+
+#include <belle-sip/mainloop.h>
 
 #include "linphone/utils/utils.h"
 
@@ -45,6 +48,13 @@ public:
 	mutable std::unordered_map<long long, std::weak_ptr<CallLog>> storageIdToCallLog;
 	mutable std::unordered_map<long long, std::weak_ptr<ConferenceInfo>> storageIdToConferenceInfo;
 
+	// True while the write-behind transaction is open, transactions are then nested in it as savepoints.
+	bool writeBehindBatchOpened = false;
+
+	// Called when the write-behind transaction is lost (failed commit, reconnection): the caches are cleaned from
+	// the storage ids of the rows it inserted.
+	void invalidateWriteBehindBatch();
+
 private:
 	// ---------------------------------------------------------------------------
 	// Misc helpers.
@@ -249,6 +259,26 @@ private:
 
 	void invalidConferenceEventsFromQuery(const std::string &query, long long chatRoomId) const;
 
+	// ---------------------------------------------------------------------------
+	// Write-behind API.
+	// ---------------------------------------------------------------------------
+
+	void beginWriteBehindOperation();
+	void endWriteBehindOperation();
+	bool commitWriteBehindBatch();
+	void stopWriteBehindTimer();
+
+	unsigned int writeBehindDelayMs = 0;
+	unsigned int writeBehindMaxOperations = 0;
+	unsigned int writeBehindOperationCount = 0;
+	belle_sip_source_t *writeBehindTimer = nullptr;
+
+	// Storage ids cached while the write-behind transaction is open.
+	mutable std::vector<long long> writeBehindEventIds;
+	mutable std::vector<long long> writeBehindChatRoomIds;
+	mutable std::vector<long long> writeBehindCallLogIds;
+	mutable std::vector<long long> writeBehindConferenceInfoIds;
+
 	// ---------------------------------------------------------------------------
 	// Versions.
 	// ---------------------------------------------------------------------------
@@ -2589,6 +2589,7 @@ void MainDbPrivate::cache(const shared_ptr<EventLog> &eventLog, long long storag
 	L_ASSERT(!dEventLog->dbKey.isValid());
 	dEventLog->dbKey = MainDbEventKey(q->getCore(), storageId);
 	storageIdToEvent[storageId] = eventLog;
+	if (writeBehindBatchOpened) writeBehindEventIds.push_back(storageId);
 	L_ASSERT(dEventLog->dbKey.isValid());
 #endif
 }
@@ -2599,6 +2600,7 @@ void MainDbPrivate::cache(const shared_ptr<ChatMessage> &chatMessage, long long
 	L_ASSERT(!chatMessage->isValid());
 	dChatMessage->setStorageId(storageId);
 	storageIdToChatMessage[storageId] = chatMessage;
+	if (writeBehindBatchOpened) writeBehindEventIds.push_back(storageId);
 	L_ASSERT(chatMessage->isValid());
 #endif
 }
@@ -2607,18 +2609,21 @@ void MainDbPrivate::cache(const ConferenceId &conferenceId, long long storageId)
 #ifdef HAVE_DB_STORAGE
 	L_ASSERT(conferenceId.isValid());
 	storageIdToConferenceId[storageId] = conferenceId;
+	if (writeBehindBatchOpened) writeBehindChatRoomIds.push_back(storageId);
 #endif
 }
 
 void MainDbPrivate::cache(const std::shared_ptr<CallLog> &callLog, long long storageId) const {
 #ifdef HAVE_DB_STORAGE
 	storageIdToCallLog[storageId] = callLog;
+	if (writeBehindBatchOpened) writeBehindCallLogIds.push_back(storageId);
 #endif
 }
 
 void MainDbPrivate::cache(const std::shared_ptr<ConferenceInfo> &conferenceInfo, long long storageId) const {
 #ifdef HAVE_DB_STORAGE
 	storageIdToConferenceInfo[storageId] = conferenceInfo;
+	if (writeBehindBatchOpened) writeBehindConferenceInfoIds.push_back(storageId);
 #endif
 }
 
@@ -2644,6 +2649,115 @@ void MainDbPrivate::invalidConferenceEventsFromQuery(const string &query, long l
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// Write-behind API.
+// -----------------------------------------------------------------------------
+
+void MainDbPrivate::beginWriteBehindOperation() {
+#ifdef HAVE_DB_STORAGE
+	if (writeBehindDelayMs == 0 || writeBehindBatchOpened) return;
+
+	try {
+		dbSession.getBackendSession()->begin();
+		writeBehindBatchOpened = true;
+		writeBehindOperationCount = 0;
+	} catch (const soci::soci_error &e) {
+		lError() << "Unable to open write-behind transaction: " << e.what();
+	}
+#endif
+}
+
+void MainDbPrivate::endWriteBehindOperation() {
+	if (!writeBehindBatchOpened) return;
+
+	++writeBehindOperationCount;
+	if (writeBehindMaxOperations > 0 && writeBehindOperationCount >= writeBehindMaxOperations)
+		commitWriteBehindBatch();
+}
+
+bool MainDbPrivate::commitWriteBehindBatch() {
+#ifdef HAVE_DB_STORAGE
+	if (!writeBehindBatchOpened) return true;
+
+	lDebug() << "Commit " << writeBehindOperationCount << " write-behind operations.";
+	soci::session *session = dbSession.getBackendSession();
+	try {
+		session->commit();
+	} catch (const soci::soci_error &e) {
+		lError() << "Unable to commit " << writeBehindOperationCount << " write-behind operations: " << e.what();
+		try {
+			session->rollback();
+		} catch (const soci::soci_error &e) {
+			lError() << "Error during rollback of write-behind operations: " << e.what();
+		}
+		invalidateWriteBehindBatch();
+		return false;
+	}
+	writeBehindBatchOpened = false;
+	writeBehindOperationCount = 0;
+	writeBehindEventIds.clear();
+	writeBehindChatRoomIds.clear();
+	writeBehindCallLogIds.clear();
+	writeBehindConferenceInfoIds.clear();
+#endif
+	return true;
+}
+
+void MainDbPrivate::invalidateWriteBehindBatch() {
+#ifdef HAVE_DB_STORAGE
+	lError() << writeBehindOperationCount << " write-behind operations lost, invalidating the rows they inserted.";
+	writeBehindBatchOpened = false;
+	writeBehindOperationCount = 0;
+
+	// The rows read during the batch are cached as well: only the ones that do not exist anymore are invalidated.
+	soci::session *session = dbSession.getBackendSession();
+	auto isLost = [session](const char *table, long long id) {
+		int count = 0;
+		try {
+			*session << "SELECT COUNT(*) FROM " << table << " WHERE id = :id", soci::use(id), soci::into(count);
+		} catch (const soci::soci_error &e) {
+			lError() << "Unable to check " << table << " row " << id << ": " << e.what();
+		}
+		return count == 0;
+	};
+
+	for (long long id : writeBehindEventIds) {
+		if (!isLost("event", id)) continue;
+		shared_ptr<EventLog> eventLog = getEventFromCache(id);
+		if (eventLog) eventLog->getPrivate()->resetStorageId();
+		shared_ptr<ChatMessage> chatMessage = getChatMessageFromCache(id);
+		if (chatMessage) chatMessage->getPrivate()->resetStorageId();
+		storageIdToEvent.erase(id);
+		storageIdToChatMessage.erase(id);
+	}
+	for (long long id : writeBehindChatRoomIds) {
+		if (isLost("chat_room", id)) storageIdToConferenceId.erase(id);
+	}
+	for (long long id : writeBehindCallLogIds) {
+		if (isLost("conference_call", id)) storageIdToCallLog.erase(id);
+	}
+	for (long long id : writeBehindConferenceInfoIds) {
+		if (isLost("conference_info", id)) storageIdToConferenceInfo.erase(id);
+	}
+	// The counts may include messages of the lost operations.
+	unreadChatMessageCountCache.clear();
+
+	writeBehindEventIds.clear();
+	writeBehindChatRoomIds.clear();
+	writeBehindCallLogIds.clear();
+	writeBehindConferenceInfoIds.clear();
+#endif
+}
+
+void MainDbPrivate::stopWriteBehindTimer() {
+	if (!writeBehindTimer) return;
+
+	// Same as Core::destroyTimer(), which cannot be used once the core is destroyed.
+	belle_sip_source_cancel(writeBehindTimer);
+	belle_sip_object_unref(writeBehindTimer);
+	writeBehindTimer = nullptr;
+}
+
 // -----------------------------------------------------------------------------
 // Versions.
 // -----------------------------------------------------------------------------
@@ -3631,6 +3745,12 @@ bool MainDbPrivate::importLegacyCallLogs(DbSession &inDbSession) {
 MainDb::MainDb(const shared_ptr<Core> &core) : AbstractDb(*new MainDbPrivate), CoreAccessor(core) {
 }
 
+MainDb::~MainDb() {
+	L_D();
+	d->stopWriteBehindTimer();
+	d->commitWriteBehindBatch();
+}
+
 void MainDb::init() {
 #ifdef HAVE_DB_STORAGE
 	L_D();
@@ -4483,7 +4603,9 @@ bool MainDb::addEvent(const shared_ptr<EventLog> &eventLog) {
 		return false;
 	}
 
-	return L_DB_TRANSACTION {
+	L_D();
+	d->beginWriteBehindOperation();
+	bool added = L_DB_TRANSACTION {
 		L_D();
 
 		long long eventId = -1;
@@ -4566,6 +4688,8 @@ bool MainDb::addEvent(const shared_ptr<EventLog> &eventLog) {
 		lError() << "MainDb::addEvent() of type " << type << " failed.";
 		return false;
 	};
+	d->endWriteBehindOperation();
+	return added;
 #else
 	return false;
 #endif
@@ -4578,7 +4702,9 @@ bool MainDb::updateEvent(const shared_ptr<EventLog> &eventLog) {
 		return false;
 	}
 
-	return L_DB_TRANSACTION {
+	L_D();
+	d->beginWriteBehindOperation();
+	bool updated = L_DB_TRANSACTION {
 		L_D();
 
 		switch (eventLog->getType()) {
@@ -4624,6 +4750,8 @@ bool MainDb::updateEvent(const shared_ptr<EventLog> &eventLog) {
 
 		return true;
 	};
+	d->endWriteBehindOperation();
+	return updated;
 #else
 	return false;
 #endif
@@ -5117,11 +5245,14 @@ void MainDb::setChatMessageParticipantState(const shared_ptr<EventLog> &eventLog
                                             ChatMessage::State state,
                                             time_t stateChangeTime) {
 #ifdef HAVE_DB_STORAGE
+	L_D();
+	d->beginWriteBehindOperation();
 	L_DB_TRANSACTION {
 		L_D();
 		d->setChatMessageParticipantState(eventLog, participantAddress, state, stateChangeTime);
 		tr.commit();
 	};
+	d->endWriteBehindOperation();
 #endif
 }
 
@@ -8081,6 +8212,31 @@ bool MainDb::import(Backend, const string &parameters) {
 #endif
 }
 
+void MainDb::enableWriteBehind(unsigned int delayMs, unsigned int maxOperations) {
+	L_D();
+
+	d->commitWriteBehindBatch();
+	d->stopWriteBehindTimer();
+	d->writeBehindDelayMs = delayMs;
+	d->writeBehindMaxOperations = maxOperations;
+	if (delayMs == 0) return;
+
+	lInfo() << "MainDb write-behind enabled: commit every " << delayMs << " ms or " << maxOperations
+	        << " operations.";
+	d->writeBehindTimer = getCore()->createTimer(
+	    [this]() {
+		    L_D();
+		    d->commitWriteBehindBatch();
+		    return true;
+	    },
+	    delayMs, "MainDb write-behind");
+}
+
+bool MainDb::flushWriteBehind() {
+	L_D();
+	return d->commitWriteBehindBatch();
+}
+
 MainDb::FilterMask MainDb::getFilterMaskFromHistoryFilterMask(AbstractChatRoom::HistoryFilterMask historyFilterMask) {
 	FilterMask mask;
 
@@ -96,6 +96,7 @@ public:
 	};
 
 	MainDb(const std::shared_ptr<Core> &core);
+	~MainDb();
 
 	// ---------------------------------------------------------------------------
 	// Generic.
@@ -316,6 +317,15 @@ public:
 	// Import legacy calls/messages from old db. Returns true if something was done.
 	bool import(Backend backend, const std::string &parameters) override;
 
+	// Write-behind: event insertions and updates and chat message participant states are grouped into a single
+	// transaction, committed every delayMs milliseconds or every maxOperations operations, instead of one
+	// transaction (and one disk sync) each. Pending operations are visible to the reads of this MainDb but lost
+	// in case of crash. A delayMs of 0 disables it.
+	void enableWriteBehind(unsigned int delayMs, unsigned int maxOperations);
+	// Commits the pending write-behind operations. On failure they are lost: false is returned and the objects they
+	// inserted are not bound to a storage id anymore, as when the timer or maxOperations commit fails.
+	bool flushWriteBehind();
+
 	static FilterMask getFilterMaskFromHistoryFilterMask(AbstractChatRoom::HistoryFilterMask historyFilterMask);
 
 protected:
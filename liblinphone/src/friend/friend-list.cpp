@@ -111,6 +111,8 @@ void FriendList::setSubscriptionBodyless(bool bodyless) {
 }
 
 void FriendList::setType(LinphoneFriendListType type) {
+	// Friends of application cache lists aren't searched.
+	if (mType != type) invalidateSearchIndex();
 	mType = type;
 	saveInDb();
 }
@@ -646,6 +648,7 @@ LinphoneFriendListStatus FriendList::importFriend(const std::shared_ptr<Friend>
 	lf->mFriendList = this;
 	mFriendsList.mList.push_front(lf);
 	lf->addAddressesAndNumbersIntoMaps(getSharedFromThis());
+	lf->updateSearchIndex();
 	if (synchronize) {
 		mDirtyFriendsToUpdate.push_front(lf);
 		mBctbxDirtyFriendsToUpdate = bctbx_list_prepend(mBctbxDirtyFriendsToUpdate, lf->toC());
@@ -677,6 +680,13 @@ void FriendList::invalidateFriendsMaps() {
 		f->addAddressesAndNumbersIntoMaps(getSharedFromThis());
 }
 
+void FriendList::invalidateSearchIndex() {
+	try {
+		getCore()->getMagicSearchIndex().invalidate();
+	} catch (std::bad_weak_ptr &) {
+	}
+}
+
 void FriendList::invalidateSubscriptions() {
 	lInfo() << "Invalidating friend list's [" << toC() << "] subscriptions";
 	// Terminate subscription event
@@ -912,6 +922,10 @@ void FriendList::deleteFriend(const std::shared_ptr<Friend> &lf, bool removeFrom
 		}
 	}
 
+	try {
+		getCore()->getMagicSearchIndex().removeFriend(lf.get());
+	} catch (std::bad_weak_ptr &) {
+	}
 	lf->mFriendList = nullptr;
 }
 
@@ -1028,6 +1042,7 @@ void FriendList::sendListSubscriptionWithoutBody(const std::shared_ptr<Address>
 
 void FriendList::setFriends(const std::list<std::shared_ptr<Friend>> &friends) {
 	mFriendsList.mList = friends;
+	invalidateSearchIndex();
 }
 
 void FriendList::updateSubscriptions() {
@@ -1109,6 +1124,7 @@ void FriendList::carddavUpdated(const std::shared_ptr<Friend> &newFriend, const
 	auto it = std::find_if(mFriendsList.mList.begin(), mFriendsList.mList.end(),
 	                       [&](const auto &elem) { return elem == oldFriend; });
 	if (it != mFriendsList.mList.end()) *it = newFriend;
+	invalidateSearchIndex();
 	newFriend->saveInDb();
 	LINPHONE_HYBRID_OBJECT_INVOKE_CBS(FriendList, this, linphone_friend_list_cbs_get_contact_updated, newFriend->toC(),
 	                                  oldFriend->toC());
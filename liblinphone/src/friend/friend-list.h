@@ -152,6 +152,7 @@ private:
 	LinphoneFriendListStatus importFriend(const std::shared_ptr<Friend> &lf, bool synchronize);
 	LinphoneStatus importFriendsFromVcard4(const std::list<std::shared_ptr<Vcard>> &vcards);
 	void invalidateFriendsMaps();
+	void invalidateSearchIndex();
 	void invalidateSubscriptions();
 	void notifyPresenceReceived(const std::shared_ptr<const Content> &content);
 	void parseMultipartRelatedBody(const std::shared_ptr<const Content> &content, const std::string &firstPartBody);
@@ -118,6 +118,7 @@ LinphoneStatus Friend::setAddress(const std::shared_ptr<const Address> &address)
 	} else {
 		mUri = newAddress;
 	}
+	updateSearchIndex();
 
 	return 0;
 }
@@ -151,6 +152,7 @@ LinphoneStatus Friend::setName(const std::string &name) {
 		}
 		mUri->setDisplayName(name);
 	}
+	updateSearchIndex();
 	return 0;
 }
 
@@ -163,6 +165,7 @@ void Friend::setOrganization(const std::string &organization) {
 	if (isReadOnly()) return;
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->setOrganization(organization);
+		updateSearchIndex();
 	}
 }
 
@@ -212,6 +215,7 @@ void Friend::setVcard(const std::shared_ptr<Vcard> &vcard) {
 	mVcard = vcard;
 	mRefKey = vcard->getUid();
 	if (mFriendList) saveInDb();
+	updateSearchIndex();
 }
 
 // -----------------------------------------------------------------------------
@@ -560,6 +564,7 @@ void Friend::addAddress(const std::shared_ptr<const Address> &address) {
 	} else if (!mUri) {
 		mUri = newAddr;
 	}
+	updateSearchIndex();
 }
 
 void Friend::addPhoneNumber(const std::string &phoneNumber) {
@@ -582,6 +587,7 @@ void Friend::addPhoneNumber(const std::string &phoneNumber) {
 		if (!mVcard) createVcard(phoneNumber);
 		if (mVcard) mVcard->addPhoneNumber(phoneNumber);
 	}
+	updateSearchIndex();
 }
 
 void Friend::addPhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumber> &phoneNumber) {
@@ -605,6 +611,7 @@ void Friend::addPhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumb
 		if (!mVcard) createVcard(phone);
 		if (mVcard) mVcard->addPhoneNumberWithLabel(phoneNumber);
 	}
+	updateSearchIndex();
 }
 
 bool Friend::createVcard(const std::string &name) {
@@ -648,6 +655,7 @@ void Friend::done() {
 	}
 	apply();
 	if (mFriendList) saveInDb();
+	updateSearchIndex();
 }
 
 void Friend::edit() {
@@ -766,6 +774,7 @@ void Friend::removeAddress(const std::shared_ptr<const Address> &address) {
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removeSipAddress(uri);
 	}
+	updateSearchIndex();
 }
 
 void Friend::removePhoneNumber(const std::string &phoneNumber) {
@@ -776,6 +785,7 @@ void Friend::removePhoneNumber(const std::string &phoneNumber) {
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removePhoneNumber(phoneNumber);
 	}
+	updateSearchIndex();
 }
 
 void Friend::removePhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneNumber> &phoneNumber) {
@@ -789,6 +799,7 @@ void Friend::removePhoneNumberWithLabel(const std::shared_ptr<const FriendPhoneN
 	if (linphone_core_vcard_supported() && mVcard) {
 		mVcard->removePhoneNumberWithLabel(phoneNumber);
 	}
+	updateSearchIndex();
 }
 
 bool Friend::subscribesEnabled() const {
@@ -838,6 +849,7 @@ void Friend::addPresenceModelForUriOrTel(const std::string &uriOrTel, const std:
 	} else {
 		it->second = model;
 	}
+	updateSearchIndex();
 }
 
 void Friend::apply() {
@@ -1116,6 +1128,14 @@ void Friend::unsubscribe() {
 	mSubscribeActive = false;
 }
 
+void Friend::updateSearchIndex() {
+	if (!mFriendList) return;
+	try {
+		getCore()->getMagicSearchIndex().updateFriend(getSharedFromThis());
+	} catch (std::bad_weak_ptr &) {
+	}
+}
+
 /**
  * Updates the p2p subscriptions.
  * If onlyWhenRegistered is true, subscribe will be sent only if the friend's corresponding proxy config is in
@@ -184,6 +184,7 @@ private:
 	void saveInDb();
 	const std::string &sipUriToPhoneNumber(const std::string &uri) const;
 	void unsubscribe();
+	void updateSearchIndex();
 	void updateSubscribes(bool onlyWhenRegistered);
 
 	static std::string capabilityToName(const LinphoneFriendCapability capability);
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <bctoolbox/defs.h>
+
+#include "account/account.h"
+#include "address/address.h"
+#include "friend/friend-list.h"
+#include "friend/friend.h"
+#include "linphone/api/c-account.h"
+#include "logger/logger.h"
+#include "magic-search-index.h"
+#include "presence/presence-model.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Below this number of dead documents, compacting the index isn't worth it.
+static constexpr size_t minDeadDocumentsToCompact = 1024;
+
+static string toLowercase(const string &str) {
+	string lowercase = str;
+	transform(lowercase.begin(), lowercase.end(), lowercase.begin(), [](unsigned char c) { return tolower(c); });
+	return lowercase;
+}
+
+static uint32_t toTrigram(const string &str, size_t pos) {
+	return ((uint32_t)(unsigned char)str[pos] << 16) | ((uint32_t)(unsigned char)str[pos + 1] << 8) |
+	       (uint32_t)(unsigned char)str[pos + 2];
+}
+
+static bool isWordCharacter(unsigned char c) {
+	// Bytes of multi-byte UTF-8 sequences are kept in words.
+	return isalnum(c) || c >= 0x80;
+}
+
+static vector<string> splitWords(const string &term) {
+	vector<string> words;
+	size_t start = string::npos;
+	for (size_t i = 0; i <= term.size(); i++) {
+		if (i < term.size() && isWordCharacter((unsigned char)term[i])) {
+			if (start == string::npos) start = i;
+		} else if (start != string::npos) {
+			words.push_back(term.substr(start, i - start));
+			start = string::npos;
+		}
+	}
+	return words;
+}
+
+// -----------------------------------------------------------------------------
+
+vector<string> MagicSearchIndex::splitFilter(const string &filter) {
+	vector<string> parts;
+	const string lowercaseFilter = toLowercase(filter);
+	size_t start = 0;
+	while (start < lowercaseFilter.size()) {
+		size_t end = lowercaseFilter.find(' ', start);
+		if (end == string::npos) end = lowercaseFilter.size();
+		if (end > start) parts.push_back(lowercaseFilter.substr(start, end - start));
+		start = end + 1;
+	}
+	return parts;
+}
+
+bool MagicSearchIndex::matches(const string &lowercaseHaystack, const vector<string> &parts) {
+	size_t pos = 0;
+	for (const auto &part : parts) {
+		pos = lowercaseHaystack.find(part, pos);
+		if (pos == string::npos) return false;
+		pos += part.size();
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void MagicSearchIndex::update(const list<shared_ptr<FriendList>> &friendLists, const shared_ptr<Account> &account) {
+	// Phone numbers are indexed as they are normalized by the default account, the index must follow its settings.
+	string normalizationKey;
+	if (account) {
+		const auto &params = account->getAccountParams();
+		normalizationKey = params->getInternationalPrefix() + (params->getDialEscapePlusEnabled() ? "|+" : "|");
+	}
+	mAccount = account;
+	if (mBuilt && normalizationKey == mNormalizationKey) return;
+
+	invalidate();
+	mNormalizationKey = normalizationKey;
+	mBuilt = true;
+	for (const auto &friendList : friendLists) {
+		addFriendList(friendList);
+	}
+	lInfo() << "[Magic Search] Indexed [" << size() << "] friends";
+}
+
+void MagicSearchIndex::invalidate() {
+	mBuilt = false;
+	mNormalizationKey.clear();
+	mFriendLists.clear();
+	mDocuments.clear();
+	mDocumentIds.clear();
+	mTrigrams.clear();
+	mWords.clear();
+	mDeadCount = 0;
+}
+
+bool MagicSearchIndex::isBuilt() const {
+	return mBuilt;
+}
+
+size_t MagicSearchIndex::size() const {
+	return mDocumentIds.size();
+}
+
+void MagicSearchIndex::addFriendList(const shared_ptr<FriendList> &friendList) {
+	if (!mBuilt || !friendList) return;
+	if (friendList->getType() == LinphoneFriendListTypeApplicationCache) {
+		lInfo() << "[Magic Search] Not indexing friend list [" << friendList->getDisplayName()
+		        << "] because it's type is set to Application Cache";
+		return;
+	}
+	mFriendLists.insert(friendList.get());
+	for (const auto &lFriend : friendList->getFriends()) {
+		updateFriend(lFriend);
+	}
+}
+
+void MagicSearchIndex::removeFriendList(const FriendList *friendList) {
+	if (!mBuilt || mFriendLists.erase(friendList) == 0) return;
+	for (uint32_t id = 0; id < mDocuments.size(); id++) {
+		const auto &document = mDocuments[id];
+		if (!document.mAlive) continue;
+		auto lFriend = document.mFriend.lock();
+		if (!lFriend || lFriend->getFriendList() == friendList) eraseDocument(id);
+	}
+	compact();
+}
+
+void MagicSearchIndex::updateFriend(const shared_ptr<Friend> &lFriend) {
+	if (!mBuilt || !lFriend) return;
+	if (mFriendLists.find(lFriend->getFriendList()) == mFriendLists.end()) {
+		removeFriend(lFriend.get());
+		return;
+	}
+
+	vector<string> terms = extractTerms(lFriend);
+	auto it = mDocumentIds.find(lFriend.get());
+	if (it != mDocumentIds.end()) {
+		// Presence notifications update friends a lot without changing what is searchable.
+		const auto &document = mDocuments[it->second];
+		if (document.mFriend.lock() == lFriend && document.mTerms == terms) return;
+		eraseDocument(it->second);
+	}
+	insertDocument(lFriend, std::move(terms));
+	compact();
+}
+
+void MagicSearchIndex::removeFriend(const Friend *lFriend) {
+	if (!mBuilt) return;
+	auto it = mDocumentIds.find(lFriend);
+	if (it == mDocumentIds.end()) return;
+	eraseDocument(it->second);
+	compact();
+}
+
+list<shared_ptr<Friend>> MagicSearchIndex::search(const string &filter) const {
+	list<shared_ptr<Friend>> results;
+	const vector<string> parts = splitFilter(filter);
+
+	// All the trigrams of the filter must be found in a friend for it to match. Parts shorter than a trigram can't
+	// narrow the search, they are only checked on the remaining candidates.
+	vector<const vector<uint32_t> *> postings;
+	for (const auto &part : parts) {
+		for (size_t i = 0; i + 3 <= part.size(); i++) {
+			auto it = mTrigrams.find(toTrigram(part, i));
+			if (it == mTrigrams.end()) return results;
+			postings.push_back(&it->second);
+		}
+	}
+
+	vector<uint32_t> candidates;
+	if (postings.empty()) {
+		candidates.reserve(mDocuments.size());
+		for (uint32_t id = 0; id < mDocuments.size(); id++) {
+			candidates.push_back(id);
+		}
+	} else {
+		sort(postings.begin(), postings.end());
+		postings.erase(unique(postings.begin(), postings.end()), postings.end());
+		// Start from the shortest posting lists to keep the intersections small.
+		sort(postings.begin(), postings.end(),
+		     [](const vector<uint32_t> *lhs, const vector<uint32_t> *rhs) { return lhs->size() < rhs->size(); });
+		candidates = *postings.front();
+		vector<uint32_t> intersection;
+		for (size_t i = 1; i < postings.size() && !candidates.empty(); i++) {
+			intersection.clear();
+			set_intersection(candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(),
+			                 back_inserter(intersection));
+			candidates.swap(intersection);
+		}
+	}
+
+	unordered_set<uint32_t> prefixMatches;
+	if (!parts.empty()) {
+		const string &prefix = parts.front();
+		for (auto it = mWords.lower_bound(prefix); it != mWords.end(); ++it) {
+			if (it->first.compare(0, prefix.size(), prefix) != 0) break;
+			prefixMatches.insert(it->second);
+		}
+	}
+
+	list<shared_ptr<Friend>> otherResults;
+	for (uint32_t id : candidates) {
+		const auto &document = mDocuments[id];
+		if (!document.mAlive) continue;
+		bool found = false;
+		for (const auto &term : document.mTerms) {
+			if (matches(term, parts)) {
+				found = true;
+				break;
+			}
+		}
+		if (!found) continue;
+		auto lFriend = document.mFriend.lock();
+		if (!lFriend) continue;
+		if (prefixMatches.find(id) != prefixMatches.end()) results.push_back(lFriend);
+		else otherResults.push_back(lFriend);
+	}
+	results.splice(results.end(), otherResults);
+	return results;
+}
+
+// -----------------------------------------------------------------------------
+
+vector<string> MagicSearchIndex::extractTerms(const shared_ptr<Friend> &lFriend) const {
+	vector<string> terms;
+	terms.push_back(lFriend->getName());
+	terms.push_back(lFriend->getOrganization());
+	for (const auto &address : lFriend->getAddresses()) {
+		// Contains the display name and the username, and the full SIP URI for filters that look like one.
+		terms.push_back(address->asString());
+	}
+	for (const auto &number : lFriend->getPhoneNumbers()) {
+		terms.push_back(number);
+		string phoneNumber = number;
+		if (mAccount) {
+			char *buff = linphone_account_normalize_phone_number(mAccount->toC(), number.c_str());
+			if (buff) {
+				phoneNumber = buff;
+				bctbx_free(buff);
+				terms.push_back(phoneNumber);
+			}
+		}
+		const auto &presenceModel = lFriend->getPresenceModelForUriOrTel(phoneNumber);
+		if (presenceModel) terms.push_back(presenceModel->getContact());
+	}
+
+	for (auto &term : terms) {
+		term = toLowercase(term);
+	}
+	sort(terms.begin(), terms.end());
+	terms.erase(unique(terms.begin(), terms.end()), terms.end());
+	if (!terms.empty() && terms.front().empty()) terms.erase(terms.begin());
+	return terms;
+}
+
+void MagicSearchIndex::insertDocument(const shared_ptr<Friend> &lFriend, vector<string> &&terms) {
+	uint32_t id = (uint32_t)mDocuments.size();
+
+	vector<uint32_t> trigrams;
+	for (const auto &term : terms) {
+		for (size_t i = 0; i + 3 <= term.size(); i++) {
+			trigrams.push_back(toTrigram(term, i));
+		}
+		for (auto &word : splitWords(term)) {
+			mWords.emplace(std::move(word), id);
+		}
+	}
+	sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+	for (uint32_t trigram : trigrams) {
+		mTrigrams[trigram].push_back(id);
+	}
+
+	Document document;
+	document.mFriend = lFriend;
+	document.mKey = lFriend.get();
+	document.mTerms = std::move(terms);
+	document.mAlive = true;
+	mDocuments.push_back(std::move(document));
+	mDocumentIds[lFriend.get()] = id;
+}
+
+void MagicSearchIndex::eraseDocument(uint32_t id) {
+	auto &document = mDocuments[id];
+	if (!document.mAlive) return;
+	mDocumentIds.erase(document.mKey);
+	document.mAlive = false;
+	document.mFriend.reset();
+	mDeadCount++;
+}
+
+void MagicSearchIndex::compact() {
+	if (mDeadCount < minDeadDocumentsToCompact || mDeadCount < mDocumentIds.size()) return;
+
+	lDebug() << "[Magic Search] Compacting index, dropping [" << mDeadCount << "] dead documents";
+	vector<Document> documents;
+	documents.swap(mDocuments);
+	mDocumentIds.clear();
+	mTrigrams.clear();
+	mWords.clear();
+	mDeadCount = 0;
+	for (auto &document : documents) {
+		if (!document.mAlive) continue;
+		auto lFriend = document.mFriend.lock();
+		if (lFriend) insertDocument(lFriend, std::move(document.mTerms));
+	}
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2010-2024 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_MAGIC_SEARCH_INDEX_H_
+#define _L_MAGIC_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Account;
+class Friend;
+class FriendList;
+
+/**
+ * In-memory index of the friends of the core, used by MagicSearch to avoid matching the filter against every friend
+ * on each keystroke.
+ * For each friend, the index keeps the lowercase strings the search looks into (name, organization, SIP addresses,
+ * phone numbers and presence contacts). Those strings are indexed by trigram, to find the friends that may contain a
+ * filter, and split into words kept in an ordered map, to rank first the friends having a word starting with it.
+ * The index is built on first use and then updated incrementally by the Friend and FriendList setters.
+ */
+class MagicSearchIndex {
+public:
+	MagicSearchIndex() = default;
+	MagicSearchIndex(const MagicSearchIndex &) = delete;
+	MagicSearchIndex &operator=(const MagicSearchIndex &) = delete;
+
+	/**
+	 * Splits a filter the way MagicSearch interprets it: lowercase, white spaces separate parts that must be found in
+	 * the same order.
+	 **/
+	static std::vector<std::string> splitFilter(const std::string &filter);
+
+	/**
+	 * @return true if all the parts are found, in that order, in the lowercase haystack
+	 **/
+	static bool matches(const std::string &lowercaseHaystack, const std::vector<std::string> &parts);
+
+	/**
+	 * Builds the index if it isn't yet, or rebuilds it if the account used to normalize phone numbers has changed.
+	 * @param[in] friendLists friend lists of the core
+	 * @param[in] account default account of the core, may be null
+	 **/
+	void update(const std::list<std::shared_ptr<FriendList>> &friendLists, const std::shared_ptr<Account> &account);
+
+	/**
+	 * Drops the index, it will be built again by the next update().
+	 **/
+	void invalidate();
+
+	bool isBuilt() const;
+	size_t size() const;
+
+	void addFriendList(const std::shared_ptr<FriendList> &friendList);
+	void removeFriendList(const FriendList *friendList);
+
+	/**
+	 * Indexes a friend again after one of its searchable fields changed, or indexes it for the first time if it has
+	 * just been added to an indexed friend list.
+	 **/
+	void updateFriend(const std::shared_ptr<Friend> &lFriend);
+	void removeFriend(const Friend *lFriend);
+
+	/**
+	 * Finds the friends that match a filter, with the same semantic as MagicSearch.
+	 * Friends having a word starting with the beginning of the filter come first, then the others in the order of
+	 * their friend lists.
+	 * @param[in] filter filter as given to MagicSearch
+	 * @return the matching friends
+	 **/
+	std::list<std::shared_ptr<Friend>> search(const std::string &filter) const;
+
+private:
+	struct Document {
+		std::weak_ptr<Friend> mFriend;
+		const Friend *mKey = nullptr;
+		std::vector<std::string> mTerms;
+		bool mAlive = false;
+	};
+
+	std::vector<std::string> extractTerms(const std::shared_ptr<Friend> &lFriend) const;
+	void insertDocument(const std::shared_ptr<Friend> &lFriend, std::vector<std::string> &&terms);
+	void eraseDocument(uint32_t id);
+	void compact();
+
+	bool mBuilt = false;
+	std::string mNormalizationKey;
+	std::shared_ptr<Account> mAccount;
+	std::unordered_set<const FriendList *> mFriendLists;
+
+	// Documents are never moved: a removed or updated friend leaves a dead document behind, that is dropped by
+	// compact() once they are too many. Ids are thus allocated in increasing order and posting lists stay sorted.
+	std::vector<Document> mDocuments;
+	std::unordered_map<const Friend *, uint32_t> mDocumentIds;
+	std::unordered_map<uint32_t, std::vector<uint32_t>> mTrigrams;
+	std::multimap<std::string, uint32_t> mWords;
+	size_t mDeadCount = 0;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // _L_MAGIC_SEARCH_INDEX_H_
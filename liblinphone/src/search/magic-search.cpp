@@ -22,7 +22,6 @@
 
 #include <bctoolbox/defs.h>
 #include <bctoolbox/list.h>
-#include <bctoolbox/regex.h>
 
 #include "address/address.h"
 #include "c-wrapper/c-wrapper.h"
@@ -45,6 +44,7 @@
 #include "linphone/types.h"
 #include "linphone/utils/utils.h"
 #include "logger/logger.h"
+#include "magic-search-index.h"
 #include "magic-search.h"
 #include "presence/presence-model.h"
 #include "private.h"
@@ -63,8 +63,6 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
-static const std::regex charactersToEscape(R"([\.\^\$\+\(\)\[\]\{\}\|\?\*])");
-
 MagicSearch::MagicSearch(const shared_ptr<Core> &core) : CoreAccessor(core) {
 }
 
@@ -185,7 +183,7 @@ void MagicSearch::getContactListFromFilterAsync(const string &filter,
                                                 LinphoneMagicSearchAggregation aggregation) {
 	lDebug() << "[Magic Search] New async search: " << filter;
 
-	setupRegex(filter);
+	setupFilter(filter);
 	if (mAsyncData.pushRequest(SearchRequest(filter, withDomain, sourceFlags, aggregation)) ==
 	    1) { // This is a new request.
 		if (mAutoResetCache || mFilter.size() > filter.size()) {
@@ -216,7 +214,7 @@ list<shared_ptr<SearchResult>> MagicSearch::getContactListFromFilter(const strin
 		resetSearchCache();
 	}
 
-	setupRegex(filter);
+	setupFilter(filter);
 	if (!getSearchCache().empty() && !filter.empty()) {
 		resultList = continueSearch(withDomain, aggregation);
 		resetSearchCache();
@@ -420,33 +418,32 @@ void MagicSearch::setSearchCache(list<shared_ptr<SearchResult>> cache) {
 	if (mCacheResult != cache) mCacheResult = cache;
 }
 
-list<shared_ptr<SearchResult>> MagicSearch::getResultsFromFriends(bool onlyStarred, const string &withDomain) {
+list<shared_ptr<SearchResult>>
+MagicSearch::getResultsFromFriends(const string &filter, bool onlyStarred, const string &withDomain) {
 	LinphoneConfig *config = linphone_core_get_config(this->getCore()->getCCore());
 	returnEmptyFriends = !!linphone_config_get_bool(config, "magic_search", "return_empty_friends", FALSE);
 
-	list<shared_ptr<SearchResult>> resultList;
-	for (const auto &friendList : getCore()->getFriendLists()) {
-		// For all friends or when we reach the search limit
-		const auto &friends = friendList->getFriends();
+	// Only the friends the index found matching the filter need to be weighted, friends of application cache lists
+	// aren't indexed.
+	auto &index = getCore()->getMagicSearchIndex();
+	index.update(getCore()->getFriendLists(), getCore()->getDefaultAccount());
+	const auto friends = index.search(filter);
+	lDebug() << "[Magic Search] Index found [" << friends.size() << "] friends matching filter among [" << index.size()
+	         << "]";
 
-		if (friendList->getType() == LinphoneFriendListTypeApplicationCache) {
-			lInfo() << "[Magic Search] Ignoring [" << friends.size() << "] friends in friend list ["
-			        << friendList->getDisplayName() << "] because it's type is set to Application Cache";
-			continue;
-		}
-		for (const auto &lFriend : friends) {
-			bool isStarred = lFriend->getStarred();
-			if (!onlyStarred || isStarred) {
-				int flags = LinphoneMagicSearchSourceFriends;
-				if (isStarred) {
-					flags |= LinphoneMagicSearchSourceFavoriteFriends;
-				}
-				list<shared_ptr<SearchResult>> found = searchInFriend(lFriend, withDomain, flags);
-				if (resultList.empty()) {
-					resultList = found;
-				} else if (!found.empty()) {
-					resultList.splice(resultList.end(), found);
-				}
+	list<shared_ptr<SearchResult>> resultList;
+	for (const auto &lFriend : friends) {
+		bool isStarred = lFriend->getStarred();
+		if (!onlyStarred || isStarred) {
+			int flags = LinphoneMagicSearchSourceFriends;
+			if (isStarred) {
+				flags |= LinphoneMagicSearchSourceFavoriteFriends;
+			}
+			list<shared_ptr<SearchResult>> found = searchInFriend(lFriend, withDomain, flags);
+			if (resultList.empty()) {
+				resultList = found;
+			} else if (!found.empty()) {
+				resultList.splice(resultList.end(), found);
 			}
 		}
 	}
@@ -644,7 +641,7 @@ void MagicSearch::beginNewSearchAsync(const SearchRequest &request, SearchAsyncD
 	const string &domain = request.getWithDomain();
 
 	if (checkFriends || checkFavoriteFriends) {
-		list<shared_ptr<SearchResult>> found = getResultsFromFriends(!checkFriends, domain);
+		list<shared_ptr<SearchResult>> found = getResultsFromFriends(filter, !checkFriends, domain);
 		addResultsToResultsList(found, synchronousResults);
 	}
 
@@ -704,7 +701,7 @@ MagicSearch::beginNewSearch(const string &filter, const string &withDomain, int
 	    (sourceFlags & LinphoneMagicSearchSourceFavoriteFriends) == LinphoneMagicSearchSourceFavoriteFriends;
 
 	if (checkFriends || checkFavoriteFriends) {
-		list<shared_ptr<SearchResult>> found = getResultsFromFriends(!checkFriends, withDomain);
+		list<shared_ptr<SearchResult>> found = getResultsFromFriends(filter, !checkFriends, withDomain);
 		addResultsToResultsList(found, resultList);
 	}
 
@@ -943,26 +940,9 @@ unsigned int MagicSearch::searchInAddress(const shared_ptr<const Address> &lAddr
 	return getMinWeight();
 }
 
-void MagicSearch::setupRegex(const string &filter) {
-	string lowercaseFilter = filter;
-	transform(lowercaseFilter.begin(), lowercaseFilter.end(), lowercaseFilter.begin(),
-	          [](unsigned char c) { return tolower(c); });
-
-	if (lowercaseFilter.empty()) {
-		// Match anything
-		lowercaseFilter = ".*";
-	} else {
-		lowercaseFilter = regex_replace(lowercaseFilter, charactersToEscape, "\\$&");
-		// Replace white space by wildcard (used by LDAP)
-		lowercaseFilter = Utils::replaceAll(lowercaseFilter, " ", ".*");
-		if (lowercaseFilter != ".*") {
-			lowercaseFilter = ".*" + lowercaseFilter + ".*";
-		}
-	}
-
-	// Replace any regex special character by escaped version of it, such as '+' for example
-	lDebug() << "[Magic Search] Building regex [" << lowercaseFilter << "]";
-	mFilterRegex = lowercaseFilter;
+void MagicSearch::setupFilter(const string &filter) {
+	// White spaces act as wildcards (used by LDAP), an empty filter matches anything.
+	mFilterParts = MagicSearchIndex::splitFilter(filter);
 	mFilterApplyFullSipUri =
 	    (filter.rfind("sip:", 0) == 0 || filter.rfind("sips:", 0) == 0 || filter.rfind("@") != string::npos);
 }
@@ -973,13 +953,7 @@ unsigned int MagicSearch::getWeight(const string &haystack) const {
 	transform(lowercaseHaystack.begin(), lowercaseHaystack.end(), lowercaseHaystack.begin(),
 	          [](unsigned char c) { return tolower(c); });
 
-	if (bctbx_is_matching_regex_log_context(lowercaseHaystack.c_str(), mFilterRegex.c_str(), TRUE,
-#ifdef _MSC_VER
-	                                        __FUNCSIG__
-#else
-	                                        __PRETTY_FUNCTION__
-#endif
-	                                        )) {
+	if (MagicSearchIndex::matches(lowercaseHaystack, mFilterParts)) {
 		return getMaxWeight();
 	}
 	return getMinWeight();
@@ -26,6 +26,7 @@
 #include <queue>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include "c-wrapper/c-wrapper.h"
 #include "linphone/api/c-callbacks.h"
@@ -226,8 +227,9 @@ public:
 	 **/
 	void setSearchCache(std::list<std::shared_ptr<SearchResult>> cache);
 
-	/** Get SearchResults matching Friends in all FriendLists available in Core */
-	std::list<std::shared_ptr<SearchResult>> getResultsFromFriends(bool onlyStarred, const std::string &withDomain);
+	/** Get SearchResults matching Friends in all FriendLists available in Core, using the Core's MagicSearchIndex */
+	std::list<std::shared_ptr<SearchResult>>
+	getResultsFromFriends(const std::string &filter, bool onlyStarred, const std::string &withDomain);
 
 	/**
 	 * Get all addresses from call log
@@ -379,7 +381,7 @@ public:
 	bool iterate(void);
 
 private:
-	void setupRegex(const std::string &filter);
+	void setupFilter(const std::string &filter);
 
 	int mState = 0;
 	unsigned int mMinWeight = 0;
@@ -392,7 +394,7 @@ private:
 	std::string mFilter;
 	bool mAutoResetCache = true; // When a new search start, let MagicSearch to clean its cache
 	bool returnEmptyFriends = false;
-	std::string mFilterRegex;
+	std::vector<std::string> mFilterParts; // Lowercase parts of the filter, that must be found in that order
 	bool mFilterApplyFullSipUri =
 	    false; // If true, searchInAddress will check the full SIP URI, otherwise only display name & username
 
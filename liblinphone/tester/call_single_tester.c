@@ -2409,6 +2409,76 @@ static void call_terminated_by_caller(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+static void call_declined_on_timeout_while_ringing(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline =
+	    linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphoneCall *in_call;
+
+	linphone_core_set_inc_timeout(marie->lc, 3);
+	linphone_core_invite_address(pauline->lc, marie->identity);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallIncomingReceived, 1));
+	BC_ASSERT_PTR_NOT_NULL(in_call = linphone_core_get_current_call(marie->lc));
+
+	/* the call keeps ringing until the timeout */
+	BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 1500));
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 5000));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallError, 1));
+	if (in_call) {
+		BC_ASSERT_EQUAL(linphone_call_log_get_status(linphone_call_get_call_log(in_call)), LinphoneCallMissed, int,
+		                "%d");
+	}
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallReleased, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallReleased, 1));
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void call_terminated_by_in_call_timeout(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline =
+	    linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+
+	linphone_core_set_in_call_timeout(marie->lc, 3);
+	if (!BC_ASSERT_TRUE(call(pauline, marie))) goto end;
+
+	/* the call goes on until the timeout, counted from its connection */
+	BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 1500));
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 5000));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallEnd, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallReleased, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallReleased, 1));
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void call_in_call_timeout_changed_during_call(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline =
+	    linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+
+	if (!BC_ASSERT_TRUE(call(pauline, marie))) goto end;
+
+	/* a timeout set then removed during the call does not end it */
+	linphone_core_set_in_call_timeout(marie->lc, 2);
+	linphone_core_set_in_call_timeout(marie->lc, 0);
+	BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 4000));
+
+	/* the call has been connected for longer than the new timeout, it ends right away */
+	linphone_core_set_in_call_timeout(marie->lc, 2);
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallEnd, 1, 3000));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallEnd, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallReleased, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallReleased, 1));
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 static void call_terminated_by_nortp_timeout_base(bool_t on_hold) {
 	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
 	LinphoneCoreManager *pauline =
@@ -8546,6 +8616,8 @@ static test_t call_tests[] = {
     TEST_NO_TAG("Call terminated by caller", call_terminated_by_caller),
     TEST_NO_TAG("Call terminated by no rtp timeout", call_terminated_by_nortp_timeout),
     TEST_NO_TAG("Call terminated by no rtp timeout on hold", call_terminated_by_nortp_timeout_on_hold),
+    TEST_NO_TAG("Call terminated by in call timeout", call_terminated_by_in_call_timeout),
+    TEST_NO_TAG("Call in call timeout changed during call", call_in_call_timeout_changed_during_call),
     TEST_NO_TAG("Call without SDP", call_with_no_sdp),
     TEST_ONE_TAG("Call without SDP to a lime X3DH enabled device", call_with_no_sdp_lime, "LimeX3DH"),
     TEST_NO_TAG("Call without SDP and ACK without SDP", call_with_no_sdp_ack_without_sdp),
@@ -8631,6 +8703,7 @@ static test_t call_not_established_tests[] = {
     TEST_NO_TAG("Call declined on timeout", call_declined_on_timeout),
     TEST_NO_TAG("Call declined in Early Media", call_declined_in_early_media),
     TEST_NO_TAG("Call declined on timeout in Early Media", call_declined_on_timeout_in_early_media),
+    TEST_NO_TAG("Call declined on timeout while ringing", call_declined_on_timeout_while_ringing),
     TEST_NO_TAG("Call cancelled on request timeout in Early Media", call_cancelled_on_request_timeout_in_early_media),
     TEST_NO_TAG("Call declined with error", call_declined_with_error),
     TEST_NO_TAG("Call declined with reasons", call_declined_with_reasons),
@@ -1615,6 +1615,68 @@ static void search_friend_large_database(void) {
 	bc_free(dbPath);
 }
 
+static bctbx_list_t *_search_friends(LinphoneMagicSearch *magicSearch, const char *filter) {
+	linphone_magic_search_reset_search_cache(magicSearch);
+	return linphone_magic_search_get_contacts_list(magicSearch, filter, "", LinphoneMagicSearchSourceFriends,
+	                                               LinphoneMagicSearchAggregationNone);
+}
+
+static void search_friend_index_updates(void) {
+	bctbx_list_t *resultList = NULL;
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	const char *sipUri = "sip:mc@sip.example.org";
+	LinphoneFriend *lf = linphone_core_create_friend_with_address(manager->lc, sipUri);
+	linphone_friend_set_name(lf, "Marie Curie");
+	linphone_friend_list_add_friend(lfl, lf);
+
+	LinphoneMagicSearch *magicSearch = linphone_magic_search_new(manager->lc);
+
+	// The first search builds the index
+	resultList = _search_friends(magicSearch, "curie");
+	if (BC_ASSERT_PTR_NOT_NULL(resultList)) {
+		BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+		_check_friend_result_list(manager->lc, resultList, 0, sipUri, NULL);
+		bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	}
+
+	// Renaming the friend must be reflected by the index
+	linphone_friend_edit(lf);
+	linphone_friend_set_name(lf, "Marie Sklodowska");
+	linphone_friend_done(lf);
+	resultList = _search_friends(magicSearch, "curie");
+	BC_ASSERT_PTR_NULL(resultList);
+	if (resultList) bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// White spaces separate parts of the filter that must be found in that order
+	resultList = _search_friends(magicSearch, "mar sklo");
+	if (BC_ASSERT_PTR_NOT_NULL(resultList)) {
+		BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+		bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	}
+	resultList = _search_friends(magicSearch, "sklo mar");
+	BC_ASSERT_PTR_NULL(resultList);
+	if (resultList) bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// So must be a new phone number
+	linphone_friend_edit(lf);
+	linphone_friend_add_phone_number(lf, "0612345678");
+	linphone_friend_done(lf);
+	resultList = _search_friends(magicSearch, "1234");
+	BC_ASSERT_PTR_NOT_NULL(resultList);
+	if (resultList) bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// And the removal of the friend
+	linphone_friend_list_remove_friend(lfl, lf);
+	resultList = _search_friends(magicSearch, "sklodowska");
+	BC_ASSERT_PTR_NULL(resultList);
+	if (resultList) bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	linphone_friend_unref(lf);
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
 static void search_friend_get_capabilities(void) {
 	LinphoneMagicSearch *magicSearch = NULL;
 	bctbx_list_t *resultList = NULL;
@@ -3103,6 +3165,7 @@ test_t friends_tests[] = {
     TEST_ONE_TAG("Search friend with multiple sip address", search_friend_with_multiple_sip_address, "MagicSearch"),
     TEST_ONE_TAG("Search friend with same address", search_friend_with_same_address, "MagicSearch"),
     TEST_ONE_TAG("Search friend in large friends database", search_friend_large_database, "MagicSearch"),
+    TEST_ONE_TAG("Search friend index follows friend updates", search_friend_index_updates, "MagicSearch"),
     TEST_ONE_TAG("Search friend result has capabilities", search_friend_get_capabilities, "MagicSearch"),
     TEST_TWO_TAGS("Search friend result chat room remote", search_friend_chat_room_remote, "MagicSearch", "LDAP"),
     TEST_TWO_TAGS("Search friend result chat room remote ldap fallback",
@@ -228,6 +228,64 @@ static void group_chat_room_server_deletion() {
 	}
 }
 
+static void group_chat_room_lasting_longer_than_in_call_timeout() {
+	Focus focus("chloe_rc");
+	{ // to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getConferenceFactoryAddress());
+		ClientConference pauline("pauline_rc", focus.getConferenceFactoryAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+
+		bctbx_list_t *coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+
+		// The in call timeout is meant for calls, not for the sessions of the chat rooms
+		for (bctbx_list_t *it = coresList; it != NULL; it = bctbx_list_next(it)) {
+			linphone_core_set_in_call_timeout((LinphoneCore *)bctbx_list_get_data(it), 1);
+		}
+
+		Address paulineAddr = pauline.getIdentity();
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(paulineAddr.toC()));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+
+		const char *initialSubject = "Long lasting";
+		LinphoneChatRoom *marieCr =
+		    create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses,
+		                                 initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+		LinphoneChatRoom *paulineCr = check_creation_chat_room_client_side(
+		    coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 1, FALSE);
+
+		// Wait past the timeout
+		CoreManagerAssert({focus, marie, pauline}).waitUntil(chrono::seconds(3), [] { return false; });
+		BC_ASSERT_EQUAL(marie.getStats().number_of_LinphoneChatRoomStateTerminated,
+		                initialMarieStats.number_of_LinphoneChatRoomStateTerminated, int, "%d");
+		BC_ASSERT_EQUAL(pauline.getStats().number_of_LinphoneChatRoomStateTerminated,
+		                initialPaulineStats.number_of_LinphoneChatRoomStateTerminated, int, "%d");
+		BC_ASSERT_EQUAL(linphone_chat_room_get_state(marieCr), LinphoneChatRoomStateCreated, int, "%d");
+		if (paulineCr) {
+			BC_ASSERT_EQUAL(linphone_chat_room_get_state(paulineCr), LinphoneChatRoomStateCreated, int, "%d");
+		}
+
+		// The chat room still works
+		LinphoneChatMessage *msg = linphone_chat_room_create_message_from_utf8(marieCr, "still there");
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(CoreManagerAssert({focus, marie, pauline}).wait([msg] {
+			return (linphone_chat_message_get_state(msg) == LinphoneChatMessageStateDelivered);
+		}));
+		BC_ASSERT_TRUE(wait_for_list(coresList, &pauline.getStats().number_of_LinphoneMessageReceived,
+		                             initialPaulineStats.number_of_LinphoneMessageReceived + 1,
+		                             liblinphone_tester_sip_timeout));
+		linphone_chat_message_unref(msg);
+
+		bctbx_list_free(coresList);
+	}
+}
+
 static void group_chat_room_server_deletion_with_rmt_lst_event_handler() {
 	Focus focus("chloe_rc");
 	{ // to make sure focus is destroyed after clients.
@@ -3899,6 +3957,8 @@ static test_t local_conference_chat_basic_tests[] = {
                 LinphoneTest::one_to_one_chatroom_not_rejoined_after_leaving),
     TEST_NO_TAG("One to one chatroom (backward compatibility)",
                 LinphoneTest::one_to_one_chatroom_backward_compatibility),
+    TEST_NO_TAG("Group chat lasting longer than the in call timeout",
+                LinphoneTest::group_chat_room_lasting_longer_than_in_call_timeout),
     TEST_ONE_TAG("Group chat Server chat room deletion with remote list event handler",
                  LinphoneTest::group_chat_room_server_deletion_with_rmt_lst_event_handler,
                  "LeaksMemory") /* because of coreMgr restart*/
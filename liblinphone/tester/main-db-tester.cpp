@@ -647,6 +647,32 @@ static void search_messages_in_chat_room(void) {
 	}
 }
 
+static void write_behind_events(void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	if (mainDb.isInitialized()) {
+		ConferenceId conferenceId(Address::create("sip:test-3@sip.linphone.org")->getSharedFromThis(),
+		                          Address::create("sip:test-1@sip.linphone.org"), ConferenceIdParams());
+		const int eventCount = mainDb.getEventCount();
+
+		// Commit every 3 operations, the delay is long enough not to trigger during the test.
+		mainDb.enableWriteBehind(60000, 3);
+		for (int i = 0; i < 10; ++i) {
+			auto event = make_shared<ConferenceSubjectEvent>(time(nullptr), conferenceId, "Subject " + to_string(i));
+			BC_ASSERT_TRUE(mainDb.addEvent(event));
+		}
+		// The last operation is still pending, but visible to the reads.
+		BC_ASSERT_EQUAL(mainDb.getEventCount(), eventCount + 10, int, "%d");
+		BC_ASSERT_TRUE(mainDb.flushWriteBehind());
+		mainDb.enableWriteBehind(0, 0);
+
+		provider.reStart();
+		BC_ASSERT_EQUAL(provider.getMainDb().getEventCount(), eventCount + 10, int, "%d");
+	} else {
+		BC_FAIL("Database not initialized");
+	}
+}
+
 static test_t main_db_tests[] = {
     TEST_NO_TAG("Get events count", get_events_count),
     TEST_NO_TAG("Get messages count", get_messages_count),
@@ -665,7 +691,8 @@ static test_t main_db_tests[] = {
                 database_with_chatroom_duplicates_gruu_pruned_conference_server),
     TEST_ONE_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms, "shaky"),
     TEST_ONE_TAG("Load a lot of chatrooms cleaning GRUU", load_a_lot_of_chatrooms_cleaning_gruu, "shaky"),
-    TEST_NO_TAG("Search messages in chatroom", search_messages_in_chat_room)};
+    TEST_NO_TAG("Search messages in chatroom", search_messages_in_chat_room),
+    TEST_NO_TAG("Write-behind events", write_behind_events)};
 
 test_suite_t main_db_test_suite = {
     "MainDb",
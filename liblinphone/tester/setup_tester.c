@@ -667,6 +667,47 @@ static void linphone_lpconfig_from_xml_zerolen_value(void) {
 	ms_free(xml_path);
 }
 
+static void linphone_lpconfig_entries(void) {
+	const char *buffer = "[sip]\ninc_timeout=30\n[rtp]\naudio_rtp_port=0x1f40\n[misc]\nratio=1.5\n";
+	LpConfig *conf = linphone_config_new_from_buffer(buffer);
+	LinphoneConfigEntry *inc_timeout = linphone_config_entry_new(conf, "sip", "inc_timeout");
+	LinphoneConfigEntry *port = linphone_config_entry_new(conf, "rtp", "audio_rtp_port");
+	LinphoneConfigEntry *ratio = linphone_config_entry_new(conf, "misc", "ratio");
+	LinphoneConfigEntry *missing = linphone_config_entry_new(conf, "misc", "missing");
+	char *dump;
+
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(inc_timeout, 0), 30, int, "%d");
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(port, 0), 8000, int, "%d");
+	BC_ASSERT_TRUE(linphone_config_entry_get_float(ratio, 0.f) == 1.5f);
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(missing, 42), 42, int, "%d");
+	BC_ASSERT_STRING_EQUAL(linphone_config_entry_get_string(missing, "default"), "default");
+
+	/* The handles follow the modifications of the config */
+	linphone_config_set_int(conf, "sip", "inc_timeout", 60);
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(inc_timeout, 0), 60, int, "%d");
+	BC_ASSERT_TRUE(linphone_config_entry_get_bool(inc_timeout, FALSE));
+	linphone_config_set_int(conf, "misc", "missing", 1);
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(missing, 42), 1, int, "%d");
+	linphone_config_clean_entry(conf, "sip", "inc_timeout");
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(inc_timeout, 0), 0, int, "%d");
+	linphone_config_clean_section(conf, "misc");
+	BC_ASSERT_EQUAL(linphone_config_entry_get_int(missing, 42), 42, int, "%d");
+	BC_ASSERT_TRUE(linphone_config_entry_get_float(ratio, 0.f) == 0.f);
+
+	/* Sections and items keep their order */
+	linphone_config_set_int(conf, "sip", "inc_timeout", 10);
+	linphone_config_set_int(conf, "misc", "ratio", 2);
+	dump = linphone_config_dump(conf);
+	BC_ASSERT_STRING_EQUAL(dump, "[sip]\n\tinc_timeout=10\n[rtp]\n\taudio_rtp_port=0x1f40\n[misc]\n\tratio=2\n");
+	ms_free(dump);
+
+	linphone_config_entry_free(inc_timeout);
+	linphone_config_entry_free(port);
+	linphone_config_entry_free(ratio);
+	linphone_config_entry_free(missing);
+	linphone_config_unref(conf);
+}
+
 void linphone_proxy_config_address_equal_test(void) {
 	LinphoneAddress *a = linphone_address_new("sip:toto@titi");
 	LinphoneAddress *b = linphone_address_new("sips:toto@titi");
@@ -1397,6 +1438,7 @@ static test_t setup_tests[] = {
     TEST_NO_TAG("LPConfig zero_len value from buffer", linphone_lpconfig_from_buffer_zerolen_value),
     TEST_NO_TAG("LPConfig zero_len value from file", linphone_lpconfig_from_file_zerolen_value),
     TEST_NO_TAG("LPConfig zero_len value from XML", linphone_lpconfig_from_xml_zerolen_value),
+    TEST_NO_TAG("LPConfig entries", linphone_lpconfig_entries),
     TEST_NO_TAG("LPConfig invalid friend", linphone_lpconfig_invalid_friend),
     TEST_NO_TAG("LPConfig invalid friend remote provisoning", linphone_lpconfig_invalid_friend_remote_provisioning),
     TEST_NO_TAG("Chat room", chat_room_test),
@@ -33,6 +33,10 @@
 #include "linphone/wrapper_utils.h"
 #include "tester_utils.h"
 
+#ifdef HAVE_SQLITE
+#include "sqlite3_bctbx_vfs.h"
+#endif
+
 static void enable_encryption(const uint16_t encryptionModule, const bool encryptDbJournal = true) {
 	// enable encryption. The call to linphone_factory_set_vfs_encryption will set the VfsEncryption class callback
 	if (encryptionModule == LINPHONE_VFS_ENCRYPTION_PLAIN) {
@@ -640,10 +644,97 @@ static void secret_key_continuity_test(void) {
 	linphone_factory_set_vfs_encryption(linphone_factory_get(), LINPHONE_VFS_ENCRYPTION_UNSET, NULL, 0);
 }
 
+#ifdef HAVE_SQLITE
+static bool database_exec(sqlite3 *db, const char *sql) {
+	char *errmsg = nullptr;
+	if (sqlite3_exec(db, sql, nullptr, nullptr, &errmsg) != SQLITE_OK) {
+		BCTBX_SLOGE << "Database throughput: [" << sql << "] failed: " << (errmsg ? errmsg : "");
+		sqlite3_free(errmsg);
+		return false;
+	}
+	return true;
+}
+
+// Insert then select rows of a database using the bctbx sqlite vfs, return the time spent in each phase
+static void database_throughput(const uint16_t encryptionModule,
+                                const char *name,
+                                uint64_t &insertTime,
+                                uint64_t &selectTime) {
+	constexpr int transactions = 50;
+	constexpr int rowsPerTransaction = 100;
+	constexpr int selects = 20;
+
+	enable_encryption(encryptionModule);
+	char *filename = bctbx_strdup_printf("evfs_throughput_%s.db", name);
+	char *dbPath = bc_tester_file(filename);
+	bctbx_free(filename);
+	unlink(dbPath);
+
+	sqlite3 *db = nullptr;
+	BC_ASSERT_EQUAL(sqlite3_open_v2(dbPath, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, BCTBX_SQLITE3_VFS),
+	                SQLITE_OK, int, "%d");
+	// keep the sqlite page cache small so the reads actually go through the vfs
+	BC_ASSERT_TRUE(database_exec(db, "PRAGMA cache_size = 16"));
+	BC_ASSERT_TRUE(database_exec(db, "CREATE TABLE message (id INTEGER PRIMARY KEY, content TEXT)"));
+
+	// one transaction per batch of rows, as the message storage does
+	uint64_t start = bctbx_get_cur_time_ms();
+	sqlite3_stmt *stmt = nullptr;
+	BC_ASSERT_EQUAL(sqlite3_prepare_v2(db, "INSERT INTO message (content) VALUES (?)", -1, &stmt, nullptr), SQLITE_OK,
+	                int, "%d");
+	std::string content(500, 'x');
+	for (int i = 0; i < transactions; i++) {
+		database_exec(db, "BEGIN");
+		for (int j = 0; j < rowsPerTransaction; j++) {
+			sqlite3_bind_text(stmt, 1, content.c_str(), (int)content.size(), SQLITE_STATIC);
+			BC_ASSERT_EQUAL(sqlite3_step(stmt), SQLITE_DONE, int, "%d");
+			sqlite3_reset(stmt);
+		}
+		database_exec(db, "COMMIT");
+	}
+	sqlite3_finalize(stmt);
+	insertTime = bctbx_get_cur_time_ms() - start;
+
+	// read the whole table back several times
+	start = bctbx_get_cur_time_ms();
+	BC_ASSERT_EQUAL(sqlite3_prepare_v2(db, "SELECT content FROM message", -1, &stmt, nullptr), SQLITE_OK, int, "%d");
+	for (int i = 0; i < selects; i++) {
+		int rows = 0;
+		while (sqlite3_step(stmt) == SQLITE_ROW) {
+			rows++;
+		}
+		sqlite3_reset(stmt);
+		BC_ASSERT_EQUAL(rows, transactions * rowsPerTransaction, int, "%d");
+	}
+	sqlite3_finalize(stmt);
+	selectTime = bctbx_get_cur_time_ms() - start;
+
+	sqlite3_close(db);
+	unlink(dbPath);
+	bctbx_free(dbPath);
+	// reset VFS encryption
+	linphone_factory_set_vfs_encryption(linphone_factory_get(), LINPHONE_VFS_ENCRYPTION_UNSET, NULL, 0);
+}
+
+static void database_throughput_test(void) {
+	uint64_t plainInsertTime = 0, plainSelectTime = 0;
+	uint64_t encryptedInsertTime = 0, encryptedSelectTime = 0;
+	database_throughput(LINPHONE_VFS_ENCRYPTION_PLAIN, "plain", plainInsertTime, plainSelectTime);
+	database_throughput(LINPHONE_VFS_ENCRYPTION_AES256GCM128_SHA256, "aes256gcm", encryptedInsertTime,
+	                    encryptedSelectTime);
+	BCTBX_SLOGI << "Database throughput: insert plain " << plainInsertTime << " ms, AES256GCM " << encryptedInsertTime
+	            << " ms - select plain " << plainSelectTime << " ms, AES256GCM " << encryptedSelectTime << " ms";
+}
+#endif // HAVE_SQLITE
+
 test_t vfs_encryption_tests[] = {TEST_NO_TAG("Register user", register_user_test),
                                  TEST_NO_TAG("ZRTP call", zrtp_call_test), TEST_NO_TAG("Migration", migration_test),
                                  TEST_NO_TAG("File transfer", file_transfer_test),
-                                 TEST_NO_TAG("Secret Key Continuity", secret_key_continuity_test)};
+                                 TEST_NO_TAG("Secret Key Continuity", secret_key_continuity_test),
+#ifdef HAVE_SQLITE
+                                 TEST_NO_TAG("Database throughput", database_throughput_test)
+#endif
+};
 
 test_suite_t vfs_encryption_test_suite = {"VFS encryption",
                                           NULL,
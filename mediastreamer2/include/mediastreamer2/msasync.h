@@ -111,6 +111,40 @@ ms_worker_thread_add_repeated_task(MSWorkerThread *obj, MSTaskFunc func, void *d
 
 MS2_PUBLIC void ms_worker_thread_destroy(MSWorkerThread *obj, bool_t finish_tasks);
 
+/*
+ * A pool of worker threads shared by many serial task queues.
+ * The tasks of a MSWorkerQueue are executed one after the other in the order they were added, never concurrently,
+ * but on any thread of the pool. This lets many codec filters share a few threads instead of owning one each.
+ */
+typedef struct _MSWorkerPool MSWorkerPool;
+typedef struct _MSWorkerQueue MSWorkerQueue;
+
+typedef struct _MSWorkerPoolStats {
+	int worker_count;
+	int queue_count;
+	int pending_tasks;     /**< tasks waiting to be executed */
+	int max_pending_tasks; /**< highest number of tasks waiting to be executed since the pool was created */
+	uint64_t executed_tasks;
+	float mean_wait_time;  /**< mean time between the addition and the execution of a task, in milliseconds */
+	float max_wait_time;   /**< in milliseconds */
+	float mean_run_time;   /**< mean execution time of a task, in milliseconds */
+} MSWorkerPoolStats;
+
+/* Create a worker pool. Name is used to name the threads. */
+MS2_PUBLIC MSWorkerPool *ms_worker_pool_new(const char *name, int nworkers);
+MS2_PUBLIC void ms_worker_pool_get_stats(MSWorkerPool *obj, MSWorkerPoolStats *stats);
+/* Destroy a worker pool. All the queues created in this pool must have been destroyed before. */
+MS2_PUBLIC void ms_worker_pool_destroy(MSWorkerPool *obj);
+
+/* Create a serial task queue executed by the threads of a pool. */
+MS2_PUBLIC MSWorkerQueue *ms_worker_queue_new(MSWorkerPool *pool);
+/* Create a serial task queue executed by a thread of its own, that behaves as a MSWorkerThread. */
+MS2_PUBLIC MSWorkerQueue *ms_worker_queue_new_standalone(const char *name);
+MS2_PUBLIC void ms_worker_queue_add_task(MSWorkerQueue *obj, MSTaskFunc fn, void *data);
+/* Destroy a queue, after the execution of the queued tasks if finish_tasks is TRUE, or dropping them otherwise.
+ * It waits for the task being executed if any, so it must not be called from a task of this queue. */
+MS2_PUBLIC void ms_worker_queue_destroy(MSWorkerQueue *obj, bool_t finish_tasks);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,6 +28,7 @@ typedef struct MSAudioMixerCtl {
 		float gain;  /**<gain correction */
 		int active;  /**< to mute or unmute the input channel */
 		int enabled; /**< to mute/unmute the output channel*/
+		float level; /**< the current level of the input channel, in dB */
 	} param;
 } MSAudioMixerCtl;
 
@@ -40,4 +41,11 @@ typedef struct MSAudioMixerCtl {
 #define MS_AUDIO_MIXER_SET_MASTER_CHANNEL MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 3, int)
 
 #define MS_AUDIO_MIXER_ENABLE_OUTPUT MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 4, MSAudioMixerCtl)
+
+/**In conference mode, limits the mix to the given number of input channels having the highest levels (see
+ * MS_AUDIO_MIXER_SET_INPUT_LEVEL). 0, the default, means that all active inputs are mixed.*/
+#define MS_AUDIO_MIXER_SET_MAX_CONTRIBUTORS MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 5, int)
+
+/**Set the current level of an input channel, used to select the contributors when their number is limited.*/
+#define MS_AUDIO_MIXER_SET_INPUT_LEVEL MS_FILTER_METHOD(MS_AUDIO_MIXER_ID, 6, MSAudioMixerCtl)
 #endif
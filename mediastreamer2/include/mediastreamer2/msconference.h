@@ -154,6 +154,30 @@ MS2_PUBLIC void ms_audio_conference_process_events(MSAudioConference *obj);
  **/
 MS2_PUBLIC void ms_audio_conference_mute_member(MSAudioConference *obj, MSAudioEndpoint *ep, bool_t muted);
 
+/**
+ * Limits the mix to the loudest participants.
+ * Only the max_contributors participants having the highest volumes are mixed, the other ones all receive the same
+ * mix, which is cheaper for large conferences. The volumes are updated by ms_audio_conference_process_events().
+ * This is only possible in mixer mode.
+ *
+ * @param obj the conference
+ * @param max_contributors the maximum number of participants heard at the same time, 0 meaning no limit.
+ **/
+MS2_PUBLIC void ms_audio_conference_set_max_contributors(MSAudioConference *obj, int max_contributors);
+
+/**
+ * Enables the sharing of encoders between the participants that are not heard (muted or not part of the loudest ones,
+ * see ms_audio_conference_set_max_contributors()).
+ * These participants all receive the same mix, which is then encoded only once for all the remote participants using
+ * the same codec configuration, instead of once per participant. The participants switch between their own encoder
+ * and the shared one when ms_audio_conference_process_events() is called.
+ * This is only possible in mixer mode, and must be done before adding members to the conference.
+ *
+ * @param obj the conference
+ * @param enabled TRUE to share the encoders, FALSE otherwise.
+ **/
+MS2_PUBLIC void ms_audio_conference_enable_shared_encoding(MSAudioConference *obj, bool_t enabled);
+
 /**
  * Returns the size (ie the number of participants) of a conference.
  * @param obj the conference
@@ -50,10 +50,15 @@ struct _MSFactory {
 	char *image_resources_dir;
 	char *echo_canceller_filtername;
 	int expected_video_bandwidth;
+	struct _MSTickerPool *ticker_pool;
+	struct _MSWorkerPool *codec_worker_pool;
 };
 
 typedef struct _MSFactory MSFactory;
 
+struct _MSTicker;
+struct _MSTickerParams;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -293,6 +298,59 @@ MS2_PUBLIC unsigned int ms_factory_get_cpu_count(MSFactory *obj);
  **/
 MS2_PUBLIC void ms_factory_set_cpu_count(MSFactory *obj, unsigned int c);
 
+/**
+ * Enable or disable the execution of the tickers created by ms_factory_create_ticker() by a shared pool of worker
+ * threads, instead of one thread per ticker.
+ * This must be done before any stream is created with this factory.
+ * @param obj the factory
+ * @param enabled TRUE to enable the ticker pool, FALSE to disable it.
+ * @param nworkers the number of worker threads of the pool. If zero, the cpu count of the factory is used.
+ **/
+MS2_PUBLIC void ms_factory_enable_ticker_pool(MSFactory *obj, bool_t enabled, int nworkers);
+
+/**
+ * Get the ticker pool of the factory, if enabled with ms_factory_enable_ticker_pool().
+ * @param obj the factory
+ * @return the #MSTickerPool or NULL.
+ **/
+MS2_PUBLIC struct _MSTickerPool *ms_factory_get_ticker_pool(MSFactory *obj);
+
+/**
+ * Create a ticker, that is run by the ticker pool of the factory if enabled, or by its own thread otherwise.
+ * @param obj the factory
+ * @param params the ticker parameters.
+ * @return a new #MSTicker.
+ **/
+MS2_PUBLIC struct _MSTicker *ms_factory_create_ticker(MSFactory *obj, const struct _MSTickerParams *params);
+
+/**
+ * Enable or disable the codec worker pool of the factory.
+ * When enabled, the encoder and decoder filters run their asynchronous work on the threads of this pool, instead of
+ * threads of their own. This bounds the number of codec threads when many video streams run concurrently.
+ * It must be called before any filter using the pool is started, or after all of them are stopped.
+ * @param obj the factory
+ * @param enabled TRUE to enable the codec worker pool, FALSE to disable it.
+ * @param nworkers the number of worker threads of the pool. If zero, the cpu count of the factory is used.
+ **/
+MS2_PUBLIC void ms_factory_enable_codec_worker_pool(MSFactory *obj, bool_t enabled, int nworkers);
+
+/**
+ * Get the codec worker pool of the factory, if enabled with ms_factory_enable_codec_worker_pool().
+ * Its statistics are available with ms_worker_pool_get_stats().
+ * @param obj the factory
+ * @return the #MSWorkerPool or NULL.
+ **/
+MS2_PUBLIC struct _MSWorkerPool *ms_factory_get_codec_worker_pool(MSFactory *obj);
+
+/**
+ * Create the serial task queue of a codec filter, that is run by the codec worker pool of the factory if enabled, or
+ * by its own thread otherwise.
+ * @param obj the factory
+ * @param name the name of the thread, when the pool is not enabled.
+ * @return a new #MSWorkerQueue, to be destroyed with ms_worker_queue_destroy().
+ **/
+MS2_PUBLIC struct _MSWorkerQueue *ms_factory_create_codec_worker_queue(MSFactory *obj, const char *name);
+
 MS2_PUBLIC void ms_factory_add_platform_tag(MSFactory *obj, const char *tag);
 
 MS2_PUBLIC MSList *ms_factory_get_platform_tags(MSFactory *obj);
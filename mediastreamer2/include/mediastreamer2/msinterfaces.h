@@ -295,6 +295,9 @@ typedef enum _MSAudioRoute MSAudioRoute;
 
 #define MS_AUDIO_ENCODER_GET_CAPABILITIES MS_FILTER_METHOD(MSFilterAudioEncoderInterface, 4, int)
 
+/* Drop the pending samples and the prediction state, as if the encoder was starting a new stream.*/
+#define MS_AUDIO_ENCODER_RESET MS_FILTER_METHOD_NO_ARG(MSFilterAudioEncoderInterface, 5)
+
 /** Interface definitions for VAD */
 #define MS_VAD_ENABLE_SILENCE_DETECTION MS_FILTER_METHOD(MSFilterVADInterface, 0, int)
 
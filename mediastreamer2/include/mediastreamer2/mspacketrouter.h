@@ -42,6 +42,11 @@ typedef struct _MSPacketRouterPinControl {
 	int enabled;
 } MSPacketRouterPinControl;
 
+typedef struct _MSPacketRouterOutputBitrate {
+	int pin;
+	int bitrate; /*< Maximum bitrate in bits/s the receiver of this output can handle, 0 for no limit */
+} MSPacketRouterOutputBitrate;
+
 #define MS_PACKET_ROUTER_SET_ROUTING_MODE MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 0, MSPacketRouterMode)
 #define MS_PACKET_ROUTER_SET_FULL_PACKET_MODE_ENABLED MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 1, bool_t)
 #define MS_PACKET_ROUTER_GET_FULL_PACKET_MODE_ENABLED MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 9, bool_t)
@@ -58,6 +63,11 @@ typedef struct _MSPacketRouterPinControl {
 #define MS_PACKET_ROUTER_NOTIFY_PLI MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 6, int)
 #define MS_PACKET_ROUTER_NOTIFY_FIR MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 7, int)
 
+// Higher temporal layers of the source are dropped for this output, so that it stays under the given bitrate.
+#define MS_PACKET_ROUTER_SET_OUTPUT_MAX_BITRATE MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 11, MSPacketRouterOutputBitrate)
+// TRUE if all the video sources being forwarded are temporally scalable (they mark several temporal layers).
+#define MS_PACKET_ROUTER_GET_TEMPORAL_SCALABILITY MS_FILTER_METHOD(MS_PACKET_ROUTER_ID, 12, bool_t)
+
 // Events raised by the router when it needs to receive a key frame in order to complete the route to new input source
 #define MS_PACKET_ROUTER_SEND_FIR MS_FILTER_EVENT(MS_PACKET_ROUTER_ID, 0, int)
 #define MS_PACKET_ROUTER_SEND_PLI MS_FILTER_EVENT(MS_PACKET_ROUTER_ID, 1, int)
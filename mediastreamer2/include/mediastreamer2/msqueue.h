@@ -120,6 +120,9 @@ MS2_PUBLIC void ms_queue_destroy(MSQueue *q);
 #define mblk_set_discardable_flag(m, bit) __mblk_set_flag(m, 5, bit) /*use to mark a discardable frame*/
 #define mblk_get_discardable_flag(m) (((m)->reserved2) >> 5 & 0x1)   /*bit 6*/
 
+#define mblk_set_temporal_layer_id(m, id) (m)->reserved2 = ((m)->reserved2 & ~(0x7 << 8)) | (((id) & 0x7) << 8)
+#define mblk_get_temporal_layer_id(m) (((m)->reserved2) >> 8 & 0x7) /*bits 9 to 11, temporal layer of a video frame*/
+
 #define mblk_set_user_flag(m, bit) __mblk_set_flag(m, 7, bit) /* to be used by extensions to mediastreamer2*/
 #define mblk_get_user_flag(m) (((m)->reserved2) >> 7 & 0x1)   /*bit 8*/
 
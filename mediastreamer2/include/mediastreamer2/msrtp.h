@@ -114,6 +114,12 @@ typedef struct _MSFilterRequestClientToMixerDataCb MSFilterRequestClientToMixerD
 
 #define MS_RTP_SEND_SET_VOICE_ACTIVITY MS_FILTER_METHOD(MS_RTP_SEND_ID, 19, bool_t)
 
+/**
+ * Tells that the next packets come from another encoder, whose timestamps have an unrelated origin. The outgoing
+ * timestamps are carried on from the previous packets and the first new packet starts a talkspurt.
+ */
+#define MS_RTP_SEND_NOTIFY_SOURCE_CHANGE MS_FILTER_METHOD_NO_ARG(MS_RTP_SEND_ID, 20)
+
 extern MSFilterDesc ms_rtp_send_desc;
 extern MSFilterDesc ms_rtp_recv_desc;
 
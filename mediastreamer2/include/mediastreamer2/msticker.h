@@ -70,6 +70,12 @@ struct _MSTickerLateEvent {
 
 typedef struct _MSTickerLateEvent MSTickerLateEvent;
 
+/**
+ * Structure for ticker pool object.
+ * @var MSTickerPool
+ */
+typedef struct _MSTickerPool MSTickerPool;
+
 struct _MSTicker {
 	ms_mutex_t lock; /*main lock protecting the filter execution list */
 	ms_cond_t cond;
@@ -95,6 +101,10 @@ struct _MSTicker {
 	MSTickerLateEvent late_event;
 	unsigned long thread_id;
 	bool_t run; /* flag to indicate whether the ticker must be run or not */
+	MSTickerPool *pool;     /* when not NULL, the ticker has no thread and is executed by the pool's workers*/
+	uint64_t pool_deadline; /* wall clock time (ms) at which the next tick is due, when run by a pool */
+	int pool_worker;        /* index of the pool worker this ticker is attached to */
+	bool_t pool_running;    /* TRUE while a pool worker is executing a tick of this ticker */
 };
 
 /**
@@ -145,6 +155,19 @@ MS2_PUBLIC MSTicker *ms_ticker_new(void);
  */
 MS2_PUBLIC MSTicker *ms_ticker_new_with_params(const MSTickerParams *params);
 
+/**
+ * Create a ticker whose graphs are executed by the worker threads of a #MSTickerPool,
+ * instead of a thread of its own.
+ * The ticker behaves as a regular ticker (same tick interval, same graph scheduling rules), but
+ * the priority from params is ignored: the one of the pool applies.
+ * ms_ticker_set_tick_func() cannot be used with such ticker.
+ * @param pool the #MSTickerPool that will run the ticker.
+ * @param params the ticker parameters.
+ *
+ * Returns: MSTicker * if successfull, NULL otherwise.
+ */
+MS2_PUBLIC MSTicker *ms_ticker_new_in_pool(MSTickerPool *pool, const MSTickerParams *params);
+
 /**
  * Set a name to the ticker (used for logging)
  * @deprecated prefer using ms_ticker_new_with_params() to set the name from the start.
@@ -255,6 +278,39 @@ MS2_PUBLIC void ms_ticker_get_last_late_tick(MSTicker *ticker, MSTickerLateEvent
  */
 MS2_PUBLIC uint64_t ms_ticker_round(uint64_t ms);
 
+/**
+ * Create a pool of worker threads able to run many tickers.
+ * Each ticker created with ms_ticker_new_in_pool() is attached to one worker, but any idle worker
+ * may run a tick that is due when the owner of the ticker is busy with other ones.
+ * This avoids the creation of one real-time thread per ticker when many graphs run concurrently, for example
+ * on a conference server.
+ * @param nworkers the number of worker threads, typically the number of processors (see ms_factory_get_cpu_count()).
+ * @param prio the priority of the worker threads.
+ * @param name the name of the pool, used to name the worker threads.
+ * @return a new #MSTickerPool.
+ */
+MS2_PUBLIC MSTickerPool *ms_ticker_pool_new(int nworkers, MSTickerPrio prio, const char *name);
+
+/**
+ * Get the number of worker threads of a ticker pool.
+ * @param pool the #MSTickerPool.
+ * @return the number of worker threads.
+ */
+MS2_PUBLIC int ms_ticker_pool_get_worker_count(const MSTickerPool *pool);
+
+/**
+ * Get the number of tickers currently run by a ticker pool.
+ * @param pool the #MSTickerPool.
+ * @return the number of tickers.
+ */
+MS2_PUBLIC int ms_ticker_pool_get_ticker_count(MSTickerPool *pool);
+
+/**
+ * Destroy a ticker pool. All tickers created in this pool must have been destroyed before.
+ * @param pool the #MSTickerPool.
+ */
+MS2_PUBLIC void ms_ticker_pool_destroy(MSTickerPool *pool);
+
 /**
  * Set the MSTickerSynchronizer for a MSTicker.
  * @param ticker A MSTicker object to synchronize
@@ -20,22 +20,27 @@
 
 #include "mediastreamer2/msaudiomixer.h"
 #include "mediastreamer2/msticker.h"
+#include "mediastreamer2/msvolume.h"
 
 #ifdef _MSC_VER
 #include <malloc.h>
 #define alloca _alloca
 #endif
 
-#define MIXER_MAX_CHANNELS 50
+#define MIXER_MAX_CHANNELS 256
 #define ALWAYS_STREAMOUT 1
 #define BYPASS_MODE_TIMEOUT 1000
 
-static void accumulate(int32_t *sum, int16_t *contrib, int nwords) {
-	int i;
-	for (i = 0; i < nwords; ++i) {
-		sum[i] += contrib[i];
-	}
-}
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIXER_USE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIXER_USE_SSE2 1
+#elif MS_HAS_ARM_NEON
+#include <arm_neon.h>
+#define MIXER_USE_NEON 1
+#endif
 
 static MS2_INLINE int16_t saturate(int32_t s) {
 	if (s > 32767) return 32767;
@@ -43,21 +48,138 @@ static MS2_INLINE int16_t saturate(int32_t s) {
 	return (int16_t)s;
 }
 
+/* sum[i] += contrib[i] */
+static void accumulate(int32_t *sum, const int16_t *contrib, int nwords) {
+	int i = 0;
+#if MIXER_USE_AVX2
+	for (; i + 16 <= nwords; i += 16) {
+		__m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(contrib + i)));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(contrib + i + 8)));
+		_mm256_storeu_si256((__m256i *)(sum + i), _mm256_add_epi32(_mm256_loadu_si256((__m256i *)(sum + i)), lo));
+		_mm256_storeu_si256((__m256i *)(sum + i + 8),
+		                    _mm256_add_epi32(_mm256_loadu_si256((__m256i *)(sum + i + 8)), hi));
+	}
+#elif MIXER_USE_SSE2
+	for (; i + 8 <= nwords; i += 8) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(contrib + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(c, c), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(c, c), 16);
+		_mm_storeu_si128((__m128i *)(sum + i), _mm_add_epi32(_mm_loadu_si128((__m128i *)(sum + i)), lo));
+		_mm_storeu_si128((__m128i *)(sum + i + 4), _mm_add_epi32(_mm_loadu_si128((__m128i *)(sum + i + 4)), hi));
+	}
+#elif MIXER_USE_NEON
+	for (; i + 8 <= nwords; i += 8) {
+		int16x8_t c = vld1q_s16(contrib + i);
+		vst1q_s32(sum + i, vaddw_s16(vld1q_s32(sum + i), vget_low_s16(c)));
+		vst1q_s32(sum + i + 4, vaddw_s16(vld1q_s32(sum + i + 4), vget_high_s16(c)));
+	}
+#endif
+	for (; i < nwords; ++i) {
+		sum[i] += contrib[i];
+	}
+}
+
+/* samples[i] = saturate(gain * samples[i]) */
 static void apply_gain(int16_t *samples, int nsamples, float gain) {
-	int i;
-	for (i = 0; i < nsamples; ++i) {
+	int i = 0;
+#if MIXER_USE_AVX2
+	__m256 g = _mm256_set1_ps(gain);
+	__m256i minval = _mm256_set1_epi16(-32767);
+	for (; i + 16 <= nsamples; i += 16) {
+		__m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i)));
+		__m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(samples + i + 8)));
+		lo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), g));
+		hi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), g));
+		/* packs works on 128 bits lanes, put the 64 bits quarters back in order */
+		lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+		_mm256_storeu_si256((__m256i *)(samples + i), _mm256_max_epi16(lo, minval));
+	}
+#elif MIXER_USE_SSE2
+	__m128 g = _mm_set1_ps(gain);
+	__m128i minval = _mm_set1_epi16(-32767);
+	for (; i + 8 <= nsamples; i += 8) {
+		__m128i c = _mm_loadu_si128((const __m128i *)(samples + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(c, c), 16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(c, c), 16);
+		lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+		hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+		_mm_storeu_si128((__m128i *)(samples + i), _mm_max_epi16(_mm_packs_epi32(lo, hi), minval));
+	}
+#elif MIXER_USE_NEON
+	int16x8_t minval = vdupq_n_s16(-32767);
+	for (; i + 8 <= nsamples; i += 8) {
+		int16x8_t c = vld1q_s16(samples + i);
+		int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(c))), gain));
+		int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(c))), gain));
+		vst1q_s16(samples + i, vmaxq_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), minval));
+	}
+#endif
+	for (; i < nsamples; ++i) {
 		samples[i] = saturate((int)(gain * (float)samples[i]));
 	}
 }
 
+/* out[i] = saturate(sum[i] - own[i]), own being the optional contribution to remove from the sum (mix-minus) */
+static void mix_minus(int16_t *out, const int32_t *sum, const int16_t *own, int nwords) {
+	int i = 0;
+#if MIXER_USE_AVX2
+	__m256i minval = _mm256_set1_epi16(-32767);
+	for (; i + 16 <= nwords; i += 16) {
+		__m256i lo = _mm256_loadu_si256((const __m256i *)(sum + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i *)(sum + i + 8));
+		if (own) {
+			lo = _mm256_sub_epi32(lo, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(own + i))));
+			hi = _mm256_sub_epi32(hi, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(own + i + 8))));
+		}
+		lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_max_epi16(lo, minval));
+	}
+#elif MIXER_USE_SSE2
+	__m128i minval = _mm_set1_epi16(-32767);
+	for (; i + 8 <= nwords; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(sum + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(sum + i + 4));
+		if (own) {
+			__m128i c = _mm_loadu_si128((const __m128i *)(own + i));
+			lo = _mm_sub_epi32(lo, _mm_srai_epi32(_mm_unpacklo_epi16(c, c), 16));
+			hi = _mm_sub_epi32(hi, _mm_srai_epi32(_mm_unpackhi_epi16(c, c), 16));
+		}
+		_mm_storeu_si128((__m128i *)(out + i), _mm_max_epi16(_mm_packs_epi32(lo, hi), minval));
+	}
+#elif MIXER_USE_NEON
+	int16x8_t minval = vdupq_n_s16(-32767);
+	for (; i + 8 <= nwords; i += 8) {
+		int32x4_t lo = vld1q_s32(sum + i);
+		int32x4_t hi = vld1q_s32(sum + i + 4);
+		if (own) {
+			int16x8_t c = vld1q_s16(own + i);
+			lo = vsubw_s16(lo, vget_low_s16(c));
+			hi = vsubw_s16(hi, vget_high_s16(c));
+		}
+		vst1q_s16(out + i, vmaxq_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)), minval));
+	}
+#endif
+	if (own) {
+		for (; i < nwords; ++i) {
+			out[i] = saturate(sum[i] - (int32_t)own[i]);
+		}
+	} else {
+		for (; i < nwords; ++i) {
+			out[i] = saturate(sum[i]);
+		}
+	}
+}
+
 typedef struct Channel {
 	MSBufferizer bufferizer;
 	int16_t *input; /*the channel contribution, for removal at output*/
 	float gain;
+	float level; /*input level in dB, used to select the contributors when their number is limited*/
 	int min_fullness;
 	uint64_t last_flow_control;
 	uint64_t last_activity;
 	bool_t active;
+	bool_t contributing; /*whether the channel is part of the mix for the current tick*/
 	bool_t output_enabled;
 } Channel;
 
@@ -65,12 +187,14 @@ static void channel_init(Channel *chan) {
 	ms_bufferizer_init(&chan->bufferizer);
 	chan->input = NULL;
 	chan->gain = 1.0;
+	chan->level = MS_VOLUME_DB_LOWEST;
 	chan->active = TRUE;
+	chan->contributing = FALSE;
 	chan->output_enabled = TRUE;
 }
 
 static void channel_prepare(Channel *chan, int bytes_per_tick) {
-	chan->input = ms_malloc0(bytes_per_tick);
+	if (chan->input == NULL) chan->input = ms_malloc0(bytes_per_tick);
 	chan->last_flow_control = (uint64_t)-1;
 	chan->last_activity = (uint64_t)-1;
 }
@@ -78,7 +202,7 @@ static void channel_prepare(Channel *chan, int bytes_per_tick) {
 static int channel_process_in(Channel *chan, MSQueue *q, int32_t *sum, int nsamples) {
 	ms_bufferizer_put_from_queue(&chan->bufferizer, q);
 	if (ms_bufferizer_read(&chan->bufferizer, (uint8_t *)chan->input, nsamples * 2) != 0) {
-		if (chan->active) {
+		if (chan->contributing) {
 			if (chan->gain != 1.0) {
 				apply_gain(chan->input, nsamples, chan->gain);
 			}
@@ -111,26 +235,16 @@ static int channel_flow_control(Channel *chan, int threshold, uint64_t time) {
 }
 
 static mblk_t *channel_process_out(Channel *chan, int32_t *sum, int nsamples) {
-	int i;
 	mblk_t *om = allocb(nsamples * 2, 0);
-	int16_t *out = (int16_t *)om->b_wptr;
 
-	if (chan->active) {
-		/*remove own contribution from sum*/
-		for (i = 0; i < nsamples; ++i) {
-			out[i] = saturate(sum[i] - (int32_t)chan->input[i]);
-		}
-	} else {
-		for (i = 0; i < nsamples; ++i) {
-			out[i] = saturate(sum[i]);
-		}
-	}
+	/*remove own contribution from sum*/
+	mix_minus((int16_t *)om->b_wptr, sum, chan->input, nsamples);
 	om->b_wptr += nsamples * 2;
 	return om;
 }
 
 static void channel_unprepare(Channel *chan) {
-	ms_free(chan->input);
+	if (chan->input) ms_free(chan->input);
 	chan->input = NULL;
 }
 
@@ -145,6 +259,7 @@ typedef struct MixerState {
 	Channel channels[MIXER_MAX_CHANNELS];
 	int32_t *sum;
 	int conf_mode;
+	int max_contributors; /*in conference mode, number of loudest channels that are mixed, 0 meaning all*/
 	int skip_threshold;
 	int master_channel;
 	bool_t bypass_mode;
@@ -189,8 +304,10 @@ static void mixer_preprocess(MSFilter *f) {
 
 	s->bytespertick = (2 * s->nchannels * s->rate * f->ticker->interval) / 1000;
 	s->sum = (int32_t *)ms_malloc0((s->bytespertick / 2) * sizeof(int32_t));
-	for (i = 0; i < MIXER_MAX_CHANNELS; ++i)
-		channel_prepare(&s->channels[i], s->bytespertick);
+	for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
+		/*with many pins, only allocate the buffers of the connected ones*/
+		if (f->inputs[i] || f->outputs[i]) channel_prepare(&s->channels[i], s->bytespertick);
+	}
 	/*ms_message("bytespertick=%i, purgeoffset=%i",s->bytespertick,s->purgeoffset);*/
 	s->skip_threshold = s->bytespertick * 2;
 	s->bypass_mode = FALSE;
@@ -209,13 +326,38 @@ static void mixer_postprocess(MSFilter *f) {
 
 static mblk_t *make_output(int32_t *sum, int nwords) {
 	mblk_t *om = allocb(nwords * 2, 0);
-	int i;
-	for (i = 0; i < nwords; ++i, om->b_wptr += 2) {
-		*(int16_t *)om->b_wptr = saturate(sum[i]);
-	}
+	mix_minus((int16_t *)om->b_wptr, sum, NULL, nwords);
+	om->b_wptr += nwords * 2;
 	return om;
 }
 
+/* Select the channels contributing to the mix for this tick: all the active ones, unless their number is limited in
+ * conference mode. In that case only the max_contributors channels having the highest levels are kept.*/
+static void mixer_select_contributors(MSFilter *f, MixerState *s) {
+	int i, n;
+	int count = 0;
+
+	for (i = 0; i < f->desc->ninputs; ++i) {
+		Channel *chan = &s->channels[i];
+		chan->contributing = (f->inputs[i] != NULL && chan->active);
+		if (chan->contributing) count++;
+	}
+	if (!s->conf_mode || s->max_contributors <= 0 || count <= s->max_contributors) return;
+
+	for (i = 0; i < f->desc->ninputs; ++i)
+		s->channels[i].contributing = FALSE;
+	for (n = 0; n < s->max_contributors; ++n) {
+		Channel *loudest = NULL;
+		for (i = 0; i < f->desc->ninputs; ++i) {
+			Channel *chan = &s->channels[i];
+			if (f->inputs[i] == NULL || !chan->active || chan->contributing) continue;
+			if (loudest == NULL || chan->level > loudest->level) loudest = chan;
+		}
+		if (loudest == NULL) break;
+		loudest->contributing = TRUE;
+	}
+}
+
 static void mixer_dispatch_output(MSFilter *f, MixerState *s, MSQueue *inq, int active_input) {
 	int i;
 	for (i = 0; i < f->desc->noutputs; i++) {
@@ -245,12 +387,18 @@ static bool_t mixer_check_bypass(MSFilter *f, MixerState *s) {
 	int i;
 	int active_cnt = 0;
 	int active_input = -1;
+	int inactive_cnt = 0;
 	MSQueue *activeq = NULL;
 	uint64_t curtime = f->ticker->time;
 	for (i = 0; i < f->desc->ninputs; i++) {
 		MSQueue *q = f->inputs[i];
 		if (q) {
 			Channel *chan = &s->channels[i];
+			if (!chan->active) {
+				/*an inactive channel is never dispatched, its owner may be listening to a mix shared with others*/
+				if (!ms_queue_empty(q)) inactive_cnt++;
+				continue;
+			}
 			if (!ms_queue_empty(q)) {
 				chan->last_activity = curtime;
 				activeq = q;
@@ -272,9 +420,12 @@ static bool_t mixer_check_bypass(MSFilter *f, MixerState *s) {
 			s->bypass_mode = TRUE;
 			ms_message("MSAudioMixer [%p] is entering bypass mode.", f);
 		}
+		for (i = 0; inactive_cnt > 0 && i < f->desc->ninputs; i++) {
+			if (f->inputs[i] && !s->channels[i].active) ms_queue_flush(f->inputs[i]);
+		}
 		mixer_dispatch_output(f, s, activeq, active_input);
 		return TRUE;
-	} else if (active_cnt > 1) {
+	} else if (active_cnt > 1 || inactive_cnt > 0) {
 		if (s->bypass_mode) {
 			s->bypass_mode = FALSE;
 			ms_message("MSAudioMixer [%p] is leaving bypass mode.", f);
@@ -299,12 +450,14 @@ static void mixer_process(MSFilter *f) {
 	}
 
 	memset(s->sum, 0, nwords * sizeof(int32_t));
+	mixer_select_contributors(f, s);
 
 	/* read from all inputs and sum everybody */
 	for (i = 0; i < f->desc->ninputs; ++i) {
 		MSQueue *q = f->inputs[i];
 
 		if (q) {
+			if (s->channels[i].input == NULL) channel_prepare(&s->channels[i], s->bytespertick);
 			if (channel_process_in(&s->channels[i], q, s->sum, nwords)) got_something = TRUE;
 			if ((skip = channel_flow_control(&s->channels[i], s->skip_threshold, f->ticker->time)) > 0) {
 				ms_warning("Too much data in channel %i, %i ms in excess dropped", i,
@@ -315,8 +468,8 @@ static void mixer_process(MSFilter *f) {
 #ifdef ALWAYS_STREAMOUT
 	got_something = TRUE;
 #endif
-	/* compute outputs. In conference mode each one has a different output, because its channel own contribution has to
-	 * be removed*/
+	/* compute outputs. In conference mode each contributor has a different output, because its channel own
+	 * contribution has to be removed. The channels that do not contribute all receive the same mix.*/
 	if (got_something) {
 		if (s->conf_mode == 0) {
 			mblk_t *om = NULL;
@@ -333,11 +486,17 @@ static void mixer_process(MSFilter *f) {
 				}
 			}
 		} else {
+			mblk_t *common = NULL;
 			for (i = 0; i < MIXER_MAX_CHANNELS; ++i) {
 				MSQueue *q = f->outputs[i];
 				Channel *chan = &s->channels[i];
 				if (q && chan->output_enabled) {
-					ms_queue_put(q, channel_process_out(&s->channels[i], s->sum, nwords));
+					if (chan->contributing && chan->input) {
+						ms_queue_put(q, channel_process_out(chan, s->sum, nwords));
+					} else {
+						common = common ? dupb(common) : make_output(s->sum, nwords);
+						ms_queue_put(q, common);
+					}
 				}
 			}
 		}
@@ -411,6 +570,27 @@ static int mixer_set_conference_mode(MSFilter *f, void *data) {
 	return 0;
 }
 
+static int mixer_set_max_contributors(MSFilter *f, void *data) {
+	MixerState *s = (MixerState *)f->data;
+	ms_filter_lock(f);
+	s->max_contributors = *(int *)data;
+	ms_filter_unlock(f);
+	return 0;
+}
+
+static int mixer_set_input_level(MSFilter *f, void *data) {
+	MixerState *s = (MixerState *)f->data;
+	MSAudioMixerCtl *ctl = (MSAudioMixerCtl *)data;
+	if (ctl->pin < 0 || ctl->pin >= MIXER_MAX_CHANNELS) {
+		ms_warning("mixer_set_input_level: invalid pin number %i", ctl->pin);
+		return -1;
+	}
+	ms_filter_lock(f);
+	s->channels[ctl->pin].level = ctl->param.level;
+	ms_filter_unlock(f);
+	return 0;
+}
+
 /*not implemented yet. A master channel is a channel that is used as a reference to mix other inputs. Samples from the
  * master channel should never be dropped*/
 static int mixer_set_master_channel(MSFilter *f, void *data) {
@@ -428,6 +608,8 @@ static MSFilterMethod methods[] = {{MS_FILTER_SET_NCHANNELS, mixer_set_nchannels
                                    {MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, mixer_set_conference_mode},
                                    {MS_AUDIO_MIXER_SET_MASTER_CHANNEL, mixer_set_master_channel},
                                    {MS_AUDIO_MIXER_ENABLE_OUTPUT, mixer_enable_output},
+                                   {MS_AUDIO_MIXER_SET_MAX_CONTRIBUTORS, mixer_set_max_contributors},
+                                   {MS_AUDIO_MIXER_SET_INPUT_LEVEL, mixer_set_input_level},
                                    {0, NULL}};
 
 #ifdef _MSC_VER
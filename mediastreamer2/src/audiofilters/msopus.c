@@ -660,6 +660,22 @@ static int ms_opus_enc_get_capabilities(BCTBX_UNUSED(MSFilter *f), void *arg) {
 	return 0;
 }
 
+static int ms_opus_enc_reset(MSFilter *f, BCTBX_UNUSED(void *arg)) {
+	OpusEncData *d = (OpusEncData *)f->data;
+	int error;
+
+	ms_filter_lock(f);
+	ms_bufferizer_flush(d->bufferizer);
+	if (d->state) {
+		error = opus_encoder_ctl(d->state, OPUS_RESET_STATE);
+		if (error != OPUS_OK) {
+			ms_error("could not reset opus encoder: %s", opus_strerror(error));
+		}
+	}
+	ms_filter_unlock(f);
+	return 0;
+}
+
 static MSFilterMethod ms_opus_enc_methods[] = {{MS_FILTER_SET_SAMPLE_RATE, ms_opus_enc_set_sample_rate},
                                                {MS_FILTER_GET_SAMPLE_RATE, ms_opus_enc_get_sample_rate},
                                                {MS_FILTER_SET_BITRATE, ms_opus_enc_set_bitrate},
@@ -670,6 +686,7 @@ static MSFilterMethod ms_opus_enc_methods[] = {{MS_FILTER_SET_SAMPLE_RATE, ms_op
                                                {MS_FILTER_SET_NCHANNELS, ms_opus_enc_set_nchannels},
                                                {MS_FILTER_GET_NCHANNELS, ms_opus_enc_get_nchannels},
                                                {MS_AUDIO_ENCODER_GET_CAPABILITIES, ms_opus_enc_get_capabilities},
+                                               {MS_AUDIO_ENCODER_RESET, ms_opus_enc_reset},
                                                {0, NULL}};
 
 /******************************************************************************
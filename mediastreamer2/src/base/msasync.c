@@ -255,3 +255,195 @@ void ms_worker_thread_destroy(MSWorkerThread *obj, bool_t finish_tasks) {
 	if (obj->name) bctbx_free(obj->name);
 	ms_free(obj);
 }
+
+typedef struct _MSWorkerQueueTask {
+	MSTaskFunc func;
+	void *data;
+	uint64_t queued_at; /* in microseconds */
+} MSWorkerQueueTask;
+
+struct _MSWorkerQueue {
+	MSWorkerPool *pool;
+	bctbx_list_t *tasks;
+	bool_t running; /* TRUE while a worker executes a task of this queue */
+	bool_t own_pool;
+};
+
+struct _MSWorkerPool {
+	ms_mutex_t mutex;
+	ms_cond_t cond;      /* signaled when a queue becomes ready */
+	ms_cond_t done_cond; /* signaled when a task is done, for threads destroying a queue */
+	ms_thread_t *threads;
+	int nworkers;
+	char *name;
+	bctbx_list_t *ready_queues; /* queues having tasks and not running, in the order they must be served */
+	int queue_count;
+	int destroy_wait_count;
+	bool_t running;
+	/* statistics */
+	int pending_tasks;
+	int max_pending_tasks;
+	uint64_t executed_tasks;
+	uint64_t total_wait_time;
+	uint64_t max_wait_time;
+	uint64_t total_run_time;
+};
+
+static uint64_t ms_worker_pool_get_time_us(void) {
+	bctoolboxTimeSpec ts;
+	bctbx_get_cur_time(&ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void *ms_worker_pool_run(void *d) {
+	MSWorkerPool *obj = (MSWorkerPool *)d;
+
+	if (obj->name) bctbx_set_self_thread_name(obj->name);
+
+	ms_mutex_lock(&obj->mutex);
+	while (obj->running) {
+		MSWorkerQueue *queue;
+		MSWorkerQueueTask *task;
+		uint64_t start_time, wait_time;
+
+		if (obj->ready_queues == NULL) {
+			ms_cond_wait(&obj->cond, &obj->mutex);
+			continue;
+		}
+		queue = (MSWorkerQueue *)obj->ready_queues->data;
+		obj->ready_queues = bctbx_list_erase_link(obj->ready_queues, obj->ready_queues);
+		task = (MSWorkerQueueTask *)queue->tasks->data;
+		queue->tasks = bctbx_list_erase_link(queue->tasks, queue->tasks);
+		queue->running = TRUE;
+		obj->pending_tasks--;
+
+		start_time = ms_worker_pool_get_time_us();
+		wait_time = start_time - task->queued_at;
+		obj->total_wait_time += wait_time;
+		if (wait_time > obj->max_wait_time) obj->max_wait_time = wait_time;
+
+		ms_mutex_unlock(&obj->mutex);
+		task->func(task->data);
+		ms_free(task);
+		ms_mutex_lock(&obj->mutex);
+
+		obj->total_run_time += ms_worker_pool_get_time_us() - start_time;
+		obj->executed_tasks++;
+		queue->running = FALSE;
+		/* go to the back of the line, so that a busy queue does not starve the others */
+		if (queue->tasks) obj->ready_queues = bctbx_list_append(obj->ready_queues, queue);
+		if (obj->destroy_wait_count != 0) ms_cond_broadcast(&obj->done_cond);
+	}
+	ms_mutex_unlock(&obj->mutex);
+	return NULL;
+}
+
+MSWorkerPool *ms_worker_pool_new(const char *name, int nworkers) {
+	MSWorkerPool *obj = ms_new0(MSWorkerPool, 1);
+	int i;
+	ms_mutex_init(&obj->mutex, NULL);
+	ms_cond_init(&obj->cond, NULL);
+	ms_cond_init(&obj->done_cond, NULL);
+	obj->running = TRUE;
+	obj->name = bctbx_strdup(name);
+	obj->nworkers = MAX(nworkers, 1);
+	obj->threads = ms_new0(ms_thread_t, obj->nworkers);
+	for (i = 0; i < obj->nworkers; i++) {
+		ms_thread_create(&obj->threads[i], NULL, ms_worker_pool_run, obj);
+	}
+	return obj;
+}
+
+void ms_worker_pool_get_stats(MSWorkerPool *obj, MSWorkerPoolStats *stats) {
+	ms_mutex_lock(&obj->mutex);
+	stats->worker_count = obj->nworkers;
+	stats->queue_count = obj->queue_count;
+	stats->pending_tasks = obj->pending_tasks;
+	stats->max_pending_tasks = obj->max_pending_tasks;
+	stats->executed_tasks = obj->executed_tasks;
+	stats->mean_wait_time =
+	    obj->executed_tasks ? (float)((double)obj->total_wait_time / (double)obj->executed_tasks / 1000.0) : 0.0f;
+	stats->max_wait_time = (float)((double)obj->max_wait_time / 1000.0);
+	stats->mean_run_time =
+	    obj->executed_tasks ? (float)((double)obj->total_run_time / (double)obj->executed_tasks / 1000.0) : 0.0f;
+	ms_mutex_unlock(&obj->mutex);
+}
+
+void ms_worker_pool_destroy(MSWorkerPool *obj) {
+	int i;
+	ms_mutex_lock(&obj->mutex);
+	if (obj->queue_count != 0) {
+		/*should never happen*/
+		ms_error("ms_async.c: worker pool [%s] destroyed with %i queues left.", obj->name, obj->queue_count);
+	}
+	obj->running = FALSE;
+	ms_cond_broadcast(&obj->cond);
+	ms_mutex_unlock(&obj->mutex);
+	for (i = 0; i < obj->nworkers; i++) {
+		ms_thread_join(obj->threads[i], NULL);
+	}
+	ms_free(obj->threads);
+	bctbx_list_free(obj->ready_queues);
+	ms_mutex_destroy(&obj->mutex);
+	ms_cond_destroy(&obj->cond);
+	ms_cond_destroy(&obj->done_cond);
+	if (obj->name) bctbx_free(obj->name);
+	ms_free(obj);
+}
+
+MSWorkerQueue *ms_worker_queue_new(MSWorkerPool *pool) {
+	MSWorkerQueue *obj = ms_new0(MSWorkerQueue, 1);
+	obj->pool = pool;
+	ms_mutex_lock(&pool->mutex);
+	pool->queue_count++;
+	ms_mutex_unlock(&pool->mutex);
+	return obj;
+}
+
+MSWorkerQueue *ms_worker_queue_new_standalone(const char *name) {
+	MSWorkerQueue *obj = ms_worker_queue_new(ms_worker_pool_new(name, 1));
+	obj->own_pool = TRUE;
+	return obj;
+}
+
+void ms_worker_queue_add_task(MSWorkerQueue *obj, MSTaskFunc func, void *data) {
+	MSWorkerPool *pool = obj->pool;
+	MSWorkerQueueTask *task = ms_new0(MSWorkerQueueTask, 1);
+	task->func = func;
+	task->data = data;
+	task->queued_at = ms_worker_pool_get_time_us();
+
+	ms_mutex_lock(&pool->mutex);
+	/* a running queue is made ready again by the worker once its current task is done */
+	if (obj->tasks == NULL && !obj->running) {
+		pool->ready_queues = bctbx_list_append(pool->ready_queues, obj);
+		ms_cond_signal(&pool->cond);
+	}
+	obj->tasks = bctbx_list_append(obj->tasks, task);
+	pool->pending_tasks++;
+	if (pool->pending_tasks > pool->max_pending_tasks) pool->max_pending_tasks = pool->pending_tasks;
+	ms_mutex_unlock(&pool->mutex);
+}
+
+void ms_worker_queue_destroy(MSWorkerQueue *obj, bool_t finish_tasks) {
+	MSWorkerPool *pool = obj->pool;
+
+	ms_mutex_lock(&pool->mutex);
+	if (!finish_tasks && obj->tasks) {
+		pool->pending_tasks -= (int)bctbx_list_size(obj->tasks);
+		obj->tasks = bctbx_list_free_with_data(obj->tasks, ms_free);
+		/* a running queue is not in the ready list */
+		bctbx_list_t *elem = bctbx_list_find(pool->ready_queues, obj);
+		if (elem) pool->ready_queues = bctbx_list_erase_link(pool->ready_queues, elem);
+	}
+	pool->destroy_wait_count++;
+	while (obj->running || obj->tasks) {
+		ms_cond_wait(&pool->done_cond, &pool->mutex);
+	}
+	pool->destroy_wait_count--;
+	pool->queue_count--;
+	ms_mutex_unlock(&pool->mutex);
+
+	if (obj->own_pool) ms_worker_pool_destroy(pool);
+	ms_free(obj);
+}
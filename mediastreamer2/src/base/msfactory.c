@@ -34,8 +34,10 @@
 #endif
 
 #include "basedescs.h"
+#include "mediastreamer2/msasync.h"
 #include "mediastreamer2/mseventqueue.h"
 #include "mediastreamer2/msfilter.h"
+#include "mediastreamer2/msticker.h"
 #include "mediastreamer2/msvideo.h"
 #include "mediastreamer2/mswebcam.h"
 
@@ -998,6 +1000,46 @@ int ms_factory_get_expected_bandwidth(MSFactory *f) {
 	return f->expected_video_bandwidth;
 }
 
+void ms_factory_enable_ticker_pool(MSFactory *obj, bool_t enabled, int nworkers) {
+	if (obj->ticker_pool) {
+		ms_ticker_pool_destroy(obj->ticker_pool);
+		obj->ticker_pool = NULL;
+	}
+	if (enabled) {
+		if (nworkers <= 0) nworkers = (int)obj->cpu_count;
+		obj->ticker_pool = ms_ticker_pool_new(nworkers, MS_TICKER_PRIO_HIGH, "MSTickerPool");
+	}
+}
+
+MSTickerPool *ms_factory_get_ticker_pool(MSFactory *obj) {
+	return obj->ticker_pool;
+}
+
+MSTicker *ms_factory_create_ticker(MSFactory *obj, const MSTickerParams *params) {
+	if (obj->ticker_pool) return ms_ticker_new_in_pool(obj->ticker_pool, params);
+	return ms_ticker_new_with_params(params);
+}
+
+void ms_factory_enable_codec_worker_pool(MSFactory *obj, bool_t enabled, int nworkers) {
+	if (obj->codec_worker_pool) {
+		ms_worker_pool_destroy(obj->codec_worker_pool);
+		obj->codec_worker_pool = NULL;
+	}
+	if (enabled) {
+		if (nworkers <= 0) nworkers = (int)obj->cpu_count;
+		obj->codec_worker_pool = ms_worker_pool_new("MSCodecPool", nworkers);
+	}
+}
+
+MSWorkerPool *ms_factory_get_codec_worker_pool(MSFactory *obj) {
+	return obj->codec_worker_pool;
+}
+
+MSWorkerQueue *ms_factory_create_codec_worker_queue(MSFactory *obj, const char *name) {
+	if (obj->codec_worker_pool) return ms_worker_queue_new(obj->codec_worker_pool);
+	return ms_worker_queue_new_standalone(name);
+}
+
 const char *ms_factory_get_default_video_renderer(BCTBX_UNUSED(MSFactory *f)) {
 #if defined(MS2_WINDOWS_PHONE)
 	return "MSWP8Dis";
@@ -1139,6 +1181,8 @@ void ms_factory_destroy(MSFactory *factory) {
 	if (factory->plugins_dir) ms_free(factory->plugins_dir);
 	if (factory->image_resources_dir) ms_free(factory->image_resources_dir);
 	if (factory->wbcmanager) ms_web_cam_manager_destroy(factory->wbcmanager);
+	if (factory->ticker_pool) ms_ticker_pool_destroy(factory->ticker_pool);
+	if (factory->codec_worker_pool) ms_worker_pool_destroy(factory->codec_worker_pool);
 	ms_free(factory);
 	if (factory == fallback_factory) fallback_factory = NULL;
 }
@@ -50,12 +50,19 @@ static uint64_t get_cur_time_ms(void *);
 static int wait_next_tick(void *, uint64_t virt_ticker_time);
 static void remove_tasks_for_filter(MSTicker *ticker, MSFilter *f);
 
+static void ms_ticker_pool_add(MSTickerPool *pool, MSTicker *ticker);
+static void ms_ticker_pool_remove(MSTickerPool *pool, MSTicker *ticker);
+
 static void ms_ticker_start(MSTicker *s) {
 	s->run = TRUE;
+	if (s->pool) {
+		ms_ticker_pool_add(s->pool, s);
+		return;
+	}
 	ms_thread_create(&s->thread, NULL, ms_ticker_run, s);
 }
 
-static void ms_ticker_init(MSTicker *ticker, const MSTickerParams *params) {
+static void ms_ticker_init(MSTicker *ticker, const MSTickerParams *params, MSTickerPool *pool) {
 	ms_mutex_init(&ticker->lock, NULL);
 	ms_mutex_init(&ticker->cur_time_lock, NULL);
 	ticker->execution_list = NULL;
@@ -76,6 +83,10 @@ static void ms_ticker_init(MSTicker *ticker, const MSTickerParams *params) {
 	ticker->late_event.time = 0;
 	ticker->late_event.current_late_ms = 0;
 	ticker->creator_tags = bctbx_create_log_tags_copy();
+	ticker->pool = pool;
+	ticker->pool_deadline = 0;
+	ticker->pool_worker = -1;
+	ticker->pool_running = FALSE;
 	ms_ticker_start(ticker);
 }
 
@@ -88,11 +99,21 @@ MSTicker *ms_ticker_new() {
 
 MSTicker *ms_ticker_new_with_params(const MSTickerParams *params) {
 	MSTicker *obj = (MSTicker *)ms_new0(MSTicker, 1);
-	ms_ticker_init(obj, params);
+	ms_ticker_init(obj, params, NULL);
+	return obj;
+}
+
+MSTicker *ms_ticker_new_in_pool(MSTickerPool *pool, const MSTickerParams *params) {
+	MSTicker *obj = (MSTicker *)ms_new0(MSTicker, 1);
+	ms_ticker_init(obj, params, pool);
 	return obj;
 }
 
 static void ms_ticker_stop(MSTicker *s) {
+	if (s->pool) {
+		ms_ticker_pool_remove(s->pool, s);
+		return;
+	}
 	ms_mutex_lock(&s->lock);
 	s->run = FALSE;
 	ms_mutex_unlock(&s->lock);
@@ -327,9 +348,8 @@ static uint64_t get_cur_time_ms(BCTBX_UNUSED(void *unused)) {
 	return ms_get_cur_time_ms();
 }
 
-static int set_high_prio(MSTicker *obj) {
+static int set_high_prio(MSTickerPrio prio, const char *name) {
 	int precision = 2;
-	int prio = obj->prio;
 
 	if (prio > MS_TICKER_PRIO_NORMAL) {
 #ifdef _WIN32
@@ -353,7 +373,7 @@ static int set_high_prio(MSTicker *obj) {
 			ms_warning("SetThreadPriority() failed (%d)\n", (int)GetLastError());
 		}
 #else
-		ms_warning("SetThreadPriority() is not implemented. %s priority left to normal.", obj->name);
+		ms_warning("SetThreadPriority() is not implemented. %s priority left to normal.", name);
 #endif
 #else
 		struct sched_param param;
@@ -384,17 +404,17 @@ static int set_high_prio(MSTicker *obj) {
 				   thread is to use setpriority().
 				*/
 				if (setpriority(PRIO_PROCESS, 0, -19) == -1) {
-					ms_message("%s setpriority() failed: %s, nevermind.", obj->name, strerror(errno));
+					ms_message("%s setpriority() failed: %s, nevermind.", name, strerror(errno));
 				} else {
-					ms_message("%s priority increased nearly to maximum (-19).", obj->name);
+					ms_message("%s priority increased nearly to maximum (-19).", name);
 				}
-			} else ms_warning("%s: Set pthread_setschedparam failed: %s", obj->name, strerror(result));
+			} else ms_warning("%s: Set pthread_setschedparam failed: %s", name, strerror(result));
 		} else {
-			ms_message("%s priority set to %s and value (%i)", obj->name,
+			ms_message("%s priority set to %s and value (%i)", name,
 			           policy == SCHED_FIFO ? "SCHED_FIFO" : "SCHED_RR", param.sched_priority);
 		}
 #endif
-	} else ms_message("%s priority left to normal.", obj->name);
+	} else ms_message("%s priority left to normal.", name);
 	return precision;
 }
 
@@ -444,6 +464,25 @@ static int wait_next_tick(void *data, BCTBX_UNUSED(uint64_t virt_ticker_time)) {
 	return late;
 }
 
+/*runs the tasks and graphs of one tick. Must be called with the ticker lock held*/
+static void ms_ticker_process_tick(MSTicker *s) {
+#if TICKER_MEASUREMENTS
+	MSTimeSpec begin, end; /*used to measure time spent in processing one tick*/
+	double iload;
+
+	ms_get_cur_time(&begin);
+#endif
+	s->ticks++;
+	run_tasks(s);
+	run_graphs(s, s->execution_list, FALSE);
+#if TICKER_MEASUREMENTS
+	ms_get_cur_time(&end);
+	iload = 100 * ((end.tv_sec - begin.tv_sec) * 1000.0 + (end.tv_nsec - begin.tv_nsec) / 1000000.0) /
+	        (double)s->interval;
+	s->av_load = (smooth_coef * s->av_load) + ((1.0 - smooth_coef) * iload);
+#endif
+}
+
 /*the ticker thread function that executes the filters */
 void *ms_ticker_run(void *arg) {
 	MSTicker *s = (MSTicker *)arg;
@@ -462,7 +501,7 @@ void *ms_ticker_run(void *arg) {
 	ms_mutex_lock(&s->lock);
 	bctbx_set_self_thread_name(s->name);
 
-	precision = set_high_prio(s);
+	precision = set_high_prio(s->prio, s->name);
 	s->thread_id = ms_thread_self();
 	s->ticks = 1;
 	ms_mutex_lock(&s->cur_time_lock);
@@ -472,24 +511,8 @@ void *ms_ticker_run(void *arg) {
 	while (s->run) {
 		uint64_t late_tick_time = 0, current_time;
 
-		s->ticks++;
 		/*Step 1: run the graphs*/
-		{
-#if TICKER_MEASUREMENTS
-			MSTimeSpec begin, end; /*used to measure time spent in processing one tick*/
-			double iload;
-
-			ms_get_cur_time(&begin);
-#endif
-			run_tasks(s);
-			run_graphs(s, s->execution_list, FALSE);
-#if TICKER_MEASUREMENTS
-			ms_get_cur_time(&end);
-			iload = 100 * ((end.tv_sec - begin.tv_sec) * 1000.0 + (end.tv_nsec - begin.tv_nsec) / 1000000.0) /
-			        (double)s->interval;
-			s->av_load = (smooth_coef * s->av_load) + ((1.0 - smooth_coef) * iload);
-#endif
-		}
+		ms_ticker_process_tick(s);
 		ms_mutex_unlock(&s->lock);
 		/*Step 2: wait for next tick*/
 		s->time += s->interval;
@@ -538,6 +561,11 @@ void ms_ticker_set_time_func(MSTicker *ticker, MSTickerTimeFunc func, void *user
 }
 
 void ms_ticker_set_tick_func(MSTicker *ticker, MSTickerTickFunc func, void *user_data) {
+	if (ticker->pool) {
+		ms_error("ms_ticker_set_tick_func(): ticker [%s] is run by a ticker pool, it cannot have a custom tick method.",
+		         ticker->name);
+		return;
+	}
 	if (func == NULL) {
 		func = wait_next_tick;
 		user_data = ticker;
@@ -611,6 +639,251 @@ void ms_ticker_get_last_late_tick(MSTicker *ticker, MSTickerLateEvent *ev) {
 	if (need_lock) ms_mutex_unlock(&ticker->lock);
 }
 
+/*
+ * Ticker pool.
+ * Each ticker of the pool is attached to a worker (its "home"), in whose run queue it is kept sorted by the wall clock
+ * time of its next tick. A worker runs the due tickers of its own run queue first, then steals due tickers from the
+ * other workers' queues. A ticker picked by a worker is removed from its queue while its tick is executed, so that it
+ * is never run concurrently by two workers, then it is put back in the run queue of its home worker.
+ */
+
+typedef struct _MSTickerPoolWorker {
+	MSTickerPool *pool;
+	ms_mutex_t lock; /* protects the run_queue, and the pool_* fields of the tickers attached to this worker */
+	ms_cond_t cond;  /* signaled when a ticker attached to this worker has finished a tick */
+	bctbx_list_t *run_queue;
+	ms_thread_t thread;
+	int index;
+	int nb_tickers;
+	bool_t run;
+} MSTickerPoolWorker;
+
+struct _MSTickerPool {
+	MSTickerPoolWorker *workers;
+	int nworkers;
+	char *name;
+	MSTickerPrio prio;
+};
+
+static int ms_ticker_pool_compare_deadlines(const void *a, const void *b) {
+	const MSTicker *ta = (const MSTicker *)a;
+	const MSTicker *tb = (const MSTicker *)b;
+	/* never return 0, so that a ticker is queued after the ones having the same deadline */
+	return ta->pool_deadline < tb->pool_deadline ? -1 : 1;
+}
+
+/* compute the wall clock time at which the next tick of the ticker is due, using the ticker's own time base */
+static uint64_t ms_ticker_pool_compute_deadline(MSTicker *s, uint64_t now, int *late) {
+	uint64_t realtime;
+	int64_t diff;
+
+	ms_mutex_lock(&s->cur_time_lock);
+	realtime = s->get_cur_time_ptr(s->get_cur_time_data) - s->orig;
+	ms_mutex_unlock(&s->cur_time_lock);
+	diff = (int64_t)s->time - (int64_t)realtime;
+	if (late) *late = diff < 0 ? (int)-diff : 0;
+	return diff > 0 ? now + (uint64_t)diff : now;
+}
+
+static void ms_ticker_pool_add(MSTickerPool *pool, MSTicker *ticker) {
+	MSTickerPoolWorker *w = NULL;
+	int i;
+
+	int min_tickers = 0;
+
+	/* attach the ticker to the worker having the least tickers */
+	for (i = 0; i < pool->nworkers; i++) {
+		int nb_tickers;
+		ms_mutex_lock(&pool->workers[i].lock);
+		nb_tickers = pool->workers[i].nb_tickers;
+		ms_mutex_unlock(&pool->workers[i].lock);
+		if (w == NULL || nb_tickers < min_tickers) {
+			w = &pool->workers[i];
+			min_tickers = nb_tickers;
+		}
+	}
+	ms_mutex_lock(&ticker->cur_time_lock);
+	ticker->orig = ticker->get_cur_time_ptr(ticker->get_cur_time_data);
+	ms_mutex_unlock(&ticker->cur_time_lock);
+
+	ms_mutex_lock(&w->lock);
+	ticker->pool_worker = w->index;
+	ticker->pool_deadline = ms_get_cur_time_ms();
+	w->nb_tickers++;
+	w->run_queue = bctbx_list_insert_sorted(w->run_queue, ticker, ms_ticker_pool_compare_deadlines);
+	ms_mutex_unlock(&w->lock);
+	ms_message("MSTicker [%s] attached to worker %i of ticker pool [%s]", ticker->name, w->index, pool->name);
+}
+
+static void ms_ticker_pool_remove(MSTickerPool *pool, MSTicker *ticker) {
+	MSTickerPoolWorker *w;
+
+	if (ticker->pool_worker < 0) return;
+	w = &pool->workers[ticker->pool_worker];
+	ms_mutex_lock(&w->lock);
+	ticker->run = FALSE;
+	while (ticker->pool_running) {
+		/* a worker is executing a tick, wait for its completion */
+		ms_cond_wait(&w->cond, &w->lock);
+	}
+	w->run_queue = bctbx_list_remove(w->run_queue, ticker);
+	w->nb_tickers--;
+	ticker->pool_worker = -1;
+	ms_mutex_unlock(&w->lock);
+}
+
+/* pop the first ticker of the worker's run queue if it is due, otherwise update next_deadline */
+static MSTicker *ms_ticker_pool_worker_pop(MSTickerPoolWorker *w, uint64_t now, uint64_t *next_deadline) {
+	MSTicker *t = NULL;
+
+	ms_mutex_lock(&w->lock);
+	if (w->run_queue) {
+		MSTicker *first = (MSTicker *)w->run_queue->data;
+		if (first->pool_deadline <= now) {
+			w->run_queue = bctbx_list_erase_link(w->run_queue, w->run_queue);
+			first->pool_running = TRUE;
+			t = first;
+		} else if (first->pool_deadline < *next_deadline) {
+			*next_deadline = first->pool_deadline;
+		}
+	}
+	ms_mutex_unlock(&w->lock);
+	return t;
+}
+
+static void ms_ticker_pool_run_tick(MSTicker *s) {
+	uint64_t current_time;
+	int late;
+
+	ms_mutex_lock(&s->lock);
+	s->thread_id = ms_thread_self();
+	ms_ticker_process_tick(s);
+	s->time += s->interval;
+	current_time = ms_get_cur_time_ms();
+	s->pool_deadline = ms_ticker_pool_compute_deadline(s, current_time, &late);
+	if (late > s->interval * 5 && late > s->late_event.current_late_ms) {
+		if (current_time > s->late_event.time + 1000) {
+			ms_warning("%s: We are late of %d miliseconds.", s->name, late);
+		}
+		s->late_event.lateMs = late;
+		s->late_event.time = current_time;
+	}
+	s->late_event.current_late_ms = late;
+	s->thread_id = 0;
+	ms_mutex_unlock(&s->lock);
+}
+
+static void ms_ticker_pool_requeue(MSTickerPool *pool, MSTicker *s) {
+	MSTickerPoolWorker *home = &pool->workers[s->pool_worker];
+
+	ms_mutex_lock(&home->lock);
+	s->pool_running = FALSE;
+	if (s->run) {
+		home->run_queue = bctbx_list_insert_sorted(home->run_queue, s, ms_ticker_pool_compare_deadlines);
+	}
+	ms_cond_broadcast(&home->cond);
+	ms_mutex_unlock(&home->lock);
+}
+
+static void *ms_ticker_pool_worker_run(void *arg) {
+	MSTickerPoolWorker *w = (MSTickerPoolWorker *)arg;
+	MSTickerPool *pool = w->pool;
+	char name[64] = {0};
+	int precision;
+	bool_t run = TRUE;
+
+	snprintf(name, sizeof(name) - 1, "%s %i", pool->name, w->index);
+	bctbx_set_self_thread_name(name);
+	precision = set_high_prio(pool->prio, name);
+
+	while (run) {
+		uint64_t now = ms_get_cur_time_ms();
+		uint64_t next_deadline = now + TICKER_INTERVAL;
+		MSTicker *t;
+		int i;
+
+		/* own run queue first, then steal from the other workers */
+		t = ms_ticker_pool_worker_pop(w, now, &next_deadline);
+		for (i = 1; t == NULL && i < pool->nworkers; i++) {
+			t = ms_ticker_pool_worker_pop(&pool->workers[(w->index + i) % pool->nworkers], now, &next_deadline);
+		}
+		if (t) {
+			ms_ticker_pool_run_tick(t);
+			ms_ticker_pool_requeue(pool, t);
+		} else if (next_deadline > now) {
+			bctbx_sleep_ms((int)(next_deadline - now));
+		}
+		ms_mutex_lock(&w->lock);
+		run = w->run;
+		ms_mutex_unlock(&w->lock);
+	}
+	unset_high_prio(precision);
+	ms_message("%s thread exiting", name);
+	return NULL;
+}
+
+MSTickerPool *ms_ticker_pool_new(int nworkers, MSTickerPrio prio, const char *name) {
+	MSTickerPool *pool = ms_new0(MSTickerPool, 1);
+	int i;
+
+	if (nworkers <= 0) nworkers = 1;
+	pool->nworkers = nworkers;
+	pool->prio = prio;
+	pool->name = ms_strdup(name ? name : "MSTickerPool");
+	pool->workers = ms_new0(MSTickerPoolWorker, nworkers);
+	for (i = 0; i < nworkers; i++) {
+		MSTickerPoolWorker *w = &pool->workers[i];
+		w->pool = pool;
+		w->index = i;
+		w->run = TRUE;
+		ms_mutex_init(&w->lock, NULL);
+		ms_cond_init(&w->cond, NULL);
+	}
+	for (i = 0; i < nworkers; i++) {
+		ms_thread_create(&pool->workers[i].thread, NULL, ms_ticker_pool_worker_run, &pool->workers[i]);
+	}
+	ms_message("Ticker pool [%s] created with %i workers", pool->name, nworkers);
+	return pool;
+}
+
+int ms_ticker_pool_get_worker_count(const MSTickerPool *pool) {
+	return pool->nworkers;
+}
+
+int ms_ticker_pool_get_ticker_count(MSTickerPool *pool) {
+	int i, count = 0;
+	for (i = 0; i < pool->nworkers; i++) {
+		ms_mutex_lock(&pool->workers[i].lock);
+		count += pool->workers[i].nb_tickers;
+		ms_mutex_unlock(&pool->workers[i].lock);
+	}
+	return count;
+}
+
+void ms_ticker_pool_destroy(MSTickerPool *pool) {
+	int i;
+
+	if (ms_ticker_pool_get_ticker_count(pool) > 0) {
+		ms_error("Ticker pool [%s] destroyed while still running tickers. This is a programming mistake.", pool->name);
+	}
+	for (i = 0; i < pool->nworkers; i++) {
+		ms_mutex_lock(&pool->workers[i].lock);
+		pool->workers[i].run = FALSE;
+		ms_mutex_unlock(&pool->workers[i].lock);
+	}
+	for (i = 0; i < pool->nworkers; i++) {
+		ms_thread_join(pool->workers[i].thread, NULL);
+	}
+	for (i = 0; i < pool->nworkers; i++) {
+		bctbx_list_free(pool->workers[i].run_queue);
+		ms_mutex_destroy(&pool->workers[i].lock);
+		ms_cond_destroy(&pool->workers[i].cond);
+	}
+	ms_free(pool->workers);
+	ms_free(pool->name);
+	ms_free(pool);
+}
+
 static void ms_ticker_synchronizer_reset(MSTickerSynchronizer *ts) {
 	memset(ts, 0, sizeof(*ts));
 }
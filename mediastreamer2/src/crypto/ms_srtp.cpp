@@ -585,7 +585,8 @@ int ms_srtp_process_on_send(RtpTransportModifier *t, mblk_t *m) {
 			m->b_rptr[slen] = 0x00; /* the emtpy OHB */
 			slen++;
 		} else {
-			/* defragment message and enlarge the buffer for srtp to write its data */
+			/* defragment message and enlarge the buffer for srtp to write its data, nothing is copied when the packet
+			 * was built with the RTP_PACKET_TAILROOM reserved by the packers */
 			msgpullup(m, slen + SRTP_MAX_TRAILER_LEN + ekt_tag_size + 4 +
 			                 4); /*+4 for 32 bits alignment + 4 for potential Original header block */
 
@@ -76,6 +76,9 @@ struct SenderData {
 	bool_t frame_start;
 	bool_t rtp_transfer_mode;
 	bool_t voice_activity;
+	bool_t source_changed;
+	bool_t talkspurt_start;
+	int ts_step;
 };
 
 typedef struct SenderData SenderData;
@@ -333,6 +336,14 @@ static uint32_t get_cur_timestamp(MSFilter *f, mblk_t *im) {
 		if (d->rtp_transfer_mode) return packet_ts;
 		if (d->last_sent_time == -1) {
 			d->tsoff = curts - packet_ts;
+		} else if (d->source_changed) {
+			/* carry on from the last packet sent, one packet duration later at least so that they do not overlap */
+			difftime_ts = (int)(((f->ticker->time - d->last_sent_time) * d->rate) / 1000);
+			if (difftime_ts < d->ts_step) difftime_ts = d->ts_step;
+			d->tsoff = d->last_ts + d->tsoff + (uint32_t)difftime_ts - packet_ts;
+			d->source_changed = FALSE;
+			/* and tell the receiver to resynchronize, its decoder state does not match the new encoder */
+			d->talkspurt_start = TRUE;
 		} else if (d->enable_ts_adjustment) {
 			diffts = packet_ts - d->last_ts;
 			difftime_ts = (int)(((f->ticker->time - d->last_sent_time) * d->rate) / 1000);
@@ -341,6 +352,8 @@ static uint32_t get_cur_timestamp(MSFilter *f, mblk_t *im) {
 				uint32_t tsoff = curts - packet_ts;
 				ms_message("Adjusting output timestamp by %i", (tsoff - d->tsoff));
 				d->tsoff = tsoff;
+			} else if (diffts > 0) {
+				d->ts_step = diffts;
 			}
 		}
 		netts = packet_ts + d->tsoff;
@@ -606,6 +619,7 @@ static void add_frame_marking_extension(SenderData *d, mblk_t *header, mblk_t *i
 
 	if (mblk_get_independent_flag(im)) marker |= RTP_FRAME_MARKER_INDEPENDENT;
 	if (mblk_get_discardable_flag(im)) marker |= RTP_FRAME_MARKER_DISCARDABLE;
+	marker |= (uint8_t)mblk_get_temporal_layer_id(im);
 
 	rtp_add_frame_marker(header, d->frame_marking_extension_id, marker);
 }
@@ -664,11 +678,11 @@ static void _sender_process(MSFilter *f) {
 				// But this information, stored in mblk_t.reserved1 is crashed when copying im meta data, save it
 				bool_t forceEKTFlag = ortp_mblk_get_ekt_tag_flag(header);
 
-				rtp_set_markbit(header, mblk_get_marker_info(im));
+				rtp_set_markbit(header, mblk_get_marker_info(im) || d->talkspurt_start);
+				d->talkspurt_start = FALSE;
 
 				sender_add_extensions(d, header, im);
 
-				header->b_cont = im;
 				mblk_meta_copy(im, header);
 
 				// before sending the message to ortp, set the ekt tag flag according to the
@@ -676,6 +690,10 @@ static void _sender_process(MSFilter *f) {
 				// Do it after the mblk_meta_copy as it will crash reservedX and the ekt flag is stored in reserved1
 				ortp_mblk_set_ekt_tag_flag(header, forceEKTFlag || mblk_get_independent_flag(im));
 
+				// the header goes in the room reserved by the packer in front of the payload if any, so that the
+				// packet is not pulled up again by the SRTP and network layers
+				header = msgprepend(header, im);
+
 				rtp_session_sendm_with_ts(s, header, timestamp);
 			} else if (d->mute == TRUE && d->skip == FALSE) {
 				process_cn(f, d, timestamp, im);
@@ -694,6 +712,8 @@ static void _sender_process(MSFilter *f) {
 	if (d->last_sent_time == -1) {
 		check_stun_sending(f);
 	}
+	/* the packets of this tick leave together when the session does batched sending */
+	rtp_session_flush_send_batch(s);
 
 	if (f->ticker->time % 5000 == 0) {
 		print_processing_delay_stats(d);
@@ -779,6 +799,14 @@ static int sender_set_voice_activity(MSFilter *f, void *data) {
 	return 0;
 }
 
+static int sender_notify_source_change(MSFilter *f, BCTBX_UNUSED(void *arg)) {
+	SenderData *d = (SenderData *)f->data;
+	ms_filter_lock(f);
+	d->source_changed = TRUE;
+	ms_filter_unlock(f);
+	return 0;
+}
+
 static MSFilterMethod sender_methods[] = {
     {MS_RTP_SEND_MUTE, sender_mute},
     {MS_RTP_SEND_UNMUTE, sender_unmute},
@@ -803,6 +831,7 @@ static MSFilterMethod sender_methods[] = {
     {MS_RTP_SEND_SET_ACTIVE_SPEAKER_SSRC, sender_set_active_speaker_ssrc},
     {MS_RTP_SEND_TELEPHONE_EVENT_SUPPORTED, sender_telephone_event_supported},
     {MS_RTP_SEND_SET_VOICE_ACTIVITY, sender_set_voice_activity},
+    {MS_RTP_SEND_NOTIFY_SOURCE_CHANGE, sender_notify_source_change},
     {0, NULL}};
 
 #ifdef _MSC_VER
@@ -1029,6 +1058,7 @@ static void receiver_check_for_extensions(MSFilter *f, mblk_t *m) {
 		if (rtp_get_frame_marker(m, d->frame_marking_extension_id, &marker)) {
 			mblk_set_independent_flag(m, (marker & RTP_FRAME_MARKER_INDEPENDENT));
 			mblk_set_discardable_flag(m, (marker & RTP_FRAME_MARKER_DISCARDABLE));
+			mblk_set_temporal_layer_id(m, RTP_FRAME_MARKER_TID(marker));
 		}
 	}
 }
@@ -110,7 +110,7 @@ void Av1Encoder::start() {
 		aom_codec_control(&mCodec, AOME_SET_CPUUSED, 11);
 
 		mIsRunning = true;
-		mEncodeThread = std::thread(&Av1Encoder::encoderThread, this);
+		mEncodeQueue = ms_factory_create_codec_worker_queue(mFactory, "MSAv1Enc");
 	}
 }
 
@@ -118,13 +118,10 @@ void Av1Encoder::stop() {
 	if (mIsRunning) {
 		mIsRunning = false;
 
-		// Ensure the encoding thread can finish
-		unique_lock<mutex> lk(mToEncodeMutex);
-		mFramesAvailable = true;
-		lk.unlock();
-		mToEncodeCondition.notify_one();
-
-		mEncodeThread.join();
+		// Waits for the frame being encoded, if any, and drops the pending tasks
+		ms_worker_queue_destroy(mEncodeQueue, FALSE);
+		mEncodeQueue = nullptr;
+		mTaskQueued = false;
 
 		flush();
 
@@ -144,13 +141,13 @@ void Av1Encoder::feed(mblk_t *rawData, [[maybe_unused]] uint64_t time, bool requ
 
 	ms_queue_put(&mToEncode, rawData);
 
-	// Notify the encoding thread that frames are available
-	mFramesAvailable = true;
-
 	if (requestIFrame) mIframeRequested = true;
 
-	lk.unlock();
-	mToEncodeCondition.notify_one();
+	// One task encodes the last frame available when it runs, there is no need to queue another one meanwhile
+	if (!mTaskQueued) {
+		mTaskQueued = true;
+		ms_worker_queue_add_task(mEncodeQueue, &Av1Encoder::encodeTask, this);
+	}
 }
 
 bool Av1Encoder::fetch(MSQueue *encodedData) {
@@ -167,82 +164,83 @@ bool Av1Encoder::fetch(MSQueue *encodedData) {
 	return true;
 }
 
-void Av1Encoder::encoderThread() {
-	while (mIsRunning) {
-		// Wait for available frames to pass to the encoder
-		unique_lock lk(mToEncodeMutex);
-		mToEncodeCondition.wait(lk, [this] { return this->mFramesAvailable; });
-
-		mblk_t *data = nullptr;
-		int skippedCount = 0;
-
-		mblk_t *previous = nullptr;
-		while ((data = ms_queue_get(&mToEncode)) != nullptr) {
-			if (previous) {
-				freemsg(previous);
-				skippedCount++;
-			}
-			previous = data;
+bool_t Av1Encoder::encodeTask(void *data) {
+	static_cast<Av1Encoder *>(data)->encodeFrame();
+	return TRUE;
+}
+
+void Av1Encoder::encodeFrame() {
+	unique_lock lk(mToEncodeMutex);
+	mTaskQueued = false;
+
+	mblk_t *data = nullptr;
+	int skippedCount = 0;
+
+	mblk_t *previous = nullptr;
+	while ((data = ms_queue_get(&mToEncode)) != nullptr) {
+		if (previous) {
+			freemsg(previous);
+			skippedCount++;
 		}
+		previous = data;
+	}
+
+	if (data == nullptr) data = previous;
 
-		if (data == nullptr) data = previous;
+	lk.unlock();
 
-		mFramesAvailable = false;
-		lk.unlock();
+	if (data == nullptr) return;
 
-		if (data == nullptr) continue;
+	if (skippedCount > 0) ms_warning("Av1Encoder: %i frames skipped by async encoding process", skippedCount);
 
-		if (skippedCount > 0) ms_warning("Av1Encoder: %i frames skipped by async encoding process", skippedCount);
+	MSPicture pic;
+	ms_yuv_buf_init_from_mblk(&pic, data);
 
-		MSPicture pic;
-		ms_yuv_buf_init_from_mblk(&pic, data);
+	aom_image_t img;
+	aom_img_wrap(&img, AOM_IMG_FMT_I420, mVsize.width, mVsize.height, 1, pic.planes[0]);
 
-		aom_image_t img;
-		aom_img_wrap(&img, AOM_IMG_FMT_I420, mVsize.width, mVsize.height, 1, pic.planes[0]);
+	aom_enc_frame_flags_t flags = 0;
 
-		aom_enc_frame_flags_t flags = 0;
+	if (mFrameCount == 0) flags |= AOM_EFLAG_FORCE_KF;
 
-		if (mFrameCount == 0) flags |= AOM_EFLAG_FORCE_KF;
+	lk.lock();
+	if (mIframeRequested) {
+		flags |= AOM_EFLAG_FORCE_KF;
+		mIframeRequested = false;
+	}
+	lk.unlock();
 
-		lk.lock();
-		if (mIframeRequested) {
-			flags |= AOM_EFLAG_FORCE_KF;
-			mIframeRequested = false;
-		}
-		lk.unlock();
+	unique_lock codecLk(mCodecMutex);
+	aom_codec_err_t ret = aom_codec_encode(&mCodec, &img, mFrameCount, 1, flags);
 
-		unique_lock codecLk(mCodecMutex);
-		aom_codec_err_t ret = aom_codec_encode(&mCodec, &img, mFrameCount, 1, flags);
+	if (ret != AOM_CODEC_OK) {
+		ms_error("Av1Encoder: encode failed: %s (%s)", aom_codec_err_to_string(ret),
+		         aom_codec_error_detail(&mCodec));
+	}
 
-		if (ret != AOM_CODEC_OK) {
-			ms_error("Av1Encoder: encode failed: %s (%s)", aom_codec_err_to_string(ret),
-			         aom_codec_error_detail(&mCodec));
-		}
+	const aom_codec_cx_pkt_t *pkt;
+	aom_codec_iter_t iter = nullptr;
 
-		const aom_codec_cx_pkt_t *pkt;
-		aom_codec_iter_t iter = nullptr;
-
-		while ((pkt = aom_codec_get_cx_data(&mCodec, &iter))) {
-			if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
-				mblk_t *out = allocb(pkt->data.frame.sz, 0);
-				memcpy(out->b_wptr, pkt->data.frame.buf, pkt->data.frame.sz);
-				out->b_wptr += pkt->data.frame.sz;
-				mblk_set_timestamp_info(out, mblk_get_timestamp_info(data));
-				mblk_set_independent_flag(out, (pkt->data.frame.flags & AOM_FRAME_IS_KEY ||
-				                                pkt->data.frame.flags & AOM_FRAME_IS_INTRAONLY ||
-				                                pkt->data.frame.flags & AOM_FRAME_IS_SWITCH));
-				mblk_set_discardable_flag(out, (pkt->data.frame.flags & AOM_FRAME_IS_DROPPABLE));
-
-				lock_guard<mutex> guard(mEncodedFramesMutex);
-				ms_queue_put(&mEncodedFrames, out);
-			}
+	while ((pkt = aom_codec_get_cx_data(&mCodec, &iter))) {
+		if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
+			mblk_t *out = allocb(pkt->data.frame.sz, 0);
+			memcpy(out->b_wptr, pkt->data.frame.buf, pkt->data.frame.sz);
+			out->b_wptr += pkt->data.frame.sz;
+			mblk_set_timestamp_info(out, mblk_get_timestamp_info(data));
+			mblk_set_independent_flag(out, (pkt->data.frame.flags & AOM_FRAME_IS_KEY ||
+			                                pkt->data.frame.flags & AOM_FRAME_IS_INTRAONLY ||
+			                                pkt->data.frame.flags & AOM_FRAME_IS_SWITCH));
+			mblk_set_discardable_flag(out, (pkt->data.frame.flags & AOM_FRAME_IS_DROPPABLE));
+
+			lock_guard<mutex> guard(mEncodedFramesMutex);
+			ms_queue_put(&mEncodedFrames, out);
 		}
-		codecLk.unlock();
+	}
+	codecLk.unlock();
 
-		mFrameCount++;
+	mFrameCount++;
 
-		freemsg(data);
-	}
+	freemsg(data);
 }
 
 void Av1Encoder::flush() {
@@ -20,13 +20,12 @@
 
 #pragma once
 
-#include <condition_variable>
 #include <mutex>
-#include <thread>
 
 #include <aom/aom_encoder.h>
 #include <aom/aomcx.h>
 
+#include "mediastreamer2/msasync.h"
 #include "mediastreamer2/msqueue.h"
 #include "video-encoder.h"
 
@@ -67,7 +66,8 @@ public:
 	void flush();
 
 protected:
-	void encoderThread();
+	static bool_t encodeTask(void *data);
+	void encodeFrame();
 
 	MSFactory *mFactory;
 
@@ -86,8 +86,7 @@ protected:
 	// IN frames
 	MSQueue mToEncode;
 	std::mutex mToEncodeMutex;
-	std::condition_variable mToEncodeCondition;
-	bool mFramesAvailable = false;
+	bool mTaskQueued = false;
 
 	// OUT frames
 	MSQueue mEncodedFrames;
@@ -95,7 +94,7 @@ protected:
 
 	std::mutex mCodecMutex;
 
-	std::thread mEncodeThread{};
+	MSWorkerQueue *mEncodeQueue = nullptr;
 };
 
 } // namespace mediastreamer
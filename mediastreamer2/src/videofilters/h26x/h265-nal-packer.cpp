@@ -58,7 +58,7 @@ mblk_t *H265NalPacker::NaluAggregator::completeAggregation() {
 	} else {
 		m = _apHeader.forge();
 		concatb(m, _ap);
-		msgpullup(m, -1);
+		msgpullup_with_room(m, RTP_PACKET_HEADROOM, RTP_PACKET_TAILROOM);
 	}
 	_ap = nullptr;
 	return m;
@@ -115,16 +115,12 @@ mblk_t *H265NalPacker::NaluSpliter::makeFu(const H265NaluHeader &naluHeader,
                                            const H265FuHeader &fuHeader,
                                            const uint8_t *payload,
                                            size_t length) {
-	mblk_t *naluHeaderBuf = naluHeader.forge();
-	mblk_t *fuHeaderBuf = fuHeader.forge();
-	mblk_t *payloadBuf = allocb(length, 0);
-	memcpy(payloadBuf->b_wptr, payload, length);
-	payloadBuf->b_wptr += length;
-
-	mblk_t *fu = naluHeaderBuf;
-	concatb(fu, fuHeaderBuf);
-	concatb(fu, payloadBuf);
-	msgpullup(fu, -1);
+	mblk_t *fu = naluHeader.forge();
+	concatb(fu, fuHeader.forge());
+	// the payload is copied once, right after the headers, in a buffer with room for the RTP header and SRTP trailer
+	msgpullup_with_room(fu, RTP_PACKET_HEADROOM, length + RTP_PACKET_TAILROOM);
+	memcpy(fu->b_wptr, payload, length);
+	fu->b_wptr += length;
 	return fu;
 }
 
@@ -119,6 +119,10 @@ void NalPacker::fragNaluAndSend(MSQueue *rtpq, uint32_t ts, mblk_t *nalu, bool_t
 }
 
 void NalPacker::sendPacket(MSQueue *rtpq, uint32_t ts, mblk_t *m, bool_t marker) {
+	// Aggregation and fragmentation packets are chains of small headers and NALu slices that the SRTP layer would have
+	// to pull up anyway: join them here, with room for the RTP header and the SRTP trailer so that no further copy is
+	// needed.
+	if (m->b_cont) msgpullup_with_room(m, RTP_PACKET_HEADROOM, RTP_PACKET_TAILROOM);
 	mblk_set_timestamp_info(m, ts);
 	mblk_set_marker_info(m, marker);
 	mblk_set_cseq(m, _refCSeq++);
@@ -22,6 +22,7 @@
 
 #include <memory>
 
+#include <ortp/rtpsession.h>
 #include <ortp/str_utils.h>
 
 #include "mediastreamer2/msqueue.h"
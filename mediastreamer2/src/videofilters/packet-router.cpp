@@ -211,7 +211,7 @@ void RouterVideoInput::update() {
 		if (!mSeqNumberSet) {
 			mState = State::Stopped;
 			mKeyFrameRequested = true;
-		} else if (!mLocal && (newSeqNumber != mCurrentSeqNumber + 1)) {
+		} else if (!mLocal && newSeqNumber != static_cast<uint16_t>(mCurrentSeqNumber + 1)) {
 			PackerRouterLogContextualizer prlc(mRouter);
 			ms_warning("Sequence discontinuity detected on pin %i, key-frame requested", mPin);
 			mState = State::Stopped;
@@ -234,8 +234,12 @@ void RouterVideoInput::update() {
 		mCurrentTimestamp = newTimestamp;
 		mCurrentSeqNumber = newSeqNumber;
 		mSeqNumberSet = true;
+
+		mLayerBytes[getTemporalLayerId(m)] += msgdsize(m);
 	}
 
+	updateLayerBitrates();
+
 	if (!ms_queue_empty(queue) && mKeyFrameRequested) {
 		if (mState == State::Stopped) {
 			mRouter->notifyPli(mPin);
@@ -260,6 +264,41 @@ bool RouterVideoInput::isKeyFrame(mblk_t *packet) const {
 
 	return mKeyFrameIndicator->isKeyFrame(packet);
 }
+
+int RouterVideoInput::getTemporalLayerId(mblk_t *packet) const {
+	if (!mRouter->isFullPacketModeEnabled()) return mblk_get_temporal_layer_id(packet);
+
+	uint8_t marker = 0;
+	if (isRTCP(packet->b_rptr) ||
+	    !rtp_get_frame_marker(packet, getExtensionId(RTP_EXTENSION_FRAME_MARKING), &marker))
+		return 0;
+
+	return RTP_FRAME_MARKER_TID(marker);
+}
+
+bool RouterVideoInput::isTemporallyScalable() const {
+	return mHighestTemporalLayer > 0;
+}
+
+void RouterVideoInput::updateLayerBitrates() {
+	const uint64_t now = mRouter->getTime();
+
+	if (mLayerBitrateStartTime == 0) {
+		mLayerBitrateStartTime = now;
+		return;
+	}
+
+	const uint64_t elapsed = now - mLayerBitrateStartTime;
+	if (elapsed < sLayerBitrateInterval) return;
+
+	mHighestTemporalLayer = 0;
+	for (int i = 0; i < sMaxTemporalLayers; ++i) {
+		mLayerBitrates[i] = static_cast<int>(mLayerBytes[i] * 8 * 1000 / elapsed);
+		if (mLayerBytes[i] > 0) mHighestTemporalLayer = i;
+		mLayerBytes[i] = 0;
+	}
+	mLayerBitrateStartTime = now;
+}
 #endif
 
 // =============================================================================
@@ -272,6 +311,33 @@ void RouterOutput::configure(const MSPacketRouterPinData *pinData) {
 	std::copy(std::begin(pinData->extension_ids), std::end(pinData->extension_ids), std::begin(mExtensionIds));
 }
 
+// Duplicates a packet for this output without copying its payload, which is shared by reference with all the other
+// outputs. Only what is rewritten per output is private:
+// - without full packet mode, the packet is just the payload and the rewritten information lives in the mblk_t,
+// - in full packet mode, the RTP header (sequence number, extension ids...) is copied in its own block.
+// The shared payload is never written to afterwards: msgprepend() and msgpullup() do not write in a buffer that has
+// several owners, so the header of the sender and the SRTP trailer end up in a private copy made once per output.
+mblk_t *RouterOutput::duplicatePacket(mblk_t *source) {
+	if (!mRouter->isFullPacketModeEnabled()) return dupmsg(source);
+
+	uint8_t *payload = nullptr;
+	if (source->b_cont != nullptr || rtp_get_payload(source, &payload) < 0) return copymsg(source);
+
+	const size_t headerSize = static_cast<size_t>(payload - source->b_rptr);
+	mblk_t *header = allocb(headerSize, 0);
+	memcpy(header->b_wptr, source->b_rptr, headerSize);
+	header->b_wptr += headerSize;
+	// Keep the reception address as copymsg() would, the network layer uses it to select the sending interface
+	memcpy(&header->recv_addr, &source->recv_addr, sizeof(header->recv_addr));
+
+	if (payload < source->b_wptr) {
+		header->b_cont = dupb(source);
+		header->b_cont->b_rptr = payload;
+	}
+
+	return header;
+}
+
 void RouterOutput::rewritePacketInformation(mblk_t *source, mblk_t *output) {
 	if (mblk_get_timestamp_info(source) != mOutTimestamp) {
 		if (mRouter->getRoutingMode() == PacketRouter::RoutingMode::Video) {
@@ -294,6 +360,7 @@ void RouterOutput::rewritePacketInformation(mblk_t *source, mblk_t *output) {
 	mblk_set_marker_info(output, mblk_get_marker_info(source));
 	mblk_set_independent_flag(output, mblk_get_independent_flag(source));
 	mblk_set_discardable_flag(output, mblk_get_discardable_flag(source));
+	mblk_set_temporal_layer_id(output, mblk_get_temporal_layer_id(source));
 }
 
 void RouterOutput::rewriteExtensionIds(mblk_t *output, int inputIds[16], int outputIds[16]) {
@@ -336,7 +403,7 @@ void RouterAudioOutput::transfer() {
 					for (mblk_t *m = ms_queue_peek_first(inputQueue); !ms_queue_end(inputQueue, m);
 					     m = ms_queue_peek_next(inputQueue, m)) {
 
-						mblk_t *o = copymsg(m);
+						mblk_t *o = duplicatePacket(m);
 
 						if (!mRouter->isFullPacketModeEnabled()) {
 							rewritePacketInformation(m, o);
@@ -392,14 +459,34 @@ void RouterVideoOutput::transfer() {
 
 			mblk_t *start = input->mKeyFrameStart ? input->mKeyFrameStart : ms_queue_peek_first(inputQueue);
 
+			if (mForwardedSource != mCurrentSource) {
+				mForwardedSource = mCurrentSource;
+				mSeqNumberOffset = 0;
+				mTemporalLayer = RouterVideoInput::sMaxTemporalLayers - 1;
+			}
+
 			for (mblk_t *m = start; !ms_queue_end(inputQueue, m); m = ms_queue_peek_next(inputQueue, m)) {
-				mblk_t *o = copymsg(m);
+				const int temporalLayer = input->getTemporalLayerId(m);
+
+				// Frames of the base layer only reference other base layer frames: the number of layers forwarded can
+				// change there without breaking the decoding of the following frames.
+				if (temporalLayer == 0) mTemporalLayer = selectTemporalLayer(input);
+				if (temporalLayer > mTemporalLayer) {
+					mSeqNumberOffset++;
+					continue;
+				}
+
+				mblk_t *o = duplicatePacket(m);
 
 				// Only re-write packet information if full packet mode is disabled
 				if (!mRouter->isFullPacketModeEnabled()) {
 					rewritePacketInformation(m, o);
 				} else {
 					rewriteExtensionIds(o, input->mExtensionIds, mExtensionIds);
+					// Hide the dropped packets to the receiver, it would otherwise take them for losses
+					if (mSeqNumberOffset != 0 && !isRTCP(o->b_rptr)) {
+						rtp_set_seqnumber(o, rtp_get_seqnumber(o) - mSeqNumberOffset);
+					}
 				}
 
 				ms_queue_put(outputQueue, o);
@@ -407,6 +494,24 @@ void RouterVideoOutput::transfer() {
 		}
 	}
 }
+
+void RouterVideoOutput::setMaxBitrate(int bitrate) {
+	mMaxBitrate = bitrate;
+}
+
+int RouterVideoOutput::selectTemporalLayer(const RouterVideoInput *input) const {
+	if (mMaxBitrate <= 0) return RouterVideoInput::sMaxTemporalLayers - 1;
+
+	// Keep as many layers as the bitrate allows, the base layer being always forwarded
+	int layer = 0;
+	int bitrate = input->mLayerBitrates[0];
+	while (layer < input->mHighestTemporalLayer && bitrate + input->mLayerBitrates[layer + 1] <= mMaxBitrate) {
+		bitrate += input->mLayerBitrates[++layer];
+	}
+
+	// Until the bitrates are known, everything is forwarded
+	return input->isTemporallyScalable() ? layer : RouterVideoInput::sMaxTemporalLayers - 1;
+}
 #endif
 
 // =============================================================================
@@ -881,6 +986,46 @@ void PacketRouter::notifyOutputSwitched(MSPacketRouterSwitchedEventData event) {
 	notify(MS_PACKET_ROUTER_OUTPUT_SWITCHED, &event);
 }
 
+void PacketRouter::setOutputMaxBitrate(const MSPacketRouterOutputBitrate *outputBitrate) {
+	PackerRouterLogContextualizer prlc(this);
+
+	lock();
+
+	auto output = dynamic_cast<RouterVideoOutput *>(getRouterOutput(outputBitrate->pin));
+	if (output != nullptr) {
+		ms_message("Maximum bitrate of output pin %i set to %i kbits/s", outputBitrate->pin,
+		           outputBitrate->bitrate / 1000);
+		output->setMaxBitrate(outputBitrate->bitrate);
+	} else {
+		ms_error("Cannot set maximum bitrate, output on pin %d does not exist", outputBitrate->pin);
+	}
+
+	unlock();
+}
+
+bool PacketRouter::isTemporallyScalable() const {
+	bool scalable = false;
+
+	lock();
+
+	for (const auto &output : mOutputs) {
+		const auto videoOutput = dynamic_cast<RouterVideoOutput *>(output.get());
+		if (videoOutput == nullptr || videoOutput->mCurrentSource == -1) continue;
+
+		const auto input = dynamic_cast<RouterVideoInput *>(getRouterInput(videoOutput->mCurrentSource));
+		if (input == nullptr) continue;
+		if (!input->isTemporallyScalable()) {
+			scalable = false;
+			break;
+		}
+		scalable = true;
+	}
+
+	unlock();
+
+	return scalable;
+}
+
 void PacketRouter::setInputFmt(const MSFmtDescriptor *format) {
 	PackerRouterLogContextualizer prlc(this);
 
@@ -1165,6 +1310,34 @@ int PacketRouterFilterWrapper::onNotifyFir(MSFilter *f, void *arg) {
 	}
 }
 
+int PacketRouterFilterWrapper::onSetOutputMaxBitrate(MSFilter *f, void *arg) {
+	try {
+		auto router = static_cast<PacketRouter *>(f->data);
+		const auto outputBitrate = static_cast<MSPacketRouterOutputBitrate *>(arg);
+
+		if (router->getRoutingMode() != PacketRouter::RoutingMode::Video || outputBitrate->pin < 0 ||
+		    outputBitrate->pin >= ROUTER_MAX_OUTPUT_CHANNELS) {
+			PackerRouterLogContextualizer prlc(router);
+			ms_error("Invalid call to MS_PACKET_ROUTER_SET_OUTPUT_MAX_BITRATE");
+			return -1;
+		}
+
+		router->setOutputMaxBitrate(outputBitrate);
+		return 0;
+	} catch (const PacketRouter::MethodCallFailed &) {
+		return -1;
+	}
+}
+
+int PacketRouterFilterWrapper::onGetTemporalScalability(MSFilter *f, void *arg) {
+	try {
+		*static_cast<bool_t *>(arg) = static_cast<PacketRouter *>(f->data)->isTemporallyScalable();
+		return 0;
+	} catch (const PacketRouter::MethodCallFailed &) {
+		return -1;
+	}
+}
+
 int PacketRouterFilterWrapper::onSetInputFmt(MSFilter *f, void *arg) {
 	try {
 		const MSFmtDescriptor *format = static_cast<MSFmtDescriptor *>(arg);
@@ -1205,6 +1378,8 @@ static MSFilterMethod MS_FILTER_WRAPPER_METHODS_NAME(PacketRouter)[] = {
     {MS_PACKET_ROUTER_SET_FOCUS, PacketRouterFilterWrapper::onSetFocus},
     {MS_PACKET_ROUTER_NOTIFY_PLI, PacketRouterFilterWrapper::onNotifyPli},
     {MS_PACKET_ROUTER_NOTIFY_FIR, PacketRouterFilterWrapper::onNotifyFir},
+    {MS_PACKET_ROUTER_SET_OUTPUT_MAX_BITRATE, PacketRouterFilterWrapper::onSetOutputMaxBitrate},
+    {MS_PACKET_ROUTER_GET_TEMPORAL_SCALABILITY, PacketRouterFilterWrapper::onGetTemporalScalability},
     {MS_FILTER_SET_INPUT_FMT, PacketRouterFilterWrapper::onSetInputFmt},
 #endif
     {0, nullptr}};
@@ -99,8 +99,14 @@ public:
 	void configure(const MSPacketRouterPinData *pinData) override;
 	void update() override;
 
+	int getTemporalLayerId(mblk_t *packet) const;
+	bool isTemporallyScalable() const;
+
+	static constexpr int sMaxTemporalLayers = RTP_FRAME_MARKER_TID_MASK + 1;
+
 protected:
 	bool isKeyFrame(mblk_t *packet) const;
+	void updateLayerBitrates();
 
 	enum State { Stopped, Running };
 	State mState = State::Stopped;
@@ -111,6 +117,13 @@ protected:
 
 	mblk_t *mKeyFrameStart = nullptr;
 	bool mKeyFrameRequested = false;
+
+	// Bitrate of each temporal layer (bits/s), measured over sLayerBitrateInterval
+	static constexpr uint64_t sLayerBitrateInterval = 1000;
+	size_t mLayerBytes[sMaxTemporalLayers] = {};
+	int mLayerBitrates[sMaxTemporalLayers] = {};
+	int mHighestTemporalLayer = 0;
+	uint64_t mLayerBitrateStartTime = 0;
 };
 #endif
 
@@ -129,6 +142,7 @@ public:
 	}
 
 protected:
+	mblk_t *duplicatePacket(mblk_t *source);
 	void rewritePacketInformation(mblk_t *source, mblk_t *output);
 	void rewriteExtensionIds(mblk_t *output, int inputIds[16], int outputIds[16]);
 
@@ -168,11 +182,22 @@ public:
 		return mCurrentSource;
 	}
 
+	void setMaxBitrate(int bitrate);
+
 protected:
+	int selectTemporalLayer(const RouterVideoInput *input) const;
+
 	int mCurrentSource = -1;
 	int mNextSource = -1;
 
 	bool mActiveSpeakerEnabled = false;
+
+	// Temporal layers above mTemporalLayer are not forwarded to keep under mMaxBitrate (bits/s, 0 for no limit)
+	int mMaxBitrate = 0;
+	int mTemporalLayer = RouterVideoInput::sMaxTemporalLayers - 1;
+	// In full packet mode, the number of packets dropped from mForwardedSource, to keep the sequence numbers continuous
+	int mForwardedSource = -1;
+	uint16_t mSeqNumberOffset = 0;
 };
 #endif
 
@@ -280,6 +305,9 @@ public:
 	void notifyFir(int pin);
 	void notifyOutputSwitched(MSPacketRouterSwitchedEventData event);
 
+	void setOutputMaxBitrate(const MSPacketRouterOutputBitrate *outputBitrate);
+	bool isTemporallyScalable() const;
+
 	void setInputFmt(const MSFmtDescriptor *format);
 #endif
 
@@ -322,6 +350,8 @@ public:
 	static int onSetFocus(MSFilter *f, void *arg);
 	static int onNotifyPli(MSFilter *f, void *arg);
 	static int onNotifyFir(MSFilter *f, void *arg);
+	static int onSetOutputMaxBitrate(MSFilter *f, void *arg);
+	static int onGetTemporalScalability(MSFilter *f, void *arg);
 	static int onSetInputFmt(MSFilter *f, void *arg);
 #endif
 };
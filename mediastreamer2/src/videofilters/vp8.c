@@ -97,7 +97,7 @@ typedef struct EncState {
 	bool_t invalid_frame_reported;
 	bool_t avpf_enabled;
 	bool_t ready;
-	MSWorkerThread *process_thread;
+	MSWorkerQueue *process_queue;
 	queue_t entry_q;
 	MSQueue *exit_q;
 	ms_mutex_t vp8_mutex;
@@ -237,7 +237,7 @@ static void enc_preprocess(MSFilter *f) {
 		ms_video_starter_init(&s->starter);
 	}
 
-	s->process_thread = ms_worker_thread_new("MSVp8Enc");
+	s->process_queue = ms_factory_create_codec_worker_queue(f->factory, "MSVp8Enc");
 	qinit(&s->entry_q);
 	s->exit_q = ms_queue_new(0, 0, 0, 0);
 	s->ready = TRUE;
@@ -651,7 +651,7 @@ static void enc_process(MSFilter *f) {
 
 		ms_queue_remove(f->inputs[0], entry_f);
 		putq(&s->entry_q, entry_f);
-		ms_worker_thread_add_task(s->process_thread, enc_process_frame_task, (void *)f);
+		ms_worker_queue_add_task(s->process_queue, enc_process_frame_task, (void *)f);
 	}
 
 	/* Put each frame we have in exit_q in f->output[0] */
@@ -665,8 +665,8 @@ static void enc_process(MSFilter *f) {
 
 static void enc_postprocess(MSFilter *f) {
 	EncState *s = (EncState *)f->data;
-	ms_worker_thread_destroy(s->process_thread, FALSE);
-	s->process_thread = NULL;
+	ms_worker_queue_destroy(s->process_queue, FALSE);
+	s->process_queue = NULL;
 	if (s->ready) vpx_codec_destroy(&s->codec);
 	vp8rtpfmt_packer_uninit(&s->packer);
 	flushq(&s->entry_q, 0);
@@ -911,15 +911,13 @@ typedef struct DecState {
 	bool_t avpf_enabled;
 	bool_t freeze_on_error;
 	bool_t ready;
-	ms_thread_t thread;
-	ms_cond_t thread_cond;
+	MSWorkerQueue *process_queue;
 	MSQueue entry_q;
 	MSQueue exit_q;
-	bool_t thread_running;
-	bool_t waiting; // TRUE when the processing thread is in ms_cond_wait()
+	bool_t task_queued; // TRUE when a decoding task is queued and has not started draining entry_q yet
 } DecState;
 
-static void *dec_processing_thread(void *obj);
+static bool_t dec_process_frames_task(void *obj);
 
 static void dec_init(MSFilter *f) {
 	DecState *s = (DecState *)ms_new0(DecState, 1);
@@ -942,7 +940,6 @@ static void dec_init(MSFilter *f) {
 	 * It appears to be due to the inefficiency of spinlocks used by the libvpx.
 	 */
 	s->max_threads = 1;
-	ms_cond_init(&s->thread_cond, NULL);
 	ms_queue_init(&s->entry_q);
 	ms_queue_init(&s->exit_q);
 	f->data = s;
@@ -990,9 +987,8 @@ static void dec_preprocess(MSFilter *f) {
 		s->ready = TRUE;
 	}
 
-	s->thread_running = TRUE;
-	s->waiting = FALSE;
-	ms_thread_create(&s->thread, NULL, dec_processing_thread, f);
+	s->task_queued = FALSE;
+	s->process_queue = ms_factory_create_codec_worker_queue(f->factory, "MSVp8Dec");
 }
 
 static void dec_uninit(MSFilter *f) {
@@ -1002,11 +998,10 @@ static void dec_uninit(MSFilter *f) {
 	ms_yuv_buf_allocator_free(s->allocator);
 	ms_queue_flush(&s->entry_q);
 	ms_queue_flush(&s->exit_q);
-	ms_cond_destroy(&s->thread_cond);
 	ms_free(s);
 }
 
-static void *dec_processing_thread(void *obj) {
+static bool_t dec_process_frames_task(void *obj) {
 	MSFilter *f = (MSFilter *)obj;
 	DecState *s = (DecState *)f->data;
 	mblk_t *im;
@@ -1016,14 +1011,9 @@ static void *dec_processing_thread(void *obj) {
 	ms_queue_init(&frame);
 
 	ms_filter_lock(f);
-	while (s->thread_running) {
-		if (ms_queue_empty(&s->entry_q)) {
-			s->waiting = TRUE;
-			ms_cond_wait(&s->thread_cond, &f->lock);
-			s->waiting = FALSE;
-			continue;
-		}
-
+	/* packets received from now on need another task, unless this one finds them in entry_q */
+	s->task_queued = FALSE;
+	while (!ms_queue_empty(&s->entry_q)) {
 		/* Unpack RTP payload format for VP8. */
 		vp8rtpfmt_unpacker_feed(&s->unpacker, &s->entry_q);
 		ms_filter_unlock(f);
@@ -1103,7 +1093,7 @@ static void *dec_processing_thread(void *obj) {
 		ms_filter_lock(f);
 	}
 	ms_filter_unlock(f);
-	return NULL;
+	return TRUE;
 }
 
 static void dec_process(MSFilter *f) {
@@ -1136,23 +1126,23 @@ static void dec_process(MSFilter *f) {
 	while ((exit_f = ms_queue_get(&s->exit_q)) != NULL) {
 		ms_queue_put(f->outputs[0], exit_f);
 	}
-	if (queued_something && s->waiting) {
-		/* Wake up the processing thread if it is waiting some job. */
-		ms_cond_signal(&s->thread_cond);
+	if (queued_something && !s->task_queued) {
+		s->task_queued = TRUE;
+		ms_worker_queue_add_task(s->process_queue, dec_process_frames_task, (void *)f);
 	}
 	ms_filter_unlock(f);
 }
 
 static void dec_postprocess(MSFilter *f) {
 	DecState *s = (DecState *)f->data;
-	/* Shutdown the decoding thread, but leave entry_q and exit_q as they are.
+	/* Stop decoding, but leave entry_q and exit_q as they are.
 	 * In case of immediate restart of the graph, they may contain useful data and it is
 	 * stupid to create a discontinuity because of a graph restart.*/
-	ms_filter_lock(f);
-	s->thread_running = FALSE;
-	if (s->waiting) ms_cond_signal(&s->thread_cond);
-	ms_filter_unlock(f);
-	ms_thread_join(s->thread, NULL);
+	if (s->process_queue) {
+		ms_worker_queue_destroy(s->process_queue, FALSE);
+		s->process_queue = NULL;
+	}
+	s->task_queued = FALSE;
 }
 
 static int dec_reset_first_image(MSFilter *f, BCTBX_UNUSED(void *data)) {
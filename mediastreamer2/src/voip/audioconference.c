@@ -25,11 +25,36 @@
 #include "mediastreamer2/msmediaplayer.h"
 #include "mediastreamer2/mspacketrouter.h"
 #include "mediastreamer2/msrtp.h"
+#include "mediastreamer2/mstee.h"
 #include "mediastreamer2/msvolume.h"
 #include "private.h"
 
 static const float audio_threshold_min_db = -30.0f;
 
+/* a shared encoder feeds its listeners through a MSTee, whose number of outputs is limited */
+#define SHARED_ENCODER_MAX_LISTENERS 10
+
+typedef struct _SharedEncoderConfig {
+	const char *mime_type;
+	const char *fmtp;
+	int samplerate; /* the rate of the endpoints, at the input of the encoder */
+	int encoder_rate;
+	int nchannels;
+	int bitrate;
+} SharedEncoderConfig;
+
+/* Encodes once the mix heard by all the participants that do not contribute to it (muted, or not part of the loudest
+ * ones), and dispatches the encoded packets to the rtp senders of these participants, the listeners. */
+typedef struct _SharedEncoder {
+	SharedEncoderConfig config;
+	MSFilter *resampler;
+	MSFilter *encoder;
+	MSFilter *tee;
+	int pin; /* the mixer output pin, which has no input and thus receives the mix of all the contributors */
+	MSAudioEndpoint *listeners[SHARED_ENCODER_MAX_LISTENERS];
+	int nlisteners;
+} SharedEncoder;
+
 struct _MSAudioConference {
 	MSTicker *ticker;
 	MSFilter *mixer;
@@ -38,6 +63,9 @@ struct _MSAudioConference {
 	int nmembers;
 	MSAudioEndpoint *active_speaker;
 	uint32_t current_speaker_ssrc;
+	int max_contributors;
+	bctbx_list_t *shared_encoders; /* list of SharedEncoder */
+	bool_t shared_encoding;
 };
 
 struct _MSAudioEndpoint {
@@ -60,7 +88,12 @@ struct _MSAudioEndpoint {
 	int pin;
 	int samplerate;
 	MSConferenceMode conf_mode;
+	SharedEncoder *shared_encoder;
+	MSFilter *shared_join; /* merges the private and shared encoder outputs before the rtp sender */
+	int shared_pin;        /* output of the shared encoder tee */
+	float level;
 	bool_t muted;
+	bool_t listening; /* receiving the output of the shared encoder instead of the one of its own encoder */
 };
 
 MSAudioConference *ms_audio_conference_new(const MSAudioConferenceParams *params, MSFactory *factory) {
@@ -69,7 +102,7 @@ MSAudioConference *ms_audio_conference_new(const MSAudioConferenceParams *params
 	MSTickerParams ticker_params = {0};
 	ticker_params.name = "Audio conference MSTicker";
 	ticker_params.prio = __ms_get_default_prio(FALSE);
-	obj->ticker = ms_ticker_new_with_params(&ticker_params);
+	obj->ticker = ms_factory_create_ticker(factory, &ticker_params);
 	obj->params = *params;
 
 	if (params->mode == MSConferenceModeMixer) {
@@ -198,7 +231,7 @@ static void redo_audio_stream_graph(MSAudioEndpoint *ep) {
 static int find_free_pin(MSFilter *mixer) {
 	int i;
 	for (i = 0; i < mixer->desc->ninputs; ++i) {
-		if (mixer->inputs[i] == NULL) {
+		if (mixer->inputs[i] == NULL && mixer->outputs[i] == NULL) {
 			return i;
 		}
 	}
@@ -319,11 +352,246 @@ static void unconfigure_output(MSAudioEndpoint *ep) {
 	ms_filter_call_method(ep->conference->mixer, MS_PACKET_ROUTER_UNCONFIGURE_OUTPUT, &ep->pin);
 }
 
+static bool_t endpoint_get_encoder_config(MSAudioEndpoint *ep, SharedEncoderConfig *config) {
+	AudioStream *st = ep->st;
+	RtpSession *session;
+	PayloadType *pt;
+
+	/* only the remote endpoints whose encoder is right after the mixer can share it */
+	if (st == NULL || st->ms.encoder == NULL || ep->mixer_out.filter != st->ms.encoder) return FALSE;
+	session = st->ms.sessions.rtp_session;
+	pt = rtp_profile_get_payload(rtp_session_get_send_profile(session), rtp_session_get_send_payload_type(session));
+	if (pt == NULL) return FALSE;
+
+	memset(config, 0, sizeof(*config));
+	config->mime_type = pt->mime_type;
+	config->fmtp = pt->send_fmtp;
+	config->samplerate = ep->samplerate != -1 ? ep->samplerate : ep->conference->params.samplerate;
+	ms_filter_call_method(st->ms.encoder, MS_FILTER_GET_SAMPLE_RATE, &config->encoder_rate);
+	if (ms_filter_has_method(st->ms.encoder, MS_FILTER_GET_NCHANNELS))
+		ms_filter_call_method(st->ms.encoder, MS_FILTER_GET_NCHANNELS, &config->nchannels);
+	if (ms_filter_has_method(st->ms.encoder, MS_FILTER_GET_BITRATE))
+		ms_filter_call_method(st->ms.encoder, MS_FILTER_GET_BITRATE, &config->bitrate);
+	return TRUE;
+}
+
+static bool_t shared_encoder_config_equals(const SharedEncoderConfig *c1, const SharedEncoderConfig *c2) {
+	if (strcasecmp(c1->mime_type, c2->mime_type) != 0) return FALSE;
+	if ((c1->fmtp == NULL) != (c2->fmtp == NULL)) return FALSE;
+	if (c1->fmtp && strcmp(c1->fmtp, c2->fmtp) != 0) return FALSE;
+	return c1->samplerate == c2->samplerate && c1->encoder_rate == c2->encoder_rate &&
+	       c1->nchannels == c2->nchannels && c1->bitrate == c2->bitrate;
+}
+
+static SharedEncoder *shared_encoder_new(MSAudioConference *conf, MSFactory *factory,
+                                         const SharedEncoderConfig *config) {
+	SharedEncoder *se;
+	MSFilter *encoder = ms_factory_create_encoder(factory, config->mime_type);
+
+	if (encoder == NULL) return NULL;
+	se = ms_new0(SharedEncoder, 1);
+	se->config = *config;
+	se->config.mime_type = ms_strdup(config->mime_type);
+	se->config.fmtp = config->fmtp ? ms_strdup(config->fmtp) : NULL;
+	se->encoder = encoder;
+	se->resampler = ms_factory_create_filter(factory, MS_RESAMPLE_ID);
+	se->tee = ms_factory_create_filter(factory, MS_TEE_ID);
+
+	/* same configuration as done by audio_stream_start() */
+	ms_filter_call_method(se->encoder, MS_FILTER_SET_SAMPLE_RATE, &se->config.encoder_rate);
+	if (se->config.bitrate > 0) ms_filter_call_method(se->encoder, MS_FILTER_SET_BITRATE, &se->config.bitrate);
+	if (se->config.nchannels > 0) ms_filter_call_method(se->encoder, MS_FILTER_SET_NCHANNELS, &se->config.nchannels);
+	if (se->config.fmtp) {
+		char value[16] = {0};
+		if (ms_filter_has_method(se->encoder, MS_AUDIO_ENCODER_SET_PTIME) &&
+		    fmtp_get_value(se->config.fmtp, "ptime", value, sizeof(value) - 1)) {
+			int ptime = atoi(value);
+			ms_filter_call_method(se->encoder, MS_AUDIO_ENCODER_SET_PTIME, &ptime);
+		}
+		ms_filter_call_method(se->encoder, MS_FILTER_ADD_FMTP, (void *)se->config.fmtp);
+	}
+	ms_filter_call_method(se->resampler, MS_FILTER_SET_SAMPLE_RATE, &conf->params.samplerate);
+	ms_filter_call_method(se->resampler, MS_FILTER_SET_OUTPUT_SAMPLE_RATE, &se->config.samplerate);
+
+	se->pin = find_free_pin(conf->mixer);
+	ms_filter_link(conf->mixer, se->pin, se->resampler, 0);
+	ms_filter_link(se->resampler, 0, se->encoder, 0);
+	ms_filter_link(se->encoder, 0, se->tee, 0);
+	ms_message("Shared %s encoder created on mixer pin %i", se->config.mime_type, se->pin);
+	return se;
+}
+
+static void shared_encoder_destroy(MSAudioConference *conf, SharedEncoder *se) {
+	ms_filter_unlink(conf->mixer, se->pin, se->resampler, 0);
+	ms_filter_unlink(se->resampler, 0, se->encoder, 0);
+	ms_filter_unlink(se->encoder, 0, se->tee, 0);
+	ms_filter_destroy(se->resampler);
+	ms_filter_destroy(se->encoder);
+	ms_filter_destroy(se->tee);
+	ms_free((char *)se->config.mime_type);
+	if (se->config.fmtp) ms_free((char *)se->config.fmtp);
+	ms_free(se);
+}
+
+/* must be called while the conference graph is detached from its ticker */
+static void shared_encoder_add_listener(MSAudioEndpoint *ep) {
+	MSAudioConference *conf = ep->conference;
+	SharedEncoderConfig config;
+	SharedEncoder *se = NULL;
+	const bctbx_list_t *elem;
+	MSFilter *encoder, *rtpsend;
+	int pin;
+
+	if (!endpoint_get_encoder_config(ep, &config)) return;
+	for (elem = conf->shared_encoders; elem != NULL; elem = elem->next) {
+		SharedEncoder *it = (SharedEncoder *)elem->data;
+		if (it->nlisteners < SHARED_ENCODER_MAX_LISTENERS && shared_encoder_config_equals(&it->config, &config)) {
+			se = it;
+			break;
+		}
+	}
+	if (se == NULL) {
+		se = shared_encoder_new(conf, ep->st->ms.factory, &config);
+		if (se == NULL) return;
+		conf->shared_encoders = bctbx_list_append(conf->shared_encoders, se);
+	}
+	for (pin = 0; se->listeners[pin] != NULL; ++pin)
+		;
+	se->listeners[pin] = ep;
+	se->nlisteners++;
+	ep->shared_encoder = se;
+	ep->shared_pin = pin;
+	ep->listening = FALSE;
+
+	encoder = ep->st->ms.encoder;
+	rtpsend = ep->st->ms.rtpsend;
+	ep->shared_join = ms_factory_create_filter(ep->st->ms.factory, MS_JOIN_ID);
+	ms_filter_unlink(encoder, 0, rtpsend, 0);
+	ms_filter_link(encoder, 0, ep->shared_join, 0);
+	ms_filter_link(se->tee, pin, ep->shared_join, 1);
+	ms_filter_link(ep->shared_join, 0, rtpsend, 0);
+	/* the endpoint starts with its own encoder, ms_audio_conference_process_events() decides when it can listen */
+	ms_filter_call_method(se->tee, MS_TEE_MUTE, &pin);
+}
+
+/* must be called while the conference graph is detached from its ticker */
+static void shared_encoder_remove_listener(MSAudioEndpoint *ep) {
+	MSAudioConference *conf = ep->conference;
+	SharedEncoder *se = ep->shared_encoder;
+	MSFilter *encoder = ep->st->ms.encoder, *rtpsend = ep->st->ms.rtpsend;
+
+	if (se == NULL) return;
+	ms_filter_unlink(encoder, 0, ep->shared_join, 0);
+	ms_filter_unlink(se->tee, ep->shared_pin, ep->shared_join, 1);
+	ms_filter_unlink(ep->shared_join, 0, rtpsend, 0);
+	ms_filter_link(encoder, 0, rtpsend, 0);
+	ms_filter_destroy(ep->shared_join);
+	ep->shared_join = NULL;
+
+	if (ep->listening) {
+		MSAudioMixerCtl ctl = {0};
+		ctl.pin = ep->pin;
+		ctl.param.enabled = TRUE;
+		ms_filter_call_method(conf->mixer, MS_AUDIO_MIXER_ENABLE_OUTPUT, &ctl);
+		if (ms_filter_has_method(encoder, MS_AUDIO_ENCODER_RESET)) {
+			ms_filter_call_method_noarg(encoder, MS_AUDIO_ENCODER_RESET);
+		}
+		ms_filter_call_method_noarg(rtpsend, MS_RTP_SEND_NOTIFY_SOURCE_CHANGE);
+		ep->listening = FALSE;
+	}
+	se->listeners[ep->shared_pin] = NULL;
+	ep->shared_encoder = NULL;
+	if (--se->nlisteners == 0) {
+		conf->shared_encoders = bctbx_list_remove(conf->shared_encoders, se);
+		shared_encoder_destroy(conf, se);
+	}
+}
+
+/* Switches an endpoint between its own encoder, fed with its own mix, and the shared encoder of the mix of all the
+ * contributors. A listener does not contribute to the mix, otherwise it would hear itself. */
+static void shared_encoder_set_listening(MSAudioEndpoint *ep, bool_t listening) {
+	MSAudioMixerCtl ctl = {0};
+	MSFilter *mixer = ep->conference->mixer;
+
+	ctl.pin = ep->pin;
+	ctl.param.active = !listening && !ep->muted;
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_ACTIVE, &ctl);
+	ctl.param.enabled = !listening;
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_ENABLE_OUTPUT, &ctl);
+	ms_filter_call_method(ep->shared_encoder->tee, listening ? MS_TEE_UNMUTE : MS_TEE_MUTE, &ep->shared_pin);
+	/* the own encoder restarts from where it stopped, with stale samples and prediction state */
+	if (!listening && ms_filter_has_method(ep->st->ms.encoder, MS_AUDIO_ENCODER_RESET)) {
+		ms_filter_call_method_noarg(ep->st->ms.encoder, MS_AUDIO_ENCODER_RESET);
+	}
+	/* both encoders have their own timestamp origin, the sender carries on the outgoing one */
+	ms_filter_call_method_noarg(ep->st->ms.rtpsend, MS_RTP_SEND_NOTIFY_SOURCE_CHANGE);
+	ep->listening = listening;
+}
+
+static int compare_levels(const void *a, const void *b) {
+	const MSAudioEndpoint *ep1 = *(const MSAudioEndpoint **)a;
+	const MSAudioEndpoint *ep2 = *(const MSAudioEndpoint **)b;
+	if (ep1->level > ep2->level) return -1;
+	if (ep1->level < ep2->level) return 1;
+	return 0;
+}
+
+/* Elects the contributors of the mix, the same way the mixer does: the unmuted participants, limited to the loudest
+ * ones when max_contributors is set. The others sharing an encoder become listeners. */
+static void update_shared_listeners(MSAudioConference *obj) {
+	MSAudioEndpoint **candidates;
+	const bctbx_list_t *elem;
+	int ncandidates = 0, i;
+	bool_t locked = FALSE;
+
+	if (obj->shared_encoders == NULL) return;
+	candidates = ms_new0(MSAudioEndpoint *, obj->nmembers);
+	for (elem = obj->members; elem != NULL; elem = elem->next) {
+		MSAudioEndpoint *ep = (MSAudioEndpoint *)elem->data;
+		if (!ep->muted) candidates[ncandidates++] = ep;
+	}
+	if (obj->max_contributors > 0 && ncandidates > obj->max_contributors) {
+		qsort(candidates, ncandidates, sizeof(MSAudioEndpoint *), compare_levels);
+	}
+	for (elem = obj->members; elem != NULL; elem = elem->next) {
+		MSAudioEndpoint *ep = (MSAudioEndpoint *)elem->data;
+		bool_t contributing = FALSE;
+
+		if (ep->shared_encoder == NULL) continue;
+		for (i = 0; i < ncandidates && !contributing; ++i) {
+			if (obj->max_contributors > 0 && i >= obj->max_contributors) break;
+			contributing = (candidates[i] == ep);
+		}
+		if (ep->listening == !contributing) continue;
+		if (!locked) {
+			/* the mixer and the tee must switch between the same two ticks */
+			ms_mutex_lock(&obj->ticker->lock);
+			locked = TRUE;
+		}
+		shared_encoder_set_listening(ep, !contributing);
+	}
+	if (locked) ms_mutex_unlock(&obj->ticker->lock);
+	ms_free(candidates);
+}
+
+void ms_audio_conference_enable_shared_encoding(MSAudioConference *obj, bool_t enabled) {
+	if (obj->params.mode != MSConferenceModeMixer) {
+		ms_warning("Cannot share encoders when the conference is not in mixer mode");
+		return;
+	}
+	if (obj->nmembers > 0) {
+		ms_warning("Shared encoding must be enabled before members are added to the conference");
+		return;
+	}
+	obj->shared_encoding = enabled;
+}
+
 void ms_audio_conference_add_member(MSAudioConference *obj, MSAudioEndpoint *ep) {
 	/* now connect to the mixer */
 	ep->conference = obj;
 	if (obj->nmembers > 0) ms_ticker_detach(obj->ticker, obj->mixer);
 	plumb_to_conf(ep);
+	if (obj->shared_encoding) shared_encoder_add_listener(ep);
 	ms_ticker_attach(obj->ticker, obj->mixer);
 	obj->members = bctbx_list_append(obj->members, ep);
 	obj->nmembers++;
@@ -367,6 +635,7 @@ static void unplumb_from_conf(MSAudioEndpoint *ep) {
 void ms_audio_conference_remove_member(MSAudioConference *obj, MSAudioEndpoint *ep) {
 	if (ep->conf_mode != MSConferenceModeMixer) unconfigure_output(ep);
 	ms_ticker_detach(obj->ticker, obj->mixer);
+	shared_encoder_remove_listener(ep);
 	unplumb_from_conf(ep);
 	ep->conference = NULL;
 	obj->nmembers--;
@@ -382,11 +651,20 @@ void ms_audio_conference_mute_member(MSAudioConference *obj, MSAudioEndpoint *ep
 
 	MSAudioMixerCtl ctl = {0};
 	ctl.pin = ep->pin;
-	ctl.param.active = !muted;
+	ctl.param.active = !muted && !ep->listening;
 	ep->muted = muted;
 	ms_filter_call_method(ep->conference->mixer, MS_AUDIO_MIXER_SET_ACTIVE, &ctl);
 }
 
+void ms_audio_conference_set_max_contributors(MSAudioConference *obj, int max_contributors) {
+	if (obj->params.mode != MSConferenceModeMixer) {
+		ms_warning("Cannot limit the number of contributors when the conference is not in mixer mode");
+		return;
+	}
+	obj->max_contributors = max_contributors;
+	ms_filter_call_method(obj->mixer, MS_AUDIO_MIXER_SET_MAX_CONTRIBUTORS, &max_contributors);
+}
+
 int ms_audio_conference_get_size(MSAudioConference *obj) {
 	return obj->nmembers;
 }
@@ -446,6 +724,14 @@ void ms_audio_conference_process_events(MSAudioConference *obj) {
 			if (volume_filter) {
 				float max_db = MS_VOLUME_DB_LOWEST;
 				if (ms_filter_call_method(volume_filter, MS_VOLUME_GET_MAX, &max_db) == 0) {
+					ep->level = max_db;
+					if (obj->max_contributors > 0) {
+						/* the mixer uses the levels to select the loudest contributors */
+						MSAudioMixerCtl ctl = {0};
+						ctl.pin = ep->pin;
+						ctl.param.level = max_db;
+						ms_filter_call_method(obj->mixer, MS_AUDIO_MIXER_SET_INPUT_LEVEL, &ctl);
+					}
 					if (max_db > audio_threshold_min_db && max_db > max_db_over_member) {
 						max_db_over_member = max_db;
 						winner = ep;
@@ -455,6 +741,7 @@ void ms_audio_conference_process_events(MSAudioConference *obj) {
 				}
 			}
 		}
+		update_shared_listeners(obj);
 	}
 
 	// Notify the active speaker
@@ -500,6 +787,7 @@ MSAudioEndpoint *ms_audio_endpoint_new(void) {
 
 	ep->samplerate = 8000;
 	ep->player_nchannels = -1;
+	ep->level = MS_VOLUME_DB_LOWEST;
 	return ep;
 }
 
@@ -234,7 +234,7 @@ void media_stream_start_ticker(MediaStream *stream) {
 	name[0] = toupper(name[0]);
 	params.name = name;
 	params.prio = __ms_get_default_prio((stream->type == MSVideo) ? TRUE : FALSE);
-	stream->sessions.ticker = ms_ticker_new_with_params(&params);
+	stream->sessions.ticker = ms_factory_create_ticker(stream->factory, &params);
 	if (stream->log_tag) bctbx_pop_log_tag(media_stream_id);
 }
 
@@ -219,7 +219,7 @@ VideoConferenceAllToAll::VideoConferenceAllToAll(MSFactory *f, const MSVideoConf
 	tickerParams.name = "Video conference(all to all)";
 	tickerParams.prio = __ms_get_default_prio(TRUE);
 
-	mTicker = ms_ticker_new_with_params(&tickerParams);
+	mTicker = ms_factory_create_ticker(f, &tickerParams);
 	mMixer = ms_factory_create_filter(f, MS_PACKET_ROUTER_ID);
 	mVoidSource = ms_factory_create_filter(f, MS_VOID_SOURCE_ID);
 	mVoidOutput = ms_factory_create_filter(f, MS_VOID_SINK_ID);
@@ -409,42 +409,51 @@ void VideoConferenceAllToAll::connectEndpoint(VideoEndpoint *ep) {
 	}
 }
 
+/* The senders are asked for the bitrate of the weakest receiver, unless they are temporally scalable: the router then
+ * thins their stream for each receiver, and they can target the best one. */
+static bool is_requested_bitrate(int bitrate, int requested_bitrate, bool_t scalable) {
+	if (requested_bitrate == -1) return true;
+	return scalable ? bitrate > requested_bitrate : bitrate < requested_bitrate;
+}
+
 void VideoConferenceAllToAll::updateBitrateRequest() {
 	const bctbx_list_t *elem;
-	int min_of_tmmbr = -1;
+	int requested_bitrate = -1;
+	bool_t scalable = FALSE;
+	ms_filter_call_method(mMixer, MS_PACKET_ROUTER_GET_TEMPORAL_SCALABILITY, &scalable);
 	for (elem = mEndpoints; elem != NULL; elem = elem->next) {
 		VideoEndpoint *ep = (VideoEndpoint *)elem->data;
 		if (ep->mSt->content != MSVideoContentThumbnail && ep->mLastTmmbrReceived != 0) {
-			if (min_of_tmmbr == -1) {
-				min_of_tmmbr = ep->mLastTmmbrReceived;
-			} else {
-				if (ep->mLastTmmbrReceived < min_of_tmmbr) {
-					min_of_tmmbr = ep->mLastTmmbrReceived;
-				}
+			if (is_requested_bitrate(ep->mLastTmmbrReceived, requested_bitrate, scalable)) {
+				requested_bitrate = ep->mLastTmmbrReceived;
 			}
 		}
 	}
 	for (elem = mMembers; elem != NULL; elem = elem->next) {
 		VideoEndpoint *ep = (VideoEndpoint *)elem->data;
 		if ((ep->mOutPin > -1) && ep->mLastTmmbrReceived != 0) {
-			if (min_of_tmmbr == -1) {
-				min_of_tmmbr = ep->mLastTmmbrReceived;
-			} else {
-				if (ep->mLastTmmbrReceived < min_of_tmmbr) {
-					min_of_tmmbr = ep->mLastTmmbrReceived;
-				}
+			if (is_requested_bitrate(ep->mLastTmmbrReceived, requested_bitrate, scalable)) {
+				requested_bitrate = ep->mLastTmmbrReceived;
 			}
 		}
 	}
-	if (min_of_tmmbr != -1) {
-		if (mBitrate != min_of_tmmbr) {
-			mBitrate = min_of_tmmbr;
+	if (requested_bitrate != -1) {
+		if (mBitrate != requested_bitrate) {
+			mBitrate = requested_bitrate;
 			ms_message("MSVideoConference [%p]: new bitrate requested: %i kbits/s.", this, mBitrate / 1000);
 			applyNewBitrateRequest();
 		}
 	}
 }
 
+void VideoConferenceAllToAll::setOutputMaxBitrate(VideoEndpoint *ep) {
+	if (ep->mOutPin < 0) return;
+	MSPacketRouterOutputBitrate ob;
+	ob.pin = ep->mOutPin;
+	ob.bitrate = ep->mLastTmmbrReceived;
+	ms_filter_call_method(mMixer, MS_PACKET_ROUTER_SET_OUTPUT_MAX_BITRATE, &ob);
+}
+
 void VideoConferenceAllToAll::configureOutput(VideoEndpoint *ep) {
 	MSPacketRouterPinData pd;
 	pd.input = ep->mSource;
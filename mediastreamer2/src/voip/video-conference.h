@@ -82,6 +82,7 @@ public:
 
 	MSFilter *getMixer() const;
 	void updateBitrateRequest();
+	void setOutputMaxBitrate(VideoEndpoint *ep);
 	void setLocalMember(MSPacketRouterPinControl pc);
 	void notifyFir(int pin);
 	void notifySli(int pin);
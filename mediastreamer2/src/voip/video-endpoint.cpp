@@ -83,6 +83,7 @@ static void ms_video_endpoint_tmmbr_received(const OrtpEventData *evd, void *use
 			           (int)(tmmbr_mxtbr / 1000), ep->mPin);
 			ep->mLastTmmbrReceived = tmmbr_mxtbr;
 			VideoConferenceAllToAll *conf = (VideoConferenceAllToAll *)ep->mConference;
+			conf->setOutputMaxBitrate(ep);
 			conf->updateBitrateRequest();
 		} break;
 		default:
@@ -590,6 +590,10 @@ VideoStream *video_stream_new2(MSFactory *factory, const char *ip, int loc_rtp_p
 	MSMediaStreamSessions sessions = {0};
 	VideoStream *obj;
 	sessions.rtp_session = ms_create_duplex_rtp_session(ip, loc_rtp_port, loc_rtcp_port, ms_factory_get_mtu(factory));
+	/* video packet rates are high enough for batched reception and sending to significantly reduce the system call
+	 * overhead */
+	rtp_session_set_recv_batch_size(sessions.rtp_session, 16);
+	rtp_session_set_send_batch_size(sessions.rtp_session, 32);
 	obj = video_stream_new_with_sessions(factory, &sessions);
 	obj->ms.owns_sessions = TRUE;
 	obj->display_mode = MSVideoDisplayHybrid;
@@ -24,6 +24,8 @@
 
 #include <limits.h>
 
+#include <ortp/rtpsession.h>
+
 static const int max_non_reference_frame_after_sli_or_pli = 60;
 
 /*#define VP8RTPFMT_DEBUG*/
@@ -1040,7 +1042,6 @@ static void packer_process_frame_part(void *p, void *c) {
 	Vp8RtpFmtPacket *packet = (Vp8RtpFmtPacket *)p;
 	Vp8RtpFmtPackerCtx *ctx = (Vp8RtpFmtPackerCtx *)c;
 	mblk_t *pdm = NULL;
-	mblk_t *dm = NULL;
 	uint8_t *rptr;
 	uint8_t pdsize = 1;
 	int max_size = (int)ctx->max_payload_size;
@@ -1058,8 +1059,10 @@ static void packer_process_frame_part(void *p, void *c) {
 
 	mblk_set_marker_info(packet->m, FALSE);
 	for (rptr = packet->m->b_rptr; rptr < packet->m->b_wptr;) {
-		/* Allocate the payload descriptor. */
-		pdm = allocb(pdsize, 0);
+		/* Allocate the payload descriptor, followed by the data of this packet and the room for the RTP header and
+		 * SRTP trailer, so that the packet is not copied again when sent. */
+		dlen = MIN((max_size - pdsize), (int)(packet->m->b_wptr - rptr));
+		pdm = rtp_create_payload(pdsize + dlen);
 		memset(pdm->b_wptr, 0, pdsize);
 		mblk_set_timestamp_info(pdm, mblk_get_timestamp_info(packet->m));
 		mblk_set_marker_info(pdm, FALSE);
@@ -1107,12 +1110,8 @@ static void packer_process_frame_part(void *p, void *c) {
 			pdm->b_wptr++;
 		}
 
-		dlen = MIN((max_size - pdsize), (int)(packet->m->b_wptr - rptr));
-		dm = dupb(packet->m);
-		dm->b_rptr = rptr;
-		dm->b_wptr = rptr + dlen;
-		dm->b_wptr = dm->b_rptr + dlen;
-		pdm->b_cont = dm;
+		memcpy(pdm->b_wptr, rptr, dlen);
+		pdm->b_wptr += dlen;
 		rptr += dlen;
 
 		ms_queue_put(ctx->output_queue, pdm);
@@ -1120,7 +1119,6 @@ static void packer_process_frame_part(void *p, void *c) {
 
 	/* Set marker bit on last packet if required. */
 	if (pdm != NULL) mblk_set_marker_info(pdm, marker_info);
-	if (dm != NULL) mblk_set_marker_info(dm, marker_info);
 
 	freeb(packet->m);
 	packet->m = NULL;
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mediastreamer2/msaudiomixer.h"
+#include "mediastreamer2/msticker.h"
+#include "mediastreamer2_tester.h"
+#include "mediastreamer2_tester_private.h"
+
+#define MIXER_TEST_MAX_INPUTS 4
+
+static MSFactory *_factory = NULL;
+
+static int tester_before_all(void) {
+	_factory = ms_tester_factory_new();
+	return 0;
+}
+
+static int tester_after_all(void) {
+	ms_factory_destroy(_factory);
+	return 0;
+}
+
+/* The mixer is driven tick by tick by the test: packets are put directly into its input queues and its outputs are
+ * read back after each process() call, so that the exact samples it computes can be checked. */
+typedef struct MixerTest {
+	MSTicker ticker;
+	MSFilter *mixer;
+	MSFilter *sources[MIXER_TEST_MAX_INPUTS];
+	MSFilter *sinks[MIXER_TEST_MAX_INPUTS];
+	int ninputs;
+	int nsamples;
+} MixerTest;
+
+static void mixer_test_init(MixerTest *t, int ninputs, int rate) {
+	int conf_mode = TRUE;
+	int i;
+
+	memset(t, 0, sizeof(*t));
+	t->ninputs = ninputs;
+	t->ticker.interval = 10;
+	t->nsamples = (rate * t->ticker.interval) / 1000;
+	t->mixer = ms_factory_create_filter(_factory, MS_AUDIO_MIXER_ID);
+	ms_filter_call_method(t->mixer, MS_FILTER_SET_SAMPLE_RATE, &rate);
+	ms_filter_call_method(t->mixer, MS_AUDIO_MIXER_ENABLE_CONFERENCE_MODE, &conf_mode);
+	for (i = 0; i < ninputs; ++i) {
+		t->sources[i] = ms_factory_create_filter(_factory, MS_VOID_SOURCE_ID);
+		t->sinks[i] = ms_factory_create_filter(_factory, MS_VOID_SINK_ID);
+		ms_filter_link(t->sources[i], 0, t->mixer, i);
+		ms_filter_link(t->mixer, i, t->sinks[i], 0);
+	}
+}
+
+static void mixer_test_start(MixerTest *t) {
+	ms_filter_preprocess(t->mixer, &t->ticker);
+}
+
+static void mixer_test_uninit(MixerTest *t) {
+	int i;
+
+	ms_filter_postprocess(t->mixer);
+	for (i = 0; i < t->ninputs; ++i) {
+		ms_filter_unlink(t->sources[i], 0, t->mixer, i);
+		ms_filter_unlink(t->mixer, i, t->sinks[i], 0);
+		ms_filter_destroy(t->sources[i]);
+		ms_filter_destroy(t->sinks[i]);
+	}
+	ms_filter_destroy(t->mixer);
+}
+
+/* Feeds one tick of samples to every input, runs the mixer and stores what each output received in outputs. */
+static void mixer_test_tick(MixerTest *t, int16_t **inputs, int16_t **outputs) {
+	int i;
+
+	for (i = 0; i < t->ninputs; ++i) {
+		mblk_t *m = allocb(t->nsamples * 2, 0);
+		memcpy(m->b_wptr, inputs[i], t->nsamples * 2);
+		m->b_wptr += t->nsamples * 2;
+		ms_queue_put(t->mixer->inputs[i], m);
+	}
+	t->ticker.time += t->ticker.interval;
+	ms_filter_process(t->mixer);
+	for (i = 0; i < t->ninputs; ++i) {
+		mblk_t *m = ms_queue_get(t->mixer->outputs[i]);
+		BC_ASSERT_PTR_NOT_NULL(m);
+		if (m == NULL) continue;
+		BC_ASSERT_EQUAL((int)msgdsize(m), t->nsamples * 2, int, "%d");
+		memcpy(outputs[i], m->b_rptr, MIN((int)msgdsize(m), t->nsamples * 2));
+		freemsg(m);
+		BC_ASSERT_TRUE(ms_queue_empty(t->mixer->outputs[i]));
+	}
+}
+
+static int16_t ref_saturate(int32_t s) {
+	if (s > 32767) return 32767;
+	if (s < -32767) return -32767;
+	return (int16_t)s;
+}
+
+static int compare_samples(const int16_t *expected, const int16_t *got, int nsamples) {
+	int i;
+	for (i = 0; i < nsamples; ++i) {
+		if (expected[i] != got[i]) {
+			ms_error("Sample %i differs: expected %i, got %i", i, expected[i], got[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static uint32_t next_random(uint32_t *seed) {
+	*seed = *seed * 1664525 + 1013904223;
+	return *seed >> 16;
+}
+
+/* Mixes the inputs with a plain scalar loop, the way the vectorized accumulate(), apply_gain() and mix_minus() of the
+ * mixer must do it, and compares with the actual output of each channel. */
+static void check_mix_against_reference(int rate) {
+	const float gains[MIXER_TEST_MAX_INPUTS] = {1.0f, 1.5f, 0.5f, 1.0f};
+	const int ninputs = 3;
+	int16_t *inputs[MIXER_TEST_MAX_INPUTS];
+	int16_t *outputs[MIXER_TEST_MAX_INPUTS];
+	int16_t *expected;
+	int32_t *sum;
+	uint32_t seed = 1234;
+	MixerTest t;
+	int tick, i, k;
+
+	mixer_test_init(&t, ninputs, rate);
+	for (i = 0; i < ninputs; ++i) {
+		MSAudioMixerCtl ctl = {0};
+		ctl.pin = i;
+		ctl.param.gain = gains[i];
+		ms_filter_call_method(t.mixer, MS_AUDIO_MIXER_SET_INPUT_GAIN, &ctl);
+		inputs[i] = ms_new0(int16_t, t.nsamples);
+		outputs[i] = ms_new0(int16_t, t.nsamples);
+	}
+	expected = ms_new0(int16_t, t.nsamples);
+	sum = ms_new0(int32_t, t.nsamples);
+	mixer_test_start(&t);
+
+	for (tick = 0; tick < 8; ++tick) {
+		for (i = 0; i < ninputs; ++i) {
+			for (k = 0; k < t.nsamples; ++k) {
+				switch (tick % 4) {
+					case 0: /* full scale noise, the sums and the gains often saturate */
+						inputs[i][k] = (int16_t)next_random(&seed);
+						break;
+					case 1: /* everything at the positive and negative extremes of int16 */
+						inputs[i][k] = (k & 1) ? 32767 : -32768;
+						break;
+					case 2: /* low level noise, nothing saturates */
+						inputs[i][k] = (int16_t)((int)(next_random(&seed) % 2001) - 1000);
+						break;
+					default: /* a single loud sample at the very end, handled by the scalar remainder */
+						inputs[i][k] = (k == t.nsamples - 1) ? (int16_t)(i % 2 ? -32768 : 32767) : 0;
+						break;
+				}
+			}
+		}
+		mixer_test_tick(&t, inputs, outputs);
+
+		memset(sum, 0, t.nsamples * sizeof(int32_t));
+		for (i = 0; i < ninputs; ++i) {
+			for (k = 0; k < t.nsamples; ++k) {
+				/* the gain is applied in place, the own contribution removed from the sum is the amplified one */
+				if (gains[i] != 1.0f) inputs[i][k] = ref_saturate((int32_t)(gains[i] * (float)inputs[i][k]));
+				sum[k] += inputs[i][k];
+			}
+		}
+		for (i = 0; i < ninputs; ++i) {
+			for (k = 0; k < t.nsamples; ++k) {
+				expected[k] = ref_saturate(sum[k] - (int32_t)inputs[i][k]);
+			}
+			BC_ASSERT_EQUAL(compare_samples(expected, outputs[i], t.nsamples), 0, int, "%d");
+		}
+	}
+
+	mixer_test_uninit(&t);
+	for (i = 0; i < ninputs; ++i) {
+		ms_free(inputs[i]);
+		ms_free(outputs[i]);
+	}
+	ms_free(expected);
+	ms_free(sum);
+}
+
+static void mix_matches_scalar_reference(void) {
+	/* 80 samples per tick is a multiple of every vector width, 110 and 441 leave a remainder, 441 being odd */
+	check_mix_against_reference(8000);
+	check_mix_against_reference(11025);
+	check_mix_against_reference(44100);
+}
+
+static void set_input_level(MSFilter *mixer, int pin, float level) {
+	MSAudioMixerCtl ctl = {0};
+	ctl.pin = pin;
+	ctl.param.level = level;
+	ms_filter_call_method(mixer, MS_AUDIO_MIXER_SET_INPUT_LEVEL, &ctl);
+}
+
+static void check_constant_output(const int16_t *samples, int nsamples, int16_t value) {
+	int k;
+	for (k = 0; k < nsamples; ++k) {
+		if (samples[k] != value) break;
+	}
+	BC_ASSERT_EQUAL(k, nsamples, int, "%d");
+	if (k < nsamples) ms_error("Sample %i is %i instead of %i", k, samples[k], value);
+}
+
+static void loudest_contributors_only(void) {
+	const int16_t values[MIXER_TEST_MAX_INPUTS] = {1000, 2000, 4000, 8000};
+	int16_t *inputs[MIXER_TEST_MAX_INPUTS];
+	int16_t *outputs[MIXER_TEST_MAX_INPUTS];
+	int max_contributors = 2;
+	MixerTest t;
+	int i, k;
+
+	mixer_test_init(&t, MIXER_TEST_MAX_INPUTS, 16000);
+	ms_filter_call_method(t.mixer, MS_AUDIO_MIXER_SET_MAX_CONTRIBUTORS, &max_contributors);
+	for (i = 0; i < MIXER_TEST_MAX_INPUTS; ++i) {
+		inputs[i] = ms_new0(int16_t, t.nsamples);
+		outputs[i] = ms_new0(int16_t, t.nsamples);
+		for (k = 0; k < t.nsamples; ++k)
+			inputs[i][k] = values[i];
+	}
+	mixer_test_start(&t);
+
+	/* the levels, not the signals, decide: inputs 0 and 2 are the two loudest */
+	set_input_level(t.mixer, 0, -10.0f);
+	set_input_level(t.mixer, 1, -40.0f);
+	set_input_level(t.mixer, 2, -20.0f);
+	set_input_level(t.mixer, 3, -50.0f);
+	mixer_test_tick(&t, inputs, outputs);
+	/* each contributor hears the other one only, the others hear both contributors */
+	check_constant_output(outputs[0], t.nsamples, 4000);
+	check_constant_output(outputs[2], t.nsamples, 1000);
+	check_constant_output(outputs[1], t.nsamples, 5000);
+	check_constant_output(outputs[3], t.nsamples, 5000);
+
+	/* input 3 becomes the loudest, input 2 is no longer mixed */
+	set_input_level(t.mixer, 3, -5.0f);
+	mixer_test_tick(&t, inputs, outputs);
+	check_constant_output(outputs[3], t.nsamples, 1000);
+	check_constant_output(outputs[0], t.nsamples, 8000);
+	check_constant_output(outputs[1], t.nsamples, 9000);
+	check_constant_output(outputs[2], t.nsamples, 9000);
+
+	/* without limit, everybody is mixed and hears all the others */
+	max_contributors = 0;
+	ms_filter_call_method(t.mixer, MS_AUDIO_MIXER_SET_MAX_CONTRIBUTORS, &max_contributors);
+	mixer_test_tick(&t, inputs, outputs);
+	for (i = 0; i < MIXER_TEST_MAX_INPUTS; ++i) {
+		check_constant_output(outputs[i], t.nsamples, 15000 - values[i]);
+	}
+
+	mixer_test_uninit(&t);
+	for (i = 0; i < MIXER_TEST_MAX_INPUTS; ++i) {
+		ms_free(inputs[i]);
+		ms_free(outputs[i]);
+	}
+}
+
+static test_t tests[] = {
+    TEST_NO_TAG("Mix matches scalar reference", mix_matches_scalar_reference),
+    TEST_NO_TAG("Loudest contributors only", loudest_contributors_only),
+};
+
+test_suite_t audio_mixer_test_suite = {
+    "Audio Mixer", tester_before_all, tester_after_all, NULL, NULL, sizeof(tests) / sizeof(tests[0]), tests, 0};
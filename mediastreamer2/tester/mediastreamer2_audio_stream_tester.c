@@ -22,6 +22,7 @@
 
 #include "mediastreamer2/dtmfgen.h"
 #include "mediastreamer2/mediastream.h"
+#include "mediastreamer2/msconference.h"
 #include "mediastreamer2/msfileplayer.h"
 #include "mediastreamer2/msfilerec.h"
 #include "mediastreamer2/msrtp.h"
@@ -1693,6 +1694,111 @@ static void voice_activity_detection(void) {
 	                          MARGAUX_RTCP_PORT, MARIELLE_RTCP_PORT, 0, TRUE);
 }
 
+typedef struct _SentTimestamps {
+	uint32_t last_ts;
+	int packets;
+	int markers;
+	int backward;
+} SentTimestamps;
+
+static int sent_timestamps_on_send(RtpTransportModifier *t, mblk_t *msg) {
+	SentTimestamps *sent = (SentTimestamps *)t->data;
+	uint32_t ts;
+
+	if (msgdsize(msg) < RTP_FIXED_HEADER_SIZE || rtp_get_version(msg) != 2 || rtp_get_payload_type(msg) != 0)
+		return (int)msgdsize(msg);
+	ts = rtp_get_timestamp(msg);
+	if (sent->packets > 0 && !RTP_TIMESTAMP_IS_STRICTLY_NEWER_THAN(ts, sent->last_ts)) {
+		ms_error("Sent timestamp %u does not follow %u", ts, sent->last_ts);
+		sent->backward++;
+	}
+	if (rtp_get_markbit(msg)) sent->markers++;
+	sent->last_ts = ts;
+	sent->packets++;
+	return (int)msgdsize(msg);
+}
+
+static int sent_timestamps_on_receive(BCTBX_UNUSED(RtpTransportModifier *t), mblk_t *msg) {
+	return (int)msgdsize(msg);
+}
+
+static void sent_timestamps_destroy(RtpTransportModifier *t) {
+	ms_free(t);
+}
+
+static void sent_timestamps_watch(AudioStream *st, SentTimestamps *sent) {
+	RtpTransportModifier *modifier = ms_new0(RtpTransportModifier, 1);
+	RtpTransport *rtpt = NULL;
+
+	modifier->data = sent;
+	modifier->t_process_on_send = sent_timestamps_on_send;
+	modifier->t_process_on_receive = sent_timestamps_on_receive;
+	modifier->t_destroy = sent_timestamps_destroy;
+	rtp_session_get_transports(st->ms.sessions.rtp_session, &rtpt, NULL);
+	meta_rtp_transport_append_modifier(rtpt, modifier);
+}
+
+/* A participant of a conference with shared encoding alternates between its own encoder when it talks and the shared
+ * one when it listens. The switches happen faster than the sender's timestamp adjustment threshold, the timestamps
+ * sent to the participant must go on increasing nonetheless. */
+static void shared_encoder_switch_in_audio_conference(void) {
+	const int ports[3] = {MARIELLE_RTP_PORT, MARGAUX_RTP_PORT, PAULINE_IN_RTP_PORT};
+	MSAudioConferenceParams params = {0};
+	MSAudioConference *conf;
+	AudioStream *streams[3];
+	MSAudioEndpoint *endpoints[3];
+	SentTimestamps sent = {0};
+	bool_t muted = FALSE;
+	int i, j;
+
+	if (ms_factory_lookup_filter_by_id(_factory, MS_RESAMPLE_ID) == NULL) {
+		ms_warning("resampler not available, skiping...");
+		return;
+	}
+	params.samplerate = 8000;
+	params.mode = MSConferenceModeMixer;
+	conf = ms_audio_conference_new(&params, _factory);
+	ms_audio_conference_enable_shared_encoding(conf, TRUE);
+
+	for (i = 0; i < 3; ++i) {
+		streams[i] = audio_stream_new2(_factory, MARIELLE_IP, ports[i], ports[i] + 1);
+		BC_ASSERT_EQUAL(audio_stream_start_full(streams[i], &rtp_profile, MARGAUX_IP, PAULINE_OUT_RTP_PORT, MARGAUX_IP,
+		                                        PAULINE_OUT_RTCP_PORT, 0, 50, NULL, NULL, NULL, NULL, 0),
+		                0, int, "%d");
+		endpoints[i] = ms_audio_endpoint_get_from_stream(streams[i], TRUE, MSConferenceModeMixer);
+	}
+	sent_timestamps_watch(streams[0], &sent);
+	for (i = 0; i < 3; ++i) {
+		ms_audio_conference_add_member(conf, endpoints[i]);
+	}
+	/* the last participant only listens, so that the shared encoder is used */
+	ms_audio_conference_mute_member(conf, endpoints[2], TRUE);
+
+	/* the first participant stops and starts talking every 100ms */
+	for (i = 0; i < 10; ++i) {
+		ms_audio_conference_mute_member(conf, endpoints[0], muted = !muted);
+		for (j = 0; j < 5; ++j) {
+			ms_audio_conference_process_events(conf);
+			ms_usleep(20000);
+		}
+	}
+
+	for (i = 0; i < 3; ++i) {
+		ms_audio_conference_remove_member(conf, endpoints[i]);
+		ms_audio_endpoint_release_from_stream(endpoints[i]);
+	}
+	ms_audio_conference_destroy(conf);
+
+	BC_ASSERT_GREATER(sent.packets, 40, int, "%d");
+	BC_ASSERT_EQUAL(sent.backward, 0, int, "%d");
+	/* each switch starts a talkspurt */
+	BC_ASSERT_GREATER(sent.markers, 10, int, "%d");
+
+	for (i = 0; i < 3; ++i) {
+		audio_stream_stop(streams[i]);
+	}
+}
+
 static test_t tests[] = {
     TEST_NO_TAG("Basic audio stream", basic_audio_stream),
     TEST_NO_TAG("Multicast audio stream", multicast_audio_stream),
@@ -1727,6 +1833,7 @@ static test_t tests[] = {
     TEST_NO_TAG("Participants volumes in audio stream", participants_volumes_in_audio_stream),
     TEST_NO_TAG("Voice activity detection", voice_activity_detection),
     TEST_NO_TAG("Auto bundle multiple audiostream in reception", multiple_audiostreams_auto_bundled),
+    TEST_NO_TAG("Shared encoder switch in audio conference", shared_encoder_switch_in_audio_conference),
 };
 
 test_suite_t audio_stream_test_suite = {
@@ -601,11 +601,154 @@ static void test_worker_threads_2(void) {
 	}
 }
 
+#define TICKER_POOL_NB_TICKERS 8
+
+static void test_ticker_pool(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSTickerParams params = {0};
+	MSTicker *tickers[TICKER_POOL_NB_TICKERS];
+	MSFilter *sources[TICKER_POOL_NB_TICKERS];
+	MSFilter *sinks[TICKER_POOL_NB_TICKERS];
+	int i;
+
+	ms_factory_enable_ticker_pool(factory, TRUE, 2);
+	BC_ASSERT_PTR_NOT_NULL(ms_factory_get_ticker_pool(factory));
+	if (ms_factory_get_ticker_pool(factory) == NULL) goto end;
+	BC_ASSERT_EQUAL(ms_ticker_pool_get_worker_count(ms_factory_get_ticker_pool(factory)), 2, int, "%i");
+
+	params.name = "Pooled ticker";
+	params.prio = MS_TICKER_PRIO_NORMAL;
+	for (i = 0; i < TICKER_POOL_NB_TICKERS; i++) {
+		tickers[i] = ms_factory_create_ticker(factory, &params);
+		BC_ASSERT_PTR_NOT_NULL(tickers[i]->pool);
+		sources[i] = ms_factory_create_filter(factory, MS_VOID_SOURCE_ID);
+		sinks[i] = ms_factory_create_filter(factory, MS_VOID_SINK_ID);
+		ms_filter_link(sources[i], 0, sinks[i], 0);
+		ms_ticker_attach(tickers[i], sources[i]);
+	}
+	BC_ASSERT_EQUAL(ms_ticker_pool_get_ticker_count(ms_factory_get_ticker_pool(factory)), TICKER_POOL_NB_TICKERS, int,
+	                "%i");
+
+	ms_usleep(500000);
+
+	for (i = 0; i < TICKER_POOL_NB_TICKERS; i++) {
+		uint32_t ticks;
+		ms_ticker_detach(tickers[i], sources[i]);
+		ticks = tickers[i]->ticks;
+		/* 500 ms at 10 ms per tick */
+		BC_ASSERT_GREATER(ticks, 30, int, "%i");
+		BC_ASSERT_LOWER(ticks, 70, int, "%i");
+		ms_filter_unlink(sources[i], 0, sinks[i], 0);
+		ms_filter_destroy(sources[i]);
+		ms_filter_destroy(sinks[i]);
+		ms_ticker_destroy(tickers[i]);
+	}
+	BC_ASSERT_EQUAL(ms_ticker_pool_get_ticker_count(ms_factory_get_ticker_pool(factory)), 0, int, "%i");
+end:
+	ms_factory_destroy(factory);
+}
+
+#define CODEC_POOL_NB_QUEUES 4
+#define CODEC_POOL_NB_TASKS 50
+
+typedef struct _CodecPoolQueueCtx {
+	int next_seq;
+	int running;
+	bool_t out_of_order;
+	bool_t concurrent;
+} CodecPoolQueueCtx;
+
+typedef struct _CodecPoolTask {
+	CodecPoolQueueCtx *ctx;
+	int seq;
+} CodecPoolTask;
+
+static bool_t codec_pool_task(void *data) {
+	CodecPoolTask *task = (CodecPoolTask *)data;
+	CodecPoolQueueCtx *ctx = task->ctx;
+	if (ctx->running) ctx->concurrent = TRUE;
+	ctx->running = 1;
+	if (task->seq != ctx->next_seq) ctx->out_of_order = TRUE;
+	ctx->next_seq++;
+	ms_usleep(200);
+	ctx->running = 0;
+	return TRUE;
+}
+
+static void test_codec_worker_pool(void) {
+	MSFactory *factory = ms_tester_factory_new();
+	MSWorkerQueue *queues[CODEC_POOL_NB_QUEUES];
+	CodecPoolQueueCtx ctxs[CODEC_POOL_NB_QUEUES] = {{0}};
+	CodecPoolTask tasks[CODEC_POOL_NB_QUEUES][CODEC_POOL_NB_TASKS];
+	MSWorkerPoolStats stats;
+	MSWorkerQueue *standalone;
+	int done = 0;
+	int i, j;
+
+	BC_ASSERT_PTR_NULL(ms_factory_get_codec_worker_pool(factory));
+	/* without the pool, the queue has its own thread */
+	standalone = ms_factory_create_codec_worker_queue(factory, "test");
+	ms_worker_queue_add_task(standalone, do_something, &done);
+	ms_worker_queue_destroy(standalone, TRUE);
+	BC_ASSERT_EQUAL(done, 1, int, "%i");
+
+	ms_factory_enable_codec_worker_pool(factory, TRUE, 2);
+	BC_ASSERT_PTR_NOT_NULL(ms_factory_get_codec_worker_pool(factory));
+	if (ms_factory_get_codec_worker_pool(factory) == NULL) goto end;
+
+	for (i = 0; i < CODEC_POOL_NB_QUEUES; i++) {
+		queues[i] = ms_factory_create_codec_worker_queue(factory, "test");
+	}
+	ms_worker_pool_get_stats(ms_factory_get_codec_worker_pool(factory), &stats);
+	BC_ASSERT_EQUAL(stats.worker_count, 2, int, "%i");
+	BC_ASSERT_EQUAL(stats.queue_count, CODEC_POOL_NB_QUEUES, int, "%i");
+
+	/* interleave the tasks of all queues, each queue must still run its own tasks in order and one at a time */
+	for (j = 0; j < CODEC_POOL_NB_TASKS; j++) {
+		for (i = 0; i < CODEC_POOL_NB_QUEUES; i++) {
+			tasks[i][j].ctx = &ctxs[i];
+			tasks[i][j].seq = j;
+			ms_worker_queue_add_task(queues[i], codec_pool_task, &tasks[i][j]);
+		}
+	}
+	for (i = 0; i < CODEC_POOL_NB_QUEUES; i++) {
+		ms_worker_queue_destroy(queues[i], TRUE);
+		BC_ASSERT_EQUAL(ctxs[i].next_seq, CODEC_POOL_NB_TASKS, int, "%i");
+		BC_ASSERT_FALSE(ctxs[i].out_of_order);
+		BC_ASSERT_FALSE(ctxs[i].concurrent);
+	}
+
+	ms_worker_pool_get_stats(ms_factory_get_codec_worker_pool(factory), &stats);
+	BC_ASSERT_EQUAL(stats.queue_count, 0, int, "%i");
+	BC_ASSERT_EQUAL(stats.pending_tasks, 0, int, "%i");
+	BC_ASSERT_EQUAL((int)stats.executed_tasks, CODEC_POOL_NB_QUEUES * CODEC_POOL_NB_TASKS, int, "%i");
+	BC_ASSERT_GREATER(stats.max_pending_tasks, 0, int, "%i");
+	BC_ASSERT_GREATER(stats.mean_run_time, 0.0f, float, "%f");
+	BC_ASSERT_TRUE(stats.max_wait_time >= stats.mean_wait_time);
+
+	/* pending tasks are dropped when not finished */
+	queues[0] = ms_factory_create_codec_worker_queue(factory, "test");
+	ctxs[0].next_seq = 0;
+	for (j = 0; j < CODEC_POOL_NB_TASKS; j++) {
+		tasks[0][j].seq = j;
+		ms_worker_queue_add_task(queues[0], codec_pool_task, &tasks[0][j]);
+	}
+	ms_worker_queue_destroy(queues[0], FALSE);
+	BC_ASSERT_LOWER(ctxs[0].next_seq, CODEC_POOL_NB_TASKS, int, "%i");
+	BC_ASSERT_FALSE(ctxs[0].out_of_order);
+	ms_worker_pool_get_stats(ms_factory_get_codec_worker_pool(factory), &stats);
+	BC_ASSERT_EQUAL(stats.pending_tasks, 0, int, "%i");
+end:
+	ms_factory_destroy(factory);
+}
+
 static test_t tests[] = {TEST_NO_TAG("Multiple ms_voip_init", filter_register_tester),
                          TEST_NO_TAG("Is multicast", test_is_multicast),
                          TEST_NO_TAG("FilterDesc enabling/disabling", test_filterdesc_enable_disable),
                          TEST_NO_TAG("Worker threads", test_worker_threads),
                          TEST_NO_TAG("Worker threads 2", test_worker_threads_2),
+                         TEST_NO_TAG("Ticker pool", test_ticker_pool),
+                         TEST_NO_TAG("Codec worker pool", test_codec_worker_pool),
 #ifdef VIDEO_ENABLED
                          TEST_NO_TAG("Video processing function", test_video_processing),
                          TEST_NO_TAG("Copy ycbcrbiplanar to true yuv with downscaling",
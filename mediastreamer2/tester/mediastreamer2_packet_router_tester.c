@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of mediastreamer2
+ * (see https://gitlab.linphone.org/BC/public/mediastreamer2).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mediastreamer2/mspacketrouter.h"
+#include "mediastreamer2/msticker.h"
+#include "mediastreamer2_tester.h"
+#include "mediastreamer2_tester_private.h"
+#include "ortp/rtp.h"
+
+#define ROUTER_TEST_PAYLOAD_TYPE 96
+#define ROUTER_TEST_PAYLOAD_SIZE 1000
+
+static MSFactory *_factory = NULL;
+
+static int tester_before_all(void) {
+	_factory = ms_tester_factory_new();
+	return 0;
+}
+
+static int tester_after_all(void) {
+	ms_factory_destroy(_factory);
+	return 0;
+}
+
+/* A video router in full packet mode forwarding input 0 to output 0, driven tick by tick by the test. The key frames
+ * are found with the frame marking extension, as with end-to-end encryption. */
+typedef struct RouterTest {
+	MSTicker ticker;
+	RtpSession *session;
+	MSFilter *router;
+	MSFilter *source;
+	MSFilter *sink;
+	uint16_t in_seq;
+	uint32_t in_ts;
+	int out_seq;
+	int forwarded[RTP_FRAME_MARKER_TID_MASK + 1];
+	int seq_errors;
+} RouterTest;
+
+static void router_test_init(RouterTest *t) {
+	MSPacketRouterMode mode = MS_PACKET_ROUTER_MODE_VIDEO;
+	MSPacketRouterPinData pin_data = {0};
+	bool_t enabled = TRUE;
+
+	memset(t, 0, sizeof(*t));
+	t->ticker.interval = 10;
+	t->ticker.time = 10;
+	t->in_seq = 65000; /* wraps around during the test */
+	t->out_seq = -1;
+	t->session = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_payload_type(t->session, ROUTER_TEST_PAYLOAD_TYPE);
+
+	t->router = ms_factory_create_filter(_factory, MS_PACKET_ROUTER_ID);
+	t->source = ms_factory_create_filter(_factory, MS_VOID_SOURCE_ID);
+	t->sink = ms_factory_create_filter(_factory, MS_VOID_SINK_ID);
+	ms_filter_call_method(t->router, MS_PACKET_ROUTER_SET_ROUTING_MODE, &mode);
+	ms_filter_call_method(t->router, MS_PACKET_ROUTER_SET_FULL_PACKET_MODE_ENABLED, &enabled);
+	ms_filter_call_method(t->router, MS_PACKET_ROUTER_SET_END_TO_END_ENCRYPTION_ENABLED, &enabled);
+
+	pin_data.input = 0;
+	pin_data.output = 0;
+	pin_data.self = 1;
+	pin_data.active_speaker_enabled = FALSE;
+	ms_filter_call_method(t->router, MS_PACKET_ROUTER_CONFIGURE_OUTPUT, &pin_data);
+
+	ms_filter_link(t->source, 0, t->router, 0);
+	ms_filter_link(t->router, 0, t->sink, 0);
+	ms_filter_preprocess(t->router, &t->ticker);
+}
+
+static void router_test_uninit(RouterTest *t) {
+	int pin = 0;
+
+	ms_filter_postprocess(t->router);
+	ms_filter_call_method(t->router, MS_PACKET_ROUTER_UNCONFIGURE_OUTPUT, &pin);
+	ms_filter_unlink(t->source, 0, t->router, 0);
+	ms_filter_unlink(t->router, 0, t->sink, 0);
+	ms_filter_destroy(t->source);
+	ms_filter_destroy(t->sink);
+	ms_filter_destroy(t->router);
+	rtp_session_destroy(t->session);
+}
+
+static void router_test_set_max_bitrate(RouterTest *t, int bitrate) {
+	MSPacketRouterOutputBitrate output_bitrate;
+	output_bitrate.pin = 0;
+	output_bitrate.bitrate = bitrate;
+	BC_ASSERT_EQUAL(ms_filter_call_method(t->router, MS_PACKET_ROUTER_SET_OUTPUT_MAX_BITRATE, &output_bitrate), 0,
+	                int, "%d");
+}
+
+/* Sends one single packet frame of the given temporal layer, the very first one being a key frame. */
+static void router_test_tick(RouterTest *t, int tid) {
+	mblk_t *packet = rtp_session_create_packet_header(t->session, 0);
+	uint8_t marker = RTP_FRAME_MARKER_START | RTP_FRAME_MARKER_END | (uint8_t)tid;
+	mblk_t *m;
+
+	if (t->in_seq == 65000) marker |= RTP_FRAME_MARKER_INDEPENDENT;
+	if (tid > 0) marker |= RTP_FRAME_MARKER_DISCARDABLE;
+	rtp_set_seqnumber(packet, t->in_seq++);
+	rtp_set_timestamp(packet, t->in_ts);
+	t->in_ts += 900;
+	rtp_add_frame_marker(packet, RTP_EXTENSION_FRAME_MARKING, marker);
+	packet->b_cont = allocb(ROUTER_TEST_PAYLOAD_SIZE, 0);
+	memset(packet->b_cont->b_wptr, tid, ROUTER_TEST_PAYLOAD_SIZE);
+	packet->b_cont->b_wptr += ROUTER_TEST_PAYLOAD_SIZE;
+	msgpullup(packet, (size_t)-1);
+	ms_queue_put(t->router->inputs[0], packet);
+
+	t->ticker.time += t->ticker.interval;
+	ms_filter_process(t->router);
+
+	while ((m = ms_queue_get(t->router->outputs[0])) != NULL) {
+		uint8_t out_marker = 0;
+		if (rtp_get_frame_marker(m, RTP_EXTENSION_FRAME_MARKING, &out_marker)) {
+			t->forwarded[RTP_FRAME_MARKER_TID(out_marker)]++;
+		}
+		/* the packets dropped for the bitrate must not show as losses to the receiver */
+		if (t->out_seq != -1 && rtp_get_seqnumber(m) != (uint16_t)(t->out_seq + 1)) {
+			ms_error("Forwarded sequence number %u does not follow %i", rtp_get_seqnumber(m), t->out_seq);
+			t->seq_errors++;
+		}
+		t->out_seq = rtp_get_seqnumber(m);
+		freemsg(m);
+	}
+}
+
+/* Runs the given duration of a three layers stream, the layers of the successive frames being 0, 2, 1, 2. The base
+ * layer and the first one are about 200 kbits/s each, the second about 400 kbits/s. */
+static void router_test_run(RouterTest *t, int duration_ms) {
+	static const int pattern[4] = {0, 2, 1, 2};
+	int i;
+
+	memset(t->forwarded, 0, sizeof(t->forwarded));
+	for (i = 0; i < duration_ms / t->ticker.interval; ++i) {
+		router_test_tick(t, pattern[i % 4]);
+	}
+}
+
+static void drop_temporal_layers_over_bitrate(void) {
+	bool_t scalable = FALSE;
+	RouterTest t;
+
+	router_test_init(&t);
+	router_test_set_max_bitrate(&t, 300000);
+
+	/* until the bitrates of the layers are measured, everything is forwarded */
+	router_test_run(&t, 1000);
+	BC_ASSERT_EQUAL(t.forwarded[0], 25, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[1], 25, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[2], 50, int, "%d");
+
+	/* then only the base layer fits */
+	router_test_run(&t, 2000);
+	BC_ASSERT_EQUAL(t.forwarded[0], 50, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[1], 0, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[2], 0, int, "%d");
+	ms_filter_call_method(t.router, MS_PACKET_ROUTER_GET_TEMPORAL_SCALABILITY, &scalable);
+	BC_ASSERT_TRUE(scalable);
+
+	/* the first layer fits too */
+	router_test_set_max_bitrate(&t, 500000);
+	router_test_run(&t, 2000);
+	BC_ASSERT_EQUAL(t.forwarded[0], 50, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[1], 50, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[2], 0, int, "%d");
+
+	/* no more limit */
+	router_test_set_max_bitrate(&t, 0);
+	router_test_run(&t, 2000);
+	BC_ASSERT_EQUAL(t.forwarded[0], 50, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[1], 50, int, "%d");
+	BC_ASSERT_EQUAL(t.forwarded[2], 100, int, "%d");
+
+	BC_ASSERT_EQUAL(t.seq_errors, 0, int, "%d");
+	router_test_uninit(&t);
+}
+
+static test_t tests[] = {
+    TEST_NO_TAG("Drop temporal layers over bitrate", drop_temporal_layers_over_bitrate),
+};
+
+test_suite_t packet_router_test_suite = {
+    "Packet Router", tester_before_all, tester_after_all, NULL, NULL, sizeof(tests) / sizeof(tests[0]), tests, 0};
@@ -37,6 +37,7 @@ extern test_suite_t basic_audio_test_suite;
 extern test_suite_t sound_card_test_suite;
 extern test_suite_t adaptive_test_suite;
 extern test_suite_t audio_stream_test_suite;
+extern test_suite_t audio_mixer_test_suite;
 extern test_suite_t video_stream_test_suite;
 extern test_suite_t aec3_test_suite;
 extern test_suite_t qrcode_test_suite;
@@ -45,6 +46,7 @@ extern test_suite_t player_test_suite;
 extern test_suite_t recorder_test_suite;
 extern test_suite_t text_stream_test_suite;
 extern test_suite_t h26x_tools_test_suite;
+extern test_suite_t packet_router_test_suite;
 extern test_suite_t double_encryption_test_suite;
 extern test_suite_t smff_test_suite;
 #ifdef HAVE_PCAP
@@ -101,6 +101,9 @@ typedef struct rtp_audio_level {
 #define RTP_FRAME_MARKER_END (1 << 6)
 #define RTP_FRAME_MARKER_INDEPENDENT (1 << 5)
 #define RTP_FRAME_MARKER_DISCARDABLE (1 << 4)
+#define RTP_FRAME_MARKER_BASE_LAYER_SYNC (1 << 3)
+#define RTP_FRAME_MARKER_TID_MASK 0x07 /* temporal layer id of scalable streams, 0 for the base layer */
+#define RTP_FRAME_MARKER_TID(marker) ((marker) & RTP_FRAME_MARKER_TID_MASK)
 
 #define RTP_TIMESTAMP_IS_NEWER_THAN(ts1, ts2) ((uint32_t)((uint32_t)(ts1) - (uint32_t)(ts2)) < ((uint32_t)1 << 31))
 
@@ -104,6 +104,16 @@ typedef struct _JitterControl {
 	bool_t pad[2];
 } JitterControl;
 
+/*! Incoming packets waiting to be delivered, stored in a ring indexed by extended sequence number.
+ */
+typedef struct _JitterQueue {
+	mblk_t **slots;     /* ring of packets, NULL for the sequence numbers not received (yet) */
+	int size;           /* number of slots, always a power of two */
+	int q_mcount;       /* number of queued packets */
+	uint32_t first_seq; /* extended sequence number of the oldest queued packet */
+	uint32_t last_seq;  /* extended sequence number of the newest queued packet */
+} JitterQueue;
+
 typedef struct _WaitPoint {
 	ortp_mutex_t lock;
 	ortp_cond_t cond;
@@ -331,7 +341,7 @@ typedef struct _RtpStream {
 	OrtpStream gs;
 	int time_jump;
 	uint32_t ts_jump;
-	queue_t rq;
+	JitterQueue rq;
 	queue_t tev_rq;
 	void *QoSHandle;
 	unsigned long QoSFlowID;
@@ -445,6 +455,9 @@ struct _RtpSession {
 	RtpSessionMode mode;
 	struct _RtpScheduler *sched;
 	mblk_t *recv_block_cache;
+	struct _OrtpRecvBatch *recv_batch;
+	struct _OrtpSendBatch *send_batch;
+	struct _RtpDemux *demux;
 	uint32_t flags;
 	int dscp;
 	int multicast_ttl;
@@ -664,6 +677,12 @@ ORTP_PUBLIC void rtp_session_set_rtcp_xr_media_callbacks(RtpSession *session, co
 
 ORTP_PUBLIC void rtp_session_set_ssrc_changed_threshold(RtpSession *session, int numpackets);
 
+/* Room reserved in front of a payload for the RTP header with its CSRCs and header extensions, and after it for the
+ * trailers appended by the transport modifiers (SRTP authentication tag and MKI, EKT tag, original header block), so
+ * that a packet can be completed and encrypted without being copied. */
+#define RTP_PACKET_HEADROOM 128
+#define RTP_PACKET_TAILROOM 384
+
 /* low level packet creation function */
 /* deprecated set : use create_packet_header and then chain a payload mblk_t to it */
 ORTP_PUBLIC ORTP_DEPRECATED mblk_t *
@@ -749,6 +768,15 @@ ORTP_PUBLIC mblk_t *rtp_create_packet(const uint8_t *packet, size_t packet_size)
  */
 ORTP_PUBLIC mblk_t *rtp_package_packet(uint8_t *packet, size_t packet_size, void (*freefn)(void *));
 
+/** allocate an empty payload for size bytes of data, with RTP_PACKET_HEADROOM bytes reserved before it and
+ * RTP_PACKET_TAILROOM bytes after it. Once filled, the header created by rtp_session_create_packet_header() can be
+ * prepended in place with msgprepend(), and the transport modifiers (SRTP) can process the packet without copying it.
+ * @param[in] size	size of the payload data
+ *
+ * @return a message block with no data and the reserved room
+ */
+ORTP_PUBLIC mblk_t *rtp_create_payload(size_t size);
+
 /*low level recv and send functions */
 
 ORTP_PUBLIC mblk_t *rtp_session_recvm_with_ts(RtpSession *session, uint32_t user_ts);
@@ -809,6 +837,10 @@ ORTP_PUBLIC void rtp_session_set_data(RtpSession *session, void *data);
 ORTP_PUBLIC void *rtp_session_get_data(const RtpSession *session);
 
 ORTP_PUBLIC void rtp_session_set_recv_buf_size(RtpSession *session, int bufsize);
+ORTP_PUBLIC void rtp_session_set_recv_batch_size(RtpSession *session, int count);
+ORTP_PUBLIC void rtp_session_set_send_batch_size(RtpSession *session, int count);
+ORTP_PUBLIC void rtp_session_enable_send_gso(RtpSession *session, bool_t enabled);
+ORTP_PUBLIC void rtp_session_flush_send_batch(RtpSession *session);
 ORTP_PUBLIC void rtp_session_set_rtp_socket_send_buffer_size(RtpSession *session, unsigned int size);
 ORTP_PUBLIC void rtp_session_set_rtp_socket_recv_buffer_size(RtpSession *session, unsigned int size);
 
@@ -984,6 +1016,30 @@ ORTP_PUBLIC mblk_t *rtp_bundle_dispatch(RtpBundle *bundle, bool_t is_rtp, mblk_t
  * Warning: this function current implementation assumes a match MID/SSRC, it may change
  */
 ORTP_PUBLIC RtpSession *rtp_bundle_lookup_session_for_outgoing_packet(RtpBundle *bundle, mblk_t *m);
+
+/* RtpDemux api */
+
+/**
+ * A RtpDemux receives the RTP and RTCP packets (rtcp-mux) of many RtpSessions on a single local port, with one or
+ * several SO_REUSEPORT sockets, and dispatches them to their session according to the remote transport address, the
+ * SSRC, the MID or the local ICE username fragment of STUN binding requests.
+ * The sessions added to a demux send their packets through the shared sockets. The sockets are read when one of the
+ * sessions receives, or explicitly with rtp_demux_process().
+ */
+typedef struct _RtpDemux RtpDemux;
+
+ORTP_PUBLIC RtpDemux *rtp_demux_new(const char *addr, int port, int socket_count);
+ORTP_PUBLIC void rtp_demux_destroy(RtpDemux *demux);
+
+ORTP_PUBLIC int rtp_demux_get_local_port(const RtpDemux *demux);
+ORTP_PUBLIC void rtp_demux_set_mid_extension_id(RtpDemux *demux, int id);
+
+ORTP_PUBLIC void rtp_demux_add_session(RtpDemux *demux, RtpSession *session);
+ORTP_PUBLIC void rtp_demux_remove_session(RtpDemux *demux, RtpSession *session);
+ORTP_PUBLIC void rtp_demux_set_session_mid(RtpDemux *demux, RtpSession *session, const char *mid);
+ORTP_PUBLIC void rtp_demux_set_session_ice_ufrag(RtpDemux *demux, RtpSession *session, const char *ufrag);
+
+ORTP_PUBLIC void rtp_demux_process(RtpDemux *demux);
 ORTP_PUBLIC void
 rtp_session_use_local_addr(RtpSession *session, const char *rtp_local_addr, const char *rtcp_local_addr);
 
@@ -102,6 +102,17 @@ ORTP_PUBLIC int dblk_ref_value(dblk_t *db);
 ORTP_PUBLIC unsigned char *dblk_base(dblk_t *db);
 ORTP_PUBLIC unsigned char *dblk_lim(dblk_t *db);
 
+/* statistics of the per-thread pools used to allocate mblk_t and dblk_t */
+typedef struct _OrtpPacketPoolStats {
+	uint64_t mblk_allocations; /* number of mblk_t allocated */
+	uint64_t mblk_reuses;      /* number of mblk_t allocations served by a pool instead of the heap */
+	uint64_t dblk_allocations; /* number of dblk_t allocated */
+	uint64_t dblk_reuses;      /* number of dblk_t allocations served by a pool instead of the heap */
+	uint64_t pullups;          /* number of messages copied by msgpullup() and its variants into a new buffer */
+} OrtpPacketPoolStats;
+
+ORTP_PUBLIC void ortp_packet_pool_get_stats(OrtpPacketPoolStats *stats);
+
 ORTP_PUBLIC void qinit(queue_t *q);
 
 ORTP_PUBLIC void putq(queue_t *q, mblk_t *m);
@@ -126,6 +137,17 @@ ORTP_PUBLIC void mblk_meta_copy(const mblk_t *source, mblk_t *dest);
 ORTP_PUBLIC mblk_t *allocb(size_t size, int unused);
 #define BPRI_MED 0
 
+/* allocates a mblk_t, that points to a datab_t, that points to a buffer of size size preceded by headroom free bytes
+ and followed by tailroom free bytes. b_rptr and b_wptr point after the headroom, so that headers can be prepended and
+ trailers appended later without reallocating. */
+ORTP_PUBLIC mblk_t *allocb_with_room(size_t headroom, size_t size, size_t tailroom);
+
+/* returns the number of free bytes of the underlying buffer before b_rptr */
+ORTP_PUBLIC size_t mblk_headroom(const mblk_t *mp);
+
+/* returns the number of free bytes of the underlying buffer after b_wptr */
+ORTP_PUBLIC size_t mblk_tailroom(const mblk_t *mp);
+
 /* allocates a mblk_t, that points to a datab_t, that points to buf; buf will be freed using freefn */
 ORTP_PUBLIC mblk_t *esballoc(uint8_t *buf, size_t size, int pri, void (*freefn)(void *));
 
@@ -145,9 +167,15 @@ ORTP_PUBLIC mblk_t *dupmsg(mblk_t *m);
 /* returns the size of data of a message */
 ORTP_PUBLIC size_t msgdsize(const mblk_t *mp);
 
-/* concatenates all fragment of a complex message and crop or extend the buffer to the given length */
+/* concatenates all fragment of a complex message and crop or extend the buffer to the given length. Nothing is copied
+ if the message is a single block with a unique owner whose buffer already holds len bytes from b_rptr. */
 ORTP_PUBLIC void msgpullup(mblk_t *mp, size_t len);
 
+/* concatenates all fragments of a complex message into a buffer with at least headroom free bytes before the data and
+ tailroom free bytes after it. Nothing is copied if the message is already a single block with a unique owner and this
+ room. */
+ORTP_PUBLIC void msgpullup_with_room(mblk_t *mp, size_t headroom, size_t tailroom);
+
 /* concatenates all fragment of a complex message and insert an empty buffer of the given length at the given offset */
 ORTP_PUBLIC void msgpullup_with_insert(mblk_t *mp, size_t offset, size_t len);
 
@@ -162,6 +190,11 @@ ORTP_PUBLIC void msgappend(mblk_t *mp, const char *data, size_t size, bool_t pad
 
 ORTP_PUBLIC mblk_t *concatb(mblk_t *mp, mblk_t *newm);
 
+/* prepends the data of the single block hdr to mp. If mp is a single block with a unique owner and enough headroom, the
+ data is copied in place in front of the one of mp and hdr is freed, otherwise hdr is chained in front of mp. The
+ returned message carries the metadata of hdr in both cases. */
+ORTP_PUBLIC mblk_t *msgprepend(mblk_t *hdr, mblk_t *mp);
+
 /*Make sure the message has a unique owner, if not duplicate the underlying data buffer so that it can be changed
  without impacting others. Note that in case of copy, the message will be un-fragmented, exactly the way msgpullup()
  does. Always returns mp.*/
@@ -69,7 +69,7 @@ static void compute_bitrate_add_to_list_and_remove_oldest_value(OrtpAudioBandwid
  * a duplicate.
  *
  * Random duplicates created by the network may not arrive one after an other and
- * may not be detected by this simple algorithm, they are removed by rtp_putq. They may interfer
+ * may not be detected by this simple algorithm, they are removed by the jitter queue. They may interfer
  * with this mechanism, so one should not push too high the trust percentage
  *
  * If the packet is a duplicate, create an ABE packet and add it to the history, this may trigger
@@ -22,31 +22,239 @@
 #include "ortp-config.h"
 #endif
 #include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <set>
+
 #include <ortp/port.h>
 #include <ortp/str_utils.h>
 
+#include "utils.h"
+
 using namespace std;
 
+namespace {
+
+/*
+ * Packets are allocated and freed at a very high rate, often by different threads (the receiving thread allocates,
+ * the processing thread frees). To avoid going to the general heap for each of them, the mblk_t and the dblk_t with
+ * their buffer are kept in per-thread caches, by size classes. A block freed by a thread goes to the cache of that
+ * thread, whatever the thread that allocated it. The caches are bounded, and released when their thread exits.
+ * The reference count of a dblk_t is in the same allocation as the dblk_t and its buffer.
+ */
+
+enum SizeClass : uint8_t { SmallBlock = 0, MtuBlock, SizeClassCount, NoSizeClass = SizeClassCount };
+
+const size_t sClassSizes[SizeClassCount] = {256, 2048};
+const size_t sMaxCachedDblks[SizeClassCount] = {512, 256};
+const size_t sMaxCachedMblks = 1024;
+
+struct DblkAllocation {
+	dblk_t db;
+	atomic_int ref;
+	SizeClass sizeClass;
+};
+
+/* The buffer follows the DblkAllocation, keep it aligned on pointers. */
+const size_t sDblkHeaderSize = (sizeof(DblkAllocation) + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+struct FreeBlock {
+	FreeBlock *next;
+};
+
+class FreeList {
+public:
+	void *pop() {
+		FreeBlock *block = mHead;
+		if (block != nullptr) {
+			mHead = block->next;
+			mCount--;
+		}
+		return block;
+	}
+
+	bool push(void *ptr, size_t max) {
+		if (mCount >= max) return false;
+		FreeBlock *block = static_cast<FreeBlock *>(ptr);
+		block->next = mHead;
+		mHead = block;
+		mCount++;
+		return true;
+	}
+
+	void clear() {
+		void *ptr;
+		while ((ptr = pop()) != nullptr)
+			ortp_free(ptr);
+	}
+
+	size_t size() const {
+		return mCount;
+	}
+
+private:
+	FreeBlock *mHead = nullptr;
+	size_t mCount = 0;
+};
+
+/* Counters are only written by the owner thread, but may be read by any thread asking for the statistics. */
+class Counter {
+public:
+	void increment() {
+		mValue.store(mValue.load(memory_order_relaxed) + 1, memory_order_relaxed);
+	}
+
+	uint64_t get() const {
+		return mValue.load(memory_order_relaxed);
+	}
+
+private:
+	atomic<uint64_t> mValue{0};
+};
+
+class PacketPoolCache;
+
+struct PacketPoolRegistry {
+	mutex lock;
+	set<PacketPoolCache *> caches;
+	OrtpPacketPoolStats exited = {}; /* statistics of the caches of the threads that have exited */
+};
+
+PacketPoolRegistry &getRegistry() {
+	/* never destroyed, so that it outlives the caches of the threads still running at exit */
+	static PacketPoolRegistry *registry = new PacketPoolRegistry();
+	return *registry;
+}
+
+thread_local bool tPacketPoolCacheDestroyed = false;
+
+class PacketPoolCache {
+public:
+	PacketPoolCache() {
+		PacketPoolRegistry &registry = getRegistry();
+		lock_guard<mutex> guard(registry.lock);
+		registry.caches.insert(this);
+	}
+
+	~PacketPoolCache() {
+		PacketPoolRegistry &registry = getRegistry();
+		tPacketPoolCacheDestroyed = true;
+		mMblks.clear();
+		for (auto &dblks : mDblks)
+			dblks.clear();
+		lock_guard<mutex> guard(registry.lock);
+		registry.caches.erase(this);
+		addStats(&registry.exited);
+	}
+
+	mblk_t *allocMblk() {
+		void *ptr = mMblks.pop();
+		mMblkAllocations.increment();
+		if (ptr) {
+			mMblkReuses.increment();
+			memset(ptr, 0, sizeof(mblk_t));
+			return static_cast<mblk_t *>(ptr);
+		}
+		return static_cast<mblk_t *>(ortp_malloc0(sizeof(mblk_t)));
+	}
+
+	void freeMblk(mblk_t *mp) {
+		if (!mMblks.push(mp, sMaxCachedMblks)) ortp_free(mp);
+	}
+
+	DblkAllocation *allocDblk(SizeClass sizeClass) {
+		void *ptr = mDblks[sizeClass].pop();
+		mDblkAllocations.increment();
+		if (ptr) mDblkReuses.increment();
+		else ptr = ortp_malloc(sDblkHeaderSize + sClassSizes[sizeClass]);
+		return static_cast<DblkAllocation *>(ptr);
+	}
+
+	void freeDblk(DblkAllocation *allocation) {
+		if (!mDblks[allocation->sizeClass].push(allocation, sMaxCachedDblks[allocation->sizeClass]))
+			ortp_free(allocation);
+	}
+
+	void countHeapDblk() {
+		mDblkAllocations.increment();
+	}
+
+	void countPullup() {
+		mPullups.increment();
+	}
+
+	/* Must be called with the registry lock held. */
+	void addStats(OrtpPacketPoolStats *stats) const {
+		stats->mblk_allocations += mMblkAllocations.get();
+		stats->mblk_reuses += mMblkReuses.get();
+		stats->dblk_allocations += mDblkAllocations.get();
+		stats->dblk_reuses += mDblkReuses.get();
+		stats->pullups += mPullups.get();
+	}
+
+	static PacketPoolCache *get() {
+		/* the cache of this thread may already be destroyed when blocks are freed by other thread_local
+		 * destructors, these blocks then go back to the heap */
+		if (tPacketPoolCacheDestroyed) return nullptr;
+		thread_local PacketPoolCache cache;
+		return &cache;
+	}
+
+private:
+	FreeList mMblks;
+	FreeList mDblks[SizeClassCount];
+	Counter mMblkAllocations;
+	Counter mMblkReuses;
+	Counter mDblkAllocations;
+	Counter mDblkReuses;
+	Counter mPullups;
+};
+
+SizeClass getSizeClass(size_t size) {
+	for (uint8_t i = 0; i < SizeClassCount; ++i) {
+		if (size <= sClassSizes[i]) return static_cast<SizeClass>(i);
+	}
+	return NoSizeClass;
+}
+
+DblkAllocation *allocDblk(size_t size, bool pooled) {
+	SizeClass sizeClass = pooled ? getSizeClass(size) : NoSizeClass;
+	PacketPoolCache *cache = PacketPoolCache::get();
+	DblkAllocation *allocation;
+
+	if (cache && sizeClass != NoSizeClass) {
+		allocation = cache->allocDblk(sizeClass);
+	} else {
+		if (cache) cache->countHeapDblk();
+		allocation = static_cast<DblkAllocation *>(ortp_malloc(sDblkHeaderSize + size));
+		sizeClass = NoSizeClass;
+	}
+	new (&allocation->ref) atomic_int(1);
+	allocation->sizeClass = sizeClass;
+	allocation->db.db_ref = &allocation->ref;
+	return allocation;
+}
+
+} // namespace
+
 extern "C" {
 dblk_t *dblk_alloc(size_t size) {
-	struct datab *db;
-	size_t total_size = sizeof(struct datab) + size;
-	db = (struct datab *)ortp_malloc(total_size);
+	DblkAllocation *allocation = allocDblk(size, true);
+	dblk_t *db = &allocation->db;
 
-	db->db_base = (uint8_t *)db + sizeof(struct datab);
+	db->db_base = reinterpret_cast<uint8_t *>(allocation) + sDblkHeaderSize;
 	db->db_lim = db->db_base + size;
-	db->db_ref = new atomic_int(1);
 	db->db_freefn = NULL; /* the buffer pointed by db_base must never be freed !*/
 
 	return db;
 }
 struct datab *dblk_alloc2(uint8_t *buf, size_t size, void (*freefn)(void *)) {
-	struct datab *db;
-	db = (struct datab *)ortp_malloc(sizeof(struct datab));
+	DblkAllocation *allocation = allocDblk(0, false); /* the buffer is not ours */
+	dblk_t *db = &allocation->db;
 
 	db->db_base = buf;
 	db->db_lim = buf + size;
-	db->db_ref = new atomic_int(1);
 	db->db_freefn = freefn;
 
 	return db;
@@ -57,13 +265,19 @@ void dblk_ref(struct datab *data) {
 }
 
 void dblk_unref(struct datab *data) {
-	atomic_int previous_ref(
-	    atomic_fetch_sub_explicit(static_cast<atomic_int *>(data->db_ref), 1, memory_order_release));
+	int previous_ref = atomic_fetch_sub_explicit(static_cast<atomic_int *>(data->db_ref), 1, memory_order_acq_rel);
 	if (previous_ref == 1) {
+		/* the dblk_t is the first member of its allocation */
+		DblkAllocation *allocation = reinterpret_cast<DblkAllocation *>(data);
+		PacketPoolCache *cache;
+
 		if (data->db_freefn != NULL) data->db_freefn(data->db_base);
-		delete static_cast<atomic_int *>(data->db_ref);
 		data->db_ref = NULL;
-		ortp_free(data);
+		if (allocation->sizeClass != NoSizeClass && (cache = PacketPoolCache::get()) != nullptr) {
+			cache->freeDblk(allocation);
+		} else {
+			ortp_free(allocation);
+		}
 	}
 }
 
@@ -71,4 +285,30 @@ int dblk_ref_value(dblk_t *db) {
 	return (int)static_cast<atomic_int *>(db->db_ref)->load();
 }
 
-} // extern "C"
\ No newline at end of file
+mblk_t *ortp_mblk_alloc(void) {
+	PacketPoolCache *cache = PacketPoolCache::get();
+	if (cache) return cache->allocMblk();
+	return (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+}
+
+void ortp_mblk_free(mblk_t *mp) {
+	PacketPoolCache *cache = PacketPoolCache::get();
+	if (cache) cache->freeMblk(mp);
+	else ortp_free(mp);
+}
+
+void ortp_packet_pool_count_pullup(void) {
+	PacketPoolCache *cache = PacketPoolCache::get();
+	if (cache) cache->countPullup();
+}
+
+void ortp_packet_pool_get_stats(OrtpPacketPoolStats *stats) {
+	PacketPoolRegistry &registry = getRegistry();
+	lock_guard<mutex> guard(registry.lock);
+
+	*stats = registry.exited;
+	for (const auto cache : registry.caches)
+		cache->addStats(stats);
+}
+
+} // extern "C"
@@ -38,6 +38,7 @@
 #define JC_GAMMA (JC_BETA)
 
 #include "jitterctl.h"
+#include "jitterqueue.h"
 
 void jitter_control_init(JitterControl *ctl, PayloadType *payload) {
 	ctl->count = 0;
@@ -88,9 +89,9 @@ void jitter_control_update_corrective_slide(JitterControl *ctl) {
 	}
 }
 
-void jitter_control_update_size(JitterControl *ctl, queue_t *q) {
-	mblk_t *newest = qlast(q);
-	mblk_t *oldest = qbegin(q);
+void jitter_control_update_size(JitterControl *ctl, const JitterQueue *q) {
+	mblk_t *newest = jitter_queue_last(q);
+	mblk_t *oldest = jitter_queue_first(q);
 	uint32_t newest_ts, oldest_ts;
 	if (newest == NULL) return;
 	newest_ts = rtp_get_timestamp(newest);
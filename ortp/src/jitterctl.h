@@ -37,7 +37,7 @@ static ORTP_INLINE bool_t jitter_control_adaptive_enabled(JitterControl *ctl) {
 }
 void jitter_control_set_payload(JitterControl *ctl, PayloadType *pt);
 void jitter_control_update_corrective_slide(JitterControl *ctl);
-void jitter_control_update_size(JitterControl *ctl, queue_t *q);
+void jitter_control_update_size(JitterControl *ctl, const JitterQueue *q);
 float jitter_control_compute_mean_size(JitterControl *ctl);
 void jitter_control_new_packet(JitterControl *ctl, uint32_t packet_ts, uint32_t cur_str_ts);
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifdef HAVE_CONFIG_H
+#include "ortp-config.h"
+#endif
+#include "ortp/ortp.h"
+
+#include "jitterqueue.h"
+
+#define JITTER_QUEUE_INITIAL_SIZE 64
+/* seq numbers further apart cannot be ordered anyway, see RTP_SEQ_IS_STRICTLY_GREATER_THAN() */
+#define JITTER_QUEUE_MAX_SIZE 32768
+
+#define jitter_queue_slot(q, ext_seq) (q)->slots[(ext_seq) & (uint32_t)((q)->size - 1)]
+
+/* the extended sequence number of seq_number, relative to the newest packet of the queue */
+static uint32_t jitter_queue_extend_seq(const JitterQueue *q, uint16_t seq_number) {
+	return q->last_seq + (uint32_t)(int32_t)(int16_t)(uint16_t)(seq_number - (uint16_t)q->last_seq);
+}
+
+void jitter_queue_init(JitterQueue *q) {
+	memset(q, 0, sizeof(JitterQueue));
+}
+
+void jitter_queue_uninit(JitterQueue *q) {
+	jitter_queue_flush(q);
+	if (q->slots) ortp_free(q->slots);
+	q->slots = NULL;
+	q->size = 0;
+}
+
+void jitter_queue_flush(JitterQueue *q) {
+	mblk_t *mp;
+	while ((mp = jitter_queue_get(q)) != NULL) {
+		freemsg(mp);
+	}
+}
+
+static void jitter_queue_resize(JitterQueue *q, int size) {
+	mblk_t **slots = ortp_new0(mblk_t *, size);
+	mblk_t **old_slots = q->slots;
+	int old_size = q->size;
+	uint32_t ext_seq;
+
+	q->slots = slots;
+	q->size = size;
+	if (old_slots == NULL) return;
+	if (q->q_mcount > 0) {
+		for (ext_seq = q->first_seq; (int32_t)(ext_seq - q->last_seq) <= 0; ext_seq++) {
+			jitter_queue_slot(q, ext_seq) = old_slots[ext_seq & (uint32_t)(old_size - 1)];
+		}
+	}
+	ortp_free(old_slots);
+}
+
+/* makes sure that packets from first_seq to last_seq can be stored */
+static void jitter_queue_reserve(JitterQueue *q, uint32_t first_seq, uint32_t last_seq) {
+	uint32_t span = last_seq - first_seq + 1;
+	int size = q->size > 0 ? q->size : JITTER_QUEUE_INITIAL_SIZE;
+
+	while ((uint32_t)size < span)
+		size *= 2;
+	if (size != q->size) jitter_queue_resize(q, size);
+}
+
+int jitter_queue_put(JitterQueue *q, mblk_t *mp, int *discarded) {
+	uint16_t seq_number = rtp_get_seqnumber(mp);
+	uint32_t ext_seq;
+
+	ortp_debug("jitter_queue_put(): Enqueuing packet with ts=%u and seq=%i", rtp_get_timestamp(mp), seq_number);
+	if (q->q_mcount == 0) {
+		/* keep the extended sequence numbers continuous even if the queue went empty */
+		ext_seq = jitter_queue_extend_seq(q, seq_number);
+		jitter_queue_reserve(q, ext_seq, ext_seq);
+		q->first_seq = q->last_seq = ext_seq;
+	} else {
+		ext_seq = jitter_queue_extend_seq(q, seq_number);
+		if ((int32_t)(ext_seq - q->first_seq) < 0) {
+			if (q->last_seq - ext_seq + 1 > JITTER_QUEUE_MAX_SIZE) {
+				ortp_warning("jitter_queue_put: packet with seq=%u is too old to be queued", seq_number);
+				freemsg(mp);
+				(*discarded)++;
+				return 0;
+			}
+			jitter_queue_reserve(q, ext_seq, q->last_seq);
+			q->first_seq = ext_seq;
+		} else if ((int32_t)(ext_seq - q->last_seq) > 0) {
+			/* after a jump of sequence numbers, the oldest packets are dropped to make room */
+			while (q->q_mcount > 0 && ext_seq - q->first_seq + 1 > JITTER_QUEUE_MAX_SIZE) {
+				mblk_t *tmp = jitter_queue_get(q);
+				ortp_warning("jitter_queue_put: Discarding message with seq=%u, too far from incoming seq=%u",
+				             rtp_get_seqnumber(tmp), seq_number);
+				freemsg(tmp);
+				(*discarded)++;
+			}
+			if (q->q_mcount == 0) q->first_seq = ext_seq;
+			jitter_queue_reserve(q, q->first_seq, ext_seq);
+			q->last_seq = ext_seq;
+		} else if (jitter_queue_slot(q, ext_seq) != NULL) {
+			ortp_debug("jitter_queue_put: duplicated message.");
+			freemsg(mp);
+			return -1;
+		}
+	}
+	jitter_queue_slot(q, ext_seq) = mp;
+	q->q_mcount++;
+	return 0;
+}
+
+mblk_t *jitter_queue_first(const JitterQueue *q) {
+	return q->q_mcount > 0 ? jitter_queue_slot(q, q->first_seq) : NULL;
+}
+
+mblk_t *jitter_queue_last(const JitterQueue *q) {
+	return q->q_mcount > 0 ? jitter_queue_slot(q, q->last_seq) : NULL;
+}
+
+mblk_t *jitter_queue_find(const JitterQueue *q, uint16_t seq_number) {
+	uint32_t ext_seq;
+	mblk_t *mp;
+	if (q->q_mcount == 0) return NULL;
+	ext_seq = jitter_queue_extend_seq(q, seq_number);
+	/* out of the queue, the slot of ext_seq may hold another packet */
+	if ((int32_t)(ext_seq - q->first_seq) < 0 || (int32_t)(ext_seq - q->last_seq) > 0) return NULL;
+	mp = jitter_queue_slot(q, ext_seq);
+	if (mp != NULL && rtp_get_seqnumber(mp) != seq_number) return NULL;
+	return mp;
+}
+
+mblk_t *jitter_queue_next(const JitterQueue *q, const mblk_t *mp) {
+	uint32_t ext_seq = jitter_queue_extend_seq(q, rtp_get_seqnumber(mp));
+	while ((int32_t)(ext_seq - q->last_seq) < 0) {
+		mblk_t *next;
+		ext_seq++;
+		next = jitter_queue_slot(q, ext_seq);
+		if (next != NULL) return next;
+	}
+	return NULL;
+}
+
+void jitter_queue_remove(JitterQueue *q, mblk_t *mp) {
+	uint32_t ext_seq = jitter_queue_extend_seq(q, rtp_get_seqnumber(mp));
+
+	if (q->q_mcount == 0 || (int32_t)(ext_seq - q->first_seq) < 0 || jitter_queue_slot(q, ext_seq) != mp) {
+		ortp_error("jitter_queue_remove: packet %p is not queued", mp);
+		return;
+	}
+	jitter_queue_slot(q, ext_seq) = NULL;
+	q->q_mcount--;
+	if (q->q_mcount == 0) {
+		q->first_seq = q->last_seq;
+		return;
+	}
+	/* the slots of lost packets are skipped only once, when they reach one end of the queue */
+	if (ext_seq == q->first_seq) {
+		while (jitter_queue_slot(q, q->first_seq) == NULL)
+			q->first_seq++;
+	} else if (ext_seq == q->last_seq) {
+		while (jitter_queue_slot(q, q->last_seq) == NULL)
+			q->last_seq--;
+	}
+}
+
+mblk_t *jitter_queue_get(JitterQueue *q) {
+	mblk_t *mp = jitter_queue_first(q);
+	if (mp != NULL) jitter_queue_remove(q, mp);
+	return mp;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef JITTERQUEUE_H
+#define JITTERQUEUE_H
+
+#include <ortp/rtpsession.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The jitter queue keeps the received packets sorted by sequence number. A packet is stored in the slot given by its
+ * extended sequence number, so that insertion, duplicate detection and removal of the oldest packet do not depend on
+ * the number of packets already queued. The ring grows as needed, up to half of the sequence number space.
+ */
+
+void jitter_queue_init(JitterQueue *q);
+void jitter_queue_uninit(JitterQueue *q);
+/* remove and free all queued packets */
+void jitter_queue_flush(JitterQueue *q);
+
+/*
+ * Inserts mp in sequence number order. Returns -1 if a packet with the same sequence number is already queued, in
+ * which case mp is freed, 0 otherwise. The oldest packets that cannot fit anymore in the ring (after a large jump of
+ * sequence numbers) are freed and counted in discarded, mp included if it is the one too old.
+ */
+int jitter_queue_put(JitterQueue *q, mblk_t *mp, int *discarded);
+/* remove and return the oldest packet */
+mblk_t *jitter_queue_get(JitterQueue *q);
+void jitter_queue_remove(JitterQueue *q, mblk_t *mp);
+
+mblk_t *jitter_queue_first(const JitterQueue *q);
+mblk_t *jitter_queue_last(const JitterQueue *q);
+/* returns the queued packet following mp in sequence number order, NULL if mp is the newest */
+mblk_t *jitter_queue_next(const JitterQueue *q, const mblk_t *mp);
+mblk_t *jitter_queue_find(const JitterQueue *q, uint16_t seq_number);
+
+static ORTP_INLINE bool_t jitter_queue_empty(const JitterQueue *q) {
+	return q->q_mcount == 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <bctoolbox/defs.h>
+#include <bctoolbox/port.h>
+
+#include "ortp/logging.h"
+#include "ortp/rtpsession.h"
+#include "rtpdemux.h"
+#include "rtpsession_priv.h"
+#include "utils.h"
+
+// Maximum number of packets read from a socket by one call to process(), so that a flood cannot starve the caller.
+static constexpr int sMaxPacketsPerSocket = 1024;
+// Sessions reading their packets less than this interval after the last reading of the sockets do not read them again.
+static constexpr uint64_t sProcessIntervalMs = 5;
+
+static constexpr uint32_t sStunMagicCookie = 0x2112A442;
+static constexpr uint16_t sStunBindingRequest = 0x0001;
+static constexpr uint16_t sStunAttributeUsername = 0x0006;
+
+// C - Interface
+
+extern "C" RtpDemux *rtp_demux_new(const char *addr, int port, int socket_count) {
+	auto *demux = new RtpDemuxCxx();
+	if (!demux->open(addr, port, socket_count)) {
+		delete demux;
+		return nullptr;
+	}
+	return reinterpret_cast<RtpDemux *>(demux);
+}
+
+extern "C" void rtp_demux_destroy(RtpDemux *demux) {
+	delete reinterpret_cast<RtpDemuxCxx *>(demux);
+}
+
+extern "C" int rtp_demux_get_local_port(const RtpDemux *demux) {
+	return reinterpret_cast<const RtpDemuxCxx *>(demux)->getLocalPort();
+}
+
+extern "C" void rtp_demux_set_mid_extension_id(RtpDemux *demux, int id) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->setMidId(id);
+}
+
+extern "C" void rtp_demux_add_session(RtpDemux *demux, RtpSession *session) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->addSession(session);
+}
+
+extern "C" void rtp_demux_remove_session(RtpDemux *demux, RtpSession *session) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->removeSession(session);
+}
+
+extern "C" void rtp_demux_set_session_mid(RtpDemux *demux, RtpSession *session, const char *mid) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->setSessionMid(session, mid ? mid : "");
+}
+
+extern "C" void rtp_demux_set_session_ice_ufrag(RtpDemux *demux, RtpSession *session, const char *ufrag) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->setSessionIceUfrag(session, ufrag ? ufrag : "");
+}
+
+extern "C" void rtp_demux_process(RtpDemux *demux) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->process();
+}
+
+extern "C" void rtp_demux_session_address_updated(RtpDemux *demux, RtpSession *session) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->updateSessionAddress(session);
+}
+
+extern "C" void rtp_demux_process_from_session(RtpDemux *demux) {
+	reinterpret_cast<RtpDemuxCxx *>(demux)->processFromSession();
+}
+
+// C++ - Implementation
+
+RtpDemuxCxx::~RtpDemuxCxx() {
+	{
+		const std::lock_guard guard(mMutex);
+		for (auto *session : mSessions) {
+			detachSession(session);
+		}
+		mSessions.clear();
+	}
+	for (auto sock : mSockets) {
+		close_socket(sock);
+	}
+}
+
+bool RtpDemuxCxx::open(const std::string &addr, int port, int socketCount) {
+	if (socketCount < 1) socketCount = 1;
+	if (port <= 0 && socketCount > 1) {
+		ortp_warning("RtpDemux[%p]: a random port cannot be shared by several sockets, using a single one.", this);
+		socketCount = 1;
+	}
+
+	for (int i = 0; i < socketCount; ++i) {
+		ortp_socket_t sock = _ortp_create_and_bind(addr.c_str(), &port, &mSockFamily, socketCount > 1, &mLocAddr,
+		                                           &mLocAddrLen);
+		if (sock == (ortp_socket_t)-1) {
+			ortp_error("RtpDemux[%p]: cannot bind socket %d to %s port %d", this, i, addr.c_str(), port);
+			return false;
+		}
+		mSockets.push_back(sock);
+	}
+	mPort = port;
+	ortp_message("RtpDemux[%p]: listening on %s port %d with %d socket(s)", this, addr.c_str(), port, socketCount);
+	return true;
+}
+
+int RtpDemuxCxx::getLocalPort() const {
+	return mPort;
+}
+
+void RtpDemuxCxx::setMidId(int id) {
+	mMidId = id;
+}
+
+void RtpDemuxCxx::addSession(RtpSession *session) {
+	if (session->demux != nullptr) {
+		ortp_error("RtpDemux[%p]: session (%p) is already attached to a demux", this, session);
+		return;
+	}
+	if (session->bundle != nullptr) {
+		ortp_error("RtpDemux[%p]: session (%p) is part of a bundle and cannot be attached", this, session);
+		return;
+	}
+
+	// The session sends through one of the shared sockets, it does not own any socket anymore.
+	_rtp_session_release_sockets(session, FALSE);
+	session->rtp.gs.socket = mSockets[mNextSocket++ % mSockets.size()];
+	session->rtp.gs.sockfamily = session->rtcp.gs.sockfamily = mSockFamily;
+	session->rtp.gs.loc_port = session->rtcp.gs.loc_port = mPort;
+	memcpy(&session->rtp.gs.loc_addr, &mLocAddr, mLocAddrLen);
+	session->rtp.gs.loc_addrlen = mLocAddrLen;
+	// The shared socket must never be connected to the remote address of a session.
+	session->use_connect = FALSE;
+	rtp_session_enable_rtcp_mux(session, TRUE);
+
+	const std::lock_guard guard(mMutex);
+	session->demux = reinterpret_cast<RtpDemux *>(this);
+	mSessions.insert(session);
+	if (session->ssrc_set) mSsrcToSession[session->rcv.ssrc] = session;
+	if (session->rtp.gs.rem_addrlen > 0) {
+		mAddressToSession[getAddressKey((const struct sockaddr *)&session->rtp.gs.rem_addr,
+		                                session->rtp.gs.rem_addrlen)] = session;
+	}
+}
+
+template <typename Map>
+static void eraseSession(Map &map, RtpSession *session) {
+	for (auto it = map.begin(); it != map.end();) {
+		if (it->second == session) it = map.erase(it);
+		else ++it;
+	}
+}
+
+void RtpDemuxCxx::removeSession(RtpSession *session) {
+	const std::lock_guard guard(mMutex);
+
+	if (mSessions.erase(session) == 0) return;
+	eraseSession(mAddressToSession, session);
+	eraseSession(mSsrcToSession, session);
+	eraseSession(mMidToSession, session);
+	eraseSession(mIceUfragToSession, session);
+	detachSession(session);
+}
+
+void RtpDemuxCxx::detachSession(RtpSession *session) {
+	session->demux = nullptr;
+	session->rtp.gs.socket = (ortp_socket_t)-1;
+	session->rtcp.gs.socket = (ortp_socket_t)-1;
+}
+
+void RtpDemuxCxx::setSessionMid(RtpSession *session, const std::string &mid) {
+	const std::lock_guard guard(mMutex);
+
+	eraseSession(mMidToSession, session);
+	if (!mid.empty()) mMidToSession[mid] = session;
+}
+
+void RtpDemuxCxx::setSessionIceUfrag(RtpSession *session, const std::string &ufrag) {
+	const std::lock_guard guard(mMutex);
+
+	eraseSession(mIceUfragToSession, session);
+	if (!ufrag.empty()) mIceUfragToSession[ufrag] = session;
+}
+
+void RtpDemuxCxx::updateSessionAddress(RtpSession *session) {
+	const std::lock_guard guard(mMutex);
+
+	if (mSessions.find(session) == mSessions.end() || session->rtp.gs.rem_addrlen == 0) return;
+	mAddressToSession[getAddressKey((const struct sockaddr *)&session->rtp.gs.rem_addr, session->rtp.gs.rem_addrlen)] =
+	    session;
+}
+
+std::string RtpDemuxCxx::getAddressKey(const struct sockaddr *addr, socklen_t addrlen) {
+	switch (addr->sa_family) {
+		case AF_INET: {
+			const auto *in = reinterpret_cast<const struct sockaddr_in *>(addr);
+			std::string key(reinterpret_cast<const char *>(&in->sin_port), sizeof(in->sin_port));
+			key.append(reinterpret_cast<const char *>(&in->sin_addr), sizeof(in->sin_addr));
+			return key;
+		}
+		case AF_INET6: {
+			const auto *in6 = reinterpret_cast<const struct sockaddr_in6 *>(addr);
+			std::string key(reinterpret_cast<const char *>(&in6->sin6_port), sizeof(in6->sin6_port));
+			key.append(reinterpret_cast<const char *>(&in6->sin6_addr), sizeof(in6->sin6_addr));
+			return key;
+		}
+		default:
+			return std::string(reinterpret_cast<const char *>(addr), addrlen);
+	}
+}
+
+static bool isStunMessage(const mblk_t *m) {
+	const size_t size = m->b_wptr - m->b_rptr;
+	if (size < 20 || (m->b_rptr[0] & 0xC0) != 0) return false;
+	uint32_t cookie;
+	memcpy(&cookie, m->b_rptr + 4, sizeof(cookie));
+	return ntohl(cookie) == sStunMagicCookie;
+}
+
+// Returns the local ICE username fragment of a binding request, it is the part of the USERNAME before the colon.
+static std::string getStunLocalUfrag(const mblk_t *m) {
+	const uint8_t *data = m->b_rptr;
+	const size_t size = m->b_wptr - m->b_rptr;
+	const uint16_t type = (uint16_t)((data[0] << 8) | data[1]);
+	const size_t end = 20 + (size_t)((data[2] << 8) | data[3]);
+
+	if (type != sStunBindingRequest || end > size) return "";
+	for (size_t offset = 20; offset + 4 <= end;) {
+		const uint16_t attrType = (uint16_t)((data[offset] << 8) | data[offset + 1]);
+		const size_t attrLen = (size_t)((data[offset + 2] << 8) | data[offset + 3]);
+		if (offset + 4 + attrLen > end) break;
+		if (attrType == sStunAttributeUsername) {
+			const std::string username(reinterpret_cast<const char *>(data + offset + 4), attrLen);
+			return username.substr(0, username.find(':'));
+		}
+		offset += 4 + ((attrLen + 3) & ~(size_t)3);
+	}
+	return "";
+}
+
+std::string RtpDemuxCxx::getMid(const mblk_t *m) const {
+	uint8_t *data;
+	if (rtp_get_extbit(m)) {
+		if (const size_t midSize = rtp_get_extension_header(m, mMidId != -1 ? mMidId : RTP_EXTENSION_MID, &data);
+		    midSize != static_cast<size_t>(-1)) {
+			return {reinterpret_cast<char *>(data), midSize};
+		}
+	}
+	return "";
+}
+
+// Binds an address that is not bound to any session yet.
+void RtpDemuxCxx::learnAddress(const mblk_t *m, RtpSession *session) {
+	if (m->net_addrlen == 0) return;
+	if (mAddressToSession.emplace(getAddressKey((const struct sockaddr *)&m->net_addr, m->net_addrlen), session)
+	        .second) {
+		ortp_message("RtpDemux[%p]: new remote address for session (%p)", this, session);
+	}
+}
+
+RtpSession *RtpDemuxCxx::lookupSession(const mblk_t *m, bool isRtp) {
+	// The remote transport address is the primary key: once bound to a session, it is never taken over by another one
+	// because of a colliding SSRC, MID or ICE username fragment.
+	if (m->net_addrlen > 0) {
+		if (const auto it =
+		        mAddressToSession.find(getAddressKey((const struct sockaddr *)&m->net_addr, m->net_addrlen));
+		    it != mAddressToSession.end()) {
+			return it->second;
+		}
+	}
+
+	// Unknown address: identify the session from the packet and bind the address to it.
+	if (isStunMessage(m)) {
+		// Binding requests of a new ICE candidate pair are identified by the local username fragment.
+		if (const auto ufrag = getStunLocalUfrag(m); !ufrag.empty()) {
+			if (const auto it = mIceUfragToSession.find(ufrag); it != mIceUfragToSession.end()) {
+				learnAddress(m, it->second);
+				return it->second;
+			}
+		}
+	} else if (rtp_get_version(m) == 2 && (size_t)(m->b_wptr - m->b_rptr) >= RTP_FIXED_HEADER_SIZE) {
+		// The sender SSRC of all RTCP packets follows their common header.
+		uint32_t ssrc;
+		memcpy(&ssrc, m->b_rptr + 4, sizeof(ssrc));
+		ssrc = ntohl(ssrc);
+		if (const auto it = mSsrcToSession.find(ssrc); it != mSsrcToSession.end()) {
+			learnAddress(m, it->second);
+			return it->second;
+		}
+		if (isRtp) {
+			if (const auto mid = getMid(m); !mid.empty()) {
+				if (const auto it = mMidToSession.find(mid); it != mMidToSession.end()) {
+					ortp_message("RtpDemux[%p]: assigning SSRC %u to session (%p) using mid %s", this, ssrc,
+					             it->second, mid.c_str());
+					mSsrcToSession[ssrc] = it->second;
+					learnAddress(m, it->second);
+					return it->second;
+				}
+			}
+		}
+	}
+	return nullptr;
+}
+
+void RtpDemuxCxx::dispatch(mblk_t *m) {
+	bool isRtp = true;
+
+	if (rtp_get_version(m) == 2 && (size_t)(m->b_wptr - m->b_rptr) >= RTP_FIXED_HEADER_SIZE) {
+		const int pt = rtp_get_payload_type(m);
+		// rtcp-mux is always used on the shared sockets
+		if (pt >= 64 && pt <= 95) isRtp = false;
+	}
+
+	const std::lock_guard guard(mMutex);
+	RtpSession *session = lookupSession(m, isRtp);
+	if (session == nullptr) {
+		if ((mDroppedPackets++ % 1000) == 0) {
+			ortp_warning("RtpDemux[%p]: dropping packet from unknown source (%llu dropped so far)", this,
+			             (unsigned long long)mDroppedPackets);
+		}
+		freemsg(m);
+		return;
+	}
+
+	m->recv_addr.port = htons((uint16_t)mPort);
+	OrtpStream *os = isRtp ? &session->rtp.gs : &session->rtcp.gs;
+	ortp_mutex_lock(&os->bundleq_lock);
+	putq(&os->bundleq, m);
+	ortp_mutex_unlock(&os->bundleq_lock);
+}
+
+void RtpDemuxCxx::process() {
+	const std::lock_guard guard(mProcessMutex);
+	readSockets();
+}
+
+void RtpDemuxCxx::processFromSession() {
+	if (bctbx_get_cur_time_ms() - mLastProcessTime < sProcessIntervalMs) return;
+	// If another session is already reading the sockets, the packets will be found in the queue at next tick.
+	const std::unique_lock lock(mProcessMutex, std::try_to_lock);
+	if (lock.owns_lock()) readSockets();
+}
+
+void RtpDemuxCxx::readSockets() {
+	for (auto sock : mSockets) {
+		for (int i = 0; i < sMaxPacketsPerSocket; ++i) {
+			struct sockaddr_storage remaddr;
+			socklen_t addrlen = sizeof(remaddr);
+			mblk_t *m = allocb(UDP_MAX_SIZE, 0);
+			const int error = rtp_session_rtp_recv_abstract(sock, m, 0, (struct sockaddr *)&remaddr, &addrlen);
+
+			if (error <= 0) {
+				if (error == -1 && !is_would_block_error(getSocketErrorCode())) {
+					ortp_warning("RtpDemux[%p]: error receiving packet: %s", this, getSocketError());
+				}
+				freemsg(m);
+				break;
+			}
+			m->b_wptr += error;
+			if (m->timestamp.tv_sec == 0) bctbx_gettimeofday(&m->timestamp, nullptr);
+			dispatch(m);
+		}
+	}
+	mLastProcessTime = bctbx_get_cur_time_ms();
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RTPDEMUX_H
+#define RTPDEMUX_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ortp/rtpsession.h"
+
+// Receives the packets of many RtpSessions on a single local port, and dispatches them to their session.
+class RtpDemuxCxx {
+
+public:
+	RtpDemuxCxx() = default;
+	~RtpDemuxCxx();
+
+	RtpDemuxCxx(const RtpDemuxCxx &) = delete;
+	RtpDemuxCxx(RtpDemuxCxx &&) = delete;
+
+	bool open(const std::string &addr, int port, int socketCount);
+
+	int getLocalPort() const;
+	void setMidId(int id);
+
+	void addSession(RtpSession *session);
+	void removeSession(RtpSession *session);
+	void setSessionMid(RtpSession *session, const std::string &mid);
+	void setSessionIceUfrag(RtpSession *session, const std::string &ufrag);
+	void updateSessionAddress(RtpSession *session);
+
+	// Reads all the packets waiting on the sockets, and queues them in their session.
+	void process();
+	// Same as process(), unless it has been done very recently by another session.
+	void processFromSession();
+
+private:
+	void readSockets();
+	void dispatch(mblk_t *m);
+	RtpSession *lookupSession(const mblk_t *m, bool isRtp);
+	void learnAddress(const mblk_t *m, RtpSession *session);
+	void detachSession(RtpSession *session);
+
+	static std::string getAddressKey(const struct sockaddr *addr, socklen_t addrlen);
+	std::string getMid(const mblk_t *m) const;
+
+	std::vector<ortp_socket_t> mSockets;
+	size_t mNextSocket = 0;
+	int mSockFamily = AF_UNSPEC;
+	int mPort = 0;
+	struct sockaddr_storage mLocAddr = {};
+	socklen_t mLocAddrLen = 0;
+
+	std::unordered_set<RtpSession *> mSessions;
+	// The remote transport address is the fast path, the other maps serve to identify new remote addresses.
+	std::unordered_map<std::string, RtpSession *> mAddressToSession;
+	std::unordered_map<uint32_t, RtpSession *> mSsrcToSession;
+	std::unordered_map<std::string, RtpSession *> mMidToSession;
+	std::unordered_map<std::string, RtpSession *> mIceUfragToSession;
+	std::mutex mMutex;
+
+	std::mutex mProcessMutex;
+	std::atomic<uint64_t> mLastProcessTime{0};
+	uint64_t mDroppedPackets = 0;
+	int mMidId = -1;
+};
+
+#endif /* RTPDEMUX_H */
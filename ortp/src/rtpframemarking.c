@@ -26,10 +26,16 @@
  * See https://datatracker.ietf.org/doc/html/draft-ietf-avtext-framemarking-13
  * @param packet the RTP packet.
  * @param id the identifier of the frame marking extension.
- * @param marker the frame marker to add.
+ * @param marker the frame marker to add. If it carries a base layer sync flag or a temporal layer id, the extension
+ * uses the form of scalable streams, with a layer id of 0 and without TL0PICIDX.
  **/
 void rtp_add_frame_marker(mblk_t *packet, int id, uint8_t marker) {
-	rtp_add_extension_header(packet, id, 1, &marker);
+	if (marker & (RTP_FRAME_MARKER_BASE_LAYER_SYNC | RTP_FRAME_MARKER_TID_MASK)) {
+		uint8_t data[2] = {marker, 0};
+		rtp_add_extension_header(packet, id, sizeof(data), data);
+	} else {
+		rtp_add_extension_header(packet, id, 1, &marker);
+	}
 }
 
 /**
@@ -24,23 +24,28 @@
 
 #include "congestiondetector.h"
 #include "jitterctl.h"
+#include "jitterqueue.h"
 #include "ortp/ortp.h"
 #include "rtpsession_priv.h"
 #include "utils.h"
 #include "videobandwidthestimator.h"
 
-static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rtp, int *discarded, int *duplicate) {
-	mblk_t *tmp;
-	int header_size;
-	*discarded = 0;
-	*duplicate = 0;
-	header_size = RTP_FIXED_HEADER_SIZE + (4 * rtp->cc);
+static bool_t discard_empty_packet(mblk_t *mp, rtp_header_t *rtp, int *discarded) {
+	int header_size = RTP_FIXED_HEADER_SIZE + (4 * rtp->cc);
 	if ((mp->b_wptr - mp->b_rptr) == header_size) {
 		ortp_debug("Rtp packet contains no data.");
 		(*discarded)++;
 		freemsg(mp);
-		return FALSE;
+		return TRUE;
 	}
+	return FALSE;
+}
+
+static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rtp, int *discarded, int *duplicate) {
+	mblk_t *tmp;
+	*discarded = 0;
+	*duplicate = 0;
+	if (discard_empty_packet(mp, rtp, discarded)) return FALSE;
 
 	/* and then add the packet to the queue */
 	if (rtp_putq(q, mp) < 0) {
@@ -61,6 +66,30 @@ static bool_t queue_packet(queue_t *q, int maxrqsz, mblk_t *mp, rtp_header_t *rt
 	return TRUE;
 }
 
+static bool_t
+jitter_queue_packet(JitterQueue *q, int maxrqsz, mblk_t *mp, rtp_header_t *rtp, int *discarded, int *duplicate) {
+	*discarded = 0;
+	*duplicate = 0;
+	if (discard_empty_packet(mp, rtp, discarded)) return FALSE;
+
+	if (jitter_queue_put(q, mp, discarded) < 0) {
+		/* It was a duplicate packet */
+		(*duplicate)++;
+		return FALSE;
+	}
+
+	/* make some checks: q size must not exceed JBParameters::max_packets */
+	while (q->q_mcount > maxrqsz) {
+		/* remove the oldest mblk_t */
+		mblk_t *tmp = jitter_queue_get(q);
+
+		ortp_warning("rtp_parse: Jitter queue is full. Discarding message with ts=%u", rtp_get_timestamp(tmp));
+		freemsg(tmp);
+		(*discarded)++;
+	}
+	return TRUE;
+}
+
 static void compute_mean_and_deviation(uint32_t nb, double x, double *olds, double *oldm, double *news, double *newm) {
 	*newm = *oldm + (x - *oldm) / nb;
 	*news = *olds + ((x - *oldm) * (x - *newm));
@@ -379,7 +408,8 @@ void rtp_session_rtp_parse(
 		check_for_seq_number_gap_immediate(session, rtp);
 	}
 
-	if (queue_packet(&session->rtp.rq, session->rtp.jittctl.params.max_packets, mp, rtp, &discarded, &duplicate))
+	if (jitter_queue_packet(&session->rtp.rq, session->rtp.jittctl.params.max_packets, mp, rtp, &discarded,
+	                        &duplicate))
 		jitter_control_update_size(&session->rtp.jittctl, &session->rtp.rq);
 	stats->discarded += discarded;
 	ortp_global_stats.discarded += discarded;
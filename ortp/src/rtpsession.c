@@ -27,6 +27,7 @@
 #include "audiobandwidthestimator.h"
 #include "congestiondetector.h"
 #include "jitterctl.h"
+#include "jitterqueue.h"
 #include "ortp/ortp.h"
 #include "ortp/rtcp.h"
 #include "ortp/telephonyevents.h"
@@ -115,8 +116,8 @@ bool_t wait_point_check(WaitPoint *wp, uint32_t t) {
 
 extern void rtp_parse(RtpSession *session, mblk_t *mp, uint32_t local_str_ts, struct sockaddr *addr, socklen_t addrlen);
 
-/* put an rtp packet in queue. It is called by rtp_parse()
-   A return value of -1 means the packet was a duplicate, 0 means the packet was ok */
+/* put an rtp packet in queue. It is called by rtp_parse() for the telephone events, media packets go to the
+   JitterQueue. A return value of -1 means the packet was a duplicate, 0 means the packet was ok */
 int rtp_putq(queue_t *q, mblk_t *mp) {
 	mblk_t *tmp;
 	uint16_t seq_number = rtp_get_seqnumber(mp);
@@ -154,19 +155,19 @@ int rtp_putq(queue_t *q, mblk_t *mp) {
 	return 0;
 }
 
-mblk_t *rtp_peekq(queue_t *q, uint32_t timestamp, int *rejected) {
+mblk_t *rtp_peekq(JitterQueue *q, uint32_t timestamp, int *rejected) {
 	mblk_t *tmp, *ret = NULL, *old = NULL;
 	uint32_t ts_found = 0;
 
 	*rejected = 0;
 	ortp_debug("rtp_getq(): Timestamp %u wanted.", timestamp);
-	if (qempty(q)) {
+	if (jitter_queue_empty(q)) {
 		/*ortp_debug("rtp_getq: q is empty.");*/
 		return NULL;
 	}
 	/* return the packet with ts just equal or older than the asked timestamp */
 	/* packets with older timestamps are discarded */
-	while ((tmp = qfirst(q)) != NULL) {
+	while ((tmp = jitter_queue_first(q)) != NULL) {
 		uint32_t tmp_timestamp = rtp_get_timestamp(tmp);
 		ortp_debug("rtp_getq: Seeing packet with ts=%u", tmp_timestamp);
 
@@ -180,7 +181,7 @@ mblk_t *rtp_peekq(queue_t *q, uint32_t timestamp, int *rejected) {
 				(*rejected)++;
 				freemsg(old);
 			}
-			ret = peekq(q); /* dequeue the packet, since it has an interesting timestamp*/
+			ret = jitter_queue_first(q); /* dequeue the packet, since it has an interesting timestamp*/
 			ts_found = tmp_timestamp;
 			ortp_debug("rtp_getq: Found packet with ts=%u", tmp_timestamp);
 
@@ -192,24 +193,24 @@ mblk_t *rtp_peekq(queue_t *q, uint32_t timestamp, int *rejected) {
 	return ret;
 }
 
-mblk_t *rtp_peekq_permissive(queue_t *q, uint32_t timestamp, int *rejected) {
+mblk_t *rtp_peekq_permissive(JitterQueue *q, uint32_t timestamp, int *rejected) {
 	mblk_t *tmp, *ret = NULL;
 	uint32_t tmp_timestamp;
 
 	*rejected = 0;
 	ortp_debug("rtp_getq_permissive(): Timestamp %u wanted.", timestamp);
 
-	if (qempty(q)) {
+	if (jitter_queue_empty(q)) {
 		/*ortp_debug("rtp_getq: q is empty.");*/
 		return NULL;
 	}
 	/* return the packet with the older timestamp (provided that it is older than
 	the asked timestamp) */
-	tmp = qfirst(q);
+	tmp = jitter_queue_first(q);
 	tmp_timestamp = rtp_get_timestamp(tmp);
 	ortp_debug("rtp_getq_permissive: Seeing packet with ts=%u, seq=%u", tmp_timestamp, rtp_get_seqnumber(tmp));
 	if (RTP_TIMESTAMP_IS_NEWER_THAN(timestamp, tmp_timestamp)) {
-		ret = peekq(q); /* dequeue the packet, since it has an interesting timestamp*/
+		ret = jitter_queue_first(q); /* dequeue the packet, since it has an interesting timestamp*/
 		ortp_debug("rtp_getq_permissive: Found packet with ts=%u", tmp_timestamp);
 	}
 	return ret;
@@ -246,7 +247,7 @@ void rtp_session_init(RtpSession *session, RtpSessionMode mode) {
 	session->dscp = RTP_DEFAULT_DSCP;
 	session->multicast_ttl = RTP_DEFAULT_MULTICAST_TTL;
 	session->multicast_loopback = RTP_DEFAULT_MULTICAST_LOOPBACK;
-	qinit(&session->rtp.rq);
+	jitter_queue_init(&session->rtp.rq);
 	qinit(&session->rtp.tev_rq);
 	qinit(&session->rtp.winrq);
 	qinit(&session->contributing_sources);
@@ -1138,6 +1139,10 @@ mblk_t *rtp_package_packet(uint8_t *packet, size_t packet_size, void (*freefn)(v
 	return mp;
 }
 
+mblk_t *rtp_create_payload(size_t size) {
+	return allocb_with_room(RTP_PACKET_HEADROOM, size, RTP_PACKET_TAILROOM);
+}
+
 /******************* DEPRECATED packet creations functions ************************************
  * Do not create any more the whole packet including payload. The correct way to do that is:
  *    - create the packet header with rtp_session_create_packet_header<_XXX> function
@@ -1572,14 +1577,7 @@ static void payload_type_changed_notify(RtpSession *session, int paytype) {
  **/
 
 mblk_t *rtp_session_pick_with_cseq(RtpSession *session, const uint16_t sequence_number) {
-	queue_t *q = &session->rtp.rq;
-	mblk_t *mb;
-	for (mb = qbegin(q); !qend(q, mb); mb = qnext(q, mb)) {
-		if (rtp_get_seqnumber(mb) == sequence_number) {
-			return mb;
-		}
-	}
-	return NULL;
+	return jitter_queue_find(&session->rtp.rq, sequence_number);
 }
 
 static void check_for_seq_number_gap(RtpSession *session, rtp_header_t *rtp) {
@@ -1621,7 +1619,7 @@ static void check_for_seq_number_gap(RtpSession *session, rtp_header_t *rtp) {
 static void apply_fec_on_missing_packets(RtpSession *session) {
 
 	uint16_t last_seq_num = session->rtp.rcv_last_seq;
-	mblk_t *mp_newest = qlast(&session->rtp.rq);
+	mblk_t *mp_newest = jitter_queue_last(&session->rtp.rq);
 
 	if (mp_newest != NULL) {
 		uint16_t newest_seq_num = rtp_get_seqnumber(mp_newest);
@@ -1630,7 +1628,8 @@ static void apply_fec_on_missing_packets(RtpSession *session) {
 			uint16_t ref_seq_num = last_seq_num;
 			uint16_t next_seq_num = 0;
 			uint16_t seq_num_diff = 0;
-			for (mblk_t *mp = qbegin(&session->rtp.rq); !qend(&session->rtp.rq, mp); mp = qnext(&session->rtp.rq, mp)) {
+			for (mblk_t *mp = jitter_queue_first(&session->rtp.rq); mp != NULL;
+			     mp = jitter_queue_next(&session->rtp.rq, mp)) {
 
 				if (mp != NULL) {
 					uint16_t seq_num_missing = ref_seq_num + 1;
@@ -1651,7 +1650,8 @@ static void apply_fec_on_missing_packets(RtpSession *session) {
 
 							if (fec_mp != NULL) {
 								/* inject recovered packet in jitter buffer */
-								rtp_putq(&session->rtp.rq, fec_mp);
+								int discarded = 0;
+								jitter_queue_put(&session->rtp.rq, fec_mp, &discarded);
 							}
 							seq_num_missing++;
 							seq_num_diff--;
@@ -1748,12 +1748,12 @@ mblk_t *rtp_session_recvm_with_ts(RtpSession *session, uint32_t user_ts) {
 	 * until the queue size reaches jitt_comp */
 
 	if (session->flags & RTP_SESSION_RECV_SYNC) {
-		queue_t *q = &session->rtp.rq;
-		if (qempty(q)) {
+		JitterQueue *q = &session->rtp.rq;
+		if (jitter_queue_empty(q)) {
 			ortp_debug("Queue is empty.");
 			goto end;
 		}
-		rtp = (rtp_header_t *)qfirst(q)->b_rptr;
+		rtp = (rtp_header_t *)jitter_queue_first(q)->b_rptr;
 		session->rtp.rcv_ts_offset = rtp_header_get_timestamp(rtp);
 		session->rtp.rcv_last_ret_ts = user_ts; /* just to have an init value */
 		session->rcv.ssrc = rtp_header_get_ssrc(rtp);
@@ -1774,7 +1774,7 @@ mblk_t *rtp_session_recvm_with_ts(RtpSession *session, uint32_t user_ts) {
 		} else {
 			mp = rtp_peekq(&session->rtp.rq, ts, &rejected);
 		}
-	} else mp = peekq(&session->rtp.rq); /*no jitter buffer at all*/
+	} else mp = jitter_queue_first(&session->rtp.rq); /*no jitter buffer at all*/
 
 	session->stats.outoftime += rejected;
 	ortp_global_stats.outoftime += rejected;
@@ -1782,7 +1782,7 @@ mblk_t *rtp_session_recvm_with_ts(RtpSession *session, uint32_t user_ts) {
 
 end:
 
-	if (!qempty(&session->rtp.rq) && mp != NULL) remq(&session->rtp.rq, mp);
+	if (mp != NULL) jitter_queue_remove(&session->rtp.rq, mp);
 
 	if (mp != NULL) {
 		size_t msgsize = msgdsize(mp); /* evaluate how much bytes (including header) is received by app */
@@ -2039,10 +2039,17 @@ void _rtp_session_release_sockets(RtpSession *session, bool_t release_transports
 		session->rtcp.gs.tr = 0;
 	}
 
-	if (session->rtp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtp.gs.socket);
-	if (session->rtcp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtcp.gs.socket);
+	/* packets queued for batched sending still have to leave through the socket being closed */
+	rtp_session_flush_send_batch(session);
+	/* the sockets of a RtpDemux are shared with other sessions, it closes them itself */
+	if (session->demux == NULL) {
+		if (session->rtp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtp.gs.socket);
+		if (session->rtcp.gs.socket != (ortp_socket_t)-1) close_socket(session->rtcp.gs.socket);
+	}
 	session->rtp.gs.socket = -1;
 	session->rtcp.gs.socket = -1;
+	/* datagrams received in advance on the closed socket must not be delivered anymore */
+	rtp_session_flush_recv_batch(session);
 
 	/* don't discard remote addresses, then can be preserved for next use.
 	session->rtp.gs.rem_addrlen=0;
@@ -2140,12 +2147,13 @@ void rtp_session_uninit(RtpSession *session) {
 	}
 
 	/*flush all queues */
-	flushq(&session->rtp.rq, FLUSHALL);
+	jitter_queue_uninit(&session->rtp.rq);
 	flushq(&session->rtp.tev_rq, FLUSHALL);
 	flushq(&session->rtp.winrq, FLUSHALL);
 
 	if (session->eventqs != NULL) o_list_free(session->eventqs);
 	/* close sockets */
+	if (session->demux) rtp_demux_remove_session(session->demux, session);
 	rtp_session_release_sockets(session);
 
 	wait_point_uninit(&session->snd.wp);
@@ -2209,6 +2217,8 @@ void rtp_session_uninit(RtpSession *session) {
 	if (session->rtcp.send_algo.fb_packets) freemsg(session->rtcp.send_algo.fb_packets);
 	ortp_mutex_destroy(&session->main_mutex);
 	if (session->recv_block_cache) freemsg(session->recv_block_cache);
+	rtp_session_destroy_recv_batch(session);
+	rtp_session_destroy_send_batch(session);
 
 	flushq(&session->contributing_sources, 0);
 	rtcp_sdes_items_uninit(&session->sdes_items);
@@ -2229,7 +2239,7 @@ void rtp_session_set_ssrc_changed_threshold(RtpSession *session, int numpackets)
  * @param session the rtp session
  **/
 void rtp_session_resync(RtpSession *session) {
-	flushq(&session->rtp.rq, FLUSHALL);
+	jitter_queue_flush(&session->rtp.rq);
 	rtp_session_set_flag(session, RTP_SESSION_RECV_SYNC);
 	rtp_session_unset_flag(session, RTP_SESSION_FIRST_PACKET_DELIVERED);
 	rtp_session_init_jitter_buffer(session);
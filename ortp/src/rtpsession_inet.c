@@ -74,6 +74,13 @@
 #endif
 #ifdef HAVE_SENDMSG
 #define USE_SENDMSG 1
+#ifdef HAVE_SENDMMSG
+#define USE_SENDMMSG 1
+#include <netinet/udp.h>
+#endif
+#endif
+#ifdef HAVE_RECVMMSG
+#define USE_RECVMMSG 1
 #endif
 #endif
 
@@ -201,12 +208,12 @@ static int set_multicast_group(ortp_socket_t sock, const char *addr) {
 #endif
 }
 
-static ortp_socket_t create_and_bind(const char *addr,
-                                     int *port,
-                                     int *sock_family,
-                                     bool_t reuse_addr,
-                                     struct sockaddr_storage *bound_addr,
-                                     socklen_t *bound_addr_len) {
+ortp_socket_t _ortp_create_and_bind(const char *addr,
+                                   int *port,
+                                   int *sock_family,
+                                   bool_t reuse_addr,
+                                   struct sockaddr_storage *bound_addr,
+                                   socklen_t *bound_addr_len) {
 	int err;
 	int optval = 1;
 	ortp_socket_t sock = -1;
@@ -418,16 +425,16 @@ int rtp_session_set_local_addr(RtpSession *session, const char *addr, int rtp_po
 	}
 	/* try to bind the rtp port */
 
-	sock = create_and_bind(addr, &rtp_port, &sockfamily, session->reuseaddr, &session->rtp.gs.loc_addr,
-	                       &session->rtp.gs.loc_addrlen);
+	sock = _ortp_create_and_bind(addr, &rtp_port, &sockfamily, session->reuseaddr, &session->rtp.gs.loc_addr,
+	                             &session->rtp.gs.loc_addrlen);
 	if (sock != -1) {
 		session->rtp.gs.sockfamily = sockfamily;
 		session->rtp.gs.socket = sock;
 		session->rtp.gs.loc_port = rtp_port;
 		_rtp_session_apply_socket_sizes(session);
 		/*try to bind rtcp port */
-		sock = create_and_bind(addr, &rtcp_port, &sockfamily, session->reuseaddr, &session->rtcp.gs.loc_addr,
-		                       &session->rtcp.gs.loc_addrlen);
+		sock = _ortp_create_and_bind(addr, &rtcp_port, &sockfamily, session->reuseaddr,
+		                             &session->rtcp.gs.loc_addr, &session->rtcp.gs.loc_addrlen);
 		if (sock != (ortp_socket_t)-1) {
 			session->rtcp.gs.sockfamily = sockfamily;
 			session->rtcp.gs.socket = sock;
@@ -471,7 +478,7 @@ static void _rtp_session_check_socket_refresh(RtpSession *session) {
  * this routing rules change taking effect on the RTP/RTCP packets sent by the session.
  **/
 void rtp_session_refresh_sockets(RtpSession *session) {
-	if (session->rtp.gs.socket != (ortp_socket_t)-1) {
+	if (session->rtp.gs.socket != (ortp_socket_t)-1 && session->demux == NULL) {
 		session->flags |= RTP_SESSION_SOCKET_REFRESH_REQUESTED;
 	}
 }
@@ -1004,6 +1011,8 @@ end:
 			session->rtcp.gs.aux_destinations = o_list_append(session->rtcp.gs.aux_destinations, aux_rtcp);
 			ortp_mutex_unlock(&session->main_mutex);
 		}
+	} else if (err == 0 && session->demux) {
+		rtp_demux_session_address_updated(session->demux, session);
 	}
 	return err;
 }
@@ -1172,40 +1181,15 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 #else
 #ifdef USE_SENDMSG
 #define MAX_IOV 64
-static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem_addr, socklen_t addr_len) {
-	struct msghdr msg;
-	struct iovec iov[MAX_IOV];
-	int iovlen;
-	u_char control_buffer[512] = {0};
-	mblk_t *m_track = m;
+/* Fills the control buffer of msg with the source address to use for sending m, and returns its actual size. */
+static int rtp_sendmsg_fill_control(mblk_t *m, struct msghdr *msg) {
 	int controlSize = 0; // Used to reset msg.msg_controllen to the real control size
 	struct cmsghdr *cmsg;
 	struct sockaddr_storage v4, v6Mapped;
 	socklen_t v4Len = 0, v6MappedLen = 0;
 	bool_t useV4 = FALSE;
-	int error;
-
-	for (iovlen = 0; iovlen < MAX_IOV && m_track != NULL; m_track = m_track->b_cont, iovlen++) {
-		iov[iovlen].iov_base = m_track->b_rptr;
-		iov[iovlen].iov_len = m_track->b_wptr - m_track->b_rptr;
-	}
-	if (iovlen == MAX_IOV) {
-		int count = 0;
-		while (m_track != NULL) {
-			count++;
-			m_track = m_track->b_cont;
-		}
-		ortp_error("Too long msgb (%i fragments) , didn't fit into iov, end discarded.", MAX_IOV + count);
-	}
-	msg.msg_name = (void *)rem_addr;
-	msg.msg_namelen = addr_len;
-	msg.msg_iov = &iov[0];
-	msg.msg_iovlen = iovlen;
-	msg.msg_flags = 0;
-	msg.msg_control = control_buffer;
-	msg.msg_controllen = sizeof(control_buffer);
 
-	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg = CMSG_FIRSTHDR(msg);
 #ifdef IPV6_PKTINFO
 	if (m->recv_addr.family == AF_INET6 && !IN6_IS_ADDR_UNSPECIFIED(&m->recv_addr.addr.ipi6_addr) &&
 	    !IN6_IS_ADDR_LOOPBACK(&m->recv_addr.addr.ipi6_addr)) { // Add IPV6 to the message control. We only add it if the
@@ -1223,7 +1207,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 			pktinfo->ipi6_ifindex = 0; // Set to 0 to let the kernel to use routable interface
 			pktinfo->ipi6_addr = m->recv_addr.addr.ipi6_addr;
 			controlSize += CMSG_SPACE(sizeof(struct in6_pktinfo));
-			cmsg = CMSG_NXTHDR(&msg, cmsg);
+			cmsg = CMSG_NXTHDR(msg, cmsg);
 		}
 	}
 #endif
@@ -1237,7 +1221,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 		if (useV4 == TRUE) pktinfo->ipi_spec_dst = ((struct sockaddr_in *)&v4)->sin_addr;
 		else pktinfo->ipi_spec_dst = m->recv_addr.addr.ipi_addr;
 		controlSize += CMSG_SPACE(sizeof(struct in_pktinfo));
-		cmsg = CMSG_NXTHDR(&msg, cmsg);
+		cmsg = CMSG_NXTHDR(msg, cmsg);
 	}
 #endif
 
@@ -1257,7 +1241,7 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 			pktinfo = (struct in6_addr *)CMSG_DATA(cmsg);
 			*pktinfo = m->recv_addr.addr.ipi6_addr;
 			controlSize += CMSG_SPACE(sizeof(struct in6_addr));
-			cmsg = CMSG_NXTHDR(&msg, cmsg);
+			cmsg = CMSG_NXTHDR(msg, cmsg);
 		}
 	}
 #endif
@@ -1271,10 +1255,42 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 		if (useV4 == TRUE) *pktinfo = ((struct sockaddr_in *)&v4)->sin_addr;
 		else *pktinfo = m->recv_addr.addr.ipi_addr;
 		controlSize += CMSG_SPACE(sizeof(struct in_addr));
-		//		cmsg = CMSG_NXTHDR(&msg, cmsg);		// Uncomment if you want to add interfaces
+		//		cmsg = CMSG_NXTHDR(msg, cmsg);		// Uncomment if you want to add interfaces
 	}
 #endif
+	return controlSize;
+}
 
+static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem_addr, socklen_t addr_len) {
+	struct msghdr msg;
+	struct iovec iov[MAX_IOV];
+	int iovlen;
+	u_char control_buffer[512] = {0};
+	mblk_t *m_track = m;
+	int controlSize;
+	int error;
+
+	for (iovlen = 0; iovlen < MAX_IOV && m_track != NULL; m_track = m_track->b_cont, iovlen++) {
+		iov[iovlen].iov_base = m_track->b_rptr;
+		iov[iovlen].iov_len = m_track->b_wptr - m_track->b_rptr;
+	}
+	if (iovlen == MAX_IOV) {
+		int count = 0;
+		while (m_track != NULL) {
+			count++;
+			m_track = m_track->b_cont;
+		}
+		ortp_error("Too long msgb (%i fragments) , didn't fit into iov, end discarded.", MAX_IOV + count);
+	}
+	msg.msg_name = (void *)rem_addr;
+	msg.msg_namelen = addr_len;
+	msg.msg_iov = &iov[0];
+	msg.msg_iovlen = iovlen;
+	msg.msg_flags = 0;
+	msg.msg_control = control_buffer;
+	msg.msg_controllen = sizeof(control_buffer);
+
+	controlSize = rtp_sendmsg_fill_control(m, &msg);
 	msg.msg_controllen = controlSize;
 	if (controlSize == 0) // Have to reset msg_control to NULL as msg_controllen is not sufficient on some platforms
 		msg.msg_control = NULL;
@@ -1289,6 +1305,238 @@ static int rtp_sendmsg(ortp_socket_t sock, mblk_t *m, const struct sockaddr *rem
 #endif
 #endif
 
+#ifdef USE_SENDMMSG
+#define ORTP_SEND_BATCH_MAX_FRAGMENTS 8
+#define ORTP_SEND_BATCH_CONTROL_SIZE 256
+/* limits of the kernel for UDP segmentation offload */
+#define ORTP_GSO_MAX_SEGMENTS 64
+#define ORTP_GSO_MAX_BYTES 65000
+
+/* RTP packets queued by rtp_session_sendto() and sent with a single sendmmsg() call by
+ * rtp_session_flush_send_batch(). */
+typedef struct _OrtpSendBatch {
+	queue_t q;
+	mblk_t **packets;
+	struct mmsghdr *msgs;
+	struct iovec *iovs;
+	char (*controls)[ORTP_SEND_BATCH_CONTROL_SIZE];
+	int *msg_first_packet;
+	int *msg_packet_count;
+	int size;
+	bool_t gso;
+	bool_t queuing; /* set while rtp_session_rtp_sendto() is sending a packet of the session */
+} OrtpSendBatch;
+
+static int rtp_send_batch_queue(OrtpSendBatch *batch, mblk_t *m, const struct sockaddr *destaddr, socklen_t destlen) {
+	mblk_t *copy = dupmsg(m);
+	mblk_t *it;
+	int fragments = 0;
+
+	for (it = copy; it != NULL; it = it->b_cont)
+		fragments++;
+	if (fragments > ORTP_SEND_BATCH_MAX_FRAGMENTS) msgpullup(copy, -1);
+	/* dupmsg() does not keep the source address that rtp_sendmsg_fill_control() needs */
+	memcpy(&copy->recv_addr, &m->recv_addr, sizeof(copy->recv_addr));
+	if (destaddr != NULL && destlen > 0) memcpy(&copy->net_addr, destaddr, destlen);
+	copy->net_addrlen = destaddr != NULL ? destlen : 0;
+	putq(&batch->q, copy);
+	return (int)msgdsize(copy);
+}
+
+/* Tells whether next can be appended to a UDP segmentation offload message starting with first and ending with last.
+ */
+static bool_t rtp_send_batch_can_aggregate(
+    const mblk_t *first, const mblk_t *last, const mblk_t *next, int segment_size, int total, int count) {
+	int size = (int)msgdsize(next);
+
+	if (segment_size == 0 || count >= ORTP_GSO_MAX_SEGMENTS || total + size > ORTP_GSO_MAX_BYTES) return FALSE;
+	/* all the segments must have the same size, but the last one that can be shorter */
+	if ((int)msgdsize(last) != segment_size || size > segment_size) return FALSE;
+	if (first->net_addrlen != next->net_addrlen || memcmp(&first->net_addr, &next->net_addr, first->net_addrlen) != 0)
+		return FALSE;
+	return memcmp(&first->recv_addr, &next->recv_addr, sizeof(first->recv_addr)) == 0;
+}
+
+static int rtp_send_batch_prepare(OrtpSendBatch *batch, int npackets) {
+	int nmsgs = 0;
+	int niov = 0;
+	int i = 0;
+
+	while (i < npackets) {
+		struct msghdr *msghdr = &batch->msgs[nmsgs].msg_hdr;
+		mblk_t *first = batch->packets[i];
+		int segment_size = (int)msgdsize(first);
+		int total = 0;
+		int controlSize;
+		int j = i;
+
+		memset(msghdr, 0, sizeof(*msghdr));
+		msghdr->msg_iov = &batch->iovs[niov];
+		do {
+			mblk_t *it;
+			for (it = batch->packets[j]; it != NULL; it = it->b_cont) {
+				batch->iovs[niov].iov_base = it->b_rptr;
+				batch->iovs[niov].iov_len = it->b_wptr - it->b_rptr;
+				niov++;
+				msghdr->msg_iovlen++;
+			}
+			total += (int)msgdsize(batch->packets[j]);
+			j++;
+		} while (batch->gso && j < npackets &&
+		         rtp_send_batch_can_aggregate(first, batch->packets[j - 1], batch->packets[j], segment_size, total,
+		                                      j - i));
+
+		msghdr->msg_name = first->net_addrlen > 0 ? &first->net_addr : NULL;
+		msghdr->msg_namelen = first->net_addrlen;
+		memset(batch->controls[nmsgs], 0, ORTP_SEND_BATCH_CONTROL_SIZE);
+		msghdr->msg_control = batch->controls[nmsgs];
+		msghdr->msg_controllen = ORTP_SEND_BATCH_CONTROL_SIZE;
+		controlSize = rtp_sendmsg_fill_control(first, msghdr);
+		if (j - i > 1) {
+			struct cmsghdr *cmsg = (struct cmsghdr *)(batch->controls[nmsgs] + controlSize);
+			cmsg->cmsg_level = SOL_UDP;
+			cmsg->cmsg_type = UDP_SEGMENT;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+			*(uint16_t *)CMSG_DATA(cmsg) = (uint16_t)segment_size;
+			controlSize += CMSG_SPACE(sizeof(uint16_t));
+		}
+		msghdr->msg_controllen = controlSize;
+		if (controlSize == 0) msghdr->msg_control = NULL;
+		batch->msg_first_packet[nmsgs] = i;
+		batch->msg_packet_count[nmsgs] = j - i;
+		nmsgs++;
+		i = j;
+	}
+	return nmsgs;
+}
+
+static void rtp_send_batch_flush(RtpSession *session, OrtpSendBatch *batch, ortp_socket_t sock) {
+	int npackets = 0;
+	int nmsgs;
+	int sent = 0;
+	int i;
+	mblk_t *m;
+
+	while ((m = getq(&batch->q)) != NULL)
+		batch->packets[npackets++] = m;
+	if (npackets == 0) return;
+
+	if (sock != (ortp_socket_t)-1) {
+		nmsgs = rtp_send_batch_prepare(batch, npackets);
+		while (sent < nmsgs) {
+			int ret = sendmmsg(sock, &batch->msgs[sent], nmsgs - sent, 0);
+			int first, count, errnum;
+			if (ret > 0) {
+				sent += ret;
+				continue;
+			}
+			/* The first remaining message could not be sent, retry its packets one by one so that the source address
+			 * fallback of rtp_sendmsg() applies. */
+			errnum = getSocketErrorCode();
+			first = batch->msg_first_packet[sent];
+			count = batch->msg_packet_count[sent];
+			if (count > 1 && errnum != EAGAIN && errnum != EWOULDBLOCK && errnum != ENOBUFS) {
+				ortp_warning("RtpSession [%p]: UDP segmentation offload failed [%s], disabling it.", session,
+				             getSocketError());
+				batch->gso = FALSE;
+			}
+			for (i = first; i < first + count; i++) {
+				mblk_t *p = batch->packets[i];
+				if (rtp_sendmsg(sock, p, p->net_addrlen > 0 ? (struct sockaddr *)&p->net_addr : NULL, p->net_addrlen) <
+				    0) {
+					ortp_error("RtpSession [%p] error sending queued rtp packet [%p]: %s", session, p,
+					           getSocketError());
+					session->rtp.send_errno = getSocketErrorCode();
+				}
+			}
+			sent++;
+		}
+	}
+	for (i = 0; i < npackets; i++)
+		freemsg(batch->packets[i]);
+}
+#endif
+
+void rtp_session_destroy_send_batch(RtpSession *session) {
+#ifdef USE_SENDMMSG
+	OrtpSendBatch *batch = session->send_batch;
+
+	if (batch == NULL) return;
+	flushq(&batch->q, FLUSHALL);
+	ortp_free(batch->packets);
+	ortp_free(batch->msgs);
+	ortp_free(batch->iovs);
+	ortp_free(batch->controls);
+	ortp_free(batch->msg_first_packet);
+	ortp_free(batch->msg_packet_count);
+	ortp_free(batch);
+#endif
+	session->send_batch = NULL;
+}
+
+/**
+ * Sets the maximum number of RTP packets sent to the network by a single system call.
+ * When greater than 1, the RTP packets are queued and sent with sendmmsg() when
+ * rtp_session_flush_send_batch() is called, or when the queue is full. The application must then flush the
+ * queue once it has sent all the packets of a processing cycle, for example at each ticker tick.
+ * Packets sent through an RtpBundle secondary session are not queued. It has no effect on platforms lacking
+ * sendmmsg().
+ *
+ * @param session a rtp session
+ * @param count the number of packets per system call, 0 or 1 to disable batching (default).
+ **/
+void rtp_session_set_send_batch_size(RtpSession *session, int count) {
+	rtp_session_flush_send_batch(session);
+	rtp_session_destroy_send_batch(session);
+	if (count <= 1) return;
+#ifdef USE_SENDMMSG
+	{
+		OrtpSendBatch *batch = ortp_new0(OrtpSendBatch, 1);
+		qinit(&batch->q);
+		batch->size = count;
+		batch->packets = ortp_new0(mblk_t *, count);
+		batch->msgs = ortp_new0(struct mmsghdr, count);
+		batch->iovs = ortp_new0(struct iovec, count * ORTP_SEND_BATCH_MAX_FRAGMENTS);
+		batch->controls = ortp_malloc0(count * ORTP_SEND_BATCH_CONTROL_SIZE);
+		batch->msg_first_packet = ortp_new0(int, count);
+		batch->msg_packet_count = ortp_new0(int, count);
+		session->send_batch = batch;
+	}
+#else
+	ortp_message("RtpSession [%p]: batched sending is not supported on this platform.", session);
+#endif
+}
+
+/**
+ * Enables UDP segmentation offload (UDP_SEGMENT) for batched sending: consecutive queued packets of the same size and
+ * destination are then given to the kernel as a single message. It is disabled automatically if the kernel or the
+ * network interface does not support it.
+ * Batched sending must have been enabled with rtp_session_set_send_batch_size() beforehand.
+ *
+ * @param session a rtp session
+ * @param enabled TRUE to enable segmentation offload, FALSE to disable it (default).
+ **/
+void rtp_session_enable_send_gso(RtpSession *session, BCTBX_UNUSED(bool_t enabled)) {
+#ifdef USE_SENDMMSG
+	if (session->send_batch) {
+		session->send_batch->gso = enabled;
+		return;
+	}
+#endif
+	ortp_warning("RtpSession [%p]: cannot enable segmentation offload without batched sending.", session);
+}
+
+/**
+ * Sends the RTP packets queued by batched sending, see rtp_session_set_send_batch_size().
+ *
+ * @param session a rtp session
+ **/
+void rtp_session_flush_send_batch(BCTBX_UNUSED(RtpSession *session)) {
+#ifdef USE_SENDMMSG
+	if (session->send_batch) rtp_send_batch_flush(session, session->send_batch, session->rtp.gs.socket);
+#endif
+}
+
 ortp_socket_t rtp_session_get_socket(RtpSession *session, bool_t is_rtp) {
 	return is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket;
 }
@@ -1331,7 +1579,17 @@ int rtp_session_sendto(
 	if (!using_simulator) {
 		ortp_socket_t sockfd = rtp_session_get_socket(session, is_rtp || session->rtcp_mux);
 		if (sockfd != (ortp_socket_t)-1) {
+#ifdef USE_SENDMMSG
+			OrtpSendBatch *batch = session->send_batch;
+			if (is_rtp && batch != NULL && batch->queuing) {
+				ret = rtp_send_batch_queue(batch, m, destaddr, destlen);
+				if (batch->q.q_mcount >= batch->size) rtp_send_batch_flush(session, batch, sockfd);
+			} else {
+				ret = _ortp_sendto(sockfd, m, flags, destaddr, destlen);
+			}
+#else
 			ret = _ortp_sendto(sockfd, m, flags, destaddr, destlen);
+#endif
 		} else {
 			ret = -1;
 		}
@@ -1396,10 +1654,218 @@ static const ortp_recv_addr_t *get_recv_addr(RtpSession *session, struct sockadd
 	}
 }
 
+/* Reads the information of a received packet from one of the ancillary data of its message. */
+static void rtp_process_recv_cmsg(int level, int type, unsigned char *data, mblk_t *msg) {
+#ifdef _RECV_SO_TIMESTAMP_TYPE
+	if (level == SOL_SOCKET && type == _RECV_SO_TIMESTAMP_TYPE) {
+		memcpy(&msg->timestamp, (struct timeval *)data, sizeof(struct timeval));
+	}
+#endif
+#ifdef IP_PKTINFO
+	if ((level == IPPROTO_IP) && (type == IP_PKTINFO)) {
+		struct in_pktinfo *pi = (struct in_pktinfo *)data;
+		memcpy(&msg->recv_addr.addr.ipi_addr, &pi->ipi_addr, sizeof(msg->recv_addr.addr.ipi_addr));
+		msg->recv_addr.family = AF_INET;
+	}
+#endif
+#ifdef IPV6_PKTINFO
+	if ((level == IPPROTO_IPV6) && (type == IPV6_PKTINFO)) {
+		struct in6_pktinfo *pi = (struct in6_pktinfo *)data;
+		memcpy(&msg->recv_addr.addr.ipi6_addr, &pi->ipi6_addr, sizeof(msg->recv_addr.addr.ipi6_addr));
+		msg->recv_addr.family = AF_INET6;
+	}
+#endif
+#ifdef IP_RECVDSTADDR
+	if ((level == IPPROTO_IP) && (type == IP_RECVDSTADDR)) {
+		struct in_addr *ia = (struct in_addr *)data;
+		memcpy(&msg->recv_addr.addr.ipi_addr, ia, sizeof(msg->recv_addr.addr.ipi_addr));
+		msg->recv_addr.family = AF_INET;
+	}
+#endif
+#ifdef IPV6_RECVDSTADDR
+	if ((level == IPPROTO_IPV6) && (type == IPV6_RECVDSTADDR)) {
+		struct in6_addr *ia = (struct in6_addr *)data;
+		memcpy(&msg->recv_addr.addr.ipi6_addr, ia, sizeof(msg->recv_addr.addr.ipi6_addr));
+		msg->recv_addr.family = AF_INET6;
+	}
+#endif
+#ifdef IP_RECVTTL
+	if ((level == IPPROTO_IP) && (type == IP_TTL)) {
+		uint32_t *ptr = (uint32_t *)data;
+		msg->ttl_or_hl = (*ptr & 0xFF);
+	}
+#endif
+#ifdef IPV6_RECVHOPLIMIT
+	if ((level == IPPROTO_IPV6) && (type == IPV6_HOPLIMIT)) {
+		uint32_t *ptr = (uint32_t *)data;
+		msg->ttl_or_hl = (*ptr & 0xFF);
+	}
+#endif
+}
+
+#ifdef USE_RECVMMSG
+#define ORTP_RECV_BATCH_CONTROL_SIZE 512
+
+typedef struct _OrtpRecvBatchSlot {
+	mblk_t *m;
+	struct iovec iov;
+	char control[ORTP_RECV_BATCH_CONTROL_SIZE];
+	struct sockaddr_storage from;
+} OrtpRecvBatchSlot;
+
+/* Datagrams drained from the RTP socket with a single recvmmsg() call, and handed out one by one to
+ * rtp_session_recvfrom(). */
+typedef struct _OrtpRecvBatch {
+	struct mmsghdr *msgs;
+	OrtpRecvBatchSlot *slots;
+	int size;
+	int count; /* number of datagrams received by the last recvmmsg() */
+	int next;  /* index of the next datagram to hand out */
+} OrtpRecvBatch;
+
+static int rtp_recv_batch_fill(OrtpRecvBatch *batch, ortp_socket_t socket, int bufsize, int flags) {
+	int i;
+	int ret;
+
+	for (i = 0; i < batch->size; i++) {
+		OrtpRecvBatchSlot *slot = &batch->slots[i];
+		struct msghdr *msghdr = &batch->msgs[i].msg_hdr;
+
+		if (slot->m == NULL || (int)(slot->m->b_datap->db_lim - slot->m->b_datap->db_base) < bufsize) {
+			if (slot->m) freemsg(slot->m);
+			slot->m = allocb(bufsize, 0);
+		}
+		slot->iov.iov_base = slot->m->b_datap->db_base;
+		slot->iov.iov_len = slot->m->b_datap->db_lim - slot->m->b_datap->db_base;
+		msghdr->msg_name = &slot->from;
+		msghdr->msg_namelen = sizeof(slot->from);
+		msghdr->msg_iov = &slot->iov;
+		msghdr->msg_iovlen = 1;
+		msghdr->msg_control = slot->control;
+		msghdr->msg_controllen = sizeof(slot->control);
+		msghdr->msg_flags = 0;
+		batch->msgs[i].msg_len = 0;
+	}
+	batch->next = 0;
+	ret = recvmmsg(socket, batch->msgs, batch->size, flags, NULL);
+	batch->count = ret > 0 ? ret : 0;
+	return ret;
+}
+
+/* Gives the next datagram of the batch to the caller. The buffers are swapped rather than copied whenever the caller
+ * hands over a pristine receive block, which is what rtp_session_rtp_recv() does. */
+static int rtp_recv_batch_pop(OrtpRecvBatch *batch, mblk_t *m, struct sockaddr *from, socklen_t *fromlen) {
+	OrtpRecvBatchSlot *slot = &batch->slots[batch->next];
+	struct msghdr *msghdr = &batch->msgs[batch->next].msg_hdr;
+	int len = (int)batch->msgs[batch->next].msg_len;
+	struct cmsghdr *cmsghdr;
+
+	batch->next++;
+	if (m->b_cont == NULL && m->b_wptr == m->b_datap->db_base && dblk_ref_value(m->b_datap) == 1) {
+		dblk_t *db = m->b_datap;
+		m->b_datap = slot->m->b_datap;
+		m->b_rptr = m->b_wptr = m->b_datap->db_base;
+		slot->m->b_datap = db;
+		slot->m->b_rptr = slot->m->b_wptr = db->db_base;
+	} else {
+		int avail = (int)(m->b_datap->db_lim - m->b_wptr);
+		if (len > avail) len = avail;
+		memcpy(m->b_wptr, slot->m->b_datap->db_base, len);
+	}
+	for (cmsghdr = CMSG_FIRSTHDR(msghdr); cmsghdr != NULL; cmsghdr = CMSG_NXTHDR(msghdr, cmsghdr)) {
+		rtp_process_recv_cmsg(cmsghdr->cmsg_level, cmsghdr->cmsg_type, CMSG_DATA(cmsghdr), m);
+	}
+	if (from && fromlen) {
+		socklen_t addrlen = MIN(*fromlen, msghdr->msg_namelen);
+		memcpy(from, &slot->from, addrlen);
+		*fromlen = addrlen;
+		/*store recv addr for use by modifiers*/
+		memcpy(&m->net_addr, from, addrlen);
+		m->net_addrlen = addrlen;
+	}
+	return len;
+}
+
+static int rtp_recv_batch_read(OrtpRecvBatch *batch,
+                               ortp_socket_t socket,
+                               int bufsize,
+                               mblk_t *m,
+                               int flags,
+                               struct sockaddr *from,
+                               socklen_t *fromlen) {
+	if (batch->next >= batch->count) {
+		int ret = rtp_recv_batch_fill(batch, socket, bufsize, flags);
+		if (ret <= 0) return ret;
+	}
+	return rtp_recv_batch_pop(batch, m, from, fromlen);
+}
+#endif
+
+void rtp_session_flush_recv_batch(BCTBX_UNUSED(RtpSession *session)) {
+#ifdef USE_RECVMMSG
+	if (session->recv_batch) {
+		session->recv_batch->count = 0;
+		session->recv_batch->next = 0;
+	}
+#endif
+}
+
+void rtp_session_destroy_recv_batch(RtpSession *session) {
+#ifdef USE_RECVMMSG
+	OrtpRecvBatch *batch = session->recv_batch;
+	int i;
+
+	if (batch == NULL) return;
+	for (i = 0; i < batch->size; i++) {
+		if (batch->slots[i].m) freemsg(batch->slots[i].m);
+	}
+	ortp_free(batch->slots);
+	ortp_free(batch->msgs);
+	ortp_free(batch);
+#endif
+	session->recv_batch = NULL;
+}
+
+/**
+ * Sets the maximum number of RTP datagrams read from the socket by a single system call.
+ * When greater than 1, the datagrams waiting on the RTP socket are drained with recvmmsg() into pre-allocated
+ * blocks and then processed one by one, which saves a system call per packet for high packet rate streams such as
+ * video. It has no effect on platforms lacking recvmmsg().
+ * Only the RTP socket is read in batches: the RTCP socket and RtpTransport endpoints keep reading one packet at a time.
+ * This must be called when the session is not being processed by another thread.
+ *
+ * @param session a rtp session
+ * @param count the number of datagrams per system call, 0 or 1 to disable batching (default).
+ **/
+void rtp_session_set_recv_batch_size(RtpSession *session, int count) {
+	rtp_session_destroy_recv_batch(session);
+	if (count <= 1) return;
+#ifdef USE_RECVMMSG
+	{
+		OrtpRecvBatch *batch = ortp_new0(OrtpRecvBatch, 1);
+		batch->size = count;
+		batch->msgs = ortp_new0(struct mmsghdr, count);
+		batch->slots = ortp_new0(OrtpRecvBatchSlot, count);
+		session->recv_batch = batch;
+	}
+#else
+	ortp_message("RtpSession [%p]: batched reception is not supported on this platform.", session);
+#endif
+}
+
 int rtp_session_recvfrom(
     RtpSession *session, bool_t is_rtp, mblk_t *m, int flags, struct sockaddr *from, socklen_t *fromlen) {
-	int ret = rtp_session_rtp_recv_abstract(is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket, m, flags, from,
-	                                        fromlen);
+	int ret;
+	ortp_socket_t socket = is_rtp ? session->rtp.gs.socket : session->rtcp.gs.socket;
+#ifdef USE_RECVMMSG
+	if (is_rtp && session->recv_batch != NULL) {
+		ret = rtp_recv_batch_read(session->recv_batch, socket, session->recv_buf_size, m, flags, from, fromlen);
+	} else {
+		ret = rtp_session_rtp_recv_abstract(socket, m, flags, from, fromlen);
+	}
+#else
+	ret = rtp_session_rtp_recv_abstract(socket, m, flags, from, fromlen);
+#endif
 	if ((ret >= 0) && (session->use_pktinfo == TRUE)) {
 		if (m->recv_addr.family == AF_UNSPEC) {
 			const ortp_recv_addr_t *recv_addr;
@@ -1479,11 +1945,19 @@ rtp_session_rtp_sendto(RtpSession *session, mblk_t *m, struct sockaddr *destaddr
 	if (m->recv_addr.family == AF_UNSPEC && ostr->used_loc_addrlen != 0)
 		ortp_sockaddr_to_recvaddr((const struct sockaddr *)&ostr->used_loc_addr, &m->recv_addr);
 
+#ifdef USE_SENDMMSG
+	/* The packets of the RtpBundle secondary sessions are not queued, as they may be sent from another thread than the
+	 * one flushing the queue of the primary session. */
+	if (send_session == session && session->send_batch) session->send_batch->queuing = TRUE;
+#endif
 	if (rtp_session_using_transport(send_session, rtp)) {
 		error = (send_session->rtp.gs.tr->t_sendto)(send_session->rtp.gs.tr, m, 0, destaddr, destlen);
 	} else {
 		error = rtp_session_sendto(send_session, TRUE, m, 0, destaddr, destlen);
 	}
+#ifdef USE_SENDMMSG
+	if (send_session == session && session->send_batch) session->send_batch->queuing = FALSE;
+#endif
 	if (!is_aux) {
 		/*errors to auxiliary destinations are not notified*/
 		if (error < 0) {
@@ -1675,51 +2149,7 @@ int rtp_session_rtp_recv_abstract(
 		struct cmsghdr *cmsghdr;
 #endif
 		for (cmsghdr = CMSG_FIRSTHDR(&msghdr); cmsghdr != NULL; cmsghdr = CMSG_NXTHDR(&msghdr, cmsghdr)) {
-#ifdef _RECV_SO_TIMESTAMP_TYPE
-			if (cmsghdr->cmsg_level == SOL_SOCKET && cmsghdr->cmsg_type == _RECV_SO_TIMESTAMP_TYPE) {
-				memcpy(&msg->timestamp, (struct timeval *)CMSG_DATA(cmsghdr), sizeof(struct timeval));
-			}
-#endif
-#ifdef IP_PKTINFO
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_PKTINFO)) {
-				struct in_pktinfo *pi = (struct in_pktinfo *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi_addr, &pi->ipi_addr, sizeof(msg->recv_addr.addr.ipi_addr));
-				msg->recv_addr.family = AF_INET;
-			}
-#endif
-#ifdef IPV6_PKTINFO
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_PKTINFO)) {
-				struct in6_pktinfo *pi = (struct in6_pktinfo *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi6_addr, &pi->ipi6_addr, sizeof(msg->recv_addr.addr.ipi6_addr));
-				msg->recv_addr.family = AF_INET6;
-			}
-#endif
-#ifdef IP_RECVDSTADDR
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_RECVDSTADDR)) {
-				struct in_addr *ia = (struct in_addr *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi_addr, ia, sizeof(msg->recv_addr.addr.ipi_addr));
-				msg->recv_addr.family = AF_INET;
-			}
-#endif
-#ifdef IPV6_RECVDSTADDR
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_RECVDSTADDR)) {
-				struct in6_addr *ia = (struct in6_addr *)CMSG_DATA(cmsghdr);
-				memcpy(&msg->recv_addr.addr.ipi6_addr, ia, sizeof(msg->recv_addr.addr.ipi6_addr));
-				msg->recv_addr.family = AF_INET6;
-			}
-#endif
-#ifdef IP_RECVTTL
-			if ((cmsghdr->cmsg_level == IPPROTO_IP) && (cmsghdr->cmsg_type == IP_TTL)) {
-				uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
-				msg->ttl_or_hl = (*ptr & 0xFF);
-			}
-#endif
-#ifdef IPV6_RECVHOPLIMIT
-			if ((cmsghdr->cmsg_level == IPPROTO_IPV6) && (cmsghdr->cmsg_type == IPV6_HOPLIMIT)) {
-				uint32_t *ptr = (uint32_t *)CMSG_DATA(cmsghdr);
-				msg->ttl_or_hl = (*ptr & 0xFF);
-			}
-#endif
+			rtp_process_recv_cmsg(cmsghdr->cmsg_level, cmsghdr->cmsg_type, CMSG_DATA(cmsghdr), msg);
 		}
 		/*store recv addr for use by modifiers*/
 		if (from && fromlen) {
@@ -2134,9 +2564,12 @@ int rtp_session_rtp_recv(RtpSession *session, uint32_t user_ts) {
 	if ((session->rtp.gs.socket == (ortp_socket_t)-1) && !rtp_session_using_transport(session, rtp))
 		return -1; /*session has no sockets for the moment*/
 
+	/* the packets of a session attached to a RtpDemux are read from the shared sockets and queued by the demux */
+	if (session->demux) rtp_demux_process_from_session(session->demux);
+
 	do {
 		bool_t packet_is_rtp = TRUE;
-		if (!bundle || (bundle && session->is_primary)) {
+		if (session->demux == NULL && (!bundle || (bundle && session->is_primary))) {
 #if defined(_WIN32) || defined(_WIN32_WCE)
 			ortp_mutex_lock(&session->rtp.winthread_lock);
 			if (!session->rtp.is_win_thread_running) {
@@ -2180,7 +2613,7 @@ int rtp_session_rtp_recv(RtpSession *session, uint32_t user_ts) {
 				more_data = FALSE;
 			}
 		} else {
-			/* case where we are part of a bundle as a secondary session */
+			/* case where we are part of a bundle as a secondary session, or attached to a demux */
 			ortp_mutex_lock(&session->rtp.gs.bundleq_lock);
 			mp = getq(&session->rtp.gs.bundleq);
 			ortp_mutex_unlock(&session->rtp.gs.bundleq_lock);
@@ -2204,7 +2637,7 @@ int rtp_session_rtcp_recv(RtpSession *session) {
 	while (1) {
 		bool_t sock_connected = !!(session->flags & RTCP_SOCKET_CONNECTED);
 		mp = NULL;
-		if (!session->bundle) {
+		if (!session->bundle && !session->demux) {
 
 			if (session->rtcp.gs.socket == (ortp_socket_t)-1 && !rtp_session_using_transport(session, rtcp))
 				return -1; /*session has no RTCP sockets for the moment*/
@@ -2252,14 +2685,15 @@ int rtp_session_rtcp_recv(RtpSession *session) {
 				rtp_session_recycle_recv_block(session, mp);
 				mp = NULL;
 			}
-		} else if (!session->is_primary) {
-			/* case where we are part of a bundle as a secondary session */
+		} else if (session->demux || !session->is_primary) {
+			/* case where we are part of a bundle as a secondary session, or attached to a demux */
 			ortp_mutex_lock(&session->rtcp.gs.bundleq_lock);
 			mp = getq(&session->rtcp.gs.bundleq);
 			ortp_mutex_unlock(&session->rtcp.gs.bundleq_lock);
 		}
 		if (mp) {
-			rtp_session_process_incoming(session, mp, FALSE, session->rtp.rcv_last_app_ts, session->bundle != NULL);
+			rtp_session_process_incoming(session, mp, FALSE, session->rtp.rcv_last_app_ts,
+			                             session->bundle != NULL || session->demux != NULL);
 		} else break;
 	}
 	return 0;
@@ -56,10 +56,17 @@ extern "C" {
 
 int rtp_session_rtp_recv_abstract(
     ortp_socket_t socket, mblk_t *msg, int flags, struct sockaddr *from, socklen_t *fromlen);
+ortp_socket_t _ortp_create_and_bind(const char *addr,
+                                   int *port,
+                                   int *sock_family,
+                                   bool_t reuse_addr,
+                                   struct sockaddr_storage *bound_addr,
+                                   socklen_t *bound_addr_len);
 
 void rtp_session_update_payload_type(RtpSession *session, int pt);
 int rtp_putq(queue_t *q, mblk_t *mp);
-mblk_t *rtp_peekq(queue_t *q, uint32_t ts, int *rejected);
+mblk_t *rtp_peekq(JitterQueue *q, uint32_t ts, int *rejected);
+mblk_t *rtp_peekq_permissive(JitterQueue *q, uint32_t ts, int *rejected);
 int rtp_session_rtp_recv(RtpSession *session, uint32_t ts);
 int rtp_session_rtcp_recv(RtpSession *session);
 int rtp_session_rtp_send(RtpSession *session, mblk_t *m);
@@ -127,10 +134,16 @@ void rtp_session_init_jitter_buffer(RtpSession *session);
 size_t rtp_session_calculate_packet_header_size(int cc, const char *mid);
 
 void _rtp_session_release_sockets(RtpSession *session, bool_t release_transports);
+void rtp_session_flush_recv_batch(RtpSession *session);
+void rtp_session_destroy_recv_batch(RtpSession *session);
+void rtp_session_destroy_send_batch(RtpSession *session);
 void rtp_session_set_bundle(RtpSession *session, RtpBundle *bundle);
 
 void rtp_bundle_session_mode_updated(RtpBundle *bundle, RtpSession *session, RtpSessionMode previous_mode);
 
+void rtp_demux_session_address_updated(RtpDemux *demux, RtpSession *session);
+void rtp_demux_process_from_session(RtpDemux *demux);
+
 #ifdef __cplusplus
 }
 #endif
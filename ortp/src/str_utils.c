@@ -60,7 +60,7 @@ mblk_t *allocb(size_t size, BCTBX_UNUSED(int pri)) {
 	mblk_t *mp;
 	dblk_t *datab;
 
-	mp = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	mp = ortp_mblk_alloc();
 	datab = dblk_alloc(size);
 
 	mp->b_datap = datab;
@@ -69,11 +69,25 @@ mblk_t *allocb(size_t size, BCTBX_UNUSED(int pri)) {
 	return mp;
 }
 
+mblk_t *allocb_with_room(size_t headroom, size_t size, size_t tailroom) {
+	mblk_t *mp = allocb(headroom + size + tailroom, 0);
+	mp->b_rptr = mp->b_wptr = mp->b_rptr + headroom;
+	return mp;
+}
+
+size_t mblk_headroom(const mblk_t *mp) {
+	return (size_t)(mp->b_rptr - mp->b_datap->db_base);
+}
+
+size_t mblk_tailroom(const mblk_t *mp) {
+	return (size_t)(mp->b_datap->db_lim - mp->b_wptr);
+}
+
 mblk_t *esballoc(uint8_t *buf, size_t size, BCTBX_UNUSED(int pri), void (*freefn)(void *)) {
 	mblk_t *mp;
 	dblk_t *datab;
 
-	mp = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	mp = ortp_mblk_alloc();
 	datab = dblk_alloc2(buf, size, freefn);
 
 	mp->b_datap = datab;
@@ -87,7 +101,7 @@ void freeb(mblk_t *mp) {
 	return_if_fail(mp->b_datap->db_base != NULL);
 
 	dblk_unref(mp->b_datap);
-	ortp_free(mp);
+	ortp_mblk_free(mp);
 }
 
 void freemsg(mblk_t *mp) {
@@ -106,7 +120,7 @@ mblk_t *dupb(mblk_t *mp) {
 	return_val_if_fail(mp->b_datap->db_base != NULL, NULL);
 
 	dblk_ref(mp->b_datap);
-	newm = (mblk_t *)ortp_malloc0(sizeof(mblk_t));
+	newm = ortp_mblk_alloc();
 	mblk_meta_copy(mp, newm);
 	newm->b_datap = mp->b_datap;
 	newm->b_rptr = mp->b_rptr;
@@ -194,24 +208,24 @@ size_t msgdsize(const mblk_t *mp) {
 	return msgsize;
 }
 
-void msgpullup(mblk_t *mp, size_t len) {
+static void msgb_allocator_free_db(void *unused);
+
+/* Tells whether the data buffer of mp can be written without impacting other messages. */
+static bool_t mblk_has_single_owner(const mblk_t *mp) {
+	int single_owner_ref = (mp->b_datap->db_freefn == msgb_allocator_free_db) ? 2 : 1;
+	return dblk_ref_value(mp->b_datap) <= single_owner_ref;
+}
+
+/* Copies the first len bytes of the message in a new buffer of size size, at offset headroom. */
+static void msgpullup_copy(mblk_t *mp, size_t headroom, size_t len, size_t size) {
 	mblk_t *firstm = mp;
 	dblk_t *db;
 	size_t wlen = 0;
 	unsigned char *base;
 
-	if (mp->b_cont == NULL) {
-		/* Special case optimisations */
-		if (len == (size_t)-1) return; /*nothing to do, message is not fragmented. */
-		if (mp->b_datap->db_base + len <= mp->b_datap->db_lim) {
-			/* The underlying data block is larger than the requested size, nothing to do. */
-			return;
-		}
-	}
-
-	if (len == (size_t)-1) len = msgdsize(mp);
-	db = dblk_alloc(len);
-	base = db->db_base;
+	ortp_packet_pool_count_pullup();
+	db = dblk_alloc(size);
+	base = db->db_base + headroom;
 	while (wlen < len && mp != NULL) {
 		int remain = (int)(len - wlen);
 		int mlen = (int)(mp->b_wptr - mp->b_rptr);
@@ -229,10 +243,34 @@ void msgpullup(mblk_t *mp, size_t len) {
 	firstm->b_cont = NULL;
 	dblk_unref(firstm->b_datap);
 	firstm->b_datap = db;
-	firstm->b_rptr = db->db_base;
+	firstm->b_rptr = base;
 	firstm->b_wptr = firstm->b_rptr + wlen;
 }
 
+void msgpullup(mblk_t *mp, size_t len) {
+	if (mp->b_cont == NULL) {
+		/* Special case optimisations */
+		if (len == (size_t)-1) return; /*nothing to do, message is not fragmented. */
+		if (mp->b_rptr + len <= mp->b_datap->db_lim && mblk_has_single_owner(mp)) {
+			/* The underlying data block is larger than the requested size and ours, nothing to do. */
+			return;
+		}
+	}
+
+	if (len == (size_t)-1) len = msgdsize(mp);
+	msgpullup_copy(mp, 0, len, len);
+}
+
+void msgpullup_with_room(mblk_t *mp, size_t headroom, size_t tailroom) {
+	size_t len;
+
+	if (mp->b_cont == NULL && mblk_headroom(mp) >= headroom && mblk_tailroom(mp) >= tailroom &&
+	    mblk_has_single_owner(mp))
+		return;
+	len = msgdsize(mp);
+	msgpullup_copy(mp, headroom, len, headroom + len + tailroom);
+}
+
 /* pullup message but insert an insert_size zeroised buffer at offset */
 /* final size will be current size + insert size
  * b->w_bptr is set at the end of the message even if the insertion if performed at the end of the message */
@@ -248,6 +286,7 @@ void msgpullup_with_insert(mblk_t *mp, size_t offset, size_t insert_size) {
 	}
 
 	len += insert_size;
+	ortp_packet_pool_count_pullup();
 	db = dblk_alloc(len);
 
 	while (mp != NULL) { /* copy the whole original content, we do not crop as in regular pullup */
@@ -335,6 +374,21 @@ mblk_t *concatb(mblk_t *mp, mblk_t *newm) {
 	return newm;
 }
 
+mblk_t *msgprepend(mblk_t *hdr, mblk_t *mp) {
+	size_t hdr_size = (size_t)(hdr->b_wptr - hdr->b_rptr);
+
+	if (hdr->b_cont != NULL || mp->b_cont != NULL || mblk_headroom(mp) < hdr_size || !mblk_has_single_owner(mp)) {
+		concatb(hdr, mp);
+		return hdr;
+	}
+	mp->b_rptr -= hdr_size;
+	if (hdr_size) memcpy(mp->b_rptr, hdr->b_rptr, hdr_size);
+	mblk_meta_copy(hdr, mp);
+	memcpy(&mp->recv_addr, &hdr->recv_addr, sizeof(mp->recv_addr));
+	freeb(hdr);
+	return mp;
+}
+
 void msgb_allocator_init(msgb_allocator_t *a) {
 	qinit(&a->q);
 	a->max_blocks = 0; /* no limit */
@@ -381,11 +435,7 @@ void msgb_allocator_uninit(msgb_allocator_t *a) {
 
 /*Same as ownb(), but invoke it for each mblk_t of the chain*/
 mblk_t *msgown(mblk_t *mp) {
-	int single_owner_ref = (mp->b_datap->db_freefn == msgb_allocator_free_db) ? 2 : 1;
-
-	if (dblk_ref_value(mp->b_datap) > single_owner_ref) {
-		// ortp_message("msgown(): datab copied db_ref=%i  single_owner_ref=%i", dblk_ref_value(mp->b_datap),
-		// single_owner_ref);
+	if (!mblk_has_single_owner(mp)) {
 		msgpullup(mp, msgdsize(mp));
 	}
 	return mp;
@@ -78,6 +78,12 @@ extern "C" {
 #endif
 void ortp_ev_queue_put(OrtpEvQueue *q, OrtpEvent *ev);
 
+/* mblk_t allocation from the packet pool of the current thread, see dblk.cc */
+mblk_t *ortp_mblk_alloc(void);
+void ortp_mblk_free(mblk_t *mp);
+/* counts a message copied by msgpullup() in the statistics of the packet pool of the current thread */
+void ortp_packet_pool_count_pullup(void);
+
 uint64_t ortp_timeval_to_ntp(const struct timeval *tv);
 
 int _ortp_sendto(ortp_socket_t sockfd, mblk_t *m, int flags, const struct sockaddr *destaddr, socklen_t destlen);
@@ -570,6 +570,28 @@ static void insert_frame_marking_into_packet_base(BCTBX_UNUSED(bool_t with_paylo
 
 	freemsg(packet);
 }
+static void insert_frame_marking_with_temporal_layer_into_packet(void) {
+	int ret;
+	uint8_t result;
+	uint8_t *data = NULL;
+
+	mblk_t *packet = rtp_session_create_packet_header(session, 0);
+	uint8_t marker = RTP_FRAME_MARKER_START | RTP_FRAME_MARKER_DISCARDABLE | 2;
+
+	rtp_add_frame_marker(packet, RTP_EXTENSION_FRAME_MARKING, marker);
+
+	// Scalable streams use the two bytes form, with the layer id
+	ret = rtp_get_extension_header(packet, RTP_EXTENSION_FRAME_MARKING, &data);
+	BC_ASSERT_EQUAL(ret, 2, int, "%d");
+
+	ret = rtp_get_frame_marker(packet, RTP_EXTENSION_FRAME_MARKING, &result);
+	BC_ASSERT_EQUAL(ret, 1, int, "%d");
+	BC_ASSERT_TRUE(result & RTP_FRAME_MARKER_START);
+	BC_ASSERT_TRUE(result & RTP_FRAME_MARKER_DISCARDABLE);
+	BC_ASSERT_EQUAL(RTP_FRAME_MARKER_TID(result), 2, int, "%d");
+
+	freemsg(packet);
+}
 static void insert_frame_marking_into_packet(void) {
 	insert_frame_marking_into_packet_base(FALSE, session);
 }
@@ -908,6 +930,8 @@ static test_t tests[] = {
                 "with mixer",
                 insert_mixer_to_client_into_packet_with_payload_in_bundled_session_use_create_with_mixer),
     TEST_NO_TAG("Insert frame marking into a packet", insert_frame_marking_into_packet),
+    TEST_NO_TAG("Insert frame marking with temporal layer into a packet",
+                insert_frame_marking_with_temporal_layer_into_packet),
     TEST_NO_TAG("Insert frame marking into a packet with payload", insert_frame_marking_into_packet_with_payload),
     TEST_NO_TAG("Insert frame marking into a packet in bundled session",
                 insert_frame_marking_into_packet_in_bundled_session),
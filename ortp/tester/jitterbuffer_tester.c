@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of oRTP
+ * (see https://gitlab.linphone.org/BC/public/ortp).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bctoolbox/defs.h>
+
+#include "jitterqueue.h"
+#include "ortp_tester.h"
+#include "rtpsession_priv.h"
+#include <ortp/ortp.h>
+
+typedef struct _JitterBufferPattern {
+	const char *name;
+	int packet_count;
+	int depth;           /* number of packets kept in the jitter buffer before delivering the oldest one */
+	int reorder_percent; /* packets arriving late */
+	int reorder_distance;
+	int loss_percent;
+	int duplicate_percent;
+} JitterBufferPattern;
+
+typedef struct _JitterBufferRun {
+	uint16_t *delivered;
+	int delivered_count;
+	int duplicates;
+	int too_late;
+	uint64_t elapsed_ms;
+} JitterBufferRun;
+
+/* reproducible pseudo random numbers, the patterns must be the same for both implementations */
+static unsigned int next_random(unsigned int *state) {
+	*state = *state * 1103515245 + 12345;
+	return (*state >> 16) & 0x7fff;
+}
+
+/* arrival order of the sequence numbers, starting close to the wrap around */
+static uint16_t *make_arrivals(const JitterBufferPattern *pattern, int *arrival_count) {
+	uint16_t *arrivals = ortp_new0(uint16_t, pattern->packet_count * 2);
+	unsigned int state = 1;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < pattern->packet_count; i++) {
+		uint16_t seq = (uint16_t)(65000 + i);
+		if ((int)(next_random(&state) % 100) < pattern->loss_percent) continue;
+		arrivals[count++] = seq;
+		if ((int)(next_random(&state) % 100) < pattern->duplicate_percent) arrivals[count++] = seq;
+	}
+	/* delay some packets by moving them further in the arrival order */
+	for (i = count - 1; i >= 0; i--) {
+		if ((int)(next_random(&state) % 100) < pattern->reorder_percent) {
+			int distance = 1 + (int)(next_random(&state) % (unsigned int)pattern->reorder_distance);
+			int dest = i + distance < count ? i + distance : count - 1;
+			uint16_t seq = arrivals[i];
+			memmove(&arrivals[i], &arrivals[i + 1], (size_t)(dest - i) * sizeof(uint16_t));
+			arrivals[dest] = seq;
+		}
+	}
+	*arrival_count = count;
+	return arrivals;
+}
+
+static mblk_t *make_packet(uint16_t seq) {
+	mblk_t *mp = allocb(RTP_FIXED_HEADER_SIZE + 160, 0);
+	rtp_header_t *rtp = (rtp_header_t *)mp->b_wptr;
+	memset(rtp, 0, RTP_FIXED_HEADER_SIZE);
+	rtp->version = 2;
+	rtp_header_set_seqnumber(rtp, seq);
+	rtp_header_set_timestamp(rtp, (uint32_t)seq * 160);
+	mp->b_wptr += RTP_FIXED_HEADER_SIZE + 160;
+	return mp;
+}
+
+static void deliver(JitterBufferRun *run, mblk_t *mp) {
+	run->delivered[run->delivered_count++] = rtp_get_seqnumber(mp);
+	freemsg(mp);
+}
+
+/* rtp_parse() drops the packets older than the last delivered one before queuing them */
+static bool_t arrives_too_late(JitterBufferRun *run, uint16_t seq) {
+	if (run->delivered_count > 0 &&
+	    !RTP_SEQ_IS_STRICTLY_GREATER_THAN(seq, run->delivered[run->delivered_count - 1])) {
+		run->too_late++;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static void run_jitter_queue(const JitterBufferPattern *pattern, const uint16_t *arrivals, int count,
+                             JitterBufferRun *run) {
+	JitterQueue q;
+	uint64_t start = bctbx_get_cur_time_ms();
+	mblk_t *mp;
+	int discarded = 0;
+	int i;
+
+	jitter_queue_init(&q);
+	for (i = 0; i < count; i++) {
+		if (arrives_too_late(run, arrivals[i])) continue;
+		if (jitter_queue_put(&q, make_packet(arrivals[i]), &discarded) < 0) run->duplicates++;
+		while (q.q_mcount > pattern->depth)
+			deliver(run, jitter_queue_get(&q));
+	}
+	while ((mp = jitter_queue_get(&q)) != NULL)
+		deliver(run, mp);
+	jitter_queue_uninit(&q);
+	run->elapsed_ms = bctbx_get_cur_time_ms() - start;
+	BC_ASSERT_EQUAL(discarded, 0, int, "%d");
+}
+
+/* the sorted list used before the jitter queue, still used for telephone events */
+static void run_sorted_list(const JitterBufferPattern *pattern, const uint16_t *arrivals, int count,
+                            JitterBufferRun *run) {
+	queue_t q;
+	uint64_t start = bctbx_get_cur_time_ms();
+	mblk_t *mp;
+	int i;
+
+	qinit(&q);
+	for (i = 0; i < count; i++) {
+		if (arrives_too_late(run, arrivals[i])) continue;
+		if (rtp_putq(&q, make_packet(arrivals[i])) < 0) run->duplicates++;
+		while (q.q_mcount > pattern->depth)
+			deliver(run, getq(&q));
+	}
+	while ((mp = getq(&q)) != NULL)
+		deliver(run, mp);
+	run->elapsed_ms = bctbx_get_cur_time_ms() - start;
+}
+
+static void jitter_buffer_benchmark(const JitterBufferPattern *pattern) {
+	JitterBufferRun ring = {0}, list = {0};
+	int count = 0;
+	uint16_t *arrivals = make_arrivals(pattern, &count);
+	int i;
+
+	ring.delivered = ortp_new0(uint16_t, count);
+	list.delivered = ortp_new0(uint16_t, count);
+	run_jitter_queue(pattern, arrivals, count, &ring);
+	run_sorted_list(pattern, arrivals, count, &list);
+
+	for (i = 1; i < ring.delivered_count; i++) {
+		if (!RTP_SEQ_IS_STRICTLY_GREATER_THAN(ring.delivered[i], ring.delivered[i - 1])) {
+			BC_FAIL("packets delivered out of order");
+			break;
+		}
+	}
+	BC_ASSERT_EQUAL(ring.delivered_count, list.delivered_count, int, "%d");
+	BC_ASSERT_EQUAL(ring.duplicates, list.duplicates, int, "%d");
+	BC_ASSERT_EQUAL(ring.too_late, list.too_late, int, "%d");
+	if (ring.delivered_count == list.delivered_count) {
+		BC_ASSERT_EQUAL(memcmp(ring.delivered, list.delivered, (size_t)ring.delivered_count * sizeof(uint16_t)), 0,
+		                int, "%d");
+	}
+	if (pattern->duplicate_percent > 0) BC_ASSERT_GREATER(ring.duplicates, 0, int, "%d");
+	if (pattern->loss_percent > 0) BC_ASSERT_LOWER(ring.delivered_count, pattern->packet_count, int, "%d");
+
+	ortp_message("Jitter buffer benchmark [%s]: %d packets received, %d delivered, %d duplicates, %d too late. "
+	             "Jitter queue: %llu ms, sorted list: %llu ms",
+	             pattern->name, count, ring.delivered_count, ring.duplicates, ring.too_late,
+	             (unsigned long long)ring.elapsed_ms, (unsigned long long)list.elapsed_ms);
+
+	ortp_free(ring.delivered);
+	ortp_free(list.delivered);
+	ortp_free(arrivals);
+}
+
+static void in_order(void) {
+	JitterBufferPattern pattern = {"in order", 100000, 50, 0, 1, 0, 0};
+	jitter_buffer_benchmark(&pattern);
+}
+
+static void reordering(void) {
+	JitterBufferPattern pattern = {"reordering", 100000, 50, 20, 10, 0, 0};
+	jitter_buffer_benchmark(&pattern);
+}
+
+static void reordering_and_loss(void) {
+	JitterBufferPattern pattern = {"reordering and loss", 100000, 50, 10, 30, 5, 2};
+	jitter_buffer_benchmark(&pattern);
+}
+
+static void large_video_buffer(void) {
+	/* video key frames fill the buffer with hundreds of packets, some of them arriving far behind the others */
+	JitterBufferPattern pattern = {"large video buffer", 100000, 2000, 5, 1500, 2, 1};
+	jitter_buffer_benchmark(&pattern);
+}
+
+static void sequence_number_jump(void) {
+	JitterQueue q;
+	int discarded = 0;
+	mblk_t *mp;
+
+	jitter_queue_init(&q);
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(10), &discarded), 0, int, "%d");
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(12), &discarded), 0, int, "%d");
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(11), &discarded), 0, int, "%d");
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(12), &discarded), -1, int, "%d");
+	BC_ASSERT_PTR_NOT_NULL(jitter_queue_find(&q, 11));
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 13));
+
+	/* packets too far from the newest one are dropped to make room */
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(10 + 20000), &discarded), 0, int, "%d");
+	BC_ASSERT_EQUAL(discarded, 0, int, "%d");
+	BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(10 + 40000), &discarded), 0, int, "%d");
+	BC_ASSERT_EQUAL(discarded, 3, int, "%d");
+	BC_ASSERT_EQUAL(q.q_mcount, 2, int, "%d");
+
+	mp = jitter_queue_first(&q);
+	if (BC_ASSERT_PTR_NOT_NULL(mp)) {
+		BC_ASSERT_EQUAL(rtp_get_seqnumber(mp), 10 + 20000, int, "%d");
+		BC_ASSERT_EQUAL(rtp_get_seqnumber(jitter_queue_next(&q, mp)), 10 + 40000, int, "%d");
+	}
+	jitter_queue_remove(&q, jitter_queue_last(&q));
+	BC_ASSERT_PTR_EQUAL(jitter_queue_last(&q), mp);
+	jitter_queue_uninit(&q);
+}
+
+static void find(void) {
+	JitterQueue q;
+	int discarded = 0;
+	uint16_t seq;
+	mblk_t *mp;
+
+	jitter_queue_init(&q);
+	for (seq = 100; seq <= 110; seq++) {
+		BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(seq), &discarded), 0, int, "%d");
+	}
+	mp = jitter_queue_find(&q, 105);
+	if (BC_ASSERT_PTR_NOT_NULL(mp)) BC_ASSERT_EQUAL(rtp_get_seqnumber(mp), 105, int, "%d");
+
+	/* past the newest packet */
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 111));
+	/* these seq numbers share the ring slots of queued packets */
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 100 + 64));
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 110 + 64));
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 100 - 64));
+	jitter_queue_uninit(&q);
+
+	/* across the wrap around of the seq numbers */
+	jitter_queue_init(&q);
+	for (seq = 65530; seq != 6; seq++) {
+		BC_ASSERT_EQUAL(jitter_queue_put(&q, make_packet(seq), &discarded), 0, int, "%d");
+	}
+	mp = jitter_queue_find(&q, 2);
+	if (BC_ASSERT_PTR_NOT_NULL(mp)) BC_ASSERT_EQUAL(rtp_get_seqnumber(mp), 2, int, "%d");
+	mp = jitter_queue_find(&q, 65533);
+	if (BC_ASSERT_PTR_NOT_NULL(mp)) BC_ASSERT_EQUAL(rtp_get_seqnumber(mp), 65533, int, "%d");
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, 6));
+	BC_ASSERT_PTR_NULL(jitter_queue_find(&q, (uint16_t)(65530 + 64)));
+	jitter_queue_uninit(&q);
+}
+
+static test_t tests[] = {
+    TEST_NO_TAG("In order", in_order),
+    TEST_NO_TAG("Reordering", reordering),
+    TEST_NO_TAG("Reordering and loss", reordering_and_loss),
+    TEST_NO_TAG("Large video buffer", large_video_buffer),
+    TEST_NO_TAG("Sequence number jump", sequence_number_jump),
+    TEST_NO_TAG("Find", find),
+};
+
+test_suite_t jitter_buffer_test_suite = {
+    "Jitter buffer",                  // Name of test suite
+    NULL,                             // Before all callback
+    NULL,                             // After all callback
+    NULL,                             // Before each callback
+    NULL,                             // After each callback
+    sizeof(tests) / sizeof(tests[0]), // Size of test table
+    tests                             // Table of test suite
+};
@@ -99,6 +99,7 @@ void ortp_tester_init(void (*ftester_printf)(int level, const char *fmt, va_list
 
 	bc_tester_add_suite(&extension_header_test_suite);
 	bc_tester_add_suite(&fec_test_suite);
+	bc_tester_add_suite(&jitter_buffer_test_suite);
 	bc_tester_add_suite(&rtp_test_suite);
 	bc_tester_add_suite(&bundle_test_suite);
 }
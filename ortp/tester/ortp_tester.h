@@ -36,6 +36,7 @@ extern "C" {
 
 extern test_suite_t extension_header_test_suite;
 extern test_suite_t fec_test_suite;
+extern test_suite_t jitter_buffer_test_suite;
 extern test_suite_t rtp_test_suite;
 extern test_suite_t bundle_test_suite;
 
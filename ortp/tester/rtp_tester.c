@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <bctoolbox/defs.h>
 #include "ortp_tester.h"
 #include <ortp/ortp.h>
 
@@ -320,8 +321,435 @@ static void change_remote_address(void) {
 	rtp_session_destroy(flore);
 }
 
+static void packet_pool(void) {
+	OrtpPacketPoolStats before, after;
+	mblk_t *m, *dup, *big;
+	int i;
+
+	ortp_packet_pool_get_stats(&before);
+	for (i = 0; i < 100; i++) {
+		m = allocb(UDP_MAX_SIZE, 0);
+		BC_ASSERT_EQUAL((int)(dblk_lim(m->b_datap) - dblk_base(m->b_datap)), UDP_MAX_SIZE, int, "%d");
+		m->b_wptr += 12;
+		dup = dupb(m);
+		BC_ASSERT_EQUAL(dblk_ref_value(m->b_datap), 2, int, "%d");
+		BC_ASSERT_PTR_EQUAL(dup->b_rptr, m->b_rptr);
+		freeb(m);
+		BC_ASSERT_EQUAL(dblk_ref_value(dup->b_datap), 1, int, "%d");
+		freeb(dup);
+	}
+	/* too large for the pools, but still counted */
+	big = allocb(64 * 1024, 0);
+	freeb(big);
+	ortp_packet_pool_get_stats(&after);
+
+	BC_ASSERT_EQUAL((int)(after.dblk_allocations - before.dblk_allocations), 101, int, "%d");
+	BC_ASSERT_EQUAL((int)(after.mblk_allocations - before.mblk_allocations), 201, int, "%d");
+	/* all but the first allocations of each size class are served by the pool of this thread */
+	BC_ASSERT_GREATER((int)(after.dblk_reuses - before.dblk_reuses), 99, int, "%d");
+	BC_ASSERT_GREATER((int)(after.mblk_reuses - before.mblk_reuses), 198, int, "%d");
+}
+
+#define FAKE_SRTP_TAG_SIZE 10
+
+/* Appends an authentication tag the way the SRTP modifier does: the packet is pulled up with room for the tag, which
+ * is then written after the data. */
+static int fake_srtp_process_on_send(BCTBX_UNUSED(RtpTransportModifier *t), mblk_t *msg) {
+	int slen = (int)msgdsize(msg);
+	msgpullup(msg, slen + FAKE_SRTP_TAG_SIZE + 4);
+	memset(msg->b_rptr + slen, 0xaa, FAKE_SRTP_TAG_SIZE);
+	return slen + FAKE_SRTP_TAG_SIZE;
+}
+
+static int fake_srtp_process_on_receive(BCTBX_UNUSED(RtpTransportModifier *t), mblk_t *msg) {
+	return (int)msgdsize(msg);
+}
+
+static void fake_srtp_destroy(RtpTransportModifier *t) {
+	ortp_free(t);
+}
+
+static int
+send_packets_with_fake_srtp(RtpSession *sender, RtpSession *receiver, uint32_t *user_ts, bool_t reserve_room) {
+	OrtpPacketPoolStats before, after;
+	mblk_t *received_packet;
+	uint32_t send_ts = *user_ts;
+	int received = 0;
+	int i, cpt;
+	const int count = 10;
+
+	ortp_packet_pool_get_stats(&before);
+	for (i = 0; i < count; i++) {
+		mblk_t *header = rtp_session_create_packet_header(sender, 0);
+		mblk_t *payload = reserve_room ? rtp_create_payload(160) : allocb(160, 0);
+		memset(payload->b_wptr, i, 160);
+		payload->b_wptr += 160;
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(sender, msgprepend(header, payload), send_ts), 0, int, "%d");
+		send_ts += 160;
+	}
+	ortp_packet_pool_get_stats(&after);
+	bctbx_sleep_ms(20);
+
+	for (cpt = 0; received < count && cpt < 100; cpt++) {
+		received_packet = rtp_session_recvm_with_ts(receiver, *user_ts);
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			continue;
+		}
+		BC_ASSERT_EQUAL(msgdsize(received_packet), RTP_FIXED_HEADER_SIZE + 160 + FAKE_SRTP_TAG_SIZE, size_t, "%zu");
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], received, int, "%d");
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE + 160], 0xaa, int, "%d");
+		freemsg(received_packet);
+		received++;
+		*user_ts += 160;
+	}
+	BC_ASSERT_EQUAL(received, count, int, "%d");
+	return (int)(after.pullups - before.pullups);
+}
+
+static void packet_room(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	RtpTransport *rtpt = NULL;
+	RtpTransportModifier *modifier;
+	uint32_t user_ts = 0;
+	mblk_t *m, *dup;
+
+	/* room is kept by the block, and only a single owner can write in it */
+	m = allocb_with_room(16, 100, 32);
+	BC_ASSERT_EQUAL((int)mblk_headroom(m), 16, int, "%d");
+	BC_ASSERT_EQUAL((int)mblk_tailroom(m), 132, int, "%d");
+	m->b_wptr += 100;
+	msgpullup(m, 100 + 32);
+	BC_ASSERT_EQUAL((int)mblk_headroom(m), 16, int, "%d");
+	dup = dupb(m);
+	msgpullup(dup, 100 + 32);
+	BC_ASSERT_PTR_NOT_EQUAL(dup->b_datap, m->b_datap);
+	BC_ASSERT_EQUAL(dblk_ref_value(m->b_datap), 1, int, "%d");
+	freeb(dup);
+	freeb(m);
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	modifier = ortp_new0(RtpTransportModifier, 1);
+	modifier->level = ORTP_RTP_TRANSPORT_MODIFIER_DEFAULT_LEVEL;
+	modifier->t_process_on_send = fake_srtp_process_on_send;
+	modifier->t_process_on_receive = fake_srtp_process_on_receive;
+	modifier->t_destroy = fake_srtp_destroy;
+	rtp_session_get_transports(sender, &rtpt, NULL);
+	meta_rtp_transport_append_modifier(rtpt, modifier);
+
+	/* a header chained to a payload without room is pulled up by the modifier */
+	BC_ASSERT_EQUAL(send_packets_with_fake_srtp(sender, receiver, &user_ts, FALSE), 10, int, "%d");
+	/* with the room reserved, the header is prepended and the tag appended in place */
+	BC_ASSERT_EQUAL(send_packets_with_fake_srtp(sender, receiver, &user_ts, TRUE), 0, int, "%d");
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
+static void batched_reception(void) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	mblk_t *received_packet;
+	uint32_t user_ts = 0;
+	int received = 0;
+	int i, cpt;
+	const int count = 20;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+	rtp_session_set_recv_batch_size(receiver, 8);
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	/* Queue more datagrams than a batch can hold on the receiver's socket before reading any of them */
+	for (i = 0; i < count; i++) {
+		mblk_t *sent_packet = rtp_session_create_packet_header(sender, 160);
+		memset(sent_packet->b_wptr, i, 160);
+		sent_packet->b_wptr += 160;
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(sender, sent_packet, i * 160), 0, int, "%d");
+	}
+	bctbx_sleep_ms(20);
+
+	for (cpt = 0; received < count && cpt < 100; cpt++) {
+		received_packet = rtp_session_recvm_with_ts(receiver, user_ts);
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			continue;
+		}
+		BC_ASSERT_EQUAL(msgdsize(received_packet), RTP_FIXED_HEADER_SIZE + 160, size_t, "%zu");
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], received, int, "%d");
+		BC_ASSERT_TRUE(received_packet->timestamp.tv_sec != 0);
+		freemsg(received_packet);
+		received++;
+		user_ts += 160;
+	}
+	BC_ASSERT_EQUAL(received, count, int, "%d");
+	BC_ASSERT_EQUAL((int)rtp_session_get_stats(receiver)->packet_recv, count, int, "%d");
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
+static void batched_sending_base(bool_t gso) {
+	RtpSession *sender;
+	RtpSession *receiver;
+	mblk_t *received_packet;
+	uint32_t user_ts = 0;
+	int received = 0;
+	int i, cpt;
+	const int count = 20;
+
+	sender = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(sender, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(sender, 0);
+	rtp_session_set_send_batch_size(sender, 16);
+	rtp_session_enable_send_gso(sender, gso);
+
+	receiver = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_local_addr(receiver, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(receiver, 0);
+	rtp_session_enable_jitter_buffer(receiver, FALSE);
+
+	rtp_session_set_remote_addr_full(sender, "127.0.0.1", rtp_session_get_local_port(receiver), "127.0.0.1",
+	                                 rtp_session_get_local_rtcp_port(receiver));
+
+	/* Same size packets, like the ones of a video frame, but the last one */
+	for (i = 0; i < count; i++) {
+		int size = (i == count - 1) ? 80 : 160;
+		mblk_t *sent_packet = rtp_session_create_packet_header(sender, size);
+		memset(sent_packet->b_wptr, i, size);
+		sent_packet->b_wptr += size;
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(sender, sent_packet, i * 160), 0, int, "%d");
+	}
+	rtp_session_flush_send_batch(sender);
+
+	for (cpt = 0; received < count && cpt < 100; cpt++) {
+		received_packet = rtp_session_recvm_with_ts(receiver, user_ts);
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			continue;
+		}
+		BC_ASSERT_EQUAL(msgdsize(received_packet), RTP_FIXED_HEADER_SIZE + ((received == count - 1) ? 80 : 160),
+		                size_t, "%zu");
+		BC_ASSERT_EQUAL(received_packet->b_rptr[RTP_FIXED_HEADER_SIZE], received, int, "%d");
+		freemsg(received_packet);
+		received++;
+		user_ts += 160;
+	}
+	BC_ASSERT_EQUAL(received, count, int, "%d");
+	BC_ASSERT_EQUAL((int)rtp_session_get_stats(sender)->packet_sent, count, int, "%d");
+
+	rtp_session_destroy(sender);
+	rtp_session_destroy(receiver);
+}
+
+static void batched_sending(void) {
+	batched_sending_base(FALSE);
+}
+
+static void batched_sending_with_gso(void) {
+	batched_sending_base(TRUE);
+}
+
+static int demux_receive(RtpSession *session, RtpDemux *demux, uint32_t *user_ts, int expected_marker) {
+	int received = 0;
+	int cpt;
+
+	for (cpt = 0; cpt < 50; cpt++) {
+		mblk_t *received_packet;
+		rtp_demux_process(demux);
+		received_packet = rtp_session_recvm_with_ts(session, *user_ts);
+		*user_ts += 160;
+		if (received_packet == NULL) {
+			bctbx_sleep_ms(1);
+			continue;
+		}
+		BC_ASSERT_EQUAL(received_packet->b_rptr[msgdsize(received_packet) - 1], expected_marker, int, "%d");
+		freemsg(received_packet);
+		received++;
+	}
+	return received;
+}
+
+static void single_port_demux(void) {
+	RtpDemux *demux;
+	RtpSession *client1, *client2;
+	RtpSession *server1, *server2;
+	uint32_t user_ts1 = 0, user_ts2 = 0;
+	const char *mid = "video";
+	int demux_port;
+	int i;
+	const int count = 10;
+
+	demux = rtp_demux_new("127.0.0.1", -1, 1);
+	if (!BC_ASSERT_PTR_NOT_NULL(demux)) return;
+	demux_port = rtp_demux_get_local_port(demux);
+
+	client1 = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(client1, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(client1, 0);
+	rtp_session_set_remote_addr_full(client1, "127.0.0.1", demux_port, "127.0.0.1", demux_port);
+
+	client2 = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(client2, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(client2, 0);
+	rtp_session_set_remote_addr_full(client2, "127.0.0.1", demux_port, "127.0.0.1", demux_port);
+
+	/* The first server session knows the address of its client, the second one only its MID */
+	server1 = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_payload_type(server1, 0);
+	rtp_session_enable_jitter_buffer(server1, FALSE);
+	rtp_demux_add_session(demux, server1);
+	rtp_session_set_remote_addr(server1, "127.0.0.1", rtp_session_get_local_port(client1));
+
+	server2 = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_payload_type(server2, 0);
+	rtp_session_enable_jitter_buffer(server2, FALSE);
+	rtp_demux_add_session(demux, server2);
+	rtp_demux_set_session_mid(demux, server2, mid);
+
+	BC_ASSERT_EQUAL(rtp_session_get_local_port(server1), demux_port, int, "%d");
+	BC_ASSERT_EQUAL(rtp_session_get_local_port(server2), demux_port, int, "%d");
+
+	for (i = 0; i < count; i++) {
+		mblk_t *sent_packet = rtp_session_create_packet_header(client1, 160);
+		memset(sent_packet->b_wptr, 1, 160);
+		sent_packet->b_wptr += 160;
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(client1, sent_packet, i * 160), 0, int, "%d");
+
+		sent_packet = rtp_session_create_packet_header(client2, 160);
+		memset(sent_packet->b_wptr, 2, 160);
+		sent_packet->b_wptr += 160;
+		rtp_add_extension_header(sent_packet, RTP_EXTENSION_MID, strlen(mid), (uint8_t *)mid);
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(client2, sent_packet, i * 160), 0, int, "%d");
+	}
+	bctbx_sleep_ms(20);
+
+	BC_ASSERT_EQUAL(demux_receive(server1, demux, &user_ts1, 1), count, int, "%d");
+	BC_ASSERT_EQUAL(demux_receive(server2, demux, &user_ts2, 2), count, int, "%d");
+
+	/* Once learnt, the address of the second client is enough to identify its session */
+	for (i = count; i < 2 * count; i++) {
+		mblk_t *sent_packet = rtp_session_create_packet_header(client2, 160);
+		memset(sent_packet->b_wptr, 2, 160);
+		sent_packet->b_wptr += 160;
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(client2, sent_packet, i * 160), 0, int, "%d");
+	}
+	bctbx_sleep_ms(20);
+
+	BC_ASSERT_EQUAL(demux_receive(server1, demux, &user_ts1, 1), 0, int, "%d");
+	BC_ASSERT_EQUAL(demux_receive(server2, demux, &user_ts2, 2), count, int, "%d");
+
+	rtp_session_destroy(server1);
+	rtp_session_destroy(server2);
+	rtp_demux_destroy(demux);
+	rtp_session_destroy(client1);
+	rtp_session_destroy(client2);
+}
+
+static void send_demux_packets(RtpSession *client, int marker, const char *mid, int first, int count) {
+	int i;
+	for (i = first; i < first + count; i++) {
+		mblk_t *sent_packet = rtp_session_create_packet_header(client, 160);
+		memset(sent_packet->b_wptr, marker, 160);
+		sent_packet->b_wptr += 160;
+		if (mid) rtp_add_extension_header(sent_packet, RTP_EXTENSION_MID, strlen(mid), (uint8_t *)mid);
+		BC_ASSERT_GREATER(rtp_session_sendm_with_ts(client, sent_packet, i * 160), 0, int, "%d");
+	}
+	bctbx_sleep_ms(20);
+}
+
+static void single_port_demux_ssrc_collision(void) {
+	RtpDemux *demux;
+	RtpSession *client1, *client2;
+	RtpSession *server1, *server2;
+	uint32_t user_ts1 = 0, user_ts2 = 0;
+	const char *mid = "audio";
+	const uint32_t ssrc = 0x12345678;
+	int demux_port;
+	const int count = 10;
+
+	demux = rtp_demux_new("127.0.0.1", -1, 1);
+	if (!BC_ASSERT_PTR_NOT_NULL(demux)) return;
+	demux_port = rtp_demux_get_local_port(demux);
+
+	/* Both clients send with the same SSRC */
+	client1 = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(client1, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(client1, 0);
+	rtp_session_set_ssrc(client1, ssrc);
+	rtp_session_set_remote_addr_full(client1, "127.0.0.1", demux_port, "127.0.0.1", demux_port);
+
+	client2 = rtp_session_new(RTP_SESSION_SENDONLY);
+	rtp_session_set_local_addr(client2, "127.0.0.1", -1, -1);
+	rtp_session_set_payload_type(client2, 0);
+	rtp_session_set_ssrc(client2, ssrc);
+	rtp_session_set_remote_addr_full(client2, "127.0.0.1", demux_port, "127.0.0.1", demux_port);
+
+	/* The first server session learns the SSRC and the address of its client from the MID, the second one knows the
+	 * address of its client */
+	server1 = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_payload_type(server1, 0);
+	rtp_session_enable_jitter_buffer(server1, FALSE);
+	rtp_demux_add_session(demux, server1);
+	rtp_demux_set_session_mid(demux, server1, mid);
+
+	server2 = rtp_session_new(RTP_SESSION_RECVONLY);
+	rtp_session_set_payload_type(server2, 0);
+	rtp_session_enable_jitter_buffer(server2, FALSE);
+	rtp_demux_add_session(demux, server2);
+	rtp_session_set_remote_addr(server2, "127.0.0.1", rtp_session_get_local_port(client2));
+
+	send_demux_packets(client1, 1, mid, 0, count);
+	BC_ASSERT_EQUAL(demux_receive(server1, demux, &user_ts1, 1), count, int, "%d");
+
+	/* The SSRC of the second client is already known, but its address identifies its session */
+	send_demux_packets(client2, 2, NULL, 0, count);
+	BC_ASSERT_EQUAL(demux_receive(server2, demux, &user_ts2, 2), count, int, "%d");
+	BC_ASSERT_EQUAL(demux_receive(server1, demux, &user_ts1, 1), 0, int, "%d");
+
+	/* The addresses are still bound to their sessions */
+	send_demux_packets(client1, 1, NULL, count, count);
+	send_demux_packets(client2, 2, NULL, count, count);
+	BC_ASSERT_EQUAL(demux_receive(server1, demux, &user_ts1, 1), count, int, "%d");
+	BC_ASSERT_EQUAL(demux_receive(server2, demux, &user_ts2, 2), count, int, "%d");
+
+	rtp_session_destroy(server1);
+	rtp_session_destroy(server2);
+	rtp_demux_destroy(demux);
+	rtp_session_destroy(client1);
+	rtp_session_destroy(client2);
+}
+
 static test_t tests[] = {TEST_NO_TAG("Send packets through a transfer session", send_packets_through_tranfer_session),
-                         TEST_NO_TAG("Change remote address", change_remote_address)};
+                         TEST_NO_TAG("Change remote address", change_remote_address),
+                         TEST_NO_TAG("Packet pool", packet_pool),
+                         TEST_NO_TAG("Packet room", packet_room),
+                         TEST_NO_TAG("Batched reception", batched_reception),
+                         TEST_NO_TAG("Batched sending", batched_sending),
+                         TEST_NO_TAG("Batched sending with GSO", batched_sending_with_gso),
+                         TEST_NO_TAG("Single port demultiplexing", single_port_demux),
+                         TEST_NO_TAG("Single port demultiplexing with colliding SSRCs",
+                                     single_port_demux_ssrc_collision)};
 
 test_suite_t rtp_test_suite = {
     "Rtp",                            // Name of test suite